@@ -7,6 +7,10 @@
  */
 
 #include "z1_bootloader.h"
+#include "z1_lz4.h"
+#include "../common/z1_crc32.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
 #include <string.h>
 
 // ============================================================================
@@ -17,6 +21,30 @@ static z1_boot_config_t g_boot_config;
 static z1_firmware_header_t g_firmware_buffer_header;
 static uint32_t g_firmware_upload_offset = 0;
 
+/**
+ * Application slot writer
+ * 
+ * Bytes are collected one flash sector at a time; a full sector is erased
+ * and programmed in FLASH_PAGE_SIZE pages. Earlier output stays readable
+ * through XIP, which is where LZ4 match copies find it.
+ */
+typedef struct {
+    uint32_t pos;               // Bytes written from APP_BASE
+    uint32_t sector_start;      // pos of sector[0]
+    uint32_t crc;               // CRC32 of the code (bytes after the header)
+    bool failed;
+    uint8_t sector[FLASH_SECTOR_SIZE] __attribute__((aligned(4)));
+} z1_flash_writer_t;
+
+static z1_flash_writer_t g_writer;
+
+// Compressed upload being decoded straight to flash
+static z1_firmware_header_t g_stream_header;
+static z1_lz4_stream_t g_stream_lz4;
+static uint32_t g_stream_consumed = 0;
+static bool g_stream_active = false;
+static bool g_stream_installed = false;
+
 // ============================================================================
 // Z1 Bus Communication Functions
 // ============================================================================
@@ -71,22 +99,11 @@ static bool z1_bus_receive_command(uint8_t *cmd, uint8_t *data, uint16_t *len) {
 // CRC32 Implementation
 // ============================================================================
 
-static const uint32_t crc32_table[256] = {
-    // Standard CRC32 table (IEEE 802.3)
-    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA,
-    0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
-    // ... (full table would be here)
-};
+// The table lives in z1_crc32.h so the controller and node firmware
+// receiver compute the same checksums
 
 uint32_t z1_bootloader_crc32(const void *data, uint32_t len) {
-    const uint8_t *p = (const uint8_t*)data;
-    uint32_t crc = 0xFFFFFFFF;
-    
-    for (uint32_t i = 0; i < len; i++) {
-        crc = crc32_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
-    }
-    
-    return ~crc;
+    return z1_crc32(data, len);
 }
 
 // ============================================================================
@@ -123,6 +140,82 @@ static void save_boot_config(void) {
     // 4. Re-enable interrupts
 }
 
+// ============================================================================
+// Flash Writer
+// ============================================================================
+
+static void writer_reset(void) {
+    g_writer.pos = 0;
+    g_writer.sector_start = 0;
+    g_writer.crc = 0;
+    g_writer.failed = false;
+}
+
+// Erase the sector being collected and program its used pages
+static bool writer_flush(void) {
+    uint32_t fill = g_writer.pos - g_writer.sector_start;
+    if (fill == 0) {
+        return true;
+    }
+    
+    uint32_t prog_size = (fill + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+    memset(g_writer.sector + fill, 0xFF, prog_size - fill);
+    
+    uint32_t flash_offset = APP_BASE - XIP_BASE + g_writer.sector_start;
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(flash_offset, FLASH_SECTOR_SIZE);
+    flash_range_program(flash_offset, g_writer.sector, prog_size);
+    restore_interrupts(ints);
+    
+    g_writer.sector_start = g_writer.pos;
+    return memcmp((const void*)(APP_BASE + g_writer.sector_start - fill), g_writer.sector, fill) == 0;
+}
+
+static bool writer_put(void *ctx, uint8_t byte) {
+    (void)ctx;
+    if (g_writer.failed || g_writer.pos >= APP_MAX_SIZE) {
+        g_writer.failed = true;
+        return false;
+    }
+    
+    g_writer.sector[g_writer.pos - g_writer.sector_start] = byte;
+    if (g_writer.pos >= sizeof(z1_firmware_header_t)) {
+        g_writer.crc = z1_crc32_update(g_writer.crc, &byte, 1);
+    }
+    g_writer.pos++;
+    
+    if (g_writer.pos - g_writer.sector_start == FLASH_SECTOR_SIZE && !writer_flush()) {
+        g_writer.failed = true;
+        return false;
+    }
+    return true;
+}
+
+static bool writer_write(const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (!writer_put(NULL, data[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Output byte `distance` back: still in the sector buffer, or already in flash
+static uint8_t writer_back(void *ctx, uint32_t distance) {
+    (void)ctx;
+    uint32_t pos = g_writer.pos - distance;
+    if (pos >= g_writer.sector_start) {
+        return g_writer.sector[pos - g_writer.sector_start];
+    }
+    return *(const volatile uint8_t*)(APP_BASE + pos);
+}
+
+static const z1_lz4_sink_t g_writer_sink = {
+    .put = writer_put,
+    .back = writer_back,
+    .ctx = NULL,
+};
+
 // ============================================================================
 // Firmware Management
 // ============================================================================
@@ -157,6 +250,15 @@ bool z1_bootloader_verify_firmware(void) {
         return false;
     }
     
+    // Compressed code is checked while it is decoded (z1_bootloader_stream_end)
+    if (header->flags & FW_FLAG_LZ4) {
+        if (header->stored_size > FIRMWARE_BUFFER_SIZE - sizeof(z1_firmware_header_t)) {
+            return false;
+        }
+        memcpy(&g_firmware_buffer_header, header, sizeof(z1_firmware_header_t));
+        return true;
+    }
+    
     // Verify CRC32
     uint8_t *firmware_code = (uint8_t*)(FIRMWARE_BUFFER_BASE + sizeof(z1_firmware_header_t));
     uint32_t calculated_crc = z1_bootloader_crc32(firmware_code, header->firmware_size);
@@ -177,30 +279,25 @@ bool z1_bootloader_install_firmware(void) {
         return false;
     }
     
-    // Erase application slot
-    // NOTE: Actual RP2350B implementation:
-    // #include "hardware/flash.h"
-    // #include "hardware/sync.h"
-    
-    // TODO: Replace with actual RP2350B SDK calls:
-    // uint32_t ints = save_and_disable_interrupts();
-    // 
-    // // Erase application flash (must be 4KB sector aligned)
-    // uint32_t erase_size = (APP_MAX_SIZE + 4095) & ~4095;  // Round up to 4KB
-    // flash_range_erase(APP_BASE - XIP_BASE, erase_size);
-    // 
-    // // Program firmware (must be 256-byte page aligned)
-    // uint32_t total_size = sizeof(z1_firmware_header_t) + g_firmware_buffer_header.firmware_size;
-    // uint32_t prog_size = (total_size + 255) & ~255;  // Round up to 256 bytes
-    // flash_range_program(APP_BASE - XIP_BASE,
-    //                     (uint8_t*)FIRMWARE_BUFFER_BASE,
-    //                     prog_size);
-    // 
-    // restore_interrupts(ints);
-    
-    // Placeholder: In real implementation, flash operations would happen here
-    uint32_t total_size = sizeof(z1_firmware_header_t) + g_firmware_buffer_header.firmware_size;
-    (void)total_size;  // Suppress unused warning
+    const uint8_t *code = (const uint8_t*)(FIRMWARE_BUFFER_BASE + sizeof(z1_firmware_header_t));
+    
+    // A staged compressed image takes the same path as a streamed one
+    if (g_firmware_buffer_header.flags & FW_FLAG_LZ4) {
+        return z1_bootloader_stream_begin(&g_firmware_buffer_header) &&
+               z1_bootloader_stream_write(code, g_firmware_buffer_header.stored_size) &&
+               z1_bootloader_stream_end();
+    }
+    
+    g_boot_config.app_valid = 0;
+    save_boot_config();
+    
+    // Header and code, programmed sector by sector
+    writer_reset();
+    if (!writer_write((const uint8_t*)&g_firmware_buffer_header, sizeof(z1_firmware_header_t)) ||
+        !writer_write(code, g_firmware_buffer_header.firmware_size) ||
+        !writer_flush()) {
+        return false;
+    }
     
     // Mark application as valid
     g_boot_config.app_valid = 1;
@@ -210,6 +307,70 @@ bool z1_bootloader_install_firmware(void) {
     return true;
 }
 
+bool z1_bootloader_stream_begin(const z1_firmware_header_t *header) {
+    if (header->magic != FIRMWARE_MAGIC || !(header->flags & FW_FLAG_LZ4) ||
+        header->firmware_size > APP_MAX_SIZE - sizeof(z1_firmware_header_t)) {
+        return false;
+    }
+    
+    memcpy(&g_stream_header, header, sizeof(z1_firmware_header_t));
+    g_stream_consumed = 0;
+    g_stream_installed = false;
+    g_stream_active = true;
+    
+    // The slot is overwritten from here on
+    g_boot_config.app_valid = 0;
+    save_boot_config();
+    
+    // Installed header describes the decoded image
+    z1_firmware_header_t installed = *header;
+    installed.flags &= ~FW_FLAG_LZ4;
+    installed.stored_size = header->firmware_size;
+    
+    writer_reset();
+    z1_lz4_stream_init(&g_stream_lz4, &g_writer_sink);
+    if (!writer_write((const uint8_t*)&installed, sizeof(installed))) {
+        g_stream_active = false;
+        return false;
+    }
+    return true;
+}
+
+bool z1_bootloader_stream_write(const uint8_t *data, uint32_t len) {
+    if (!g_stream_active || len > g_stream_header.stored_size - g_stream_consumed) {
+        return false;
+    }
+    
+    g_stream_consumed += len;
+    if (!z1_lz4_stream_feed(&g_stream_lz4, data, len)) {
+        g_stream_active = false;
+        return false;
+    }
+    return true;
+}
+
+bool z1_bootloader_stream_end(void) {
+    if (!g_stream_active) {
+        return g_stream_installed;
+    }
+    g_stream_active = false;
+    
+    if (g_stream_consumed != g_stream_header.stored_size ||
+        !z1_lz4_stream_complete(&g_stream_lz4) ||
+        g_stream_lz4.produced != g_stream_header.firmware_size ||
+        !writer_flush() ||
+        g_writer.crc != g_stream_header.crc32) {
+        return false;
+    }
+    
+    g_stream_installed = true;
+    g_boot_config.app_valid = 1;
+    g_boot_config.update_pending = 0;
+    save_boot_config();
+    
+    return true;
+}
+
 void z1_bootloader_boot_application(void) {
     z1_firmware_header_t header;
     
@@ -284,6 +445,31 @@ static void handle_firmware_info(void) {
 }
 
 static void handle_firmware_upload(uint32_t offset, const uint8_t *data, uint16_t len) {
+    // A compressed image is decoded to flash as it arrives, in order
+    if (offset == 0 && len >= sizeof(z1_firmware_header_t)) {
+        z1_firmware_header_t header;
+        memcpy(&header, data, sizeof(header));
+        if (header.magic == FIRMWARE_MAGIC && (header.flags & FW_FLAG_LZ4)) {
+            bool ok = z1_bootloader_stream_begin(&header) &&
+                      z1_bootloader_stream_write(data + sizeof(header), len - sizeof(header));
+            g_firmware_upload_offset = len;
+            ok ? z1_bus_send_ack() : z1_bus_send_nack();
+            return;
+        }
+    }
+    if (g_stream_active) {
+        bool ok = (offset == g_firmware_upload_offset) &&
+                  z1_bootloader_stream_write(data, len);
+        if (ok) {
+            g_firmware_upload_offset = offset + len;
+            if (g_stream_consumed == g_stream_header.stored_size) {
+                ok = z1_bootloader_stream_end();
+            }
+        }
+        ok ? z1_bus_send_ack() : z1_bus_send_nack();
+        return;
+    }
+    
     // Write data to firmware buffer
     if (offset + len <= FIRMWARE_BUFFER_SIZE) {
         memcpy((void*)(FIRMWARE_BUFFER_BASE + offset), data, len);
@@ -298,7 +484,8 @@ static void handle_firmware_upload(uint32_t offset, const uint8_t *data, uint16_
 }
 
 static void handle_firmware_verify(void) {
-    bool valid = z1_bootloader_verify_firmware();
+    // Streamed images were checked as they were decoded
+    bool valid = g_stream_installed || z1_bootloader_verify_firmware();
     
     // Send response
     uint8_t response = valid ? 1 : 0;
@@ -306,7 +493,7 @@ static void handle_firmware_verify(void) {
 }
 
 static void handle_firmware_install(void) {
-    bool success = z1_bootloader_install_firmware();
+    bool success = g_stream_installed || z1_bootloader_install_firmware();
     
     // Send response
     uint8_t response = success ? 1 : 0;
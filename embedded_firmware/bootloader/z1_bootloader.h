@@ -57,9 +57,18 @@ typedef struct __attribute__((packed)) {
     char     name[32];           // Firmware name (null-terminated)
     char     version_string[16]; // Version string (e.g., "1.0.0")
     uint32_t capabilities;       // Capability flags
-    uint32_t reserved[42];       // Reserved for future use
+    uint32_t flags;              // Image format flags (FW_FLAG_*)
+    uint32_t stored_size;        // Bytes following the header (compressed size)
+    uint32_t reserved[40];       // Reserved for future use
 } z1_firmware_header_t;
 
+// Image format flags
+// With FW_FLAG_LZ4 the header is followed by stored_size bytes of one LZ4
+// block that decodes to firmware_size bytes; crc32 is over the decoded code.
+// The bootloader decodes it straight to the application slot and installs
+// the header with the flag cleared.
+#define FW_FLAG_LZ4             0x00000001  // Code is an LZ4 block
+
 // Firmware capability flags
 #define FW_CAP_SNN              0x00000001  // Spiking neural network
 #define FW_CAP_MATRIX           0x00000002  // Matrix operations
@@ -184,6 +193,34 @@ bool z1_bootloader_verify_firmware(void);
  */
 bool z1_bootloader_install_firmware(void);
 
+/**
+ * Start installing a compressed image as it arrives (no staging buffer)
+ *
+ * The application slot is erased sector by sector as decoded code reaches
+ * it, so the installed application is invalid until z1_bootloader_stream_end()
+ * succeeds.
+ *
+ * @param header Image header (FW_FLAG_LZ4 set)
+ * @return false if the header does not describe a compressed image that fits
+ */
+bool z1_bootloader_stream_begin(const z1_firmware_header_t *header);
+
+/**
+ * Decode the next compressed bytes into the application slot
+ *
+ * @param data Compressed bytes, in order
+ * @param len Length in bytes
+ * @return false on malformed data or a flash error
+ */
+bool z1_bootloader_stream_write(const uint8_t *data, uint32_t len);
+
+/**
+ * Flush the last sector and check size and CRC32 of the decoded code
+ *
+ * @return true if the application was installed and marked valid
+ */
+bool z1_bootloader_stream_end(void);
+
 /**
  * Boot to application firmware
  * 
@@ -0,0 +1,132 @@
+/**
+ * Z1 Streaming LZ4 Decoder
+ *
+ * A block is a run of sequences: token [literal length bytes] literals
+ * offset:2 [match length bytes]. The last sequence stops after its
+ * literals. Each input byte advances the state machine by one step, so a
+ * sequence may be split across feed calls anywhere.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_lz4.h"
+#include <stddef.h>
+
+#define LZ4_MIN_MATCH   4
+
+typedef enum {
+    LZ4_TOKEN = 0,
+    LZ4_LITERAL_LENGTH,
+    LZ4_LITERALS,
+    LZ4_OFFSET_LO,
+    LZ4_OFFSET_HI,
+    LZ4_MATCH_LENGTH
+} lz4_state_t;
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+static bool lz4_copy_match(z1_lz4_stream_t* s) {
+    const z1_lz4_sink_t* sink = s->sink;
+
+    if (s->offset == 0 || s->offset > s->produced) {
+        return false;
+    }
+
+    // Overlapping copies (offset < length) repeat the bytes just written
+    for (uint32_t i = 0; i < s->length; i++) {
+        if (!sink->put(sink->ctx, sink->back(sink->ctx, s->offset))) {
+            return false;
+        }
+        s->produced++;
+    }
+    s->state = LZ4_TOKEN;
+    return true;
+}
+
+/**
+ * Start decoding a block
+ */
+void z1_lz4_stream_init(z1_lz4_stream_t* stream, const z1_lz4_sink_t* sink) {
+    stream->sink = sink;
+    stream->state = LZ4_TOKEN;
+    stream->token = 0;
+    stream->offset = 0;
+    stream->length = 0;
+    stream->produced = 0;
+    stream->failed = false;
+}
+
+/**
+ * Decode the next piece of compressed input
+ */
+bool z1_lz4_stream_feed(z1_lz4_stream_t* s, const uint8_t* data, uint32_t length) {
+    const z1_lz4_sink_t* sink = s->sink;
+
+    for (uint32_t i = 0; i < length && !s->failed; i++) {
+        uint8_t b = data[i];
+
+        switch (s->state) {
+            case LZ4_TOKEN:
+                s->token = b;
+                s->length = b >> 4;
+                if (s->length == 15) {
+                    s->state = LZ4_LITERAL_LENGTH;
+                } else {
+                    s->state = (s->length > 0) ? LZ4_LITERALS : LZ4_OFFSET_LO;
+                }
+                break;
+
+            case LZ4_LITERAL_LENGTH:
+                s->length += b;
+                if (b != 255) {
+                    s->state = LZ4_LITERALS;
+                }
+                break;
+
+            case LZ4_LITERALS:
+                if (!sink->put(sink->ctx, b)) {
+                    s->failed = true;
+                    break;
+                }
+                s->produced++;
+                if (--s->length == 0) {
+                    s->state = LZ4_OFFSET_LO;
+                }
+                break;
+
+            case LZ4_OFFSET_LO:
+                s->offset = b;
+                s->state = LZ4_OFFSET_HI;
+                break;
+
+            case LZ4_OFFSET_HI:
+                s->offset |= (uint16_t)b << 8;
+                s->length = (s->token & 0x0F) + LZ4_MIN_MATCH;
+                if ((s->token & 0x0F) == 15) {
+                    s->state = LZ4_MATCH_LENGTH;
+                } else if (!lz4_copy_match(s)) {
+                    s->failed = true;
+                }
+                break;
+
+            case LZ4_MATCH_LENGTH:
+                s->length += b;
+                if (b != 255 && !lz4_copy_match(s)) {
+                    s->failed = true;
+                }
+                break;
+        }
+    }
+    return !s->failed;
+}
+
+/**
+ * Check that the input ended on a sequence boundary
+ */
+bool z1_lz4_stream_complete(const z1_lz4_stream_t* stream) {
+    // A block ends after the literals of its last sequence
+    return !stream->failed && (stream->state == LZ4_OFFSET_LO ||
+                               (stream->state == LZ4_TOKEN && stream->produced == 0));
+}
@@ -0,0 +1,79 @@
+/**
+ * Z1 Streaming LZ4 Decoder
+ *
+ * Decodes the LZ4 block format (as produced by LZ4_compress_default() or
+ * `nflash --compress`) from input that arrives in pieces of any size. The
+ * decoder keeps a few bytes of state and no window: match copies read the
+ * already decoded output back through the sink, so the output can go
+ * straight to flash.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_LZ4_H
+#define Z1_LZ4_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Destination of the decoded bytes
+ */
+typedef struct {
+    // Append one byte; false stops decoding (output full or write failed)
+    bool (*put)(void* ctx, uint8_t byte);
+
+    // Byte `distance` positions before the end of the output (1 = last byte)
+    uint8_t (*back)(void* ctx, uint32_t distance);
+
+    void* ctx;
+} z1_lz4_sink_t;
+
+/**
+ * Decoder state
+ */
+typedef struct {
+    const z1_lz4_sink_t* sink;
+    uint8_t state;
+    uint8_t token;
+    uint16_t offset;
+    uint32_t length;            // Literal or match bytes still to emit or gather
+    uint32_t produced;          // Output bytes so far
+    bool failed;
+} z1_lz4_stream_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Start decoding a block
+ *
+ * @param stream Decoder state
+ * @param sink Destination of the decoded bytes
+ */
+void z1_lz4_stream_init(z1_lz4_stream_t* stream, const z1_lz4_sink_t* sink);
+
+/**
+ * Decode the next piece of compressed input
+ *
+ * @param stream Decoder state
+ * @param data Compressed bytes
+ * @param length Bytes in data
+ * @return false on malformed input or when the sink refused a byte
+ */
+bool z1_lz4_stream_feed(z1_lz4_stream_t* stream, const uint8_t* data, uint32_t length);
+
+/**
+ * Check that the input ended on a sequence boundary
+ *
+ * @param stream Decoder state
+ * @return true if the block decoded completely
+ */
+bool z1_lz4_stream_complete(const z1_lz4_stream_t* stream);
+
+#endif // Z1_LZ4_H
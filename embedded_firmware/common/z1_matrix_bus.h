@@ -88,6 +88,8 @@ void z1_bus_handle_interrupt(void);
 
 // Ping functions
 bool z1_bus_ping_node(uint8_t target_node);
+bool z1_bus_ping_start(uint8_t target_node);     // No wait; poll z1_bus_ping_answered
+bool z1_bus_ping_answered(uint8_t target_node);
 bool z1_bus_ping_all_nodes(void);
 void z1_bus_clear_ping_history(void);
 bool z1_bus_handle_ping_response(uint8_t sender_node, uint8_t data_received);
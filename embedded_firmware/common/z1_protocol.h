@@ -35,6 +35,8 @@
 #define Z1_CMD_FIRMWARE_INSTALL     0x33  // Install firmware
 #define Z1_CMD_FIRMWARE_ACTIVATE    0x34  // Activate and reboot
 #define Z1_CMD_BOOT_MODE            0x35  // Set boot mode
+#define Z1_CMD_FIRMWARE_BEGIN       0x37  // Start a chunked image transfer (z1_fw_begin_t)
+#define Z1_CMD_FIRMWARE_STATUS      0x38  // Query received chunks (z1_fw_status_t reply)
 
 // ============================================================================
 // Memory Access Commands (0x40-0x4F)
@@ -45,11 +47,20 @@
 #define Z1_CMD_MEM_WRITE        0x42  // Write memory
 #define Z1_CMD_MEM_WRITE_ACK    0x43  // Write acknowledgment
 #define Z1_CMD_MEM_INFO         0x44  // Query memory info
+#define Z1_CMD_MEM_HASH         0x45  // Hash a memory range in fixed-size chunks
+#define Z1_CMD_MEM_READ_ACK     0x46  // Memory read window ack (data = blocks taken, mod 256)
 
 // Aliases for compatibility
 #define Z1_CMD_MEMORY_READ      Z1_CMD_MEM_READ_REQ
 #define Z1_CMD_MEMORY_WRITE     Z1_CMD_MEM_WRITE
 
+// ============================================================================
+// Diagnostics Commands (0x50-0x5F)
+// ============================================================================
+
+#define Z1_CMD_BENCH            0x50  // Run a benchmark (z1_bench_req_t, result reply)
+#define Z1_CMD_BENCH_SINK       0x51  // Bus benchmark traffic (counted and dropped)
+
 // ============================================================================
 // Code Execution Commands (0x60-0x6F)
 // ============================================================================
@@ -72,10 +83,41 @@
 #define Z1_CMD_SNN_GET_SPIKES       0x77  // Get output spikes
 #define Z1_CMD_SNN_LOAD_TABLE       0x78  // Load neuron table from PSRAM
 #define Z1_CMD_SNN_GET_STATUS       0x79  // Get SNN engine status
+#define Z1_CMD_SNN_SPIKE_BATCH      0x7A  // Batched spike events (inter-node)
+#define Z1_CMD_SNN_TICK             0x7B  // Release timestep (broadcast, data = step & 0xFF)
+#define Z1_CMD_SNN_STEP_DONE        0x7C  // Timestep finished (node -> controller, data = step & 0xFF)
+#define Z1_CMD_SNN_SLOT_DONE        0x7D  // TDMA slot finished (broadcast, data = z1_snn_slot_done_data())
+#define Z1_CMD_SNN_TDMA             0x7E  // TDMA spike exchange schedule (z1_snn_tdma_config_t)
+#define Z1_CMD_SNN_CREDIT           0x7F  // Spike credit return (data = spikes / Z1_SNN_CREDIT_UNIT)
+
+// Z1_CMD_SNN_START data flags
+#define Z1_SNN_START_SYNC           0x01  // Step only on Z1_CMD_SNN_TICK (timestep barrier)
+#define Z1_SNN_START_TDMA           0x02  // With SYNC: send spikes in the Z1_CMD_SNN_TDMA slots
+#define Z1_SNN_START_BATCH          0x04  // Run the staged batch of samples (see Batch Inference)
+
+// Free-running spike flow control: a sender may have Z1_SNN_CREDIT_WINDOW
+// batched spikes outstanding per destination. The destination hands credit
+// back with Z1_CMD_SNN_CREDIT as it takes them off its spike queue; a batch
+// short of credit is held by the sender (see z1_spike_batch.h). Barrier runs
+// are paced by the tick instead and ignore credit.
+#define Z1_SNN_CREDIT_WINDOW        256
+#define Z1_SNN_CREDIT_UNIT          16
+
+// Barrier mode: a spike fired in step k reaches other nodes' neurons in step
+// k + Z1_SNN_SYNC_LATENCY_STEPS (one step to compute, one to cross the bus)
+#define Z1_SNN_SYNC_LATENCY_STEPS   2
 
 // Aliases for compatibility
 #define Z1_CMD_SNN_INJECT_SPIKE Z1_CMD_SNN_INPUT_SPIKE
 
+// ============================================================================
+// SNN State Commands (0x80-0x8F)
+// ============================================================================
+
+#define Z1_CMD_SNN_CHECKPOINT       0x80  // Save run state (data = Z1_SNN_CKPT_SAVE) or describe it (QUERY)
+#define Z1_CMD_SNN_RESTORE          0x81  // Apply the staged checkpoint image (z1_snn_ckpt_info_t reply)
+#define Z1_CMD_SNN_BATCH            0x82  // Describe the staged or running batch (z1_snn_batch_info_t reply)
+
 // ============================================================================
 // Multi-Frame Protocol Commands (0xF0-0xFF)
 // ============================================================================
@@ -85,6 +127,7 @@
 #define Z1_CMD_FRAME_END        0xF2  // End multi-frame transfer
 #define Z1_CMD_FRAME_ACK        0xF3  // Frame acknowledgment
 #define Z1_CMD_FRAME_NACK       0xF4  // Frame negative acknowledgment
+#define Z1_CMD_FRAME_BURST      0xF5  // Burst transfer (single BUSATTN, data = command)
 
 // ============================================================================
 // Protocol Constants
@@ -92,6 +135,7 @@
 
 #define Z1_FRAME_HEADER         0xAA  // Frame header byte
 #define Z1_BROADCAST_ID         31    // Broadcast address
+#define Z1_MULTICAST_ID         30    // Multicast address (destination mask on the data lanes)
 #define Z1_CONTROLLER_ID        16    // Controller node ID
 #define Z1_MAX_NODES            16    // Maximum regular nodes (0-15)
 #define Z1_PING_DATA            0xA5  // Standard ping payload
@@ -130,6 +174,8 @@ typedef struct {
     uint32_t start_time_ms;         // Receive start time
     uint8_t* buffer;                // Receive buffer
     uint16_t buffer_size;           // Buffer capacity
+    uint8_t expect;                 // Next raw transaction: 0=none, 1=length, 2=data
+    uint8_t pending_sequence;       // Sequence from last FRAME_DATA
 } z1_multiframe_rx_t;
 
 /**
@@ -150,11 +196,47 @@ typedef struct {
  * Spike message structure
  */
 typedef struct {
-    uint32_t global_neuron_id;  // Bits [31:16] = node_id, [15:0] = local_id
+    uint32_t global_neuron_id;  // Node, backplane and local ID (see Global Neuron Addressing)
     uint32_t timestamp_us;      // Spike timestamp
     uint8_t flags;              // Spike flags
 } z1_spike_msg_t;
 
+/**
+ * Spike batch header (8 bytes)
+ * 
+ * Payload of Z1_CMD_SNN_SPIKE_BATCH: header followed by count entries.
+ * All spikes come from neurons on source_node.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  source_node;           // Node hosting the source neurons
+    uint8_t  flags;                 // Spike flags (shared by all entries)
+    uint16_t count;                 // Number of entries
+    uint32_t base_timestamp_us;     // Timestamp of entries with dt_steps = 0
+} z1_spike_batch_header_t;
+
+/**
+ * Spike batch entry (3 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t local_id;              // Source neuron local ID on source_node
+    uint8_t  dt_steps;              // Timesteps after base_timestamp_us
+} z1_spike_batch_entry_t;
+
+#define Z1_INPUT_VALUE_ONE      256     // z1_input_spike_t value of 1.0 (Q8.8)
+#define Z1_INPUT_BATCH_MAX      256     // Entries per Z1_CMD_SNN_INPUT_SPIKE payload (1 KB)
+
+/**
+ * Input spike (4 bytes)
+ *
+ * Payload of Z1_CMD_SNN_INPUT_SPIKE: entries back to back, all for neurons
+ * of the receiving node. The single-frame form carries a local ID below
+ * 256 in the data byte and injects 1.0.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t local_id;              // Target neuron on the receiving node
+    int16_t  value;                 // Added to the membrane potential (Q8.8)
+} z1_input_spike_t;
+
 /**
  * Weight update structure
  */
@@ -164,6 +246,42 @@ typedef struct {
     uint8_t new_weight;
 } z1_weight_update_t;
 
+// Weight patch record formats (z1_weight_patch_header_t.format)
+#define Z1_WEIGHT_PATCH_LIST    1   // count z1_weight_update_t entries
+#define Z1_WEIGHT_PATCH_VECTOR  2   // z1_weight_vector_t, then count weights
+
+#define Z1_WEIGHT_PATCH_MAX     2048  // Bytes per Z1_CMD_SNN_WEIGHT_UPDATE payload
+
+/**
+ * Weight patch record header (4 bytes)
+ *
+ * Payload of Z1_CMD_SNN_WEIGHT_UPDATE: one or more records back to back.
+ * LIST records set single synapses (synapse_idx 0-255); VECTOR records
+ * overwrite a run of one neuron's synapses, for rows of any length. The
+ * node answers with z1_weight_patch_result_t.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  format;                // Z1_WEIGHT_PATCH_*
+    uint8_t  node_id;               // Target node (POST /api/snn/weights); ignored by nodes
+    uint16_t count;                 // Entries (LIST) or weights (VECTOR)
+} z1_weight_patch_header_t;
+
+/**
+ * Weight vector position (4 bytes, follows a VECTOR record header)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t local_id;              // Target neuron
+    uint16_t first_synapse;         // Synapse the first weight goes to
+} z1_weight_vector_t;
+
+/**
+ * Weight patch result (response to Z1_CMD_SNN_WEIGHT_UPDATE)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t applied;               // Synapses updated
+    uint16_t rejected;              // Outside the loaded table, or refused while running
+} z1_weight_patch_result_t;
+
 /**
  * SNN activity query response
  */
@@ -174,6 +292,597 @@ typedef struct {
     uint32_t timestamp_us;
 } z1_snn_activity_t;
 
+// SNN timestep phases (z1_snn_phase_status_t order in z1_snn_status_t)
+#define Z1_SNN_PHASE_INGRESS    0   // Cross-core spike/input ring drain
+#define Z1_SNN_PHASE_DELIVERY   1   // Spike queue through the synapse index, delayed inputs
+#define Z1_SNN_PHASE_SWEEP      2   // Active neuron update
+#define Z1_SNN_PHASE_ROUTING    3   // Spike batch flush to remote nodes
+#define Z1_SNN_PHASE_FLUSH      4   // Cache and state write-back to PSRAM (on stop)
+#define Z1_SNN_PHASE_STALL      5   // Waiting on synapse index DMA, per step
+#define Z1_SNN_PHASE_STEP       6   // Whole timestep
+#define Z1_SNN_PHASE_COUNT      7
+
+#define Z1_SNN_STATUS_VERSION   3
+#define Z1_SNN_STATUS_BUCKETS   12  // log2 histogram buckets per phase
+
+/**
+ * Timing of one SNN phase (64 bytes)
+ *
+ * Bucket 0 counts samples below (1 << bucket_shift) counter ticks, bucket
+ * b counts [1 << (bucket_shift + b - 1), 1 << (bucket_shift + b)), and the
+ * last bucket everything above.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t samples;
+    uint32_t min_ticks;
+    uint32_t avg_ticks;
+    uint32_t max_ticks;
+    uint32_t buckets[Z1_SNN_STATUS_BUCKETS];
+} z1_snn_phase_status_t;
+
+/**
+ * Z1_CMD_SNN_GET_STATUS response payload (68 + 7 x 64 bytes)
+ *
+ * A node answers Z1_CMD_SNN_GET_STATUS (data bit 0 = reset timing after
+ * reading) with a multi-frame transfer of this structure under the same
+ * command code.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  version;               // Z1_SNN_STATUS_VERSION
+    uint8_t  running;
+    uint8_t  phase_count;           // Z1_SNN_PHASE_COUNT
+    uint8_t  bucket_shift;          // See z1_snn_phase_status_t
+    uint16_t ticks_per_us;          // Timing counter rate (CPU MHz, or 1 for µs)
+    uint16_t neuron_count;
+    uint16_t active_neurons;        // Neurons visited by the last step
+    uint16_t reserved;
+    uint32_t current_time_us;
+    uint32_t steps_completed;
+    uint32_t spikes_generated;
+    uint32_t spikes_received;
+    uint32_t spikes_processed;
+    uint32_t synapse_events;
+    uint32_t fanout_stalls;         // Index blocks still in flight when needed
+    uint32_t uptime_ms;             // Node time since boot
+    uint32_t cache_hits;            // Neuron cache (z1_neuron_cache_stats_t)
+    uint32_t cache_misses;
+    uint32_t cache_evictions;
+    uint32_t spikes_spilled;        // Queued spikes that overflowed to PSRAM
+    uint32_t spikes_dropped;        // Received spikes lost to a full queue
+    uint32_t credit_stalls;         // Batches held for a destination short of credit
+    z1_snn_phase_status_t phases[Z1_SNN_PHASE_COUNT];
+} z1_snn_status_t;
+
+/**
+ * Z1_CMD_SNN_GET_SPIKES request (multi-frame payload, 4 bytes)
+ *
+ * Records are consumed: each request continues where the last one ended.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t max_records;           // Records to return at most
+    uint8_t  flags;                 // Z1_SPIKE_READ_*
+    uint8_t  reserved;
+} z1_spike_read_req_t;
+
+#define Z1_SPIKE_READ_REWIND    0x01    // Restart from the oldest record still held
+
+/**
+ * Z1_CMD_SNN_GET_SPIKES response header (16 bytes), followed by count
+ * z1_spike_raster_t records in firing order
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t first_seq;             // Sequence number of the first record
+    uint32_t current_step;          // Node's completed timesteps when read
+    uint32_t pending;               // Records still unread after this response
+    uint16_t count;                 // Records in this response
+    uint8_t  flags;                 // Z1_SPIKE_RASTER_*
+    uint8_t  reserved;
+} z1_spike_raster_header_t;
+
+#define Z1_SPIKE_RASTER_OVERRUN     0x01    // Records were lost before first_seq
+#define Z1_SPIKE_RASTER_OUTPUT_ONLY 0x02    // Only Z1_NEURON_FLAG_OUTPUT neurons are recorded
+
+/**
+ * Spike raster record: [31:14] timestep (low 18 bits), [13:0] local neuron ID
+ */
+typedef uint32_t z1_spike_raster_t;
+
+#define Z1_SPIKE_RASTER_STEP_BITS   18
+
+static inline z1_spike_raster_t z1_spike_raster_pack(uint16_t local_id, uint32_t step) {
+    return (step << 14) | (local_id & 0x3FFF);
+}
+
+static inline uint16_t z1_spike_raster_id(z1_spike_raster_t rec) {
+    return rec & 0x3FFF;
+}
+
+/**
+ * Recover the full timestep of a record, given a step at or after it
+ * (less than 2^18 steps later), e.g. the header's current_step
+ */
+static inline uint32_t z1_spike_raster_step(z1_spike_raster_t rec, uint32_t current_step) {
+    uint32_t mask = (1u << Z1_SPIKE_RASTER_STEP_BITS) - 1;
+    return current_step - ((current_step - (rec >> 14)) & mask);
+}
+
+// ============================================================================
+// TDMA Spike Exchange
+// ============================================================================
+//
+// In a barrier run started with Z1_SNN_START_TDMA, each tick opens a round
+// of one slot per node in node_mask, in node ID order. A node sends its
+// spike batches only in its own slot and closes the slot with a
+// Z1_CMD_SNN_SLOT_DONE broadcast, which also serves as its STEP_DONE. The
+// next node starts on that marker, or at guard_us + rank * slot_us after the
+// tick if the marker does not come, so an idle node costs one marker and a
+// lost one at most a slot. The round ends with the last marker.
+
+/**
+ * Z1_CMD_SNN_TDMA payload (6 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t node_mask;             // Nodes with a slot (bit n = node n)
+    uint16_t slot_us;               // Slot length without a marker
+    uint16_t guard_us;              // Tick to the first slot
+} z1_snn_tdma_config_t;
+
+static inline uint8_t z1_snn_slot_done_data(uint8_t node_id, uint32_t step) {
+    return (uint8_t)((node_id << 4) | (step & 0x0F));
+}
+
+// ============================================================================
+// Firmware Distribution
+// ============================================================================
+
+// An image goes out once, chunk by chunk, to every target node (multicast);
+// each node reports which chunks it holds and only the gaps are resent:
+//
+//   FIRMWARE_BEGIN   z1_fw_begin_t                   clears the node's bitmap
+//   FIRMWARE_UPLOAD  z1_fw_chunk_t + data            stored if its CRC32 matches
+//   FIRMWARE_STATUS  -> z1_fw_status_t               bitmap of stored chunks
+//   FIRMWARE_VERIFY  z1_fw_verify_t                  whole-image CRC32 check
+//
+// CRC32 is z1_crc32() (z1_crc32.h), the bootloader's image checksum.
+
+#define Z1_FW_CHUNK_SIZE        1024    // Image bytes per chunk (last one may be short)
+#define Z1_FW_MAX_CHUNKS        128     // 128 KB, the bootloader's firmware buffer
+#define Z1_FW_BITMAP_BYTES      (Z1_FW_MAX_CHUNKS / 8)
+
+/**
+ * Z1_CMD_FIRMWARE_BEGIN payload (12 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t session;               // Transfer ID, repeated in every chunk
+    uint32_t image_size;            // Bytes in the image
+    uint16_t chunk_count;
+    uint16_t chunk_size;            // Z1_FW_CHUNK_SIZE
+} z1_fw_begin_t;
+
+/**
+ * Z1_CMD_FIRMWARE_UPLOAD payload header (12 bytes, chunk data follows)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t session;
+    uint16_t index;                 // Chunk number
+    uint16_t length;                // Data bytes after this header
+    uint32_t crc32;                 // z1_crc32() of the data
+} z1_fw_chunk_t;
+
+/**
+ * Z1_CMD_FIRMWARE_VERIFY payload (8 bytes)
+ *
+ * The node checks the stored image in its main loop; the result shows in
+ * the flags of the next status.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t session;
+    uint32_t image_crc32;           // z1_crc32() of the whole image
+} z1_fw_verify_t;
+
+/**
+ * Z1_CMD_FIRMWARE_STATUS response payload (16 + Z1_FW_BITMAP_BYTES bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t session;               // 0 before the first FIRMWARE_BEGIN
+    uint16_t chunk_count;
+    uint16_t received;              // Chunks stored
+    uint8_t  flags;                 // Z1_FW_STATUS_*
+    uint8_t  reserved[3];
+    uint32_t crc_errors;            // Chunks dropped for a bad CRC32
+    uint8_t  bitmap[Z1_FW_BITMAP_BYTES];  // Bit i of byte i/8: chunk i stored
+} z1_fw_status_t;
+
+#define Z1_FW_STATUS_COMPLETE       0x01    // Every chunk stored
+#define Z1_FW_STATUS_VERIFYING      0x02    // VERIFY received, check pending
+#define Z1_FW_STATUS_VERIFIED       0x04    // Image CRC32 matched
+#define Z1_FW_STATUS_BAD_IMAGE      0x08    // Image CRC32 did not match
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+// A node runs a benchmark in its main loop when it receives Z1_CMD_BENCH
+// with a z1_bench_req_t (or test as the data byte, all parameters default)
+// and answers with the result structure of the test under the same command.
+// Every result starts with the test and a Z1_BENCH_STATUS_* byte; a refused
+// request gets its result structure with only those two set (an unknown
+// test a z1_bench_sink_result_t).
+//
+// Bus throughput is measured from the controller: it sends Z1_CMD_BENCH_SINK
+// traffic, which the node only counts, then reads the counts back with
+// Z1_BENCH_SINK to see how much arrived.
+
+#define Z1_BENCH_SNN            1       // Synthetic network, timed steps
+#define Z1_BENCH_PSRAM          2       // PSRAM bandwidth, XIP memcpy vs DMA
+#define Z1_BENCH_SINK           3       // Read the BENCH_SINK counters
+
+#define Z1_BENCH_STATUS_OK          0
+#define Z1_BENCH_STATUS_BUSY        1   // SNN running (Z1_BENCH_SNN, Z1_BENCH_PSRAM)
+#define Z1_BENCH_STATUS_BAD_PARAMS  2   // Parameters do not fit this node
+#define Z1_BENCH_STATUS_FAILED      3   // Load, transfer or step timeout
+
+#define Z1_BENCH_SINK_CLEAR     0x01    // z1_bench_req_t flags: zero the counters after reading
+#define Z1_BENCH_SINK_MAX       4096    // Largest BENCH_SINK payload (node receive buffer)
+
+/**
+ * Z1_CMD_BENCH request (multi-frame payload, 16 bytes)
+ *
+ * Zero fields take the node's defaults (see z1_bench.h).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  test;                  // Z1_BENCH_*
+    uint8_t  flags;                 // Z1_BENCH_SINK_CLEAR
+    uint16_t neurons;               // SNN: network size
+    uint16_t fan_in;                // SNN: synapses per neuron
+    uint16_t rate;                  // SNN: neurons driven per step, per mille
+    uint32_t steps;                 // SNN: timesteps to run
+    uint32_t bytes;                 // PSRAM: bytes per pass
+} z1_bench_req_t;
+
+/**
+ * Z1_BENCH_SNN result (32 bytes)
+ *
+ * The synthetic network replaces the loaded one; it is built in the deploy
+ * staging area. run_us covers the timed steps only.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  test;
+    uint8_t  status;                // Z1_BENCH_STATUS_*
+    uint16_t neurons;
+    uint16_t fan_in;
+    uint16_t rate;
+    uint32_t steps;                 // Steps completed
+    uint32_t setup_us;              // Generating and loading the network
+    uint32_t run_us;
+    uint32_t spikes;                // Spikes generated during the run
+    uint32_t synapse_events;        // Synapse index target updates
+    uint32_t inputs;                // Suprathreshold inputs injected
+} z1_bench_snn_result_t;
+
+/**
+ * Z1_BENCH_PSRAM result (24 bytes)
+ *
+ * Each pass moves bytes between SRAM and the deploy staging area in
+ * block_size pieces; the XIP passes use psram_read()/psram_write(), the DMA
+ * passes psram_read_async()/psram_write_async().
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  test;
+    uint8_t  status;
+    uint16_t block_size;
+    uint32_t bytes;
+    uint32_t xip_read_us;
+    uint32_t xip_write_us;
+    uint32_t dma_read_us;
+    uint32_t dma_write_us;
+} z1_bench_psram_result_t;
+
+/**
+ * Z1_BENCH_SINK result (12 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  test;
+    uint8_t  status;
+    uint16_t reserved;
+    uint32_t transfers;             // Single frames plus completed multi-frame payloads
+    uint32_t bytes;                 // Payload bytes (1 per single frame)
+} z1_bench_sink_result_t;
+
+// ============================================================================
+// Memory Hashing
+// ============================================================================
+
+#define Z1_MEM_HASH_CHUNK       1024    // Bytes per chunk hash
+#define Z1_MEM_HASH_MAX         256     // Hashes per response (256 KB of memory)
+
+/**
+ * Z1_CMD_MEM_HASH request (multi-frame payload, 8 bytes)
+ *
+ * The response is one uint32_t z1_hash32() per Z1_MEM_HASH_CHUNK bytes of
+ * the range, the last chunk possibly short, at most Z1_MEM_HASH_MAX. An
+ * invalid range gets no response.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t addr;                  // Host address (0x20000000 PSRAM window)
+    uint32_t length;                // Bytes to hash
+} z1_mem_hash_req_t;
+
+#define Z1_HASH32_INIT          0x811C9DC5u
+
+/**
+ * Continue a 32-bit FNV-1a hash over more data (start from Z1_HASH32_INIT)
+ */
+static inline uint32_t z1_hash32_update(uint32_t hash, const uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 0x01000193u;
+    }
+    return hash;
+}
+
+static inline uint32_t z1_hash32(const uint8_t* data, uint32_t length) {
+    return z1_hash32_update(Z1_HASH32_INIT, data, length);
+}
+
+// ============================================================================
+// Memory Read-Back
+// ============================================================================
+
+#define Z1_MEM_READ_BLOCK       1024    // Data bytes per MEM_READ_DATA transfer
+#define Z1_MEM_READ_WINDOW      8       // Blocks a node sends ahead of the last ack
+#define Z1_MEM_READ_TIMEOUT_MS  500     // Node abandons a read left this long without an ack
+#define Z1_MEM_READ_INVALID     0xFFFFFFFFu  // Offset of the answer to an invalid range
+
+/**
+ * Z1_CMD_MEM_READ_REQ request (multi-frame payload, 8 bytes)
+ *
+ * The node streams the range back as burst transfers of Z1_CMD_MEM_READ_DATA
+ * [offset:4][data], in order and Z1_MEM_READ_BLOCK data bytes each except
+ * the last. At most Z1_MEM_READ_WINDOW blocks are outstanding: the reader
+ * sends Z1_CMD_MEM_READ_ACK with the number of blocks it has taken (mod 256)
+ * as it makes room. A range outside PSRAM is answered with one transfer
+ * holding only the offset Z1_MEM_READ_INVALID. A new request replaces the
+ * read in progress; length 0 cancels it.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t addr;                  // Host address (0x20000000 PSRAM window)
+    uint32_t length;                // Bytes to read
+} z1_mem_read_req_t;
+
+// ============================================================================
+// SNN Checkpoints
+// ============================================================================
+
+// A checkpoint holds what a run changed on a stopped node, not what its
+// deployed table already gives it: membrane potentials, refractory time
+// left, STDP traces and the weights of synapse index rows learned since
+// the table was loaded. Z1_CMD_SNN_CHECKPOINT with Z1_SNN_CKPT_SAVE is not
+// answered, so it can be broadcast and every node serializes at once into
+// its deploy staging area (host 0x20100000, replacing the staged table).
+// Z1_SNN_CKPT_QUERY answers with the z1_snn_ckpt_info_t of the last save,
+// after a save still in progress; the image is then read back with
+// Z1_CMD_MEM_READ_REQ.
+//
+// To restore, the image is written back to the staging area of a node with
+// the same network loaded and Z1_CMD_SNN_RESTORE applies it, answering with
+// the z1_snn_ckpt_info_t of the image. The next Z1_CMD_SNN_START resumes
+// from the restored state with time and steps counted from zero; spikes in
+// flight at the save are not part of it.
+//
+// Image: z1_snn_ckpt_header_t, neuron_count z1_snn_ckpt_neuron_t, rows
+// uint16_t pre traces (Q12, one per synapse index row), then learned_rows
+// records of [row:2][count:2][count weight bytes] in index order.
+
+#define Z1_SNN_CKPT_QUERY           0       // Z1_CMD_SNN_CHECKPOINT data
+#define Z1_SNN_CKPT_SAVE            1
+
+#define Z1_SNN_CKPT_ADDR            0x20100000u  // Image on the node (host address of the staging area)
+#define Z1_SNN_CKPT_MAGIC           0x4B43315Au  // "Z1CK"
+#define Z1_SNN_CKPT_VERSION         1
+
+#define Z1_SNN_CKPT_STATUS_OK           0
+#define Z1_SNN_CKPT_STATUS_NONE         1   // Nothing saved since boot
+#define Z1_SNN_CKPT_STATUS_BUSY         2   // SNN running
+#define Z1_SNN_CKPT_STATUS_NO_NETWORK   3
+#define Z1_SNN_CKPT_STATUS_TOO_LARGE    4   // Image does not fit the staging area
+#define Z1_SNN_CKPT_STATUS_BAD_IMAGE    5   // Magic, version, length or CRC32 wrong
+#define Z1_SNN_CKPT_STATUS_MISMATCH     6   // Saved from a different network
+#define Z1_SNN_CKPT_STATUS_FAILED       7   // PSRAM access failed
+
+/**
+ * Checkpoint image header (32 bytes)
+ *
+ * topology is a z1_hash32() of what the image relies on without carrying
+ * it: neuron flags and refractory periods, and the source and length of
+ * every synapse index row. crc32 is the z1_crc32() of the bytes after the
+ * header.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                 // Z1_SNN_CKPT_MAGIC
+    uint8_t  version;               // Z1_SNN_CKPT_VERSION
+    uint8_t  reserved;
+    uint16_t neuron_count;
+    uint32_t topology;
+    uint32_t steps;                 // Steps completed when saved
+    uint32_t rng;                   // STDP rounding state
+    uint16_t rows;                  // Pre trace records (0 without STDP)
+    uint16_t learned_rows;          // Learned row records
+    uint32_t length;                // Whole image, header included
+    uint32_t crc32;
+} z1_snn_ckpt_header_t;
+
+/**
+ * Per-neuron checkpoint record (10 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    float    potential;             // Membrane potential
+    uint32_t refractory_us;         // Refractory time left
+    uint16_t post_trace;            // STDP post trace (Q12)
+} z1_snn_ckpt_neuron_t;
+
+/**
+ * Z1_SNN_CKPT_QUERY and Z1_CMD_SNN_RESTORE answer (24 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  status;                // Z1_SNN_CKPT_STATUS_*
+    uint8_t  version;
+    uint16_t neuron_count;
+    uint32_t length;                // Image bytes at the staging area start
+    uint32_t crc32;                 // Header crc32 of the image
+    uint32_t topology;
+    uint32_t steps;
+    uint16_t learned_rows;
+    uint16_t reserved;
+} z1_snn_ckpt_info_t;
+
+// ============================================================================
+// Batch Inference
+// ============================================================================
+
+// A batch run presents samples one after another with no controller
+// traffic between them. The inputs of every sample are staged on each node
+// of the network first, in its deploy staging area (host 0x20100000,
+// replacing the staged table as a checkpoint does), and Z1_CMD_SNN_START
+// with Z1_SNN_START_BATCH runs them: each sample gets steps_per_sample
+// steps, its inputs are added at the start of their steps, the spikes of
+// the output neurons (Z1_NEURON_FLAG_OUTPUT) are counted, and before the
+// next sample the run state is cleared in SRAM without reloading the table.
+// Spikes from an earlier sample still in flight are dropped by timestamp.
+//
+// Batch runs use logical time (step * timestep). Without Z1_SNN_START_SYNC
+// a node steps as fast as it can, which suits networks on one node; a
+// network spread over several nodes needs the barrier so that they all
+// change sample at the same step. Once the last sample is done the node
+// stops stepping until told to stop.
+//
+// Z1_CMD_SNN_BATCH answers with z1_snn_batch_info_t: the staging capacity,
+// progress, and where the results are; they are read back with
+// Z1_CMD_MEM_READ_REQ and grow by one record per finished sample.
+//
+// Image: z1_snn_batch_header_t, then input_count z1_snn_batch_input_t in
+// (sample, step) order. Results, 4-byte aligned after the image:
+// z1_snn_batch_results_t, output_count z1_snn_batch_output_t in local ID
+// order, then per sample output_count uint16_t spike counts (saturating).
+
+#define Z1_SNN_BATCH_ADDR           0x20100000u  // Image on the node (host address of the staging area)
+#define Z1_SNN_BATCH_MAGIC          0x4942315Au  // "Z1BI"
+#define Z1_SNN_BATCH_RESULTS_MAGIC  0x5242315Au  // "Z1BR"
+#define Z1_SNN_BATCH_VERSION        1
+#define Z1_SNN_BATCH_MAX_OUTPUTS    256     // Output neurons counted per node
+#define Z1_SNN_BATCH_HOLD           0x8000  // z1_snn_batch_input_t.step: repeat every step to the end of the sample
+
+#define Z1_SNN_BATCH_STATUS_OK          0
+#define Z1_SNN_BATCH_STATUS_NONE        1   // No batch started since the table was loaded
+#define Z1_SNN_BATCH_STATUS_NO_NETWORK  2
+#define Z1_SNN_BATCH_STATUS_BAD_IMAGE   3   // Magic, version, length, order or CRC32 wrong
+#define Z1_SNN_BATCH_STATUS_TOO_LARGE   4   // Results do not fit behind the image
+#define Z1_SNN_BATCH_STATUS_NO_OUTPUTS  5   // No Z1_NEURON_FLAG_OUTPUT neuron, or too many
+#define Z1_SNN_BATCH_STATUS_FAILED      6   // PSRAM access failed
+
+/**
+ * Batch image header (24 bytes)
+ *
+ * crc32 is the z1_crc32() of the bytes after the header.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                 // Z1_SNN_BATCH_MAGIC
+    uint8_t  version;               // Z1_SNN_BATCH_VERSION
+    uint8_t  reserved;
+    uint16_t steps_per_sample;
+    uint16_t sample_count;
+    uint16_t reserved2;
+    uint32_t input_count;
+    uint32_t length;                // Whole image, header included
+    uint32_t crc32;
+} z1_snn_batch_header_t;
+
+/**
+ * Staged input (8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t sample;
+    uint16_t step;                  // Step within the sample, | Z1_SNN_BATCH_HOLD
+    uint16_t local_id;              // Target neuron on the node
+    int16_t  value;                 // Added to the membrane potential (Q8.8)
+} z1_snn_batch_input_t;
+
+/**
+ * Batch results header (16 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                 // Z1_SNN_BATCH_RESULTS_MAGIC
+    uint8_t  node_id;
+    uint8_t  reserved;
+    uint16_t output_count;
+    uint16_t sample_count;          // Samples with counts below
+    uint16_t steps_per_sample;
+    uint32_t reserved2;
+} z1_snn_batch_results_t;
+
+/**
+ * Output neuron of the results (8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t local_id;
+    uint16_t reserved;
+    uint32_t global_id;             // From the neuron table
+} z1_snn_batch_output_t;
+
+/**
+ * Z1_CMD_SNN_BATCH answer (28 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  status;                // Z1_SNN_BATCH_STATUS_*
+    uint8_t  version;
+    uint16_t output_count;
+    uint16_t sample_count;
+    uint16_t samples_done;
+    uint16_t steps_per_sample;
+    uint16_t held_dropped;          // HOLD inputs beyond the node's held list
+    uint32_t capacity;              // Staging bytes for the image and its results
+    uint32_t results_addr;          // Host address of z1_snn_batch_results_t
+    uint32_t results_length;        // Result bytes of the finished samples
+    uint32_t steps;                 // Steps completed
+} z1_snn_batch_info_t;
+
+// ============================================================================
+// Global Neuron Addressing
+// ============================================================================
+//
+// A spike source, on the bus and in the 20-bit source field of a synapse,
+// is [19:16] node, [15:13] backplane, [12:0] local ID. The backplane field
+// is the source backplane XOR the backplane of the node that sees the ID,
+// so sources on the own backplane keep the (node << 16) | local IDs nodes
+// have always used and nodes never need to know their backplane number.
+// Local IDs stay below Z1_GLOBAL_LOCAL_LIMIT, the v2 engine's maximum capacity.
+//
+// Nodes only send field 0. A neuron with targets on other backplanes has
+// Z1_NEURON_FLAG_GATEWAY, so its spikes also go to the controller, which
+// relays them once per step to the peer controllers in batched datagrams
+// (z1_gateway.h). The receiving controller sets the field and passes them
+// on to its nodes as ordinary spike batches.
+
+#define Z1_MAX_BACKPLANES           8
+#define Z1_GLOBAL_LOCAL_BITS        13
+#define Z1_GLOBAL_LOCAL_LIMIT       (1u << Z1_GLOBAL_LOCAL_BITS)
+
+static inline uint32_t z1_global_id(uint8_t backplane_field, uint8_t node, uint16_t local_id) {
+    return ((uint32_t)(node & 0x0F) << 16) | ((uint32_t)(backplane_field & 0x07) << Z1_GLOBAL_LOCAL_BITS) |
+           (local_id & (Z1_GLOBAL_LOCAL_LIMIT - 1));
+}
+
+static inline uint8_t z1_global_node(uint32_t id) {
+    return (uint8_t)((id >> 16) & 0x0F);
+}
+
+static inline uint8_t z1_global_backplane_field(uint32_t id) {
+    return (uint8_t)((id >> Z1_GLOBAL_LOCAL_BITS) & 0x07);
+}
+
+static inline uint16_t z1_global_local(uint32_t id) {
+    return (uint16_t)(id & (Z1_GLOBAL_LOCAL_LIMIT - 1));
+}
+
 #endif // Z1_PROTOCOL_H
 
 // Firmware constants
@@ -20,6 +20,28 @@
 // Extended Protocol Functions (Controller-Side)
 // ============================================================================
 
+/**
+ * Prepare the receive path for node responses (call after z1_bus_init)
+ */
+bool z1_protocol_init(void);
+
+/**
+ * Send a command and wait for the node's multi-frame response
+ *
+ * The response must come from node_id under the same command code.
+ *
+ * @param node_id Target node
+ * @param command Command code
+ * @param data Request payload (one byte goes as the command's data byte)
+ * @param length Request payload length
+ * @param response Buffer for the response payload
+ * @param response_size Buffer capacity
+ * @param timeout_ms Time to wait for the response
+ * @return Response length, or -1 on send failure or timeout
+ */
+int z1_bus_request(uint8_t node_id, uint8_t command, const uint8_t* data, uint16_t length,
+                   uint8_t* response, uint16_t response_size, uint32_t timeout_ms);
+
 /**
  * Send spike to target node
  */
@@ -51,12 +73,184 @@ bool z1_bus_ping_node(uint8_t node_id);
  * Memory operations
  */
 int z1_read_node_memory(uint8_t node_id, uint32_t addr, uint8_t* buffer, uint16_t length);
+int z1_write_node_memory(uint8_t node_id, uint32_t addr, const uint8_t* data, uint16_t length);
+
+/**
+ * Streamed memory read-back (Z1_CMD_MEM_READ_REQ): begin asks the node for
+ * the range, next returns the following bytes as they arrive (0 at the end,
+ * -1 on an invalid range, a corrupt block or timeout_ms without data) and
+ * acknowledges each block taken so the node keeps its window full. end
+ * cancels an unfinished read. One read at a time.
+ */
+#define Z1_MEM_READ_NEXT_TIMEOUT_MS 200
+bool z1_mem_read_begin(uint8_t node_id, uint32_t addr, uint32_t length);
+int z1_mem_read_next(uint8_t* buffer, uint16_t size, uint32_t timeout_ms);
+void z1_mem_read_end(void);
+int z1_query_mem_hashes(uint8_t node_id, uint32_t addr, uint32_t length,
+                        uint32_t* hashes, uint16_t max_hashes);
 
 /**
  * SNN coordination
  */
 bool z1_query_snn_activity(uint8_t node_id, z1_snn_activity_t* activity);
+bool z1_update_weight(uint8_t node_id, const z1_weight_update_t* update);
+bool z1_patch_weights(uint8_t node_id, const uint8_t* patch, uint16_t length,
+                      z1_weight_patch_result_t* result);
+bool z1_query_snn_status(uint8_t node_id, bool reset_timing, z1_snn_status_t* status);
+int z1_query_snn_spikes(uint8_t node_id, uint16_t max_records, uint8_t flags,
+                        z1_spike_raster_header_t* header, z1_spike_raster_t* records);
 bool z1_start_snn_all(void);
 bool z1_stop_snn_all(void);
 
+// ============================================================================
+// Timestep Barrier (Controller-Side)
+// ============================================================================
+
+#ifndef Z1_SNN_TICK_HOLD_US
+#define Z1_SNN_TICK_HOLD_US     200     // BUSATTN hold of a Z1_CMD_SNN_TICK broadcast
+#endif
+
+#ifndef Z1_SNN_SYNC_TIMEOUT_US
+#define Z1_SNN_SYNC_TIMEOUT_US  20000   // Repeat a tick not answered by every node
+#endif
+
+#ifndef Z1_SNN_TDMA_GUARD_US
+#define Z1_SNN_TDMA_GUARD_US    1000    // Default tick to first TDMA slot (step compute time)
+#endif
+
+/**
+ * Barrier statistics
+ */
+typedef struct {
+    bool active;                // Barrier run in progress
+    uint16_t node_mask;         // Nodes taking part
+    uint32_t period_us;         // Minimum tick spacing (0 = as fast as the slowest node)
+    uint16_t slot_us;           // TDMA slot length (0 = spikes sent on contention)
+    uint32_t step;              // Last step released
+    uint32_t steps_done;        // Steps every node has reported
+    uint32_t retries;           // Ticks repeated after a timeout
+    uint32_t last_step_us;      // Tick to last STEP_DONE of the last finished step
+    uint32_t avg_step_us;
+    uint32_t max_step_us;
+    uint8_t slowest_node;       // Last node to report the last finished step
+} z1_snn_sync_stats_t;
+
+/**
+ * Start SNN execution in barrier mode
+ *
+ * Nodes step only on Z1_CMD_SNN_TICK. Step k + 1 is released once every
+ * node in node_mask has reported step k with Z1_CMD_SNN_STEP_DONE, and no
+ * sooner than period_us after step k. z1_snn_sync_service() drives the
+ * ticks; z1_stop_snn_all() ends the run.
+ *
+ * With a TDMA schedule the nodes send their spikes in turn, one slot each
+ * in node ID order, and report with a Z1_CMD_SNN_SLOT_DONE marker instead
+ * (see z1_protocol.h).
+ *
+ * @param node_mask Nodes with a loaded network (bit n = node n)
+ * @param period_us Minimum tick spacing; 0 runs as fast as the slowest node
+ * @param tdma Slot and guard length (node_mask is filled in), NULL to send on contention
+ * @return true if the start broadcast went out
+ */
+bool z1_start_snn_sync(uint16_t node_mask, uint32_t period_us, const z1_snn_tdma_config_t* tdma);
+
+/**
+ * Start the staged batch run (see "Batch Inference" in z1_protocol.h)
+ *
+ * Only the nodes in node_mask are started. With sync they run on the
+ * barrier, which stops releasing after the last step of the batch; a batch
+ * spread over several nodes needs it. Without, each node runs its batch on
+ * its own as fast as it can.
+ *
+ * @param node_mask Nodes with a staged batch
+ * @param sync Step on the barrier
+ * @param steps Steps of the batch (samples * steps per sample)
+ * @return true if the start broadcast went out
+ */
+bool z1_start_snn_batch(uint16_t node_mask, bool sync, uint32_t steps);
+
+/**
+ * Release the next step when due (controller main loop)
+ */
+void z1_snn_sync_service(void);
+
+/**
+ * Check whether a barrier run is in progress
+ *
+ * @return true while ticks are being driven
+ */
+bool z1_snn_sync_active(void);
+
+/**
+ * Get barrier statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_snn_sync_get_stats(z1_snn_sync_stats_t* stats);
+
+// ============================================================================
+// Benchmarks (Controller-Side)
+// ============================================================================
+
+#ifndef Z1_BENCH_TIMEOUT_MS
+#define Z1_BENCH_TIMEOUT_MS     30000   // Longest node benchmark (result wait)
+#endif
+
+#define Z1_BENCH_CHUNKED_MAX    256     // Chunked payload limit (multi-frame send timeout)
+
+/**
+ * Bus benchmark transfer modes
+ */
+typedef enum {
+    Z1_BENCH_BUS_WRITE = 0,     // z1_bus_write(): one frame, one data byte
+    Z1_BENCH_BUS_CHUNKED,       // z1_send_multiframe_chunked()
+    Z1_BENCH_BUS_BURST,         // z1_send_multiframe_burst()
+    Z1_BENCH_BUS_MODES
+} z1_bench_bus_mode_t;
+
+/**
+ * Bus benchmark result
+ */
+typedef struct {
+    uint8_t mode;                   // z1_bench_bus_mode_t
+    uint16_t payload;               // Bytes per transfer
+    uint32_t transfers;             // Transfers sent successfully
+    uint32_t failed;                // Transfers the bus rejected
+    uint32_t bytes;                 // Payload bytes sent
+    uint32_t elapsed_us;
+    bool delivered_valid;           // Node counters read back
+    uint32_t delivered_transfers;   // Transfers the node counted
+    uint32_t delivered_bytes;
+} z1_bench_bus_result_t;
+
+/**
+ * Run a benchmark on a node (Z1_CMD_BENCH)
+ *
+ * Blocks until the node answers, up to Z1_BENCH_TIMEOUT_MS.
+ *
+ * @param node_id Target node
+ * @param req Benchmark request
+ * @param result Buffer for the result structure of the test
+ * @param size Buffer capacity
+ * @return Result length, or -1 if the node did not answer
+ */
+int z1_query_bench(uint8_t node_id, const z1_bench_req_t* req, uint8_t* result, uint16_t size);
+
+/**
+ * Measure bus throughput to a node
+ *
+ * Sends count transfers of Z1_CMD_BENCH_SINK traffic, timing only the
+ * sends, then reads the node's counters to see how much arrived.
+ *
+ * @param node_id Target node
+ * @param mode Transfer mode
+ * @param payload Bytes per transfer (ignored for Z1_BENCH_BUS_WRITE; at
+ *                most Z1_BENCH_SINK_MAX, Z1_BENCH_CHUNKED_MAX when chunked)
+ * @param count Transfers to send
+ * @param result Result to fill
+ * @return false if the node did not answer the counter reset
+ */
+bool z1_bench_bus(uint8_t node_id, z1_bench_bus_mode_t mode, uint16_t payload, uint32_t count,
+                  z1_bench_bus_result_t* result);
+
 #endif // Z1_PROTOCOL_EXTENDED_H
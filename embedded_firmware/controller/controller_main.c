@@ -17,6 +17,8 @@
 
 // Project headers
 #include "w5500_http_server.h"
+#include "z1_udp_spikes.h"
+#include "z1_telemetry.h"
 #include "z1_matrix_bus.h"
 #include "z1_protocol_extended.h"
 #include "z1_display.h"
@@ -107,6 +109,7 @@ int main(void) {
         set_led_color(255, 0, 0);  // Red = error
         while (1) sleep_ms(1000);
     }
+    z1_protocol_init();  // Node responses (ping, status) land here
     printf("[Init] ✅ Matrix bus OK\n");
     
     // Discover nodes
@@ -123,6 +126,7 @@ int main(void) {
         }
     }
     printf("[Init] ✅ Found %d nodes\n", active_node_count);
+    z1_telemetry_init(active_nodes);  // Kept current by the HTTP server loop
     z1_display_nodes(active_node_count, 16);
     sleep_ms(1000);
     
@@ -144,6 +148,11 @@ int main(void) {
         while (1) sleep_ms(1000);
     }
     
+    // UDP spike channel (HTTP keeps working without it)
+    if (!z1_udp_spikes_init()) {
+        printf("[Init] ⚠️  UDP spike channel unavailable\n");
+    }
+    
     set_led_color(0, 0, 255);  // Blue = ready
     
     printf("\n");
@@ -161,6 +170,7 @@ int main(void) {
     printf("║    POST /api/snn/start                                     ║\n");
     printf("║    POST /api/snn/stop                                      ║\n");
     printf("║    POST /api/snn/input                                     ║\n");
+    printf("║  UDP Spikes:  port 5005                                    ║\n");
     printf("╚════════════════════════════════════════════════════════════╝\n");
     printf("\n");
     
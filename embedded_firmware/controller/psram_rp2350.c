@@ -6,6 +6,10 @@
 #include "hardware/regs/xip.h"
 #include "hardware/structs/qmi.h"
 #include "hardware/structs/xip_ctrl.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include <string.h>
 #include <stdio.h>
 
 // Private state variables
@@ -410,3 +414,132 @@ bool psram_write(uint32_t address, const void* buffer, size_t length) {
     
     return true;
 }
+
+// Asynchronous DMA transfers
+
+// DMA_IRQ_0 is left to other users (bus backend, SDK); completions use DMA_IRQ_1
+#define PSRAM_DMA_IRQ_INDEX 1
+
+static psram_dma_handle_t* volatile dma_handles[NUM_DMA_CHANNELS];
+static bool dma_irq_installed = false;
+
+static bool psram_range_valid(uint32_t address, size_t length) {
+    return psram_initialized && length > 0 &&
+           address >= psram_base_address &&
+           (address + length) <= (psram_base_address + psram_size);
+}
+
+static void psram_dma_irq_handler(void) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        psram_dma_handle_t* handle = dma_handles[ch];
+        if (!handle || !dma_irqn_get_channel_status(PSRAM_DMA_IRQ_INDEX, ch)) {
+            continue;
+        }
+        
+        dma_irqn_acknowledge_channel(PSRAM_DMA_IRQ_INDEX, ch);
+        dma_irqn_set_channel_enabled(PSRAM_DMA_IRQ_INDEX, ch, false);
+        dma_handles[ch] = NULL;
+        dma_channel_unclaim(ch);
+        
+        // Same ordering guarantee as psram_write()
+        __dsb();
+        
+        handle->channel = -1;
+        handle->busy = false;
+        if (handle->callback) {
+            handle->callback(handle->user_data);
+        }
+    }
+}
+
+static bool psram_dma_start(volatile void* dst, const volatile void* src, size_t length,
+                            psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    if (!handle) {
+        return false;
+    }
+    
+    psram_dma_wait(handle);
+    handle->callback = callback;
+    handle->user_data = user_data;
+    
+    if (!dma_irq_installed) {
+        irq_add_shared_handler(DMA_IRQ_1, psram_dma_irq_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        dma_irq_installed = true;
+    }
+    
+    int ch = dma_claim_unused_channel(false);
+    if (ch < 0) {
+        // No free channel: complete synchronously
+        memcpy((void*)dst, (const void*)src, length);
+        __dsb();
+        if (callback) {
+            callback(user_data);
+        }
+        return true;
+    }
+    
+    // Word transfers when everything is 4-byte aligned, bytes otherwise
+    bool words = (((uintptr_t)dst | (uintptr_t)src | length) & 3) == 0;
+    
+    dma_channel_config cfg = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&cfg, words ? DMA_SIZE_32 : DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, true);
+    
+    handle->channel = (int8_t)ch;
+    handle->busy = true;
+    dma_handles[ch] = handle;
+    
+    dma_irqn_acknowledge_channel(PSRAM_DMA_IRQ_INDEX, ch);
+    dma_irqn_set_channel_enabled(PSRAM_DMA_IRQ_INDEX, ch, true);
+    dma_channel_configure(ch, &cfg, dst, src, words ? length / 4 : length, true);
+    
+    return true;
+}
+
+bool psram_read_async(uint32_t address, void* buffer, size_t length,
+                      psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    if (!buffer || !psram_range_valid(address, length)) {
+        return false;
+    }
+    
+    return psram_dma_start(buffer, psram_get_pointer(address - psram_base_address), length,
+                           handle, callback, user_data);
+}
+
+bool psram_write_async(uint32_t address, const void* buffer, size_t length,
+                       psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    if (!buffer || !psram_range_valid(address, length)) {
+        return false;
+    }
+    
+    return psram_dma_start(psram_get_pointer(address - psram_base_address), buffer, length,
+                           handle, callback, user_data);
+}
+
+bool psram_copy_async(uint32_t dst_address, uint32_t src_address, size_t length,
+                      psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    if (!psram_range_valid(dst_address, length) || !psram_range_valid(src_address, length)) {
+        return false;
+    }
+    
+    return psram_dma_start(psram_get_pointer(dst_address - psram_base_address),
+                           psram_get_pointer(src_address - psram_base_address), length,
+                           handle, callback, user_data);
+}
+
+bool psram_dma_busy(const psram_dma_handle_t* handle) {
+    return handle && handle->busy;
+}
+
+void psram_dma_wait(psram_dma_handle_t* handle) {
+    if (!handle) {
+        return;
+    }
+    
+    while (handle->busy) {
+        tight_loop_contents();
+    }
+}
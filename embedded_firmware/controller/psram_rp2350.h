@@ -136,6 +136,90 @@ bool psram_read(uint32_t address, void* buffer, size_t length);
  */
 bool psram_write(uint32_t address, const void* buffer, size_t length);
 
+/**
+ * @brief Completion callback for asynchronous PSRAM transfers
+ * 
+ * Called from the DMA interrupt handler once the transfer has finished.
+ * 
+ * @param user_data Pointer passed when the transfer was started
+ */
+typedef void (*psram_dma_callback_t)(void* user_data);
+
+/**
+ * @brief Asynchronous PSRAM transfer handle
+ * 
+ * Zero-initialize before first use. A handle tracks one transfer at a time;
+ * starting a new transfer on a busy handle waits for the previous one.
+ */
+typedef struct {
+    volatile bool busy;             // Transfer in flight
+    int8_t channel;                 // DMA channel while busy
+    psram_dma_callback_t callback;  // Optional completion callback
+    void* user_data;                // Callback argument
+} psram_dma_handle_t;
+
+/**
+ * @brief Start DMA read from PSRAM
+ * 
+ * The buffer must stay valid until the transfer completes. If no DMA
+ * channel is free the copy is done synchronously before returning.
+ * 
+ * @param address PSRAM address to read from
+ * @param buffer Buffer to store read data
+ * @param length Number of bytes to read
+ * @param handle Transfer handle (poll with psram_dma_busy/psram_dma_wait)
+ * @param callback Completion callback, or NULL
+ * @param user_data Callback argument
+ * @return true if the transfer was started
+ */
+bool psram_read_async(uint32_t address, void* buffer, size_t length,
+                      psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data);
+
+/**
+ * @brief Start DMA write to PSRAM
+ * 
+ * @param address PSRAM address to write to
+ * @param buffer Buffer containing data to write (must stay valid until complete)
+ * @param length Number of bytes to write
+ * @param handle Transfer handle
+ * @param callback Completion callback, or NULL
+ * @param user_data Callback argument
+ * @return true if the transfer was started
+ */
+bool psram_write_async(uint32_t address, const void* buffer, size_t length,
+                       psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data);
+
+/**
+ * @brief Start DMA copy within PSRAM
+ * 
+ * @param dst_address PSRAM destination address
+ * @param src_address PSRAM source address (ranges must not overlap)
+ * @param length Number of bytes to copy
+ * @param handle Transfer handle
+ * @param callback Completion callback, or NULL
+ * @param user_data Callback argument
+ * @return true if the transfer was started
+ */
+bool psram_copy_async(uint32_t dst_address, uint32_t src_address, size_t length,
+                      psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data);
+
+/**
+ * @brief Check whether an asynchronous transfer is still in flight
+ * 
+ * @param handle Transfer handle
+ * @return true while the transfer is running
+ */
+bool psram_dma_busy(const psram_dma_handle_t* handle);
+
+/**
+ * @brief Wait for an asynchronous transfer to complete
+ * 
+ * Returns immediately for an idle handle.
+ * 
+ * @param handle Transfer handle
+ */
+void psram_dma_wait(psram_dma_handle_t* handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 #include <stdlib.h>  // For malloc, free, and abs functions
 #include <stdio.h>   // For printf functions
 #include "pico/time.h" // For time_us_32()
+#include "hardware/dma.h"
 
 static i2c_inst_t *i2c_instance;
 static uint8_t buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
@@ -495,4 +496,107 @@ void ssd1306_draw_rect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, bool
             ssd1306_draw_pixel(x + width - 1, y + i, true);
         }
     }
-}
\ No newline at end of file
+}
+
+// DMA page updates. The pages to send are copied into a stream of I2C
+// data_cmd words, one transaction per run of consecutive pages: each
+// addressing command behind a 0x80 control byte, then 0x40 and the page
+// data, STOP on the last byte. The frame buffer can be redrawn as soon as
+// the transfer has started.
+#define SSD1306_DMA_TIMEOUT_US 1000000
+
+static int dma_channel = -1;
+static uint16_t dma_stream[SSD1306_PAGES * (13 + SSD1306_WIDTH)];
+static uint32_t dma_start_us = 0;
+static bool dma_failed = false;
+
+bool ssd1306_dma_init(void) {
+    dma_channel = dma_claim_unused_channel(false);
+    if (dma_channel < 0) {
+        printf("OLED: No free DMA channel for display updates\n");
+        return false;
+    }
+    return true;
+}
+
+uint8_t* ssd1306_get_buffer(void) {
+    return buffer;
+}
+
+bool ssd1306_update_pages_async(uint8_t page_mask) {
+    if (dma_channel < 0 || page_mask == 0 || ssd1306_update_busy(NULL)) {
+        return false;
+    }
+    
+    size_t n = 0;
+    uint8_t page = 0;
+    while (page < SSD1306_PAGES) {
+        if (!(page_mask & (1u << page))) {
+            page++;
+            continue;
+        }
+        uint8_t last = page;
+        while (last + 1 < SSD1306_PAGES && (page_mask & (1u << (last + 1)))) {
+            last++;
+        }
+    
+        const uint8_t commands[] = {SSD1306_COLUMNADDR, 0, SSD1306_WIDTH - 1,
+                                    SSD1306_PAGEADDR, page, last};
+        for (size_t i = 0; i < sizeof(commands); i++) {
+            dma_stream[n++] = 0x80;  // Control byte: one command follows
+            dma_stream[n++] = commands[i];
+        }
+        dma_stream[n++] = 0x40;      // Control byte: data up to the STOP
+        for (size_t i = page * SSD1306_WIDTH; i < (size_t)(last + 1) * SSD1306_WIDTH; i++) {
+            dma_stream[n++] = buffer[i];
+        }
+        dma_stream[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    
+        page = last + 1;
+    }
+    
+    // The SDK sets the target address per blocking call; set it for the stream
+    i2c_hw_t *hw = i2c_get_hw(i2c_instance);
+    hw->enable = 0;
+    hw->tar = SSD1306_I2C_ADDR;
+    hw->enable = 1;
+    
+    dma_channel_config c = dma_channel_get_default_config(dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_dreq(&c, i2c_get_dreq(i2c_instance, true));
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(dma_channel, &c, &hw->data_cmd, dma_stream, n, true);
+    
+    dma_start_us = time_us_32();
+    return true;
+}
+
+bool ssd1306_update_busy(bool *failed) {
+    if (dma_channel < 0) {
+        return false;
+    }
+    
+    i2c_hw_t *hw = i2c_get_hw(i2c_instance);
+    bool busy = dma_channel_is_busy(dma_channel) || !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+                (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS);
+    
+    if (busy && time_us_32() - dma_start_us > SSD1306_DMA_TIMEOUT_US) {
+        printf("OLED: DMA page update timed out\n");
+        dma_channel_abort(dma_channel);
+        dma_failed = true;
+        busy = false;
+    }
+    
+    // A NAK aborts the transaction and flushes what the DMA still writes
+    if (!busy && (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) {
+        (void)hw->clr_tx_abrt;
+        dma_failed = true;
+    }
+    
+    if (failed) {
+        *failed = dma_failed;
+        dma_failed = false;
+    }
+    return busy;
+}
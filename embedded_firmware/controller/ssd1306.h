@@ -71,4 +71,11 @@ void ssd1306_draw_pixel(uint8_t x, uint8_t y, bool on);
 void ssd1306_draw_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 void ssd1306_draw_rect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, bool filled);
 
+// Non-blocking page updates over I2C DMA (see ssd1306.c)
+#define SSD1306_PAGES (SSD1306_HEIGHT / 8)
+bool ssd1306_dma_init(void);
+uint8_t* ssd1306_get_buffer(void);
+bool ssd1306_update_pages_async(uint8_t page_mask);
+bool ssd1306_update_busy(bool *failed);
+
 #endif // SSD1306_H
\ No newline at end of file
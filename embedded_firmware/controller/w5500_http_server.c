@@ -9,13 +9,21 @@
 
 #include "w5500_http_server.h"
 #include "z1_http_api.h"
+#include "z1_protocol_extended.h"
 #include "z1_display.h"
+#include "z1_trace.h"
+#include "z1_udp_spikes.h"
+#include "z1_gateway.h"
+#include "z1_encoder.h"
+#include "z1_telemetry.h"
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <strings.h>
 
 // W5500 Pin Definitions
 #define W5500_SPI_PORT spi0
@@ -32,6 +40,8 @@
 #define W5500_GAR0       0x0001
 #define W5500_SUBR0      0x0005
 #define W5500_SIPR0      0x000F
+#define W5500_SIR        0x0017
+#define W5500_SIMR       0x0018
 #define W5500_VERSIONR   0x0039
 #define W5500_PHYCFGR    0x002E
 
@@ -39,16 +49,51 @@
 #define PHYCFGR_SPD      0x02
 #define PHYCFGR_DPX      0x04
 
-// Socket Registers
+// Socket Registers (offsets within a socket's register block)
 #define S0_MR            0x0000
 #define S0_CR            0x0001
 #define S0_IR            0x0002
 #define S0_SR            0x0003
 #define S0_PORT0         0x0004
+#define S0_DIPR0         0x000C
+#define S0_DPORT0        0x0010
+#define S0_TX_FSR        0x0020
+#define S0_TX_WR         0x0024
+#define S0_RX_RSR        0x0026
+#define S0_RX_RD         0x0028
+#define S0_IMR           0x002C
+
+// Socket Interrupt Bits
+#define SOCK_IR_CON      0x01
+#define SOCK_IR_DISCON   0x02
+#define SOCK_IR_RECV     0x04
+#define SOCK_IR_TIMEOUT  0x08
+#define SOCK_IR_SEND_OK  0x10
+
+// Sn_IR bits that raise INTn (SEND_OK is polled by the sender instead)
+#define SOCK_IR_EVENTS   (SOCK_IR_CON | SOCK_IR_DISCON | SOCK_IR_RECV | SOCK_IR_TIMEOUT)
 
 // Block Select Bits
-#define COMMON_REG_BSB   0x00
-#define SOCKET0_REG_BSB  0x08
+#define COMMON_REG_BSB        0x00
+#define SOCKET_REG_BSB(sn)    (((4 * (sn)) + 1) << 3)
+#define SOCKET_TX_BSB(sn)     (((4 * (sn)) + 2) << 3)
+#define SOCKET_RX_BSB(sn)     (((4 * (sn)) + 3) << 3)
+
+// Control byte: read/write bit (VDM, length set by CS)
+#define W5500_CTRL_WRITE 0x04
+
+// Socket buffers (reset default: 2 KB TX and RX per socket)
+#define W5500_SOCK_BUF_SIZE  2048
+#define W5500_SOCK_BUF_MASK  (W5500_SOCK_BUF_SIZE - 1)
+
+// Bursts shorter than this are cheaper without DMA setup
+#define W5500_DMA_MIN_LEN    16
+
+// Socket command / send completion timeout
+#define W5500_CMD_TIMEOUT_MS 500
+
+// Longest wait for INTn before housekeeping (keep-alive expiry, trace drain)
+#define W5500_IDLE_WAIT_MS   10
 
 // Socket Commands
 #define SOCK_OPEN        0x01
@@ -64,7 +109,12 @@
 #define SOCK_STAT_LISTEN      0x14
 #define SOCK_STAT_ESTABLISHED 0x17
 #define SOCK_STAT_CLOSE_WAIT  0x1C
+#define SOCK_STAT_UDP         0x22
 #define SOCK_TCP              0x01
+#define SOCK_UDP              0x02
+
+// UDP RX buffer entries: [ip:4][port:2][length:2] (big-endian), then the payload
+#define W5500_UDP_HEADER_SIZE 8
 
 // Network Configuration
 const uint8_t MAC_ADDRESS[] = {0x02, 0x08, 0xDC, 0x00, 0x00, 0x01};
@@ -90,25 +140,146 @@ static void w5500_deselect(void) {
     sleep_us(1);
 }
 
-uint8_t w5500_read_reg(uint16_t addr, uint8_t bsb) {
-    uint8_t data;
+// DMA channels for the data phase of bursts (-1: blocking SPI only)
+static int g_w5500_tx_dma = -1;
+static int g_w5500_rx_dma = -1;
+
+static void w5500_dma_init(void) {
+    g_w5500_tx_dma = dma_claim_unused_channel(false);
+    g_w5500_rx_dma = dma_claim_unused_channel(false);
+    if (g_w5500_tx_dma < 0 || g_w5500_rx_dma < 0) {
+        printf("[W5500] ⚠️  No free DMA channels, using blocking SPI\n");
+        if (g_w5500_tx_dma >= 0) dma_channel_unclaim(g_w5500_tx_dma);
+        if (g_w5500_rx_dma >= 0) dma_channel_unclaim(g_w5500_rx_dma);
+        g_w5500_tx_dma = -1;
+        g_w5500_rx_dma = -1;
+    }
+}
+
+// Full-duplex DMA transfer: tx NULL clocks out zeros, rx NULL discards
+static void w5500_spi_dma(const uint8_t* tx, uint8_t* rx, uint16_t length) {
+    static const uint8_t zero = 0;
+    static uint8_t discard;
+    io_rw_32* dr = &spi_get_hw(W5500_SPI_PORT)->dr;
+    
+    dma_channel_config c = dma_channel_get_default_config(g_w5500_tx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(W5500_SPI_PORT, true));
+    channel_config_set_read_increment(&c, tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(g_w5500_tx_dma, &c, dr, tx ? tx : &zero, length, false);
+    
+    c = dma_channel_get_default_config(g_w5500_rx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(W5500_SPI_PORT, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rx != NULL);
+    dma_channel_configure(g_w5500_rx_dma, &c, rx ? rx : &discard, dr, length, false);
+    
+    // RX finishing means every byte has been clocked
+    dma_start_channel_mask((1u << g_w5500_tx_dma) | (1u << g_w5500_rx_dma));
+    dma_channel_wait_for_finish_blocking(g_w5500_rx_dma);
+}
+
+// Address + control phase of a VDM frame
+static void w5500_begin_frame(uint16_t addr, uint8_t control) {
+    uint8_t header[3] = {addr >> 8, addr & 0xFF, control};
     w5500_select();
-    spi_write_blocking(W5500_SPI_PORT, (uint8_t[]){addr >> 8}, 1);
-    spi_write_blocking(W5500_SPI_PORT, (uint8_t[]){addr & 0xFF}, 1);
-    spi_write_blocking(W5500_SPI_PORT, &bsb, 1);
-    spi_read_blocking(W5500_SPI_PORT, 0x00, &data, 1);
+    spi_write_blocking(W5500_SPI_PORT, header, sizeof(header));
+}
+
+/**
+ * Read a block of consecutive W5500 addresses in one SPI frame
+ */
+void w5500_read_buf(uint16_t addr, uint8_t bsb, uint8_t* buffer, uint16_t length) {
+    w5500_begin_frame(addr, bsb);
+    if (length >= W5500_DMA_MIN_LEN && g_w5500_rx_dma >= 0) {
+        w5500_spi_dma(NULL, buffer, length);
+    } else {
+        spi_read_blocking(W5500_SPI_PORT, 0x00, buffer, length);
+    }
     w5500_deselect();
+}
+
+/**
+ * Write a block of consecutive W5500 addresses in one SPI frame
+ */
+void w5500_write_buf(uint16_t addr, uint8_t bsb, const uint8_t* data, uint16_t length) {
+    w5500_begin_frame(addr, bsb | W5500_CTRL_WRITE);
+    if (length >= W5500_DMA_MIN_LEN && g_w5500_tx_dma >= 0) {
+        w5500_spi_dma(data, NULL, length);
+    } else {
+        spi_write_blocking(W5500_SPI_PORT, data, length);
+    }
+    w5500_deselect();
+}
+
+uint8_t w5500_read_reg(uint16_t addr, uint8_t bsb) {
+    uint8_t data;
+    w5500_read_buf(addr, bsb, &data, 1);
     return data;
 }
 
 void w5500_write_reg(uint16_t addr, uint8_t bsb, uint8_t data) {
-    w5500_select();
-    spi_write_blocking(W5500_SPI_PORT, (uint8_t[]){addr >> 8}, 1);
-    spi_write_blocking(W5500_SPI_PORT, (uint8_t[]){addr & 0xFF}, 1);
-    uint8_t control = bsb | 0x04;
-    spi_write_blocking(W5500_SPI_PORT, &control, 1);
-    spi_write_blocking(W5500_SPI_PORT, &data, 1);
-    w5500_deselect();
+    w5500_write_buf(addr, bsb, &data, 1);
+}
+
+static uint16_t w5500_read_reg16(uint16_t addr, uint8_t bsb) {
+    uint8_t data[2];
+    w5500_read_buf(addr, bsb, data, 2);
+    return (data[0] << 8) | data[1];
+}
+
+static void w5500_write_reg16(uint16_t addr, uint8_t bsb, uint16_t value) {
+    uint8_t data[2] = {value >> 8, value & 0xFF};
+    w5500_write_buf(addr, bsb, data, 2);
+}
+
+// Free-running counters (TX_FSR, RX_RSR) must read the same twice
+static uint16_t w5500_read_counter(uint16_t addr, uint8_t bsb) {
+    uint16_t value, again = w5500_read_reg16(addr, bsb);
+    do {
+        value = again;
+        again = w5500_read_reg16(addr, bsb);
+    } while (value != again);
+    return value;
+}
+
+// Socket buffer copies at a free-running 16-bit pointer, split at the wrap
+static void w5500_tx_write(uint8_t sn, uint16_t ptr, const uint8_t* data, uint16_t length) {
+    uint16_t offset = ptr & W5500_SOCK_BUF_MASK;
+    uint16_t first = W5500_SOCK_BUF_SIZE - offset;
+    if (first > length) first = length;
+    
+    w5500_write_buf(offset, SOCKET_TX_BSB(sn), data, first);
+    if (length > first) {
+        w5500_write_buf(0, SOCKET_TX_BSB(sn), data + first, length - first);
+    }
+}
+
+static void w5500_rx_read(uint8_t sn, uint16_t ptr, uint8_t* buffer, uint16_t length) {
+    uint16_t offset = ptr & W5500_SOCK_BUF_MASK;
+    uint16_t first = W5500_SOCK_BUF_SIZE - offset;
+    if (first > length) first = length;
+    
+    w5500_read_buf(offset, SOCKET_RX_BSB(sn), buffer, first);
+    if (length > first) {
+        w5500_read_buf(0, SOCKET_RX_BSB(sn), buffer + first, length - first);
+    }
+}
+
+// Issue a socket command; Sn_CR reads back 0 once the W5500 has taken it
+static bool w5500_socket_cmd(uint8_t sn, uint8_t cmd) {
+    absolute_time_t deadline = make_timeout_time_ms(W5500_CMD_TIMEOUT_MS);
+    
+    w5500_write_reg(S0_CR, SOCKET_REG_BSB(sn), cmd);
+    while (w5500_read_reg(S0_CR, SOCKET_REG_BSB(sn)) != 0) {
+        if (time_reached(deadline)) {
+            return false;
+        }
+        sleep_us(10);
+    }
+    return true;
 }
 
 static void w5500_hardware_reset(void) {
@@ -137,6 +308,8 @@ bool w5500_init(void) {
     gpio_set_dir(W5500_CS, GPIO_OUT);
     gpio_put(W5500_CS, 1);
     
+    w5500_dma_init();
+    
     gpio_init(W5500_RST);
     gpio_set_dir(W5500_RST, GPIO_OUT);
     gpio_put(W5500_RST, 1);
@@ -152,25 +325,11 @@ bool w5500_init(void) {
         return false;
     }
     
-    // Set MAC
-    for (int i = 0; i < 6; i++) {
-        w5500_write_reg(W5500_SHAR0 + i, COMMON_REG_BSB, MAC_ADDRESS[i]);
-    }
-    
-    // Set Gateway
-    for (int i = 0; i < 4; i++) {
-        w5500_write_reg(W5500_GAR0 + i, COMMON_REG_BSB, GATEWAY[i]);
-    }
-    
-    // Set Subnet
-    for (int i = 0; i < 4; i++) {
-        w5500_write_reg(W5500_SUBR0 + i, COMMON_REG_BSB, SUBNET_MASK[i]);
-    }
-    
-    // Set IP
-    for (int i = 0; i < 4; i++) {
-        w5500_write_reg(W5500_SIPR0 + i, COMMON_REG_BSB, IP_ADDRESS[i]);
-    }
+    // Set MAC, Gateway, Subnet and IP
+    w5500_write_buf(W5500_SHAR0, COMMON_REG_BSB, MAC_ADDRESS, 6);
+    w5500_write_buf(W5500_GAR0, COMMON_REG_BSB, GATEWAY, 4);
+    w5500_write_buf(W5500_SUBR0, COMMON_REG_BSB, SUBNET_MASK, 4);
+    w5500_write_buf(W5500_SIPR0, COMMON_REG_BSB, IP_ADDRESS, 4);
     
     printf("[W5500] IP: %d.%d.%d.%d\n",
            IP_ADDRESS[0], IP_ADDRESS[1], IP_ADDRESS[2], IP_ADDRESS[3]);
@@ -183,38 +342,74 @@ bool w5500_init(void) {
 // TCP Server Setup
 // ============================================================================
 
-bool w5500_setup_tcp_server(uint16_t port) {
-    printf("[W5500] Setting up TCP server on port %d\n", port);
-    z1_display_status("Start HTTP server");
-    
-    w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_CLOSE);
-    sleep_ms(10);
+// INTn falling edge seen since the main loop last looked
+static volatile bool g_w5500_irq = false;
+static uint16_t g_http_port = Z1_HTTP_PORT;
+
+// Raw handler: shares IO_IRQ_BANK0 with the matrix bus BUSATTN callback
+static void w5500_int_irq_handler(void) {
+    if (gpio_get_irq_event_mask(W5500_INT) & GPIO_IRQ_EDGE_FALL) {
+        gpio_acknowledge_irq(W5500_INT, GPIO_IRQ_EDGE_FALL);
+        g_w5500_irq = true;
+    }
+}
+
+// Open one socket in TCP mode and put it in LISTEN
+static bool w5500_socket_listen(uint8_t sn) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
     
-    w5500_write_reg(S0_MR, SOCKET0_REG_BSB, SOCK_TCP);
-    w5500_write_reg(S0_PORT0, SOCKET0_REG_BSB, (port >> 8) & 0xFF);
-    w5500_write_reg(S0_PORT0 + 1, SOCKET0_REG_BSB, port & 0xFF);
+    w5500_socket_cmd(sn, SOCK_CLOSE);
+    w5500_write_reg(S0_IR, bsb, 0xFF);
+    w5500_write_reg(S0_MR, bsb, SOCK_TCP);
+    w5500_write_reg16(S0_PORT0, bsb, g_http_port);
+    w5500_write_reg(S0_IMR, bsb, SOCK_IR_EVENTS);
     
-    w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_OPEN);
-    sleep_ms(10);
+    if (!w5500_socket_cmd(sn, SOCK_OPEN) || w5500_read_reg(S0_SR, bsb) != SOCK_STAT_INIT) {
+        printf("[W5500] ❌ Failed to open socket %d\n", sn);
+        return false;
+    }
     
-    uint8_t status = w5500_read_reg(S0_SR, SOCKET0_REG_BSB);
-    if (status != SOCK_STAT_INIT) {
-        printf("[W5500] ❌ Failed to open socket\n");
-        z1_display_error("TCP open failed");
+    if (!w5500_socket_cmd(sn, SOCK_LISTEN) || w5500_read_reg(S0_SR, bsb) != SOCK_STAT_LISTEN) {
+        printf("[W5500] ❌ Socket %d failed to listen\n", sn);
         return false;
     }
     
-    w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_LISTEN);
-    sleep_ms(10);
+    memset(&g_http_connections[sn], 0, sizeof(http_connection_t));
+    g_http_connections[sn].socket_num = sn;
+    return true;
+}
+
+bool w5500_setup_tcp_server(uint16_t port) {
+    printf("[W5500] Setting up TCP server on port %d (%d sockets)\n",
+           port, Z1_HTTP_MAX_CONNECTIONS);
+    z1_display_status("Start HTTP server");
     
-    status = w5500_read_reg(S0_SR, SOCKET0_REG_BSB);
-    if (status != SOCK_STAT_LISTEN) {
-        printf("[W5500] ❌ Failed to listen\n");
+    g_http_port = port;
+    
+    // INTn is open-drain, active low
+    gpio_init(W5500_INT);
+    gpio_set_dir(W5500_INT, GPIO_IN);
+    gpio_pull_up(W5500_INT);
+    
+    uint8_t listening = 0;
+    for (uint8_t sn = 0; sn < Z1_HTTP_MAX_CONNECTIONS; sn++) {
+        if (w5500_socket_listen(sn)) {
+            listening++;
+        }
+    }
+    
+    if (listening == 0) {
         z1_display_error("TCP listen failed");
         return false;
     }
     
-    printf("[W5500] ✅ Listening on port %d\n", port);
+    w5500_write_reg(W5500_SIMR, COMMON_REG_BSB, (1u << Z1_HTTP_MAX_CONNECTIONS) - 1);
+    gpio_add_raw_irq_handler(W5500_INT, w5500_int_irq_handler);
+    gpio_set_irq_enabled(W5500_INT, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    
+    printf("[W5500] ✅ Listening on port %d (%d/%d sockets)\n",
+           port, listening, Z1_HTTP_MAX_CONNECTIONS);
     z1_display_status("HTTP ready!");
     return true;
 }
@@ -223,39 +418,119 @@ bool w5500_setup_tcp_server(uint16_t port) {
 // HTTP Response Sending
 // ============================================================================
 
-static bool w5500_send_data(const char* data, uint16_t length) {
-    uint8_t tx_wr_high = w5500_read_reg(0x0024, SOCKET0_REG_BSB);
-    uint8_t tx_wr_low = w5500_read_reg(0x0025, SOCKET0_REG_BSB);
-    uint16_t tx_wr_ptr = (tx_wr_high << 8) | tx_wr_low;
+// Issue SEND and wait until the peer has acknowledged the data
+static bool w5500_send_and_wait(uint8_t sn, absolute_time_t deadline) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
     
-    for (uint16_t i = 0; i < length; i++) {
-        uint16_t addr = (tx_wr_ptr + i) & 0x07FF;
-        w5500_write_reg(addr, 0x14, data[i]);
-    }
+    // Drop a completion left over from an earlier send that timed out
+    w5500_write_reg(S0_IR, bsb, SOCK_IR_SEND_OK | SOCK_IR_TIMEOUT);
+    w5500_write_reg(S0_CR, bsb, SOCK_SEND);
     
-    tx_wr_ptr += length;
-    w5500_write_reg(0x0024, SOCKET0_REG_BSB, (tx_wr_ptr >> 8) & 0xFF);
-    w5500_write_reg(0x0025, SOCKET0_REG_BSB, tx_wr_ptr & 0xFF);
+    while (true) {
+        uint8_t ir = w5500_read_reg(S0_IR, bsb);
+        if (ir & SOCK_IR_SEND_OK) {
+            return true;
+        }
+        if ((ir & SOCK_IR_TIMEOUT) || time_reached(deadline)) {
+            return false;
+        }
+        sleep_us(10);
+    }
+}
+
+static bool w5500_send_data(uint8_t sn, const char* data, uint16_t length) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    const uint8_t* p = (const uint8_t*)data;
+    absolute_time_t deadline = make_timeout_time_ms(W5500_CMD_TIMEOUT_MS);
     
-    w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_SEND);
+    // A peer that has gone away would only run into the deadline
+    uint8_t status = w5500_read_reg(S0_SR, bsb);
+    if (status != SOCK_STAT_ESTABLISHED && status != SOCK_STAT_CLOSE_WAIT) {
+        return false;
+    }
     
-    int timeout = 100;
-    uint8_t cmd_status;
-    do {
-        cmd_status = w5500_read_reg(S0_CR, SOCKET0_REG_BSB);
-        sleep_ms(5);
-        timeout--;
-    } while (cmd_status != 0 && timeout > 0);
+    // Responses larger than the socket buffer go out in buffer-sized pieces
+    while (length > 0) {
+        uint16_t room = w5500_read_counter(S0_TX_FSR, bsb);
+        if (room == 0) {
+            if (time_reached(deadline)) {
+                return false;
+            }
+            sleep_us(10);
+            continue;
+        }
+        uint16_t n = (length < room) ? length : room;
+        
+        uint16_t tx_wr_ptr = w5500_read_reg16(S0_TX_WR, bsb);
+        w5500_tx_write(sn, tx_wr_ptr, p, n);
+        w5500_write_reg16(S0_TX_WR, bsb, tx_wr_ptr + n);
+        
+        if (!w5500_send_and_wait(sn, deadline)) {
+            return false;
+        }
+        p += n;
+        length -= n;
+    }
     
-    return (timeout > 0);
+    return true;
 }
 
 // HTTP response functions are implemented in z1_http_api.c
 // We just provide the low-level W5500 send function
 
 // Low-level send function used by z1_http_api.c
-bool w5500_send_http_data(const char* data, uint16_t length) {
-    return w5500_send_data(data, length);
+bool w5500_send_http_data(uint8_t socket, const char* data, uint16_t length) {
+    return w5500_send_data(socket, data, length);
+}
+
+// ============================================================================
+// Streaming Response Output
+// ============================================================================
+
+/**
+ * Wait for free space in a socket's TX buffer
+ */
+bool w5500_tx_begin(uint8_t sn, uint16_t min, uint16_t* wr_ptr, uint16_t* room) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    absolute_time_t deadline = make_timeout_time_ms(W5500_CMD_TIMEOUT_MS);
+    
+    if (min > W5500_SOCK_BUF_SIZE) {
+        min = W5500_SOCK_BUF_SIZE;
+    }
+    
+    // Space frees up as the peer acknowledges what was sent before
+    while (true) {
+        uint8_t status = w5500_read_reg(S0_SR, bsb);
+        if (status != SOCK_STAT_ESTABLISHED && status != SOCK_STAT_CLOSE_WAIT) {
+            return false;
+        }
+        *room = w5500_read_counter(S0_TX_FSR, bsb);
+        if (*room >= min) {
+            break;
+        }
+        if (time_reached(deadline)) {
+            return false;
+        }
+        sleep_us(10);
+    }
+    
+    *wr_ptr = w5500_read_reg16(S0_TX_WR, bsb);
+    return true;
+}
+
+/**
+ * Copy bytes into a socket's TX buffer without sending them
+ */
+void w5500_tx_put(uint8_t sn, uint16_t ptr, const uint8_t* data, uint16_t length) {
+    w5500_tx_write(sn, ptr, data, length);
+}
+
+/**
+ * Send the TX buffer contents up to a write pointer
+ */
+bool w5500_tx_commit(uint8_t sn, uint16_t wr_ptr) {
+    w5500_write_reg16(S0_TX_WR, SOCKET_REG_BSB(sn), wr_ptr);
+    return w5500_send_and_wait(sn, make_timeout_time_ms(W5500_CMD_TIMEOUT_MS));
 }
 
 // ============================================================================
@@ -267,9 +542,10 @@ static void route_http_request(http_connection_t* conn, const char* method,
     printf("[HTTP] %s %s\n", method, path);
     z1_display_http_request(method, path);
     
-    // GET /api/nodes - List all nodes
-    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/nodes") == 0) {
-        handle_get_nodes(conn);
+    // GET /api/nodes[?refresh=1] - List all nodes (refresh: discover first)
+    if (strcmp(method, "GET") == 0 && strncmp(path, "/api/nodes", 10) == 0 &&
+        (path[10] == '\0' || path[10] == '?')) {
+        handle_get_nodes(conn, strstr(path, "refresh=1") != NULL);
         return;
     }
     
@@ -279,15 +555,28 @@ static void route_http_request(http_connection_t* conn, const char* method,
         return;
     }
     
-    // GET /api/snn/status - Get SNN status
-    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/snn/status") == 0) {
-        handle_get_snn_status(conn);
+    // GET /api/snn/status[?node=N&reset=1&refresh=1] - Get SNN status and node timing
+    if (strcmp(method, "GET") == 0 && strncmp(path, "/api/snn/status", 15) == 0 &&
+        (path[15] == '\0' || path[15] == '?')) {
+        const char* node_param = strstr(path, "node=");
+        const char* reset_param = strstr(path, "reset=");
+        handle_get_snn_status(conn, node_param ? atoi(node_param + 5) : 0,
+                              reset_param && reset_param[6] == '1',
+                              strstr(path, "refresh=1") != NULL);
         return;
     }
     
-    // POST /api/snn/start - Start SNN
-    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/start") == 0) {
-        handle_post_snn_start(conn);
+    // POST /api/snn/start[?sync=1&period_us=N&slot_us=N&guard_us=N] - Start SNN
+    // (sync: timestep barrier, slot_us: TDMA spike exchange)
+    if (strcmp(method, "POST") == 0 && strncmp(path, "/api/snn/start", 14) == 0 &&
+        (path[14] == '\0' || path[14] == '?')) {
+        const char* period_param = strstr(path, "period_us=");
+        const char* slot_param = strstr(path, "slot_us=");
+        const char* guard_param = strstr(path, "guard_us=");
+        handle_post_snn_start(conn, strstr(path, "sync=1") != NULL,
+                              period_param ? (uint32_t)atoi(period_param + 10) : 0,
+                              slot_param ? (uint16_t)atoi(slot_param + 8) : 0,
+                              guard_param ? (uint16_t)atoi(guard_param + 9) : Z1_SNN_TDMA_GUARD_US);
         return;
     }
     
@@ -297,15 +586,114 @@ static void route_http_request(http_connection_t* conn, const char* method,
         return;
     }
     
-    // POST /api/snn/deploy - Deploy SNN
-    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/deploy") == 0) {
-        handle_post_snn_deploy(conn, body, body_length);
+    // POST /api/snn/checkpoint - Save the stopped run of every deployed node
+    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/checkpoint") == 0) {
+        handle_post_snn_checkpoint(conn);
+        return;
+    }
+    
+    // GET /api/snn/checkpoint - Describe the stored checkpoint
+    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/snn/checkpoint") == 0) {
+        handle_get_snn_checkpoint(conn);
+        return;
+    }
+    
+    // POST /api/snn/restore - Put the stored checkpoint back on the nodes
+    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/restore") == 0) {
+        handle_post_snn_restore(conn);
+        return;
+    }
+    
+    // POST /api/snn/batch?steps=S&samples=K is streamed to g_snn_batch_sink (request_body_sink)
+    
+    // POST /api/snn/batch/start - Run the staged batch
+    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/batch/start") == 0) {
+        handle_post_snn_batch_start(conn);
+        return;
+    }
+    
+    // GET /api/snn/batch - Staged batch and per-node progress
+    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/snn/batch") == 0) {
+        handle_get_snn_batch(conn);
+        return;
+    }
+    
+    // GET /api/snn/batch/results - Results blocks of the batch nodes (binary)
+    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/snn/batch/results") == 0) {
+        handle_get_snn_batch_results(conn);
         return;
     }
     
-    // POST /api/snn/input - Inject spikes
-    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/input") == 0) {
-        handle_post_snn_inject(conn, body, body_length);
+    // GET /api/gateway - Backplane number, peers and relay counters
+    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/gateway") == 0) {
+        handle_get_gateway(conn);
+        return;
+    }
+    
+    // POST /api/gateway?backplane=N - Set this controller's backplane (drops the routes)
+    if (strcmp(method, "POST") == 0 && strncmp(path, "/api/gateway?", 13) == 0) {
+        handle_post_gateway(conn, path);
+        return;
+    }
+    
+    // POST /api/gateway/peer?backplane=N[&ip=A.B.C.D&port=P] - Set or remove a peer controller
+    if (strcmp(method, "POST") == 0 && strncmp(path, "/api/gateway/peer", 17) == 0 &&
+        (path[17] == '\0' || path[17] == '?')) {
+        handle_post_gateway_peer(conn, path);
+        return;
+    }
+    
+    // POST /api/gateway/routes is streamed to g_gateway_routes_sink (request_body_sink)
+    
+    // POST /api/snn/deploy is streamed to g_snn_deploy_sink (request_body_sink)
+    
+    // GET /api/snn/deploy - Per-node progress of the running or last deploy
+    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/snn/deploy") == 0) {
+        handle_get_snn_deploy_status(conn);
+        return;
+    }
+    
+    // POST /api/snn/weights is streamed to g_snn_weights_sink (request_body_sink)
+    
+    // POST /api/snn/input is streamed to g_snn_input_sink (request_body_sink)
+    
+    // POST /api/snn/encode is streamed to g_snn_encode_sink (request_body_sink)
+    
+    // GET /api/snn/encode - Tensor being presented by the controller's encoder
+    if (strcmp(method, "GET") == 0 && strcmp(path, "/api/snn/encode") == 0) {
+        handle_get_snn_encode(conn);
+        return;
+    }
+    
+    // POST /api/snn/encode/stop - End the presentation
+    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/snn/encode/stop") == 0) {
+        handle_post_snn_encode_stop(conn);
+        return;
+    }
+    
+    // POST /api/firmware/batch is streamed to g_firmware_batch_sink (request_body_sink)
+    
+    // GET /api/snn/events[?count=N&format=bin] - Recorded spikes (consumed)
+    if (strcmp(method, "GET") == 0 && strncmp(path, "/api/snn/events", 15) == 0 &&
+        (path[15] == '\0' || path[15] == '?')) {
+        const char* count_param = strstr(path, "count=");
+        handle_get_snn_events(conn, count_param ? atoi(count_param + 6) : 0,
+                              strstr(path, "format=bin") != NULL);
+        return;
+    }
+    
+    // GET /api/trace[?count=N] - Recent trace records
+    if (strcmp(method, "GET") == 0 && strncmp(path, "/api/trace", 10) == 0 &&
+        (path[10] == '\0' || path[10] == '?')) {
+        const char* count_param = strstr(path, "count=");
+        handle_get_trace(conn, count_param ? atoi(count_param + 6) : 0);
+        return;
+    }
+    
+    // POST /api/bench?test=snn|psram|bus[&node=N&...] - Run a benchmark (blocks until done)
+    if (strcmp(method, "POST") == 0 && strncmp(path, "/api/bench", 10) == 0 &&
+        (path[10] == '\0' || path[10] == '?')) {
+        handle_post_bench(conn, path);
         return;
     }
     
@@ -314,6 +702,21 @@ static void route_http_request(http_connection_t* conn, const char* method,
     strncpy(path_copy, path, sizeof(path_copy) - 1);
     path_copy[sizeof(path_copy) - 1] = '\0';
     
+    // GET /api/nodes/{id}/memory?address=A&length=N[&format=bin] - Stream node PSRAM
+    if (strcmp(method, "GET") == 0 && strncmp(path, "/api/nodes/", 11) == 0 &&
+        strstr(path, "/memory") != NULL) {
+        const char* addr_param = strstr(path, "address=");
+        const char* length_param = strstr(path, "length=");
+        if (!addr_param || !length_param) {
+            z1_http_send_error(conn, 400, "address and length required");
+            return;
+        }
+        handle_get_node_memory(conn, atoi(path + 11), strtoul(addr_param + 8, NULL, 0),
+                               strtoul(length_param + 7, NULL, 0),
+                               strstr(path, "format=bin") != NULL);
+        return;
+    }
+    
     // GET /api/nodes/{id} - Get specific node
     if (strcmp(method, "GET") == 0 && strncmp(path, "/api/nodes/", 11) == 0) {
         int node_id = atoi(path + 11);
@@ -347,23 +750,54 @@ static void route_http_request(http_connection_t* conn, const char* method,
     z1_http_send_error(conn, 404, "Endpoint not found");
 }
 
-static void parse_and_route_request(const char* request, uint16_t length) {
-    http_connection_t conn = {0};
+// Find header "name" in the header block and return its value (NULL if absent)
+static const char* find_header(const char* headers, const char* headers_end, const char* name) {
+    size_t name_len = strlen(name);
+    const char* line = strstr(headers, "\r\n");
+    
+    while (line && line < headers_end) {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char* value = line + name_len + 1;
+            while (*value == ' ') value++;
+            return value;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return NULL;
+}
+
+// HTTP/1.1 stays open unless the client says close; HTTP/1.0 only on request
+static bool wants_keep_alive(const char* version, const char* headers, const char* headers_end) {
+    const char* connection = find_header(headers, headers_end, "Connection");
     
+    if (connection && strncasecmp(connection, "close", 5) == 0) {
+        return false;
+    }
+    if (strncmp(version, "HTTP/1.1", 8) == 0) {
+        return true;
+    }
+    return connection && strncasecmp(connection, "keep-alive", 10) == 0;
+}
+
+static void parse_and_route_request(http_connection_t* conn, const char* request, uint16_t length) {
     // Parse request line: "METHOD /path HTTP/1.1"
     char method[16] = {0};
     char path[128] = {0};
     
+    // Malformed requests end the connection
+    conn->keep_alive = false;
+    
     const char* line_end = strstr(request, "\r\n");
     if (!line_end) {
-        z1_http_send_error(&conn, 400, "Invalid request");
+        z1_http_send_error(conn, 400, "Invalid request");
         return;
     }
     
     // Extract method
     const char* space1 = strchr(request, ' ');
     if (!space1 || space1 > line_end) {
-        z1_http_send_error(&conn, 400, "Invalid request");
+        z1_http_send_error(conn, 400, "Invalid request");
         return;
     }
     
@@ -376,7 +810,7 @@ static void parse_and_route_request(const char* request, uint16_t length) {
     const char* path_start = space1 + 1;
     const char* space2 = strchr(path_start, ' ');
     if (!space2 || space2 > line_end) {
-        z1_http_send_error(&conn, 400, "Invalid request");
+        z1_http_send_error(conn, 400, "Invalid request");
         return;
     }
     
@@ -395,78 +829,543 @@ static void parse_and_route_request(const char* request, uint16_t length) {
         body_length = length - (body - request);
     }
     
+    conn->keep_alive = wants_keep_alive(space2 + 1, request,
+                                        body_start ? body_start : line_end);
+    
     // Route request
-    route_http_request(&conn, method, path, body, body_length);
+    route_http_request(conn, method, path, body, body_length);
 }
 
 // ============================================================================
-// Main HTTP Server Loop
+// Socket Service
 // ============================================================================
 
-void w5500_http_server_run(void) {
-    printf("[HTTP] Server running...\n");
-    z1_display_status("HTTP listening");
-    
-    char request_buffer[2048];
+// Content-Length of a complete header block (0 if absent or malformed)
+static uint32_t request_content_length(const char* headers, const char* headers_end) {
+    const char* value = find_header(headers, headers_end, "Content-Length");
+    return value ? (uint32_t)strtoul(value, NULL, 10) : 0;
+}
+
+static bool request_is_chunked(const char* headers, const char* headers_end) {
+    const char* value = find_header(headers, headers_end, "Transfer-Encoding");
+    return value && strncasecmp(value, "chunked", 7) == 0;
+}
+
+// Routes whose body is streamed to a sink instead of buffered
+static const z1_http_body_sink_t* request_body_sink(const char* request) {
+    if (strncmp(request, "POST /api/snn/deploy", 20) == 0 &&
+        (request[20] == ' ' || request[20] == '?')) {
+        return &g_snn_deploy_sink;
+    }
+    if (strncmp(request, "POST /api/snn/weights", 21) == 0 &&
+        (request[21] == ' ' || request[21] == '?')) {
+        return &g_snn_weights_sink;
+    }
+    if (strncmp(request, "POST /api/snn/input", 19) == 0 &&
+        (request[19] == ' ' || request[19] == '?')) {
+        return &g_snn_input_sink;
+    }
+    if (strncmp(request, "POST /api/snn/encode", 20) == 0 &&
+        (request[20] == ' ' || request[20] == '?')) {
+        return &g_snn_encode_sink;
+    }
+    if (strncmp(request, "POST /api/firmware/batch", 24) == 0 &&
+        (request[24] == ' ' || request[24] == '?')) {
+        return &g_firmware_batch_sink;
+    }
+    if (strncmp(request, "POST /api/snn/batch", 19) == 0 &&
+        (request[19] == ' ' || request[19] == '?')) {
+        return &g_snn_batch_sink;
+    }
+    if (strncmp(request, "POST /api/gateway/routes", 24) == 0 &&
+        (request[24] == ' ' || request[24] == '?')) {
+        return &g_gateway_routes_sink;
+    }
+    return NULL;
+}
+
+// Advance a socket's RX read pointer past consumed bytes
+static void w5500_rx_consume(uint8_t sn, uint16_t rx_rd_ptr, uint16_t length) {
+    w5500_write_reg16(S0_RX_RD, SOCKET_REG_BSB(sn), rx_rd_ptr + length);
+    w5500_socket_cmd(sn, SOCK_RECV);
+}
+
+// ============================================================================
+// Streamed Request Bodies
+// ============================================================================
+
+// Chunked transfer decoder states (http_connection_t.chunk_state)
+#define HTTP_CHUNK_NONE          0   // Content-Length body
+#define HTTP_CHUNK_SIZE          1   // Hex chunk size
+#define HTTP_CHUNK_EXT           2   // Rest of the size line
+#define HTTP_CHUNK_DATA          3
+#define HTTP_CHUNK_DATA_END      4   // CRLF after the data
+#define HTTP_CHUNK_TRAILER       5   // Start of a trailer line (empty line ends the body)
+#define HTTP_CHUNK_TRAILER_LINE  6
+#define HTTP_CHUNK_DONE          7
+
+static bool http_body_complete(const http_connection_t* conn) {
+    return (conn->chunk_state == HTTP_CHUNK_NONE) ? conn->body_remaining == 0
+                                                  : conn->chunk_state == HTTP_CHUNK_DONE;
+}
+
+/**
+ * Decode body bytes and push the payload to the connection's sink
+ *
+ * Stops at the end of the body so a pipelined request behind it stays in
+ * the socket.
+ *
+ * @return Bytes consumed, -1 on a malformed chunk or a refusing sink
+ */
+static int http_body_feed(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    uint16_t i = 0;
     
-    while (true) {
-        uint8_t status = w5500_read_reg(S0_SR, SOCKET0_REG_BSB);
+    while (i < length && !http_body_complete(conn)) {
+        uint8_t c = data[i];
         
-        switch (status) {
-            case SOCK_STAT_LISTEN:
-                // Waiting for connection
+        switch (conn->chunk_state) {
+            case HTTP_CHUNK_NONE:
+            case HTTP_CHUNK_DATA: {
+                uint16_t n = length - i;
+                if (n > conn->body_remaining) n = conn->body_remaining;
+                if (!conn->body_sink->write(conn, data + i, n)) {
+                    return -1;
+                }
+                conn->body_remaining -= n;
+                conn->bytes_received += n;
+                i += n;
+                if (conn->chunk_state == HTTP_CHUNK_DATA && conn->body_remaining == 0) {
+                    conn->chunk_state = HTTP_CHUNK_DATA_END;
+                }
+                continue;
+            }
+                
+            case HTTP_CHUNK_SIZE:
+                if (c >= '0' && c <= '9') {
+                    conn->body_remaining = (conn->body_remaining << 4) | (c - '0');
+                } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                    conn->body_remaining = (conn->body_remaining << 4) | ((c | 0x20) - 'a' + 10);
+                } else if (c == '\n') {
+                    conn->chunk_state = conn->body_remaining ? HTTP_CHUNK_DATA : HTTP_CHUNK_TRAILER;
+                } else {
+                    conn->chunk_state = HTTP_CHUNK_EXT;
+                }
+                if (conn->body_remaining > 0x0FFFFFFF) {
+                    return -1;
+                }
                 break;
                 
-            case SOCK_STAT_ESTABLISHED: {
-                // Check for received data
-                uint8_t rx_size_high = w5500_read_reg(0x0026, SOCKET0_REG_BSB);
-                uint8_t rx_size_low = w5500_read_reg(0x0027, SOCKET0_REG_BSB);
-                uint16_t rx_size = (rx_size_high << 8) | rx_size_low;
+            case HTTP_CHUNK_EXT:
+                if (c == '\n') {
+                    conn->chunk_state = conn->body_remaining ? HTTP_CHUNK_DATA : HTTP_CHUNK_TRAILER;
+                }
+                break;
                 
-                if (rx_size > 0) {
-                    printf("[HTTP] Received %d bytes\n", rx_size);
-                    
-                    // Read request
-                    uint8_t rx_rd_high = w5500_read_reg(0x0028, SOCKET0_REG_BSB);
-                    uint8_t rx_rd_low = w5500_read_reg(0x0029, SOCKET0_REG_BSB);
-                    uint16_t rx_rd_ptr = (rx_rd_high << 8) | rx_rd_low;
-                    
-                    uint16_t read_size = (rx_size < sizeof(request_buffer) - 1) ? 
-                                        rx_size : sizeof(request_buffer) - 1;
-                    
-                    for (uint16_t i = 0; i < read_size; i++) {
-                        uint16_t addr = (rx_rd_ptr + i) & 0x07FF;
-                        request_buffer[i] = w5500_read_reg(addr, 0x18);
-                    }
-                    request_buffer[read_size] = '\0';
-                    
-                    // Update read pointer
-                    rx_rd_ptr += rx_size;
-                    w5500_write_reg(0x0028, SOCKET0_REG_BSB, (rx_rd_ptr >> 8) & 0xFF);
-                    w5500_write_reg(0x0029, SOCKET0_REG_BSB, rx_rd_ptr & 0xFF);
-                    w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_RECV);
-                    
-                    // Parse and route request
-                    parse_and_route_request(request_buffer, read_size);
-                    
-                    // Close connection
-                    w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_DISCON);
-                    sleep_ms(50);
+            case HTTP_CHUNK_DATA_END:
+                if (c == '\n') {
+                    conn->chunk_state = HTTP_CHUNK_SIZE;
                 }
                 break;
-            }
                 
-            case SOCK_STAT_CLOSE_WAIT:
-                printf("[HTTP] Connection closing\n");
-                w5500_write_reg(S0_CR, SOCKET0_REG_BSB, SOCK_CLOSE);
+            case HTTP_CHUNK_TRAILER:
+                if (c == '\n') {
+                    conn->chunk_state = HTTP_CHUNK_DONE;
+                } else if (c != '\r') {
+                    conn->chunk_state = HTTP_CHUNK_TRAILER_LINE;
+                }
                 break;
                 
-            case SOCK_STAT_CLOSED:
-                printf("[HTTP] Reopening socket\n");
-                w5500_setup_tcp_server(80);
+            case HTTP_CHUNK_TRAILER_LINE:
+                if (c == '\n') {
+                    conn->chunk_state = HTTP_CHUNK_TRAILER;
+                }
+                break;
+        }
+        i++;
+    }
+    
+    return i;
+}
+
+// Hand the body to the sink's end(): 1 if the connection stays open, else -1
+static int http_body_finish(http_connection_t* conn, bool complete) {
+    const z1_http_body_sink_t* sink = conn->body_sink;
+    
+    conn->body_sink = NULL;
+    conn->state = HTTP_STATE_PROCESSING;
+    if (!complete) {
+        // The rest of the body may still be in flight
+        conn->keep_alive = false;
+    }
+    sink->end(conn, complete);
+    return (conn->state == HTTP_STATE_CLOSING) ? -1 : 1;
+}
+
+// Move whatever body bytes have arrived into the sink
+static int http_stream_body(http_connection_t* conn, char* buffer, uint16_t size) {
+    uint8_t sn = conn->socket_num;
+    uint16_t rx_size = w5500_read_counter(S0_RX_RSR, SOCKET_REG_BSB(sn));
+    if (rx_size == 0) {
+        return 0;
+    }
+    
+    uint16_t rx_rd_ptr = w5500_read_reg16(S0_RX_RD, SOCKET_REG_BSB(sn));
+    uint16_t n = (rx_size < size) ? rx_size : size;
+    w5500_rx_read(sn, rx_rd_ptr, (uint8_t*)buffer, n);
+    
+    int used = http_body_feed(conn, (const uint8_t*)buffer, n);
+    if (used < 0) {
+        return http_body_finish(conn, false);
+    }
+    w5500_rx_consume(sn, rx_rd_ptr, (uint16_t)used);
+    conn->last_activity_ms = to_ms_since_boot(get_absolute_time());
+    
+    if (http_body_complete(conn)) {
+        return http_body_finish(conn, true);
+    }
+    return 1;
+}
+
+// Headers of a streamed route are in: consume them and start the sink
+static int http_begin_body(http_connection_t* conn, const z1_http_body_sink_t* sink,
+                           char* request, uint16_t headers_length) {
+    const char* headers_end = request + headers_length - 4;
+    bool chunked = request_is_chunked(request, headers_end);
+    uint32_t content_length = request_content_length(request, headers_end);
+    
+    // Request line "METHOD /path HTTP/x.y": the version follows the last space
+    const char* line_end = strstr(request, "\r\n");
+    const char* version = line_end;
+    while (version > request && version[-1] != ' ') version--;
+    bool keep_alive = wants_keep_alive(version, request, headers_end);
+    
+    *(char*)line_end = '\0';
+    printf("[HTTP] %s (%s body)\n", request, chunked ? "chunked" : "streamed");
+    
+    // Sinks read their query parameters from conn->path
+    const char* path_start = strchr(request, ' ') + 1;  // Matched by request_body_sink()
+    const char* path_end = strchr(path_start, ' ');
+    size_t path_len = path_end ? (size_t)(path_end - path_start) : strlen(path_start);
+    if (path_len >= sizeof(conn->path)) path_len = sizeof(conn->path) - 1;
+    memcpy(conn->path, path_start, path_len);
+    conn->path[path_len] = '\0';
+    
+    w5500_rx_consume(conn->socket_num,
+                     w5500_read_reg16(S0_RX_RD, SOCKET_REG_BSB(conn->socket_num)),
+                     headers_length);
+    conn->last_activity_ms = to_ms_since_boot(get_absolute_time());
+    
+    // A refused body is never read, so the connection has to close
+    conn->keep_alive = false;
+    conn->state = HTTP_STATE_PROCESSING;
+    conn->body_sink = sink;
+    if (!sink->begin(conn, chunked ? Z1_HTTP_BODY_CHUNKED : content_length)) {
+        conn->body_sink = NULL;
+        return -1;
+    }
+    
+    conn->keep_alive = keep_alive;
+    conn->state = HTTP_STATE_RECEIVING_BODY;
+    conn->content_length = chunked ? Z1_HTTP_BODY_CHUNKED : content_length;
+    conn->bytes_received = 0;
+    conn->body_remaining = chunked ? 0 : content_length;
+    conn->chunk_state = chunked ? HTTP_CHUNK_SIZE : HTTP_CHUNK_NONE;
+    
+    if (http_body_complete(conn)) {
+        return http_body_finish(conn, true);
+    }
+    return 1;
+}
+
+// ============================================================================
+// Socket Service
+// ============================================================================
+
+/**
+ * Take one complete request out of a socket's RX buffer
+ *
+ * Data stays in the W5500 until headers and body have both arrived, so a
+ * partial request costs no SRAM and a pipelined request behind it is left
+ * for the next call. Routes with a body sink are handed over as soon as
+ * their headers are complete.
+ *
+ * @return 1 served or handed over, 0 not complete yet, -1 disconnect
+ */
+static int http_read_request(http_connection_t* conn, char* buffer, uint16_t size) {
+    uint8_t sn = conn->socket_num;
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    uint16_t rx_size = w5500_read_counter(S0_RX_RSR, bsb);
+    if (rx_size == 0) {
+        return 0;
+    }
+    
+    uint16_t rx_rd_ptr = w5500_read_reg16(S0_RX_RD, bsb);
+    uint16_t peek = (rx_size < size - 1) ? rx_size : size - 1;
+    w5500_rx_read(sn, rx_rd_ptr, (uint8_t*)buffer, peek);
+    buffer[peek] = '\0';
+    
+    const char* headers_end = strstr(buffer, "\r\n\r\n");
+    if (!headers_end) {
+        if (peek < size - 1) {
+            return 0;
+        }
+        conn->keep_alive = false;
+        z1_http_send_error(conn, 413, "Request headers too large");
+        return -1;
+    }
+    uint16_t headers_length = headers_end + 4 - buffer;
+    
+    const z1_http_body_sink_t* sink = request_body_sink(buffer);
+    if (sink) {
+        return http_begin_body(conn, sink, buffer, headers_length);
+    }
+    
+    if (request_is_chunked(buffer, headers_end)) {
+        conn->keep_alive = false;
+        z1_http_send_error(conn, 411, "Chunked body not supported for this endpoint");
+        return -1;
+    }
+    
+    uint32_t total = headers_length + request_content_length(buffer, headers_end);
+    if (total > (uint32_t)(size - 1)) {
+        conn->keep_alive = false;
+        z1_http_send_error(conn, 413, "Request too large");
+        return -1;
+    }
+    if (total > peek) {
+        return 0;
+    }
+    
+    // Consume exactly this request
+    buffer[total] = '\0';
+    w5500_rx_consume(sn, rx_rd_ptr, (uint16_t)total);
+    
+    conn->last_activity_ms = to_ms_since_boot(get_absolute_time());
+    conn->state = HTTP_STATE_PROCESSING;
+    parse_and_route_request(conn, buffer, (uint16_t)total);
+    return (conn->state == HTTP_STATE_CLOSING) ? -1 : 1;
+}
+
+// Serve at most one request or body piece: 1 progress, 0 nothing yet, -1 disconnect
+static int http_serve_one(http_connection_t* conn, char* buffer, uint16_t size) {
+    if (conn->state == HTTP_STATE_RECEIVING_BODY) {
+        return http_stream_body(conn, buffer, size);
+    }
+    return http_read_request(conn, buffer, size);
+}
+
+// Connection gone or given up on: a half-received body is reported to its sink
+static void http_drop_connection(http_connection_t* conn) {
+    if (conn->body_sink) {
+        http_body_finish(conn, false);
+    }
+    conn->state = HTTP_STATE_IDLE;
+}
+
+// Service one socket; true if it may have another request queued already
+static bool http_service_socket(uint8_t sn, char* buffer, uint16_t size) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    http_connection_t* conn = &g_http_connections[sn];
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    
+    // Acknowledge events so INTn can deassert; state is re-read below
+    uint8_t ir = w5500_read_reg(S0_IR, bsb) & SOCK_IR_EVENTS;
+    if (ir) {
+        w5500_write_reg(S0_IR, bsb, ir);
+    }
+    
+    switch (w5500_read_reg(S0_SR, bsb)) {
+        case SOCK_STAT_ESTABLISHED: {
+            if (conn->state == HTTP_STATE_IDLE) {
+                conn->state = HTTP_STATE_RECEIVING_HEADERS;
+                conn->last_activity_ms = now_ms;
+            }
+            
+            // A stalled upload gets the long timeout, an idle connection the keep-alive one
+            uint32_t idle_limit_ms = (conn->state == HTTP_STATE_RECEIVING_BODY) ?
+                                     Z1_HTTP_TIMEOUT_MS : Z1_HTTP_KEEPALIVE_MS;
+            
+            int served = http_serve_one(conn, buffer, size);
+            if (served < 0 ||
+                (served == 0 && now_ms - conn->last_activity_ms > idle_limit_ms)) {
+                http_drop_connection(conn);
+                w5500_socket_cmd(sn, SOCK_DISCON);
                 break;
+            }
+            // A pipelined request (or the rest of a body) raises no new RECV event
+            return served > 0;
+        }
+            
+        case SOCK_STAT_CLOSE_WAIT:
+            // Peer has finished sending; answer everything it sent, then close
+            while (http_serve_one(conn, buffer, size) > 0) {
+            }
+            http_drop_connection(conn);
+            w5500_socket_cmd(sn, SOCK_DISCON);
+            break;
+            
+        case SOCK_STAT_CLOSED:
+            http_drop_connection(conn);
+            w5500_socket_listen(sn);
+            break;
+            
+        default:
+            // LISTEN, or a transient SYN/FIN state
+            break;
+    }
+    return false;
+}
+
+// Wait until INTn asserts or the timeout passes, driving barrier ticks meanwhile
+static void w5500_wait_for_event(uint32_t timeout_ms) {
+    absolute_time_t deadline = make_timeout_time_ms(timeout_ms);
+    
+    do {
+        if (z1_snn_sync_active()) {
+            z1_snn_sync_service();
+        } else if (timeout_ms > 0) {
+            best_effort_wfe_or_timeout(deadline);
+        }
+    } while (!g_w5500_irq && gpio_get(W5500_INT) && !time_reached(deadline));
+    g_w5500_irq = false;
+}
+
+// ============================================================================
+// UDP Sockets
+// ============================================================================
+
+/**
+ * Open a socket in UDP mode
+ */
+bool w5500_udp_open(uint8_t sn, uint16_t port) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    
+    w5500_socket_cmd(sn, SOCK_CLOSE);
+    w5500_write_reg(S0_IR, bsb, 0xFF);
+    w5500_write_reg(S0_MR, bsb, SOCK_UDP);
+    w5500_write_reg16(S0_PORT0, bsb, port);
+    w5500_write_reg(S0_IMR, bsb, SOCK_IR_RECV);
+    
+    if (!w5500_socket_cmd(sn, SOCK_OPEN) || w5500_read_reg(S0_SR, bsb) != SOCK_STAT_UDP) {
+        printf("[W5500] ❌ Failed to open UDP socket %d\n", sn);
+        return false;
+    }
+    
+    w5500_write_reg(W5500_SIMR, COMMON_REG_BSB,
+                    w5500_read_reg(W5500_SIMR, COMMON_REG_BSB) | (1u << sn));
+    printf("[W5500] ✅ UDP socket %d on port %d\n", sn, port);
+    return true;
+}
+
+/**
+ * Take one datagram out of a UDP socket
+ */
+int w5500_udp_recv(uint8_t sn, uint8_t* buffer, uint16_t size, uint8_t ip[4], uint16_t* port) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    
+    // Acknowledge RECV so INTn can deassert; the RX size is re-read below
+    if (w5500_read_reg(S0_IR, bsb) & SOCK_IR_RECV) {
+        w5500_write_reg(S0_IR, bsb, SOCK_IR_RECV);
+    }
+    
+    uint16_t rx_size = w5500_read_counter(S0_RX_RSR, bsb);
+    if (rx_size < W5500_UDP_HEADER_SIZE) {
+        return 0;
+    }
+    
+    uint16_t rx_rd_ptr = w5500_read_reg16(S0_RX_RD, bsb);
+    uint8_t header[W5500_UDP_HEADER_SIZE];
+    w5500_rx_read(sn, rx_rd_ptr, header, sizeof(header));
+    
+    uint16_t length = (header[6] << 8) | header[7];
+    if (W5500_UDP_HEADER_SIZE + length > rx_size) {
+        // The W5500 stores whole datagrams: the buffer pointers are off
+        printf("[W5500] ⚠️  UDP socket %d out of sync, reopening\n", sn);
+        w5500_udp_open(sn, w5500_read_reg16(S0_PORT0, bsb));
+        return -1;
+    }
+    
+    memcpy(ip, header, 4);
+    *port = (header[4] << 8) | header[5];
+    
+    // Oversized datagrams are truncated; the rest is skipped
+    uint16_t n = (length < size) ? length : size;
+    w5500_rx_read(sn, rx_rd_ptr + W5500_UDP_HEADER_SIZE, buffer, n);
+    w5500_rx_consume(sn, rx_rd_ptr, W5500_UDP_HEADER_SIZE + length);
+    return n;
+}
+
+/**
+ * Send one datagram from a UDP socket
+ */
+bool w5500_udp_send(uint8_t sn, const uint8_t ip[4], uint16_t port,
+                    const uint8_t* data, uint16_t length) {
+    uint8_t bsb = SOCKET_REG_BSB(sn);
+    absolute_time_t deadline = make_timeout_time_ms(W5500_CMD_TIMEOUT_MS);
+    
+    if (length == 0 || length > W5500_SOCK_BUF_SIZE) {
+        return false;
+    }
+    
+    // A datagram goes out whole: wait for room for all of it
+    while (w5500_read_counter(S0_TX_FSR, bsb) < length) {
+        if (time_reached(deadline)) {
+            return false;
         }
+        sleep_us(10);
+    }
+    
+    uint8_t dport[2] = {port >> 8, port & 0xFF};
+    w5500_write_buf(S0_DIPR0, bsb, ip, 4);
+    w5500_write_buf(S0_DPORT0, bsb, dport, 2);
+    
+    uint16_t tx_wr_ptr = w5500_read_reg16(S0_TX_WR, bsb);
+    w5500_tx_write(sn, tx_wr_ptr, data, length);
+    w5500_write_reg16(S0_TX_WR, bsb, tx_wr_ptr + length);
+    
+    // TIMEOUT here means ARP found no host at ip
+    return w5500_send_and_wait(sn, deadline);
+}
+
+// ============================================================================
+// Main HTTP Server Loop
+// ============================================================================
+
+void w5500_http_server_run(void) {
+    printf("[HTTP] Server running...\n");
+    z1_display_status("HTTP listening");
+    
+    static char request_buffer[Z1_HTTP_BUFFER_SIZE];
+    uint8_t first = 0;
+    
+    while (true) {
+        // Round-robin, one request per socket per pass, rotating who goes first
+        bool busy = false;
+        for (uint8_t i = 0; i < Z1_HTTP_MAX_CONNECTIONS; i++) {
+            uint8_t sn = (first + i) % Z1_HTTP_MAX_CONNECTIONS;
+            busy |= http_service_socket(sn, request_buffer, sizeof(request_buffer));
+        }
+        first = (first + 1) % Z1_HTTP_MAX_CONNECTIONS;
+        
+        // Injected datagrams and the output push of a subscribed host
+        busy |= z1_udp_spikes_service();
+        
+        // Spikes for other backplanes, sent to the peer controllers once per step
+        busy |= z1_gateway_service();
+        
+        // Input spikes of the tensor being encoded, once per step
+        busy |= z1_encoder_service();
+        
+        // Status endpoints read the table this keeps current
+        z1_telemetry_service(busy);
+        
+        // Trace records are formatted here, away from the bus paths
+        z1_trace_drain_stdio(Z1_TRACE_DRAIN_PER_LOOP);
+        
+        // OLED refresh (rate-limited, DMA); request handlers only record state
+        z1_display_service();
         
-        sleep_ms(10);
+        // INTn stays low while any socket has unacknowledged events
+        w5500_wait_for_event(busy ? 0 : W5500_IDLE_WAIT_MS);
     }
 }
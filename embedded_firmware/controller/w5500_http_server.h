@@ -28,4 +28,30 @@ void w5500_http_server_run(void);
 uint8_t w5500_read_reg(uint16_t addr, uint8_t bsb);
 void w5500_write_reg(uint16_t addr, uint8_t bsb, uint8_t data);
 
+// Burst access: one SPI frame (variable-length data mode) for a run of
+// consecutive addresses; the data phase uses DMA from 16 bytes on
+void w5500_read_buf(uint16_t addr, uint8_t bsb, uint8_t* buffer, uint16_t length);
+void w5500_write_buf(uint16_t addr, uint8_t bsb, const uint8_t* data, uint16_t length);
+
+// Streaming TX access for z1_http_stream_*(). w5500_tx_begin() waits until
+// at least min bytes (capped at the 2 KB buffer) are free and returns the
+// write pointer they start at; w5500_tx_put() copies at any pointer inside
+// that space and w5500_tx_commit() sends up to wr_ptr, waiting for SEND_OK.
+// Begin and commit return false once the peer has gone or time ran out.
+bool w5500_tx_begin(uint8_t sn, uint16_t min, uint16_t* wr_ptr, uint16_t* room);
+void w5500_tx_put(uint8_t sn, uint16_t ptr, const uint8_t* data, uint16_t length);
+bool w5500_tx_commit(uint8_t sn, uint16_t wr_ptr);
+
+// UDP sockets. Received datagrams keep their sender; a socket with
+// datagrams waiting raises INTn like the HTTP sockets.
+bool w5500_udp_open(uint8_t sn, uint16_t port);
+
+// Take one datagram: payload bytes copied (truncated to size), 0 if none,
+// -1 if the socket had to be reopened
+int w5500_udp_recv(uint8_t sn, uint8_t* buffer, uint16_t size, uint8_t ip[4], uint16_t* port);
+
+// Send one datagram (at most one socket buffer); false if it did not go out
+bool w5500_udp_send(uint8_t sn, const uint8_t ip[4], uint16_t port,
+                    const uint8_t* data, uint16_t length);
+
 #endif // W5500_HTTP_SERVER_H
@@ -0,0 +1,200 @@
+/**
+ * Z1 Batch Inference
+ *
+ * Staging runs in the foreground of the request that uploads the batch.
+ * Each node's image is written straight to its staging area; nothing is
+ * kept in controller PSRAM.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_batch.h"
+#include "z1_protocol_extended.h"
+#include "../common/z1_crc32.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+// Image being written to one node
+typedef struct {
+    uint32_t capacity;          // Staging bytes on the node
+    uint32_t count;             // Entries added
+    uint32_t written;           // Entry bytes on the node
+    uint32_t last;              // (sample << 16) | step of the last entry
+    uint32_t crc;
+    bool failed;
+    uint16_t fill;
+    uint8_t buffer[Z1_BATCH_WRITE_BLOCK];
+} z1_batch_image_t;
+
+static z1_batch_image_t g_images[Z1_MAX_NODES];
+static z1_batch_stage_info_t g_stage;
+
+// ============================================================================
+// Staging
+// ============================================================================
+
+// Write a node's buffered entries behind those already written
+static void flush_image(uint8_t node) {
+    z1_batch_image_t* image = &g_images[node];
+    if (image->fill == 0 || image->failed) {
+        return;
+    }
+
+    uint32_t addr = Z1_SNN_BATCH_ADDR + sizeof(z1_snn_batch_header_t) + image->written;
+    if (z1_write_node_memory(node, addr, image->buffer, image->fill) != image->fill) {
+        printf("[Batch] Node %d: write at 0x%08lX failed\n", node, (unsigned long)addr);
+        image->failed = true;
+        return;
+    }
+    image->crc = z1_crc32_update(image->crc, image->buffer, image->fill);
+    image->written += image->fill;
+    g_stage.bytes += image->fill;
+    image->fill = 0;
+}
+
+/**
+ * Begin staging a batch on the target nodes
+ */
+bool z1_batch_stage_begin(uint16_t node_mask, uint16_t steps_per_sample, uint16_t sample_count) {
+    memset(&g_stage, 0, sizeof(g_stage));
+    if (node_mask == 0 || steps_per_sample == 0 || sample_count == 0) {
+        printf("[Batch] ERROR: Empty batch\n");
+        return false;
+    }
+
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(node_mask & (1u << node))) {
+            continue;
+        }
+
+        z1_batch_image_t* image = &g_images[node];
+        z1_snn_batch_info_t info;
+        if (!z1_batch_query(node, &info)) {
+            printf("[Batch] Node %d: no answer to the capacity query\n", node);
+            return false;
+        }
+        memset(image, 0, offsetof(z1_batch_image_t, buffer));
+        image->capacity = info.capacity;
+    }
+
+    g_stage.node_mask = node_mask;
+    g_stage.steps_per_sample = steps_per_sample;
+    g_stage.sample_count = sample_count;
+    return true;
+}
+
+/**
+ * Add an input to a node's image
+ */
+bool z1_batch_stage_add(uint8_t node, const z1_snn_batch_input_t* input) {
+    if (node >= Z1_MAX_NODES || !(g_stage.node_mask & (1u << node))) {
+        return false;
+    }
+
+    z1_batch_image_t* image = &g_images[node];
+    uint16_t step = input->step & ~Z1_SNN_BATCH_HOLD;
+    uint32_t key = ((uint32_t)input->sample << 16) | step;
+    uint32_t length = sizeof(z1_snn_batch_header_t) + (image->count + 1) * sizeof(*input);
+    if (image->failed || key < image->last || input->sample >= g_stage.sample_count ||
+        step >= g_stage.steps_per_sample || length > image->capacity) {
+        return false;
+    }
+
+    memcpy(image->buffer + image->fill, input, sizeof(*input));
+    image->fill += sizeof(*input);
+    image->count++;
+    image->last = key;
+    g_stage.inputs++;
+
+    if (image->fill + sizeof(*input) > sizeof(image->buffer)) {
+        flush_image(node);
+    }
+    return !image->failed;
+}
+
+/**
+ * Write the remaining entries and the image headers
+ */
+bool z1_batch_stage_end(void) {
+    uint16_t written = 0;
+
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(g_stage.node_mask & (1u << node))) {
+            continue;
+        }
+
+        z1_batch_image_t* image = &g_images[node];
+        flush_image(node);
+        if (image->failed) {
+            continue;
+        }
+
+        z1_snn_batch_header_t header = {
+            .magic = Z1_SNN_BATCH_MAGIC,
+            .version = Z1_SNN_BATCH_VERSION,
+            .steps_per_sample = g_stage.steps_per_sample,
+            .sample_count = g_stage.sample_count,
+            .input_count = image->count,
+            .length = sizeof(header) + image->written,
+            .crc32 = image->crc,
+        };
+        if (z1_write_node_memory(node, Z1_SNN_BATCH_ADDR, (const uint8_t*)&header,
+                                 sizeof(header)) != sizeof(header)) {
+            printf("[Batch] Node %d: header write failed\n", node);
+            continue;
+        }
+        g_stage.bytes += sizeof(header);
+        written |= 1u << node;
+    }
+
+    g_stage.staged = written == g_stage.node_mask;
+    printf("[Batch] Staged %d samples x %d steps on nodes 0x%04X: %lu inputs, %lu bytes\n",
+           g_stage.sample_count, g_stage.steps_per_sample, written,
+           (unsigned long)g_stage.inputs, (unsigned long)g_stage.bytes);
+    return g_stage.staged;
+}
+
+/**
+ * Describe the staged batch
+ */
+void z1_batch_get_stage(z1_batch_stage_info_t* info) {
+    *info = g_stage;
+}
+
+// ============================================================================
+// Run
+// ============================================================================
+
+/**
+ * Start the staged batch on its nodes
+ */
+bool z1_batch_start(void) {
+    if (!g_stage.staged) {
+        printf("[Batch] ERROR: No batch staged\n");
+        return false;
+    }
+
+    // Nodes of one network change sample together only on the barrier
+    bool sync = __builtin_popcount(g_stage.node_mask) > 1;
+    uint32_t steps = (uint32_t)g_stage.steps_per_sample * g_stage.sample_count;
+    return z1_start_snn_batch(g_stage.node_mask, sync, steps);
+}
+
+/**
+ * Ask a node for its batch progress
+ */
+bool z1_batch_query(uint8_t node, z1_snn_batch_info_t* info) {
+    int length = z1_bus_request(node, Z1_CMD_SNN_BATCH, NULL, 0, (uint8_t*)info,
+                                sizeof(*info), Z1_BATCH_QUERY_TIMEOUT_MS);
+    if (length != (int)sizeof(*info)) {
+        memset(info, 0, sizeof(*info));
+        info->status = Z1_SNN_BATCH_STATUS_FAILED;
+        return false;
+    }
+    return true;
+}
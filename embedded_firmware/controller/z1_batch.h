@@ -0,0 +1,107 @@
+/**
+ * Z1 Batch Inference
+ *
+ * Stages a batch of samples on the nodes and starts it (see "Batch
+ * Inference" in z1_protocol.h):
+ *
+ *   stage    inputs come in (sample, step) order with their node; each
+ *            node's entries collect in an SRAM buffer that is written
+ *            behind its image header when full, with a running CRC32; the
+ *            headers go last, so a node never sees a partial image as valid
+ *   run      the nodes go through every sample without controller traffic;
+ *            a batch on more than one node runs on the timestep barrier
+ *   results  each node keeps per-sample output spike counts behind its
+ *            image, read back with the windowed memory read
+ *
+ * Staging replaces the deployed table in the nodes' staging areas: the
+ * loaded network is unchanged, but the next deploy sends all its chunks.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_BATCH_H
+#define Z1_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_BATCH_WRITE_BLOCK        512     // Image bytes per node memory write
+#define Z1_BATCH_QUERY_TIMEOUT_MS   200
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Staged batch
+ */
+typedef struct {
+    bool staged;                // Headers written, batch can start
+    uint16_t node_mask;         // Nodes with an image
+    uint16_t steps_per_sample;
+    uint16_t sample_count;
+    uint32_t inputs;            // Entries staged over all nodes
+    uint32_t bytes;             // Image bytes written
+} z1_batch_stage_info_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Begin staging a batch on the target nodes
+ *
+ * Asks each node for its staging capacity. The SNN must be stopped.
+ *
+ * @param node_mask Nodes of the network (all get an image, inputs or not)
+ * @param steps_per_sample Steps each sample runs
+ * @param sample_count Samples in the batch
+ * @return false if a node does not answer or a parameter is 0
+ */
+bool z1_batch_stage_begin(uint16_t node_mask, uint16_t steps_per_sample, uint16_t sample_count);
+
+/**
+ * Add an input to a node's image
+ *
+ * @param node Target node (in the staged node mask)
+ * @param input Entry, after the previous one of the node in (sample, step) order
+ * @return false if out of order or range, the image is full or a write failed
+ */
+bool z1_batch_stage_add(uint8_t node, const z1_snn_batch_input_t* input);
+
+/**
+ * Write the remaining entries and the image headers
+ *
+ * @return true if every node's image was written
+ */
+bool z1_batch_stage_end(void);
+
+/**
+ * Describe the staged batch
+ *
+ * @param info Filled with the staged nodes and sizes
+ */
+void z1_batch_get_stage(z1_batch_stage_info_t* info);
+
+/**
+ * Start the staged batch on its nodes
+ *
+ * @return false if nothing is staged or the start failed
+ */
+bool z1_batch_start(void);
+
+/**
+ * Ask a node for its batch progress (Z1_CMD_SNN_BATCH)
+ *
+ * @param node Node
+ * @param info Filled with the answer
+ * @return false if the node does not answer
+ */
+bool z1_batch_query(uint8_t node, z1_snn_batch_info_t* info);
+
+#endif // Z1_BATCH_H
@@ -0,0 +1,171 @@
+/**
+ * Z1 Matrix Bus PIO Backend
+ *
+ * PIO state machines run the BUSCLK/BUSACK frame handshake and DMA moves
+ * frames between memory and the 16 data lanes (GPIO12-27). Arbitration
+ * (BUSATTN), addressing (BUSSELECT) and broadcast hold timing stay on the
+ * CPU in z1_matrix_bus.c.
+ *
+ * Selected at configure time with -DZ1_BUS_BACKEND=PIO. Every node on a
+ * backplane must use the same backend: the PIO transmitter clocks frames
+ * far faster than the GPIO receiver polls.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_BUS_PIO_H
+#define Z1_BUS_PIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_BUS_PIO_MAX_FRAMES        512       // Frames per DMA transfer
+#define Z1_BUS_PIO_DEFAULT_FRAME_HZ  1000000   // Default frame rate (1 MHz)
+#define Z1_BUS_PIO_TX_CYCLES         27        // TX state machine cycles per frame
+#define Z1_BUS_PIO_LAST_FRAME        0x10000   // TX word flag: hold BUSCLK for BUSACK release
+
+// Frame rate applied by z1_bus_pio_init() (frames per second)
+extern volatile uint32_t z1_bus_pio_frame_hz;
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * PIO backend statistics
+ */
+typedef struct {
+    uint32_t tx_frames;      // Frames clocked out
+    uint32_t rx_frames;      // Frames latched
+    uint32_t tx_timeouts;    // Transfers aborted waiting for BUSACK
+    uint32_t rx_timeouts;    // Receives aborted waiting for BUSCLK
+} z1_bus_pio_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Initialize PIO state machines and DMA channels
+ *
+ * Claims one PIO0 state machine each for TX and RX and two DMA channels.
+ * BUSCLK and the data lanes are handed to PIO and left released.
+ *
+ * @return true if successful
+ */
+bool z1_bus_pio_init(void);
+
+/**
+ * Change frame rate
+ *
+ * @param frame_hz Frames per second
+ * @return true if successful
+ */
+bool z1_bus_pio_set_frame_rate(uint32_t frame_hz);
+
+/**
+ * Drive BUSCLK and data lanes from the TX state machine (bus owner)
+ */
+void z1_bus_pio_attach(void);
+
+/**
+ * Release BUSCLK and data lanes (listening)
+ */
+void z1_bus_pio_detach(void);
+
+/**
+ * Hand data lanes back to SIO for CPU-driven broadcast
+ */
+void z1_bus_pio_pins_to_sio(void);
+
+/**
+ * Return data lanes to PIO after a CPU-driven broadcast
+ */
+void z1_bus_pio_pins_to_pio(void);
+
+/**
+ * Start frame transfer (returns immediately)
+ *
+ * The caller must own the bus and have called z1_bus_pio_attach().
+ * Longer streams are sent as consecutive chunks under the same bus
+ * claim, with last set only on the final chunk.
+ *
+ * @param frames Frames to send (copied)
+ * @param count Number of frames (1 to Z1_BUS_PIO_MAX_FRAMES)
+ * @param last true if this chunk ends the transaction
+ * @return true if the transfer was started
+ */
+bool z1_bus_pio_send_start(const uint16_t* frames, uint16_t count, bool last);
+
+/**
+ * Wait for the transfer started by z1_bus_pio_send_start()
+ *
+ * A final chunk completes when the receiver releases BUSACK after the
+ * last frame; other chunks complete once DMA has queued every frame.
+ * On timeout the state machine is reset and the transfer dropped.
+ *
+ * @param timeout_us Timeout in microseconds
+ * @return true if all frames were accepted
+ */
+bool z1_bus_pio_send_wait(uint32_t timeout_us);
+
+/**
+ * Send frames (start + wait)
+ *
+ * @param frames Frames to send
+ * @param count Number of frames
+ * @param timeout_us Timeout in microseconds
+ * @return true if all frames were accepted
+ */
+bool z1_bus_pio_send(const uint16_t* frames, uint16_t count, uint32_t timeout_us);
+
+/**
+ * Arm receiver for a fixed number of frames
+ *
+ * Must be called before BUSACK is pulled low, since the sender starts
+ * clocking as soon as it sees the ACK.
+ *
+ * @param frames Buffer to receive frames
+ * @param count Number of frames expected
+ * @return true if armed
+ */
+bool z1_bus_pio_receive_start(uint16_t* frames, uint16_t count);
+
+/**
+ * Receive further frames of the same transaction
+ *
+ * Re-arms DMA only; the state machine keeps latching into its FIFO.
+ *
+ * @param frames Buffer to receive frames (2-byte aligned)
+ * @param count Number of frames expected
+ * @return true if armed
+ */
+bool z1_bus_pio_receive_continue(uint16_t* frames, uint16_t count);
+
+/**
+ * Wait for the receive armed by z1_bus_pio_receive_start/continue()
+ *
+ * The state machine is left running for z1_bus_pio_receive_continue().
+ *
+ * @param timeout_us Timeout in microseconds
+ * @return true if all frames were received
+ */
+bool z1_bus_pio_receive_wait(uint32_t timeout_us);
+
+/**
+ * Stop receiver at the end of a transaction
+ */
+void z1_bus_pio_receive_stop(void);
+
+/**
+ * Get backend statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_bus_pio_get_stats(z1_bus_pio_stats_t* stats);
+
+#endif // Z1_BUS_PIO_H
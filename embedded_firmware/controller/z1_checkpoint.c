@@ -0,0 +1,232 @@
+/**
+ * Z1 Cluster Checkpoints
+ *
+ * Runs in the foreground of the request that asked for it. Images travel
+ * in Z1_MEM_READ_BLOCK pieces through one SRAM buffer between the bus and
+ * the store.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_checkpoint.h"
+#include "z1_matrix_bus.h"
+#include "z1_protocol_extended.h"
+#include "psram_rp2350.h"
+#include "../common/z1_crc32.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    bool stored;
+    z1_snn_ckpt_info_t info;
+} z1_ckpt_slot_t;
+
+static z1_ckpt_slot_t g_slots[Z1_MAX_NODES];
+
+static uint8_t g_ckpt_buffer[Z1_MEM_READ_BLOCK] __attribute__((aligned(4)));
+
+static inline uint32_t ckpt_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static uint32_t slot_size(void) {
+    size_t psram = psram_get_size();
+    uint32_t used = Z1_CKPT_STORE_ADDR - PSRAM_BASE_ADDRESS;
+    return (psram > used) ? (uint32_t)((psram - used) / Z1_MAX_NODES) & ~0xFFFu : 0;
+}
+
+static inline uint32_t slot_addr(uint8_t node) {
+    return Z1_CKPT_STORE_ADDR + node * slot_size();
+}
+
+// ============================================================================
+// Save
+// ============================================================================
+
+// Stream a described image from the node into its slot, checking its CRC32
+static uint8_t save_image(uint8_t node, const z1_snn_ckpt_info_t* info) {
+    if (info->length > slot_size()) {
+        printf("[Checkpoint] Node %d: image of %lu bytes does not fit the %lu byte slot\n",
+               node, (unsigned long)info->length, (unsigned long)slot_size());
+        return Z1_SNN_CKPT_STATUS_TOO_LARGE;
+    }
+    if (!z1_mem_read_begin(node, Z1_SNN_CKPT_ADDR, info->length)) {
+        return Z1_SNN_CKPT_STATUS_FAILED;
+    }
+
+    // The header is not covered by its own crc32
+    uint32_t crc = 0;
+    uint32_t offset = 0;
+    while (offset < info->length) {
+        int n = z1_mem_read_next(g_ckpt_buffer, sizeof(g_ckpt_buffer), Z1_MEM_READ_NEXT_TIMEOUT_MS);
+        if (n <= 0 || !psram_write(slot_addr(node) + offset, g_ckpt_buffer, n)) {
+            break;
+        }
+
+        uint32_t skip = (offset < sizeof(z1_snn_ckpt_header_t)) ?
+                        sizeof(z1_snn_ckpt_header_t) - offset : 0;
+        if (skip < (uint32_t)n) {
+            crc = z1_crc32_update(crc, g_ckpt_buffer + skip, n - skip);
+        }
+        offset += n;
+    }
+    z1_mem_read_end();
+
+    if (offset < info->length) {
+        return Z1_SNN_CKPT_STATUS_FAILED;
+    }
+    if (crc != info->crc32) {
+        printf("[Checkpoint] Node %d: image CRC32 0x%08lX, expected 0x%08lX\n",
+               node, (unsigned long)crc, (unsigned long)info->crc32);
+        return Z1_SNN_CKPT_STATUS_BAD_IMAGE;
+    }
+    return Z1_SNN_CKPT_STATUS_OK;
+}
+
+/**
+ * Save a checkpoint of the target nodes
+ */
+bool z1_checkpoint_save(uint16_t node_mask, z1_checkpoint_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    result->targets = node_mask;
+    uint32_t start_ms = ckpt_now_ms();
+
+    // Single frames, not answered: every node serializes while the next is told
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (node_mask & (1u << node)) {
+            g_slots[node].stored = false;
+            if (!z1_bus_write(node, Z1_CMD_SNN_CHECKPOINT, Z1_SNN_CKPT_SAVE)) {
+                printf("[Checkpoint] Node %d: save request failed\n", node);
+            }
+        }
+    }
+
+    // A node answers the query once its save is done
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(node_mask & (1u << node))) {
+            continue;
+        }
+
+        z1_snn_ckpt_info_t* info = &result->nodes[node];
+        uint8_t query = Z1_SNN_CKPT_QUERY;
+        int length = z1_bus_request(node, Z1_CMD_SNN_CHECKPOINT, &query, 1, (uint8_t*)info,
+                                    sizeof(*info), Z1_CKPT_SAVE_TIMEOUT_MS);
+        if (length != (int)sizeof(*info)) {
+            memset(info, 0, sizeof(*info));
+            info->status = Z1_SNN_CKPT_STATUS_FAILED;
+            continue;
+        }
+        if (info->status == Z1_SNN_CKPT_STATUS_OK) {
+            info->status = save_image(node, info);
+        }
+        if (info->status != Z1_SNN_CKPT_STATUS_OK) {
+            printf("[Checkpoint] Node %d: not saved (status %d)\n", node, info->status);
+            continue;
+        }
+
+        g_slots[node].info = *info;
+        g_slots[node].stored = true;
+        result->done_mask |= 1u << node;
+        result->bytes += info->length;
+    }
+
+    result->elapsed_ms = ckpt_now_ms() - start_ms;
+    printf("[Checkpoint] Saved %d of %d nodes, %lu bytes in %lu ms\n",
+           __builtin_popcount(result->done_mask), __builtin_popcount(node_mask),
+           (unsigned long)result->bytes, (unsigned long)result->elapsed_ms);
+    return result->done_mask == node_mask;
+}
+
+// ============================================================================
+// Restore
+// ============================================================================
+
+// Write a stored image back to the node's staging area
+static bool restore_image(uint8_t node, uint32_t length) {
+    for (uint32_t offset = 0; offset < length; offset += sizeof(g_ckpt_buffer)) {
+        uint16_t n = (length - offset < sizeof(g_ckpt_buffer)) ? length - offset : sizeof(g_ckpt_buffer);
+        if (!psram_read(slot_addr(node) + offset, g_ckpt_buffer, n) ||
+            z1_write_node_memory(node, Z1_SNN_CKPT_ADDR + offset, g_ckpt_buffer, n) != n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Restore the stored checkpoint on the target nodes
+ */
+bool z1_checkpoint_restore(uint16_t node_mask, z1_checkpoint_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    result->targets = node_mask;
+    uint32_t start_ms = ckpt_now_ms();
+
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(node_mask & (1u << node))) {
+            continue;
+        }
+
+        z1_snn_ckpt_info_t* info = &result->nodes[node];
+        if (!z1_checkpoint_get_info(node, info)) {
+            continue;
+        }
+        if (!restore_image(node, info->length)) {
+            info->status = Z1_SNN_CKPT_STATUS_FAILED;
+            continue;
+        }
+        result->bytes += info->length;
+
+        // The node checks the whole image before applying any of it
+        int length = z1_bus_request(node, Z1_CMD_SNN_RESTORE, NULL, 0, (uint8_t*)info,
+                                    sizeof(*info), Z1_CKPT_RESTORE_TIMEOUT_MS);
+        if (length != (int)sizeof(*info)) {
+            info->status = Z1_SNN_CKPT_STATUS_FAILED;
+        }
+        if (info->status != Z1_SNN_CKPT_STATUS_OK) {
+            printf("[Checkpoint] Node %d: not restored (status %d)\n", node, info->status);
+            continue;
+        }
+        result->done_mask |= 1u << node;
+    }
+
+    result->elapsed_ms = ckpt_now_ms() - start_ms;
+    printf("[Checkpoint] Restored %d of %d nodes, %lu bytes in %lu ms\n",
+           __builtin_popcount(result->done_mask), __builtin_popcount(node_mask),
+           (unsigned long)result->bytes, (unsigned long)result->elapsed_ms);
+    return result->done_mask == node_mask;
+}
+
+// ============================================================================
+// Store
+// ============================================================================
+
+/**
+ * Describe the stored image of a node
+ */
+bool z1_checkpoint_get_info(uint8_t node_id, z1_snn_ckpt_info_t* info) {
+    if (node_id >= Z1_MAX_NODES || !g_slots[node_id].stored) {
+        memset(info, 0, sizeof(*info));
+        info->status = Z1_SNN_CKPT_STATUS_NONE;
+        return false;
+    }
+    *info = g_slots[node_id].info;
+    return true;
+}
+
+/**
+ * Get the nodes with a stored image
+ */
+uint16_t z1_checkpoint_stored_mask(void) {
+    uint16_t mask = 0;
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (g_slots[node].stored) {
+            mask |= 1u << node;
+        }
+    }
+    return mask;
+}
@@ -0,0 +1,96 @@
+/**
+ * Z1 Cluster Checkpoints
+ *
+ * Saves and restores the run state of a stopped SNN across the nodes (see
+ * "SNN Checkpoints" in z1_protocol.h):
+ *
+ *   save     every target is told to serialize first, so the nodes work in
+ *            parallel; then each image is described, streamed back with
+ *            the windowed memory read and kept in controller PSRAM after
+ *            the firmware staging copy
+ *   restore  each stored image is written back to its node's staging area
+ *            and applied there; the deployed topology is not sent again
+ *
+ * One checkpoint is kept per node, in a slot of 1/Z1_MAX_NODES of the PSRAM
+ * above the firmware copy; a save replaces the images of the nodes it
+ * covers. The store is lost on reset.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_CHECKPOINT_H
+#define Z1_CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "z1_protocol.h"
+#include "z1_firmware_dist.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_CKPT_STORE_ADDR          (Z1_FW_DIST_STAGING_ADDR + Z1_FW_DIST_MAX_IMAGE)
+#define Z1_CKPT_SAVE_TIMEOUT_MS     3000    // Serializing on the node, first answer
+#define Z1_CKPT_RESTORE_TIMEOUT_MS  3000    // Checking and applying on the node
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Outcome of a save or restore
+ */
+typedef struct {
+    uint16_t targets;           // Nodes asked
+    uint16_t done_mask;         // Nodes saved or restored
+    uint32_t bytes;             // Image bytes moved over the bus
+    uint32_t elapsed_ms;
+    z1_snn_ckpt_info_t nodes[Z1_MAX_NODES];  // Per-node image and status (answered or local)
+} z1_checkpoint_result_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Save a checkpoint of the target nodes into controller PSRAM
+ *
+ * The SNN must be stopped. A node that does not answer is reported with
+ * Z1_SNN_CKPT_STATUS_FAILED; its stored image, if any, is dropped.
+ *
+ * @param node_mask Target nodes
+ * @param result Filled with the per-node outcome
+ * @return true if every target's image was stored
+ */
+bool z1_checkpoint_save(uint16_t node_mask, z1_checkpoint_result_t* result);
+
+/**
+ * Restore the stored checkpoint on the target nodes
+ *
+ * Each node must have the network the checkpoint was saved from loaded; a
+ * node without a stored image is reported with Z1_SNN_CKPT_STATUS_NONE.
+ *
+ * @param node_mask Target nodes
+ * @param result Filled with the per-node outcome
+ * @return true if every target restored its image
+ */
+bool z1_checkpoint_restore(uint16_t node_mask, z1_checkpoint_result_t* result);
+
+/**
+ * Describe the stored image of a node
+ *
+ * @param node_id Node
+ * @param info Filled with the image description (status NONE if not stored)
+ * @return true if an image is stored
+ */
+bool z1_checkpoint_get_info(uint8_t node_id, z1_snn_ckpt_info_t* info);
+
+/**
+ * Get the nodes with a stored image
+ *
+ * @return Node mask
+ */
+uint16_t z1_checkpoint_stored_mask(void);
+
+#endif // Z1_CHECKPOINT_H
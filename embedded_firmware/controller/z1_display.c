@@ -1,13 +1,17 @@
 /**
  * Z1 Display Helper - SSD1306 OLED Status Updates
  * 
- * Provides display update functions for controller status
+ * Provides display update functions for controller status. The update
+ * functions only record what to show; z1_display_service() redraws from
+ * the main loop at most every Z1_DISPLAY_REFRESH_MS and sends the pages
+ * that differ from the shadow copy of the panel by I2C DMA.
  * 
  * Copyright NeuroFab Corp. All rights reserved.
  */
 
 #include "z1_display.h"
 #include "ssd1306.h"
+#include "pico/time.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -25,6 +29,16 @@ static bool http_active = false;
 static uint8_t active_nodes = 0;
 static bool snn_running = false;
 static uint32_t total_spikes = 0;
+static char status_text[43] = "";
+
+// Refresh state: what the panel shows (valid once a frame went out whole)
+static uint8_t shadow[SSD1306_WIDTH * SSD1306_PAGES];
+static bool shadow_valid = false;
+static bool dma_ready = false;
+static bool loop_running = false;   // Set by the first z1_display_service()
+static bool changed = false;        // Content changed since the last redraw
+static uint32_t last_refresh_ms = 0;
+static z1_display_stats_t stats = {0};
 
 // Initialize display
 bool z1_display_init(void) {
@@ -44,16 +58,17 @@ bool z1_display_init(void) {
     ssd1306_draw_line(0, 10, 127, 10);
     ssd1306_write_line("Booting...", 3);
     ssd1306_display_update();
+    memcpy(shadow, ssd1306_get_buffer(), sizeof(shadow));
+    shadow_valid = true;
+    
+    // Without DMA every refresh is a blocking full-frame update
+    dma_ready = ssd1306_dma_init();
     
     return true;
 }
 
-// Helper to update full display
-static void update_display(const char* status_line) {
-    if (!display_initialized) {
-        return;
-    }
-    
+// Draw the whole screen into the frame buffer
+static void render(const char* status_line) {
     ssd1306_display_clear();
     
     // Line 0: Title
@@ -98,8 +113,97 @@ static void update_display(const char* status_line) {
     } else {
         ssd1306_write_line(status_line, 6);
     }
+}
+
+// Redraw and send the pages that changed
+static void refresh(void) {
+    render(status_text);
+    changed = false;
+    last_refresh_ms = to_ms_since_boot(get_absolute_time());
+    stats.refreshes++;
     
-    ssd1306_display_update();
+    const uint8_t* frame = ssd1306_get_buffer();
+    uint8_t dirty = 0;
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        const uint8_t* row = frame + page * SSD1306_WIDTH;
+        if (!shadow_valid || memcmp(row, shadow + page * SSD1306_WIDTH, SSD1306_WIDTH) != 0) {
+            dirty |= 1u << page;
+            stats.pages_sent++;
+        }
+    }
+    if (dirty == 0) {
+        return;
+    }
+    
+    memcpy(shadow, frame, sizeof(shadow));
+    shadow_valid = true;
+    if (!dma_ready || !ssd1306_update_pages_async(dirty)) {
+        ssd1306_display_update();
+    }
+}
+
+// Record a new status line; before the main loop runs, show it at once
+static void update_display(const char* status_line) {
+    if (!display_initialized) {
+        return;
+    }
+    
+    strncpy(status_text, status_line, sizeof(status_text) - 1);
+    status_text[sizeof(status_text) - 1] = '\0';
+    
+    if (changed) {
+        stats.coalesced++;
+    }
+    changed = true;
+    
+    if (!loop_running) {
+        z1_display_flush();
+    }
+}
+
+// Refresh when due (main loop)
+void z1_display_service(void) {
+    loop_running = true;
+    if (!display_initialized) {
+        return;
+    }
+    
+    // One transfer at a time; a failed one leaves the panel unknown
+    bool failed = false;
+    if (ssd1306_update_busy(&failed)) {
+        return;
+    }
+    if (failed) {
+        stats.failures++;
+        shadow_valid = false;
+        changed = true;
+    }
+    
+    if (changed && to_ms_since_boot(get_absolute_time()) - last_refresh_ms >= Z1_DISPLAY_REFRESH_MS) {
+        refresh();
+    }
+}
+
+// Show pending changes now and wait for the transfer
+void z1_display_flush(void) {
+    if (!display_initialized) {
+        return;
+    }
+    
+    while (ssd1306_update_busy(NULL)) {
+        tight_loop_contents();
+    }
+    if (changed) {
+        refresh();
+    }
+    while (ssd1306_update_busy(NULL)) {
+        tight_loop_contents();
+    }
+}
+
+// Get refresh statistics
+void z1_display_get_stats(z1_display_stats_t* out) {
+    *out = stats;
 }
 
 // Update display with status message
@@ -1,7 +1,9 @@
 /**
  * Z1 Display Helper - SSD1306 OLED Status Updates
  * 
- * Provides display update functions for controller status
+ * Provides display update functions for controller status. Updates only
+ * record the new content; the screen is redrawn by z1_display_service()
+ * from the main loop, so they cost no I2C time on the request path.
  * 
  * Copyright NeuroFab Corp. All rights reserved.
  */
@@ -12,6 +14,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Shortest time between two refreshes; updates in between are coalesced
+#ifndef Z1_DISPLAY_REFRESH_MS
+#define Z1_DISPLAY_REFRESH_MS 200
+#endif
+
+// Refresh statistics
+typedef struct {
+    uint32_t refreshes;     // Redraws
+    uint32_t pages_sent;    // Pages that differed from the panel
+    uint32_t coalesced;     // Updates merged into a later redraw
+    uint32_t failures;      // Transfers that failed (panel resent whole)
+} z1_display_stats_t;
+
 // Initialize display
 bool z1_display_init(void);
 
@@ -33,4 +48,13 @@ void z1_display_http_request(const char* method, const char* path);
 // Update display with error message
 void z1_display_error(const char* error);
 
+// Refresh the screen when due and changed (main loop)
+void z1_display_service(void);
+
+// Show pending changes now and wait for the transfer
+void z1_display_flush(void);
+
+// Get refresh statistics
+void z1_display_get_stats(z1_display_stats_t* stats);
+
 #endif // Z1_DISPLAY_H
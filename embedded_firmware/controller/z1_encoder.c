@@ -0,0 +1,273 @@
+/**
+ * Z1 Spike Encoders
+ *
+ * Runs in the controller main loop next to the gateway. Each nonzero
+ * tensor value is turned into an input entry when it arrives, so a step
+ * only walks the neurons that can spike, with one loop per mode.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_encoder.h"
+#include "z1_http_api.h"
+#include "z1_protocol_extended.h"
+#include "z1_udp_spikes.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+// A neuron the tensor drives (nonzero value)
+typedef struct {
+    uint16_t neuron;                // Global ID
+    uint16_t param;                 // POISSON/RATE: chance per step - 1, Q0.16; LATENCY: spike step
+    uint16_t acc;                   // RATE: accumulated chance, Q0.16
+} z1_encoder_input_t;
+
+typedef struct {
+    bool loading;                   // Between begin and start
+    bool active;
+    bool due_now;                   // First step of a presentation goes out at once
+    z1_encode_header_t header;
+    int16_t value;                  // Q8.8 per spike
+    uint32_t rng;
+    uint16_t received;              // Values loaded
+    uint16_t step;
+
+    uint16_t input_count;
+    z1_encoder_input_t inputs[Z1_ENCODER_MAX_INPUTS];
+
+    // Last step sent
+    uint32_t last_step;
+    uint32_t last_us;
+
+    uint32_t presentations;
+    uint32_t spikes;
+    uint32_t unmapped;
+} z1_encoder_state_t;
+
+static z1_encoder_state_t g_enc;
+
+// ============================================================================
+// Step Generation
+// ============================================================================
+
+static inline uint32_t encoder_random(void) {
+    uint32_t x = g_enc.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_enc.rng = x;
+    return x;
+}
+
+// Whether the next step is due (the barrier finished one, or a step length passed)
+static bool step_due(void) {
+    uint32_t now_us = time_us_32();
+    z1_snn_sync_stats_t sync;
+    z1_snn_sync_get_stats(&sync);
+
+    if (!g_enc.due_now) {
+        if (z1_snn_sync_active() ? sync.steps_done == g_enc.last_step :
+                                   now_us - g_enc.last_us < Z1_UDP_STEP_US) {
+            return false;
+        }
+    }
+    g_enc.due_now = false;
+    g_enc.last_step = sync.steps_done;
+    g_enc.last_us = now_us;
+    return true;
+}
+
+static inline void encoder_fire(uint16_t neuron) {
+    if (z1_snn_input_queue(neuron, g_enc.value)) {
+        g_enc.spikes++;
+    } else {
+        g_enc.unmapped++;
+    }
+}
+
+// Queue and send the spikes of the current step
+static void encode_step(void) {
+    z1_encoder_input_t* inputs = g_enc.inputs;
+    uint16_t count = g_enc.input_count;
+
+    switch (g_enc.header.mode) {
+        case Z1_ENCODE_POISSON:
+            for (uint16_t i = 0; i < count; i++) {
+                if ((encoder_random() >> 16) <= inputs[i].param) {
+                    encoder_fire(inputs[i].neuron);
+                }
+            }
+            break;
+
+        case Z1_ENCODE_RATE:
+            for (uint16_t i = 0; i < count; i++) {
+                uint32_t acc = (uint32_t)inputs[i].acc + inputs[i].param + 1;
+                inputs[i].acc = (uint16_t)acc;
+                if (acc > UINT16_MAX) {
+                    encoder_fire(inputs[i].neuron);
+                }
+            }
+            break;
+
+        case Z1_ENCODE_LATENCY:
+            for (uint16_t i = 0; i < count; i++) {
+                if (inputs[i].param == g_enc.step) {
+                    encoder_fire(inputs[i].neuron);
+                }
+            }
+            break;
+    }
+    z1_snn_input_flush();
+
+    if (++g_enc.step < g_enc.header.window_steps) {
+        return;
+    }
+    g_enc.presentations++;
+    g_enc.step = 0;
+    if (!(g_enc.header.flags & Z1_ENCODE_FLAG_LOOP)) {
+        g_enc.active = false;
+        printf("[Encoder] Presentation done: %lu spikes\n", (unsigned long)g_enc.spikes);
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        inputs[i].acc = 0;
+    }
+}
+
+// ============================================================================
+// Tensor Loading
+// ============================================================================
+
+/**
+ * Begin loading a tensor
+ */
+bool z1_encoder_begin(const z1_encode_header_t* header) {
+    g_enc.active = false;
+    g_enc.loading = false;
+
+    if (header->mode > Z1_ENCODE_LATENCY || header->count > Z1_ENCODER_MAX_INPUTS ||
+        header->window_steps == 0 || (uint32_t)header->first_neuron + header->count > 0x10000) {
+        printf("[Encoder] ERROR: Invalid header (mode %u, %u values, %u steps)\n",
+               header->mode, header->count, header->window_steps);
+        return false;
+    }
+
+    g_enc.header = *header;
+    g_enc.value = header->value ? header->value : Z1_INPUT_VALUE_ONE;
+    g_enc.rng = header->seed ? header->seed : (time_us_32() | 1);
+    g_enc.received = 0;
+    g_enc.input_count = 0;
+    g_enc.loading = true;
+    return true;
+}
+
+/**
+ * Add the next tensor values
+ */
+void z1_encoder_add(const uint8_t* values, uint16_t count) {
+    if (!g_enc.loading) {
+        return;
+    }
+
+    const z1_encode_header_t* header = &g_enc.header;
+    uint32_t rate = header->max_rate ? header->max_rate : 0x10000;
+
+    for (uint16_t i = 0; i < count && g_enc.received < header->count; i++) {
+        uint16_t index = g_enc.received++;
+        uint8_t v = values[i];
+        if (v == 0) {
+            continue;
+        }
+
+        uint32_t param;
+        if (header->mode == Z1_ENCODE_LATENCY) {
+            param = ((uint32_t)(255 - v) * (header->window_steps - 1) + 127) / 255;
+        } else {
+            // Values too faint for the rate never spike
+            uint32_t chance = (v * rate + 127) / 255;
+            if (chance == 0) {
+                continue;
+            }
+            param = chance - 1;
+        }
+
+        z1_encoder_input_t* in = &g_enc.inputs[g_enc.input_count++];
+        in->neuron = header->first_neuron + index;
+        in->param = (uint16_t)param;
+        in->acc = 0;
+    }
+}
+
+/**
+ * Start presenting the loaded tensor at the next step
+ */
+bool z1_encoder_start(void) {
+    if (!g_enc.loading || g_enc.received < g_enc.header.count) {
+        g_enc.loading = false;
+        return false;
+    }
+
+    g_enc.loading = false;
+    g_enc.step = 0;
+    g_enc.presentations = 0;
+    g_enc.spikes = 0;
+    g_enc.unmapped = 0;
+    g_enc.due_now = true;
+    g_enc.active = true;
+
+    printf("[Encoder] Presenting %u values (%u nonzero) from neuron %u, mode %u, %u steps%s\n",
+           g_enc.header.count, g_enc.input_count, g_enc.header.first_neuron, g_enc.header.mode,
+           g_enc.header.window_steps, (g_enc.header.flags & Z1_ENCODE_FLAG_LOOP) ? ", looped" : "");
+    return true;
+}
+
+/**
+ * End the current presentation
+ */
+void z1_encoder_stop(void) {
+    g_enc.active = false;
+    g_enc.loading = false;
+}
+
+// ============================================================================
+// Service
+// ============================================================================
+
+/**
+ * Queue and send the spikes of a step when one is due
+ */
+bool z1_encoder_service(void) {
+    if (!g_enc.active) {
+        return false;
+    }
+    if (!g_snn_running) {
+        g_enc.active = false;
+        return false;
+    }
+
+    if (step_due()) {
+        encode_step();
+    }
+    return g_enc.active;
+}
+
+/**
+ * Get encoder statistics
+ */
+void z1_encoder_get_stats(z1_encoder_stats_t* stats) {
+    stats->active = g_enc.active;
+    stats->mode = g_enc.header.mode;
+    stats->flags = g_enc.header.flags;
+    stats->count = g_enc.header.count;
+    stats->inputs = g_enc.input_count;
+    stats->window_steps = g_enc.header.window_steps;
+    stats->step = g_enc.step;
+    stats->presentations = g_enc.presentations;
+    stats->spikes = g_enc.spikes;
+    stats->unmapped = g_enc.unmapped;
+}
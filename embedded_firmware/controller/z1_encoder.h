@@ -0,0 +1,132 @@
+/**
+ * Z1 Spike Encoders
+ *
+ * Turns a raw input tensor into input spikes on the controller, so a host
+ * sends a sample once instead of every spike of every step of its window
+ * (POST /api/snn/encode). Value i of the tensor drives global neuron
+ * first_neuron + i; each step's spikes go out through the owner-routed
+ * per-node input batches of POST /api/snn/input.
+ *
+ * Modes, for a window of W steps and v = value / 255:
+ *
+ *   POISSON  every step a neuron spikes with probability v * max_rate
+ *            (xorshift32 draw per nonzero value)
+ *   RATE     the same mean rate, evenly spaced: a per-neuron accumulator
+ *            spikes each time it passes 1 (no draws, same train every run)
+ *   LATENCY  time-to-first-spike: one spike, at step (1 - v) * (W - 1), so
+ *            the brightest values fire first
+ *
+ * Zero values never spike and are not kept. Steps follow the barrier (one
+ * per step every node has finished) or, on free-running nodes,
+ * Z1_UDP_STEP_US of wall time, like the gateway flush; spikes are applied
+ * when they reach a node. One tensor is presented at a time: a new one
+ * replaces it, and stopping the SNN ends it.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_ENCODER_H
+#define Z1_ENCODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_ENCODER_MAX_INPUTS   4096    // Tensor values per presentation
+
+// ============================================================================
+// Body Format (little-endian)
+// ============================================================================
+
+// Modes
+#define Z1_ENCODE_POISSON       0
+#define Z1_ENCODE_RATE          1
+#define Z1_ENCODE_LATENCY       2
+
+// Flags
+#define Z1_ENCODE_FLAG_LOOP     0x01    // Present again after each window until replaced or stopped
+
+/**
+ * POST /api/snn/encode body header (16 bytes), followed by count uint8 values
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  mode;              // Z1_ENCODE_*
+    uint8_t  flags;             // Z1_ENCODE_FLAG_*
+    uint16_t count;             // Tensor values after the header
+    uint16_t first_neuron;      // Global ID driven by value 0
+    uint16_t window_steps;      // Steps each presentation lasts
+    uint16_t max_rate;          // POISSON/RATE: spike chance per step at value 255, Q0.16 (0 = every step)
+    int16_t  value;             // Input per spike, Q8.8 (0 = Z1_INPUT_VALUE_ONE)
+    uint32_t seed;              // POISSON: PRNG seed (0 = from the timer)
+} z1_encode_header_t;
+
+/**
+ * Encoder statistics
+ */
+typedef struct {
+    bool active;                // Tensor being presented
+    uint8_t mode;
+    uint8_t flags;
+    uint16_t count;             // Tensor values
+    uint16_t inputs;            // Nonzero values (the neurons that can spike)
+    uint16_t window_steps;
+    uint16_t step;              // Step of the current presentation
+    uint32_t presentations;     // Windows finished
+    uint32_t spikes;            // Spikes queued
+    uint32_t unmapped;          // Spikes for IDs no deployed table holds
+} z1_encoder_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Begin loading a tensor
+ *
+ * Ends the current presentation. The values follow with z1_encoder_add().
+ *
+ * @param header Body header
+ * @return false if the mode is unknown, count exceeds Z1_ENCODER_MAX_INPUTS,
+ *         the window is empty or the neuron IDs run past 65535
+ */
+bool z1_encoder_begin(const z1_encode_header_t* header);
+
+/**
+ * Add the next tensor values
+ *
+ * @param values Values, in neuron order after the previous ones
+ * @param count Number of values (beyond the header count are ignored)
+ */
+void z1_encoder_add(const uint8_t* values, uint16_t count);
+
+/**
+ * Start presenting the loaded tensor at the next step
+ *
+ * @return false if fewer values arrived than the header announced
+ */
+bool z1_encoder_start(void);
+
+/**
+ * End the current presentation
+ */
+void z1_encoder_stop(void);
+
+/**
+ * Queue and send the spikes of a step when one is due (controller main loop)
+ *
+ * @return true while a tensor is being presented, so the loop polls
+ *         instead of sleeping until the next W5500 event
+ */
+bool z1_encoder_service(void);
+
+/**
+ * Get encoder statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_encoder_get_stats(z1_encoder_stats_t* stats);
+
+#endif // Z1_ENCODER_H
@@ -0,0 +1,337 @@
+/**
+ * Z1 Firmware Distribution
+ *
+ * Runs in the foreground of the request that carries the image: chunks go
+ * out as the body arrives, repair and verification block until done.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_firmware_dist.h"
+#include "z1_matrix_bus.h"
+#include "z1_multiframe.h"
+#include "z1_protocol_extended.h"
+#include "../common/z1_crc32.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    bool active;
+    uint32_t started_ms;
+
+    uint16_t targets;
+    uint32_t session;
+    uint32_t image_size;
+    uint32_t image_offset;          // Image bytes received so far
+    uint32_t image_crc32;           // Running, over the bytes received
+    uint16_t chunk_count;
+    uint16_t chunk_index;           // Chunk being filled
+    uint16_t chunk_length;
+    bool staging_failed;
+
+    z1_fw_dist_result_t result;
+} z1_fw_dist_t;
+
+static z1_fw_dist_t g_dist;
+
+// Z1_CMD_FIRMWARE_UPLOAD packet: header and the chunk data
+static uint8_t g_dist_packet[sizeof(z1_fw_chunk_t) + Z1_FW_CHUNK_SIZE] __attribute__((aligned(4)));
+
+// Chunk -> targets still missing it, built each repair round
+static uint16_t g_dist_missing[Z1_FW_MAX_CHUNKS];
+
+static inline uint32_t dist_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static uint16_t dist_chunk_length(uint16_t index) {
+    uint32_t left = g_dist.image_size - (uint32_t)index * Z1_FW_CHUNK_SIZE;
+    return (left > Z1_FW_CHUNK_SIZE) ? Z1_FW_CHUNK_SIZE : (uint16_t)left;
+}
+
+// One multicast when several nodes take the payload, unicast otherwise
+static void dist_send(uint16_t dest, uint8_t command, const uint8_t* data, uint16_t length) {
+    if (__builtin_popcount(dest) > 1 && z1_send_multicast(dest, command, data, length)) {
+        return;
+    }
+
+    // Failures show up as gaps in the node's next status
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (dest & (1u << node)) {
+            z1_bus_send_command(node, command, data, length);
+        }
+    }
+}
+
+static void dist_send_begin(uint16_t dest) {
+    z1_fw_begin_t begin = {
+        .session = g_dist.session,
+        .image_size = g_dist.image_size,
+        .chunk_count = g_dist.chunk_count,
+        .chunk_size = Z1_FW_CHUNK_SIZE,
+    };
+    dist_send(dest, Z1_CMD_FIRMWARE_BEGIN, (const uint8_t*)&begin, sizeof(begin));
+}
+
+// Send the chunk whose data is in g_dist_packet
+static void dist_send_chunk(uint16_t dest, uint16_t index) {
+    z1_fw_chunk_t header = {
+        .session = g_dist.session,
+        .index = index,
+        .length = dist_chunk_length(index),
+    };
+    header.crc32 = z1_crc32(g_dist_packet + sizeof(header), header.length);
+    memcpy(g_dist_packet, &header, sizeof(header));
+
+    dist_send(dest, Z1_CMD_FIRMWARE_UPLOAD, g_dist_packet, sizeof(header) + header.length);
+}
+
+// ============================================================================
+// First Pass
+// ============================================================================
+
+/**
+ * Start a distribution
+ */
+bool z1_fw_dist_begin(uint16_t node_mask, uint32_t image_size) {
+    if (g_dist.active) {
+        return false;
+    }
+    if (node_mask == 0 || image_size == 0 || image_size > Z1_FW_DIST_MAX_IMAGE) {
+        printf("[Firmware] ❌ Image of %lu bytes refused (max %u)\n",
+               (unsigned long)image_size, Z1_FW_DIST_MAX_IMAGE);
+        return false;
+    }
+
+    memset(&g_dist, 0, sizeof(g_dist));
+    g_dist.active = true;
+    g_dist.started_ms = dist_now_ms();
+    g_dist.targets = node_mask;
+    g_dist.session = time_us_32() | 1;  // Never 0, the node's "no session"
+    g_dist.image_size = image_size;
+    g_dist.chunk_count = (image_size + Z1_FW_CHUNK_SIZE - 1) / Z1_FW_CHUNK_SIZE;
+
+    printf("[Firmware] Distributing %lu bytes (%u chunks) to nodes 0x%04X\n",
+           (unsigned long)image_size, g_dist.chunk_count, node_mask);
+    dist_send_begin(node_mask);
+    return true;
+}
+
+/**
+ * Feed the next image bytes
+ */
+bool z1_fw_dist_write(const uint8_t* data, uint32_t length) {
+    if (!g_dist.active || length > g_dist.image_size - g_dist.image_offset) {
+        return false;
+    }
+
+    while (length > 0) {
+        uint16_t chunk_size = dist_chunk_length(g_dist.chunk_index);
+        uint16_t n = chunk_size - g_dist.chunk_length;
+        if (n > length) n = length;
+
+        memcpy(g_dist_packet + sizeof(z1_fw_chunk_t) + g_dist.chunk_length, data, n);
+        g_dist.chunk_length += n;
+        g_dist.image_offset += n;
+        data += n;
+        length -= n;
+
+        if (g_dist.chunk_length < chunk_size) {
+            break;
+        }
+
+        // Complete chunk: keep a copy for resends, then one pass to every target
+        const uint8_t* chunk = g_dist_packet + sizeof(z1_fw_chunk_t);
+        if (!psram_write(Z1_FW_DIST_STAGING_ADDR + (uint32_t)g_dist.chunk_index * Z1_FW_CHUNK_SIZE,
+                         chunk, chunk_size)) {
+            g_dist.staging_failed = true;
+            return false;
+        }
+        g_dist.image_crc32 = z1_crc32_update(g_dist.image_crc32, chunk, chunk_size);
+        dist_send_chunk(g_dist.targets, g_dist.chunk_index);
+
+        g_dist.chunk_index++;
+        g_dist.chunk_length = 0;
+    }
+    return true;
+}
+
+// ============================================================================
+// Repair and Verification
+// ============================================================================
+
+// Ask every target for its chunk bitmap and record what it misses;
+// returns the targets that still miss chunks or did not answer
+static uint16_t dist_collect_gaps(uint16_t nodes) {
+    z1_fw_dist_result_t* result = &g_dist.result;
+    uint16_t incomplete = 0;
+    memset(g_dist_missing, 0, sizeof(g_dist_missing));
+
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        uint16_t bit = 1u << node;
+        if (!(nodes & bit)) {
+            continue;
+        }
+
+        z1_fw_dist_node_t* n = &result->nodes[node];
+        z1_fw_status_t status;
+        int length = z1_bus_request(node, Z1_CMD_FIRMWARE_STATUS, NULL, 0, (uint8_t*)&status,
+                                    sizeof(status), Z1_FW_DIST_STATUS_TIMEOUT_MS);
+        n->answered = (length == sizeof(status));
+        if (!n->answered) {
+            incomplete |= bit;
+            continue;
+        }
+        n->flags = status.flags;
+        n->crc_errors = status.crc_errors;
+
+        bool same_session = (status.session == g_dist.session &&
+                             status.chunk_count == g_dist.chunk_count);
+        if (!same_session) {
+            // Rebooted or missed the BEGIN: restart it, every chunk is a gap
+            dist_send_begin(bit);
+        }
+
+        n->missing = 0;
+        for (uint16_t c = 0; c < g_dist.chunk_count; c++) {
+            if (!same_session || !(status.bitmap[c >> 3] & (1u << (c & 7)))) {
+                g_dist_missing[c] |= bit;
+                n->missing++;
+            }
+        }
+        if (n->missing > 0) {
+            incomplete |= bit;
+        }
+    }
+    return incomplete;
+}
+
+// Resend every chunk in g_dist_missing to the nodes missing it
+static bool dist_resend_gaps(void) {
+    z1_fw_dist_result_t* result = &g_dist.result;
+
+    for (uint16_t c = 0; c < g_dist.chunk_count; c++) {
+        uint16_t dest = g_dist_missing[c];
+        if (dest == 0) {
+            continue;
+        }
+        if (!psram_read(Z1_FW_DIST_STAGING_ADDR + (uint32_t)c * Z1_FW_CHUNK_SIZE,
+                        g_dist_packet + sizeof(z1_fw_chunk_t), dist_chunk_length(c))) {
+            return false;
+        }
+        dist_send_chunk(dest, c);
+
+        result->chunks_resent++;
+        for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+            if (dest & (1u << node)) {
+                result->nodes[node].resent++;
+            }
+        }
+    }
+    return true;
+}
+
+// Have the complete nodes check the image; returns the nodes that verified
+static uint16_t dist_verify(uint16_t nodes) {
+    z1_fw_dist_result_t* result = &g_dist.result;
+    z1_fw_verify_t verify = {
+        .session = g_dist.session,
+        .image_crc32 = g_dist.image_crc32,
+    };
+    dist_send(nodes, Z1_CMD_FIRMWARE_VERIFY, (const uint8_t*)&verify, sizeof(verify));
+
+    uint16_t verified = 0;
+    uint16_t pending = nodes;
+    uint32_t start_ms = dist_now_ms();
+    while (pending && dist_now_ms() - start_ms < Z1_FW_DIST_VERIFY_TIMEOUT_MS) {
+        for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+            uint16_t bit = 1u << node;
+            if (!(pending & bit)) {
+                continue;
+            }
+
+            z1_fw_status_t status;
+            int length = z1_bus_request(node, Z1_CMD_FIRMWARE_STATUS, NULL, 0, (uint8_t*)&status,
+                                        sizeof(status), Z1_FW_DIST_STATUS_TIMEOUT_MS);
+            if (length != sizeof(status) || status.session != g_dist.session) {
+                continue;
+            }
+            result->nodes[node].flags = status.flags;
+            if (status.flags & Z1_FW_STATUS_VERIFIED) {
+                result->nodes[node].verified = true;
+                verified |= bit;
+                pending &= ~bit;
+            } else if (status.flags & Z1_FW_STATUS_BAD_IMAGE) {
+                printf("[Firmware] ❌ Node %u: image CRC32 mismatch\n", node);
+                pending &= ~bit;
+            }
+        }
+        if (pending) {
+            sleep_ms(10);
+        }
+    }
+    return verified;
+}
+
+/**
+ * Repair gaps, verify and end the distribution
+ */
+bool z1_fw_dist_finish(z1_fw_dist_result_t* result) {
+    z1_fw_dist_result_t* r = &g_dist.result;
+    r->targets = g_dist.targets;
+    r->session = g_dist.session;
+    r->image_size = g_dist.image_size;
+    r->image_crc32 = g_dist.image_crc32;
+    r->chunk_count = g_dist.chunk_count;
+
+    bool ok = g_dist.active && !g_dist.staging_failed && g_dist.image_offset == g_dist.image_size;
+    if (ok) {
+        uint16_t incomplete = dist_collect_gaps(g_dist.targets);
+        while (incomplete && r->rounds < Z1_FW_DIST_REPAIR_ROUNDS) {
+            r->rounds++;
+            printf("[Firmware] Repair round %u: nodes 0x%04X incomplete\n", r->rounds, incomplete);
+            if (!dist_resend_gaps()) {
+                break;
+            }
+            incomplete = dist_collect_gaps(incomplete);
+        }
+
+        uint16_t complete = g_dist.targets & ~incomplete;
+        r->verified_mask = complete ? dist_verify(complete) : 0;
+        ok = (r->verified_mask == g_dist.targets);
+    }
+
+    r->elapsed_ms = dist_now_ms() - g_dist.started_ms;
+    printf("[Firmware] %u/%u nodes verified, %u chunks resent, %lu ms\n",
+           __builtin_popcount(r->verified_mask), __builtin_popcount(r->targets),
+           r->chunks_resent, (unsigned long)r->elapsed_ms);
+
+    if (result) {
+        memcpy(result, r, sizeof(*result));
+    }
+    g_dist.active = false;
+    return ok;
+}
+
+/**
+ * End a distribution without repairing or verifying
+ */
+void z1_fw_dist_abort(void) {
+    if (g_dist.active) {
+        printf("[Firmware] Distribution aborted after %lu of %lu bytes\n",
+               (unsigned long)g_dist.image_offset, (unsigned long)g_dist.image_size);
+    }
+    g_dist.active = false;
+}
+
+/**
+ * Check whether a distribution is running
+ */
+bool z1_fw_dist_active(void) {
+    return g_dist.active;
+}
@@ -0,0 +1,113 @@
+/**
+ * Z1 Firmware Distribution
+ *
+ * Sends one firmware image to any set of nodes for the cost of about one
+ * transfer (see "Firmware Distribution" in z1_protocol.h):
+ *
+ *   1. the image is streamed in Z1_FW_CHUNK_SIZE chunks, each with its
+ *      CRC32, as one multicast per chunk to every target node; a copy is
+ *      kept in controller PSRAM
+ *   2. every target reports the bitmap of chunks it stored, and only the
+ *      missing chunks are resent - as one multicast to all nodes missing
+ *      the same chunk - for up to Z1_FW_DIST_REPAIR_ROUNDS rounds
+ *   3. complete nodes check the whole-image CRC32 and report the result
+ *
+ * A node that rebooted or missed the start of the transfer is sent the
+ * BEGIN again during repair and gets the whole image in the gaps.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_FIRMWARE_DIST_H
+#define Z1_FIRMWARE_DIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "z1_protocol.h"
+#include "psram_rp2350.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_FW_DIST_STAGING_ADDR         PSRAM_BASE_ADDRESS  // Image copy for resends
+#define Z1_FW_DIST_MAX_IMAGE            (Z1_FW_MAX_CHUNKS * Z1_FW_CHUNK_SIZE)
+#define Z1_FW_DIST_REPAIR_ROUNDS        4       // Status/resend rounds after the first pass
+#define Z1_FW_DIST_STATUS_TIMEOUT_MS    100     // Z1_CMD_FIRMWARE_STATUS answer timeout
+#define Z1_FW_DIST_VERIFY_TIMEOUT_MS    2000    // Whole-image check on every node
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Outcome for one target node
+ */
+typedef struct {
+    bool answered;              // Reported its status in the last round
+    bool verified;              // Image stored and its CRC32 matched
+    uint8_t flags;              // Last Z1_FW_STATUS_* reported
+    uint16_t missing;           // Chunks missing at the last status
+    uint16_t resent;            // Chunks resent to this node
+    uint32_t crc_errors;        // Chunks the node dropped for a bad CRC32
+} z1_fw_dist_node_t;
+
+/**
+ * Outcome of a distribution
+ */
+typedef struct {
+    uint16_t targets;           // Nodes the image was sent to
+    uint16_t verified_mask;     // Targets holding a verified image
+    uint32_t session;
+    uint32_t image_size;
+    uint32_t image_crc32;
+    uint16_t chunk_count;
+    uint16_t chunks_resent;     // Chunk transfers after the first pass
+    uint8_t rounds;             // Repair rounds that resent chunks
+    uint32_t elapsed_ms;
+    z1_fw_dist_node_t nodes[Z1_MAX_NODES];
+} z1_fw_dist_result_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Start a distribution: announce the image to every target
+ *
+ * @param node_mask Target nodes
+ * @param image_size Image size in bytes (1 to Z1_FW_DIST_MAX_IMAGE)
+ * @return false if a distribution is running or the image does not fit
+ */
+bool z1_fw_dist_begin(uint16_t node_mask, uint32_t image_size);
+
+/**
+ * Feed the next image bytes; every completed chunk goes out immediately
+ *
+ * @param data Image data
+ * @param length Bytes in data
+ * @return false if more bytes were given than announced or staging failed
+ */
+bool z1_fw_dist_write(const uint8_t* data, uint32_t length);
+
+/**
+ * Repair gaps, verify and end the distribution
+ *
+ * @param result Filled with the per-node outcome
+ * @return true if every target holds a verified image
+ */
+bool z1_fw_dist_finish(z1_fw_dist_result_t* result);
+
+/**
+ * End a distribution without repairing or verifying
+ */
+void z1_fw_dist_abort(void);
+
+/**
+ * Check whether a distribution is running
+ *
+ * @return true between z1_fw_dist_begin() and finish/abort
+ */
+bool z1_fw_dist_active(void);
+
+#endif // Z1_FIRMWARE_DIST_H
@@ -0,0 +1,507 @@
+/**
+ * Z1 Backplane Gateway
+ *
+ * Node batches are queued by the bus receive path and relayed from the
+ * main loop, next to the UDP spike channel whose socket the datagrams
+ * share. Routes are kept sorted by source and looked up by bisection.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_gateway.h"
+#include "z1_protocol_extended.h"
+#include "z1_multiframe.h"
+#include "z1_http_api.h"
+#include "w5500_http_server.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// First block byte of a datagram
+#define GATEWAY_BLOCKS_OFFSET   (sizeof(z1_udp_header_t) + sizeof(z1_udp_gateway_t))
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    bool active;                    // Configured
+    uint8_t ip[4];
+    uint16_t port;
+    uint16_t seq;
+    uint16_t blocks;                // Batches in the datagram
+    uint16_t length;                // Datagram bytes so far
+    uint16_t block_offset;          // Batch being filled, 0 = start a new one
+    uint8_t datagram[Z1_UDP_MAX_DATAGRAM];
+} z1_gateway_peer_t;
+
+typedef struct {
+    z1_spike_batch_header_t header;
+    z1_spike_batch_entry_t entries[Z1_GATEWAY_BATCH_ENTRIES];
+} __attribute__((packed)) z1_gateway_batch_t;
+
+typedef struct {
+    uint8_t backplane;
+    uint16_t route_count;
+    z1_gateway_peer_t peers[Z1_MAX_BACKPLANES];
+
+    // Node batches: written by the bus receive path, taken by the main loop
+    volatile uint8_t rx_head;
+    volatile uint8_t rx_tail;
+    uint16_t rx_length[Z1_GATEWAY_RX_SLOTS];
+    uint8_t rx_data[Z1_GATEWAY_RX_SLOTS][Z1_GATEWAY_BATCH_MAX];
+
+    // Ingress batches per destination mask
+    uint16_t out_masks[Z1_GATEWAY_OUT_GROUPS];
+    z1_gateway_batch_t out[Z1_GATEWAY_OUT_GROUPS];
+
+    // Last datagram flush
+    uint32_t flush_step;
+    uint32_t flush_us;
+
+    z1_gateway_stats_t stats;
+} z1_gateway_state_t;
+
+static z1_gateway_state_t g_gw;
+static z1_gateway_route_t g_routes[Z1_GATEWAY_MAX_ROUTES];
+
+// ============================================================================
+// Routes
+// ============================================================================
+
+static inline uint32_t route_key(uint8_t backplane, uint8_t node, uint16_t local_id) {
+    return ((uint32_t)backplane << 24) | ((uint32_t)node << 16) | local_id;
+}
+
+static int route_compare(const void* a, const void* b) {
+    const z1_gateway_route_t* ra = a;
+    const z1_gateway_route_t* rb = b;
+    uint32_t ka = route_key(ra->backplane, ra->node, ra->local_id);
+    uint32_t kb = route_key(rb->backplane, rb->node, rb->local_id);
+    return (ka > kb) - (ka < kb);
+}
+
+// Mask of the route for a source, 0 without one
+static uint16_t route_find(uint8_t backplane, uint8_t node, uint16_t local_id) {
+    uint32_t key = route_key(backplane, node, local_id);
+    int lo = 0;
+    int hi = (int)g_gw.route_count - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const z1_gateway_route_t* r = &g_routes[mid];
+        uint32_t k = route_key(r->backplane, r->node, r->local_id);
+        if (k == key) {
+            return r->mask;
+        }
+        if (k < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// Egress (local nodes -> peers)
+// ============================================================================
+
+static void peer_reset(z1_gateway_peer_t* peer) {
+    peer->blocks = 0;
+    peer->length = GATEWAY_BLOCKS_OFFSET;
+    peer->block_offset = 0;
+}
+
+// Send a peer's datagram; UDP does not retry, so it is dropped either way
+static void peer_send(uint8_t backplane) {
+    z1_gateway_peer_t* peer = &g_gw.peers[backplane];
+    if (peer->blocks == 0) {
+        return;
+    }
+
+    z1_snn_sync_stats_t sync;
+    z1_snn_sync_get_stats(&sync);
+
+    z1_udp_header_t header = {
+        .magic = Z1_UDP_MAGIC,
+        .type = Z1_UDP_GATEWAY,
+        .seq = peer->seq++,
+        .count = peer->blocks,
+        .step = sync.steps_done,
+    };
+    z1_udp_gateway_t prefix = { .backplane = g_gw.backplane };
+    memcpy(peer->datagram, &header, sizeof(header));
+    memcpy(peer->datagram + sizeof(header), &prefix, sizeof(prefix));
+
+    if (w5500_udp_send(Z1_UDP_SOCKET, peer->ip, peer->port, peer->datagram, peer->length)) {
+        g_gw.stats.datagrams_out++;
+    } else {
+        g_gw.stats.send_errors++;
+    }
+    peer_reset(peer);
+}
+
+// Add one entry of a node batch to a peer's datagram
+static void peer_append(uint8_t backplane, const z1_spike_batch_header_t* source,
+                        const z1_spike_batch_entry_t* entry) {
+    z1_gateway_peer_t* peer = &g_gw.peers[backplane];
+    z1_spike_batch_header_t block;
+
+    // A new block needs room for its header too
+    uint16_t needed = sizeof(*entry) + (peer->block_offset ? 0 : sizeof(block));
+    if (peer->length + needed > Z1_UDP_MAX_DATAGRAM) {
+        peer_send(backplane);
+    }
+
+    if (peer->block_offset == 0) {
+        block = *source;
+        block.count = 0;
+        peer->block_offset = peer->length;
+        peer->length += sizeof(block);
+        peer->blocks++;
+    } else {
+        memcpy(&block, peer->datagram + peer->block_offset, sizeof(block));
+    }
+
+    memcpy(peer->datagram + peer->length, entry, sizeof(*entry));
+    peer->length += sizeof(*entry);
+    block.count++;
+    memcpy(peer->datagram + peer->block_offset, &block, sizeof(block));
+    g_gw.stats.spikes_out++;
+}
+
+// Split a node batch over the datagrams of its entries' peer backplanes
+static void gateway_relay(const uint8_t* data, uint16_t length) {
+    z1_spike_batch_header_t header;
+    if (length < sizeof(header)) {
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (length < sizeof(header) + header.count * sizeof(z1_spike_batch_entry_t)) {
+        return;
+    }
+
+    const uint8_t* p = data + sizeof(header);
+    for (uint16_t i = 0; i < header.count; i++, p += sizeof(z1_spike_batch_entry_t)) {
+        z1_spike_batch_entry_t entry;
+        memcpy(&entry, p, sizeof(entry));
+
+        uint16_t peers = route_find(g_gw.backplane, header.source_node, entry.local_id);
+        peers &= ~(1u << g_gw.backplane);
+        if (peers == 0) {
+            g_gw.stats.unrouted++;
+            continue;
+        }
+
+        for (uint8_t bp = 0; bp < Z1_MAX_BACKPLANES; bp++) {
+            if ((peers & (1u << bp)) && g_gw.peers[bp].active) {
+                peer_append(bp, &header, &entry);
+            }
+        }
+    }
+
+    // Entries of the next node batch start new blocks
+    for (uint8_t bp = 0; bp < Z1_MAX_BACKPLANES; bp++) {
+        g_gw.peers[bp].block_offset = 0;
+    }
+}
+
+// True once per barrier step, or every Z1_GATEWAY_FLUSH_US when free-running
+static bool flush_due(void) {
+    if (z1_snn_sync_active()) {
+        z1_snn_sync_stats_t sync;
+        z1_snn_sync_get_stats(&sync);
+        if (sync.steps_done == g_gw.flush_step) {
+            return false;
+        }
+        g_gw.flush_step = sync.steps_done;
+        return true;
+    }
+
+    uint32_t now_us = time_us_32();
+    if (g_snn_running && now_us - g_gw.flush_us < Z1_GATEWAY_FLUSH_US) {
+        return false;
+    }
+    g_gw.flush_us = now_us;
+    return true;
+}
+
+// ============================================================================
+// Ingress (peers -> local nodes)
+// ============================================================================
+
+// Send one destination mask's batch to its nodes
+static void out_send(uint8_t group) {
+    z1_gateway_batch_t* batch = &g_gw.out[group];
+    uint16_t mask = g_gw.out_masks[group];
+    uint16_t length = sizeof(batch->header) + batch->header.count * sizeof(z1_spike_batch_entry_t);
+
+    g_gw.out_masks[group] = 0;
+    g_gw.stats.spikes_in += batch->header.count;
+
+    // Several destinations: one bus claim for all of them
+    if ((mask & (mask - 1)) != 0 &&
+        z1_send_multicast(mask, Z1_CMD_SNN_SPIKE_BATCH, (const uint8_t*)batch, length)) {
+        return;
+    }
+
+    for (uint8_t node = 0; mask; node++, mask >>= 1) {
+        if ((mask & 1) &&
+            !z1_send_multiframe(node, Z1_CMD_SNN_SPIKE_BATCH, (const uint8_t*)batch, length)) {
+            g_gw.stats.bus_errors++;
+        }
+    }
+}
+
+// Batch for a destination mask, claimed with the block's header if new
+static z1_gateway_batch_t* out_group(uint16_t mask, const z1_spike_batch_header_t* block) {
+    uint8_t free_group = Z1_GATEWAY_OUT_GROUPS;
+
+    for (uint8_t g = 0; g < Z1_GATEWAY_OUT_GROUPS; g++) {
+        if (g_gw.out_masks[g] == mask) {
+            return &g_gw.out[g];
+        }
+        if (g_gw.out_masks[g] == 0 && free_group == Z1_GATEWAY_OUT_GROUPS) {
+            free_group = g;
+        }
+    }
+
+    // All in use: make room with the first one
+    if (free_group == Z1_GATEWAY_OUT_GROUPS) {
+        out_send(0);
+        free_group = 0;
+    }
+
+    g_gw.out_masks[free_group] = mask;
+    g_gw.out[free_group].header = *block;
+    g_gw.out[free_group].header.count = 0;
+    return &g_gw.out[free_group];
+}
+
+// Pass one relayed block on to the nodes its sources' import routes name
+static void deliver_block(uint8_t source_backplane, const z1_spike_batch_header_t* block,
+                          const uint8_t* entries) {
+    uint8_t field = source_backplane ^ g_gw.backplane;
+
+    for (uint16_t i = 0; i < block->count; i++) {
+        z1_spike_batch_entry_t entry;
+        memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+
+        uint16_t mask = route_find(source_backplane, block->source_node, entry.local_id) &
+                        g_snn_node_mask;
+        if (mask == 0) {
+            g_gw.stats.unrouted++;
+            continue;
+        }
+
+        // The source is addressed as the nodes' synapses name it
+        entry.local_id = (uint16_t)z1_global_id(field, 0, entry.local_id);
+
+        z1_gateway_batch_t* batch = out_group(mask, block);
+        batch->entries[batch->header.count++] = entry;
+        if (batch->header.count >= Z1_GATEWAY_BATCH_ENTRIES) {
+            out_send((uint8_t)(batch - g_gw.out));
+        }
+    }
+
+    // Batches share the block's timestamp base, so they go out with it
+    for (uint8_t g = 0; g < Z1_GATEWAY_OUT_GROUPS; g++) {
+        if (g_gw.out_masks[g] != 0) {
+            out_send(g);
+        }
+    }
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+/**
+ * Set this controller's backplane number and drop the routes
+ */
+bool z1_gateway_set_backplane(uint8_t backplane) {
+    if (backplane >= Z1_MAX_BACKPLANES) {
+        return false;
+    }
+
+    g_gw.backplane = backplane;
+    g_gw.peers[backplane].active = false;
+    z1_gateway_routes_clear();
+    printf("[Gateway] Backplane %u\n", backplane);
+    return true;
+}
+
+/**
+ * Get this controller's backplane number
+ */
+uint8_t z1_gateway_get_backplane(void) {
+    return g_gw.backplane;
+}
+
+/**
+ * Set the controller of a peer backplane
+ */
+bool z1_gateway_set_peer(uint8_t backplane, const uint8_t ip[4], uint16_t port) {
+    if (backplane >= Z1_MAX_BACKPLANES || backplane == g_gw.backplane) {
+        return false;
+    }
+
+    z1_gateway_peer_t* peer = &g_gw.peers[backplane];
+    peer_reset(peer);
+    peer->active = (ip != NULL);
+    if (ip) {
+        memcpy(peer->ip, ip, 4);
+        peer->port = port ? port : Z1_UDP_PORT;
+        printf("[Gateway] Peer backplane %u at %d.%d.%d.%d:%u\n",
+               backplane, ip[0], ip[1], ip[2], ip[3], peer->port);
+    }
+    return true;
+}
+
+/**
+ * Get the configured peers
+ */
+uint8_t z1_gateway_get_peers(uint8_t ips[][4], uint16_t* ports) {
+    uint8_t mask = 0;
+
+    for (uint8_t bp = 0; bp < Z1_MAX_BACKPLANES; bp++) {
+        const z1_gateway_peer_t* peer = &g_gw.peers[bp];
+        if (!peer->active) {
+            continue;
+        }
+        mask |= (uint8_t)(1u << bp);
+        if (ips) memcpy(ips[bp], peer->ip, 4);
+        if (ports) ports[bp] = peer->port;
+    }
+
+    return mask;
+}
+
+/**
+ * Drop all routes
+ */
+void z1_gateway_routes_clear(void) {
+    g_gw.route_count = 0;
+}
+
+/**
+ * Add a route
+ */
+bool z1_gateway_route_add(const z1_gateway_route_t* route) {
+    if (g_gw.route_count >= Z1_GATEWAY_MAX_ROUTES) {
+        return false;
+    }
+    g_routes[g_gw.route_count++] = *route;
+    return true;
+}
+
+/**
+ * Sort the added routes for lookup
+ */
+uint16_t z1_gateway_routes_commit(void) {
+    qsort(g_routes, g_gw.route_count, sizeof(g_routes[0]), route_compare);
+    printf("[Gateway] %u routes\n", g_gw.route_count);
+    return g_gw.route_count;
+}
+
+// ============================================================================
+// Service
+// ============================================================================
+
+/**
+ * Check whether a node batch would be taken
+ */
+bool z1_gateway_bus_room(uint16_t length) {
+    uint8_t next = (g_gw.rx_tail + 1) % Z1_GATEWAY_RX_SLOTS;
+    if (length > Z1_GATEWAY_BATCH_MAX || next == g_gw.rx_head) {
+        g_gw.stats.batches_refused++;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Queue a node's spike batch
+ */
+bool z1_gateway_bus_batch(const uint8_t* data, uint16_t length) {
+    if (!z1_gateway_bus_room(length)) {
+        return false;
+    }
+
+    uint8_t tail = g_gw.rx_tail;
+    memcpy(g_gw.rx_data[tail], data, length);
+    g_gw.rx_length[tail] = length;
+    __atomic_store_n(&g_gw.rx_tail, (uint8_t)((tail + 1) % Z1_GATEWAY_RX_SLOTS), __ATOMIC_RELEASE);
+    g_gw.stats.batches_in++;
+    return true;
+}
+
+/**
+ * Deliver a peer's Z1_UDP_GATEWAY datagram to the local nodes
+ */
+void z1_gateway_receive(const z1_udp_header_t* header, const uint8_t* payload, uint16_t length) {
+    z1_udp_gateway_t prefix;
+    if (length < sizeof(prefix)) {
+        return;
+    }
+    memcpy(&prefix, payload, sizeof(prefix));
+    if (prefix.backplane >= Z1_MAX_BACKPLANES || prefix.backplane == g_gw.backplane ||
+        !g_snn_running) {
+        return;
+    }
+    g_gw.stats.datagrams_in++;
+
+    const uint8_t* p = payload + sizeof(prefix);
+    uint16_t left = length - sizeof(prefix);
+    for (uint16_t b = 0; b < header->count; b++) {
+        z1_spike_batch_header_t block;
+        if (left < sizeof(block)) {
+            break;
+        }
+        memcpy(&block, p, sizeof(block));
+
+        uint32_t size = sizeof(block) + (uint32_t)block.count * sizeof(z1_spike_batch_entry_t);
+        if (size > left) {
+            printf("[Gateway] Truncated datagram from backplane %u\n", prefix.backplane);
+            break;
+        }
+        deliver_block(prefix.backplane, &block, p + sizeof(block));
+        p += size;
+        left -= size;
+    }
+}
+
+/**
+ * Relay queued node batches and send datagrams when due
+ */
+bool z1_gateway_service(void) {
+    uint8_t head = g_gw.rx_head;
+    while (head != __atomic_load_n(&g_gw.rx_tail, __ATOMIC_ACQUIRE)) {
+        gateway_relay(g_gw.rx_data[head], g_gw.rx_length[head]);
+        head = (head + 1) % Z1_GATEWAY_RX_SLOTS;
+        __atomic_store_n(&g_gw.rx_head, head, __ATOMIC_RELEASE);
+    }
+
+    bool pending = false;
+    for (uint8_t bp = 0; bp < Z1_MAX_BACKPLANES; bp++) {
+        pending |= (g_gw.peers[bp].blocks != 0);
+    }
+    if (!pending || !flush_due()) {
+        return pending;
+    }
+
+    for (uint8_t bp = 0; bp < Z1_MAX_BACKPLANES; bp++) {
+        peer_send(bp);
+    }
+    return false;
+}
+
+/**
+ * Get gateway statistics
+ */
+void z1_gateway_get_stats(z1_gateway_stats_t* stats, uint16_t* routes) {
+    if (stats) *stats = g_gw.stats;
+    if (routes) *routes = g_gw.route_count;
+}
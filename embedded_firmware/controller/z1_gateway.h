@@ -0,0 +1,177 @@
+/**
+ * Z1 Backplane Gateway
+ *
+ * Relays spikes between backplanes (see Global Neuron Addressing in
+ * z1_protocol.h). Each controller is the gateway of its own bus:
+ *
+ *   egress   nodes send the spikes of Z1_NEURON_FLAG_GATEWAY neurons to the
+ *            controller as Z1_CMD_SNN_SPIKE_BATCH; each entry is added to
+ *            the datagram of every peer backplane its export route names,
+ *            and the datagrams go out once per step (barrier runs) or
+ *            every Z1_GATEWAY_FLUSH_US (free-running), or when full
+ *   ingress  a peer's Z1_UDP_GATEWAY datagram arrives on the UDP spike
+ *            socket; each entry gets the backplane field of the source and
+ *            goes to the nodes its import route names, as spike batches
+ *
+ * Routes come from the compiler: entries whose backplane is this one are
+ * exports (mask = peer backplanes), all others imports (mask = local
+ * nodes). Spikes without a route are dropped. The backplanes' barriers are
+ * independent, so a relayed spike is applied when it arrives, a step or
+ * more after it fired.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_GATEWAY_H
+#define Z1_GATEWAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "z1_protocol.h"
+#include "z1_udp_spikes.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_GATEWAY_MAX_ROUTES       4096    // Export and import routes
+#define Z1_GATEWAY_RX_SLOTS         8       // Node batches queued by the bus receive path
+#define Z1_GATEWAY_FLUSH_US         Z1_UDP_STEP_US  // Free-running datagram interval
+
+#define Z1_GATEWAY_BATCH_ENTRIES    128     // Entries per batch (Z1_SPIKE_BATCH_MAX_ENTRIES on the nodes)
+#define Z1_GATEWAY_OUT_GROUPS       8       // Destination masks batched at once on ingress
+
+// Largest node batch the gateway takes
+#define Z1_GATEWAY_BATCH_MAX        (sizeof(z1_spike_batch_header_t) + \
+                                     Z1_GATEWAY_BATCH_ENTRIES * sizeof(z1_spike_batch_entry_t))
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Route (8 bytes, POST /api/gateway/routes body entry)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  backplane;         // Source backplane
+    uint8_t  node;              // Source node
+    uint16_t local_id;          // Source local ID
+    uint16_t mask;              // Export: peer backplanes; import: destination nodes
+    uint16_t reserved;
+} z1_gateway_route_t;
+
+/**
+ * Gateway statistics
+ */
+typedef struct {
+    uint32_t batches_in;        // Node batches taken from the bus
+    uint32_t batches_refused;   // Node batches refused (queue full, retried by the node)
+    uint32_t spikes_out;        // Entries sent to peers (once per peer)
+    uint32_t datagrams_out;
+    uint32_t send_errors;
+    uint32_t datagrams_in;
+    uint32_t spikes_in;         // Entries delivered to local nodes
+    uint32_t unrouted;          // Entries without a route
+    uint32_t bus_errors;        // Failed spike batch transfers to local nodes
+} z1_gateway_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Set this controller's backplane number and drop the routes
+ *
+ * @param backplane Backplane number (below Z1_MAX_BACKPLANES)
+ * @return false if out of range
+ */
+bool z1_gateway_set_backplane(uint8_t backplane);
+
+/**
+ * Get this controller's backplane number
+ *
+ * @return Backplane number (0 until set)
+ */
+uint8_t z1_gateway_get_backplane(void);
+
+/**
+ * Set the controller of a peer backplane
+ *
+ * @param backplane Peer backplane number
+ * @param ip Controller address, NULL to remove the peer
+ * @param port Controller UDP spike port
+ * @return false if out of range or this backplane
+ */
+bool z1_gateway_set_peer(uint8_t backplane, const uint8_t ip[4], uint16_t port);
+
+/**
+ * Get the configured peers
+ *
+ * @param ips Filled with the address of each peer (Z1_MAX_BACKPLANES entries, may be NULL)
+ * @param ports Filled with the port of each peer (may be NULL)
+ * @return Mask of configured peer backplanes
+ */
+uint8_t z1_gateway_get_peers(uint8_t ips[][4], uint16_t* ports);
+
+/**
+ * Drop all routes
+ */
+void z1_gateway_routes_clear(void);
+
+/**
+ * Add a route (call z1_gateway_routes_commit() after the last one)
+ *
+ * @param route Route
+ * @return false if the table is full
+ */
+bool z1_gateway_route_add(const z1_gateway_route_t* route);
+
+/**
+ * Sort the added routes for lookup
+ *
+ * @return Number of routes
+ */
+uint16_t z1_gateway_routes_commit(void);
+
+/**
+ * Queue a node's spike batch (bus receive path)
+ *
+ * @param data Z1_CMD_SNN_SPIKE_BATCH payload
+ * @param length Payload length
+ * @return false if the queue is full or the batch too large
+ */
+bool z1_gateway_bus_batch(const uint8_t* data, uint16_t length);
+
+/**
+ * Check whether a node batch would be taken (bus receive path admission)
+ *
+ * @param length Payload length
+ * @return true if a queue slot is free
+ */
+bool z1_gateway_bus_room(uint16_t length);
+
+/**
+ * Deliver a peer's Z1_UDP_GATEWAY datagram to the local nodes
+ *
+ * @param header Datagram header
+ * @param payload Payload after the header
+ * @param length Payload length
+ */
+void z1_gateway_receive(const z1_udp_header_t* header, const uint8_t* payload, uint16_t length);
+
+/**
+ * Relay queued node batches and send datagrams when due (controller main loop)
+ *
+ * @return true while spikes are waiting to be relayed
+ */
+bool z1_gateway_service(void);
+
+/**
+ * Get gateway statistics
+ *
+ * @param stats Filled with the counters since boot
+ * @param routes Set to the number of routes (may be NULL)
+ */
+void z1_gateway_get_stats(z1_gateway_stats_t* stats, uint16_t* routes);
+
+#endif // Z1_GATEWAY_H
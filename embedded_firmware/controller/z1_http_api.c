@@ -6,7 +6,18 @@
 
 #include "z1_http_api.h"
 #include "z1_protocol_extended.h"
+#include "z1_multiframe.h"
 #include "z1_display.h"
+#include "z1_trace.h"
+#include "z1_telemetry.h"
+#include "z1_firmware_dist.h"
+#include "z1_checkpoint.h"
+#include "z1_batch.h"
+#include "z1_gateway.h"
+#include "z1_encoder.h"
+#include "w5500_http_server.h"
+#include "pico/time.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -24,6 +35,7 @@ bool g_snn_running = false;
 char g_snn_network_name[64] = "none";
 uint32_t g_snn_neuron_count = 0;
 uint8_t g_snn_nodes_used = 0;
+uint16_t g_snn_node_mask = 0;    // Nodes that received a neuron table
 uint32_t g_snn_spike_count = 0;  // Total spikes processed
 
 // ============================================================================
@@ -91,43 +103,57 @@ int json_end_array(char* buffer, int pos, int size, bool is_last) {
 // HTTP Response Functions
 // ============================================================================
 
+static const char* http_status_text(uint16_t status_code) {
+    switch (status_code) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 411: return "Length Required";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+    }
+    return "OK";
+}
+
+static const char* http_connection_headers(const http_connection_t* conn) {
+    return conn->keep_alive ? "Connection: keep-alive\r\nKeep-Alive: timeout=5\r\n"
+                            : "Connection: close\r\n";
+}
+
 void z1_http_send_response(http_connection_t* conn,
                            uint16_t status_code,
                            const char* content_type,
                            const char* body,
                            uint16_t body_length) {
     char headers[256];
-    const char* status_text = "OK";
-    
-    // Map status codes to text
-    switch (status_code) {
-        case 200: status_text = "OK"; break;
-        case 201: status_text = "Created"; break;
-        case 400: status_text = "Bad Request"; break;
-        case 404: status_text = "Not Found"; break;
-        case 500: status_text = "Internal Server Error"; break;
-    }
+    const char* status_text = http_status_text(status_code);
     
     // Build headers
     int header_len = snprintf(headers, sizeof(headers),
         "HTTP/1.1 %d %s\r\n"
         "Content-Type: %s\r\n"
         "Content-Length: %d\r\n"
-        "Connection: close\r\n"
+        "%s"
         "Access-Control-Allow-Origin: *\r\n"
         "\r\n",
-        status_code, status_text, content_type, body_length);
+        status_code, status_text, content_type, body_length,
+        http_connection_headers(conn));
     
     // Send headers (extern function from w5500_http_server.c)
-    extern bool w5500_send_http_data(const char* data, uint16_t length);
-    w5500_send_http_data(headers, header_len);
+    extern bool w5500_send_http_data(uint8_t socket, const char* data, uint16_t length);
+    bool sent = w5500_send_http_data(conn->socket_num, headers, header_len);
     
     // Send body
-    if (body && body_length > 0) {
-        w5500_send_http_data(body, body_length);
+    if (sent && body && body_length > 0) {
+        sent = w5500_send_http_data(conn->socket_num, body, body_length);
     }
     
-    conn->state = HTTP_STATE_CLOSING;
+    // A failed send leaves the stream out of sync, so it is closed
+    conn->state = (sent && conn->keep_alive) ? HTTP_STATE_RECEIVING_HEADERS
+                                             : HTTP_STATE_CLOSING;
 }
 
 void z1_http_send_json(http_connection_t* conn, uint16_t status_code, const char* json) {
@@ -145,69 +171,300 @@ void z1_http_send_error(http_connection_t* conn, uint16_t status_code, const cha
 }
 
 // ============================================================================
-// Node Management Endpoints
+// Streaming Responses
 // ============================================================================
 
-void handle_get_nodes(http_connection_t* conn) {
-    char json[Z1_HTTP_BUFFER_SIZE];
-    int pos = json_begin_object(json, sizeof(json));
+// Each chunk is "XXXX\r\n" data "\r\n". The size line is reserved when the
+// chunk opens and filled in when it closes; four hex digits cover the 2 KB
+// TX buffer.
+#define STREAM_SIZE_LINE    6
+#define STREAM_OVERHEAD     (STREAM_SIZE_LINE + 2)
+#define STREAM_TERMINATOR   "0\r\n\r\n"
+
+static void stream_put(z1_http_stream_t* s, const void* data, uint16_t length) {
+    w5500_tx_put(s->conn->socket_num, s->wr_ptr, (const uint8_t*)data, length);
+    s->wr_ptr += length;
+    s->room -= length;
+}
+
+static bool stream_reserve(z1_http_stream_t* s, uint16_t min) {
+    if (!w5500_tx_begin(s->conn->socket_num, min, &s->wr_ptr, &s->room)) {
+        s->failed = true;
+        return false;
+    }
+    return true;
+}
+
+static void stream_open_chunk(z1_http_stream_t* s) {
+    s->chunk_ptr = s->wr_ptr;
+    s->chunk_length = 0;
+    s->wr_ptr += STREAM_SIZE_LINE;
+    s->room -= STREAM_SIZE_LINE;
+}
+
+// Fill in the open chunk's size line; an empty chunk is taken back
+static void stream_close_chunk(z1_http_stream_t* s) {
+    if (s->chunk_length == 0) {
+        s->wr_ptr -= STREAM_SIZE_LINE;
+        s->room += STREAM_SIZE_LINE;
+        return;
+    }
     
-    // Discover active nodes
-    bool active_nodes[16] = {false};
-    z1_discover_nodes_sequential(active_nodes);
+    char line[STREAM_SIZE_LINE + 1];
+    snprintf(line, sizeof(line), "%04X\r\n", s->chunk_length);
+    w5500_tx_put(s->conn->socket_num, s->chunk_ptr, (const uint8_t*)line, STREAM_SIZE_LINE);
+    stream_put(s, "\r\n", 2);
+    s->chunk_length = 0;
+}
+
+// Send the full TX buffer as one chunk and open the next one
+static bool stream_flush(z1_http_stream_t* s) {
+    stream_close_chunk(s);
+    if (!w5500_tx_commit(s->conn->socket_num, s->wr_ptr)) {
+        s->failed = true;
+        return false;
+    }
+    if (!stream_reserve(s, Z1_HTTP_STREAM_MIN_ROOM)) {
+        return false;
+    }
+    stream_open_chunk(s);
+    return true;
+}
+
+/**
+ * Start a streamed response
+ */
+bool z1_http_stream_begin(z1_http_stream_t* stream, http_connection_t* conn,
+                          uint16_t status_code, const char* content_type) {
+    char headers[256];
+    int header_len = snprintf(headers, sizeof(headers),
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: %s\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "%s"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n",
+        status_code, http_status_text(status_code), content_type,
+        http_connection_headers(conn));
+    
+    stream->conn = conn;
+    stream->stage_len = 0;
+    stream->total = 0;
+    stream->failed = false;
+    
+    if (header_len < 0 || header_len >= (int)sizeof(headers) ||
+        !stream_reserve(stream, header_len + Z1_HTTP_STREAM_MIN_ROOM)) {
+        conn->state = HTTP_STATE_CLOSING;
+        return false;
+    }
+    stream_put(stream, headers, header_len);
+    stream_open_chunk(stream);
+    return true;
+}
+
+// Copy bytes into the open chunk, sending chunks as the TX buffer fills
+static void stream_emit(z1_http_stream_t* s, const uint8_t* data, uint16_t length) {
+    while (length > 0 && !s->failed) {
+        // Keep room for the chunk's closing CRLF
+        uint16_t space = (s->room > 2) ? s->room - 2 : 0;
+        if (space == 0) {
+            stream_flush(s);
+            continue;
+        }
+        uint16_t n = (length < space) ? length : space;
+        
+        stream_put(s, data, n);
+        s->chunk_length += n;
+        data += n;
+        length -= n;
+    }
+}
+
+static void stream_emit_stage(z1_http_stream_t* s) {
+    stream_emit(s, s->stage, s->stage_len);
+    s->stage_len = 0;
+}
+
+/**
+ * Append body bytes
+ */
+bool z1_http_stream_write(z1_http_stream_t* stream, const void* data, uint16_t length) {
+    // Small pieces are collected into one SPI burst; large ones go straight out
+    if (stream->stage_len + length > Z1_HTTP_STREAM_STAGE) {
+        stream_emit_stage(stream);
+    }
+    if (length >= Z1_HTTP_STREAM_STAGE) {
+        stream_emit(stream, (const uint8_t*)data, length);
+    } else {
+        memcpy(stream->stage + stream->stage_len, data, length);
+        stream->stage_len += length;
+    }
+    stream->total += length;
+    return !stream->failed;
+}
+
+/**
+ * Append formatted body text
+ */
+bool z1_http_stream_printf(z1_http_stream_t* stream, const char* format, ...) {
+    va_list args;
     
-    // Build nodes array
-    pos = json_begin_array(json, pos, sizeof(json), "nodes");
+    // Formatted in place behind the staged bytes; retried in an empty stage
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint16_t space = Z1_HTTP_STREAM_STAGE - stream->stage_len;
+        
+        va_start(args, format);
+        int length = vsnprintf((char*)stream->stage + stream->stage_len, space, format, args);
+        va_end(args);
+        
+        if (length < 0) {
+            break;
+        }
+        if (length < space) {
+            stream->stage_len += length;
+            stream->total += length;
+            return !stream->failed;
+        }
+        if (stream->stage_len == 0) {
+            break;
+        }
+        stream_emit_stage(stream);
+    }
     
-    for (int i = 0; i < 16; i++) {
-        if (active_nodes[i]) {
-            // Get node info
-            z1_node_info_t info;
-            if (z1_get_node_info(i, &info)) {
-                // Add node object
-                int obj_start = pos;
-                pos += snprintf(json + pos, sizeof(json) - pos, "{");
-                pos = json_add_int(json, pos, sizeof(json), "id", i, false);
-                pos = json_add_string(json, pos, sizeof(json), "status", "active", false);
-                pos = json_add_int(json, pos, sizeof(json), "memory_free", info.free_memory, false);
-                pos = json_add_int(json, pos, sizeof(json), "uptime_ms", info.uptime_ms, true);
-                pos += snprintf(json + pos, sizeof(json) - pos, "}");
-                
-                if (i < 15 && active_nodes[i+1]) {
-                    pos += snprintf(json + pos, sizeof(json) - pos, ",");
-                }
-            }
+    // Truncated text would corrupt the document, so the response is cut instead
+    stream->failed = true;
+    return false;
+}
+
+/**
+ * Finish a streamed response
+ */
+bool z1_http_stream_end(z1_http_stream_t* stream) {
+    uint16_t terminator = sizeof(STREAM_TERMINATOR) - 1;
+    
+    stream_emit_stage(stream);
+    if (!stream->failed) {
+        stream_close_chunk(stream);
+        if (stream->room < terminator &&
+            (!w5500_tx_commit(stream->conn->socket_num, stream->wr_ptr) ||
+             !stream_reserve(stream, terminator))) {
+            stream->failed = true;
         }
     }
+    if (!stream->failed) {
+        stream_put(stream, STREAM_TERMINATOR, terminator);
+        stream->failed = !w5500_tx_commit(stream->conn->socket_num, stream->wr_ptr);
+    }
     
-    pos = json_end_array(json, pos, sizeof(json), true);
-    json_end_object(json, pos, sizeof(json));
+    // A response cut short leaves the stream out of sync, so it is closed
+    stream->conn->state = (!stream->failed && stream->conn->keep_alive) ?
+                          HTTP_STATE_RECEIVING_HEADERS : HTTP_STATE_CLOSING;
+    return !stream->failed;
+}
+
+// ============================================================================
+// Node Management Endpoints
+// ============================================================================
+
+// Append one node of the telemetry table as {...}
+static int json_add_node_telemetry(char* json, int pos, int size, uint8_t node,
+                                   const z1_telemetry_node_t* t, uint32_t now_ms) {
+    int written = snprintf(json + pos, size - pos,
+                           "{\"id\":%d,\"status\":\"%s\",\"last_seen_ms\":%u",
+                           node, t->alive ? "active" : "inactive",
+                           (unsigned int)(now_ms - t->last_seen_ms));
+    if (written < 0 || pos + written >= size) return -1;
+    pos += written;
+    
+    if (t->have_status) {
+        const z1_snn_status_t* s = &t->status;
+        written = snprintf(json + pos, size - pos,
+                           ",\"status_age_ms\":%u,\"uptime_ms\":%u,\"neuron_count\":%u,"
+                           "\"snn_running\":%s,\"steps\":%u,\"spikes\":%u,"
+                           "\"cache\":{\"hits\":%u,\"misses\":%u,\"evictions\":%u}",
+                           (unsigned int)(now_ms - t->status_ms), (unsigned int)s->uptime_ms,
+                           s->neuron_count, s->running ? "true" : "false",
+                           (unsigned int)s->steps_completed, (unsigned int)s->spikes_generated,
+                           (unsigned int)s->cache_hits, (unsigned int)s->cache_misses,
+                           (unsigned int)s->cache_evictions);
+        if (written < 0 || pos + written >= size) return -1;
+        pos += written;
+    }
     
-    z1_http_send_json(conn, 200, json);
+    written = snprintf(json + pos, size - pos, "}");
+    if (written < 0 || pos + written >= size) return -1;
+    return pos + written;
+}
+
+/**
+ * Handle get nodes - GET /api/nodes[?refresh=1]
+ * Served from the telemetry table; refresh=1 runs a discovery first
+ */
+void handle_get_nodes(http_connection_t* conn, bool refresh) {
+    if (refresh) {
+        bool active_nodes[16] = {false};
+        z1_discover_nodes_sequential(active_nodes);
+        z1_telemetry_record_discovery(active_nodes);
+    }
+    
+    z1_http_stream_t out;
+    if (!z1_http_stream_begin(&out, conn, 200, "application/json")) {
+        return;
+    }
+    z1_http_stream_printf(&out, "{\"nodes\":[");
+    
+    // Nodes that answered since boot; the ones that stopped are listed as inactive
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < Z1_MAX_NODES; i++) {
+        const z1_telemetry_node_t* t = z1_telemetry_node(i);
+        if (!t->seen) {
+            continue;
+        }
+        
+        // Streamed one node at a time, so the table size is not bounded by a buffer
+        char entry[512];
+        int pos = snprintf(entry, sizeof(entry), "%s", total ? "," : "");
+        pos = json_add_node_telemetry(entry, pos, sizeof(entry), i, t, now_ms);
+        if (pos > 0) {
+            z1_http_stream_write(&out, entry, pos);
+            total++;
+        }
+    }
+    
+    z1_telemetry_stats_t tel;
+    z1_telemetry_get_stats(&tel);
+    z1_http_stream_printf(&out,
+                          "],\"total\":%u,\"telemetry\":{\"polls\":%u,\"status_failed\":%u,"
+                          "\"pings_lost\":%u,\"sweep_ms\":%u}}",
+                          total, (unsigned int)tel.polls, (unsigned int)tel.status_failed,
+                          (unsigned int)tel.pings_lost, (unsigned int)tel.sweep_ms);
+    z1_http_stream_end(&out);
 }
 
+/**
+ * Handle get node - GET /api/nodes/{id}
+ * Served from the telemetry table
+ */
 void handle_get_node(http_connection_t* conn, uint8_t node_id) {
     if (node_id > 15) {
         z1_http_send_error(conn, 400, "Invalid node ID");
         return;
     }
     
-    z1_node_info_t info;
-    if (!z1_get_node_info(node_id, &info)) {
+    const z1_telemetry_node_t* t = z1_telemetry_node(node_id);
+    if (!t->seen) {
         z1_http_send_error(conn, 404, "Node not found or not responding");
         return;
     }
     
     char json[512];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_int(json, pos, sizeof(json), "id", node_id, false);
-    pos = json_add_string(json, pos, sizeof(json), "status", "active", false);
-    pos = json_add_int(json, pos, sizeof(json), "memory_free", info.free_memory, false);
-    pos = json_add_int(json, pos, sizeof(json), "uptime_ms", info.uptime_ms, false);
-    pos = json_add_int(json, pos, sizeof(json), "neuron_count", info.neuron_count, false);
-    pos = json_add_int(json, pos, sizeof(json), "spike_count", g_snn_spike_count, true);
-    json_end_object(json, pos, sizeof(json));
-    
+    int pos = json_add_node_telemetry(json, 0, sizeof(json), node_id, t,
+                                      to_ms_since_boot(get_absolute_time()));
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
     z1_http_send_json(conn, 200, json);
 }
 
@@ -252,6 +509,7 @@ void handle_post_nodes_discover(http_connection_t* conn) {
     
     bool active_nodes[16] = {false};
     z1_discover_nodes_sequential(active_nodes);
+    z1_telemetry_record_discovery(active_nodes);
     
     char json[512];
     int pos = json_begin_object(json, sizeof(json));
@@ -283,43 +541,87 @@ void handle_post_nodes_discover(http_connection_t* conn) {
 // Memory Operations Endpoints
 // ============================================================================
 
+/**
+ * Handle get node memory - GET /api/nodes/{id}/memory?address=A&length=N[&format=bin]
+ * Streams a node PSRAM range to the client as the node's blocks arrive
+ *
+ * JSON carries the data base64-encoded; format=bin sends it raw. A read
+ * that fails part way cuts the stream, so a short body means a failed read.
+ */
 void handle_get_node_memory(http_connection_t* conn, uint8_t node_id, 
-                           uint32_t addr, uint16_t length) {
+                           uint32_t addr, uint32_t length, bool binary) {
+    // Encoded a whole number of base64 groups at a time, so the pieces join
+    static uint8_t block[Z1_HTTP_MEMORY_BLOCK];
+    static char b64[Z1_HTTP_MEMORY_BLOCK / 3 * 4 + 1];
+    
     if (node_id > 15) {
         z1_http_send_error(conn, 400, "Invalid node ID");
         return;
     }
     
-    if (length > 4096) {
-        z1_http_send_error(conn, 400, "Length too large (max 4096 bytes)");
+    if (length == 0) {
+        z1_http_send_error(conn, 400, "Length required");
         return;
     }
     
-    uint8_t buffer[4096];
-    int bytes_read = z1_read_node_memory(node_id, addr, buffer, length);
-    
-    if (bytes_read < 0) {
+    // The first block decides between an error answer and a stream
+    int n = -1;
+    if (z1_mem_read_begin(node_id, addr, length)) {
+        n = z1_mem_read_next(block, sizeof(block), Z1_MEM_READ_NEXT_TIMEOUT_MS);
+    }
+    if (n <= 0) {
+        z1_mem_read_end();
         z1_http_send_error(conn, 500, "Failed to read memory");
         return;
     }
     
-    // Encode to base64
-    char b64_buffer[6000];
-    int b64_len = base64_encode(buffer, bytes_read, b64_buffer, sizeof(b64_buffer));
-    
-    if (b64_len < 0) {
-        z1_http_send_error(conn, 500, "Failed to encode data");
+    z1_http_stream_t out;
+    if (!z1_http_stream_begin(&out, conn, 200,
+                              binary ? "application/octet-stream" : "application/json")) {
+        z1_mem_read_end();
         return;
     }
+    if (!binary) {
+        z1_http_stream_printf(&out, "{\"addr\":%u,\"length\":%u,\"data\":\"",
+                              (unsigned int)addr, (unsigned int)length);
+    }
     
-    char json[Z1_HTTP_BUFFER_SIZE];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_int(json, pos, sizeof(json), "addr", addr, false);
-    pos = json_add_int(json, pos, sizeof(json), "length", bytes_read, false);
-    pos = json_add_string(json, pos, sizeof(json), "data", b64_buffer, true);
-    json_end_object(json, pos, sizeof(json));
+    uint32_t total = 0;
+    uint16_t fill = n;
+    while (fill > 0 && !out.failed) {
+        total += fill;
+        
+        // Top the block up so that only the last one is a partial base64 group
+        while (!binary && fill < sizeof(block) && total < length) {
+            n = z1_mem_read_next(block + fill, sizeof(block) - fill, Z1_MEM_READ_NEXT_TIMEOUT_MS);
+            if (n <= 0) {
+                break;
+            }
+            fill += n;
+            total += n;
+        }
+        
+        if (binary) {
+            z1_http_stream_write(&out, block, fill);
+        } else {
+            int b64_len = base64_encode(block, fill, b64, sizeof(b64));
+            z1_http_stream_write(&out, b64, b64_len > 0 ? b64_len : 0);
+        }
+        
+        if (total >= length || n <= 0) {
+            break;
+        }
+        n = z1_mem_read_next(block, sizeof(block), Z1_MEM_READ_NEXT_TIMEOUT_MS);
+        fill = (n > 0) ? n : 0;
+    }
+    z1_mem_read_end();
     
-    z1_http_send_json(conn, 200, json);
+    if (total < length) {
+        out.failed = true;  // Cut the response: the client must not take it as whole
+    } else if (!binary) {
+        z1_http_stream_printf(&out, "\"}");
+    }
+    z1_http_stream_end(&out);
 }
 
 void handle_post_node_memory(http_connection_t* conn, uint8_t node_id, const char* body) {
@@ -337,8 +639,61 @@ void handle_post_node_memory(http_connection_t* conn, uint8_t node_id, const cha
 // SNN Management Endpoints
 // ============================================================================
 
-void handle_get_snn_status(http_connection_t* conn) {
-    char json[512];
+// Append the per-phase timing of a node status response as "timing":{...}
+static int json_add_snn_timing(char* json, int pos, int size, uint8_t node,
+                               const z1_snn_status_t* status) {
+    static const char* const phases[Z1_SNN_PHASE_COUNT] = {
+        "ingress", "delivery", "sweep", "routing", "flush", "stall", "step",
+    };
+    
+    int written = snprintf(json + pos, size - pos,
+                           "\"timing\":{\"node\":%d,\"steps\":%u,\"fanout_stalls\":%u,"
+                           "\"spikes_spilled\":%u,\"spikes_dropped\":%u,\"credit_stalls\":%u,"
+                           "\"ticks_per_us\":%u,\"bucket_shift\":%u,\"phases\":{",
+                           node, (unsigned int)status->steps_completed,
+                           (unsigned int)status->fanout_stalls,
+                           (unsigned int)status->spikes_spilled, (unsigned int)status->spikes_dropped,
+                           (unsigned int)status->credit_stalls,
+                           status->ticks_per_us, status->bucket_shift);
+    if (written < 0 || pos + written >= size) return -1;
+    pos += written;
+    
+    for (uint8_t p = 0; p < Z1_SNN_PHASE_COUNT; p++) {
+        const z1_snn_phase_status_t* ph = &status->phases[p];
+        written = snprintf(json + pos, size - pos,
+                           "\"%s\":{\"samples\":%u,\"min\":%u,\"avg\":%u,\"max\":%u,\"hist\":[",
+                           phases[p], (unsigned int)ph->samples, (unsigned int)ph->min_ticks,
+                           (unsigned int)ph->avg_ticks, (unsigned int)ph->max_ticks);
+        if (written < 0 || pos + written >= size) return -1;
+        pos += written;
+        
+        for (uint8_t b = 0; b < Z1_SNN_STATUS_BUCKETS; b++) {
+            written = snprintf(json + pos, size - pos, "%u%s", (unsigned int)ph->buckets[b],
+                               (b + 1 < Z1_SNN_STATUS_BUCKETS) ? "," : "");
+            if (written < 0 || pos + written >= size) return -1;
+            pos += written;
+        }
+        
+        written = snprintf(json + pos, size - pos, "]}%s", (p + 1 < Z1_SNN_PHASE_COUNT) ? "," : "");
+        if (written < 0 || pos + written >= size) return -1;
+        pos += written;
+    }
+    
+    written = snprintf(json + pos, size - pos, "}}");
+    if (written < 0 || pos + written >= size) return -1;
+    return pos + written;
+}
+
+/**
+ * Handle get SNN status - GET /api/snn/status
+ * Cluster state plus engine counters and per-phase timing of one node,
+ * from the telemetry table unless reset or refresh asks for a live query
+ */
+void handle_get_snn_status(http_connection_t* conn, uint8_t node, bool reset_timing, bool refresh) {
+    static z1_snn_status_t live;
+    const z1_snn_status_t* status = NULL;
+    uint32_t status_age_ms = 0;
+    char json[2048];
     int pos = json_begin_object(json, sizeof(json));
     pos = json_add_string(json, pos, sizeof(json), "state", 
                          g_snn_running ? "running" : (g_snn_deployed ? "stopped" : "idle"), false);
@@ -346,35 +701,69 @@ void handle_get_snn_status(http_connection_t* conn) {
     pos = json_add_int(json, pos, sizeof(json), "neuron_count", g_snn_neuron_count, false);
     pos = json_add_int(json, pos, sizeof(json), "nodes_used", g_snn_nodes_used, false);
     
-    // Query activity from first node
-    if (g_snn_deployed && g_snn_nodes_used > 0) {
-        z1_snn_activity_t activity;
-        if (z1_query_snn_activity(0, &activity)) {
-            pos = json_add_int(json, pos, sizeof(json), "active_neurons", activity.active_neurons, false);
-            pos = json_add_int(json, pos, sizeof(json), "total_spikes", activity.total_spikes, false);
-            pos = json_add_int(json, pos, sizeof(json), "spike_rate_hz", activity.spike_rate_hz, true);
-        } else {
-            pos = json_add_int(json, pos, sizeof(json), "active_neurons", 0, false);
-            pos = json_add_int(json, pos, sizeof(json), "total_spikes", 0, false);
-            pos = json_add_int(json, pos, sizeof(json), "spike_rate_hz", 0, true);
+    // Barrier run: release rate and the node holding it back
+    z1_snn_sync_stats_t sync;
+    z1_snn_sync_get_stats(&sync);
+    if (sync.active && pos >= 0) {
+        int written = snprintf(json + pos, sizeof(json) - pos,
+                               "\"sync\":{\"step\":%u,\"period_us\":%u,\"slot_us\":%u,\"retries\":%u,"
+                               "\"last_step_us\":%u,\"avg_step_us\":%u,\"max_step_us\":%u,"
+                               "\"slowest_node\":%u},",
+                               (unsigned int)sync.steps_done, (unsigned int)sync.period_us,
+                               (unsigned int)sync.slot_us,
+                               (unsigned int)sync.retries, (unsigned int)sync.last_step_us,
+                               (unsigned int)sync.avg_step_us, (unsigned int)sync.max_step_us,
+                               sync.slowest_node);
+        pos = (written < 0 || pos + written >= (int)sizeof(json)) ? -1 : pos + written;
+    }
+    
+    // Resetting needs the node itself (one GET_STATUS round trip); else the last poll
+    const z1_telemetry_node_t* cached = z1_telemetry_node(node);
+    if (!g_snn_deployed || !cached) {
+        // Nothing to report
+    } else if (reset_timing || refresh) {
+        if (z1_query_snn_status(node, reset_timing, &live)) {
+            z1_telemetry_record_status(node, &live);
+            status = &live;
         }
+    } else if (cached->have_status) {
+        status = &cached->status;
+        status_age_ms = to_ms_since_boot(get_absolute_time()) - cached->status_ms;
+    }
+    
+    if (status) {
+        uint32_t rate = status->current_time_us > 0 ?
+            (uint32_t)((uint64_t)status->spikes_generated * 1000000 / status->current_time_us) : 0;
+        pos = json_add_int(json, pos, sizeof(json), "active_neurons", status->active_neurons, false);
+        pos = json_add_int(json, pos, sizeof(json), "total_spikes", status->spikes_generated, false);
+        pos = json_add_int(json, pos, sizeof(json), "spike_rate_hz", rate, false);
+        pos = json_add_int(json, pos, sizeof(json), "status_age_ms", status_age_ms, false);
+        pos = json_add_snn_timing(json, pos, sizeof(json), node, status);
     } else {
         pos = json_add_int(json, pos, sizeof(json), "active_neurons", 0, false);
         pos = json_add_int(json, pos, sizeof(json), "total_spikes", 0, false);
         pos = json_add_int(json, pos, sizeof(json), "spike_rate_hz", 0, true);
     }
     
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
     json_end_object(json, pos, sizeof(json));
     z1_http_send_json(conn, 200, json);
 }
 
-void handle_post_snn_start(http_connection_t* conn) {
+void handle_post_snn_start(http_connection_t* conn, bool sync, uint32_t period_us,
+                           uint16_t slot_us, uint16_t guard_us) {
     if (!g_snn_deployed) {
         z1_http_send_error(conn, 400, "No SNN deployed");
         return;
     }
     
-    if (z1_start_snn_all()) {
+    z1_snn_tdma_config_t tdma = { .node_mask = 0, .slot_us = slot_us, .guard_us = guard_us };
+    bool started = sync ? z1_start_snn_sync(g_snn_node_mask, period_us, slot_us ? &tdma : NULL) :
+                          z1_start_snn_all();
+    if (started) {
         g_snn_running = true;
         
         // Update display
@@ -394,6 +783,7 @@ void handle_post_snn_start(http_connection_t* conn) {
 void handle_post_snn_stop(http_connection_t* conn) {
     if (z1_stop_snn_all()) {
         g_snn_running = false;
+        z1_encoder_stop();
         
         // Update display
         z1_display_snn_status(false, g_snn_spike_count);
@@ -410,348 +800,2530 @@ void handle_post_snn_stop(http_connection_t* conn) {
 }
 
 // ============================================================================
-// URL Parsing
+// SNN Checkpoints
 // ============================================================================
 
-int parse_url_path(const char* path, char components[][32], int max_components) {
-    int count = 0;
-    const char* start = path;
+// POST /api/snn/checkpoint saves the stopped run of every node holding the
+// deployed network into controller PSRAM (z1_checkpoint.h), POST
+// /api/snn/restore puts it back on the same nodes and GET
+// /api/snn/checkpoint describes what is stored. A restore needs the network
+// the checkpoint was taken from to still be loaded on the nodes.
+
+static const char* checkpoint_status_text(uint8_t status) {
+    switch (status) {
+        case Z1_SNN_CKPT_STATUS_OK:         return "ok";
+        case Z1_SNN_CKPT_STATUS_NONE:       return "none";
+        case Z1_SNN_CKPT_STATUS_BUSY:       return "running";
+        case Z1_SNN_CKPT_STATUS_NO_NETWORK: return "no_network";
+        case Z1_SNN_CKPT_STATUS_TOO_LARGE:  return "too_large";
+        case Z1_SNN_CKPT_STATUS_BAD_IMAGE:  return "bad_image";
+        case Z1_SNN_CKPT_STATUS_MISMATCH:   return "different_network";
+        default:                            return "failed";
+    }
+}
+
+// {"status":..., "bytes":..., "elapsed_ms":..., "nodes":[...]} for the nodes in node_mask
+static void send_checkpoint_nodes(http_connection_t* conn, int status_code, const char* status,
+                                  uint16_t node_mask, const z1_snn_ckpt_info_t* nodes,
+                                  uint32_t bytes, uint32_t elapsed_ms) {
+    char json[Z1_HTTP_BUFFER_SIZE];
     
-    // Skip leading slash
-    if (*start == '/') start++;
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "status", status, false);
+    pos = json_add_int(json, pos, sizeof(json), "bytes", bytes, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", elapsed_ms, false);
+    pos = json_begin_array(json, pos, sizeof(json), "nodes");
     
-    while (*start && count < max_components) {
-        const char* end = strchr(start, '/');
-        if (!end) end = start + strlen(start);
-        
-        int len = end - start;
-        if (len > 0 && len < 32) {
-            strncpy(components[count], start, len);
-            components[count][len] = '\0';
-            count++;
+    bool first = true;
+    for (uint8_t node = 0; node < Z1_MAX_NODES && pos >= 0; node++) {
+        if (!(node_mask & (1u << node))) {
+            continue;
         }
-        
-        if (*end == '\0') break;
-        start = end + 1;
+        const z1_snn_ckpt_info_t* n = &nodes[node];
+        int written = snprintf(json + pos, sizeof(json) - pos,
+                               "%s{\"id\":%u,\"status\":\"%s\",\"neurons\":%u,\"length\":%lu,"
+                               "\"steps\":%lu,\"learned_rows\":%u,\"crc32\":\"0x%08lX\"}",
+                               first ? "" : ",", node, checkpoint_status_text(n->status),
+                               n->neuron_count, (unsigned long)n->length, (unsigned long)n->steps,
+                               n->learned_rows, (unsigned long)n->crc32);
+        pos = (written < 0 || pos + written >= (int)sizeof(json)) ? -1 : pos + written;
+        first = false;
     }
     
-    return count;
+    if (pos >= 0) {
+        pos = json_end_array(json, pos, sizeof(json), true);
+    }
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, status_code, json);
 }
 
-bool parse_query_param(const char* query, const char* key, char* value, int value_size) {
-    const char* pos = strstr(query, key);
-    if (!pos) return false;
-    
-    pos += strlen(key);
-    if (*pos != '=') return false;
-    pos++;
-    
-    const char* end = strchr(pos, '&');
-    if (!end) end = pos + strlen(pos);
-    
-    int len = end - pos;
-    if (len >= value_size) len = value_size - 1;
+// Save and restore both need a stopped, deployed network
+static bool checkpoint_ready(http_connection_t* conn) {
+    if (!g_snn_deployed || g_snn_node_mask == 0) {
+        z1_http_send_error(conn, 400, "No SNN deployed");
+        return false;
+    }
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN first");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Handle checkpoint save - POST /api/snn/checkpoint
+ */
+void handle_post_snn_checkpoint(http_connection_t* conn) {
+    if (!checkpoint_ready(conn)) {
+        return;
+    }
     
-    strncpy(value, pos, len);
-    value[len] = '\0';
+    z1_checkpoint_result_t result;
+    bool ok = z1_checkpoint_save(g_snn_node_mask, &result);
+    send_checkpoint_nodes(conn, ok ? 200 : 500, ok ? "saved" : "incomplete", result.targets,
+                          result.nodes, result.bytes, result.elapsed_ms);
+}
+
+/**
+ * Handle checkpoint restore - POST /api/snn/restore
+ */
+void handle_post_snn_restore(http_connection_t* conn) {
+    if (!checkpoint_ready(conn)) {
+        return;
+    }
+    if (z1_checkpoint_stored_mask() == 0) {
+        z1_http_send_error(conn, 404, "No checkpoint stored");
+        return;
+    }
     
-    return true;
+    z1_checkpoint_result_t result;
+    bool ok = z1_checkpoint_restore(g_snn_node_mask, &result);
+    send_checkpoint_nodes(conn, ok ? 200 : 500, ok ? "restored" : "incomplete", result.targets,
+                          result.nodes, result.bytes, result.elapsed_ms);
 }
 
-int32_t parse_query_param_int(const char* query, const char* key, int32_t default_value) {
-    char value[32];
-    if (!parse_query_param(query, key, value, sizeof(value))) {
-        return default_value;
+/**
+ * Handle checkpoint description - GET /api/snn/checkpoint
+ */
+void handle_get_snn_checkpoint(http_connection_t* conn) {
+    static z1_snn_ckpt_info_t nodes[Z1_MAX_NODES];
+    uint16_t stored = z1_checkpoint_stored_mask();
+    uint32_t bytes = 0;
+    
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (z1_checkpoint_get_info(node, &nodes[node])) {
+            bytes += nodes[node].length;
+        }
     }
-    return atoi(value);
+    send_checkpoint_nodes(conn, 200, stored ? "stored" : "none", stored, nodes, bytes, 0);
 }
 
 // ============================================================================
-// Base64 Implementation (simplified)
+// Backplane Gateway
 // ============================================================================
 
-static const char base64_chars[] = 
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-int base64_encode(const uint8_t* input, int input_length, 
-                 char* output, int output_size) {
-    int i = 0, j = 0;
-    uint8_t char_array_3[3];
-    uint8_t char_array_4[4];
+/**
+ * Handle gateway status - GET /api/gateway
+ */
+void handle_get_gateway(http_connection_t* conn) {
+    static uint8_t ips[Z1_MAX_BACKPLANES][4];
+    uint16_t ports[Z1_MAX_BACKPLANES];
+    z1_gateway_stats_t stats;
+    uint16_t routes;
+    char json[1024];
     
-    int output_length = ((input_length + 2) / 3) * 4;
-    if (output_length >= output_size) return -1;
+    uint8_t peers = z1_gateway_get_peers(ips, ports);
+    z1_gateway_get_stats(&stats, &routes);
     
-    while (input_length--) {
-        char_array_3[i++] = *(input++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-            
-            for (i = 0; i < 4; i++)
-                output[j++] = base64_chars[char_array_4[i]];
-            i = 0;
-        }
-    }
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_int(json, pos, sizeof(json), "backplane", z1_gateway_get_backplane(), false);
+    pos = json_add_int(json, pos, sizeof(json), "routes", routes, false);
+    pos = json_add_int(json, pos, sizeof(json), "batches_in", stats.batches_in, false);
+    pos = json_add_int(json, pos, sizeof(json), "batches_refused", stats.batches_refused, false);
+    pos = json_add_int(json, pos, sizeof(json), "spikes_out", stats.spikes_out, false);
+    pos = json_add_int(json, pos, sizeof(json), "datagrams_out", stats.datagrams_out, false);
+    pos = json_add_int(json, pos, sizeof(json), "send_errors", stats.send_errors, false);
+    pos = json_add_int(json, pos, sizeof(json), "datagrams_in", stats.datagrams_in, false);
+    pos = json_add_int(json, pos, sizeof(json), "spikes_in", stats.spikes_in, false);
+    pos = json_add_int(json, pos, sizeof(json), "unrouted", stats.unrouted, false);
+    pos = json_add_int(json, pos, sizeof(json), "bus_errors", stats.bus_errors, false);
+    pos = json_begin_array(json, pos, sizeof(json), "peers");
+    
+    bool first = true;
+    for (uint8_t bp = 0; bp < Z1_MAX_BACKPLANES && pos >= 0; bp++) {
+        if (!(peers & (1u << bp))) {
+            continue;
+        }
+        int written = snprintf(json + pos, sizeof(json) - pos,
+                               "%s{\"backplane\":%u,\"ip\":\"%u.%u.%u.%u\",\"port\":%u}",
+                               first ? "" : ",", bp, ips[bp][0], ips[bp][1], ips[bp][2],
+                               ips[bp][3], ports[bp]);
+        pos = (written < 0 || pos + written >= (int)sizeof(json)) ? -1 : pos + written;
+        first = false;
+    }
+    
+    if (pos >= 0) {
+        pos = json_end_array(json, pos, sizeof(json), true);
+    }
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+/**
+ * Handle gateway setup - POST /api/gateway?backplane=N
+ * Sets this controller's backplane number; the routes are dropped
+ */
+void handle_post_gateway(http_connection_t* conn, const char* query) {
+    int32_t backplane = parse_query_param_int(query, "backplane", -1);
+    
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN first");
+        return;
+    }
+    if (backplane < 0 || !z1_gateway_set_backplane((uint8_t)backplane)) {
+        z1_http_send_error(conn, 400, "Invalid backplane");
+        return;
+    }
+    
+    handle_get_gateway(conn);
+}
+
+/**
+ * Handle peer setup - POST /api/gateway/peer?backplane=N[&ip=A.B.C.D&port=P]
+ * Without ip the peer is removed
+ */
+void handle_post_gateway_peer(http_connection_t* conn, const char* query) {
+    int32_t backplane = parse_query_param_int(query, "backplane", -1);
+    int32_t port = parse_query_param_int(query, "port", Z1_UDP_PORT);
+    char value[20];
+    uint8_t ip[4];
+    bool remove = !parse_query_param(query, "ip", value, sizeof(value));
+    
+    if (!remove) {
+        unsigned int a, b, c, d;
+        if (sscanf(value, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 ||
+            a > 255 || b > 255 || c > 255 || d > 255) {
+            z1_http_send_error(conn, 400, "Invalid ip");
+            return;
+        }
+        ip[0] = a; ip[1] = b; ip[2] = c; ip[3] = d;
+    }
+    if (port <= 0 || port > 0xFFFF) {
+        z1_http_send_error(conn, 400, "Invalid port");
+        return;
+    }
+    if (backplane < 0 || !z1_gateway_set_peer((uint8_t)backplane, remove ? NULL : ip, (uint16_t)port)) {
+        z1_http_send_error(conn, 400, "Invalid backplane");
+        return;
+    }
+    
+    handle_get_gateway(conn);
+}
+
+// POST /api/gateway/routes: z1_gateway_route_t entries, replacing the table
+typedef struct {
+    bool active;
+    bool overflow;
+    uint8_t field[sizeof(z1_gateway_route_t)];
+    uint8_t field_length;
+} z1_gateway_upload_t;
+
+static z1_gateway_upload_t g_gateway_upload;
+
+static bool gateway_routes_begin(http_connection_t* conn, uint32_t content_length) {
+    if (g_gateway_upload.active) {
+        z1_http_send_error(conn, 503, "Route upload already in progress");
+        return false;
+    }
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN first");
+        return false;
+    }
+    
+    g_gateway_upload.active = true;
+    g_gateway_upload.overflow = false;
+    g_gateway_upload.field_length = 0;
+    z1_gateway_routes_clear();
+    return true;
+}
+
+static bool gateway_routes_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    while (length > 0) {
+        uint8_t n = sizeof(z1_gateway_route_t) - g_gateway_upload.field_length;
+        if (n > length) n = length;
+        memcpy(g_gateway_upload.field + g_gateway_upload.field_length, data, n);
+        g_gateway_upload.field_length += n;
+        data += n;
+        length -= n;
+        
+        if (g_gateway_upload.field_length == sizeof(z1_gateway_route_t)) {
+            z1_gateway_route_t route;
+            memcpy(&route, g_gateway_upload.field, sizeof(route));
+            g_gateway_upload.overflow |= !z1_gateway_route_add(&route);
+            g_gateway_upload.field_length = 0;
+        }
+    }
+    
+    return true;
+}
+
+static void gateway_routes_end(http_connection_t* conn, bool complete) {
+    g_gateway_upload.active = false;
+    
+    // Whatever arrived is usable; an incomplete table is reported
+    uint16_t routes = z1_gateway_routes_commit();
+    if (!complete || g_gateway_upload.field_length != 0) {
+        z1_http_send_error(conn, 400, "Incomplete route data");
+        return;
+    }
+    if (g_gateway_upload.overflow) {
+        z1_http_send_error(conn, 413, "Too many routes");
+        return;
+    }
+    
+    char json[64];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_int(json, pos, sizeof(json), "routes", routes, true);
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+const z1_http_body_sink_t g_gateway_routes_sink = {
+    .begin = gateway_routes_begin,
+    .write = gateway_routes_write,
+    .end = gateway_routes_end,
+};
+
+// ============================================================================
+// URL Parsing
+// ============================================================================
+
+int parse_url_path(const char* path, char components[][32], int max_components) {
+    int count = 0;
+    const char* start = path;
+    
+    // Skip leading slash
+    if (*start == '/') start++;
+    
+    while (*start && count < max_components) {
+        const char* end = strchr(start, '/');
+        if (!end) end = start + strlen(start);
+        
+        int len = end - start;
+        if (len > 0 && len < 32) {
+            strncpy(components[count], start, len);
+            components[count][len] = '\0';
+            count++;
+        }
+        
+        if (*end == '\0') break;
+        start = end + 1;
+    }
+    
+    return count;
+}
+
+bool parse_query_param(const char* query, const char* key, char* value, int value_size) {
+    const char* pos = strstr(query, key);
+    if (!pos) return false;
+    
+    pos += strlen(key);
+    if (*pos != '=') return false;
+    pos++;
+    
+    const char* end = strchr(pos, '&');
+    if (!end) end = pos + strlen(pos);
+    
+    int len = end - pos;
+    if (len >= value_size) len = value_size - 1;
+    
+    strncpy(value, pos, len);
+    value[len] = '\0';
+    
+    return true;
+}
+
+int32_t parse_query_param_int(const char* query, const char* key, int32_t default_value) {
+    char value[32];
+    if (!parse_query_param(query, key, value, sizeof(value))) {
+        return default_value;
+    }
+    return atoi(value);
+}
+
+// ============================================================================
+// Base64 Implementation (simplified)
+// ============================================================================
+
+static const char base64_chars[] = 
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int base64_encode(const uint8_t* input, int input_length, 
+                 char* output, int output_size) {
+    int i = 0, j = 0;
+    uint8_t char_array_3[3];
+    uint8_t char_array_4[4];
+    
+    int output_length = ((input_length + 2) / 3) * 4;
+    if (output_length >= output_size) return -1;
+    
+    while (input_length--) {
+        char_array_3[i++] = *(input++);
+        if (i == 3) {
+            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+            char_array_4[3] = char_array_3[2] & 0x3f;
+            
+            for (i = 0; i < 4; i++)
+                output[j++] = base64_chars[char_array_4[i]];
+            i = 0;
+        }
+    }
+    
+    if (i) {
+        for (int k = i; k < 3; k++)
+            char_array_3[k] = '\0';
+        
+        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+        
+        for (int k = 0; k < i + 1; k++)
+            output[j++] = base64_chars[char_array_4[k]];
+        
+        while (i++ < 3)
+            output[j++] = '=';
+    }
+    
+    output[j] = '\0';
+    return j;
+}
+
+int base64_decode(const char* input, uint8_t* output, int output_size) {
+    // TODO: Implement base64 decode
+    return -1;
+}
+
+
+// ============================================================================
+// SNN Neuron Map
+// ============================================================================
+
+// Global neuron ID -> (owner nodes, local ID), taken from the global_id
+// field of every neuron table as it is deployed. Consecutive IDs with
+// consecutive local IDs on the same nodes share one run, so a layer placed
+// on a node costs one run.
+
+#define Z1_NEURON_MAP_MAX_RUNS      512
+#define Z1_NEURON_GLOBAL_ID_OFFSET  20      // Entry bytes 20-23: uint32 global_id
+
+typedef struct {
+    uint32_t global_first;
+    uint16_t local_first;
+    uint16_t count;
+    uint16_t node_mask;             // Nodes holding the table (several if shared)
+} z1_neuron_run_t;
+
+typedef struct {
+    z1_neuron_run_t runs[Z1_NEURON_MAP_MAX_RUNS];
+    uint16_t run_count;
+    bool valid;                     // Built by the last successful deploy
+    bool overflow;                  // Too many runs, or IDs that overlap
+} z1_neuron_map_t;
+
+static z1_neuron_map_t g_neuron_map;
+
+static void neuron_map_reset(void) {
+    g_neuron_map.run_count = 0;
+    g_neuron_map.valid = false;
+    g_neuron_map.overflow = false;
+}
+
+static void neuron_map_add(uint32_t global_id, uint16_t local_id, uint16_t node_mask) {
+    if (g_neuron_map.run_count > 0) {
+        z1_neuron_run_t* run = &g_neuron_map.runs[g_neuron_map.run_count - 1];
+        if (run->node_mask == node_mask && run->count < UINT16_MAX &&
+            global_id == run->global_first + run->count &&
+            local_id == run->local_first + run->count) {
+            run->count++;
+            return;
+        }
+    }
+    
+    if (g_neuron_map.run_count == Z1_NEURON_MAP_MAX_RUNS) {
+        g_neuron_map.overflow = true;
+        return;
+    }
+    z1_neuron_run_t* run = &g_neuron_map.runs[g_neuron_map.run_count++];
+    run->global_first = global_id;
+    run->local_first = local_id;
+    run->count = 1;
+    run->node_mask = node_mask;
+}
+
+// Sort the runs by global ID; the map is only used if no two runs overlap
+// (tables from compilers that leave global_id zero fail this check)
+static void neuron_map_finish(void) {
+    z1_neuron_run_t* runs = g_neuron_map.runs;
+    
+    // Tables usually arrive in ID order: insertion sort is close to linear
+    for (uint16_t i = 1; i < g_neuron_map.run_count; i++) {
+        z1_neuron_run_t run = runs[i];
+        uint16_t j = i;
+        while (j > 0 && runs[j - 1].global_first > run.global_first) {
+            runs[j] = runs[j - 1];
+            j--;
+        }
+        runs[j] = run;
+    }
+    
+    for (uint16_t i = 1; i < g_neuron_map.run_count; i++) {
+        if (runs[i - 1].global_first + runs[i - 1].count > runs[i].global_first) {
+            g_neuron_map.overflow = true;
+        }
+    }
+    
+    g_neuron_map.valid = !g_neuron_map.overflow;
+    printf("[API] Neuron map: %u runs%s\n", g_neuron_map.run_count,
+           g_neuron_map.valid ? "" : " (unusable, injecting by local ID)");
+}
+
+// Owner nodes and local ID of a global neuron ID; false if no table holds it
+static bool neuron_map_lookup(uint32_t global_id, uint16_t* node_mask, uint16_t* local_id) {
+    uint16_t lo = 0;
+    uint16_t hi = g_neuron_map.run_count;
+    
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        const z1_neuron_run_t* run = &g_neuron_map.runs[mid];
+        if (global_id < run->global_first) {
+            hi = mid;
+        } else if (global_id >= run->global_first + run->count) {
+            lo = mid + 1;
+        } else {
+            *node_mask = run->node_mask;
+            *local_id = run->local_first + (uint16_t)(global_id - run->global_first);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Global ID of a node's local neuron (linear in the number of runs)
+ */
+bool z1_snn_neuron_global_id(uint8_t node, uint16_t local_id, uint32_t* global_id) {
+    if (!g_neuron_map.valid) {
+        return false;
+    }
+    
+    for (uint16_t i = 0; i < g_neuron_map.run_count; i++) {
+        const z1_neuron_run_t* run = &g_neuron_map.runs[i];
+        if ((run->node_mask & (1u << node)) && local_id >= run->local_first &&
+            local_id - run->local_first < run->count) {
+            *global_id = run->global_first + (local_id - run->local_first);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// SNN Deployment Endpoints (Complete Implementation)
+// ============================================================================
+
+// Deploy body, parsed as it streams in:
+// [0-3]   uint32_t total_neurons
+// [4]     uint8_t node_count (entries)
+// [5-68]  char[64] network_name
+// [69+]   node_count entries:
+//   [0]     uint8_t node_id (Z1_DEPLOY_SHARED: one table for several nodes)
+//   [1-2]   uint16_t data_length (Z1_DEPLOY_LENGTH32: uint32_t length follows)
+//   [..]    Z1_DEPLOY_SHARED only: uint16_t node_mask
+//   [..]    Z1_DEPLOY_LENGTH32 only: uint32_t data_length
+//   [..]    neuron table data
+//
+// Tables go out in Z1_MEM_HASH_CHUNK pieces. Before a table, each target
+// node reports the hashes of what its staging region already holds; a
+// piece is only sent to the nodes whose hash differs, as one multicast
+// when there are several. Multicast receivers are verified afterwards,
+// since the bus cannot confirm every one of them took the transfer.
+
+typedef enum {
+    DEPLOY_HEADER = 0,
+    DEPLOY_ENTRY,
+    DEPLOY_ENTRY_MASK,
+    DEPLOY_ENTRY_LENGTH32,
+    DEPLOY_TABLE,
+    DEPLOY_DONE,
+    DEPLOY_FAILED
+} deploy_phase_t;
+
+typedef enum {
+    DEPLOY_NODE_IDLE = 0,
+    DEPLOY_NODE_SENDING,
+    DEPLOY_NODE_LOADED,
+    DEPLOY_NODE_FAILED
+} deploy_node_state_t;
+
+static const char* const g_deploy_node_states[] = { "pending", "sending", "loaded", "failed" };
+
+// Per-node progress, kept after the deploy for GET /api/snn/deploy
+typedef struct {
+    deploy_node_state_t state;
+    uint32_t table_bytes;
+    uint32_t done_bytes;            // Table bytes compared or sent so far
+    uint32_t sent_bytes;            // Table bytes that went over the bus
+    uint16_t skipped_chunks;        // Chunks the node already held
+    uint16_t failed_chunks;         // Multicast chunks that did not verify
+} z1_deploy_node_progress_t;
+
+typedef struct {
+    bool active;
+    deploy_phase_t phase;
+    uint16_t error_status;
+    const char* error;
+    uint32_t started_ms;
+    uint32_t elapsed_ms;
+    
+    // Header and entry fields gathered across writes
+    uint8_t field[Z1_DEPLOY_HEADER_SIZE];
+    uint8_t field_length;
+    
+    uint32_t total_neurons;
+    uint8_t node_count;
+    uint8_t nodes_done;
+    
+    // Table being forwarded
+    uint16_t targets;               // Nodes receiving it
+    uint16_t multicast_mask;        // Targets that got chunks by multicast
+    uint16_t failed_mask;           // Targets whose table did not arrive
+    uint16_t data_length;
+    uint32_t table_length;
+    uint32_t table_offset;
+    uint16_t neuron_count;
+    uint16_t table_targets;         // Targets at the start of the table (neuron map)
+    uint32_t map_base;              // First entry: 0 (v1) or after the v2 header
+    uint16_t map_stride;            // Entry size: 256 (v1) or 40 (v2)
+    uint16_t map_index;             // Next entry whose global_id is collected
+    uint8_t map_field[4];           // global_id split across two chunks
+    uint8_t map_field_length;
+    uint8_t chunk[4 + Z1_MEM_HASH_CHUNK] __attribute__((aligned(4)));  // MEM_WRITE [addr:4][data]
+    uint16_t chunk_length;
+    
+    // Chunk hashes: held by each target before the table, and of the new table
+    uint32_t node_hashes[Z1_MAX_NODES][Z1_MEM_HASH_MAX];
+    uint16_t node_hash_count[Z1_MAX_NODES];
+    uint32_t table_hashes[Z1_MEM_HASH_MAX];
+    
+    z1_deploy_node_progress_t nodes[Z1_MAX_NODES];
+} z1_deploy_stream_t;
+
+static z1_deploy_stream_t g_deploy;
+
+#define Z1_DEPLOY_TABLE_ADDR    0x20100000  // Z1_NEURON_TABLE_BASE_ADDR (node staging region)
+
+static bool deploy_fail(uint16_t status, const char* message) {
+    g_deploy.phase = DEPLOY_FAILED;
+    g_deploy.error_status = status;
+    g_deploy.error = message;
+    return false;
+}
+
+// Collect a fixed-size field; true once all of it is in g_deploy.field
+static bool deploy_gather(uint8_t size, const uint8_t** data, uint16_t* length) {
+    uint16_t n = size - g_deploy.field_length;
+    if (n > *length) n = *length;
+    
+    memcpy(g_deploy.field + g_deploy.field_length, *data, n);
+    g_deploy.field_length += n;
+    *data += n;
+    *length -= n;
+    
+    if (g_deploy.field_length < size) {
+        return false;
+    }
+    g_deploy.field_length = 0;
+    return true;
+}
+
+// Add the global IDs of the entries in this chunk to the neuron map
+static void deploy_map_chunk(const uint8_t* data, uint32_t start, uint16_t length) {
+    uint32_t end = start + length;
+    
+    while (g_deploy.map_index < g_deploy.neuron_count) {
+        uint32_t pos = g_deploy.map_base + (uint32_t)g_deploy.map_index * g_deploy.map_stride +
+                       Z1_NEURON_GLOBAL_ID_OFFSET + g_deploy.map_field_length;
+        if (pos >= end) {
+            return;
+        }
+        
+        uint32_t n = 4 - g_deploy.map_field_length;
+        if (n > end - pos) n = end - pos;
+        memcpy(g_deploy.map_field + g_deploy.map_field_length, data + (pos - start), n);
+        g_deploy.map_field_length += n;
+        if (g_deploy.map_field_length < 4) {
+            return;
+        }
+        g_deploy.map_field_length = 0;
+        
+        uint32_t global_id;
+        memcpy(&global_id, g_deploy.map_field, 4);
+        neuron_map_add(global_id, g_deploy.map_index, g_deploy.table_targets);
+        g_deploy.map_index++;
+    }
+}
+
+// Write one chunk to the targets that do not hold it yet
+static bool deploy_flush_chunk(void) {
+    if (g_deploy.chunk_length == 0) {
+        return true;
+    }
+    
+    uint32_t start = g_deploy.table_offset - g_deploy.chunk_length;
+    uint32_t index = start / Z1_MEM_HASH_CHUNK;
+    const uint8_t* table_data = g_deploy.chunk + 4;
+    uint32_t psram_addr = Z1_DEPLOY_TABLE_ADDR + start;
+    memcpy(g_deploy.chunk, &psram_addr, 4);
+    
+    // v2 (CSR) tables carry their neuron count in the header ("Z1N", version,
+    // count); v1 tables are 256 bytes per neuron
+    if (start == 0 && g_deploy.chunk_length >= 16 && memcmp(table_data, "Z1N", 3) == 0) {
+        memcpy(&g_deploy.neuron_count, table_data + 4, 2);
+        g_deploy.map_base = 16;     // sizeof(z1_neuron_table_header_t)
+        g_deploy.map_stride = 40;
+    }
+    deploy_map_chunk(table_data, start, g_deploy.chunk_length);
+    
+    // Chunks past the hash window are always sent, one node at a time
+    bool hashed = index < Z1_MEM_HASH_MAX;
+    uint32_t hash = z1_hash32(table_data, g_deploy.chunk_length);
+    if (hashed) {
+        g_deploy.table_hashes[index] = hash;
+    }
+    
+    uint16_t dest = 0;
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(g_deploy.targets & (1u << node))) {
+            continue;
+        }
+        z1_deploy_node_progress_t* progress = &g_deploy.nodes[node];
+        progress->done_bytes += g_deploy.chunk_length;
+        
+        if (hashed && index < g_deploy.node_hash_count[node] &&
+            g_deploy.node_hashes[node][index] == hash) {
+            progress->skipped_chunks++;
+        } else {
+            progress->sent_bytes += g_deploy.chunk_length;
+            dest |= 1u << node;
+        }
+    }
+    
+    uint16_t payload_length = 4 + g_deploy.chunk_length;
+    g_deploy.chunk_length = 0;
+    
+    if (hashed && __builtin_popcount(dest) > 1 &&
+        z1_send_multicast(dest, Z1_CMD_MEMORY_WRITE, g_deploy.chunk, payload_length)) {
+        g_deploy.multicast_mask |= dest;
+        return true;
+    }
+    
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if ((dest & (1u << node)) &&
+            !z1_bus_send_command(node, Z1_CMD_MEMORY_WRITE, g_deploy.chunk, payload_length)) {
+            printf("[API] ❌ Node %u: table write failed at offset %lu\n", node, (unsigned long)start);
+            g_deploy.failed_mask |= 1u << node;
+            g_deploy.targets &= ~(1u << node);
+            g_deploy.nodes[node].state = DEPLOY_NODE_FAILED;
+        }
+    }
+    return true;
+}
+
+static void deploy_begin_table(void) {
+    g_deploy.table_offset = 0;
+    g_deploy.chunk_length = 0;
+    g_deploy.multicast_mask = 0;
+    g_deploy.neuron_count = g_deploy.table_length / 256;
+    g_deploy.table_targets = g_deploy.targets;
+    g_deploy.map_base = 0;
+    g_deploy.map_stride = 256;
+    g_deploy.map_index = 0;
+    g_deploy.map_field_length = 0;
+    g_deploy.phase = DEPLOY_TABLE;
+    
+    printf("[API] Deploying %lu-byte table to nodes 0x%04X\n",
+           (unsigned long)g_deploy.table_length, g_deploy.targets);
+    
+    // What each target already holds (no answer: everything is sent)
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(g_deploy.targets & (1u << node))) {
+            continue;
+        }
+        z1_deploy_node_progress_t* progress = &g_deploy.nodes[node];
+        memset(progress, 0, sizeof(*progress));
+        progress->state = DEPLOY_NODE_SENDING;
+        progress->table_bytes = g_deploy.table_length;
+        
+        int count = (g_deploy.table_length > 0) ?
+            z1_query_mem_hashes(node, Z1_DEPLOY_TABLE_ADDR, g_deploy.table_length,
+                                g_deploy.node_hashes[node], Z1_MEM_HASH_MAX) : 0;
+        g_deploy.node_hash_count[node] = (count > 0) ? count : 0;
+    }
+}
+
+// Compare multicast receivers against the new table; all or nothing per node
+static void deploy_verify_table(void) {
+    uint32_t chunks = (g_deploy.table_length + Z1_MEM_HASH_CHUNK - 1) / Z1_MEM_HASH_CHUNK;
+    if (chunks > Z1_MEM_HASH_MAX) chunks = Z1_MEM_HASH_MAX;
+    
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        uint16_t bit = 1u << node;
+        if (!(g_deploy.multicast_mask & g_deploy.targets & bit)) {
+            continue;
+        }
+        
+        int count = z1_query_mem_hashes(node, Z1_DEPLOY_TABLE_ADDR, g_deploy.table_length,
+                                        g_deploy.node_hashes[node], Z1_MEM_HASH_MAX);
+        uint16_t failed = 0;
+        for (uint32_t c = 0; c < chunks; c++) {
+            if ((int)c >= count || g_deploy.node_hashes[node][c] != g_deploy.table_hashes[c]) {
+                failed++;
+            }
+        }
+        
+        if (failed > 0) {
+            printf("[API] ❌ Node %u: %u chunks did not verify\n", node, failed);
+            g_deploy.nodes[node].failed_chunks = failed;
+            g_deploy.nodes[node].state = DEPLOY_NODE_FAILED;
+            g_deploy.failed_mask |= bit;
+            g_deploy.targets &= ~bit;
+        }
+    }
+}
+
+static void deploy_end_table(void) {
+    deploy_verify_table();
+    
+    // Send load command to each node with neuron count
+    uint8_t load_cmd_data[2];
+    memcpy(load_cmd_data, &g_deploy.neuron_count, 2);
+    
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(g_deploy.targets & (1u << node))) {
+            continue;
+        }
+        z1_bus_send_command(node, Z1_CMD_SNN_LOAD_TABLE, load_cmd_data, 2);
+        
+        z1_deploy_node_progress_t* progress = &g_deploy.nodes[node];
+        progress->state = DEPLOY_NODE_LOADED;
+        printf("[API] Sent SNN_LOAD_TABLE to node %u: %u neurons (%lu of %lu bytes sent)\n",
+               node, g_deploy.neuron_count, (unsigned long)progress->sent_bytes,
+               (unsigned long)progress->table_bytes);
+        g_snn_node_mask |= 1u << node;
+    }
+    
+    g_deploy.nodes_done++;
+    g_deploy.phase = (g_deploy.nodes_done < g_deploy.node_count) ? DEPLOY_ENTRY : DEPLOY_DONE;
+}
+
+// Entry fields are in (node_id, lengths, node mask): start its table
+static bool deploy_start_entry(void) {
+    if (g_deploy.targets == 0) {
+        return deploy_fail(400, "Invalid node ID");
+    }
+    deploy_begin_table();
+    return true;
+}
+
+static bool deploy_parse_entry(void) {
+    uint8_t node_id = g_deploy.field[0];
+    memcpy(&g_deploy.data_length, g_deploy.field + 1, 2);
+    
+    if (node_id == Z1_DEPLOY_SHARED) {
+        g_deploy.phase = DEPLOY_ENTRY_MASK;
+        return true;
+    }
+    g_deploy.targets = (node_id < Z1_MAX_NODES) ? (1u << node_id) : 0;
+    
+    if (g_deploy.data_length == Z1_DEPLOY_LENGTH32) {
+        g_deploy.phase = DEPLOY_ENTRY_LENGTH32;
+        return true;
+    }
+    g_deploy.table_length = g_deploy.data_length;
+    return deploy_start_entry();
+}
+
+static bool deploy_parse_header(void) {
+    memcpy(&g_deploy.total_neurons, g_deploy.field, 4);
+    g_deploy.node_count = g_deploy.field[4];
+    memcpy(g_snn_network_name, g_deploy.field + 5, 64);
+    g_snn_network_name[63] = '\0';
+    
+    if (g_deploy.node_count > 16) {
+        return deploy_fail(400, "Too many nodes");
+    }
+    
+    printf("[API] Deploying SNN '%s': %lu neurons, %u table entries\n",
+           g_snn_network_name, (unsigned long)g_deploy.total_neurons, g_deploy.node_count);
+    
+    // Update display
+    z1_display_snn_deploy(g_deploy.total_neurons, g_deploy.node_count);
+    g_snn_node_mask = 0;
+    neuron_map_reset();
+    
+    g_deploy.phase = (g_deploy.node_count > 0) ? DEPLOY_ENTRY : DEPLOY_DONE;
+    return true;
+}
+
+static bool deploy_begin(http_connection_t* conn, uint32_t content_length) {
+    if (g_deploy.active) {
+        z1_http_send_error(conn, 503, "Deployment already in progress");
+        return false;
+    }
+    
+    memset(&g_deploy, 0, sizeof(g_deploy));
+    g_deploy.active = true;
+    g_deploy.started_ms = to_ms_since_boot(get_absolute_time());
+    return true;
+}
+
+static bool deploy_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    while (length > 0) {
+        switch (g_deploy.phase) {
+            case DEPLOY_HEADER:
+                if (deploy_gather(Z1_DEPLOY_HEADER_SIZE, &data, &length) && !deploy_parse_header()) {
+                    return false;
+                }
+                break;
+                
+            case DEPLOY_ENTRY:
+                if (deploy_gather(Z1_DEPLOY_ENTRY_SIZE, &data, &length) && !deploy_parse_entry()) {
+                    return false;
+                }
+                break;
+                
+            case DEPLOY_ENTRY_MASK:
+                if (deploy_gather(2, &data, &length)) {
+                    memcpy(&g_deploy.targets, g_deploy.field, 2);
+                    if (g_deploy.data_length == Z1_DEPLOY_LENGTH32) {
+                        g_deploy.phase = DEPLOY_ENTRY_LENGTH32;
+                    } else {
+                        g_deploy.table_length = g_deploy.data_length;
+                        if (!deploy_start_entry()) {
+                            return false;
+                        }
+                    }
+                }
+                break;
+                
+            case DEPLOY_ENTRY_LENGTH32:
+                if (deploy_gather(4, &data, &length)) {
+                    memcpy(&g_deploy.table_length, g_deploy.field, 4);
+                    if (!deploy_start_entry()) {
+                        return false;
+                    }
+                }
+                break;
+                
+            case DEPLOY_TABLE: {
+                uint32_t left = g_deploy.table_length - g_deploy.table_offset;
+                uint16_t n = Z1_MEM_HASH_CHUNK - g_deploy.chunk_length;
+                if (n > left) n = left;
+                if (n > length) n = length;
+                
+                memcpy(g_deploy.chunk + 4 + g_deploy.chunk_length, data, n);
+                g_deploy.chunk_length += n;
+                g_deploy.table_offset += n;
+                data += n;
+                length -= n;
+                
+                bool table_done = (g_deploy.table_offset == g_deploy.table_length);
+                if ((g_deploy.chunk_length == Z1_MEM_HASH_CHUNK || table_done) &&
+                    !deploy_flush_chunk()) {
+                    return false;
+                }
+                break;
+            }
+                
+            case DEPLOY_DONE:
+                // Trailing bytes after the last table are ignored
+                return true;
+                
+            case DEPLOY_FAILED:
+                return false;
+        }
+        
+        // Zero-length tables complete without data
+        if (g_deploy.phase == DEPLOY_TABLE && g_deploy.table_offset == g_deploy.table_length) {
+            deploy_end_table();
+        }
+    }
+    
+    return true;
+}
+
+static void deploy_end(http_connection_t* conn, bool complete) {
+    g_deploy.active = false;
+    g_deploy.elapsed_ms = to_ms_since_boot(get_absolute_time()) - g_deploy.started_ms;
+    
+    switch (g_deploy.phase) {
+        case DEPLOY_DONE:
+            break;
+        case DEPLOY_FAILED:
+            z1_http_send_error(conn, g_deploy.error_status, g_deploy.error);
+            return;
+        case DEPLOY_HEADER:
+            z1_http_send_error(conn, 400, "Invalid deployment data");
+            return;
+        case DEPLOY_TABLE:
+            z1_http_send_error(conn, 400, "Incomplete neuron table data");
+            return;
+        default:
+            z1_http_send_error(conn, 400, "Incomplete node data");
+            return;
+    }
+    
+    if (g_deploy.failed_mask) {
+        // Redeploying resends only the chunks these nodes are missing
+        z1_http_send_error(conn, 500, "Failed to write to node PSRAM");
+        return;
+    }
+    
+    g_snn_deployed = true;
+    g_snn_neuron_count = g_deploy.total_neurons;
+    g_snn_nodes_used = __builtin_popcount(g_snn_node_mask);
+    neuron_map_finish();
+    
+    uint32_t sent_bytes = 0;
+    uint32_t skipped_chunks = 0;
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        sent_bytes += g_deploy.nodes[node].sent_bytes;
+        skipped_chunks += g_deploy.nodes[node].skipped_chunks;
+    }
+    
+    // Send success response
+    char json[256];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "status", "deployed", false);
+    pos = json_add_string(json, pos, sizeof(json), "network_name", g_snn_network_name, false);
+    pos = json_add_int(json, pos, sizeof(json), "neuron_count", g_snn_neuron_count, false);
+    pos = json_add_int(json, pos, sizeof(json), "nodes_used", g_snn_nodes_used, false);
+    pos = json_add_int(json, pos, sizeof(json), "sent_bytes", sent_bytes, false);
+    pos = json_add_int(json, pos, sizeof(json), "skipped_chunks", skipped_chunks, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", g_deploy.elapsed_ms, true);
+    json_end_object(json, pos, sizeof(json));
+    
+    z1_http_send_json(conn, 200, json);
+    
+    printf("[API] SNN deployment complete (%lu bytes sent, %lu chunks unchanged)\n",
+           (unsigned long)sent_bytes, (unsigned long)skipped_chunks);
+    
+    // Update display
+    z1_display_status("Deploy complete");
+}
+
+const z1_http_body_sink_t g_snn_deploy_sink = {
+    .begin = deploy_begin,
+    .write = deploy_write,
+    .end = deploy_end,
+};
+
+/**
+ * Handle deployment progress - GET /api/snn/deploy
+ * Per-node progress of the running (or last) deployment
+ */
+void handle_get_snn_deploy_status(http_connection_t* conn) {
+    char json[Z1_HTTP_BUFFER_SIZE];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_bool(json, pos, sizeof(json), "active", g_deploy.active, false);
+    pos = json_add_int(json, pos, sizeof(json), "entries_done", g_deploy.nodes_done, false);
+    pos = json_add_int(json, pos, sizeof(json), "entries", g_deploy.node_count, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", g_deploy.active ?
+                       to_ms_since_boot(get_absolute_time()) - g_deploy.started_ms :
+                       g_deploy.elapsed_ms, false);
+    pos = json_begin_array(json, pos, sizeof(json), "nodes");
+    
+    bool first = true;
+    for (uint8_t node = 0; node < Z1_MAX_NODES && pos >= 0; node++) {
+        const z1_deploy_node_progress_t* progress = &g_deploy.nodes[node];
+        if (progress->state == DEPLOY_NODE_IDLE) {
+            continue;
+        }
+        int written = snprintf(json + pos, sizeof(json) - pos,
+                               "%s{\"id\":%u,\"state\":\"%s\",\"table_bytes\":%lu,"
+                               "\"done_bytes\":%lu,\"sent_bytes\":%lu,"
+                               "\"skipped_chunks\":%u,\"failed_chunks\":%u}",
+                               first ? "" : ",", node, g_deploy_node_states[progress->state],
+                               (unsigned long)progress->table_bytes,
+                               (unsigned long)progress->done_bytes,
+                               (unsigned long)progress->sent_bytes,
+                               progress->skipped_chunks, progress->failed_chunks);
+        pos = (written < 0 || pos + written >= (int)sizeof(json)) ? -1 : pos + written;
+        first = false;
+    }
+    
+    if (pos >= 0) {
+        pos = json_end_array(json, pos, sizeof(json), true);
+    }
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+/**
+ * Handle SNN deployment - POST /api/snn/deploy
+ * Deploys a body that is already in memory through the streaming parser
+ */
+void handle_post_snn_deploy(http_connection_t* conn, const char* body, uint16_t body_length) {
+    if (!deploy_begin(conn, body_length)) {
+        return;
+    }
+    deploy_write(conn, (const uint8_t*)body, body_length);
+    deploy_end(conn, true);
+}
+
+// ============================================================================
+// SNN Weight Patch Endpoint
+// ============================================================================
+
+// Weight patch body, parsed as it streams in: records back to back
+// [0]     uint8_t format (Z1_WEIGHT_PATCH_LIST or Z1_WEIGHT_PATCH_VECTOR)
+// [1]     uint8_t node_id
+// [2-3]   uint16_t count
+// LIST:   count entries [neuron:2][synapse:1][weight:1]
+// VECTOR: [neuron:2][first_synapse:2], then count weights
+//
+// Records for the same node are packed into Z1_WEIGHT_PATCH_MAX payloads
+// (long records are split) and applied with one bus request each.
+
+typedef enum {
+    WEIGHTS_HEADER = 0,
+    WEIGHTS_VECTOR,
+    WEIGHTS_ENTRIES,
+    WEIGHTS_FAILED
+} weights_phase_t;
+
+#define Z1_WEIGHTS_NO_RECORD    0xFFFF  // record_offset: next item opens a record
+
+typedef struct {
+    bool active;
+    weights_phase_t phase;
+    uint16_t error_status;
+    const char* error;
+    uint32_t started_ms;
+    
+    uint8_t field[sizeof(z1_weight_patch_header_t)];
+    uint8_t field_length;
+    
+    // Record being parsed
+    z1_weight_patch_header_t record;
+    z1_weight_vector_t vector;      // Next synapse of a VECTOR record
+    uint16_t left;                  // Items not yet parsed
+    
+    // Payload being assembled for payload_node
+    uint8_t payload[Z1_WEIGHT_PATCH_MAX];
+    uint16_t payload_length;
+    uint16_t record_offset;         // Header of the open record in payload
+    uint8_t payload_node;
+    
+    uint32_t applied;
+    uint32_t rejected;
+    uint16_t requests;
+    uint16_t failed_mask;           // Nodes that did not answer
+} z1_weights_stream_t;
+
+static z1_weights_stream_t g_weights;
+
+static bool weights_fail(uint16_t status, const char* message) {
+    g_weights.phase = WEIGHTS_FAILED;
+    g_weights.error_status = status;
+    g_weights.error = message;
+    return false;
+}
+
+// Collect a fixed-size field; true once all of it is in g_weights.field
+static bool weights_gather(uint8_t size, const uint8_t** data, uint16_t* length) {
+    uint16_t n = size - g_weights.field_length;
+    if (n > *length) n = *length;
+    
+    memcpy(g_weights.field + g_weights.field_length, *data, n);
+    g_weights.field_length += n;
+    *data += n;
+    *length -= n;
+    
+    if (g_weights.field_length < size) {
+        return false;
+    }
+    g_weights.field_length = 0;
+    return true;
+}
+
+// Send the assembled payload to its node
+static void weights_flush(void) {
+    if (g_weights.payload_length == 0) {
+        return;
+    }
+    
+    uint8_t node = g_weights.payload_node;
+    z1_weight_patch_result_t result;
+    if (z1_patch_weights(node, g_weights.payload, g_weights.payload_length, &result)) {
+        g_weights.applied += result.applied;
+        g_weights.rejected += result.rejected;
+    } else {
+        printf("[API] ❌ Node %u: weight patch not acknowledged\n", node);
+        g_weights.failed_mask |= 1u << node;
+    }
+    
+    g_weights.requests++;
+    g_weights.payload_length = 0;
+    g_weights.record_offset = Z1_WEIGHTS_NO_RECORD;
+}
+
+// Items of item_size that fit in the payload, opening a record if needed (at least 1)
+static uint16_t weights_room(uint16_t item_size) {
+    uint16_t header_size = sizeof(z1_weight_patch_header_t) +
+        (g_weights.record.format == Z1_WEIGHT_PATCH_VECTOR ? sizeof(z1_weight_vector_t) : 0);
+    
+    if (g_weights.record_offset == Z1_WEIGHTS_NO_RECORD ||
+        g_weights.payload_length + item_size > Z1_WEIGHT_PATCH_MAX) {
+        if (g_weights.payload_length > 0 &&
+            (g_weights.payload_node != g_weights.record.node_id ||
+             g_weights.payload_length + header_size + item_size > Z1_WEIGHT_PATCH_MAX)) {
+            weights_flush();
+        }
+        
+        // Split records continue where the previous part stopped
+        z1_weight_patch_header_t header = g_weights.record;
+        header.count = 0;
+        g_weights.payload_node = header.node_id;
+        g_weights.record_offset = g_weights.payload_length;
+        memcpy(g_weights.payload + g_weights.payload_length, &header, sizeof(header));
+        if (header.format == Z1_WEIGHT_PATCH_VECTOR) {
+            memcpy(g_weights.payload + g_weights.payload_length + sizeof(header),
+                   &g_weights.vector, sizeof(g_weights.vector));
+        }
+        g_weights.payload_length += header_size;
+    }
+    
+    return (Z1_WEIGHT_PATCH_MAX - g_weights.payload_length) / item_size;
+}
+
+// Add items to the open record
+static void weights_append(const uint8_t* items, uint16_t count, uint16_t item_size) {
+    z1_weight_patch_header_t header;
+    uint8_t* record = g_weights.payload + g_weights.record_offset;
+    
+    memcpy(g_weights.payload + g_weights.payload_length, items, count * item_size);
+    g_weights.payload_length += count * item_size;
+    
+    memcpy(&header, record, sizeof(header));
+    header.count += count;
+    memcpy(record, &header, sizeof(header));
+    
+    g_weights.vector.first_synapse += count;
+    g_weights.left -= count;
+    if (g_weights.left == 0) {
+        g_weights.phase = WEIGHTS_HEADER;
+    }
+}
+
+static bool weights_parse_header(void) {
+    memcpy(&g_weights.record, g_weights.field, sizeof(g_weights.record));
+    
+    if (g_weights.record.format != Z1_WEIGHT_PATCH_LIST &&
+        g_weights.record.format != Z1_WEIGHT_PATCH_VECTOR) {
+        return weights_fail(400, "Invalid weight patch format");
+    }
+    if (g_weights.record.node_id >= Z1_MAX_NODES) {
+        return weights_fail(400, "Invalid node ID");
+    }
+    
+    g_weights.left = g_weights.record.count;
+    g_weights.record_offset = Z1_WEIGHTS_NO_RECORD;
+    if (g_weights.record.format == Z1_WEIGHT_PATCH_VECTOR) {
+        g_weights.phase = WEIGHTS_VECTOR;
+    } else {
+        g_weights.phase = (g_weights.left > 0) ? WEIGHTS_ENTRIES : WEIGHTS_HEADER;
+    }
+    return true;
+}
+
+static bool weights_begin(http_connection_t* conn, uint32_t content_length) {
+    if (g_weights.active) {
+        z1_http_send_error(conn, 503, "Weight patch already in progress");
+        return false;
+    }
+    if (!g_snn_deployed) {
+        z1_http_send_error(conn, 400, "No SNN deployed");
+        return false;
+    }
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN before patching weights");
+        return false;
+    }
+    
+    memset(&g_weights, 0, sizeof(g_weights));
+    g_weights.active = true;
+    g_weights.record_offset = Z1_WEIGHTS_NO_RECORD;
+    g_weights.started_ms = to_ms_since_boot(get_absolute_time());
+    return true;
+}
+
+static bool weights_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    while (length > 0) {
+        switch (g_weights.phase) {
+            case WEIGHTS_HEADER:
+                if (weights_gather(sizeof(z1_weight_patch_header_t), &data, &length) &&
+                    !weights_parse_header()) {
+                    return false;
+                }
+                break;
+                
+            case WEIGHTS_VECTOR:
+                if (weights_gather(sizeof(z1_weight_vector_t), &data, &length)) {
+                    memcpy(&g_weights.vector, g_weights.field, sizeof(g_weights.vector));
+                    g_weights.phase = (g_weights.left > 0) ? WEIGHTS_ENTRIES : WEIGHTS_HEADER;
+                }
+                break;
+                
+            case WEIGHTS_ENTRIES:
+                if (g_weights.record.format == Z1_WEIGHT_PATCH_LIST) {
+                    if (weights_gather(sizeof(z1_weight_update_t), &data, &length)) {
+                        weights_room(sizeof(z1_weight_update_t));
+                        weights_append(g_weights.field, 1, sizeof(z1_weight_update_t));
+                    }
+                } else {
+                    // Weights are copied straight from the body
+                    uint16_t n = weights_room(1);
+                    if (n > g_weights.left) n = g_weights.left;
+                    if (n > length) n = length;
+                    weights_append(data, n, 1);
+                    data += n;
+                    length -= n;
+                }
+                break;
+                
+            case WEIGHTS_FAILED:
+                return false;
+        }
+    }
+    
+    return true;
+}
+
+static void weights_end(http_connection_t* conn, bool complete) {
+    g_weights.active = false;
+    
+    if (g_weights.phase == WEIGHTS_FAILED) {
+        z1_http_send_error(conn, g_weights.error_status, g_weights.error);
+        return;
+    }
+    if (!complete || g_weights.phase != WEIGHTS_HEADER || g_weights.field_length > 0) {
+        // Payloads already sent stay applied
+        z1_http_send_error(conn, 400, "Incomplete weight patch data");
+        return;
+    }
+    
+    weights_flush();
+    uint32_t elapsed_ms = to_ms_since_boot(get_absolute_time()) - g_weights.started_ms;
+    
+    if (g_weights.failed_mask) {
+        z1_http_send_error(conn, 500, "Failed to patch node weights");
+        return;
+    }
+    
+    char json[192];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "status", "patched", false);
+    pos = json_add_int(json, pos, sizeof(json), "applied", g_weights.applied, false);
+    pos = json_add_int(json, pos, sizeof(json), "rejected", g_weights.rejected, false);
+    pos = json_add_int(json, pos, sizeof(json), "requests", g_weights.requests, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", elapsed_ms, true);
+    json_end_object(json, pos, sizeof(json));
+    
+    z1_http_send_json(conn, 200, json);
+    
+    printf("[API] Weight patch: %lu applied, %lu rejected in %u requests\n",
+           (unsigned long)g_weights.applied, (unsigned long)g_weights.rejected, g_weights.requests);
+}
+
+const z1_http_body_sink_t g_snn_weights_sink = {
+    .begin = weights_begin,
+    .write = weights_write,
+    .end = weights_end,
+};
+
+/**
+ * Handle synapse weight patch - POST /api/snn/weights
+ * Patches a body that is already in memory through the streaming parser
+ */
+void handle_post_snn_weights(http_connection_t* conn, const char* body, uint16_t body_length) {
+    if (!weights_begin(conn, body_length)) {
+        return;
+    }
+    weights_write(conn, (const uint8_t*)body, body_length);
+    weights_end(conn, true);
+}
+
+// ============================================================================
+// SNN Input Endpoint
+// ============================================================================
+
+// Input body, parsed as it streams in:
+// [0-1]   uint16_t spike_count
+// [2+]    spike_count entries [neuron_id:2][value:f32], neuron_id global
+//
+// Each spike is looked up in the neuron map and queued for the node that
+// owns it as a z1_input_spike_t; a node gets one Z1_CMD_SNN_INPUT_SPIKE
+// packet per Z1_INPUT_BATCH_MAX spikes. Without a usable map the IDs are
+// taken as local IDs and queued for every node of the network. The UDP
+// spike channel queues through the same batches.
+
+#define Z1_INPUT_ENTRY_SIZE     6
+
+// Batches being assembled, one per node
+typedef struct {
+    z1_input_spike_t spikes[Z1_MAX_NODES][Z1_INPUT_BATCH_MAX];
+    uint16_t count[Z1_MAX_NODES];
+    uint32_t packets;
+    uint16_t failed_mask;           // Nodes a packet could not be sent to
+} z1_input_batches_t;
+
+static z1_input_batches_t g_input_batches;
+
+// Send a node's batch as one packet
+static void input_flush_node(uint8_t node) {
+    uint16_t count = g_input_batches.count[node];
+    if (count == 0) {
+        return;
+    }
+    
+    if (!z1_bus_send_command(node, Z1_CMD_SNN_INPUT_SPIKE,
+                             (const uint8_t*)g_input_batches.spikes[node],
+                             count * sizeof(z1_input_spike_t))) {
+        printf("[API] ❌ Node %u: input packet not sent\n", node);
+        g_input_batches.failed_mask |= 1u << node;
+    }
+    g_input_batches.packets++;
+    g_input_batches.count[node] = 0;
+}
+
+/**
+ * Queue an input spike for the nodes owning a global neuron ID
+ */
+bool z1_snn_input_queue(uint16_t neuron_id, int16_t value) {
+    uint16_t node_mask = g_snn_node_mask;
+    uint16_t local_id = neuron_id;
+    if (g_neuron_map.valid && !neuron_map_lookup(neuron_id, &node_mask, &local_id)) {
+        return false;
+    }
+    
+    z1_input_spike_t spike = { .local_id = local_id, .value = value };
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(node_mask & (1u << node))) {
+            continue;
+        }
+        g_input_batches.spikes[node][g_input_batches.count[node]++] = spike;
+        if (g_input_batches.count[node] == Z1_INPUT_BATCH_MAX) {
+            input_flush_node(node);
+        }
+    }
+    return true;
+}
+
+/**
+ * Send every queued input spike
+ */
+void z1_snn_input_flush(void) {
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        input_flush_node(node);
+    }
+}
+
+typedef enum {
+    INPUT_COUNT = 0,
+    INPUT_ENTRIES,
+    INPUT_DONE,
+    INPUT_FAILED
+} input_phase_t;
+
+typedef struct {
+    bool active;
+    input_phase_t phase;
+    uint32_t started_ms;
+    
+    uint8_t field[Z1_INPUT_ENTRY_SIZE];
+    uint8_t field_length;
+    uint16_t left;                  // Entries not yet parsed
+    
+    uint32_t injected;
+    uint32_t unmapped;              // Global IDs no deployed table holds
+    uint32_t first_packet;          // g_input_batches.packets at the start
+} z1_input_stream_t;
+
+static z1_input_stream_t g_input;
+
+// Collect a fixed-size field; true once all of it is in g_input.field
+static bool input_gather(uint8_t size, const uint8_t** data, uint16_t* length) {
+    uint16_t n = size - g_input.field_length;
+    if (n > *length) n = *length;
+    
+    memcpy(g_input.field + g_input.field_length, *data, n);
+    g_input.field_length += n;
+    *data += n;
+    *length -= n;
+    
+    if (g_input.field_length < size) {
+        return false;
+    }
+    g_input.field_length = 0;
+    return true;
+}
+
+// Queue one body entry for its owner nodes
+static void input_add(void) {
+    uint16_t neuron_id;
+    float value;
+    memcpy(&neuron_id, g_input.field, 2);
+    memcpy(&value, g_input.field + 2, 4);
+    
+    // Q8.8, saturated
+    float scaled = value * Z1_INPUT_VALUE_ONE;
+    if (scaled > INT16_MAX) scaled = INT16_MAX;
+    if (scaled < INT16_MIN) scaled = INT16_MIN;
+    
+    if (z1_snn_input_queue(neuron_id, (int16_t)(scaled + (scaled >= 0 ? 0.5f : -0.5f)))) {
+        g_input.injected++;
+    } else {
+        g_input.unmapped++;
+    }
+}
+
+static bool input_begin(http_connection_t* conn, uint32_t content_length) {
+    if (g_input.active) {
+        z1_http_send_error(conn, 503, "Spike injection already in progress");
+        return false;
+    }
+    if (!g_snn_running) {
+        z1_http_send_error(conn, 400, "SNN not running");
+        return false;
+    }
+    
+    g_input.active = true;
+    g_input.phase = INPUT_COUNT;
+    g_input.started_ms = to_ms_since_boot(get_absolute_time());
+    g_input.field_length = 0;
+    g_input.injected = 0;
+    g_input.unmapped = 0;
+    g_input.first_packet = g_input_batches.packets;
+    g_input_batches.failed_mask = 0;
+    return true;
+}
+
+static bool input_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    while (length > 0) {
+        switch (g_input.phase) {
+            case INPUT_COUNT:
+                if (input_gather(2, &data, &length)) {
+                    memcpy(&g_input.left, g_input.field, 2);
+                    g_input.phase = (g_input.left > 0) ? INPUT_ENTRIES : INPUT_DONE;
+                }
+                break;
+                
+            case INPUT_ENTRIES:
+                if (input_gather(Z1_INPUT_ENTRY_SIZE, &data, &length)) {
+                    input_add();
+                    if (--g_input.left == 0) {
+                        g_input.phase = INPUT_DONE;
+                    }
+                }
+                break;
+                
+            case INPUT_DONE:
+                // Trailing bytes after the last entry are ignored
+                return true;
+                
+            case INPUT_FAILED:
+                return false;
+        }
+    }
+    
+    return true;
+}
+
+static void input_end(http_connection_t* conn, bool complete) {
+    g_input.active = false;
+    
+    // Spikes parsed before a truncated body still go out
+    z1_snn_input_flush();
+    uint32_t packets = g_input_batches.packets - g_input.first_packet;
+    uint32_t elapsed_ms = to_ms_since_boot(get_absolute_time()) - g_input.started_ms;
+    
+    if (g_input.phase == INPUT_COUNT) {
+        z1_http_send_error(conn, 400, "Invalid spike data");
+        return;
+    }
+    if (!complete || g_input.phase != INPUT_DONE) {
+        z1_http_send_error(conn, 400, "Incomplete spike data");
+        return;
+    }
+    if (g_input_batches.failed_mask) {
+        z1_http_send_error(conn, 500, "Failed to send spikes to nodes");
+        return;
+    }
+    
+    // Update spike count
+    g_snn_spike_count += g_input.injected;
+    
+    // Update display
+    char status_msg[32];
+    snprintf(status_msg, sizeof(status_msg), "Injected %lu spikes", (unsigned long)g_input.injected);
+    z1_display_status(status_msg);
+    
+    // Send response
+    char json[160];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_int(json, pos, sizeof(json), "spikes_injected", g_input.injected, false);
+    pos = json_add_int(json, pos, sizeof(json), "unmapped", g_input.unmapped, false);
+    pos = json_add_int(json, pos, sizeof(json), "packets", packets, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", elapsed_ms, true);
+    json_end_object(json, pos, sizeof(json));
+    
+    z1_http_send_json(conn, 200, json);
+}
+
+const z1_http_body_sink_t g_snn_input_sink = {
+    .begin = input_begin,
+    .write = input_write,
+    .end = input_end,
+};
+
+/**
+ * Handle spike injection - POST /api/snn/input
+ * Injects a body that is already in memory through the streaming parser
+ */
+void handle_post_snn_inject(http_connection_t* conn, const char* body, uint16_t body_length) {
+    if (!input_begin(conn, body_length)) {
+        return;
+    }
+    input_write(conn, (const uint8_t*)body, body_length);
+    input_end(conn, true);
+}
+
+/**
+ * Handle get spike events - GET /api/snn/events
+ * Streams recorded spikes from all nodes, oldest first per node
+ *
+ * Records are consumed on the nodes, so polling streams the raster. Each
+ * node is read in batches of Z1_HTTP_EVENTS_BATCH until it is empty or
+ * count is reached. JSON by default; ?format=bin returns one block per
+ * batch: an 8-byte header [count:2][flags:1][reserved:1][pending:4]
+ * followed by 8-byte events [node:1][reserved:1][neuron:2][step:4]
+ * (little-endian).
+ */
+void handle_get_snn_events(http_connection_t* conn, uint16_t count, bool binary) {
+    static z1_spike_raster_t records[Z1_HTTP_EVENTS_BATCH];
+    
+    if (!g_snn_running) {
+        z1_http_send_error(conn, 400, "SNN not running");
+        return;
+    }
+    
+    if (count == 0 || count > Z1_HTTP_EVENTS_MAX) {
+        count = Z1_HTTP_EVENTS_MAX;
+    }
+    
+    z1_http_stream_t out;
+    if (!z1_http_stream_begin(&out, conn, 200,
+                              binary ? "application/octet-stream" : "application/json")) {
+        return;
+    }
+    if (!binary) {
+        z1_http_stream_printf(&out, "{\"events\":[");
+    }
+    
+    uint16_t total = 0;
+    uint32_t pending = 0;
+    bool overrun = false;
+    
+    // Ask each node only for what still fits, so no consumed record is dropped
+    for (uint8_t node = 0; node < g_snn_nodes_used && total < count && !out.failed; node++) {
+        uint32_t node_pending = 0;
+        
+        while (total < count && !out.failed) {
+            uint16_t want = count - total;
+            if (want > Z1_HTTP_EVENTS_BATCH) {
+                want = Z1_HTTP_EVENTS_BATCH;
+            }
+            
+            z1_spike_raster_header_t header;
+            int n = z1_query_snn_spikes(node, want, 0, &header, records);
+            if (n < 0) {
+                break;
+            }
+            
+            overrun |= (header.flags & Z1_SPIKE_RASTER_OVERRUN) != 0;
+            node_pending = header.pending;
+            
+            if (binary) {
+                uint8_t block_header[8];
+                uint16_t block_count = n;
+                memcpy(block_header, &block_count, 2);
+                block_header[2] = header.flags & Z1_SPIKE_RASTER_OVERRUN;
+                block_header[3] = 0;
+                memcpy(block_header + 4, &header.pending, 4);
+                z1_http_stream_write(&out, block_header, sizeof(block_header));
+            }
+            
+            for (int i = 0; i < n; i++) {
+                uint16_t neuron = z1_spike_raster_id(records[i]);
+                uint32_t step = z1_spike_raster_step(records[i], header.current_step);
+                
+                if (binary) {
+                    uint8_t entry[8] = { node, 0 };
+                    memcpy(entry + 2, &neuron, 2);
+                    memcpy(entry + 4, &step, 4);
+                    z1_http_stream_write(&out, entry, sizeof(entry));
+                } else {
+                    z1_http_stream_printf(&out, "%s{\"node\":%d,\"neuron\":%d,\"step\":%u}",
+                                          (total + i) ? "," : "", node, neuron,
+                                          (unsigned int)step);
+                }
+            }
+            total += n;
+            
+            // The node had no more than that
+            if (n < want || header.pending == 0) {
+                break;
+            }
+        }
+        pending += node_pending;
+    }
+    
+    if (!binary) {
+        z1_http_stream_printf(&out, "],\"count\":%u,\"overrun\":%s,\"pending\":%u}",
+                              total, overrun ? "true" : "false", (unsigned int)pending);
+    }
+    z1_http_stream_end(&out);
+}
+
+// ============================================================================
+// SNN Input Encoders
+// ============================================================================
+
+// POST /api/snn/encode loads a tensor into the controller's encoder
+// (z1_encoder.h): a z1_encode_header_t, then count uint8 values. The
+// encoder then sends the spikes of every step of the window itself, through
+// the same per-node input batches. GET /api/snn/encode shows the progress
+// and POST /api/snn/encode/stop ends the presentation.
+
+typedef struct {
+    bool active;
+    bool rejected;                  // Header refused by the encoder
+    uint32_t started_ms;
+    
+    uint8_t header[sizeof(z1_encode_header_t)];
+    uint8_t header_length;
+} z1_encode_upload_t;
+
+static z1_encode_upload_t g_encode_upload;
+
+static const char* encode_mode_text(uint8_t mode) {
+    switch (mode) {
+        case Z1_ENCODE_POISSON: return "poisson";
+        case Z1_ENCODE_RATE:    return "rate";
+        case Z1_ENCODE_LATENCY: return "latency";
+        default:                return "unknown";
+    }
+}
+
+static bool encode_upload_begin(http_connection_t* conn, uint32_t content_length) {
+    if (g_encode_upload.active) {
+        z1_http_send_error(conn, 503, "Encoder upload already in progress");
+        return false;
+    }
+    if (!g_snn_running) {
+        z1_http_send_error(conn, 400, "SNN not running");
+        return false;
+    }
+    
+    g_encode_upload.active = true;
+    g_encode_upload.rejected = false;
+    g_encode_upload.started_ms = to_ms_since_boot(get_absolute_time());
+    g_encode_upload.header_length = 0;
+    return true;
+}
+
+static bool encode_upload_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    if (g_encode_upload.header_length < sizeof(z1_encode_header_t)) {
+        uint16_t n = sizeof(z1_encode_header_t) - g_encode_upload.header_length;
+        if (n > length) n = length;
+        memcpy(g_encode_upload.header + g_encode_upload.header_length, data, n);
+        g_encode_upload.header_length += n;
+        data += n;
+        length -= n;
+        
+        if (g_encode_upload.header_length < sizeof(z1_encode_header_t)) {
+            return true;
+        }
+        z1_encode_header_t header;
+        memcpy(&header, g_encode_upload.header, sizeof(header));
+        if (!z1_encoder_begin(&header)) {
+            g_encode_upload.rejected = true;
+            return false;
+        }
+    }
+    
+    z1_encoder_add(data, length);
+    return true;
+}
+
+static void encode_upload_end(http_connection_t* conn, bool complete) {
+    g_encode_upload.active = false;
+    
+    if (g_encode_upload.rejected) {
+        z1_http_send_error(conn, 400, "Invalid encoder header");
+        return;
+    }
+    if (!complete || g_encode_upload.header_length < sizeof(z1_encode_header_t) ||
+        !z1_encoder_start()) {
+        z1_encoder_stop();
+        z1_http_send_error(conn, 400, "Incomplete tensor data");
+        return;
+    }
+    
+    z1_encoder_stats_t stats;
+    z1_encoder_get_stats(&stats);
+    uint32_t elapsed_ms = to_ms_since_boot(get_absolute_time()) - g_encode_upload.started_ms;
+    
+    char json[192];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "mode", encode_mode_text(stats.mode), false);
+    pos = json_add_int(json, pos, sizeof(json), "values", stats.count, false);
+    pos = json_add_int(json, pos, sizeof(json), "inputs", stats.inputs, false);
+    pos = json_add_int(json, pos, sizeof(json), "window_steps", stats.window_steps, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", elapsed_ms, true);
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+const z1_http_body_sink_t g_snn_encode_sink = {
+    .begin = encode_upload_begin,
+    .write = encode_upload_write,
+    .end = encode_upload_end,
+};
+
+/**
+ * Handle encoder progress - GET /api/snn/encode
+ */
+void handle_get_snn_encode(http_connection_t* conn) {
+    z1_encoder_stats_t stats;
+    z1_encoder_get_stats(&stats);
+    
+    char json[320];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_bool(json, pos, sizeof(json), "active", stats.active, false);
+    pos = json_add_string(json, pos, sizeof(json), "mode", encode_mode_text(stats.mode), false);
+    pos = json_add_bool(json, pos, sizeof(json), "loop", (stats.flags & Z1_ENCODE_FLAG_LOOP) != 0, false);
+    pos = json_add_int(json, pos, sizeof(json), "values", stats.count, false);
+    pos = json_add_int(json, pos, sizeof(json), "inputs", stats.inputs, false);
+    pos = json_add_int(json, pos, sizeof(json), "window_steps", stats.window_steps, false);
+    pos = json_add_int(json, pos, sizeof(json), "step", stats.step, false);
+    pos = json_add_int(json, pos, sizeof(json), "presentations", stats.presentations, false);
+    pos = json_add_int(json, pos, sizeof(json), "spikes", stats.spikes, false);
+    pos = json_add_int(json, pos, sizeof(json), "unmapped", stats.unmapped, true);
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+/**
+ * Handle encoder stop - POST /api/snn/encode/stop
+ */
+void handle_post_snn_encode_stop(http_connection_t* conn) {
+    z1_encoder_stop();
+    
+    char json[64];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "status", "ok", true);
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+// ============================================================================
+// SNN Batch Inference
+// ============================================================================
+
+// POST /api/snn/batch?steps=S&samples=K stages a batch (z1_batch.h): the
+// body is entries [sample:2][step:2][neuron_id:2][value:2], neuron_id
+// global, value Q8.8, step | Z1_SNN_BATCH_HOLD repeated to the end of the
+// sample, all in (sample, step) order. Each entry goes to the nodes that own
+// the neuron; without a usable neuron map the ID is taken as a local ID on
+// every node of the network. POST /api/snn/batch/start runs it, GET
+// /api/snn/batch shows the progress per node and GET /api/snn/batch/results
+// returns the results block of every node back to back.
+
+#define Z1_BATCH_ENTRY_SIZE     8
+
+typedef struct {
+    bool active;
+    bool rejected;                  // Out of order, out of range or over a node's capacity
+    uint32_t started_ms;
+    
+    uint8_t field[Z1_BATCH_ENTRY_SIZE];
+    uint8_t field_length;
+    
+    uint32_t unmapped;              // Global IDs no deployed table holds
+} z1_batch_upload_t;
+
+static z1_batch_upload_t g_batch_upload;
+
+static const char* batch_status_text(uint8_t status) {
+    switch (status) {
+        case Z1_SNN_BATCH_STATUS_OK:         return "ok";
+        case Z1_SNN_BATCH_STATUS_NONE:       return "none";
+        case Z1_SNN_BATCH_STATUS_NO_NETWORK: return "no_network";
+        case Z1_SNN_BATCH_STATUS_BAD_IMAGE:  return "bad_image";
+        case Z1_SNN_BATCH_STATUS_TOO_LARGE:  return "too_large";
+        case Z1_SNN_BATCH_STATUS_NO_OUTPUTS: return "no_outputs";
+        default:                             return "failed";
+    }
+}
+
+// Stage one body entry on its owner nodes
+static void batch_upload_add(void) {
+    z1_snn_batch_input_t input;
+    memcpy(&input, g_batch_upload.field, sizeof(input));
+    
+    uint16_t node_mask = g_snn_node_mask;
+    uint16_t local_id = input.local_id;
+    if (g_neuron_map.valid && !neuron_map_lookup(input.local_id, &node_mask, &local_id)) {
+        g_batch_upload.unmapped++;
+        return;
+    }
+    input.local_id = local_id;
+    
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if ((node_mask & (1u << node)) && !z1_batch_stage_add(node, &input)) {
+            g_batch_upload.rejected = true;
+        }
+    }
+}
+
+static bool batch_upload_begin(http_connection_t* conn, uint32_t content_length) {
+    if (g_batch_upload.active) {
+        z1_http_send_error(conn, 503, "Batch upload already in progress");
+        return false;
+    }
+    if (!g_snn_deployed || g_snn_node_mask == 0) {
+        z1_http_send_error(conn, 400, "No SNN deployed");
+        return false;
+    }
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN first");
+        return false;
+    }
+    
+    int32_t steps = parse_query_param_int(conn->path, "steps", 0);
+    int32_t samples = parse_query_param_int(conn->path, "samples", 0);
+    if (steps <= 0 || steps > UINT16_MAX || samples <= 0 || samples > UINT16_MAX) {
+        z1_http_send_error(conn, 400, "steps and samples required");
+        return false;
+    }
+    if (!z1_batch_stage_begin(g_snn_node_mask, (uint16_t)steps, (uint16_t)samples)) {
+        z1_http_send_error(conn, 500, "Nodes did not answer");
+        return false;
+    }
+    
+    g_batch_upload.active = true;
+    g_batch_upload.rejected = false;
+    g_batch_upload.started_ms = to_ms_since_boot(get_absolute_time());
+    g_batch_upload.field_length = 0;
+    g_batch_upload.unmapped = 0;
+    return true;
+}
+
+static bool batch_upload_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    while (length > 0) {
+        uint8_t n = Z1_BATCH_ENTRY_SIZE - g_batch_upload.field_length;
+        if (n > length) n = length;
+        memcpy(g_batch_upload.field + g_batch_upload.field_length, data, n);
+        g_batch_upload.field_length += n;
+        data += n;
+        length -= n;
+        
+        if (g_batch_upload.field_length == Z1_BATCH_ENTRY_SIZE) {
+            batch_upload_add();
+            g_batch_upload.field_length = 0;
+        }
+    }
+    
+    // A refused entry ends the transfer
+    return !g_batch_upload.rejected;
+}
+
+static void batch_upload_end(http_connection_t* conn, bool complete) {
+    g_batch_upload.active = false;
+    
+    // Headers only for a whole body, so the nodes never take a partial batch
+    if (g_batch_upload.rejected) {
+        z1_http_send_error(conn, 413, "Batch inputs out of order or beyond node staging");
+        return;
+    }
+    if (!complete || g_batch_upload.field_length != 0) {
+        z1_http_send_error(conn, 400, "Incomplete batch data");
+        return;
+    }
+    if (!z1_batch_stage_end()) {
+        z1_http_send_error(conn, 500, "Failed to stage the batch");
+        return;
+    }
+    
+    z1_batch_stage_info_t stage;
+    z1_batch_get_stage(&stage);
+    uint32_t elapsed_ms = to_ms_since_boot(get_absolute_time()) - g_batch_upload.started_ms;
+    
+    char json[192];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_int(json, pos, sizeof(json), "samples", stage.sample_count, false);
+    pos = json_add_int(json, pos, sizeof(json), "steps_per_sample", stage.steps_per_sample, false);
+    pos = json_add_int(json, pos, sizeof(json), "inputs", stage.inputs, false);
+    pos = json_add_int(json, pos, sizeof(json), "unmapped", g_batch_upload.unmapped, false);
+    pos = json_add_int(json, pos, sizeof(json), "bytes", stage.bytes, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", elapsed_ms, true);
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+const z1_http_body_sink_t g_snn_batch_sink = {
+    .begin = batch_upload_begin,
+    .write = batch_upload_write,
+    .end = batch_upload_end,
+};
+
+/**
+ * Handle batch start - POST /api/snn/batch/start
+ */
+void handle_post_snn_batch_start(http_connection_t* conn) {
+    z1_batch_stage_info_t stage;
+    z1_batch_get_stage(&stage);
+    
+    if (!stage.staged) {
+        z1_http_send_error(conn, 400, "No batch staged");
+        return;
+    }
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN first");
+        return;
+    }
+    if (!z1_batch_start()) {
+        z1_display_error("Batch start failed");
+        z1_http_send_error(conn, 500, "Failed to start the batch");
+        return;
+    }
+    g_snn_running = true;
+    z1_display_snn_status(true, g_snn_spike_count);
+    
+    char json[128];
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "status", "ok", false);
+    pos = json_add_bool(json, pos, sizeof(json), "sync", __builtin_popcount(stage.node_mask) > 1, true);
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+/**
+ * Handle batch progress - GET /api/snn/batch
+ */
+void handle_get_snn_batch(http_connection_t* conn) {
+    char json[Z1_HTTP_BUFFER_SIZE];
+    z1_batch_stage_info_t stage;
+    z1_batch_get_stage(&stage);
+    
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_bool(json, pos, sizeof(json), "staged", stage.staged, false);
+    pos = json_add_int(json, pos, sizeof(json), "samples", stage.sample_count, false);
+    pos = json_add_int(json, pos, sizeof(json), "steps_per_sample", stage.steps_per_sample, false);
+    pos = json_begin_array(json, pos, sizeof(json), "nodes");
     
-    if (i) {
-        for (int k = i; k < 3; k++)
-            char_array_3[k] = '\0';
-        
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        
-        for (int k = 0; k < i + 1; k++)
-            output[j++] = base64_chars[char_array_4[k]];
+    bool first = true;
+    bool done = stage.staged;
+    for (uint8_t node = 0; node < Z1_MAX_NODES && pos >= 0; node++) {
+        if (!(stage.node_mask & (1u << node))) {
+            continue;
+        }
+        z1_snn_batch_info_t info;
+        z1_batch_query(node, &info);
+        done &= info.status == Z1_SNN_BATCH_STATUS_OK && info.samples_done == info.sample_count;
         
-        while (i++ < 3)
-            output[j++] = '=';
+        int written = snprintf(json + pos, sizeof(json) - pos,
+                               "%s{\"id\":%u,\"status\":\"%s\",\"samples_done\":%u,\"outputs\":%u,"
+                               "\"steps\":%lu,\"held_dropped\":%u,\"results_length\":%lu}",
+                               first ? "" : ",", node, batch_status_text(info.status),
+                               info.samples_done, info.output_count, (unsigned long)info.steps,
+                               info.held_dropped, (unsigned long)info.results_length);
+        pos = (written < 0 || pos + written >= (int)sizeof(json)) ? -1 : pos + written;
+        first = false;
     }
     
-    output[j] = '\0';
-    return j;
+    if (pos >= 0) {
+        pos = json_end_array(json, pos, sizeof(json), false);
+        pos = json_add_bool(json, pos, sizeof(json), "done", done, true);
+    }
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
 }
 
-int base64_decode(const char* input, uint8_t* output, int output_size) {
-    // TODO: Implement base64 decode
-    return -1;
+/**
+ * Handle batch results - GET /api/snn/batch/results
+ * Streams the results block (z1_snn_batch_results_t) of every batch node
+ *
+ * Each block carries its node ID, output neurons and the counts of the
+ * samples finished so far. A read that fails part way cuts the stream.
+ */
+void handle_get_snn_batch_results(http_connection_t* conn) {
+    static uint8_t block[Z1_HTTP_MEMORY_BLOCK];
+    static z1_snn_batch_info_t nodes[Z1_MAX_NODES];
+    z1_batch_stage_info_t stage;
+    z1_batch_get_stage(&stage);
+    
+    if (!stage.staged) {
+        z1_http_send_error(conn, 400, "No batch staged");
+        return;
+    }
+    
+    // Sizes first, so a node without results is an error answer, not a cut stream
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if ((stage.node_mask & (1u << node)) &&
+            (!z1_batch_query(node, &nodes[node]) || nodes[node].results_length == 0)) {
+            z1_http_send_error(conn, 404, "No batch results");
+            return;
+        }
+    }
+    
+    z1_http_stream_t out;
+    if (!z1_http_stream_begin(&out, conn, 200, "application/octet-stream")) {
+        return;
+    }
+    
+    for (uint8_t node = 0; node < Z1_MAX_NODES && !out.failed; node++) {
+        if (!(stage.node_mask & (1u << node))) {
+            continue;
+        }
+        
+        const z1_snn_batch_info_t* info = &nodes[node];
+        uint32_t total = 0;
+        if (z1_mem_read_begin(node, info->results_addr, info->results_length)) {
+            while (total < info->results_length && !out.failed) {
+                int n = z1_mem_read_next(block, sizeof(block), Z1_MEM_READ_NEXT_TIMEOUT_MS);
+                if (n <= 0) {
+                    break;
+                }
+                z1_http_stream_write(&out, block, n);
+                total += n;
+            }
+        }
+        z1_mem_read_end();
+        
+        if (total < info->results_length) {
+            out.failed = true;  // Cut the response: the client must not take it as whole
+        }
+    }
+    z1_http_stream_end(&out);
 }
 
-
 // ============================================================================
-// SNN Deployment Endpoints (Complete Implementation)
+// Diagnostics Endpoints
 // ============================================================================
 
 /**
- * Handle SNN deployment - POST /api/snn/deploy
- * Receives neuron table data and deploys to nodes
+ * Handle get trace - GET /api/trace
+ * Returns the most recent controller trace records, oldest first
  */
-void handle_post_snn_deploy(http_connection_t* conn, const char* body, uint16_t body_length) {
-    // Binary format expected:
-    // [0-3]   uint32_t total_neurons
-    // [4]     uint8_t node_count
-    // [5-68]  char[64] network_name
-    // [69+]   Node deployment data
+void handle_get_trace(http_connection_t* conn, uint16_t count) {
+    static z1_trace_record_t records[Z1_HTTP_TRACE_MAX_RECORDS];
+    static const char* const subsystems[] = {"bus", "frame", "snn", "app"};
     
-    if (body_length < 69) {
-        z1_http_send_error(conn, 400, "Invalid deployment data");
-        return;
+    if (count == 0 || count > Z1_HTTP_TRACE_MAX_RECORDS) {
+        count = Z1_HTTP_TRACE_MAX_RECORDS;
     }
+    uint16_t n = z1_trace_snapshot(records, count);
     
-    // Parse header
-    uint32_t total_neurons;
-    uint8_t node_count;
-    memcpy(&total_neurons, body, 4);
-    memcpy(&node_count, body + 4, 1);
-    memcpy(g_snn_network_name, body + 5, 64);
-    g_snn_network_name[63] = '\0';
-    
-    if (node_count > 16) {
-        z1_http_send_error(conn, 400, "Too many nodes");
+    z1_http_stream_t out;
+    if (!z1_http_stream_begin(&out, conn, 200, "application/json")) {
         return;
     }
+    z1_http_stream_printf(&out, "{\"total\":%u,\"dropped\":%u,\"records\":[",
+                          (unsigned int)z1_trace_count(), (unsigned int)z1_trace_dropped());
+    
+    for (uint16_t i = 0; i < n && !out.failed; i++) {
+        const z1_trace_record_t* rec = &records[i];
+        z1_http_stream_printf(&out,
+                              "{\"t\":%u,\"sub\":\"%s\",\"event\":\"%s\",\"arg0\":%u,\"arg1\":%u}%s",
+                              (unsigned int)rec->timestamp_us,
+                              rec->subsystem < 4 ? subsystems[rec->subsystem] : "?",
+                              z1_trace_event_name(rec->subsystem, rec->event),
+                              rec->arg0, (unsigned int)rec->arg1, (i + 1 < n) ? "," : "");
+    }
     
-    printf("[API] Deploying SNN '%s': %lu neurons across %u nodes\n",
-           g_snn_network_name, total_neurons, node_count);
+    z1_http_stream_printf(&out, "]}");
+    z1_http_stream_end(&out);
+}
+
+// Benchmarks run to completion inside the request: the node (or, for the
+// bus test, the controller) is busy for the whole run and the response
+// carries the raw counts and times plus the rates derived from them.
+
+static const char* const g_bench_bus_modes[Z1_BENCH_BUS_MODES] = { "write", "chunked", "burst" };
+static const uint32_t g_bench_bus_counts[Z1_BENCH_BUS_MODES] = { 1000, 4, 100 };
+
+static uint32_t bench_rate(uint64_t count, uint32_t elapsed_us) {
+    return elapsed_us > 0 ? (uint32_t)(count * 1000000 / elapsed_us) : 0;
+}
+
+// KB/s of a PSRAM pass
+static uint32_t bench_kb_per_s(uint32_t bytes, uint32_t elapsed_us) {
+    return bench_rate(bytes, elapsed_us) / 1024;
+}
+
+// Answer a refused or failed node benchmark; false if it ran
+static bool bench_refused(http_connection_t* conn, int length, int expected, uint8_t status) {
+    if (length != expected) {
+        z1_http_send_error(conn, 504, "Node did not answer");
+    } else if (status == Z1_BENCH_STATUS_BUSY) {
+        z1_http_send_error(conn, 409, "SNN running on node");
+    } else if (status == Z1_BENCH_STATUS_BAD_PARAMS) {
+        z1_http_send_error(conn, 400, "Benchmark does not fit the node");
+    } else if (status != Z1_BENCH_STATUS_OK) {
+        z1_http_send_error(conn, 500, "Benchmark failed on node");
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static int bench_snn(http_connection_t* conn, const char* query, uint8_t node,
+                     char* json, int pos, int size) {
+    z1_bench_req_t req = {
+        .test = Z1_BENCH_SNN,
+        .neurons = parse_query_param_int(query, "neurons", 0),
+        .fan_in = parse_query_param_int(query, "fan_in", 0),
+        .rate = parse_query_param_int(query, "rate", 0),
+        .steps = parse_query_param_int(query, "steps", 0),
+    };
+    z1_bench_snn_result_t r;
+    int length = z1_query_bench(node, &req, (uint8_t*)&r, sizeof(r));
+    if (bench_refused(conn, length, sizeof(r), r.status)) {
+        return -1;
+    }
     
-    // Update display
-    z1_display_snn_deploy(total_neurons, node_count);
+    // The synthetic network replaced this node's part of the deployed one
+    if (g_snn_node_mask & (1u << node)) {
+        g_snn_deployed = false;
+    }
     
-    // Parse and deploy to each node
-    const uint8_t* data_ptr = (const uint8_t*)body + 69;
-    uint16_t remaining = body_length - 69;
+    pos = json_add_int(json, pos, size, "neurons", r.neurons, false);
+    pos = json_add_int(json, pos, size, "fan_in", r.fan_in, false);
+    pos = json_add_int(json, pos, size, "rate_permille", r.rate, false);
+    pos = json_add_int(json, pos, size, "steps", r.steps, false);
+    pos = json_add_int(json, pos, size, "setup_us", r.setup_us, false);
+    pos = json_add_int(json, pos, size, "run_us", r.run_us, false);
+    pos = json_add_int(json, pos, size, "spikes", r.spikes, false);
+    pos = json_add_int(json, pos, size, "synapse_events", r.synapse_events, false);
+    pos = json_add_int(json, pos, size, "inputs", r.inputs, false);
+    pos = json_add_int(json, pos, size, "steps_per_s", bench_rate(r.steps, r.run_us), false);
+    pos = json_add_int(json, pos, size, "spikes_per_s", bench_rate(r.spikes, r.run_us), false);
+    return json_add_int(json, pos, size, "synapse_events_per_s",
+                        bench_rate(r.synapse_events, r.run_us), true);
+}
+
+static int bench_psram(http_connection_t* conn, const char* query, uint8_t node,
+                       char* json, int pos, int size) {
+    z1_bench_req_t req = {
+        .test = Z1_BENCH_PSRAM,
+        .bytes = parse_query_param_int(query, "bytes", 0),
+    };
+    z1_bench_psram_result_t r;
+    int length = z1_query_bench(node, &req, (uint8_t*)&r, sizeof(r));
+    if (bench_refused(conn, length, sizeof(r), r.status)) {
+        return -1;
+    }
     
-    for (uint8_t i = 0; i < node_count; i++) {
-        if (remaining < 3) {
-            z1_http_send_error(conn, 400, "Incomplete node data");
-            return;
-        }
-        
-        // Parse node deployment entry:
-        // [0]     uint8_t node_id
-        // [1-2]   uint16_t data_length
-        // [3+]    neuron table data
-        
-        uint8_t node_id = data_ptr[0];
-        uint16_t data_length;
-        memcpy(&data_length, data_ptr + 1, 2);
-        
-        if (remaining < 3 + data_length) {
-            z1_http_send_error(conn, 400, "Incomplete neuron table data");
-            return;
+    pos = json_add_int(json, pos, size, "bytes", r.bytes, false);
+    pos = json_add_int(json, pos, size, "block_size", r.block_size, false);
+    pos = json_add_int(json, pos, size, "xip_read_us", r.xip_read_us, false);
+    pos = json_add_int(json, pos, size, "xip_write_us", r.xip_write_us, false);
+    pos = json_add_int(json, pos, size, "dma_read_us", r.dma_read_us, false);
+    pos = json_add_int(json, pos, size, "dma_write_us", r.dma_write_us, false);
+    pos = json_add_int(json, pos, size, "xip_read_kb_s", bench_kb_per_s(r.bytes, r.xip_read_us), false);
+    pos = json_add_int(json, pos, size, "xip_write_kb_s", bench_kb_per_s(r.bytes, r.xip_write_us), false);
+    pos = json_add_int(json, pos, size, "dma_read_kb_s", bench_kb_per_s(r.bytes, r.dma_read_us), false);
+    return json_add_int(json, pos, size, "dma_write_kb_s", bench_kb_per_s(r.bytes, r.dma_write_us), true);
+}
+
+static int bench_bus(http_connection_t* conn, const char* query, uint8_t node,
+                     char* json, int pos, int size) {
+    char mode[16];
+    bool all = !parse_query_param(query, "mode", mode, sizeof(mode));
+    uint16_t payload = parse_query_param_int(query, "bytes", 256);
+    int32_t count = parse_query_param_int(query, "count", 0);
+    
+    pos = json_begin_array(json, pos, size, "results");
+    bool first = true;
+    for (uint8_t m = 0; m < Z1_BENCH_BUS_MODES && pos >= 0; m++) {
+        if (!all && strcmp(mode, g_bench_bus_modes[m]) != 0) {
+            continue;
         }
         
-        const uint8_t* neuron_table = data_ptr + 3;
-        
-        printf("[API] Deploying to node %u: %u bytes\n", node_id, data_length);
-        
-        // Write neuron table to node's PSRAM
-        uint32_t psram_addr = 0x20100000;  // Z1_NEURON_TABLE_BASE_ADDR
-        
-        // Send in chunks (max 256 bytes per Z1 bus message)
-        uint16_t offset = 0;
-        while (offset < data_length) {
-            uint16_t chunk_size = (data_length - offset > 256) ? 256 : (data_length - offset);
-            
-            // Prepare memory write command
-            uint8_t cmd_data[260];
-            memcpy(cmd_data, &psram_addr, 4);
-            memcpy(cmd_data + 4, neuron_table + offset, chunk_size);
-            
-            if (!z1_bus_send_command(node_id, Z1_CMD_MEMORY_WRITE, cmd_data, 4 + chunk_size)) {
-                z1_http_send_error(conn, 500, "Failed to write to node PSRAM");
-                return;
-            }
-            
-            offset += chunk_size;
-            psram_addr += chunk_size;
+        z1_bench_bus_result_t r;
+        uint32_t n = count > 0 ? (uint32_t)count : g_bench_bus_counts[m];
+        if (!z1_bench_bus(node, (z1_bench_bus_mode_t)m, payload, n, &r)) {
+            z1_http_send_error(conn, 504, "Node did not answer");
+            return -1;
         }
         
-        // Calculate neuron count from data length (each neuron is 256 bytes)
-        uint16_t neuron_count = data_length / 256;
-        
-        // Send load command to node with neuron count
-        uint8_t load_cmd_data[2];
-        memcpy(load_cmd_data, &neuron_count, 2);
-        z1_bus_send_command(node_id, Z1_CMD_SNN_LOAD_TABLE, load_cmd_data, 2);
-        
-        printf("[API] Sent SNN_LOAD_TABLE to node %u: %u neurons\n", node_id, neuron_count);
-        
-        data_ptr += 3 + data_length;
-        remaining -= 3 + data_length;
+        int written = snprintf(json + pos, size - pos,
+                               "%s{\"mode\":\"%s\",\"payload\":%u,\"transfers\":%lu,\"failed\":%lu,"
+                               "\"bytes\":%lu,\"elapsed_us\":%lu,\"transfers_per_s\":%lu,"
+                               "\"bytes_per_s\":%lu,\"delivered_transfers\":%ld,\"delivered_bytes\":%ld}",
+                               first ? "" : ",", g_bench_bus_modes[m], r.payload,
+                               (unsigned long)r.transfers, (unsigned long)r.failed,
+                               (unsigned long)r.bytes, (unsigned long)r.elapsed_us,
+                               (unsigned long)bench_rate(r.transfers, r.elapsed_us),
+                               (unsigned long)bench_rate(r.bytes, r.elapsed_us),
+                               r.delivered_valid ? (long)r.delivered_transfers : -1L,
+                               r.delivered_valid ? (long)r.delivered_bytes : -1L);
+        pos = (written < 0 || pos + written >= size) ? -1 : pos + written;
+        first = false;
     }
     
-    g_snn_deployed = true;
-    g_snn_neuron_count = total_neurons;
-    g_snn_nodes_used = node_count;
-    
-    // Send success response
-    char json[256];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_string(json, pos, sizeof(json), "status", "deployed", false);
-    pos = json_add_string(json, pos, sizeof(json), "network_name", g_snn_network_name, false);
-    pos = json_add_int(json, pos, sizeof(json), "neuron_count", g_snn_neuron_count, false);
-    pos = json_add_int(json, pos, sizeof(json), "nodes_used", g_snn_nodes_used, true);
-    json_end_object(json, pos, sizeof(json));
-    
-    z1_http_send_json(conn, 200, json);
-    
-    printf("[API] SNN deployment complete\n");
-    
-    // Update display
-    z1_display_status("Deploy complete");
+    if (first && pos >= 0) {
+        z1_http_send_error(conn, 400, "mode must be write, chunked or burst");
+        return -1;
+    }
+    return pos >= 0 ? json_end_array(json, pos, size, true) : pos;
 }
 
 /**
- * Handle spike injection - POST /api/snn/input
- * Injects spikes into specified neurons
+ * Handle benchmark - POST /api/bench?test=snn|psram|bus
+ * snn: neurons, fan_in, rate (per mille driven per step), steps;
+ * psram: bytes; bus: mode (write|chunked|burst, default all), bytes, count
  */
-void handle_post_snn_inject(http_connection_t* conn, const char* body, uint16_t body_length) {
-    if (!g_snn_running) {
-        z1_http_send_error(conn, 400, "SNN not running");
+void handle_post_bench(http_connection_t* conn, const char* query) {
+    char test[16];
+    char json[1024];
+    int32_t node = parse_query_param_int(query, "node", 0);
+    
+    if (!parse_query_param(query, "test", test, sizeof(test))) {
+        z1_http_send_error(conn, 400, "test must be snn, psram or bus");
         return;
     }
-    
-    // Binary format:
-    // [0-1]   uint16_t spike_count
-    // [2+]    Spike entries (6 bytes each):
-    //   [0-1]   uint16_t neuron_id
-    //   [2-5]   float value
-    
-    if (body_length < 2) {
-        z1_http_send_error(conn, 400, "Invalid spike data");
+    if (node < 0 || node >= Z1_MAX_NODES) {
+        z1_http_send_error(conn, 400, "Invalid node ID");
         return;
     }
-    
-    uint16_t spike_count;
-    memcpy(&spike_count, body, 2);
-    
-    if (body_length < 2 + spike_count * 6) {
-        z1_http_send_error(conn, 400, "Incomplete spike data");
+    if (g_snn_running) {
+        z1_http_send_error(conn, 409, "Stop the SNN first");
         return;
     }
     
-    const uint8_t* spike_data = (const uint8_t*)body + 2;
-    uint16_t injected = 0;
+    int pos = json_begin_object(json, sizeof(json));
+    pos = json_add_string(json, pos, sizeof(json), "test", test, false);
+    pos = json_add_int(json, pos, sizeof(json), "node", node, false);
+    
+    if (strcmp(test, "snn") == 0) {
+        pos = bench_snn(conn, query, node, json, pos, sizeof(json));
+    } else if (strcmp(test, "psram") == 0) {
+        pos = bench_psram(conn, query, node, json, pos, sizeof(json));
+    } else if (strcmp(test, "bus") == 0) {
+        pos = bench_bus(conn, query, node, json, pos, sizeof(json));
+    } else {
+        z1_http_send_error(conn, 400, "test must be snn, psram or bus");
+        return;
+    }
     
-    for (uint16_t i = 0; i < spike_count; i++) {
-        uint16_t neuron_id;
-        float value;
-        memcpy(&neuron_id, spike_data + i * 6, 2);
-        memcpy(&value, spike_data + i * 6 + 2, 4);
-        
-        // Broadcast spike to all nodes (they'll filter by neuron ID)
-        uint8_t cmd_data[6];
-        memcpy(cmd_data, &neuron_id, 2);
-        uint32_t timestamp = 0;  // Current time
-        memcpy(cmd_data + 2, &timestamp, 4);
-        
-        for (uint8_t node = 0; node < g_snn_nodes_used; node++) {
-            z1_bus_send_command(node, Z1_CMD_SNN_INJECT_SPIKE, cmd_data, 6);
+    // Errors were answered by the test
+    if (pos < 0) {
+        return;
+    }
+    json_end_object(json, pos, sizeof(json));
+    z1_http_send_json(conn, 200, json);
+}
+
+// ============================================================================
+// Firmware Management Endpoints
+// ============================================================================
+
+// Firmware images are sent with z1_firmware_dist.c: one multicast pass of
+// CRC32-checked chunks to every target, then only the chunks each node
+// reports missing, then a whole-image check on every node.
+//
+// POST /api/firmware/batch[?nodes=0,1,2] streams the raw image (Content-Length
+// required) into the distribution as it arrives; without nodes= it goes to
+// every node the telemetry poller sees alive.
+
+// "0,1,2" -> node mask (0 if malformed)
+static uint16_t parse_node_list(const char* list) {
+    uint16_t mask = 0;
+    while (*list) {
+        char* end;
+        long node = strtol(list, &end, 10);
+        if (end == list || node < 0 || node >= Z1_MAX_NODES) {
+            return 0;
+        }
+        mask |= 1u << node;
+        list = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return 0;
         }
-        
-        injected++;
     }
+    return mask;
+}
+
+// Per-node outcome of a distribution (200 once every target verified)
+static void send_firmware_result(http_connection_t* conn, bool ok, const z1_fw_dist_result_t* r) {
+    char json[Z1_HTTP_BUFFER_SIZE];
+    char crc[12];
+    snprintf(crc, sizeof(crc), "0x%08lX", (unsigned long)r->image_crc32);
     
-    // Update spike count
-    g_snn_spike_count += injected;
-    
-    // Update display
-    char status_msg[32];
-    snprintf(status_msg, sizeof(status_msg), "Injected %d spikes", injected);
-    z1_display_status(status_msg);
+    uint8_t total = __builtin_popcount(r->targets);
+    uint8_t verified = __builtin_popcount(r->verified_mask);
     
-    // Send response
-    char json[128];
     int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_int(json, pos, sizeof(json), "spikes_injected", injected, true);
+    pos = json_add_string(json, pos, sizeof(json), "status", ok ? "verified" : "incomplete", false);
+    pos = json_add_int(json, pos, sizeof(json), "image_size", r->image_size, false);
+    pos = json_add_string(json, pos, sizeof(json), "image_crc32", crc, false);
+    pos = json_add_int(json, pos, sizeof(json), "chunks", r->chunk_count, false);
+    pos = json_add_int(json, pos, sizeof(json), "chunks_resent", r->chunks_resent, false);
+    pos = json_add_int(json, pos, sizeof(json), "repair_rounds", r->rounds, false);
+    pos = json_add_int(json, pos, sizeof(json), "elapsed_ms", r->elapsed_ms, false);
+    pos = json_add_int(json, pos, sizeof(json), "total_nodes", total, false);
+    pos = json_add_int(json, pos, sizeof(json), "success_count", verified, false);
+    pos = json_add_int(json, pos, sizeof(json), "failed_count", total - verified, false);
+    pos = json_begin_array(json, pos, sizeof(json), "nodes");
+    
+    bool first = true;
+    for (uint8_t node = 0; node < Z1_MAX_NODES && pos >= 0; node++) {
+        if (!(r->targets & (1u << node))) {
+            continue;
+        }
+        const z1_fw_dist_node_t* n = &r->nodes[node];
+        int written = snprintf(json + pos, sizeof(json) - pos,
+                               "%s{\"id\":%u,\"verified\":%s,\"answered\":%s,"
+                               "\"missing\":%u,\"resent\":%u,\"crc_errors\":%lu}",
+                               first ? "" : ",", node, n->verified ? "true" : "false",
+                               n->answered ? "true" : "false", n->missing, n->resent,
+                               (unsigned long)n->crc_errors);
+        pos = (written < 0 || pos + written >= (int)sizeof(json)) ? -1 : pos + written;
+        first = false;
+    }
+    
+    if (pos >= 0) {
+        pos = json_end_array(json, pos, sizeof(json), true);
+    }
+    if (pos < 0) {
+        z1_http_send_error(conn, 500, "Response too large");
+        return;
+    }
     json_end_object(json, pos, sizeof(json));
     
-    z1_http_send_json(conn, 200, json);
+    z1_http_send_json(conn, ok ? 200 : 500, json);
 }
 
-/**
- * Handle get spike events - GET /api/snn/events
- * Returns recent spike events from all nodes
- */
-void handle_get_snn_events(http_connection_t* conn, uint16_t count) {
-    if (!g_snn_running) {
-        z1_http_send_error(conn, 400, "SNN not running");
+// Distribute an image that is already in memory
+static void distribute_firmware(http_connection_t* conn, uint16_t node_mask,
+                                const uint8_t* firmware_data, uint32_t firmware_size) {
+    if (firmware_size == 0 || firmware_size > Z1_FW_DIST_MAX_IMAGE) {
+        z1_http_send_error(conn, 413, "Firmware image too large");
+        return;
+    }
+    if (!z1_fw_dist_begin(node_mask, firmware_size)) {
+        z1_http_send_error(conn, 503, "Firmware distribution already in progress");
         return;
     }
     
-    // Query all nodes for recent spikes
-    char json[2048];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_begin_array(json, pos, sizeof(json), "events");
-    
-    // For each node, request spike events
-    for (uint8_t node = 0; node < g_snn_nodes_used; node++) {
-        // Send get spikes command
-        uint8_t cmd_data[2];
-        memcpy(cmd_data, &count, 2);
-        z1_bus_send_command(node, Z1_CMD_SNN_GET_SPIKES, cmd_data, 2);
-        
-        // TODO: Wait for response and parse spike data
-        // For now, return empty array
+    z1_fw_dist_result_t result;
+    z1_fw_dist_write(firmware_data, firmware_size);
+    bool ok = z1_fw_dist_finish(&result);
+    send_firmware_result(conn, ok, &result);
+}
+
+static bool firmware_batch_begin(http_connection_t* conn, uint32_t content_length) {
+    if (z1_fw_dist_active()) {
+        z1_http_send_error(conn, 503, "Firmware distribution already in progress");
+        return false;
+    }
+    if (content_length == Z1_HTTP_BODY_CHUNKED || content_length == 0) {
+        z1_http_send_error(conn, 411, "Content-Length required");
+        return false;
+    }
+    if (content_length > Z1_FW_DIST_MAX_IMAGE) {
+        z1_http_send_error(conn, 413, "Firmware image too large");
+        return false;
     }
     
-    pos = json_end_array(json, pos, sizeof(json), true);
-    json_end_object(json, pos, sizeof(json));
+    uint16_t node_mask;
+    char nodes[64];
+    if (parse_query_param(conn->path, "nodes", nodes, sizeof(nodes))) {
+        node_mask = parse_node_list(nodes);
+    } else {
+        z1_telemetry_stats_t stats;
+        z1_telemetry_get_stats(&stats);
+        node_mask = stats.alive_mask;
+    }
+    if (node_mask == 0) {
+        z1_http_send_error(conn, 400, "No target nodes");
+        return false;
+    }
     
-    z1_http_send_json(conn, 200, json);
+    if (!z1_fw_dist_begin(node_mask, content_length)) {
+        z1_http_send_error(conn, 500, "Failed to start firmware distribution");
+        return false;
+    }
+    return true;
 }
 
-// ============================================================================
-// Firmware Management Endpoints
-// ============================================================================
+static bool firmware_batch_write(http_connection_t* conn, const uint8_t* data, uint16_t length) {
+    return z1_fw_dist_write(data, length);
+}
+
+static void firmware_batch_end(http_connection_t* conn, bool complete) {
+    if (!complete) {
+        z1_fw_dist_abort();
+        z1_http_send_error(conn, 400, "Incomplete firmware image");
+        return;
+    }
+    
+    z1_fw_dist_result_t result;
+    bool ok = z1_fw_dist_finish(&result);
+    send_firmware_result(conn, ok, &result);
+}
+
+const z1_http_body_sink_t g_firmware_batch_sink = {
+    .begin = firmware_batch_begin,
+    .write = firmware_batch_write,
+    .end = firmware_batch_end,
+};
 
 /**
  * Handle firmware upload - POST /api/firmware/upload/{node_id}
- * Upload firmware binary to node's buffer
+ * Stage firmware in one node's buffer (chunked, CRC32-checked, verified)
  */
 void handle_firmware_upload(http_connection_t* conn, uint8_t node_id, 
                            const uint8_t* firmware_data, uint32_t firmware_size) {
@@ -760,46 +3332,7 @@ void handle_firmware_upload(http_connection_t* conn, uint8_t node_id,
         return;
     }
     
-    if (firmware_size > Z1_FIRMWARE_MAX_SIZE) {
-        z1_http_send_error(conn, 400, "Firmware too large (max 112KB)");
-        return;
-    }
-    
-    // Send firmware in chunks over Z1 bus
-    const uint32_t chunk_size = 256;  // Z1 bus packet size
-    uint32_t offset = 0;
-    uint32_t chunks_sent = 0;
-    
-    while (offset < firmware_size) {
-        uint32_t bytes_to_send = (firmware_size - offset) < chunk_size ? 
-                                 (firmware_size - offset) : chunk_size;
-        
-        // Prepare command data: [offset:4][size:4][data:N]
-        uint8_t cmd_data[chunk_size + 8];
-        memcpy(cmd_data, &offset, 4);
-        memcpy(cmd_data + 4, &bytes_to_send, 4);
-        memcpy(cmd_data + 8, firmware_data + offset, bytes_to_send);
-        
-        // Send firmware upload command
-        if (!z1_bus_send_command(node_id, Z1_CMD_FIRMWARE_UPLOAD, 
-                                 cmd_data, bytes_to_send + 8)) {
-            z1_http_send_error(conn, 500, "Failed to send firmware chunk");
-            return;
-        }
-        
-        offset += bytes_to_send;
-        chunks_sent++;
-    }
-    
-    // Send success response
-    char json[256];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_int(json, pos, sizeof(json), "node_id", node_id, false);
-    pos = json_add_int(json, pos, sizeof(json), "bytes_uploaded", firmware_size, false);
-    pos = json_add_int(json, pos, sizeof(json), "chunks_sent", chunks_sent, true);
-    json_end_object(json, pos, sizeof(json));
-    
-    z1_http_send_json(conn, 200, json);
+    distribute_firmware(conn, 1u << node_id, firmware_data, firmware_size);
 }
 
 /**
@@ -912,7 +3445,7 @@ void handle_firmware_info(http_connection_t* conn, uint8_t node_id) {
 
 /**
  * Handle batch firmware flash - POST /api/firmware/batch
- * Flash multiple nodes with same firmware
+ * Send the same firmware to multiple nodes in one multicast pass
  */
 void handle_firmware_batch(http_connection_t* conn, const uint8_t* node_list, 
                           uint8_t node_count, const uint8_t* firmware_data, 
@@ -922,43 +3455,16 @@ void handle_firmware_batch(http_connection_t* conn, const uint8_t* node_list,
         return;
     }
     
-    if (firmware_size > Z1_FIRMWARE_MAX_SIZE) {
-        z1_http_send_error(conn, 400, "Firmware too large");
-        return;
-    }
-    
-    uint8_t success_count = 0;
-    uint8_t failed_nodes[16];
-    uint8_t failed_count = 0;
-    
-    // Flash each node
+    uint16_t node_mask = 0;
     for (uint8_t i = 0; i < node_count; i++) {
-        uint8_t node_id = node_list[i];
-        
-        if (node_id >= 16) {
-            failed_nodes[failed_count++] = node_id;
-            continue;
-        }
-        
-        // Upload firmware (simplified - should use handle_firmware_upload)
-        // For now, just send command
-        if (z1_bus_send_command(node_id, Z1_CMD_FIRMWARE_UPLOAD, 
-                                firmware_data, firmware_size)) {
-            success_count++;
-        } else {
-            failed_nodes[failed_count++] = node_id;
+        if (node_list[i] >= 16) {
+            z1_http_send_error(conn, 400, "Invalid node ID");
+            return;
         }
+        node_mask |= 1u << node_list[i];
     }
     
-    // Send response
-    char json[512];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_int(json, pos, sizeof(json), "total_nodes", node_count, false);
-    pos = json_add_int(json, pos, sizeof(json), "success_count", success_count, false);
-    pos = json_add_int(json, pos, sizeof(json), "failed_count", failed_count, true);
-    json_end_object(json, pos, sizeof(json));
-    
-    z1_http_send_json(conn, 200, json);
+    distribute_firmware(conn, node_mask, firmware_data, firmware_size);
 }
 
 // ============================================================================
@@ -967,41 +3473,11 @@ void handle_firmware_batch(http_connection_t* conn, const uint8_t* node_list,
 
 /**
  * Handle memory read - GET /api/nodes/{node_id}/memory?addr={addr}&len={len}
- * Read memory from node
+ * Read memory from node (JSON form of handle_get_node_memory())
  */
 void handle_memory_read(http_connection_t* conn, uint8_t node_id, 
                        uint32_t address, uint32_t length) {
-    if (node_id >= 16) {
-        z1_http_send_error(conn, 400, "Invalid node ID");
-        return;
-    }
-    
-    if (length > 4096) {
-        z1_http_send_error(conn, 400, "Length too large (max 4KB)");
-        return;
-    }
-    
-    // Send memory read command
-    uint8_t cmd_data[8];
-    memcpy(cmd_data, &address, 4);
-    memcpy(cmd_data + 4, &length, 4);
-    
-    if (!z1_bus_send_command(node_id, Z1_CMD_MEMORY_READ, cmd_data, 8)) {
-        z1_http_send_error(conn, 500, "Failed to send read command");
-        return;
-    }
-    
-    // TODO: Wait for response with memory data
-    // For now, return placeholder
-    char json[256];
-    int pos = json_begin_object(json, sizeof(json));
-    pos = json_add_int(json, pos, sizeof(json), "node_id", node_id, false);
-    pos = json_add_int(json, pos, sizeof(json), "address", address, false);
-    pos = json_add_int(json, pos, sizeof(json), "length", length, false);
-    pos = json_add_string(json, pos, sizeof(json), "data", "base64_data_here", true);
-    json_end_object(json, pos, sizeof(json));
-    
-    z1_http_send_json(conn, 200, json);
+    handle_get_node_memory(conn, node_id, address, length, false);
 }
 
 /**
@@ -18,9 +18,11 @@
 // ============================================================================
 
 #define Z1_HTTP_PORT            80
-#define Z1_HTTP_MAX_CONNECTIONS 4
+#define Z1_HTTP_MAX_CONNECTIONS 7       // W5500 sockets 0-6 (socket 7: UDP spike channel)
 #define Z1_HTTP_BUFFER_SIZE     2048
 #define Z1_HTTP_TIMEOUT_MS      30000
+#define Z1_HTTP_KEEPALIVE_MS    5000    // Idle keep-alive connections are closed after this
+#define Z1_HTTP_BODY_CHUNKED    0xFFFFFFFF  // Streamed body length when chunked (not known up front)
 
 // ============================================================================
 // HTTP Server State
@@ -35,18 +37,45 @@ typedef enum {
     HTTP_STATE_CLOSING
 } http_state_t;
 
+struct z1_http_body_sink;
+
 typedef struct {
     uint8_t socket_num;
     http_state_t state;
-    uint16_t content_length;
-    uint16_t bytes_received;
+    uint32_t content_length;
+    uint32_t bytes_received;
     uint16_t bytes_sent;
     uint32_t last_activity_ms;
+    bool keep_alive;                // Leave the connection open after the response
     char method[8];
     char path[128];
     char content_type[32];
+    
+    // Streamed request body (HTTP_STATE_RECEIVING_BODY)
+    const struct z1_http_body_sink* body_sink;
+    uint32_t body_remaining;        // Bytes left in the body, or in the current chunk
+    uint8_t chunk_state;            // Chunked decoder state (0: Content-Length body)
 } http_connection_t;
 
+/**
+ * Streaming request body consumer
+ * 
+ * Routes with a sink get their body pushed in pieces as it arrives in the
+ * socket RX buffer, so its size is not limited by Z1_HTTP_BUFFER_SIZE.
+ * The sink sends the response: from begin() when it refuses the request,
+ * otherwise from end().
+ */
+typedef struct z1_http_body_sink {
+    // Headers received; content_length is Z1_HTTP_BODY_CHUNKED for chunked bodies
+    bool (*begin)(http_connection_t* conn, uint32_t content_length);
+    
+    // Next piece of the body; false stops the transfer and closes the connection
+    bool (*write)(http_connection_t* conn, const uint8_t* data, uint16_t length);
+    
+    // Body finished (complete) or connection lost / write failed / timed out
+    void (*end)(http_connection_t* conn, bool complete);
+} z1_http_body_sink_t;
+
 // ============================================================================
 // API Endpoint Handlers
 // ============================================================================
@@ -80,7 +109,7 @@ bool z1_http_handle_request(http_connection_t* conn,
 // ============================================================================
 
 // Node Management Endpoints
-void handle_get_nodes(http_connection_t* conn);
+void handle_get_nodes(http_connection_t* conn, bool refresh);
 void handle_get_node(http_connection_t* conn, uint8_t node_id);
 void handle_post_node_reset(http_connection_t* conn, uint8_t node_id);
 void handle_post_node_ping(http_connection_t* conn, uint8_t node_id);
@@ -88,20 +117,90 @@ void handle_post_node_led(http_connection_t* conn, uint8_t node_id, const char*
 void handle_post_nodes_discover(http_connection_t* conn);
 
 // Memory Operations Endpoints
+#define Z1_HTTP_MEMORY_BLOCK 768        // Bytes encoded per piece of a streamed memory dump (3-byte groups)
 void handle_get_node_memory(http_connection_t* conn, uint8_t node_id, 
-                           uint32_t addr, uint16_t length);
+                           uint32_t addr, uint32_t length, bool binary);
 void handle_post_node_memory(http_connection_t* conn, uint8_t node_id, const char* body);
 void handle_post_node_execute(http_connection_t* conn, uint8_t node_id, const char* body);
 
 // SNN Management Endpoints
+#define Z1_DEPLOY_HEADER_SIZE   69      // total_neurons:4, node_count:1, network_name:64
+#define Z1_DEPLOY_ENTRY_SIZE    3       // node_id:1, data_length:2
+#define Z1_DEPLOY_LENGTH32      0xFFFF  // data_length value: a uint32 table length follows
+#define Z1_DEPLOY_SHARED        0xFE    // node_id value: a uint16 node mask follows
+extern const z1_http_body_sink_t g_snn_deploy_sink;  // POST /api/snn/deploy (streamed)
 void handle_post_snn_deploy(http_connection_t* conn, const char* body, uint16_t body_length);
+void handle_get_snn_deploy_status(http_connection_t* conn);
 void handle_get_snn_topology(http_connection_t* conn);
-void handle_post_snn_weights(http_connection_t* conn, const char* body);
+extern const z1_http_body_sink_t g_snn_weights_sink;  // POST /api/snn/weights (streamed)
+void handle_post_snn_weights(http_connection_t* conn, const char* body, uint16_t body_length);
 void handle_get_snn_activity(http_connection_t* conn, uint32_t duration_ms);
-void handle_post_snn_input(http_connection_t* conn, const char* body);
-void handle_post_snn_start(http_connection_t* conn);
+extern const z1_http_body_sink_t g_snn_input_sink;    // POST /api/snn/input (streamed)
+void handle_post_snn_inject(http_connection_t* conn, const char* body, uint16_t body_length);
+extern const z1_http_body_sink_t g_snn_encode_sink;   // POST /api/snn/encode (streamed)
+void handle_get_snn_encode(http_connection_t* conn);
+void handle_post_snn_encode_stop(http_connection_t* conn);
+
+/**
+ * Queue an input spike for the nodes owning a global neuron ID
+ *
+ * Spikes are batched per node (one Z1_CMD_SNN_INPUT_SPIKE packet per
+ * Z1_INPUT_BATCH_MAX) until z1_snn_input_flush(). Without a usable neuron
+ * map the ID is taken as a local ID on every deployed node.
+ *
+ * @param neuron_id Global neuron ID
+ * @param value Input value in Q8.8 (Z1_INPUT_VALUE_ONE = 1.0)
+ * @return false if no deployed table holds the neuron
+ */
+bool z1_snn_input_queue(uint16_t neuron_id, int16_t value);
+
+/**
+ * Send every queued input spike
+ */
+void z1_snn_input_flush(void);
+
+/**
+ * Global ID of a node's local neuron, from the neuron map of the last deploy
+ *
+ * @param node Node ID
+ * @param local_id Local neuron ID on that node
+ * @param global_id Receives the global ID
+ * @return false if the map is unusable or does not hold the neuron
+ */
+bool z1_snn_neuron_global_id(uint8_t node, uint16_t local_id, uint32_t* global_id);
+void handle_post_snn_start(http_connection_t* conn, bool sync, uint32_t period_us,
+                           uint16_t slot_us, uint16_t guard_us);
 void handle_post_snn_stop(http_connection_t* conn);
-void handle_get_snn_status(http_connection_t* conn);
+void handle_get_snn_status(http_connection_t* conn, uint8_t node, bool reset_timing, bool refresh);
+void handle_post_snn_checkpoint(http_connection_t* conn);
+void handle_post_snn_restore(http_connection_t* conn);
+void handle_get_snn_checkpoint(http_connection_t* conn);
+extern const z1_http_body_sink_t g_snn_batch_sink;    // POST /api/snn/batch (streamed)
+void handle_post_snn_batch_start(http_connection_t* conn);
+void handle_get_snn_batch(http_connection_t* conn);
+void handle_get_snn_batch_results(http_connection_t* conn);
+
+// Backplane Gateway Endpoints
+extern const z1_http_body_sink_t g_gateway_routes_sink;  // POST /api/gateway/routes (streamed)
+void handle_get_gateway(http_connection_t* conn);
+void handle_post_gateway(http_connection_t* conn, const char* query);
+void handle_post_gateway_peer(http_connection_t* conn, const char* query);
+#define Z1_HTTP_EVENTS_MAX   4096       // Events per GET /api/snn/events response (streamed)
+#define Z1_HTTP_EVENTS_BATCH 250        // Events per node request (one raster burst)
+void handle_get_snn_events(http_connection_t* conn, uint16_t count, bool binary);
+
+// Firmware Management Endpoints
+extern const z1_http_body_sink_t g_firmware_batch_sink;  // POST /api/firmware/batch (streamed)
+void handle_firmware_upload(http_connection_t* conn, uint8_t node_id,
+                            const uint8_t* firmware_data, uint32_t firmware_size);
+void handle_firmware_batch(http_connection_t* conn, const uint8_t* node_list,
+                           uint8_t node_count, const uint8_t* firmware_data,
+                           uint32_t firmware_size);
+
+// Diagnostics Endpoints
+#define Z1_HTTP_TRACE_MAX_RECORDS Z1_TRACE_RING_SIZE  // Records per GET /api/trace response (the whole z1_trace.h ring)
+void handle_get_trace(http_connection_t* conn, uint16_t count);
+void handle_post_bench(http_connection_t* conn, const char* query);
 
 // ============================================================================
 // HTTP Response Helpers
@@ -141,33 +240,74 @@ void z1_http_send_json(http_connection_t* conn, uint16_t status_code, const char
 void z1_http_send_error(http_connection_t* conn, uint16_t status_code, const char* message);
 
 /**
- * Send chunked response (for large data)
+ * Streaming response writer
+ *
+ * Serializes a response straight into the socket's W5500 TX buffer with
+ * chunked transfer encoding. Small writes and printf output collect in a
+ * staging area that goes over SPI as one burst; when the TX buffer runs out
+ * of room, what it holds is sent as one chunk and the writer continues in
+ * the space the peer's acknowledgement frees. Memory use does not depend on
+ * the response size.
+ *
+ * After a failed write (peer gone, send timed out) later writes are dropped
+ * and z1_http_stream_end() closes the connection, so the client sees the
+ * response cut short rather than a complete one.
+ */
+#define Z1_HTTP_STREAM_STAGE      256   // Staging bytes; also the longest printf output
+#define Z1_HTTP_STREAM_MIN_ROOM   256   // Free TX bytes a new chunk waits for
+
+typedef struct {
+    http_connection_t* conn;
+    uint16_t chunk_ptr;             // TX pointer of the open chunk's size line
+    uint16_t wr_ptr;                // TX pointer of the next byte
+    uint16_t room;                  // TX buffer bytes still free at wr_ptr
+    uint16_t chunk_length;          // Data bytes in the open chunk
+    uint16_t stage_len;
+    uint32_t total;                 // Body bytes written
+    bool failed;
+    uint8_t stage[Z1_HTTP_STREAM_STAGE];
+} z1_http_stream_t;
+
+/**
+ * Start a streamed response: sends nothing yet, the headers go out with
+ * the first chunk
  * 
+ * @param stream Writer state
  * @param conn Connection structure
  * @param status_code HTTP status code
  * @param content_type Content type
- * @return true if headers sent successfully
+ * @return true if the socket is still connected
  */
-bool z1_http_begin_chunked(http_connection_t* conn, 
-                           uint16_t status_code,
-                           const char* content_type);
+bool z1_http_stream_begin(z1_http_stream_t* stream, http_connection_t* conn,
+                          uint16_t status_code, const char* content_type);
 
 /**
- * Send chunk of data
+ * Append body bytes
  * 
- * @param conn Connection structure
- * @param data Chunk data
- * @param length Chunk length
- * @return true if successful
+ * @param stream Writer state
+ * @param data Body data
+ * @param length Data length
+ * @return true if the stream has not failed
  */
-bool z1_http_send_chunk(http_connection_t* conn, const char* data, uint16_t length);
+bool z1_http_stream_write(z1_http_stream_t* stream, const void* data, uint16_t length);
 
 /**
- * End chunked response
+ * Append formatted body text (at most Z1_HTTP_STREAM_STAGE - 1 characters)
  * 
- * @param conn Connection structure
+ * @param stream Writer state
+ * @param format printf format
+ * @return true if the stream has not failed
+ */
+bool z1_http_stream_printf(z1_http_stream_t* stream, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * Send the last chunk and the terminating zero-length chunk
+ * 
+ * @param stream Writer state
+ * @return true if the whole response went out
  */
-void z1_http_end_chunked(http_connection_t* conn);
+bool z1_http_stream_end(z1_http_stream_t* stream);
 
 // ============================================================================
 // JSON Helper Functions
@@ -334,5 +474,6 @@ extern bool g_snn_running;
 extern char g_snn_network_name[64];
 extern uint32_t g_snn_neuron_count;
 extern uint8_t g_snn_nodes_used;
+extern uint16_t g_snn_node_mask;
 
 #endif // Z1_HTTP_API_H
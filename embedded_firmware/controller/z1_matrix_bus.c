@@ -1,9 +1,15 @@
 #include "z1_matrix_bus.h"
+#include "z1_multiframe.h"
+#include "z1_trace.h"
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
 #include <stdio.h>
 
+#ifdef Z1_BUS_BACKEND_PIO
+#include "z1_bus_pio.h"
+#endif
+
 // Simple Linear Congruential Generator for collision avoidance
 // Uses parameters from Numerical Recipes: a=1664525, c=1013904223, m=2^32
 static uint32_t z1_random_state = 1;
@@ -27,6 +33,7 @@ volatile uint32_t z1_bus_clock_low_us = 50;      // Clock low time for data latc
 volatile uint32_t z1_bus_ack_timeout_ms = 500;   // ACK wait timeout
 volatile uint32_t z1_bus_backoff_base_us = 100;  // Base backoff time for collisions
 volatile uint32_t z1_bus_broadcast_hold_ms = 50; // Time to hold BUSATTN low for broadcast
+volatile uint32_t z1_bus_multicast_settle_us = 100; // Wait after first multicast ACK for the other receivers
 
 // Ping timing configuration (milliseconds) - Global adjustable variables
 volatile uint32_t z1_ping_response_wait_ms = 1500;  // Controller waits 1500ms for responses (nodes now wait 200ms+ before responding)
@@ -70,6 +77,11 @@ void z1_bus_set_all_pins_input(void) {
         gpio_disable_pulls(BUS0_PIN + i);
     }
     
+#ifdef Z1_BUS_BACKEND_PIO
+    // BUSCLK and data lanes belong to PIO; release them via OE override
+    z1_bus_pio_detach();
+#endif
+    
     printf("[Z1 Bus] All pins set to input (listening mode)\n");
 }
 
@@ -86,8 +98,6 @@ void z1_bus_set_address(uint8_t address) {
     gpio_put(BUSSELECT2_PIN, (address >> 2) & 1);
     gpio_put(BUSSELECT3_PIN, (address >> 3) & 1);
     gpio_put(BUSSELECT4_PIN, (address >> 4) & 1);
-    
-    printf("[Z1 Bus] Address set to %d (0x%02X)\n", address, address);
 }
 
 // Set data on the 16-bit data bus
@@ -97,7 +107,6 @@ void z1_bus_set_data(uint16_t data) {
         gpio_set_dir(BUS0_PIN + i, GPIO_OUT);
         gpio_put(BUS0_PIN + i, (data >> i) & 1);
     }
-    printf("[Z1 Bus] Data set to 0x%04X\n", data);
 }
 
 // Read data from the 16-bit data bus
@@ -132,8 +141,6 @@ bool z1_bus_claim_bus(void) {
     for (uint32_t attempt = 0; attempt < max_attempts; attempt++) {
         // Check if BUSATTN is high (bus available)
         if (gpio_get(BUSATTN_PIN)) {
-            printf("[Z1 Bus] Bus available, claiming...\n");
-            
             // Disable interrupt while we're sending to avoid self-triggering
             gpio_set_irq_enabled(BUSATTN_PIN, GPIO_IRQ_EDGE_FALL, false);
             
@@ -145,7 +152,7 @@ bool z1_bus_claim_bus(void) {
             gpio_set_dir(BUSCLK_PIN, GPIO_OUT);
             gpio_put(BUSCLK_PIN, 1);   // Clock high
             
-            printf("[Z1 Bus] ✅ Bus claimed successfully\n");
+            Z1_TRACE(BUS, Z1_TRACE_DEBUG, Z1_EV_BUS_CLAIM, attempt + 1, backoff_us);
             z1_bus_transaction_active = true;
             return true;
         }
@@ -153,20 +160,20 @@ bool z1_bus_claim_bus(void) {
         // Bus busy, exponential backoff with random jitter to prevent synchronized collisions
         uint32_t jitter_us = (z1_random() % (backoff_us / 2 + 1));  // 0 to 50% jitter
         uint32_t total_backoff = backoff_us + jitter_us;
-        printf("[Z1 Bus] Bus busy, attempt %d, backing off %dus (base: %dus, jitter: +%dus)\n", 
-               attempt + 1, total_backoff, backoff_us, jitter_us);
+        Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_BACKOFF, attempt + 1, total_backoff);
         sleep_us(total_backoff);
         backoff_us *= 2;
         if (backoff_us > 10000) backoff_us = 10000; // Max 10ms
     }
     
+    Z1_TRACE(BUS, Z1_TRACE_ERROR, Z1_EV_BUS_CLAIM_FAIL, max_attempts, 0);
     printf("[Z1 Bus] ❌ Failed to claim bus after %d attempts\n", max_attempts);
     return false;
 }
 
 // Release the bus - return all pins to listening state
 void z1_bus_release_bus(void) {
-    printf("[Z1 Bus] Releasing bus\n");
+    Z1_TRACE(BUS, Z1_TRACE_DEBUG, Z1_EV_BUS_RELEASE, 0, 0);
     z1_bus_set_all_pins_input();
     z1_bus_transaction_active = false;
     
@@ -176,54 +183,46 @@ void z1_bus_release_bus(void) {
 
 // Wait for receiver to pull BUSACK low
 bool z1_bus_wait_for_ack(void) {
-    printf("[Z1 Bus] Waiting for ACK (BUSACK to go low)\n");
-    
     absolute_time_t timeout_time = make_timeout_time_ms(z1_bus_ack_timeout_ms);
     uint32_t poll_count = 0;
     
     while (!time_reached(timeout_time)) {
         if (!gpio_get(BUSACK_PIN)) {  // ACK is active low
-            printf("[Z1 Bus] ✅ ACK received after %d polls\n", poll_count);
+            Z1_TRACE(BUS, Z1_TRACE_DEBUG, Z1_EV_BUS_ACK, poll_count, 0);
             return true;
         }
         poll_count++;
-        if (poll_count % 1000 == 0) {
-            printf("[Z1 Bus] Still waiting for ACK... polls=%d\n", poll_count);
-        }
         sleep_us(10);
     }
     
-    printf("[Z1 Bus] ❌ ACK timeout after %d polls\n", poll_count);
+    Z1_TRACE(BUS, Z1_TRACE_ERROR, Z1_EV_BUS_ACK_TIMEOUT, poll_count, 0);
     return false;
 }
 
-// Send a single 16-bit frame with proper clock timing
-void z1_bus_send_frame(uint16_t frame_data, bool is_last_frame) {
-    printf("[Z1 Bus] Sending frame: 0x%04X (last=%s)\n", frame_data, is_last_frame ? "YES" : "NO");
+// Send a single 16-bit frame with proper clock timing (false: not acknowledged)
+bool z1_bus_send_frame(uint16_t frame_data, bool is_last_frame) {
+    Z1_TRACE(BUS, Z1_TRACE_DEBUG, Z1_EV_BUS_FRAME, frame_data, is_last_frame);
     
     // Set data on bus
     z1_bus_set_data(frame_data);
     
     // Wait for ACK from receiver
     if (!z1_bus_wait_for_ack()) {
-        printf("[Z1 Bus] ❌ No ACK for frame 0x%04X\n", frame_data);
-        return;
+        printf("[Z1 Bus] ❌ No ACK for frame 0x%04X\n", frame_data);  // Rare; worth the console time
+        return false;
     }
     
     // Drop clock low - receiver latches data on falling edge
-    printf("[Z1 Bus] Dropping clock LOW for data latch\n");
     gpio_put(BUSCLK_PIN, 0);
     sleep_us(z1_bus_clock_low_us);
     
     if (!is_last_frame) {
         // Bring clock back high for next frame
-        printf("[Z1 Bus] Clock back HIGH (more frames)\n");
         gpio_put(BUSCLK_PIN, 1);
         sleep_us(z1_bus_clock_high_us);
-    } else {
-        // Last frame - keep clock low and data valid until receiver releases BUSACK
-        printf("[Z1 Bus] Clock stays LOW (last frame - waiting for BUSACK release)\n");
     }
+    // Last frame: clock stays low and data valid until receiver releases BUSACK
+    return true;
 }
 
 // Initialize the Z1 Matrix Bus
@@ -245,6 +244,13 @@ bool z1_bus_init(uint8_t node_id) {
     gpio_pull_up(BUSATTN_PIN);  // 330Ω resistor tie-high
     gpio_pull_up(BUSACK_PIN);   // 330Ω resistor tie-high
     
+#ifdef Z1_BUS_BACKEND_PIO
+    if (!z1_bus_pio_init()) {
+        printf("[Z1 Bus] ❌ PIO backend initialization failed\n");
+        return false;
+    }
+#endif
+    
     // Set up interrupt on BUSATTN falling edge
     gpio_set_irq_enabled_with_callback(BUSATTN_PIN, GPIO_IRQ_EDGE_FALL, true, &z1_busattn_irq_handler);
     
@@ -253,6 +259,7 @@ bool z1_bus_init(uint8_t node_id) {
     return true;
 }
 
+#ifndef Z1_BUS_BACKEND_PIO
 // Write command and data to target node
 bool z1_bus_write(uint8_t target_node, uint8_t command, uint8_t data) {
     if (!bus_initialized) {
@@ -260,8 +267,7 @@ bool z1_bus_write(uint8_t target_node, uint8_t command, uint8_t data) {
         return false;
     }
     
-    printf("[Z1 Bus] === STARTING WRITE TRANSACTION ===\n");
-    printf("[Z1 Bus] Target: %d, Command: 0x%02X, Data: 0x%02X\n", target_node, command, data);
+    Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_WRITE, target_node, (command << 8) | data);
     
     // Try to claim the bus
     if (!z1_bus_claim_bus()) {
@@ -271,45 +277,51 @@ bool z1_bus_write(uint8_t target_node, uint8_t command, uint8_t data) {
     // Set target address
     z1_bus_set_address(target_node);
     
-    // Frame 1: Header (0xAA + my_node_id)
+    // Frame 1: Header (0xAA + my_node_id); a receiver that cannot take the
+    // message leaves it unacknowledged
     uint16_t frame1 = (Z1_FRAME_HEADER << 8) | my_node_id;
-    printf("[Z1 Bus] Frame 1: Header 0x%02X + Sender ID %d\n", Z1_FRAME_HEADER, my_node_id);
-    z1_bus_send_frame(frame1, false);  // Not last frame
+    if (!z1_bus_send_frame(frame1, false)) {  // Not last frame
+        z1_bus_release_bus();
+        Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_WRITE_DONE, target_node, 0);
+        return false;
+    }
     
     // Frame 2: Command + Data
     uint16_t frame2 = (command << 8) | data;
-    printf("[Z1 Bus] Frame 2: Command 0x%02X + Data 0x%02X\n", command, data);
     z1_bus_send_frame(frame2, true);   // Last frame - clock stays low
     
     // Keep data valid on bus, wait for receiver to release BUSACK
-    printf("[Z1 Bus] Waiting for receiver to release BUSACK...\n");
     absolute_time_t timeout_time = make_timeout_time_ms(z1_bus_ack_timeout_ms);
     while (!time_reached(timeout_time) && !gpio_get(BUSACK_PIN)) {
         sleep_us(10);
     }
     
-    if (!gpio_get(BUSACK_PIN)) {
+    bool released = gpio_get(BUSACK_PIN);
+    if (!released) {
         printf("[Z1 Bus] ⚠️ Receiver did not release BUSACK\n");
-    } else {
-        printf("[Z1 Bus] ✅ Receiver released BUSACK - transaction complete\n");
     }
     
     // Release the bus
     z1_bus_release_bus();
     
-    printf("[Z1 Bus] === WRITE TRANSACTION COMPLETE ===\n");
+    Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_WRITE_DONE, target_node, released);
     return true;
 }
+#endif // !Z1_BUS_BACKEND_PIO
 
 // Broadcast command to all nodes (no ACK, no clock)
 bool z1_bus_broadcast(uint8_t command, uint8_t data) {
+    return z1_bus_broadcast_us(command, data, z1_bus_broadcast_hold_ms * 1000);
+}
+
+// Broadcast with an explicit hold time
+bool z1_bus_broadcast_us(uint8_t command, uint8_t data, uint32_t hold_us) {
     if (!bus_initialized) {
         printf("[Z1 Bus] ❌ Bus not initialized\n");
         return false;
     }
     
-    printf("[Z1 Bus] === STARTING BROADCAST TRANSACTION ===\n");
-    printf("[Z1 Bus] Command: 0x%02X, Data: 0x%02X (broadcast to all nodes)\n", command, data);
+    Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_BROADCAST, 0, (command << 8) | data);
     
     // Manual bus claiming for broadcast (no normal claim sequence)
     if (!gpio_get(BUSATTN_PIN)) {
@@ -317,7 +329,6 @@ bool z1_bus_broadcast(uint8_t command, uint8_t data) {
         return false;
     }
     
-    printf("[Z1 Bus] Claiming bus for broadcast\n");
     z1_bus_transaction_active = true;
     
     // Disable interrupt while we're transmitting
@@ -333,6 +344,11 @@ bool z1_bus_broadcast(uint8_t command, uint8_t data) {
         gpio_put(BUSSELECT0_PIN + i, (Z1_BROADCAST_ID >> i) & 1);
     }
     
+#ifdef Z1_BUS_BACKEND_PIO
+    // Broadcast is CPU-timed; borrow the data lanes from PIO
+    z1_bus_pio_pins_to_sio();
+#endif
+    
     // Set data bus to output and put command+data
     uint16_t broadcast_data = (command << 8) | data;
     for (int i = 0; i < 16; i++) {
@@ -340,27 +356,355 @@ bool z1_bus_broadcast(uint8_t command, uint8_t data) {
         gpio_put(BUS0_PIN + i, (broadcast_data >> i) & 1);
     }
     
-    printf("[Z1 Bus] BUSATTN=LOW, Address=31, Data=0x%04X, holding for %dms\n", 
-           broadcast_data, z1_bus_broadcast_hold_ms);
-    
     // Hold for configured time
-    sleep_ms(z1_bus_broadcast_hold_ms);
+    sleep_us(hold_us);
     
     // Release BUSATTN (triggers data latch in all nodes)
-    printf("[Z1 Bus] Releasing BUSATTN (data latch trigger)\n");
     gpio_set_dir(BUSATTN_PIN, GPIO_IN);
     gpio_pull_up(BUSATTN_PIN);
     
     // Release all other pins
     z1_bus_set_all_pins_input();
+#ifdef Z1_BUS_BACKEND_PIO
+    z1_bus_pio_pins_to_pio();
+#endif
     z1_bus_transaction_active = false;
     
     // Re-enable interrupt
     gpio_set_irq_enabled(BUSATTN_PIN, GPIO_IRQ_EDGE_FALL, true);
+    return true;
+}
+
+#ifdef Z1_BUS_BACKEND_PIO
+// ============================================================================
+// PIO Backend Transactions
+// ============================================================================
+
+// Claim the bus (same backoff as z1_bus_claim_bus, without per-attempt logging)
+static bool z1_bus_pio_claim(void) {
+    uint32_t backoff_us = z1_bus_backoff_base_us;
+    
+    for (uint32_t attempt = 0; attempt < 10; attempt++) {
+        if (gpio_get(BUSATTN_PIN)) {
+            gpio_set_irq_enabled(BUSATTN_PIN, GPIO_IRQ_EDGE_FALL, false);
+            gpio_set_dir(BUSATTN_PIN, GPIO_OUT);
+            gpio_put(BUSATTN_PIN, 0);
+            z1_bus_transaction_active = true;
+            return true;
+        }
+        
+        uint32_t total_backoff = backoff_us + (z1_random() % (backoff_us / 2 + 1));
+        Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_BACKOFF, attempt + 1, total_backoff);
+        sleep_us(total_backoff);
+        backoff_us *= 2;
+        if (backoff_us > 10000) backoff_us = 10000;
+    }
+    
+    Z1_TRACE(BUS, Z1_TRACE_ERROR, Z1_EV_BUS_CLAIM_FAIL, 10, 0);
+    printf("[Z1 Bus] ❌ Failed to claim bus after 10 attempts\n");
+    return false;
+}
+
+// Release the bus without logging
+static void z1_bus_pio_release(void) {
+    z1_bus_pio_detach();
+    gpio_set_dir_in_masked(0x1Fu << BUSSELECT0_PIN);
+    gpio_set_dir(BUSATTN_PIN, GPIO_IN);
+    gpio_pull_up(BUSATTN_PIN);
+    z1_bus_transaction_active = false;
+    gpio_set_irq_enabled(BUSATTN_PIN, GPIO_IRQ_EDGE_FALL, true);
+}
+
+// Write command and data to target node (PIO handshake, DMA-fed frames)
+bool z1_bus_write(uint8_t target_node, uint8_t command, uint8_t data) {
+    if (!bus_initialized) {
+        printf("[Z1 Bus] ❌ Bus not initialized\n");
+        return false;
+    }
     
-    printf("[Z1 Bus] === BROADCAST TRANSACTION COMPLETE ===\n");
+    Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_WRITE, target_node, (command << 8) | data);
+    if (!z1_bus_pio_claim()) {
+        return false;
+    }
+    
+    // Address lines stay CPU-driven for the whole transaction
+    gpio_put_masked(0x1Fu << BUSSELECT0_PIN, (uint32_t)(target_node & 0x1F) << BUSSELECT0_PIN);
+    gpio_set_dir_out_masked(0x1Fu << BUSSELECT0_PIN);
+    z1_bus_pio_attach();
+    
+    uint16_t frames[Z1_FRAMES_PER_MSG] = {
+        (uint16_t)((Z1_FRAME_HEADER << 8) | my_node_id),
+        (uint16_t)((command << 8) | data)
+    };
+    bool ok = z1_bus_pio_send(frames, Z1_FRAMES_PER_MSG, z1_bus_ack_timeout_ms * 1000);
+    
+    z1_bus_pio_release();
+    
+    Z1_TRACE(BUS, Z1_TRACE_INFO, Z1_EV_BUS_WRITE_DONE, target_node, ok);
+    if (!ok) {
+        printf("[Z1 Bus] ❌ No ACK from node %d (cmd 0x%02X)\n", target_node, command);
+    }
+    return ok;
+}
+#endif // Z1_BUS_BACKEND_PIO
+
+// ============================================================================
+// Burst Transfers
+// ============================================================================
+
+#define Z1_BUS_BURST_CHUNK  256   // Frames staged per send (PIO backend)
+#define Z1_BUS_DRAIN_BYTES  32    // Streamed bytes passed on per received frame (GPIO backend)
+
+// Payload frame i: two bytes, first byte in the low half (matches DMA byte order)
+static inline uint16_t z1_bus_burst_frame(const uint8_t* payload, uint16_t length, uint32_t i) {
+    uint32_t pos = i * 2;
+    uint16_t frame = payload[pos];
+    if (pos + 1 < length) {
+        frame |= (uint16_t)payload[pos + 1] << 8;
+    }
+    return frame;
+}
+
+#ifndef Z1_BUS_BACKEND_PIO
+// Clock one frame without logging (GPIO backend bursts)
+static bool z1_bus_clock_frame(uint16_t frame_data, bool is_last_frame) {
+    gpio_put_masked(0xFFFFu << BUS0_PIN, (uint32_t)frame_data << BUS0_PIN);
+    
+    // Receiver holds BUSACK low for the whole transaction; high means it gave up
+    absolute_time_t timeout_time = make_timeout_time_ms(z1_bus_ack_timeout_ms);
+    while (gpio_get(BUSACK_PIN)) {
+        if (time_reached(timeout_time)) {
+            return false;
+        }
+    }
+    
+    gpio_put(BUSCLK_PIN, 0);
+    sleep_us(z1_bus_clock_low_us);
+    
+    if (!is_last_frame) {
+        gpio_put(BUSCLK_PIN, 1);
+        sleep_us(z1_bus_clock_high_us);
+    }
     return true;
 }
+#endif
+
+// Wait for BUSCLK to reach level (GPIO receive path)
+static bool z1_bus_wait_clock(bool level) {
+    uint32_t timeout_count = 0;
+    while (gpio_get(BUSCLK_PIN) != level) {
+        sleep_us(1);
+        timeout_count++;
+        if (timeout_count > 50000) {  // 50ms timeout
+            return false;
+        }
+    }
+    return true;
+}
+
+// Latch one frame on BUSCLK falling edge, then optionally wait for the rise
+static bool z1_bus_latch_frame(uint16_t* frame, bool wait_rise) {
+    if (!z1_bus_wait_clock(false)) {
+        return false;
+    }
+    *frame = z1_bus_get_data();
+    return !wait_rise || z1_bus_wait_clock(true);
+}
+
+// Hold the destination mask on the data lanes until the addressed nodes are ready
+static bool z1_bus_multicast_setup(uint16_t dest_mask) {
+    gpio_put_masked(0xFFFFu << BUS0_PIN, (uint32_t)dest_mask << BUS0_PIN);
+    gpio_set_dir_out_masked(0xFFFFu << BUS0_PIN);
+    
+    // Receivers read the mask before pulling BUSACK low. BUSACK is wired-AND,
+    // so the first ACK only shows one of them is ready; give the rest time
+    absolute_time_t timeout_time = make_timeout_time_ms(z1_bus_ack_timeout_ms);
+    while (gpio_get(BUSACK_PIN)) {
+        if (time_reached(timeout_time)) {
+            return false;
+        }
+    }
+    sleep_us(z1_bus_multicast_settle_us);
+    return true;
+}
+
+// Burst under one BUSATTN claim; Z1_MULTICAST_ID reaches every node in dest_mask
+static bool z1_bus_burst_transaction(uint8_t address, uint16_t dest_mask, uint8_t command,
+                                     const uint8_t* payload, uint16_t length, uint16_t crc) {
+    uint32_t frame_count = ((uint32_t)length + 1) / 2;
+    uint16_t header[3] = {
+        (uint16_t)((Z1_FRAME_HEADER << 8) | my_node_id),
+        (uint16_t)((Z1_CMD_FRAME_BURST << 8) | command),
+        length
+    };
+    bool ok = true;
+    
+#ifdef Z1_BUS_BACKEND_PIO
+    if (!z1_bus_pio_claim()) {
+        return false;
+    }
+    
+    gpio_put_masked(0x1Fu << BUSSELECT0_PIN, (uint32_t)(address & 0x1F) << BUSSELECT0_PIN);
+    gpio_set_dir_out_masked(0x1Fu << BUSSELECT0_PIN);
+    z1_bus_pio_attach();
+    
+    if (address == Z1_MULTICAST_ID) {
+        // Mask is CPU-driven; PIO keeps BUSCLK high meanwhile
+        z1_bus_pio_pins_to_sio();
+        ok = z1_bus_multicast_setup(dest_mask);
+        gpio_set_dir_in_masked(0xFFFFu << BUS0_PIN);
+        z1_bus_pio_pins_to_pio();
+        z1_bus_pio_attach();
+    }
+    
+    // Stage frames in chunks; each DMA run drains while the next chunk is built
+    uint16_t chunk[Z1_BUS_BURST_CHUNK];
+    uint16_t n = 0;
+    for (int h = 0; h < 3; h++) {
+        chunk[n++] = header[h];
+    }
+    
+    for (uint32_t i = 0; i <= frame_count && ok; i++) {
+        bool last = (i == frame_count);
+        chunk[n++] = last ? crc : z1_bus_burst_frame(payload, length, i);
+        
+        if (n == Z1_BUS_BURST_CHUNK || last) {
+            ok = z1_bus_pio_send_start(chunk, n, last) &&
+                 z1_bus_pio_send_wait(z1_bus_ack_timeout_ms * 1000);
+            n = 0;
+        }
+    }
+    
+    z1_bus_pio_release();
+#else
+    if (!z1_bus_claim_bus()) {
+        return false;
+    }
+    
+    // Receivers sample the address 20 us after the claim
+    gpio_put_masked(0x1Fu << BUSSELECT0_PIN, (uint32_t)(address & 0x1F) << BUSSELECT0_PIN);
+    gpio_set_dir_out_masked(0x1Fu << BUSSELECT0_PIN);
+    gpio_set_dir_out_masked(0xFFFFu << BUS0_PIN);
+    
+    if (address == Z1_MULTICAST_ID) {
+        ok = z1_bus_multicast_setup(dest_mask);
+    }
+    
+    for (int h = 0; h < 3 && ok; h++) {
+        ok = z1_bus_clock_frame(header[h], false);
+    }
+    for (uint32_t i = 0; i < frame_count && ok; i++) {
+        ok = z1_bus_clock_frame(z1_bus_burst_frame(payload, length, i), false);
+    }
+    ok = ok && z1_bus_clock_frame(crc, true);
+    
+    // Keep CRC frame valid until receiver releases BUSACK
+    if (ok) {
+        absolute_time_t timeout_time = make_timeout_time_ms(z1_bus_ack_timeout_ms);
+        while (!time_reached(timeout_time) && !gpio_get(BUSACK_PIN)) {
+            sleep_us(10);
+        }
+    }
+    
+    z1_bus_release_bus();
+#endif
+    
+    return ok;
+}
+
+// Write burst transaction to target node
+bool z1_bus_write_burst(uint8_t target_node, uint8_t command,
+                        const uint8_t* payload, uint16_t length, uint16_t crc) {
+    if (!bus_initialized || !payload || length == 0) {
+        return false;
+    }
+    
+    bool ok = z1_bus_burst_transaction(target_node, 0, command, payload, length, crc);
+    
+    // Old targets NACK bursts; the caller falls back to chunked transfer
+    Z1_TRACE(BUS, Z1_TRACE_INFO, ok ? Z1_EV_BUS_BURST_TX : Z1_EV_BUS_BURST_FAIL, target_node, length);
+    return ok;
+}
+
+// Write burst transaction to every node in dest_mask at once
+bool z1_bus_write_multicast(uint16_t dest_mask, uint8_t command,
+                            const uint8_t* payload, uint16_t length, uint16_t crc) {
+    if (!bus_initialized || !payload || length == 0 || dest_mask == 0) {
+        return false;
+    }
+    
+    bool ok = z1_bus_burst_transaction(Z1_MULTICAST_ID, dest_mask, command, payload, length, crc);
+    
+    Z1_TRACE(BUS, Z1_TRACE_INFO, ok ? Z1_EV_BUS_MCAST_TX : Z1_EV_BUS_MCAST_FAIL, dest_mask, length);
+    return ok;
+}
+
+// Receive burst body after the [FRAME_BURST|command] frame (BUSACK held low)
+static bool z1_bus_receive_burst(uint8_t command) {
+    uint16_t length = 0;
+    uint16_t crc = 0;
+    
+#ifdef Z1_BUS_BACKEND_PIO
+    if (!z1_bus_pio_receive_continue(&length, 1) || !z1_bus_pio_receive_wait(50000)) {
+        return false;
+    }
+    
+    uint16_t frames = 0;
+    uint8_t* dest = z1_multiframe_handle_burst(z1_last_sender_id, command, length, &frames);
+    if (!dest) {
+        return false;
+    }
+    
+    // Data frames land directly in the multiframe buffer (low byte first);
+    // a streamed payload drains one chunk while the next one lands
+    do {
+        if (!z1_bus_pio_receive_continue((uint16_t*)dest, frames)) {
+            return false;
+        }
+        z1_multiframe_rx_drain(0xFFFF);
+        if (!z1_bus_pio_receive_wait(50000 + (uint32_t)frames * 10)) {
+            return false;
+        }
+        dest = z1_multiframe_handle_burst_chunk(&frames);
+    } while (dest);
+    
+    if (!z1_bus_pio_receive_continue(&crc, 1) || !z1_bus_pio_receive_wait(50000)) {
+        return false;
+    }
+#else
+    // The command frame left BUSCLK low; it rises before the length frame
+    if (!z1_bus_wait_clock(true) || !z1_bus_latch_frame(&length, true)) {
+        return false;
+    }
+    
+    uint16_t frames = 0;
+    uint8_t* dest = z1_multiframe_handle_burst(z1_last_sender_id, command, length, &frames);
+    if (!dest) {
+        return false;
+    }
+    
+    do {
+        for (uint32_t i = 0; i < frames; i++) {
+            uint16_t frame;
+            if (!z1_bus_latch_frame(&frame, true)) {
+                return false;
+            }
+            dest[i * 2] = frame & 0xFF;
+            dest[i * 2 + 1] = frame >> 8;
+            
+            // Streamed data drains a little per frame, within the clock high time
+            z1_multiframe_rx_drain(Z1_BUS_DRAIN_BYTES);
+        }
+        dest = z1_multiframe_handle_burst_chunk(&frames);
+    } while (dest);
+    
+    if (!z1_bus_latch_frame(&crc, false)) {
+        return false;
+    }
+#endif
+    
+    return z1_multiframe_handle_burst_end(crc);
+}
 
 // BUSATTN interrupt handler - called when someone claims the bus
 void z1_busattn_irq_handler(uint gpio, uint32_t events) {
@@ -385,9 +729,16 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
     
     // Read address to see if it's for us
     uint8_t target_address = z1_bus_get_address();
+    bool multicast = (target_address == Z1_MULTICAST_ID);
     
-    // Check if message is for us (direct or broadcast)
-    if (target_address != my_node_id && target_address != Z1_BROADCAST_ID) {
+    // Multicast: the destination mask is on the data lanes until the sender clocks
+    if (multicast) {
+        if (my_node_id >= Z1_MAX_NODES || !(z1_bus_get_data() & (1u << my_node_id))) {
+            z1_irq_handler_busy = false;
+            return;
+        }
+    } else if (target_address != my_node_id && target_address != Z1_BROADCAST_ID) {
+        // Not for us (neither direct nor broadcast)
         z1_irq_handler_busy = false;  // Clear busy flag before returning
         return;
     }
@@ -401,20 +752,35 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
             gpio_disable_pulls(BUS0_PIN + i);
         }
         
-        // Wait for BUSATTN to go high (sender releases after hold time)
+        // Wait for BUSATTN to go high (sender releases after hold time),
+        // keeping the last command+data sampled while it was still low:
+        // the sender lets go of the data lanes right after BUSATTN
+        uint16_t received_data = 0;
+        bool latched = false;
         uint32_t timeout_count = 0;
-        while (!gpio_get(BUSATTN_PIN)) {
-            sleep_us(100);
+        while (true) {
+            uint16_t sample = z1_bus_get_data();
+            if (gpio_get(BUSATTN_PIN)) {
+                break;
+            }
+            received_data = sample;
+            latched = true;
+            sleep_us(10);
             timeout_count++;
-            if (timeout_count > 1000) {  // 100ms timeout (2x hold time)
+            if (timeout_count > 10000) {  // 100ms timeout (2x hold time)
                 z1_bus_transaction_active = false;
                 z1_irq_handler_busy = false;
                 return;
             }
         }
         
-        // Latch the 16-bit command+data immediately
-        uint16_t received_data = z1_bus_get_data();
+        // Entered after the hold ended: nothing valid to latch
+        if (!latched) {
+            z1_bus_transaction_active = false;
+            z1_irq_handler_busy = false;
+            return;
+        }
+        
         uint8_t command = (received_data >> 8) & 0xFF;
         uint8_t data_value = received_data & 0xFF;
         
@@ -426,9 +792,35 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
         return;
     }
     
+    // Not acknowledged when the receiver could not queue it: the sender
+    // times out and keeps the message instead of losing it here
+    if (!z1_bus_accept_transaction()) {
+        z1_irq_handler_busy = false;
+        return;
+    }
+    
     // Normal targeted transaction
     z1_bus_transaction_active = true;
     
+    uint8_t command = 0, data_value = 0;
+    
+#ifdef Z1_BUS_BACKEND_PIO
+    // Arm the RX state machine before ACK - the sender clocks as soon as it sees BUSACK low
+    uint16_t frames[Z1_FRAMES_PER_MSG];
+    z1_bus_pio_receive_start(frames, Z1_FRAMES_PER_MSG);
+    
+    gpio_set_dir(BUSACK_PIN, GPIO_OUT);
+    gpio_put(BUSACK_PIN, 0);
+    
+    if (!z1_bus_pio_receive_wait(50000) ||  // 50ms timeout
+        ((frames[0] >> 8) & 0xFF) != Z1_FRAME_HEADER) {
+        goto cleanup;
+    }
+    
+    z1_last_sender_id = frames[0] & 0xFF;
+    command = (frames[1] >> 8) & 0xFF;
+    data_value = frames[1] & 0xFF;
+#else
     // Set data bus pins to INPUT for receiving
     for (int i = 0; i < 16; i++) {
         gpio_set_dir(BUS0_PIN + i, GPIO_IN);
@@ -440,8 +832,6 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
     gpio_put(BUSACK_PIN, 0);
     
     // Receive exactly 2 frames according to protocol
-    uint8_t command = 0, data_value = 0;
-    
     for (int frame = 0; frame < 2; frame++) {
         // Wait for clock to drop (sender drops after we ACK)
         uint32_t timeout_count = 0;
@@ -484,6 +874,20 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
             }
         }
     }
+#endif // Z1_BUS_BACKEND_PIO
+    
+    // Burst: remaining frames follow under the same BUSATTN assertion
+    // (multicast carries nothing else)
+    if (multicast && command != Z1_CMD_FRAME_BURST) {
+        goto cleanup;
+    }
+    if (command == Z1_CMD_FRAME_BURST && !z1_bus_receive_burst(data_value)) {
+        goto cleanup;
+    }
+    
+#ifdef Z1_BUS_BACKEND_PIO
+    z1_bus_pio_receive_stop();
+#endif
     
     // Release BUSACK first to complete the receive transaction
     gpio_set_dir(BUSACK_PIN, GPIO_IN);
@@ -491,6 +895,7 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
     z1_bus_transaction_active = false;
     
     // Now process the command (transaction is complete, node can send responses)
+    Z1_TRACE(BUS, Z1_TRACE_DEBUG, Z1_EV_BUS_RX, z1_last_sender_id, (command << 8) | data_value);
     z1_bus_process_command(command, data_value);
     
     // Clear busy flag
@@ -498,6 +903,10 @@ void z1_busattn_irq_handler(uint gpio, uint32_t events) {
     return;
 
 cleanup:
+#ifdef Z1_BUS_BACKEND_PIO
+    z1_bus_pio_receive_stop();
+#endif
+    
     // Release BUSACK to signal completion
     gpio_set_dir(BUSACK_PIN, GPIO_IN);
     gpio_pull_up(BUSACK_PIN);
@@ -638,6 +1047,23 @@ static bool check_if_node_responded(uint8_t node) {
     return false;
 }
 
+// Ping without waiting; poll z1_bus_ping_answered for the response
+bool z1_bus_ping_start(uint8_t target_node) {
+    // Drop old history for this node so only the new ping can match
+    for (int i = 0; i < Z1_MAX_PING_HISTORY; i++) {
+        if (ping_history[i].target_node == target_node) {
+            ping_history[i].target_node = 0xFF;  // Invalidate entry
+            ping_history[i].active = false;
+        }
+    }
+    return z1_bus_ping_node(target_node);
+}
+
+// Check whether the ping sent by z1_bus_ping_start has been answered
+bool z1_bus_ping_answered(uint8_t target_node) {
+    return check_if_node_responded(target_node);
+}
+
 // Sequential node discovery - pings nodes one at a time with proper delays
 bool z1_discover_nodes_sequential(bool active_nodes_out[16]) {
     if (!bus_initialized) {
@@ -663,16 +1089,8 @@ bool z1_discover_nodes_sequential(bool active_nodes_out[16]) {
     for (uint8_t node = 0; node < 16; node++) {
         printf("[Z1 Discovery] 🏓 Pinging node %d...\n", node);
         
-        // Clear old ping history for this node (invalidate by setting target to 0xFF)
-        for (int i = 0; i < Z1_MAX_PING_HISTORY; i++) {
-            if (ping_history[i].target_node == node) {
-                ping_history[i].target_node = 0xFF;  // Invalidate entry
-                ping_history[i].active = false;
-            }
-        }
-        
-        // Send ping to this node
-        if (!z1_bus_ping_node(node)) {
+        // Send ping to this node (clears its old ping history)
+        if (!z1_bus_ping_start(node)) {
             printf("[Z1 Discovery] ⚠️  Node %d: ping send failed\n", node);
             active_nodes_out[node] = false;
             continue;
@@ -722,6 +1140,11 @@ bool z1_bus_handle_ping_response(uint8_t sender_node, uint8_t data_received) {
 __attribute__((weak)) void z1_bus_process_command(uint8_t command, uint8_t data) {
     printf("[Z1 Bus] WEAK DEFAULT: Command 0x%02X, Data 0x%02X (no application handler)\n", command, data);
 }
+
+// Weak default: every addressed transaction is acknowledged
+__attribute__((weak)) bool z1_bus_accept_transaction(void) {
+    return true;
+}
 
 // ============================================================================
 // SNN Engine Compatibility Layer
@@ -66,6 +66,7 @@ extern volatile uint32_t z1_bus_clock_low_us;    // Clock low time for data latc
 extern volatile uint32_t z1_bus_ack_timeout_ms;  // ACK wait timeout
 extern volatile uint32_t z1_bus_backoff_base_us; // Base backoff time for collisions
 extern volatile uint32_t z1_bus_broadcast_hold_ms; // Time to hold BUSATTN low for broadcast
+extern volatile uint32_t z1_bus_multicast_settle_us; // Wait after first multicast ACK for the other receivers
 
 // Ping timing configuration (milliseconds)
 extern volatile uint32_t z1_ping_response_wait_ms; // Controller waits for responses
@@ -79,10 +80,27 @@ extern volatile bool z1_bus_transaction_active;  // True when transaction in pro
 bool z1_bus_init(uint8_t node_id);
 bool z1_bus_write(uint8_t target_node, uint8_t command, uint8_t data);
 bool z1_bus_broadcast(uint8_t command, uint8_t data);
+
+// Broadcast with an explicit BUSATTN hold, for short periodic broadcasts
+// (timestep ticks) that cannot afford z1_bus_broadcast_hold_ms
+bool z1_bus_broadcast_us(uint8_t command, uint8_t data, uint32_t hold_us);
+
+// Burst: [0xAA|sender] [FRAME_BURST|command] [length] [data...] [crc] under one BUSATTN
+bool z1_bus_write_burst(uint8_t target_node, uint8_t command,
+                        const uint8_t* payload, uint16_t length, uint16_t crc);
+
+// Multicast: burst to Z1_MULTICAST_ID with dest_mask on the data lanes during the
+// claim; every node in dest_mask latches the same frames. BUSACK is wired-AND, so
+// success means at least one destination took part, not that every one did.
+bool z1_bus_write_multicast(uint16_t dest_mask, uint8_t command,
+                            const uint8_t* payload, uint16_t length, uint16_t crc);
+
 void z1_bus_handle_interrupt(void);
 
 // Ping functions
 bool z1_bus_ping_node(uint8_t target_node);
+bool z1_bus_ping_start(uint8_t target_node);     // No wait; poll z1_bus_ping_answered
+bool z1_bus_ping_answered(uint8_t target_node);
 bool z1_bus_ping_all_nodes(void);
 void z1_bus_clear_ping_history(void);
 bool z1_bus_handle_ping_response(uint8_t sender_node, uint8_t data_received);
@@ -93,6 +111,11 @@ bool z1_bus_handle_ping_response(uint8_t sender_node, uint8_t data_received);
 // Callback function - must be implemented by application (node.c)
 extern void z1_bus_process_command(uint8_t command, uint8_t data);
 
+// Receive admission (bus IRQ, before the ACK of a targeted or multicast
+// transaction); false leaves it unacknowledged so the sender sees the
+// failure. The weak default accepts everything.
+extern bool z1_bus_accept_transaction(void);
+
 // ============================================================================
 // SNN Engine Compatibility Layer
 // ============================================================================
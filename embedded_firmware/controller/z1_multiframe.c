@@ -10,11 +10,22 @@
  * 3. Send FRAME_END with checksum
  * 4. Wait for FRAME_ACK/NACK
  * 
+ * Burst mode (preferred, falls back to the above if the target does not
+ * accept it): one bus transaction carrying
+ *   [0xAA|sender] [FRAME_BURST|command] [length] [data x (length+1)/2] [CRC16]
+ * Data frames carry two payload bytes, first byte in the low half.
+ * 
+ * Streaming: payloads of the sink's command are passed on in buffer-half
+ * chunks as they land (see z1_multiframe_sink_t). Bursts alternate halves so
+ * one chunk drains while the next is received; checksum and CRC are
+ * accumulated per chunk.
+ * 
  * Copyright NeuroFab Corp. All rights reserved.
  */
 
 #include "z1_multiframe.h"
 #include "z1_matrix_bus.h"
+#include "z1_trace.h"
 #include "../common/z1_protocol.h"
 #include <string.h>
 #include <stdio.h>
@@ -27,6 +38,35 @@
 static z1_multiframe_tx_t g_tx_state = {0};
 static z1_multiframe_rx_t g_rx_state = {0};
 
+#define Z1_MULTIFRAME_SINK_HEADER_MAX 16
+
+/**
+ * Streaming receive state
+ */
+typedef struct {
+    const z1_multiframe_sink_t* sink;   // Registered sink (NULL: buffer everything)
+    bool streaming;                     // Current transfer goes to the sink
+    bool ok;                            // No sink callback has failed
+    uint16_t chunk_size;                // Bytes per buffer half
+    uint8_t half;                       // Buffer half being received into
+    uint16_t fill;                      // Bytes in that half (chunked path)
+    uint16_t assigned;                  // Payload bytes covered by burst chunks so far
+    uint16_t chunk_bytes;               // Payload bytes of the burst chunk in flight
+    const uint8_t* pending;             // Landed burst chunk not yet drained
+    uint16_t pending_length;
+    uint16_t pending_pos;
+    uint16_t consumed;                  // Payload bytes passed to the sink
+    uint8_t checksum;                   // Running XOR checksum
+    uint16_t crc;                       // Running CRC16
+    uint8_t header[Z1_MULTIFRAME_SINK_HEADER_MAX];
+} z1_multiframe_stream_t;
+
+static z1_multiframe_stream_t g_stream = {0};
+
+// Buffered-transfer admission (z1_multiframe_rx_set_admit())
+static bool (*g_rx_admit)(uint8_t command, uint16_t length) = NULL;
+static uint8_t g_rx_command = 0;            // Command of the chunked transfer in progress
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
@@ -42,6 +82,26 @@ static uint8_t calculate_checksum(const uint8_t* data, uint16_t length) {
     return checksum;
 }
 
+/**
+ * Continue a CRC16-CCITT (poly 0x1021) over more data
+ */
+static uint16_t update_crc16(uint16_t crc, const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * Calculate CRC16-CCITT (poly 0x1021, init 0xFFFF) for burst transfers
+ */
+static uint16_t calculate_crc16(const uint8_t* data, uint16_t length) {
+    return update_crc16(0xFFFF, data, length);
+}
+
 /**
  * Get current time in milliseconds
  */
@@ -68,8 +128,31 @@ bool z1_send_multiframe(uint8_t target_node, uint8_t command,
         return false;
     }
     
-    printf("[Multiframe TX] Sending %d bytes to node %d (cmd 0x%02X)\n", 
-           length, target_node, command);
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_TX, target_node, ((uint32_t)command << 16) | length);
+    
+    // Burst first: one bus claim for the whole payload
+    if (z1_send_multiframe_burst(target_node, command, data, length)) {
+        return true;
+    }
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_TX_FALLBACK, target_node, length);
+    
+    return z1_send_multiframe_chunked(target_node, command, data, length);
+}
+
+/**
+ * Send payload as chunked frames (FRAME_START, length, FRAME_DATA pairs, FRAME_END)
+ * 
+ * @param target_node Target node ID
+ * @param command Command byte
+ * @param data Payload data
+ * @param length Payload length
+ * @return true if every frame was sent
+ */
+bool z1_send_multiframe_chunked(uint8_t target_node, uint8_t command,
+                                const uint8_t* data, uint16_t length) {
+    if (!data || length == 0) {
+        return false;
+    }
     
     // Initialize transfer state
     g_tx_state.active = true;
@@ -130,10 +213,6 @@ bool z1_send_multiframe(uint8_t target_node, uint8_t command,
         offset += chunk_size;
         g_tx_state.sequence++;
         g_tx_state.bytes_sent = offset;
-        
-        if (offset % 64 == 0) {
-            printf("[Multiframe TX] Progress: %d/%d bytes\n", offset, length);
-        }
     }
     
     // Calculate checksum
@@ -146,13 +225,200 @@ bool z1_send_multiframe(uint8_t target_node, uint8_t command,
         return false;
     }
     
-    printf("[Multiframe TX] ✅ Complete: %d bytes sent (checksum 0x%02X)\n", 
-           length, checksum);
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_TX_DONE, target_node, length);
     
     g_tx_state.active = false;
     return true;
 }
 
+/**
+ * Send payload as a single burst transaction
+ * 
+ * @param target_node Target node ID
+ * @param command Command byte
+ * @param data Payload data
+ * @param length Payload length
+ * @return true if the target accepted every frame
+ */
+bool z1_send_multiframe_burst(uint8_t target_node, uint8_t command,
+                              const uint8_t* data, uint16_t length) {
+    if (!data || length == 0) {
+        return false;
+    }
+    
+    uint32_t start_ms = get_time_ms();
+    uint16_t crc = calculate_crc16(data, length);
+    
+    if (!z1_bus_write_burst(target_node, command, data, length, crc)) {
+        return false;
+    }
+    
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_TX_BURST, target_node, get_time_ms() - start_ms);
+    return true;
+}
+
+/**
+ * Send payload to several nodes in one multicast burst
+ * 
+ * @param dest_mask Destination node mask (nodes 0-15)
+ * @param command Command byte
+ * @param data Payload data
+ * @param length Payload length
+ * @return true if at least one destination took the transfer
+ */
+bool z1_send_multicast(uint16_t dest_mask, uint8_t command,
+                       const uint8_t* data, uint16_t length) {
+    if (!data || length == 0 || dest_mask == 0) {
+        return false;
+    }
+    
+    uint16_t crc = calculate_crc16(data, length);
+    return z1_bus_write_multicast(dest_mask, command, data, length, crc);
+}
+
+// ============================================================================
+// Streaming Receive
+// ============================================================================
+
+/**
+ * Close the current streamed transfer
+ */
+static void stream_finish(bool ok) {
+    if (!g_stream.streaming) {
+        return;
+    }
+    
+    g_stream.streaming = false;
+    g_stream.pending = NULL;
+    if (g_stream.consumed < g_stream.sink->header_size) {
+        ok = false;  // Header never completed
+    }
+    g_stream.sink->end(ok && g_stream.ok);
+}
+
+/**
+ * Decide whether a new transfer streams, closing any abandoned one
+ */
+static bool stream_start(uint8_t command) {
+    stream_finish(false);
+    
+    if (!g_stream.sink || g_stream.sink->command != command) {
+        return false;
+    }
+    
+    g_stream.streaming = true;
+    g_stream.ok = true;
+    g_stream.half = 0;
+    g_stream.fill = 0;
+    g_stream.assigned = 0;
+    g_stream.chunk_bytes = 0;
+    g_stream.pending = NULL;
+    g_stream.consumed = 0;
+    g_stream.checksum = 0;
+    g_stream.crc = 0xFFFF;
+    return true;
+}
+
+/**
+ * Pass payload bytes to the sink (header to begin(), the rest to write())
+ */
+static void stream_consume(const uint8_t* data, uint16_t length) {
+    const z1_multiframe_sink_t* sink = g_stream.sink;
+    
+    g_stream.checksum ^= calculate_checksum(data, length);
+    g_stream.crc = update_crc16(g_stream.crc, data, length);
+    
+    while (length > 0 && g_stream.consumed < sink->header_size) {
+        g_stream.header[g_stream.consumed++] = *data++;
+        length--;
+        if (g_stream.consumed == sink->header_size && g_stream.ok) {
+            g_stream.ok = sink->begin(g_stream.header,
+                                      g_rx_state.total_length - sink->header_size);
+        }
+    }
+    
+    // After a failure the rest of the transfer is received and dropped
+    if (length > 0 && g_stream.ok) {
+        g_stream.ok = sink->write(data, length);
+    }
+    g_stream.consumed += length;
+}
+
+/**
+ * Store one chunked-path byte, passing the half on once it is full
+ */
+static void stream_store(uint8_t byte) {
+    if (g_rx_state.bytes_received >= g_rx_state.total_length) {
+        return;
+    }
+    
+    uint8_t* chunk = g_rx_state.buffer + g_stream.half * g_stream.chunk_size;
+    chunk[g_stream.fill++] = byte;
+    g_rx_state.bytes_received++;
+    
+    if (g_stream.fill == g_stream.chunk_size ||
+        g_rx_state.bytes_received == g_rx_state.total_length) {
+        stream_consume(chunk, g_stream.fill);
+        g_stream.half ^= 1;
+        g_stream.fill = 0;
+    }
+}
+
+/**
+ * Set up the next burst chunk and return its destination
+ */
+static uint8_t* stream_next_chunk(uint16_t* frames) {
+    uint16_t remaining = g_rx_state.total_length - g_stream.assigned;
+    g_stream.chunk_bytes = (remaining < g_stream.chunk_size) ? remaining : g_stream.chunk_size;
+    g_stream.assigned += g_stream.chunk_bytes;
+    *frames = (uint16_t)(((uint32_t)g_stream.chunk_bytes + 1) / 2);
+    return g_rx_state.buffer + g_stream.half * g_stream.chunk_size;
+}
+
+/**
+ * Stream one command's payloads to a sink
+ */
+bool z1_multiframe_rx_set_sink(const z1_multiframe_sink_t* sink) {
+    if (sink && (!sink->begin || !sink->write || !sink->end || sink->header_size == 0 ||
+                 sink->header_size > Z1_MULTIFRAME_SINK_HEADER_MAX)) {
+        return false;
+    }
+    
+    stream_finish(false);
+    g_stream.sink = sink;
+    return true;
+}
+
+/**
+ * Set the buffered-transfer admission check
+ */
+void z1_multiframe_rx_set_admit(bool (*admit)(uint8_t command, uint16_t length)) {
+    g_rx_admit = admit;
+}
+
+/**
+ * Hand landed burst data to the sink
+ * 
+ * Called by the bus receive path while the next chunk is in flight; at most
+ * max_bytes are passed on per call so it fits between bit-banged frames.
+ */
+void z1_multiframe_rx_drain(uint16_t max_bytes) {
+    if (!g_stream.streaming || !g_stream.pending) {
+        return;
+    }
+    
+    uint16_t n = g_stream.pending_length - g_stream.pending_pos;
+    if (n > max_bytes) {
+        n = max_bytes;
+    }
+    stream_consume(g_stream.pending + g_stream.pending_pos, n);
+    g_stream.pending_pos += n;
+    
+    if (g_stream.pending_pos == g_stream.pending_length) {
+        g_stream.pending = NULL;
+    }
+}
+
 // ============================================================================
 // Multi-Frame Receive
 // ============================================================================
@@ -169,6 +435,9 @@ bool z1_multiframe_rx_init(uint8_t* buffer, uint16_t buffer_size) {
     g_rx_state.buffer_size = buffer_size;
     g_rx_state.active = false;
     
+    // Streamed chunks use the buffer as two even-sized halves
+    g_stream.chunk_size = (buffer_size / 2) & ~1u;
+    
     return true;
 }
 
@@ -185,13 +454,14 @@ bool z1_multiframe_handle_start(uint8_t source_node, uint8_t command) {
     g_rx_state.sequence = 0;
     g_rx_state.bytes_received = 0;
     g_rx_state.start_time_ms = get_time_ms();
+    g_rx_state.expect = 1;  // Length transaction follows
+    g_rx_command = command;
+    stream_start(command);
     
     // Command byte is passed as parameter
     // Length will come in next frame
     
-    printf("[Multiframe RX] Started from node %d (cmd 0x%02X)\n", 
-           source_node, command);
-    
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_RX_START, source_node, command);
     return true;
 }
 
@@ -205,14 +475,19 @@ bool z1_multiframe_handle_length(uint8_t length_high, uint8_t length_low) {
     
     g_rx_state.total_length = (length_high << 8) | length_low;
     
-    if (g_rx_state.total_length > g_rx_state.buffer_size) {
+    if (!g_stream.streaming && g_rx_state.total_length > g_rx_state.buffer_size) {
         printf("[Multiframe RX] Error: Payload too large (%d > %d)\n",
                g_rx_state.total_length, g_rx_state.buffer_size);
         g_rx_state.active = false;
         return false;
     }
     
-    printf("[Multiframe RX] Expecting %d bytes\n", g_rx_state.total_length);
+    if (!g_stream.streaming && g_rx_admit && !g_rx_admit(g_rx_command, g_rx_state.total_length)) {
+        g_rx_state.active = false;
+        return false;
+    }
+    
+    Z1_TRACE(FRAME, Z1_TRACE_DEBUG, Z1_EV_FRAME_RX_LENGTH, 0, g_rx_state.total_length);
     return true;
 }
 
@@ -240,11 +515,16 @@ bool z1_multiframe_handle_data(uint8_t sequence, uint8_t byte1, uint8_t byte2) {
     }
     
     // Store data bytes
-    if (g_rx_state.bytes_received < g_rx_state.total_length) {
-        g_rx_state.buffer[g_rx_state.bytes_received++] = byte1;
-    }
-    if (g_rx_state.bytes_received < g_rx_state.total_length) {
-        g_rx_state.buffer[g_rx_state.bytes_received++] = byte2;
+    if (g_stream.streaming) {
+        stream_store(byte1);
+        stream_store(byte2);
+    } else {
+        if (g_rx_state.bytes_received < g_rx_state.total_length) {
+            g_rx_state.buffer[g_rx_state.bytes_received++] = byte1;
+        }
+        if (g_rx_state.bytes_received < g_rx_state.total_length) {
+            g_rx_state.buffer[g_rx_state.bytes_received++] = byte2;
+        }
     }
     
     g_rx_state.sequence++;
@@ -265,27 +545,171 @@ bool z1_multiframe_handle_end(uint8_t checksum_received) {
         printf("[Multiframe RX] Incomplete: %d/%d bytes\n",
                g_rx_state.bytes_received, g_rx_state.total_length);
         g_rx_state.active = false;
+        stream_finish(false);
         return false;
     }
     
     // Verify checksum
-    uint8_t checksum_calculated = calculate_checksum(g_rx_state.buffer, 
-                                                      g_rx_state.total_length);
+    uint8_t checksum_calculated = g_stream.streaming ? g_stream.checksum :
+                                  calculate_checksum(g_rx_state.buffer, g_rx_state.total_length);
     
     if (checksum_calculated != checksum_received) {
         printf("[Multiframe RX] Checksum error: expected 0x%02X, got 0x%02X\n",
                checksum_calculated, checksum_received);
         g_rx_state.active = false;
+        stream_finish(false);
         return false;
     }
     
-    printf("[Multiframe RX] ✅ Complete: %d bytes received\n", 
-           g_rx_state.bytes_received);
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_RX_DONE, g_rx_state.source_node,
+             g_rx_state.bytes_received);
+    
+    g_rx_state.active = false;
+    if (g_stream.streaming) {
+        // Already delivered to the sink; nothing left for the command handler
+        g_rx_state.bytes_received = 0;
+        stream_finish(true);
+    }
+    return true;
+}
+
+/**
+ * Handle start of burst transfer
+ * 
+ * Called from the bus receive path once the length frame is latched.
+ * Data frames are written straight into the returned buffer; odd lengths
+ * write one pad byte, so the rounded-up length must fit. Streamed payloads
+ * arrive one buffer half at a time.
+ * 
+ * @param frames Set to the number of frames to receive into the buffer
+ * @return Destination, or NULL if the transfer cannot be accepted
+ */
+uint8_t* z1_multiframe_handle_burst(uint8_t source_node, uint8_t command, uint16_t length,
+                                    uint16_t* frames) {
+    uint32_t padded = ((uint32_t)length + 1) & ~1u;
+    bool streaming = g_rx_state.buffer && stream_start(command);
+    
+    if (!g_rx_state.buffer || length == 0 ||
+        (!streaming && padded > g_rx_state.buffer_size) ||
+        (!streaming && g_rx_admit && !g_rx_admit(command, length)) ||
+        (streaming && g_stream.chunk_size == 0)) {
+        g_rx_state.active = false;
+        stream_finish(false);
+        return NULL;
+    }
+    
+    g_rx_state.active = true;
+    g_rx_state.source_node = source_node;
+    g_rx_state.total_length = length;
+    g_rx_state.bytes_received = 0;
+    g_rx_state.start_time_ms = get_time_ms();
+    g_rx_state.expect = 0;
+    
+    if (streaming) {
+        return stream_next_chunk(frames);
+    }
+    
+    *frames = (uint16_t)(padded / 2);
+    return g_rx_state.buffer;
+}
+
+/**
+ * Handle a landed burst chunk
+ * 
+ * The chunk becomes pending for z1_multiframe_rx_drain() and the other
+ * buffer half is returned for the next one, so the bus can re-arm at once.
+ * 
+ * @param frames Set to the number of frames for the next chunk
+ * @return Next destination, or NULL once the whole payload has been received
+ */
+uint8_t* z1_multiframe_handle_burst_chunk(uint16_t* frames) {
+    if (!g_rx_state.active || !g_stream.streaming) {
+        return NULL;
+    }
+    
+    // The half about to be reused must be fully drained
+    z1_multiframe_rx_drain(0xFFFF);
+    
+    g_stream.pending = g_rx_state.buffer + g_stream.half * g_stream.chunk_size;
+    g_stream.pending_length = g_stream.chunk_bytes;
+    g_stream.pending_pos = 0;
+    
+    if (g_stream.assigned >= g_rx_state.total_length) {
+        return NULL;
+    }
+    
+    g_stream.half ^= 1;
+    return stream_next_chunk(frames);
+}
+
+/**
+ * Handle end of burst transfer
+ */
+bool z1_multiframe_handle_burst_end(uint16_t crc_received) {
+    if (!g_rx_state.active) {
+        return false;
+    }
     
     g_rx_state.active = false;
+    
+    if (g_stream.streaming) {
+        z1_multiframe_rx_drain(0xFFFF);
+        bool ok = g_stream.consumed == g_rx_state.total_length && g_stream.crc == crc_received;
+        g_rx_state.bytes_received = 0;  // Delivered to the sink, not the buffer
+        stream_finish(ok);  // Sink errors are reported by end(), not as a bus failure
+        Z1_TRACE(FRAME, Z1_TRACE_INFO, ok ? Z1_EV_FRAME_RX_DONE : Z1_EV_FRAME_RX_ERROR,
+                 g_rx_state.source_node, g_stream.consumed);
+        return ok;
+    }
+    
+    uint16_t crc_calculated = calculate_crc16(g_rx_state.buffer, g_rx_state.total_length);
+    if (crc_calculated != crc_received) {
+        Z1_TRACE(FRAME, Z1_TRACE_ERROR, Z1_EV_FRAME_RX_ERROR, g_rx_state.source_node,
+                 g_rx_state.total_length);
+        g_rx_state.bytes_received = 0;
+        return false;
+    }
+    
+    g_rx_state.bytes_received = g_rx_state.total_length;
+    Z1_TRACE(FRAME, Z1_TRACE_INFO, Z1_EV_FRAME_RX_DONE, g_rx_state.source_node,
+             g_rx_state.total_length);
     return true;
 }
 
+/**
+ * Feed a received bus transaction into the receive state machine
+ * 
+ * The length and data-byte transactions carry raw payload in the command
+ * and data fields, so they must be routed here before normal command
+ * dispatch.
+ */
+bool z1_multiframe_rx_feed(uint8_t command, uint8_t data) {
+    if (!g_rx_state.active) {
+        return false;
+    }
+    
+    uint8_t expect = g_rx_state.expect;
+    g_rx_state.expect = 0;
+    
+    if (expect == 1) {
+        z1_multiframe_handle_length(command, data);
+        return true;
+    }
+    
+    if (expect == 2) {
+        z1_multiframe_handle_data(g_rx_state.pending_sequence, command, data);
+        return true;
+    }
+    
+    if (command == Z1_CMD_FRAME_DATA) {
+        g_rx_state.pending_sequence = data;
+        g_rx_state.expect = 2;  // Data bytes follow
+        return true;
+    }
+    
+    return false;
+}
+
 /**
  * Check if receive is complete
  */
@@ -304,6 +728,8 @@ uint16_t z1_multiframe_rx_length(void) {
  * Reset receive state
  */
 void z1_multiframe_rx_reset(void) {
+    stream_finish(false);
     g_rx_state.active = false;
+    g_rx_state.expect = 0;
     g_rx_state.bytes_received = 0;
 }
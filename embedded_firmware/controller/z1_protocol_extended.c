@@ -9,9 +9,270 @@
 #include "z1_protocol_extended.h"
 #include "z1_matrix_bus.h"
 #include "z1_multiframe.h"
+#include "z1_gateway.h"
+#include "z1_trace.h"
+#include "pico/stdlib.h"
 #include <string.h>
 #include <stdio.h>
 
+// ============================================================================
+// Response Receive
+// ============================================================================
+
+// Largest node response (a full Z1_CMD_SNN_GET_SPIKES read: 16 + 1000 x 4 bytes)
+#define Z1_RESPONSE_BUFFER_SIZE 4096
+
+static uint8_t g_response_buffer[Z1_RESPONSE_BUFFER_SIZE] __attribute__((aligned(4)));  // Burst DMA target
+static bool g_response_rx_ready = false;
+static uint8_t g_rx_command = 0;                // Command of the transfer being received
+static bool g_rx_refused = false;               // Transfer being received is ignored
+static uint8_t g_response_command = 0;          // Command of the completed response
+static volatile uint8_t g_response_source = 0;
+static volatile bool g_response_complete = false;
+
+// Timestep barrier: STEP_DONE reports arrive in the bus IRQ
+typedef struct {
+    bool active;
+    bool tick_pending;            // Release of step failed (bus busy), retry
+    uint16_t node_mask;
+    uint32_t period_us;
+    uint16_t slot_us;             // TDMA slot length, 0 without a schedule
+    uint32_t timeout_us;          // Report wait before a repeated tick
+    uint32_t step;                // Last step released
+    uint32_t step_limit;          // Last step to release (0 = no limit)
+    volatile uint16_t done_mask;  // Nodes that reported step
+    volatile uint8_t last_node;   // Most recent reporter of step
+    uint32_t released_us;         // First tick of step
+    uint32_t sent_us;             // Last tick of step (first or repeat)
+    uint32_t steps_done;
+    uint32_t retries;
+    uint32_t last_step_us;
+    uint32_t max_step_us;
+    uint64_t total_step_us;
+    uint8_t slowest_node;
+} z1_snn_barrier_t;
+
+static z1_snn_barrier_t g_barrier;
+
+// Memory read-back: MEM_READ_DATA blocks are streamed by the bus receive
+// path into a ring that holds the node's whole window
+#define MEM_READ_RING_SIZE (Z1_MEM_READ_WINDOW * Z1_MEM_READ_BLOCK)
+
+typedef struct {
+    bool active;
+    uint8_t node;
+    uint32_t length;
+    uint32_t taken;                 // Bytes handed to the reader
+    uint32_t block_fill;            // Bytes of the block being received
+    volatile uint32_t received;     // Bytes of complete, checked blocks
+    volatile bool failed;           // Invalid range or a corrupt block
+    uint8_t ring[MEM_READ_RING_SIZE];
+} z1_mem_read_state_t;
+
+static z1_mem_read_state_t g_mem_read;
+
+// MEM_READ_DATA [offset:4]: only the next block of the current read is taken
+static bool mem_read_begin(const uint8_t* header, uint16_t length) {
+    uint32_t offset;
+    memcpy(&offset, header, 4);
+    
+    if (!g_mem_read.active || z1_last_sender_id != g_mem_read.node) {
+        return false;
+    }
+    if (offset == Z1_MEM_READ_INVALID) {
+        g_mem_read.failed = true;
+        return false;
+    }
+    
+    // Blocks come in order and the window keeps them within the ring
+    if (offset != g_mem_read.received || length > Z1_MEM_READ_BLOCK ||
+        offset + length > g_mem_read.length) {
+        return false;
+    }
+    g_mem_read.block_fill = 0;
+    return true;
+}
+
+static bool mem_read_write(const uint8_t* data, uint16_t length) {
+    uint32_t pos = (g_mem_read.received + g_mem_read.block_fill) % MEM_READ_RING_SIZE;
+    memcpy(g_mem_read.ring + pos, data, length);
+    g_mem_read.block_fill += length;
+    return true;
+}
+
+// A block only counts once its checksum matched; a bad one ends the read
+static void mem_read_end(bool ok) {
+    if (!g_mem_read.active) {
+        return;
+    }
+    if (ok) {
+        g_mem_read.received += g_mem_read.block_fill;
+    } else if (g_mem_read.block_fill > 0) {
+        g_mem_read.failed = true;
+    }
+    g_mem_read.block_fill = 0;
+}
+
+static const z1_multiframe_sink_t g_mem_read_sink = {
+    .command = Z1_CMD_MEM_READ_DATA,
+    .header_size = 4,
+    .begin = mem_read_begin,
+    .write = mem_read_write,
+    .end = mem_read_end,
+};
+
+// Node spike batches for the gateway share the response buffer: refused
+// while a response waits there or the gateway queue is full (the node
+// keeps the batch and sends it again)
+static bool response_admit(uint8_t command, uint16_t length) {
+    if (command != Z1_CMD_SNN_SPIKE_BATCH) {
+        return true;
+    }
+    return !g_response_complete && z1_gateway_bus_room(length);
+}
+
+/**
+ * Prepare the receive path for node responses
+ */
+bool z1_protocol_init(void) {
+    g_response_rx_ready = z1_multiframe_rx_init(g_response_buffer, sizeof(g_response_buffer)) &&
+                          z1_multiframe_rx_set_sink(&g_mem_read_sink);
+    z1_multiframe_rx_set_admit(response_admit);
+    return g_response_rx_ready;
+}
+
+// Publish a finished transfer to the waiting z1_bus_request(), or hand a
+// spike batch to the gateway
+static void response_received(uint8_t command) {
+    if (!z1_multiframe_rx_complete()) {
+        return;
+    }
+    if (command == Z1_CMD_SNN_SPIKE_BATCH) {
+        z1_gateway_bus_batch(g_response_buffer, z1_multiframe_rx_length());
+        z1_multiframe_rx_reset();
+        return;
+    }
+    g_response_command = command;
+    g_response_source = z1_last_sender_id;
+    g_response_complete = true;
+}
+
+// Count a node's STEP_DONE towards the current barrier step
+static void step_done_received(uint8_t node, uint8_t step_lo) {
+    if (!g_barrier.active || node >= Z1_MAX_NODES || step_lo != (uint8_t)g_barrier.step) {
+        return;
+    }
+    g_barrier.done_mask |= (1u << node) & g_barrier.node_mask;
+    g_barrier.last_node = node;
+}
+
+// Count a node's TDMA SLOT_DONE marker (4-bit step) as its STEP_DONE
+static void slot_done_received(uint8_t data) {
+    uint8_t node = data >> 4;
+    if (g_barrier.active && g_barrier.slot_us && (data & 0x0F) == (g_barrier.step & 0x0F)) {
+        step_done_received(node, (uint8_t)g_barrier.step);
+    }
+}
+
+/**
+ * Handle a command addressed to the controller (bus IRQ context)
+ *
+ * Overrides the weak default in z1_matrix_bus.c. Nodes send ping replies,
+ * multi-frame responses, barrier STEP_DONE reports and spike batches for
+ * the gateway to the controller.
+ */
+void z1_bus_process_command(uint8_t command, uint8_t data) {
+    // Length and data-byte transactions of an active multi-frame transfer
+    if (z1_multiframe_rx_feed(command, data)) {
+        return;
+    }
+    
+    Z1_TRACE(APP, Z1_TRACE_INFO, Z1_EV_APP_COMMAND, z1_last_sender_id, (command << 8) | data);
+    
+    switch (command) {
+        case Z1_CMD_PING:
+            z1_bus_handle_ping_response(z1_last_sender_id, data);
+            break;
+            
+        case Z1_CMD_FRAME_START:
+            // A spike batch would overwrite a response not yet taken
+            g_rx_command = data;
+            g_rx_refused = (data == Z1_CMD_SNN_SPIKE_BATCH && g_response_complete);
+            if (g_rx_refused) {
+                break;
+            }
+            if (data != Z1_CMD_SNN_SPIKE_BATCH) {
+                g_response_complete = false;
+            }
+            z1_multiframe_handle_start(z1_last_sender_id, data);
+            break;
+            
+        case Z1_CMD_FRAME_END:
+            if (!g_rx_refused) {
+                z1_multiframe_handle_end(data);
+                response_received(g_rx_command);
+            }
+            break;
+            
+        case Z1_CMD_FRAME_BURST:
+            // Payload already received and CRC-checked by the bus receive path
+            response_received(data);
+            break;
+            
+        case Z1_CMD_SNN_STEP_DONE:
+            step_done_received(z1_last_sender_id, data);
+            break;
+            
+        case Z1_CMD_SNN_SLOT_DONE:
+            slot_done_received(data);
+            break;
+            
+        default:
+            break;
+    }
+}
+
+/**
+ * Send a command and wait for the node's multi-frame response
+ */
+int z1_bus_request(uint8_t node_id, uint8_t command, const uint8_t* data, uint16_t length,
+                   uint8_t* response, uint16_t response_size, uint32_t timeout_ms) {
+    if (!g_response_rx_ready) {
+        printf("[Z1 Protocol] ERROR: Response path not initialized\n");
+        return -1;
+    }
+    
+    g_response_complete = false;
+    z1_multiframe_rx_reset();
+    
+    if (!z1_bus_send_command(node_id, command, data, length)) {
+        return -1;
+    }
+    
+    uint32_t start_ms = to_ms_since_boot(get_absolute_time());
+    while (!(g_response_complete && g_response_command == command && g_response_source == node_id)) {
+        if (to_ms_since_boot(get_absolute_time()) - start_ms >= timeout_ms) {
+            printf("[Z1 Protocol] Node %d: no response to command 0x%02X\n", node_id, command);
+            return -1;
+        }
+        sleep_ms(1);
+    }
+    
+    uint16_t received = z1_multiframe_rx_length();
+    if (received > response_size) {
+        received = response_size;
+    }
+    memcpy(response, g_response_buffer, received);
+    
+    g_response_complete = false;
+    z1_multiframe_rx_reset();
+    return received;
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
 /**
  * Send command with multi-byte payload to a node
  * 
@@ -38,23 +299,152 @@ bool z1_bus_send_command(uint8_t target_node, uint8_t command,
 // z1_send_multiframe and z1_receive_multiframe are implemented in z1_multiframe.c
 
 /**
- * Read memory from remote node (stub implementation)
+ * Start streaming a node memory range back
+ */
+bool z1_mem_read_begin(uint8_t node_id, uint32_t addr, uint32_t length) {
+    z1_mem_read_req_t req = { .addr = addr, .length = length };
+    
+    z1_mem_read_end();
+    if (length == 0) {
+        return false;
+    }
+    
+    g_mem_read.node = node_id;
+    g_mem_read.length = length;
+    g_mem_read.taken = 0;
+    g_mem_read.block_fill = 0;
+    g_mem_read.received = 0;
+    g_mem_read.failed = false;
+    g_mem_read.active = true;
+    
+    if (!z1_bus_send_command(node_id, Z1_CMD_MEM_READ_REQ, (const uint8_t*)&req, sizeof(req))) {
+        g_mem_read.active = false;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Take the next bytes of a streamed read as they arrive
+ */
+int z1_mem_read_next(uint8_t* buffer, uint16_t size, uint32_t timeout_ms) {
+    if (!g_mem_read.active) {
+        return -1;
+    }
+    if (g_mem_read.taken >= g_mem_read.length) {
+        return 0;
+    }
+    
+    uint32_t start_ms = to_ms_since_boot(get_absolute_time());
+    while (g_mem_read.received == g_mem_read.taken) {
+        if (g_mem_read.failed ||
+            to_ms_since_boot(get_absolute_time()) - start_ms >= timeout_ms) {
+            printf("[Z1 Protocol] Node %d: memory read failed at %u of %u bytes\n",
+                   g_mem_read.node, (unsigned int)g_mem_read.taken,
+                   (unsigned int)g_mem_read.length);
+            return -1;
+        }
+        sleep_us(50);
+    }
+    
+    // Copy up to the end of the ring; the rest comes with the next call
+    uint32_t pos = g_mem_read.taken % MEM_READ_RING_SIZE;
+    uint32_t n = g_mem_read.received - g_mem_read.taken;
+    if (n > MEM_READ_RING_SIZE - pos) n = MEM_READ_RING_SIZE - pos;
+    if (n > size) n = size;
+    memcpy(buffer, g_mem_read.ring + pos, n);
+    
+    // Acknowledge whole blocks as they are taken so the node sends further
+    uint32_t blocks_before = g_mem_read.taken / Z1_MEM_READ_BLOCK;
+    g_mem_read.taken += n;
+    uint32_t blocks = g_mem_read.taken / Z1_MEM_READ_BLOCK;
+    if (g_mem_read.taken == g_mem_read.length) {
+        blocks = (g_mem_read.length + Z1_MEM_READ_BLOCK - 1) / Z1_MEM_READ_BLOCK;
+    }
+    if (blocks != blocks_before) {
+        z1_bus_write(g_mem_read.node, Z1_CMD_MEM_READ_ACK, (uint8_t)blocks);
+    }
+    return (int)n;
+}
+
+/**
+ * Finish a streamed read, cancelling it on the node if it is not complete
+ */
+void z1_mem_read_end(void) {
+    if (g_mem_read.active && g_mem_read.taken < g_mem_read.length) {
+        z1_mem_read_req_t cancel = { .addr = 0, .length = 0 };
+        z1_bus_send_command(g_mem_read.node, Z1_CMD_MEM_READ_REQ,
+                            (const uint8_t*)&cancel, sizeof(cancel));
+    }
+    g_mem_read.active = false;
+}
+
+/**
+ * Read memory from remote node
  */
 int z1_read_node_memory(uint8_t node_id, uint32_t address, 
                         uint8_t* buffer, uint16_t length) {
-    // TODO: Implement memory read protocol
-    printf("[Z1 Protocol] Memory read not yet implemented\n");
-    return -1;
+    if (!z1_mem_read_begin(node_id, address, length)) {
+        return -1;
+    }
+    
+    uint16_t total = 0;
+    while (total < length) {
+        int n = z1_mem_read_next(buffer + total, length - total, Z1_MEM_READ_NEXT_TIMEOUT_MS);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+    z1_mem_read_end();
+    return (total == length) ? total : -1;
+}
+
+/**
+ * Read the chunk hashes (Z1_MEM_HASH_CHUNK bytes each) of a node memory range
+ *
+ * @param node_id Node to query
+ * @param addr Host address of the range
+ * @param length Range length in bytes
+ * @param hashes Receives one z1_hash32() per chunk
+ * @param max_hashes Array capacity
+ * @return Hashes received, or -1 if the node did not answer
+ */
+int z1_query_mem_hashes(uint8_t node_id, uint32_t addr, uint32_t length,
+                        uint32_t* hashes, uint16_t max_hashes) {
+    z1_mem_hash_req_t req = { .addr = addr, .length = length };
+    uint16_t size = (max_hashes < Z1_MEM_HASH_MAX ? max_hashes : Z1_MEM_HASH_MAX) * sizeof(uint32_t);
+    
+    // The node reads the whole range from PSRAM before answering
+    int received = z1_bus_request(node_id, Z1_CMD_MEM_HASH, (const uint8_t*)&req, sizeof(req),
+                                  (uint8_t*)hashes, size, 500);
+    return (received < 0) ? -1 : received / (int)sizeof(uint32_t);
 }
 
 /**
- * Write memory to remote node (stub implementation)
+ * Write memory to remote node
+ *
+ * Sent as MEM_WRITE transfers [addr:4][data] of up to Z1_MEM_READ_BLOCK
+ * data bytes, which the node streams into PSRAM as they arrive. The node
+ * does not answer, so a range it refuses is only reported on its console.
  */
 int z1_write_node_memory(uint8_t node_id, uint32_t address,
                          const uint8_t* data, uint16_t length) {
-    // TODO: Implement memory write protocol
-    printf("[Z1 Protocol] Memory write not yet implemented\n");
-    return -1;
+    static uint8_t piece[4 + Z1_MEM_READ_BLOCK] __attribute__((aligned(4)));
+    uint16_t offset = 0;
+    
+    while (offset < length) {
+        uint16_t n = (length - offset < Z1_MEM_READ_BLOCK) ? length - offset : Z1_MEM_READ_BLOCK;
+        uint32_t addr = address + offset;
+        
+        memcpy(piece, &addr, 4);
+        memcpy(piece + 4, data + offset, n);
+        if (!z1_send_multiframe(node_id, Z1_CMD_MEM_WRITE, piece, 4 + n)) {
+            return -1;
+        }
+        offset += n;
+    }
+    return length;
 }
 
 /**
@@ -103,11 +493,37 @@ bool z1_send_spike(const z1_spike_msg_t* spike) {
 }
 
 /**
- * Update synapse weight (stub implementation)
+ * Apply a weight patch on a node
+ *
+ * @param node_id Node to patch
+ * @param patch Records (z1_weight_patch_header_t, ...), up to Z1_WEIGHT_PATCH_MAX bytes
+ * @param length Patch length
+ * @param result Receives the synapses applied and rejected
+ * @return false if the node did not answer
+ */
+bool z1_patch_weights(uint8_t node_id, const uint8_t* patch, uint16_t length,
+                      z1_weight_patch_result_t* result) {
+    // The node rewrites table and index entries before answering
+    int received = z1_bus_request(node_id, Z1_CMD_SNN_WEIGHT_UPDATE, patch, length,
+                                  (uint8_t*)result, sizeof(*result), 1000);
+    return received == (int)sizeof(*result);
+}
+
+/**
+ * Update synapse weight
  */
 bool z1_update_weight(uint8_t node_id, const z1_weight_update_t* update) {
-    // TODO: Implement weight update protocol
-    return false;
+    struct __attribute__((packed)) {
+        z1_weight_patch_header_t header;
+        z1_weight_update_t entry;
+    } patch = {
+        .header = { .format = Z1_WEIGHT_PATCH_LIST, .node_id = node_id, .count = 1 },
+        .entry = *update,
+    };
+    z1_weight_patch_result_t result;
+    
+    return z1_patch_weights(node_id, (const uint8_t*)&patch, sizeof(patch), &result) &&
+           result.applied == 1;
 }
 
 /**
@@ -121,15 +537,335 @@ bool z1_start_snn_all(void) {
  * Stop SNN execution on all nodes
  */
 bool z1_stop_snn_all(void) {
+    g_barrier.active = false;
     return z1_bus_broadcast(Z1_CMD_SNN_STOP, 0);
 }
 
+// ============================================================================
+// Timestep Barrier
+// ============================================================================
+
+// Send the start to each node of the mask
+static bool start_nodes(uint16_t node_mask, uint8_t flags) {
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if ((node_mask & (1u << node)) && !z1_bus_write(node, Z1_CMD_SNN_START, flags)) {
+            printf("[Z1 Protocol] ERROR: Start of node %d failed\n", node);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Start the nodes in barrier mode with extra start flags, up to step_limit
+static bool start_barrier(uint16_t node_mask, uint32_t period_us, const z1_snn_tdma_config_t* tdma,
+                          uint8_t flags, uint32_t step_limit) {
+    if (node_mask == 0) {
+        printf("[Z1 Protocol] ERROR: No nodes for barrier run\n");
+        return false;
+    }
+    
+    g_barrier.active = false;
+    
+    // Every node needs the schedule before the start; one that missed it
+    // would send on contention and leave its slot to the timeout
+    uint8_t start_flags = Z1_SNN_START_SYNC | flags;
+    uint32_t timeout_us = Z1_SNN_SYNC_TIMEOUT_US;
+    if (tdma && tdma->slot_us) {
+        z1_snn_tdma_config_t config = *tdma;
+        config.node_mask = node_mask;
+        for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+            if ((node_mask & (1u << node)) &&
+                !z1_send_multiframe(node, Z1_CMD_SNN_TDMA, (uint8_t*)&config, sizeof(config))) {
+                printf("[Z1 Protocol] ERROR: TDMA schedule to node %d failed\n", node);
+                return false;
+            }
+        }
+        start_flags |= Z1_SNN_START_TDMA;
+        
+        // A round may run every slot to its end before the last marker
+        uint32_t round_us = config.guard_us + __builtin_popcount(node_mask) * config.slot_us;
+        if (timeout_us < 2 * round_us) {
+            timeout_us = 2 * round_us;
+        }
+    }
+    
+    // Batch images outlive their run, so only the nodes of this one start
+    bool started = (start_flags & Z1_SNN_START_BATCH) ? start_nodes(node_mask, start_flags)
+                                                      : z1_bus_broadcast(Z1_CMD_SNN_START, start_flags);
+    if (!started) {
+        return false;
+    }
+    
+    // Step 0 counts as done by everyone; step 1 goes out on the next service
+    // pass, once the nodes have reset their engines
+    memset(&g_barrier, 0, sizeof(g_barrier));
+    g_barrier.node_mask = node_mask;
+    g_barrier.period_us = period_us;
+    g_barrier.slot_us = (start_flags & Z1_SNN_START_TDMA) ? tdma->slot_us : 0;
+    g_barrier.timeout_us = timeout_us;
+    g_barrier.step_limit = step_limit;
+    g_barrier.done_mask = node_mask;
+    g_barrier.released_us = time_us_32();
+    g_barrier.active = true;
+    
+    printf("[Z1 Protocol] Barrier run: nodes 0x%04X, %s%s\n", node_mask,
+           period_us ? "fixed period" : "as fast as the slowest node",
+           g_barrier.slot_us ? ", TDMA spike exchange" : "");
+    return true;
+}
+
+/**
+ * Start SNN execution in barrier mode
+ */
+bool z1_start_snn_sync(uint16_t node_mask, uint32_t period_us, const z1_snn_tdma_config_t* tdma) {
+    return start_barrier(node_mask, period_us, tdma, 0, 0);
+}
+
+/**
+ * Start the staged batch run
+ */
+bool z1_start_snn_batch(uint16_t node_mask, bool sync, uint32_t steps) {
+    if (sync) {
+        return start_barrier(node_mask, 0, NULL, Z1_SNN_START_BATCH, steps);
+    }
+    g_barrier.active = false;
+    return start_nodes(node_mask, Z1_SNN_START_BATCH);
+}
+
+// Broadcast the tick of the current step
+static bool send_tick(uint32_t now_us) {
+    if (!z1_bus_broadcast_us(Z1_CMD_SNN_TICK, (uint8_t)g_barrier.step, Z1_SNN_TICK_HOLD_US)) {
+        return false;
+    }
+    g_barrier.sent_us = now_us;
+    return true;
+}
+
+/**
+ * Release the next step when due
+ */
+void z1_snn_sync_service(void) {
+    if (!g_barrier.active) {
+        return;
+    }
+    uint32_t now_us = time_us_32();
+    
+    if (g_barrier.tick_pending) {
+        g_barrier.tick_pending = !send_tick(now_us);
+        return;
+    }
+    
+    if (g_barrier.done_mask != g_barrier.node_mask) {
+        // A node missed the tick or its report was lost; finished nodes
+        // answer a repeated tick with STEP_DONE again
+        if (now_us - g_barrier.sent_us >= g_barrier.timeout_us && send_tick(now_us)) {
+            g_barrier.retries++;
+        }
+        return;
+    }
+    
+    if (g_barrier.steps_done != g_barrier.step) {
+        uint32_t elapsed = now_us - g_barrier.released_us;
+        g_barrier.steps_done = g_barrier.step;
+        g_barrier.last_step_us = elapsed;
+        g_barrier.total_step_us += elapsed;
+        if (elapsed > g_barrier.max_step_us) {
+            g_barrier.max_step_us = elapsed;
+        }
+        g_barrier.slowest_node = g_barrier.last_node;
+    }
+    
+    if (now_us - g_barrier.released_us < g_barrier.period_us ||
+        (g_barrier.step_limit && g_barrier.step >= g_barrier.step_limit)) {
+        return;
+    }
+    
+    // Clear before the tick: the first reports can arrive during the broadcast
+    g_barrier.step++;
+    g_barrier.done_mask = 0;
+    g_barrier.released_us = now_us;
+    g_barrier.tick_pending = !send_tick(now_us);
+}
+
+/**
+ * Check whether a barrier run is in progress
+ */
+bool z1_snn_sync_active(void) {
+    return g_barrier.active;
+}
+
+/**
+ * Get barrier statistics
+ */
+void z1_snn_sync_get_stats(z1_snn_sync_stats_t* stats) {
+    stats->active = g_barrier.active;
+    stats->node_mask = g_barrier.node_mask;
+    stats->period_us = g_barrier.period_us;
+    stats->slot_us = g_barrier.slot_us;
+    stats->step = g_barrier.step;
+    stats->steps_done = g_barrier.steps_done;
+    stats->retries = g_barrier.retries;
+    stats->last_step_us = g_barrier.last_step_us;
+    stats->avg_step_us = g_barrier.steps_done ?
+        (uint32_t)(g_barrier.total_step_us / g_barrier.steps_done) : 0;
+    stats->max_step_us = g_barrier.max_step_us;
+    stats->slowest_node = g_barrier.slowest_node;
+}
+
+/**
+ * Query SNN engine status and per-phase timing from node
+ *
+ * @param node_id Node to query
+ * @param reset_timing Clear the node's timing counters after reading
+ * @param status Receives the status payload
+ * @return true if a valid response arrived
+ */
+bool z1_query_snn_status(uint8_t node_id, bool reset_timing, z1_snn_status_t* status) {
+    if (!status) return false;
+    
+    uint8_t flags = reset_timing ? 0x01 : 0x00;
+    int length = z1_bus_request(node_id, Z1_CMD_SNN_GET_STATUS, &flags, 1,
+                                (uint8_t*)status, sizeof(*status), 100);
+    if (length < (int)sizeof(*status) || status->version != Z1_SNN_STATUS_VERSION) {
+        if (length >= 0) {
+            printf("[Z1 Protocol] Node %d: bad SNN status (%d bytes, version %d)\n",
+                   node_id, length, length > 0 ? status->version : 0);
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read recorded spikes from node (consumes them on the node)
+ *
+ * @param node_id Node to read
+ * @param max_records Records to return at most
+ * @param flags Z1_SPIKE_READ_*
+ * @param header Receives the response header
+ * @param records Receives up to max_records records
+ * @return Records received, or -1 on failure
+ */
+int z1_query_snn_spikes(uint8_t node_id, uint16_t max_records, uint8_t flags,
+                        z1_spike_raster_header_t* header, z1_spike_raster_t* records) {
+    static uint8_t response[sizeof(z1_spike_raster_header_t) + 1000 * sizeof(z1_spike_raster_t)];
+    uint16_t max_fit = (sizeof(response) - sizeof(*header)) / sizeof(z1_spike_raster_t);
+    z1_spike_read_req_t req = {
+        .max_records = (max_records < max_fit) ? max_records : max_fit,
+        .flags = flags,
+    };
+    
+    // Multi-frame request; the payload comes back as a burst
+    int length = z1_bus_request(node_id, Z1_CMD_SNN_GET_SPIKES, (const uint8_t*)&req, sizeof(req),
+                                response, sizeof(response), 200);
+    if (length < (int)sizeof(*header)) {
+        return -1;
+    }
+    
+    memcpy(header, response, sizeof(*header));
+    if (header->count > req.max_records ||
+        sizeof(*header) + header->count * sizeof(z1_spike_raster_t) > (size_t)length) {
+        printf("[Z1 Protocol] Node %d: truncated spike raster (%d records, %d bytes)\n",
+               node_id, header->count, length);
+        return -1;
+    }
+    memcpy(records, response + sizeof(*header), header->count * sizeof(z1_spike_raster_t));
+    return header->count;
+}
+
 /**
- * Query SNN activity from node (stub implementation)
+ * Query SNN activity from node
  */
 bool z1_query_snn_activity(uint8_t node_id, z1_snn_activity_t* activity) {
-    // TODO: Implement activity query protocol
-    return false;
+    static z1_snn_status_t status;
+    
+    if (!activity || !z1_query_snn_status(node_id, false, &status)) {
+        return false;
+    }
+    
+    activity->active_neurons = status.active_neurons;
+    activity->total_spikes = status.spikes_generated;
+    activity->spike_rate_hz = status.current_time_us > 0 ?
+        (uint32_t)((uint64_t)status.spikes_generated * 1000000 / status.current_time_us) : 0;
+    activity->timestamp_us = status.current_time_us;
+    return true;
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+// Z1_CMD_BENCH_SINK payload (contents are never looked at)
+static uint8_t g_bench_payload[Z1_BENCH_SINK_MAX] __attribute__((aligned(4)));
+
+/**
+ * Run a benchmark on a node
+ */
+int z1_query_bench(uint8_t node_id, const z1_bench_req_t* req, uint8_t* result, uint16_t size) {
+    // The node runs the whole benchmark before answering
+    return z1_bus_request(node_id, Z1_CMD_BENCH, (const uint8_t*)req, sizeof(*req),
+                          result, size, Z1_BENCH_TIMEOUT_MS);
+}
+
+// Read (and clear) the node's BENCH_SINK counters
+static bool bench_read_sink(uint8_t node_id, z1_bench_sink_result_t* sink) {
+    z1_bench_req_t req = { .test = Z1_BENCH_SINK, .flags = Z1_BENCH_SINK_CLEAR };
+    int length = z1_query_bench(node_id, &req, (uint8_t*)sink, sizeof(*sink));
+    return length == (int)sizeof(*sink) && sink->status == Z1_BENCH_STATUS_OK;
+}
+
+/**
+ * Measure bus throughput to a node
+ */
+bool z1_bench_bus(uint8_t node_id, z1_bench_bus_mode_t mode, uint16_t payload, uint32_t count,
+                  z1_bench_bus_result_t* result) {
+    z1_bench_sink_result_t sink;
+    
+    uint16_t limit = (mode == Z1_BENCH_BUS_CHUNKED) ? Z1_BENCH_CHUNKED_MAX : Z1_BENCH_SINK_MAX;
+    if (mode == Z1_BENCH_BUS_WRITE || payload == 0) {
+        payload = 1;
+    } else if (payload > limit) {
+        payload = limit;
+    }
+    
+    memset(result, 0, sizeof(*result));
+    result->mode = mode;
+    result->payload = payload;
+    if (!bench_read_sink(node_id, &sink)) {
+        return false;
+    }
+    
+    uint32_t start_us = time_us_32();
+    for (uint32_t i = 0; i < count; i++) {
+        bool ok;
+        if (mode == Z1_BENCH_BUS_WRITE) {
+            ok = z1_bus_write(node_id, Z1_CMD_BENCH_SINK, (uint8_t)i);
+        } else if (mode == Z1_BENCH_BUS_CHUNKED) {
+            ok = z1_send_multiframe_chunked(node_id, Z1_CMD_BENCH_SINK, g_bench_payload, payload);
+        } else {
+            ok = z1_send_multiframe_burst(node_id, Z1_CMD_BENCH_SINK, g_bench_payload, payload);
+        }
+        
+        if (ok) {
+            result->transfers++;
+            result->bytes += payload;
+        } else {
+            result->failed++;
+        }
+    }
+    result->elapsed_us = time_us_32() - start_us;
+    
+    // No answer here only loses the delivery check
+    result->delivered_valid = bench_read_sink(node_id, &sink);
+    if (result->delivered_valid) {
+        result->delivered_transfers = sink.transfers;
+        result->delivered_bytes = sink.bytes;
+    }
+    
+    printf("[Z1 Protocol] Bus benchmark (mode %d) to node %d: %lu x %u bytes in %lu us, %lu failed\n",
+           mode, node_id, (unsigned long)result->transfers, payload,
+           (unsigned long)result->elapsed_us, (unsigned long)result->failed);
+    return true;
 }
 
 // z1_discover_nodes_sequential and z1_bus_ping_node are implemented in z1_matrix_bus.c
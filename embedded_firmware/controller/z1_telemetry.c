@@ -0,0 +1,227 @@
+/**
+ * Z1 Cluster Telemetry
+ *
+ * One bus exchange per service call at most: a status request (bounded by
+ * its 100 ms timeout, a few ms for a live node) or a ping that is checked
+ * on the following calls.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_telemetry.h"
+#include "z1_matrix_bus.h"
+#include "z1_protocol_extended.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+#define Z1_TELEMETRY_NO_PING    0xFF
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    z1_telemetry_node_t nodes[Z1_MAX_NODES];
+    z1_telemetry_stats_t stats;
+
+    uint8_t cursor;                 // Next node to consider
+    uint8_t ping_node;              // Node with a ping outstanding
+    uint32_t ping_ms;
+    uint32_t poll_ms;               // Last poll
+    uint32_t sweep_start_ms;
+} z1_telemetry_t;
+
+static z1_telemetry_t g_tel;
+
+static z1_snn_status_t g_tel_scratch;
+
+static inline uint32_t telemetry_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static void telemetry_mark_alive(uint8_t node, uint32_t now_ms) {
+    z1_telemetry_node_t* n = &g_tel.nodes[node];
+    n->alive = true;
+    n->seen = true;
+    n->last_seen_ms = now_ms;
+    g_tel.stats.alive_mask |= (1u << node);
+}
+
+static void telemetry_mark_offline(uint8_t node) {
+    g_tel.nodes[node].alive = false;
+    g_tel.stats.alive_mask &= ~(1u << node);
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+/**
+ * Clear the table and seed liveness from a boot-time discovery
+ */
+void z1_telemetry_init(const bool active_nodes[16]) {
+    memset(&g_tel, 0, sizeof(g_tel));
+    g_tel.ping_node = Z1_TELEMETRY_NO_PING;
+    g_tel.sweep_start_ms = telemetry_now_ms();
+
+    if (active_nodes) {
+        z1_telemetry_record_discovery(active_nodes);
+    }
+}
+
+/**
+ * Store the result of a foreground discovery
+ */
+void z1_telemetry_record_discovery(const bool active_nodes[16]) {
+    uint32_t now_ms = telemetry_now_ms();
+
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (active_nodes[node]) {
+            telemetry_mark_alive(node, now_ms);
+            g_tel.nodes[node].misses = 0;
+        } else {
+            telemetry_mark_offline(node);
+        }
+        g_tel.nodes[node].polled_ms = now_ms;
+    }
+
+    // Discovery replaced the history an outstanding ping would match against
+    g_tel.ping_node = Z1_TELEMETRY_NO_PING;
+}
+
+/**
+ * Store a status report fetched outside the poller
+ */
+void z1_telemetry_record_status(uint8_t node, const z1_snn_status_t* status) {
+    if (node >= Z1_MAX_NODES) {
+        return;
+    }
+
+    z1_telemetry_node_t* n = &g_tel.nodes[node];
+    uint32_t now_ms = telemetry_now_ms();
+    memcpy(&n->status, status, sizeof(n->status));
+    n->have_status = true;
+    n->status_ms = now_ms;
+    n->misses = 0;
+    telemetry_mark_alive(node, now_ms);
+}
+
+// ============================================================================
+// Poller
+// ============================================================================
+
+// Resolve the outstanding ping; returns false while it is still in flight
+static bool telemetry_check_ping(uint32_t now_ms) {
+    uint8_t node = g_tel.ping_node;
+
+    if (z1_bus_ping_answered(node)) {
+        telemetry_mark_alive(node, now_ms);
+    } else if (now_ms - g_tel.ping_ms >= Z1_TELEMETRY_PING_MS) {
+        if (g_tel.nodes[node].alive) {
+            printf("[Telemetry] Node %d stopped answering\n", node);
+        }
+        telemetry_mark_offline(node);
+        g_tel.stats.pings_lost++;
+    } else {
+        return false;
+    }
+
+    g_tel.ping_node = Z1_TELEMETRY_NO_PING;
+    return true;
+}
+
+static void telemetry_poll_node(uint8_t node, uint32_t now_ms) {
+    z1_telemetry_node_t* n = &g_tel.nodes[node];
+    n->polled_ms = now_ms;
+    g_tel.stats.polls++;
+
+    if (n->alive && n->misses < Z1_TELEMETRY_MISSES) {
+        if (z1_query_snn_status(node, false, &g_tel_scratch)) {
+            g_tel.stats.status_ok++;
+            z1_telemetry_record_status(node, &g_tel_scratch);
+        } else {
+            g_tel.stats.status_failed++;
+            n->misses++;
+        }
+        return;
+    }
+
+    // Unknown, offline or not answering status requests: is it there at all?
+    if (z1_bus_ping_start(node)) {
+        g_tel.ping_node = node;
+        g_tel.ping_ms = now_ms;
+    }
+    if (n->misses >= Z1_TELEMETRY_MISSES) {
+        n->misses = 0;
+    }
+}
+
+// Next node whose refresh interval has passed, or Z1_MAX_NODES
+static uint8_t telemetry_next_due(uint32_t now_ms) {
+    for (uint8_t i = 0; i < Z1_MAX_NODES; i++) {
+        uint8_t node = g_tel.cursor;
+        g_tel.cursor = (g_tel.cursor + 1) % Z1_MAX_NODES;
+        if (g_tel.cursor == 0) {
+            g_tel.stats.sweep_ms = now_ms - g_tel.sweep_start_ms;
+            g_tel.sweep_start_ms = now_ms;
+        }
+
+        const z1_telemetry_node_t* n = &g_tel.nodes[node];
+        uint32_t interval = n->alive ? Z1_TELEMETRY_NODE_MS : Z1_TELEMETRY_OFFLINE_MS;
+        if (now_ms - n->polled_ms >= interval) {
+            return node;
+        }
+    }
+    return Z1_MAX_NODES;
+}
+
+/**
+ * Advance the poller by at most one bus exchange
+ */
+void z1_telemetry_service(bool busy) {
+    uint32_t now_ms = telemetry_now_ms();
+
+    if (g_tel.ping_node != Z1_TELEMETRY_NO_PING && !telemetry_check_ping(now_ms)) {
+        return;
+    }
+
+    uint32_t spacing = busy ? Z1_TELEMETRY_BUSY_POLL_MS : Z1_TELEMETRY_POLL_MS;
+    if (now_ms - g_tel.poll_ms < spacing) {
+        return;
+    }
+
+    // Barrier run: only while every node waits for the next tick
+    if (z1_snn_sync_active()) {
+        z1_snn_sync_stats_t sync;
+        z1_snn_sync_get_stats(&sync);
+        if (sync.steps_done != sync.step) {
+            g_tel.stats.skipped++;
+            return;
+        }
+    }
+
+    uint8_t node = telemetry_next_due(now_ms);
+    if (node < Z1_MAX_NODES) {
+        telemetry_poll_node(node, now_ms);
+    }
+    g_tel.poll_ms = now_ms;
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+/**
+ * Get the telemetry of a node
+ */
+const z1_telemetry_node_t* z1_telemetry_node(uint8_t node) {
+    return (node < Z1_MAX_NODES) ? &g_tel.nodes[node] : NULL;
+}
+
+/**
+ * Get poller statistics
+ */
+void z1_telemetry_get_stats(z1_telemetry_stats_t* stats) {
+    memcpy(stats, &g_tel.stats, sizeof(*stats));
+}
@@ -0,0 +1,119 @@
+/**
+ * Z1 Cluster Telemetry
+ *
+ * Controller-side table of node liveness and the last SNN status every
+ * node reported, so GET /api/nodes and GET /api/snn/status answer without
+ * a bus round trip. The table is refreshed one node at a time from the
+ * controller main loop:
+ *
+ *   - nodes believed alive get a Z1_CMD_SNN_GET_STATUS request, which also
+ *     proves they are up; Z1_TELEMETRY_MISSES failed requests in a row
+ *     demote the node to pinging
+ *   - other nodes get a ping that is not waited for; the answer is picked
+ *     up on a later pass
+ *
+ * Polling yields to request handling and to the spike path: while HTTP or
+ * UDP work is pending the poller slows to Z1_TELEMETRY_BUSY_POLL_MS, and
+ * during a barrier run it only polls between steps.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_TELEMETRY_H
+#define Z1_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_TELEMETRY_POLL_MS        20      // Poll spacing while the loop is idle
+#define Z1_TELEMETRY_BUSY_POLL_MS   500     // Poll spacing while requests are being served
+#define Z1_TELEMETRY_NODE_MS        1000    // Refresh interval of a live node
+#define Z1_TELEMETRY_OFFLINE_MS     5000    // Ping interval of an offline node
+#define Z1_TELEMETRY_PING_MS        30      // Ping answer timeout
+#define Z1_TELEMETRY_MISSES         2       // Failed status requests before pinging
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Telemetry of one node
+ */
+typedef struct {
+    bool alive;                 // Answered the last status request or ping
+    bool seen;                  // Answered at least once since boot
+    bool have_status;           // status holds a report
+    uint8_t misses;             // Failed status requests in a row
+    uint32_t last_seen_ms;      // Controller time of the last answer
+    uint32_t status_ms;         // Controller time status was received
+    uint32_t polled_ms;         // Controller time of the last poll
+    z1_snn_status_t status;     // Last Z1_CMD_SNN_GET_STATUS report
+} z1_telemetry_node_t;
+
+/**
+ * Poller statistics
+ */
+typedef struct {
+    uint32_t polls;             // Status requests and pings sent
+    uint32_t status_ok;         // Status requests answered
+    uint32_t status_failed;     // Status requests that timed out or were malformed
+    uint32_t pings_lost;        // Pings not answered in time
+    uint32_t skipped;           // Polls deferred until a barrier step finished
+    uint32_t sweep_ms;          // Duration of the last pass over all nodes
+    uint16_t alive_mask;        // Nodes currently alive
+} z1_telemetry_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Clear the table and seed liveness from a boot-time discovery
+ *
+ * @param active_nodes Discovery result, or NULL to start with every node unknown
+ */
+void z1_telemetry_init(const bool active_nodes[16]);
+
+/**
+ * Store the result of a foreground discovery (POST /api/nodes/discover)
+ *
+ * @param active_nodes Discovery result; absent nodes are marked offline
+ */
+void z1_telemetry_record_discovery(const bool active_nodes[16]);
+
+/**
+ * Store a status report fetched outside the poller (e.g. with reset=1)
+ *
+ * @param node Node that answered
+ * @param status Report received
+ */
+void z1_telemetry_record_status(uint8_t node, const z1_snn_status_t* status);
+
+/**
+ * Advance the poller by at most one bus exchange (controller main loop)
+ *
+ * @param busy The loop pass handled HTTP or UDP work
+ */
+void z1_telemetry_service(bool busy);
+
+/**
+ * Get the telemetry of a node
+ *
+ * @param node Node ID (0-15)
+ * @return Table entry, or NULL for an invalid node
+ */
+const z1_telemetry_node_t* z1_telemetry_node(uint8_t node);
+
+/**
+ * Get poller statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_telemetry_get_stats(z1_telemetry_stats_t* stats);
+
+#endif // Z1_TELEMETRY_H
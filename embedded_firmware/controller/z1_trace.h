@@ -0,0 +1,177 @@
+/**
+ * Z1 Binary Event Trace
+ *
+ * Fixed-size SRAM ring of {timestamp, event, 2 args} records for hot paths
+ * (matrix bus, multi-frame, SNN) where printf over USB stdio would cost
+ * milliseconds per frame. Recording is a few stores; records are formatted
+ * later from the main loop (z1_trace_drain_stdio) or copied out for the
+ * HTTP API (z1_trace_snapshot). The ring overwrites its oldest records.
+ *
+ * Each subsystem has a compile-time level (Z1_TRACE_LEVEL_<SUB>); records
+ * above it compile to nothing.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_TRACE_H
+#define Z1_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#ifndef Z1_TRACE_RING_SIZE
+#define Z1_TRACE_RING_SIZE  512     // Records (power of 2), 12 bytes each
+#endif
+
+#ifndef Z1_TRACE_DRAIN_PER_LOOP
+#define Z1_TRACE_DRAIN_PER_LOOP 8   // Records a main loop pass prints (0 = ring only)
+#endif
+
+// Levels
+#define Z1_TRACE_OFF    0
+#define Z1_TRACE_ERROR  1
+#define Z1_TRACE_INFO   2           // One record per transaction / transfer
+#define Z1_TRACE_DEBUG  3           // Per frame, per poll
+
+// Per-subsystem levels (override with -DZ1_TRACE_LEVEL_BUS=... etc.)
+#ifndef Z1_TRACE_LEVEL_BUS
+#define Z1_TRACE_LEVEL_BUS      Z1_TRACE_INFO
+#endif
+#ifndef Z1_TRACE_LEVEL_FRAME
+#define Z1_TRACE_LEVEL_FRAME    Z1_TRACE_INFO
+#endif
+#ifndef Z1_TRACE_LEVEL_SNN
+#define Z1_TRACE_LEVEL_SNN      Z1_TRACE_INFO
+#endif
+#ifndef Z1_TRACE_LEVEL_APP
+#define Z1_TRACE_LEVEL_APP      Z1_TRACE_INFO
+#endif
+
+// Subsystems
+#define Z1_TRACE_SUB_BUS    0       // Matrix bus transactions
+#define Z1_TRACE_SUB_FRAME  1       // Multi-frame transfers
+#define Z1_TRACE_SUB_SNN    2       // SNN engine
+#define Z1_TRACE_SUB_APP    3       // Command dispatch (node.c / HTTP API)
+
+// ============================================================================
+// Event IDs
+// ============================================================================
+
+// Bus (arg0 / arg1 noted per event)
+#define Z1_EV_BUS_CLAIM         0x01    // attempts, backoff_us
+#define Z1_EV_BUS_CLAIM_FAIL    0x02    // attempts, -
+#define Z1_EV_BUS_BACKOFF       0x03    // attempt, backoff_us
+#define Z1_EV_BUS_RELEASE       0x04    // -, -
+#define Z1_EV_BUS_ACK           0x05    // polls, -
+#define Z1_EV_BUS_ACK_TIMEOUT   0x06    // polls, -
+#define Z1_EV_BUS_FRAME         0x07    // frame, last
+#define Z1_EV_BUS_WRITE         0x08    // target, (command << 8) | data
+#define Z1_EV_BUS_WRITE_DONE    0x09    // target, busack_released
+#define Z1_EV_BUS_BROADCAST     0x0A    // -, (command << 8) | data
+#define Z1_EV_BUS_RX            0x0B    // sender, (command << 8) | data
+#define Z1_EV_BUS_BURST_TX      0x0C    // target, length
+#define Z1_EV_BUS_BURST_FAIL    0x0D    // target, length
+#define Z1_EV_BUS_MCAST_TX      0x0E    // dest_mask, length
+#define Z1_EV_BUS_MCAST_FAIL    0x0F    // dest_mask, length
+
+// Multi-frame
+#define Z1_EV_FRAME_TX          0x01    // target, (command << 16) | length
+#define Z1_EV_FRAME_TX_DONE     0x02    // target, length
+#define Z1_EV_FRAME_TX_BURST    0x03    // target, elapsed_ms
+#define Z1_EV_FRAME_TX_FALLBACK 0x04    // target, length
+#define Z1_EV_FRAME_RX_START    0x05    // sender, command
+#define Z1_EV_FRAME_RX_LENGTH   0x06    // -, length
+#define Z1_EV_FRAME_RX_DONE     0x07    // sender, length
+#define Z1_EV_FRAME_RX_ERROR    0x08    // sender, bytes_received
+
+// SNN
+#define Z1_EV_SNN_QUEUE_FULL    0x01    // -, global_id
+#define Z1_EV_SNN_BATCH_FAIL    0x02    // node, count
+#define Z1_EV_SNN_INJECT        0x03    // neuron, -
+#define Z1_EV_SNN_TICK_SKIP     0x04    // tick step & 0xFF, expected step
+#define Z1_EV_SNN_SLOT_OVERRUN  0x05    // node, tick to SLOT_DONE (us)
+
+// App
+#define Z1_EV_APP_COMMAND       0x01    // sender, (command << 8) | data
+#define Z1_EV_APP_FRAME         0x02    // sequence / checksum, command
+#define Z1_EV_APP_HTTP          0x03    // status, -
+#define Z1_EV_APP_MULTIFRAME    0x04    // command, length
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Trace record (12 bytes)
+ */
+typedef struct {
+    uint32_t timestamp_us;          // time_us_32() when recorded
+    uint8_t subsystem;              // Z1_TRACE_SUB_*
+    uint8_t event;                  // Event ID within the subsystem
+    uint16_t arg0;
+    uint32_t arg1;
+} z1_trace_record_t;
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+#define Z1_TRACE(sub, level, event, arg0, arg1)                                   \
+    do {                                                                          \
+        if ((level) <= Z1_TRACE_LEVEL_##sub) {                                    \
+            z1_trace_record(Z1_TRACE_SUB_##sub, (event), (uint16_t)(arg0),        \
+                            (uint32_t)(arg1));                                    \
+        }                                                                         \
+    } while (0)
+
+/**
+ * Append a record (safe from IRQs and both cores)
+ *
+ * @param subsystem Z1_TRACE_SUB_*
+ * @param event Event ID
+ * @param arg0 First argument
+ * @param arg1 Second argument
+ */
+void z1_trace_record(uint8_t subsystem, uint8_t event, uint16_t arg0, uint32_t arg1);
+
+// ============================================================================
+// Readout
+// ============================================================================
+
+/**
+ * Print pending records as text (call from the main loop)
+ *
+ * @param max_records Records to print at most
+ * @return Records printed
+ */
+uint16_t z1_trace_drain_stdio(uint16_t max_records);
+
+/**
+ * Copy the most recent records, oldest first (does not consume them)
+ *
+ * @param records Output array
+ * @param max_records Array capacity
+ * @return Records copied
+ */
+uint16_t z1_trace_snapshot(z1_trace_record_t* records, uint16_t max_records);
+
+/**
+ * Get the total number of records written (including overwritten ones)
+ */
+uint32_t z1_trace_count(void);
+
+/**
+ * Get the number of records overwritten before the stdio drain reached them
+ */
+uint32_t z1_trace_dropped(void);
+
+/**
+ * Get a short name for an event (e.g. "ack_timeout")
+ */
+const char* z1_trace_event_name(uint8_t subsystem, uint8_t event);
+
+#endif // Z1_TRACE_H
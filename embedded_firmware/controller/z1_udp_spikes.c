@@ -0,0 +1,302 @@
+/**
+ * Z1 UDP Spike Channel
+ *
+ * Datagrams are handled in the controller main loop, between HTTP socket
+ * passes; input goes out through the same per-node batches as
+ * POST /api/snn/input. Peer gateway datagrams are passed to z1_gateway.c.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_udp_spikes.h"
+#include "z1_gateway.h"
+#include "w5500_http_server.h"
+#include "z1_http_api.h"
+#include "z1_protocol_extended.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// Datagrams taken per main loop pass, so HTTP sockets are not starved
+#define Z1_UDP_RX_PER_PASS      4
+
+// Datagrams per push and node before the rest waits for the next push
+#define Z1_UDP_TX_PER_NODE      4
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    bool open;
+
+    // Subscriber
+    bool subscribed;
+    uint8_t ip[4];
+    uint16_t port;
+    uint16_t every_steps;
+    uint16_t seq;
+    uint8_t send_failures;          // Failed pushes in a row
+
+    // Last push
+    uint32_t push_step;
+    uint32_t push_us;
+} z1_udp_state_t;
+
+static z1_udp_state_t g_udp;
+
+static uint8_t g_udp_datagram[Z1_UDP_MAX_DATAGRAM] __attribute__((aligned(4)));
+
+// ============================================================================
+// Input
+// ============================================================================
+
+static void udp_send_ack(const uint8_t ip[4], uint16_t port, uint16_t seq, uint16_t count) {
+    z1_udp_header_t ack = {
+        .magic = Z1_UDP_MAGIC,
+        .type = Z1_UDP_ACK,
+        .seq = seq,
+        .count = count,
+    };
+    w5500_udp_send(Z1_UDP_SOCKET, ip, port, (const uint8_t*)&ack, sizeof(ack));
+}
+
+// Inject count entries following the header; returns spikes injected
+static uint16_t udp_inject(const uint8_t* entries, uint16_t count) {
+    if (!g_snn_running) {
+        return 0;
+    }
+
+    uint16_t injected = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        z1_udp_input_t in;
+        memcpy(&in, entries + i * sizeof(in), sizeof(in));
+        if (z1_snn_input_queue(in.neuron_id, in.value)) {
+            injected++;
+        }
+    }
+    z1_snn_input_flush();
+    return injected;
+}
+
+static void udp_subscribe(const uint8_t ip[4], uint16_t port, const z1_udp_subscribe_t* sub) {
+    memcpy(g_udp.ip, ip, 4);
+    g_udp.port = port;
+    g_udp.every_steps = sub->every_steps ? sub->every_steps : 1;
+    g_udp.seq = 0;
+    g_udp.send_failures = 0;
+    g_udp.push_us = time_us_32();
+
+    z1_snn_sync_stats_t sync;
+    z1_snn_sync_get_stats(&sync);
+    g_udp.push_step = sync.steps_done;
+    g_udp.subscribed = true;
+
+    printf("[UDP] Subscriber %d.%d.%d.%d:%d, every %u steps\n",
+           ip[0], ip[1], ip[2], ip[3], port, g_udp.every_steps);
+}
+
+static void udp_handle_datagram(const uint8_t* data, int length, const uint8_t ip[4], uint16_t port) {
+    z1_udp_header_t header;
+    if (length < (int)sizeof(header)) {
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != Z1_UDP_MAGIC) {
+        return;
+    }
+
+    const uint8_t* payload = data + sizeof(header);
+    uint16_t payload_length = length - sizeof(header);
+
+    switch (header.type) {
+        case Z1_UDP_INPUT: {
+            uint16_t count = payload_length / sizeof(z1_udp_input_t);
+            if (count > header.count) count = header.count;
+
+            uint16_t injected = udp_inject(payload, count);
+            if (header.flags & Z1_UDP_FLAG_ACK) {
+                udp_send_ack(ip, port, header.seq, injected);
+            }
+            break;
+        }
+
+        case Z1_UDP_SUBSCRIBE: {
+            z1_udp_subscribe_t sub = { .every_steps = 1 };
+            memcpy(&sub, payload,
+                   payload_length < sizeof(sub) ? payload_length : sizeof(sub));
+            udp_subscribe(ip, port, &sub);
+            udp_send_ack(ip, port, header.seq, 0);
+            break;
+        }
+
+        case Z1_UDP_UNSUBSCRIBE:
+            if (g_udp.subscribed && memcmp(g_udp.ip, ip, 4) == 0 && g_udp.port == port) {
+                g_udp.subscribed = false;
+                printf("[UDP] Subscriber left\n");
+            }
+            udp_send_ack(ip, port, header.seq, 0);
+            break;
+
+        case Z1_UDP_GATEWAY:
+            z1_gateway_receive(&header, payload, payload_length);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// Output Push
+// ============================================================================
+
+// Send the SPIKES datagram assembled in g_udp_datagram
+static bool udp_send_spikes(uint16_t count, uint8_t flags, uint32_t step) {
+    z1_udp_header_t header = {
+        .magic = Z1_UDP_MAGIC,
+        .type = Z1_UDP_SPIKES,
+        .flags = flags,
+        .seq = g_udp.seq++,
+        .count = count,
+        .step = step,
+    };
+    memcpy(g_udp_datagram, &header, sizeof(header));
+
+    return w5500_udp_send(Z1_UDP_SOCKET, g_udp.ip, g_udp.port, g_udp_datagram,
+                          sizeof(header) + count * sizeof(z1_udp_spike_t));
+}
+
+// Collect the spikes every node recorded since the last push and send them
+static void udp_push(uint32_t step) {
+    static z1_spike_raster_t records[Z1_UDP_MAX_SPIKES];
+    z1_udp_spike_t* out = (z1_udp_spike_t*)(g_udp_datagram + sizeof(z1_udp_header_t));
+    uint16_t count = 0;
+    uint8_t flags = 0;
+    bool sent = true;
+
+    for (uint8_t node = 0; node < Z1_MAX_NODES; node++) {
+        if (!(g_snn_node_mask & (1u << node))) {
+            continue;
+        }
+
+        for (uint8_t part = 0; part < Z1_UDP_TX_PER_NODE; part++) {
+            z1_spike_raster_header_t header;
+            int n = z1_query_snn_spikes(node, Z1_UDP_MAX_SPIKES - count, 0, &header, records);
+            if (n < 0) {
+                break;
+            }
+            if (header.flags & Z1_SPIKE_RASTER_OVERRUN) {
+                flags |= Z1_UDP_FLAG_OVERRUN;
+            }
+
+            for (int i = 0; i < n; i++) {
+                uint16_t local_id = z1_spike_raster_id(records[i]);
+                uint32_t global_id;
+                z1_udp_spike_t spike = {
+                    .node = node,
+                    .neuron_id = local_id,
+                    .step = z1_spike_raster_step(records[i], header.current_step),
+                };
+                if (z1_snn_neuron_global_id(node, local_id, &global_id)) {
+                    spike.neuron_id = (uint16_t)global_id;
+                } else {
+                    flags |= Z1_UDP_FLAG_LOCAL_IDS;
+                }
+                memcpy(&out[count++], &spike, sizeof(spike));
+            }
+
+            if (count < Z1_UDP_MAX_SPIKES) {
+                break;
+            }
+            sent &= udp_send_spikes(count, flags, step);
+            count = 0;
+            flags = 0;
+            if (header.pending == 0) {
+                break;
+            }
+        }
+    }
+
+    // An empty datagram still marks the step for the host
+    sent &= udp_send_spikes(count, flags, step);
+
+    if (sent) {
+        g_udp.send_failures = 0;
+    } else if (++g_udp.send_failures >= Z1_UDP_SEND_RETRIES) {
+        printf("[UDP] Subscriber unreachable, dropped\n");
+        g_udp.subscribed = false;
+    }
+}
+
+// Step to push for, or false if the interval has not passed yet
+static bool udp_push_due(uint32_t* step) {
+    if (z1_snn_sync_active()) {
+        // Barrier runs: count the steps every node has finished
+        z1_snn_sync_stats_t sync;
+        z1_snn_sync_get_stats(&sync);
+        if (sync.steps_done - g_udp.push_step < g_udp.every_steps) {
+            return false;
+        }
+        g_udp.push_step = sync.steps_done;
+        *step = sync.steps_done;
+        return true;
+    }
+
+    // Free-running nodes: nominal step length
+    uint32_t now_us = time_us_32();
+    if (now_us - g_udp.push_us < (uint32_t)g_udp.every_steps * Z1_UDP_STEP_US) {
+        return false;
+    }
+    g_udp.push_us = now_us;
+    g_udp.push_step += g_udp.every_steps;
+    *step = g_udp.push_step;
+    return true;
+}
+
+// ============================================================================
+// Service
+// ============================================================================
+
+/**
+ * Open the UDP socket
+ */
+bool z1_udp_spikes_init(void) {
+    memset(&g_udp, 0, sizeof(g_udp));
+    g_udp.open = w5500_udp_open(Z1_UDP_SOCKET, Z1_UDP_PORT);
+    return g_udp.open;
+}
+
+/**
+ * Handle received datagrams and push spikes when due
+ */
+bool z1_udp_spikes_service(void) {
+    if (!g_udp.open) {
+        return false;
+    }
+
+    // RECV is acknowledged on the first read: datagrams left over raise no new event
+    uint8_t received = 0;
+    while (received < Z1_UDP_RX_PER_PASS) {
+        uint8_t ip[4];
+        uint16_t port;
+        int length = w5500_udp_recv(Z1_UDP_SOCKET, g_udp_datagram, sizeof(g_udp_datagram),
+                                    ip, &port);
+        if (length <= 0) {
+            break;
+        }
+        udp_handle_datagram(g_udp_datagram, length, ip, port);
+        received++;
+    }
+    bool more = (received == Z1_UDP_RX_PER_PASS);
+
+    if (!g_udp.subscribed || !g_snn_running) {
+        return more;
+    }
+
+    uint32_t step;
+    if (udp_push_due(&step)) {
+        udp_push(step);
+    }
+    return true;
+}
@@ -0,0 +1,127 @@
+/**
+ * Z1 UDP Spike Channel
+ *
+ * Low-latency spike I/O for closed-loop hosts, on a W5500 UDP socket next
+ * to the HTTP API. Every datagram starts with a z1_udp_header_t:
+ *
+ *   INPUT        host -> controller   count z1_udp_input_t, injected at once
+ *   SUBSCRIBE    host -> controller   z1_udp_subscribe_t; the sender becomes
+ *                                     the subscriber (one at a time)
+ *   UNSUBSCRIBE  host -> controller   no payload
+ *   SPIKES       controller -> host   count z1_udp_spike_t recorded since the
+ *                                     last push, every every_steps timesteps
+ *   ACK          controller -> host   reply to SUBSCRIBE, UNSUBSCRIBE and to
+ *                                     INPUT with Z1_UDP_FLAG_ACK (seq echoed)
+ *   GATEWAY      controller -> peer   z1_udp_gateway_t, then count spike
+ *                                     batches relayed from the sender's
+ *                                     nodes (see z1_gateway.h)
+ *
+ * Pushing consumes the nodes' spike rasters, like GET /api/snn/events.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_UDP_SPIKES_H
+#define Z1_UDP_SPIKES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_UDP_SOCKET           7       // W5500 socket (HTTP uses 0-6)
+#define Z1_UDP_PORT             5005
+#define Z1_UDP_MAX_DATAGRAM     1472    // UDP payload of one Ethernet frame
+#define Z1_UDP_STEP_US          1000    // Free-running step length assumed for pushes
+#define Z1_UDP_SEND_RETRIES     3       // Failed pushes in a row before the subscriber is dropped
+
+// ============================================================================
+// Datagram Format (little-endian)
+// ============================================================================
+
+#define Z1_UDP_MAGIC            0x315A  // "Z1"
+
+// Datagram types
+#define Z1_UDP_INPUT            0x01
+#define Z1_UDP_SUBSCRIBE        0x02
+#define Z1_UDP_UNSUBSCRIBE      0x03
+#define Z1_UDP_SPIKES           0x04
+#define Z1_UDP_ACK              0x05
+#define Z1_UDP_GATEWAY          0x06
+
+// Header flags
+#define Z1_UDP_FLAG_ACK         0x01    // INPUT: answer with ACK, count = spikes injected
+#define Z1_UDP_FLAG_OVERRUN     0x02    // SPIKES: a node lost records before they were pushed
+#define Z1_UDP_FLAG_LOCAL_IDS   0x04    // SPIKES: neuron IDs are local (no neuron map)
+
+typedef struct __attribute__((packed)) {
+    uint16_t magic;             // Z1_UDP_MAGIC
+    uint8_t  type;              // Z1_UDP_*
+    uint8_t  flags;             // Z1_UDP_FLAG_*
+    uint16_t seq;               // Host: any (echoed in ACK); controller: SPIKES counter
+    uint16_t count;             // Entries after the header
+    uint32_t step;              // SPIKES: timestep of the push; GATEWAY: sender's steps done; otherwise 0
+} z1_udp_header_t;
+
+/**
+ * Input entry (4 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t neuron_id;         // Global neuron ID
+    int16_t  value;             // Q8.8 (Z1_INPUT_VALUE_ONE = 1.0)
+} z1_udp_input_t;
+
+/**
+ * Subscription request (payload of SUBSCRIBE, count 0)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t every_steps;       // Push interval in timesteps (0 = every step)
+    uint16_t reserved;
+} z1_udp_subscribe_t;
+
+/**
+ * Pushed spike (8 bytes, same layout as GET /api/snn/events?format=bin)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  node;              // Node that recorded the spike
+    uint8_t  reserved;
+    uint16_t neuron_id;         // Global ID (local with Z1_UDP_FLAG_LOCAL_IDS)
+    uint32_t step;              // Timestep the neuron fired in
+} z1_udp_spike_t;
+
+/**
+ * Gateway datagram prefix (4 bytes)
+ *
+ * Followed by count z1_spike_batch_header_t blocks, each with its entries,
+ * as the sender's nodes put them on their bus.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  backplane;         // Sending backplane
+    uint8_t  reserved[3];
+} z1_udp_gateway_t;
+
+#define Z1_UDP_MAX_INPUTS   ((Z1_UDP_MAX_DATAGRAM - sizeof(z1_udp_header_t)) / sizeof(z1_udp_input_t))
+#define Z1_UDP_MAX_SPIKES   ((Z1_UDP_MAX_DATAGRAM - sizeof(z1_udp_header_t)) / sizeof(z1_udp_spike_t))
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Open the UDP socket
+ *
+ * @return false if the W5500 did not open it
+ */
+bool z1_udp_spikes_init(void);
+
+/**
+ * Handle received datagrams and push spikes when due (controller main loop)
+ *
+ * @return true while a host is subscribed to a running network, so the
+ *         loop polls instead of sleeping until the next W5500 event
+ */
+bool z1_udp_spikes_service(void);
+
+#endif // Z1_UDP_SPIKES_H
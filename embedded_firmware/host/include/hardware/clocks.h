@@ -0,0 +1,24 @@
+/**
+ * Host shim for hardware/clocks.h
+ *
+ * Off target z1_snn_profile times phases with time_us_32(), so this only
+ * reports the node's nominal 150 MHz system clock.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_HOST_HARDWARE_CLOCKS_H
+#define Z1_HOST_HARDWARE_CLOCKS_H
+
+#include <stdint.h>
+
+enum clock_index {
+    clk_sys = 0
+};
+
+static inline uint32_t clock_get_hz(enum clock_index clk) {
+    (void)clk;
+    return 150000000u;
+}
+
+#endif // Z1_HOST_HARDWARE_CLOCKS_H
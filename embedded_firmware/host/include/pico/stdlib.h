@@ -0,0 +1,17 @@
+/**
+ * Host shim for pico/stdlib.h
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_HOST_PICO_STDLIB_H
+#define Z1_HOST_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/time.h"
+
+static inline void tight_loop_contents(void) {}
+
+#endif // Z1_HOST_PICO_STDLIB_H
@@ -0,0 +1,49 @@
+/**
+ * Host shim for pico/time.h
+ *
+ * Microsecond time since the first call, from CLOCK_MONOTONIC. Only the
+ * calls the node SNN sources use are provided.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_HOST_PICO_TIME_H
+#define Z1_HOST_PICO_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+
+typedef uint64_t absolute_time_t;
+
+static inline uint64_t time_us_64(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
+
+static inline void sleep_us(uint64_t us) {
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static inline void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+#endif // Z1_HOST_PICO_TIME_H
@@ -0,0 +1,101 @@
+/**
+ * Z1 Host Backends
+ *
+ * Stand-ins for the node hardware so the SNN engine sources build and run
+ * as a native library:
+ *
+ *   PSRAM  psram_rp2350.h over a heap array at PSRAM_BASE_ADDRESS; the
+ *          "asynchronous" transfers complete before they return
+ *   Bus    z1_multiframe.h sends and z1_bus_write() frames append to an
+ *          in-process queue that the caller drains with z1_host_bus_pop()
+ *
+ * Single core only: Z1_NODE_DUAL_CORE is not supported off target.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_HOST_H
+#define Z1_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#ifndef Z1_HOST_PSRAM_SIZE
+#define Z1_HOST_PSRAM_SIZE          (8 * 1024 * 1024)   // APS6404L on the node
+#endif
+
+#define Z1_HOST_BUS_QUEUE_DEPTH     64      // Messages held until popped
+#define Z1_HOST_BUS_MAX_PAYLOAD     1024    // Largest spike batch is ~390 bytes
+
+#define Z1_HOST_BUS_MULTICAST       0xFF    // z1_host_bus_msg_t.target of a multicast
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * One message sent by the engine
+ */
+typedef struct {
+    uint8_t target;                 // Destination node, or Z1_HOST_BUS_MULTICAST
+    uint8_t command;                // Z1_CMD_*
+    uint16_t dest_mask;             // Multicast destinations (single target: 1 << target)
+    uint16_t length;                // Payload bytes
+    uint8_t data[Z1_HOST_BUS_MAX_PAYLOAD];
+} z1_host_bus_msg_t;
+
+// ============================================================================
+// PSRAM
+// ============================================================================
+
+/**
+ * Allocate the PSRAM array with a size other than Z1_HOST_PSRAM_SIZE
+ *
+ * Call before psram_init() (which otherwise allocates the default size).
+ *
+ * @param size Bytes of PSRAM to emulate
+ * @return true on success
+ */
+bool z1_host_psram_init(size_t size);
+
+/**
+ * Free the PSRAM array (psram_init() allocates a fresh, zeroed one)
+ */
+void z1_host_psram_deinit(void);
+
+// ============================================================================
+// Bus
+// ============================================================================
+
+/**
+ * Take the oldest queued message
+ *
+ * @param msg Receives the message
+ * @return true if a message was queued
+ */
+bool z1_host_bus_pop(z1_host_bus_msg_t* msg);
+
+/**
+ * Number of messages waiting in the queue
+ */
+uint16_t z1_host_bus_pending(void);
+
+/**
+ * Drop queued messages and clear the counters
+ */
+void z1_host_bus_reset(void);
+
+/**
+ * Read the send counters
+ *
+ * @param sent Messages queued
+ * @param dropped Sends refused because the queue was full or the payload too large
+ */
+void z1_host_bus_get_stats(uint32_t* sent, uint32_t* dropped);
+
+#endif // Z1_HOST_H
@@ -0,0 +1,126 @@
+/**
+ * Z1 Host Bus Backend
+ *
+ * z1_multiframe.h sends become entries of a ring of z1_host_bus_msg_t, and
+ * single frames (z1_bus_write(), spike credit) entries of one data byte.
+ * The burst, chunked and fallback paths all deliver the same way; a full
+ * queue refuses the send like a node that does not answer, so the engine's
+ * send error counters still mean something.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_host.h"
+#include "z1_multiframe.h"
+#include "z1_matrix_bus.h"
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+static z1_host_bus_msg_t g_bus_queue[Z1_HOST_BUS_QUEUE_DEPTH];
+static uint16_t g_bus_head = 0;     // Next message to pop
+static uint16_t g_bus_count = 0;
+static uint32_t g_bus_sent = 0;
+static uint32_t g_bus_dropped = 0;
+
+static bool bus_push(uint8_t target, uint16_t dest_mask, uint8_t command,
+                     const uint8_t* data, uint16_t length) {
+    if (g_bus_count == Z1_HOST_BUS_QUEUE_DEPTH || length > Z1_HOST_BUS_MAX_PAYLOAD ||
+        (length > 0 && !data)) {
+        g_bus_dropped++;
+        return false;
+    }
+
+    z1_host_bus_msg_t* msg = &g_bus_queue[(g_bus_head + g_bus_count) % Z1_HOST_BUS_QUEUE_DEPTH];
+    msg->target = target;
+    msg->command = command;
+    msg->dest_mask = dest_mask;
+    msg->length = length;
+    if (length > 0) {
+        memcpy(msg->data, data, length);
+    }
+    g_bus_count++;
+    g_bus_sent++;
+    return true;
+}
+
+// ============================================================================
+// z1_multiframe.h
+// ============================================================================
+
+bool z1_send_multiframe(uint8_t target_node, uint8_t command,
+                        const uint8_t* data, uint16_t length) {
+    return bus_push(target_node, (uint16_t)(1u << (target_node & 0x0F)), command, data, length);
+}
+
+bool z1_send_multiframe_chunked(uint8_t target_node, uint8_t command,
+                                const uint8_t* data, uint16_t length) {
+    return z1_send_multiframe(target_node, command, data, length);
+}
+
+bool z1_send_multiframe_burst(uint8_t target_node, uint8_t command,
+                              const uint8_t* data, uint16_t length) {
+    return z1_send_multiframe(target_node, command, data, length);
+}
+
+bool z1_send_multicast(uint16_t dest_mask, uint8_t command,
+                       const uint8_t* data, uint16_t length) {
+    return bus_push(Z1_HOST_BUS_MULTICAST, dest_mask, command, data, length);
+}
+
+// ============================================================================
+// z1_matrix_bus.h
+// ============================================================================
+
+bool z1_bus_write(uint8_t target_node, uint8_t command, uint8_t data) {
+    return bus_push(target_node, (uint16_t)(1u << (target_node & 0x0F)), command, &data, 1);
+}
+
+// ============================================================================
+// Queue Access
+// ============================================================================
+
+/**
+ * Take the oldest queued message
+ */
+bool z1_host_bus_pop(z1_host_bus_msg_t* msg) {
+    if (g_bus_count == 0) {
+        return false;
+    }
+
+    *msg = g_bus_queue[g_bus_head];
+    g_bus_head = (g_bus_head + 1) % Z1_HOST_BUS_QUEUE_DEPTH;
+    g_bus_count--;
+    return true;
+}
+
+/**
+ * Number of messages waiting in the queue
+ */
+uint16_t z1_host_bus_pending(void) {
+    return g_bus_count;
+}
+
+/**
+ * Drop queued messages and clear the counters
+ */
+void z1_host_bus_reset(void) {
+    g_bus_head = 0;
+    g_bus_count = 0;
+    g_bus_sent = 0;
+    g_bus_dropped = 0;
+}
+
+/**
+ * Read the send counters
+ */
+void z1_host_bus_get_stats(uint32_t* sent, uint32_t* dropped) {
+    if (sent) {
+        *sent = g_bus_sent;
+    }
+    if (dropped) {
+        *dropped = g_bus_dropped;
+    }
+}
@@ -0,0 +1,143 @@
+/**
+ * Z1 Host PSRAM Backend
+ *
+ * psram_rp2350.h over a zeroed heap array. Addresses keep the device map
+ * (PSRAM_BASE_ADDRESS upwards) so the layout and table code run unchanged.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_host.h"
+#include "psram_rp2350.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+static uint8_t* g_psram = NULL;
+static size_t g_psram_size = 0;
+
+static bool psram_range_valid(uint32_t address, size_t length) {
+    return g_psram && address >= PSRAM_BASE_ADDRESS &&
+           address - PSRAM_BASE_ADDRESS <= g_psram_size &&
+           length <= g_psram_size - (address - PSRAM_BASE_ADDRESS);
+}
+
+/**
+ * Allocate the PSRAM array with a size other than Z1_HOST_PSRAM_SIZE
+ */
+bool z1_host_psram_init(size_t size) {
+    z1_host_psram_deinit();
+
+    g_psram = calloc(1, size);
+    if (!g_psram) {
+        printf("[PSRAM] ERROR: Cannot allocate %zu bytes\n", size);
+        return false;
+    }
+    g_psram_size = size;
+    return true;
+}
+
+/**
+ * Free the PSRAM array
+ */
+void z1_host_psram_deinit(void) {
+    free(g_psram);
+    g_psram = NULL;
+    g_psram_size = 0;
+}
+
+// ============================================================================
+// psram_rp2350.h
+// ============================================================================
+
+bool psram_init(void) {
+    return g_psram || z1_host_psram_init(Z1_HOST_PSRAM_SIZE);
+}
+
+size_t psram_get_size(void) {
+    return g_psram_size;
+}
+
+uint32_t psram_get_base_address(void) {
+    return PSRAM_BASE_ADDRESS;
+}
+
+bool psram_is_initialized(void) {
+    return g_psram != NULL;
+}
+
+bool psram_is_quad_mode(void) {
+    return g_psram != NULL;
+}
+
+bool psram_test_memory(uint32_t test_address) {
+    return psram_range_valid(test_address, 4);
+}
+
+volatile uint8_t* psram_get_pointer(size_t offset) {
+    if (!g_psram || offset >= g_psram_size) {
+        return NULL;
+    }
+    return g_psram + offset;
+}
+
+bool psram_read(uint32_t address, void* buffer, size_t length) {
+    if (!buffer || length == 0 || !psram_range_valid(address, length)) {
+        return false;
+    }
+    memcpy(buffer, g_psram + (address - PSRAM_BASE_ADDRESS), length);
+    return true;
+}
+
+bool psram_write(uint32_t address, const void* buffer, size_t length) {
+    if (!buffer || length == 0 || !psram_range_valid(address, length)) {
+        return false;
+    }
+    memcpy(g_psram + (address - PSRAM_BASE_ADDRESS), buffer, length);
+    return true;
+}
+
+// Transfers finish before the start call returns; the callback still runs
+static bool psram_complete(psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    if (handle) {
+        handle->busy = false;
+        handle->channel = -1;
+        handle->callback = callback;
+        handle->user_data = user_data;
+    }
+    if (callback) {
+        callback(user_data);
+    }
+    return true;
+}
+
+bool psram_read_async(uint32_t address, void* buffer, size_t length,
+                      psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    return psram_read(address, buffer, length) && psram_complete(handle, callback, user_data);
+}
+
+bool psram_write_async(uint32_t address, const void* buffer, size_t length,
+                       psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    return psram_write(address, buffer, length) && psram_complete(handle, callback, user_data);
+}
+
+bool psram_copy_async(uint32_t dst_address, uint32_t src_address, size_t length,
+                      psram_dma_handle_t* handle, psram_dma_callback_t callback, void* user_data) {
+    if (length == 0 || !psram_range_valid(dst_address, length) || !psram_range_valid(src_address, length)) {
+        return false;
+    }
+    memcpy(g_psram + (dst_address - PSRAM_BASE_ADDRESS), g_psram + (src_address - PSRAM_BASE_ADDRESS), length);
+    return psram_complete(handle, callback, user_data);
+}
+
+bool psram_dma_busy(const psram_dma_handle_t* handle) {
+    return handle && handle->busy;
+}
+
+void psram_dma_wait(psram_dma_handle_t* handle) {
+    (void)handle;
+}
@@ -0,0 +1,243 @@
+/**
+ * Z1 SNN Table Replay
+ *
+ * Runs a compiled per-node neuron table (v1 or v2, as written to the node's
+ * staging region by nsnn deploy) through the node engine on the host:
+ *
+ *   z1_snn_replay [-n node] [-s steps] [-r rate] [-v value] [-x seed] [-p bytes] table.bin
+ *
+ * Each step, rate per mille of the input neurons (all neurons if the table
+ * marks none) get an input of value, then the step is released and
+ * waited for through the barrier interface, as z1_bench does on the node.
+ * Outbound spike batches are popped from the host bus queue and counted.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_host.h"
+#include "z1_snn_engine.h"
+#include "z1_psram_neurons.h"
+#include "z1_psram_layout.h"
+#include "psram_rp2350.h"
+#include "pico/time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define REPLAY_DEFAULT_STEPS    1000
+#define REPLAY_DEFAULT_RATE     50          // Per mille of input neurons driven per step
+#define REPLAY_DEFAULT_VALUE    2.0f        // Injected input (Q8.8 range, below 128)
+#define REPLAY_TABLE_V1_ENTRY   256
+#define REPLAY_CHUNK_SIZE       4096
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+static uint32_t g_rng = 0x2545F491;
+static uint16_t g_inputs[Z1_SNN_V2_MAX_NEURONS];
+static uint16_t g_input_count = 0;
+static z1_input_spike_t g_batch[Z1_INPUT_BATCH_MAX];
+static z1_neuron_t g_neuron;
+static z1_snn_status_t g_status;
+
+static uint32_t replay_random(void) {
+    uint32_t x = g_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_rng = x;
+    return x;
+}
+
+// ============================================================================
+// Table Loading
+// ============================================================================
+
+// Copy the table file into the staging region and return its neuron count
+static bool replay_stage(const char* path, uint32_t addr, uint32_t capacity, uint16_t* neuron_count) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("[Replay] ERROR: Cannot open %s\n", path);
+        return false;
+    }
+
+    static uint8_t chunk[REPLAY_CHUNK_SIZE];
+    uint8_t header[8] = {0};
+    uint32_t size = 0;
+    size_t n;
+    bool ok = true;
+    while (ok && (n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        if (size == 0) {
+            memcpy(header, chunk, n < sizeof(header) ? n : sizeof(header));
+        }
+        if (size + n > capacity) {
+            printf("[Replay] ERROR: Table exceeds the %u byte staging region\n", (unsigned int)capacity);
+            ok = false;
+        } else {
+            ok = psram_write(addr + size, chunk, n);
+            size += n;
+        }
+    }
+    fclose(f);
+    if (!ok || size == 0) {
+        return false;
+    }
+
+    if (memcmp(header, "Z1N", 3) == 0) {
+        memcpy(neuron_count, header + 4, 2);
+    } else {
+        *neuron_count = (uint16_t)(size / REPLAY_TABLE_V1_ENTRY);
+    }
+    printf("[Replay] Staged %s: %u bytes, %u neurons\n", path, (unsigned int)size, *neuron_count);
+    return true;
+}
+
+// Neurons the table marks as inputs, or all of them
+static void replay_find_inputs(uint16_t neuron_count) {
+    g_input_count = 0;
+    for (uint16_t i = 0; i < neuron_count; i++) {
+        if (z1_psram_read_neuron_params(i, &g_neuron) && (g_neuron.flags & Z1_NEURON_FLAG_INPUT)) {
+            g_inputs[g_input_count++] = i;
+        }
+    }
+    if (g_input_count == 0) {
+        for (uint16_t i = 0; i < neuron_count; i++) {
+            g_inputs[g_input_count++] = i;
+        }
+    }
+}
+
+// ============================================================================
+// Stepping
+// ============================================================================
+
+static void replay_drive(uint16_t drive, int16_t value) {
+    for (uint16_t k = 0; k < drive; k++) {
+        g_batch[k].local_id = g_inputs[replay_random() % g_input_count];
+        g_batch[k].value = value;
+    }
+    z1_snn_engine_inject_batch((const uint8_t*)g_batch, drive * sizeof(z1_input_spike_t));
+}
+
+// Release one step, run it and flush its egress; count what reached the bus
+static bool replay_step(uint32_t step, uint32_t* messages, uint32_t* bytes) {
+    static z1_host_bus_msg_t msg;
+
+    z1_snn_engine_sync_tick((uint8_t)step);
+    z1_snn_engine_sync_step();
+
+    uint8_t step_lo;
+    for (int tries = 0; !z1_snn_engine_sync_poll(&step_lo); tries++) {
+        if (tries > 1000) {
+            return false;
+        }
+        z1_snn_engine_service_egress();
+    }
+
+    while (z1_host_bus_pop(&msg)) {
+        (*messages)++;
+        *bytes += msg.length;
+    }
+    return true;
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [-n node] [-s steps] [-r rate] [-v value] [-x seed] [-p bytes] table.bin\n", name);
+    printf("  -n node   Node ID the table was compiled for (default 0)\n");
+    printf("  -s steps  Timesteps to run (default %d)\n", REPLAY_DEFAULT_STEPS);
+    printf("  -r rate   Input neurons driven per step, per mille (default %d)\n", REPLAY_DEFAULT_RATE);
+    printf("  -v value  Input added to each driven neuron (default %.1f)\n", REPLAY_DEFAULT_VALUE);
+    printf("  -x seed   Input pattern seed\n");
+    printf("  -p bytes  Emulated PSRAM size (default %d; the layout scales with it)\n", Z1_HOST_PSRAM_SIZE);
+}
+
+int main(int argc, char** argv) {
+    uint8_t node_id = 0;
+    uint32_t steps = REPLAY_DEFAULT_STEPS;
+    uint32_t rate = REPLAY_DEFAULT_RATE;
+    float value = REPLAY_DEFAULT_VALUE;
+    size_t psram_size = Z1_HOST_PSRAM_SIZE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:r:v:x:p:h")) != -1) {
+        switch (opt) {
+            case 'n': node_id = (uint8_t)atoi(optarg); break;
+            case 's': steps = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': rate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'v': value = strtof(optarg, NULL); break;
+            case 'x': g_rng = (uint32_t)strtoul(optarg, NULL, 0) | 1; break;
+            case 'p': psram_size = (size_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc - 1 || node_id >= Z1_MAX_NODES || rate > 1000 || value <= -128.0f || value >= 128.0f) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!z1_host_psram_init(psram_size) || !psram_init() || !z1_snn_engine_init(node_id)) {
+        return 1;
+    }
+
+    const z1_psram_layout_t* layout = z1_psram_layout_get();
+    uint16_t neuron_count = 0;
+    if (!replay_stage(argv[optind], layout->staging_addr, layout->staging_size, &neuron_count) ||
+        !z1_snn_engine_load_network(layout->staging_addr, neuron_count)) {
+        return 1;
+    }
+
+    z1_snn_engine_get_status(&g_status);
+    neuron_count = g_status.neuron_count;
+    replay_find_inputs(neuron_count);
+
+    z1_snn_engine_set_sync(true);
+    if (!z1_snn_engine_start()) {
+        return 1;
+    }
+
+    uint16_t drive = (uint32_t)g_input_count * rate / 1000;
+    if (drive > Z1_INPUT_BATCH_MAX) {
+        drive = Z1_INPUT_BATCH_MAX;
+    }
+
+    z1_snn_engine_get_status(&g_status);
+    uint32_t spikes_before = g_status.spikes_generated;
+    uint32_t events_before = g_status.synapse_events;
+    uint32_t messages = 0;
+    uint32_t bytes = 0;
+    uint32_t done = 0;
+
+    uint64_t start_us = time_us_64();
+    for (uint32_t step = 1; step <= steps; step++) {
+        if (drive > 0) {
+            replay_drive(drive, (int16_t)(value * Z1_INPUT_VALUE_ONE));
+        }
+        if (!replay_step(step, &messages, &bytes)) {
+            printf("[Replay] ERROR: Step %u was not reported\n", (unsigned int)step);
+            break;
+        }
+        done++;
+    }
+    uint64_t run_us = time_us_64() - start_us;
+
+    z1_snn_engine_get_status(&g_status);
+    z1_snn_engine_stop();
+
+    uint32_t spikes = g_status.spikes_generated - spikes_before;
+    uint32_t events = g_status.synapse_events - events_before;
+    uint32_t dropped = 0;
+    z1_host_bus_get_stats(NULL, &dropped);
+    double seconds = run_us > 0 ? run_us / 1e6 : 1e-6;
+
+    printf("[Replay] %u neurons (%u inputs, %u driven per step)\n",
+           neuron_count, g_input_count, drive);
+    printf("[Replay] %u steps in %.3f s: %.0f steps/s\n", (unsigned int)done, seconds, done / seconds);
+    printf("[Replay] %u spikes, %u synapse events (%.2f M events/s)\n",
+           (unsigned int)spikes, (unsigned int)events, events / seconds / 1e6);
+    printf("[Replay] Bus: %u messages, %u bytes, %u refused\n",
+           (unsigned int)messages, (unsigned int)bytes, (unsigned int)dropped);
+
+    return done == steps ? 0 : 1;
+}
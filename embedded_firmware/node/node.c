@@ -4,6 +4,7 @@
 #include "pico/time.h"
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"
+#include "pico/multicore.h"
 
 #include "hardware/regs/io_bank0.h"
 #include "hardware/regs/sio.h"
@@ -15,7 +16,17 @@
 #include "z1_matrix_bus.h"
 #include "z1_snn_engine.h"
 #include "psram_rp2350.h"
+#include "z1_psram_layout.h"
 #include "z1_multiframe.h"
+#include "z1_trace.h"
+#include "z1_snn_profile.h"
+#include "z1_spike_recorder.h"
+#include "z1_firmware_rx.h"
+#include "z1_bench.h"
+#include "z1_spike_tdma.h"
+#include "z1_spike_batch.h"
+#include "z1_bus_rx.h"
+#include "z1_mem_read.h"
 
 // LED Pin Definitions for nodes (PWM capable pins)
 #define LED_GREEN      44
@@ -32,13 +43,68 @@ static bool ping_response_pending = false;
 static uint8_t ping_response_target = 0;
 static uint8_t ping_response_data = 0;
 
+// SNN status response state (sent from the main loop like ping responses)
+static volatile bool status_response_pending = false;
+static uint8_t status_response_target = 0;
+static bool status_response_reset = false;
+
+// Spike raster readback (Z1_CMD_SNN_GET_SPIKES), also sent from the main loop
+static volatile bool spikes_response_pending = false;
+static uint8_t spikes_response_target = 0;
+static z1_spike_read_req_t spikes_request;
+static uint8_t spikes_response_buffer[sizeof(z1_spike_raster_header_t) +
+                                      Z1_SPIKE_REC_READ_MAX * sizeof(z1_spike_raster_t)]
+    __attribute__((aligned(4)));
+
+// Chunk hashes of a memory range (Z1_CMD_MEM_HASH), computed in the main loop
+static volatile bool hash_response_pending = false;
+static uint8_t hash_response_target = 0;
+static z1_mem_hash_req_t hash_request;
+static uint32_t hash_response_buffer[Z1_MEM_HASH_MAX];
+
+// Synapse weight patch (Z1_CMD_SNN_WEIGHT_UPDATE), applied in the main loop
+static volatile bool weights_patch_pending = false;
+static uint8_t weights_patch_target = 0;
+static uint16_t weights_patch_length = 0;
+static uint8_t weights_patch_buffer[Z1_WEIGHT_PATCH_MAX];
+
+// Firmware chunk bitmap (Z1_CMD_FIRMWARE_STATUS), sent from the main loop
+static volatile bool fw_status_pending = false;
+static uint8_t fw_status_target = 0;
+
+// Benchmark request (Z1_CMD_BENCH), run in the main loop
+static volatile bool bench_pending = false;
+static uint8_t bench_target = 0;
+static z1_bench_req_t bench_request;
+static uint8_t bench_response_buffer[Z1_BENCH_RESULT_MAX] __attribute__((aligned(4)));
+
+// SNN checkpoint save, query and restore (Z1_CMD_SNN_CHECKPOINT/RESTORE), run in the main loop
+static volatile bool ckpt_save_pending = false;
+static volatile bool ckpt_query_pending = false;
+static volatile bool ckpt_restore_pending = false;
+static uint8_t ckpt_query_target = 0;
+static uint8_t ckpt_restore_target = 0;
+static z1_snn_ckpt_info_t ckpt_info = { .status = Z1_SNN_CKPT_STATUS_NONE };
+
+// Batch progress queries (Z1_CMD_SNN_BATCH), answered from the main loop
+static volatile bool batch_query_pending = false;
+static uint8_t batch_query_target = 0;
+
 // SNN engine state
 static bool snn_initialized = false;
 static bool snn_running = false;
 
-// Multi-frame receive buffer
-static uint8_t multiframe_buffer[4096];
-static uint8_t multiframe_command = 0;
+// Dual-core mode: core1 steps the SNN at a fixed timestep
+#define SNN_CORE1_STEP_US 1000
+
+// Idle main loop: wait between checks for captured bus messages
+#define BUS_RX_POLL_US 100
+
+// Sender of the bus message being dispatched (z1_bus_rx.h)
+static uint8_t bus_sender = 0;
+
+// Streamed MEM_WRITE: device address of the next payload byte
+static uint32_t mem_write_addr = 0;
 
 // PWM slice numbers for LEDs
 static uint red_slice, green_slice, blue_slice;
@@ -126,11 +192,188 @@ void set_led_pwm(uint8_t led_pin, uint8_t pwm_value) {
            Z1_NODE_ID, led_pin, pwm_value, pwm_level);
 }
 
+// Handle inter-node spike payload: [global_id:4][timestamp:4][flags:1]
+static void handle_spike_payload(const uint8_t* payload, uint16_t length) {
+    if (length != 9) {
+        printf("[Node %d] ⚠️  Received incomplete spike data\n", Z1_NODE_ID);
+        return;
+    }
+    
+    uint32_t global_id;
+    uint32_t timestamp;
+    uint8_t flags;
+    
+    memcpy(&global_id, payload, 4);
+    memcpy(&timestamp, payload + 4, 4);
+    flags = payload[8];
+    
+    // global_id is the source neuron; the engine fans it out to local targets
+    z1_snn_process_spike(global_id, timestamp, flags);
+}
+
+// MEM_WRITE [addr:4][data:N]: validate the destination once the address lands
+static bool mem_write_begin(const uint8_t* header, uint16_t length) {
+    uint32_t addr;
+    memcpy(&addr, header, 4);
+    printf("[Node %d] Writing %d bytes to PSRAM addr 0x%08X\n",
+           Z1_NODE_ID, length, (unsigned int)addr);
+    
+    // Host tools address PSRAM through the 0x20000000 window
+    uint32_t device_addr = z1_psram_layout_host_to_device(addr);
+    if (device_addr == 0 ||
+        (length > 0 && z1_psram_layout_host_to_device(addr + length - 1) == 0)) {
+        printf("[Node %d] ⚠️  Write 0x%08X+%d is outside PSRAM\n",
+               Z1_NODE_ID, (unsigned int)addr, length);
+        return false;
+    }
+    
+    mem_write_addr = device_addr;
+    return true;
+}
+
+// MEM_WRITE payload chunk: written in place while the next chunk is received
+static bool mem_write_chunk(const uint8_t* data, uint16_t length) {
+    if (!psram_write(mem_write_addr, data, length)) {
+        return false;
+    }
+    mem_write_addr += length;
+    return true;
+}
+
+static void mem_write_end(bool ok) {
+    if (!ok) {
+        // Chunks already written stay in place; the host must resend
+        printf("[Node %d] ⚠️  MEM_WRITE failed (range or checksum)\n", Z1_NODE_ID);
+    }
+}
+
+static const z1_multiframe_sink_t mem_write_sink = {
+    .command = Z1_CMD_MEM_WRITE,
+    .header_size = 4,
+    .begin = mem_write_begin,
+    .write = mem_write_chunk,
+    .end = mem_write_end,
+};
+
+// MEM_HASH: hash the requested range chunk by chunk; returns the hash count
+static uint16_t compute_mem_hashes(const z1_mem_hash_req_t* req, uint32_t* hashes) {
+    static uint8_t block[256] __attribute__((aligned(4)));
+    
+    uint32_t device_addr = z1_psram_layout_host_to_device(req->addr);
+    if (req->length == 0 || device_addr == 0 ||
+        z1_psram_layout_host_to_device(req->addr + req->length - 1) == 0) {
+        printf("[Node %d] ⚠️  Hash range 0x%08X+%u is outside PSRAM\n",
+               Z1_NODE_ID, (unsigned int)req->addr, (unsigned int)req->length);
+        return 0;
+    }
+    
+    uint32_t chunks = (req->length + Z1_MEM_HASH_CHUNK - 1) / Z1_MEM_HASH_CHUNK;
+    if (chunks > Z1_MEM_HASH_MAX) {
+        chunks = Z1_MEM_HASH_MAX;
+    }
+    
+    for (uint32_t c = 0; c < chunks; c++) {
+        uint32_t offset = c * Z1_MEM_HASH_CHUNK;
+        uint32_t end = offset + Z1_MEM_HASH_CHUNK;
+        if (end > req->length) end = req->length;
+        
+        uint32_t hash = Z1_HASH32_INIT;
+        while (offset < end) {
+            uint32_t n = (end - offset < sizeof(block)) ? end - offset : sizeof(block);
+            if (!psram_read(device_addr + offset, block, n)) {
+                return 0;
+            }
+            hash = z1_hash32_update(hash, block, n);
+            offset += n;
+        }
+        hashes[c] = hash;
+    }
+    return (uint16_t)chunks;
+}
+
+// Load the deployed neuron table from the PSRAM staging region
+static void load_neuron_table(uint16_t neuron_count) {
+    if (!snn_initialized) {
+        return;
+    }
+    
+    printf("[Node %d] 🧠 Loading %d neurons from PSRAM...\n", Z1_NODE_ID, neuron_count);
+    
+    // Deploys write the table to the staging region (host 0x20100000)
+    uint32_t table_addr = z1_psram_layout_get()->staging_addr;
+    if (z1_snn_load_table(table_addr, neuron_count)) {
+        printf("[Node %d] ✅ Loaded %d neurons\n", Z1_NODE_ID, neuron_count);
+        set_led_pwm(LED_GREEN, 100);  // Green = loaded
+    } else {
+        printf("[Node %d] ❌ Failed to load neurons\n", Z1_NODE_ID);
+        set_led_pwm(LED_RED, 100);  // Red = error
+    }
+}
+
+// Dispatch a completed multi-frame (chunked or burst) payload
+static void handle_multiframe_complete(uint8_t command, const uint8_t* payload, uint16_t length) {
+    Z1_TRACE(APP, Z1_TRACE_DEBUG, Z1_EV_APP_MULTIFRAME, command, length);
+           
+    // Handle the command based on type (MEM_WRITE is streamed by mem_write_sink)
+    if (command == Z1_CMD_SNN_SPIKE && snn_running) {
+        handle_spike_payload(payload, length);
+    } else if (command == Z1_CMD_SNN_SPIKE_BATCH && snn_running) {
+        // Decoded straight into the engine's ingress queue
+        z1_snn_process_spike_batch(payload, length);
+    } else if (command == Z1_CMD_SNN_INPUT_SPIKE && snn_running) {
+        // Batched form: z1_input_spike_t entries routed here by the controller
+        z1_snn_inject_batch(payload, length);
+    } else if (command == Z1_CMD_SNN_GET_SPIKES && length >= 2) {
+        // Request payload: z1_spike_read_req_t (flags optional)
+        memset(&spikes_request, 0, sizeof(spikes_request));
+        memcpy(&spikes_request, payload,
+               length < sizeof(spikes_request) ? length : sizeof(spikes_request));
+        spikes_response_target = bus_sender;
+        spikes_response_pending = true;
+    } else if (command == Z1_CMD_MEM_READ_REQ) {
+        // Blocks go out from the main loop as the reader acknowledges them
+        z1_mem_read_request(bus_sender, payload, length);
+    } else if (command == Z1_CMD_MEM_HASH && length >= sizeof(hash_request)) {
+        memcpy(&hash_request, payload, sizeof(hash_request));
+        hash_response_target = bus_sender;
+        hash_response_pending = true;
+    } else if (command == Z1_CMD_SNN_WEIGHT_UPDATE && !weights_patch_pending &&
+               length <= sizeof(weights_patch_buffer)) {
+        memcpy(weights_patch_buffer, payload, length);
+        weights_patch_length = length;
+        weights_patch_target = bus_sender;
+        weights_patch_pending = true;
+    } else if (command == Z1_CMD_BENCH && !bench_pending && length >= 1) {
+        // Request payload: z1_bench_req_t (trailing fields optional)
+        memset(&bench_request, 0, sizeof(bench_request));
+        memcpy(&bench_request, payload,
+               length < sizeof(bench_request) ? length : sizeof(bench_request));
+        bench_target = bus_sender;
+        bench_pending = true;
+    } else if (command == Z1_CMD_SNN_LOAD_TABLE && length >= 2) {
+        // [neuron_count:2]
+        uint16_t neuron_count;
+        memcpy(&neuron_count, payload, 2);
+        load_neuron_table(neuron_count);
+    } else if (command == Z1_CMD_SNN_TDMA && length >= sizeof(z1_snn_tdma_config_t)) {
+        z1_snn_tdma_config_t tdma_config;
+        memcpy(&tdma_config, payload, sizeof(tdma_config));
+        z1_spike_tdma_configure(&tdma_config);
+    } else if (command == Z1_CMD_BENCH_SINK) {
+        z1_bench_sink(length);
+    } else if (command == Z1_CMD_FIRMWARE_BEGIN) {
+        z1_firmware_rx_begin(payload, length);
+    } else if (command == Z1_CMD_FIRMWARE_UPLOAD) {
+        // Chunks failing their CRC32 stay missing in the bitmap and are resent
+        z1_firmware_rx_chunk(payload, length);
+    } else if (command == Z1_CMD_FIRMWARE_VERIFY) {
+        z1_firmware_rx_request_verify(payload, length);
+    }
+}
+
 // Process bus commands and update LEDs
 void process_bus_command(uint8_t command, uint8_t data) {
-    printf("\n[Node %d] *** PROCESSING BUS COMMAND ***\n", Z1_NODE_ID);
-    printf("[Node %d] Command: 0x%02X, Data: %d, Sender: node %d\n", 
-           Z1_NODE_ID, command, data, z1_last_sender_id);
+    Z1_TRACE(APP, Z1_TRACE_INFO, Z1_EV_APP_COMMAND, bus_sender, (command << 8) | data);
     
     switch (command) {
         // LED Control Commands
@@ -155,86 +398,37 @@ void process_bus_command(uint8_t command, uint8_t data) {
         case Z1_CMD_STATUS:
             printf("[Node %d] 📊 STATUS response - R:%d G:%d B:%d\n", 
                    Z1_NODE_ID, led_red_pwm, led_green_pwm, led_blue_pwm);
+            z1_psram_layout_print();
             break;
             
         case Z1_CMD_PING:
             printf("[Node %d] 🏓 PING received with data 0x%02X\n", Z1_NODE_ID, data);
             ping_response_pending = true;
-            ping_response_target = z1_last_sender_id;
+            ping_response_target = bus_sender;
             ping_response_data = data;
             break;
         
-        // Multi-frame Protocol Commands
-        case Z1_CMD_FRAME_START:
-            multiframe_command = data;  // Command is passed as data byte
-            z1_multiframe_handle_start(z1_last_sender_id, data);
-            printf("[Node %d] 📦 FRAME_START for command 0x%02X\n", Z1_NODE_ID, data);
-            break;
-            
-        case Z1_CMD_FRAME_DATA:
-            // data contains sequence number, next frame has actual data
-            printf("[Node %d] 📦 FRAME_DATA seq %d\n", Z1_NODE_ID, data);
-            break;
-            
-        case Z1_CMD_FRAME_END:
-            z1_multiframe_handle_end(data);  // data is checksum
-            printf("[Node %d] 📦 FRAME_END (checksum 0x%02X)\n", Z1_NODE_ID, data);
-            
-            // Process the received multi-frame command
-            if (z1_multiframe_rx_complete()) {
-                uint16_t length = z1_multiframe_rx_length();
-                printf("[Node %d] Processing multiframe command 0x%02X (%d bytes)\n",
-                       Z1_NODE_ID, multiframe_command, length);
-                       
-                // Handle the command based on type
-                if (multiframe_command == Z1_CMD_MEM_WRITE) {
-                    // Memory write: [addr:4][data:N]
-                    if (length >= 4) {
-                        uint32_t addr;
-                        memcpy(&addr, multiframe_buffer, 4);
-                        uint16_t data_len = length - 4;
-                        printf("[Node %d] Writing %d bytes to PSRAM addr 0x%08X\n",
-                               Z1_NODE_ID, data_len, (unsigned int)addr);
-                        psram_write(addr, multiframe_buffer + 4, data_len);
-                    }
-                }
-                
-                z1_multiframe_rx_reset();
-            }
-            break;
+        // Multi-frame transfers arrive reassembled (handle_multiframe_complete())
         
         // SNN Engine Commands
         case Z1_CMD_SNN_LOAD_TABLE:
-            if (snn_initialized) {
-                printf("[Node %d] 🧠 Loading neuron table from PSRAM...\n", Z1_NODE_ID);
-                // Neuron count comes via multi-frame: [neuron_count:2]
-                uint16_t neuron_count = 0;
-                if (z1_multiframe_rx_complete() && z1_multiframe_rx_length() >= 2) {
-                    memcpy(&neuron_count, multiframe_buffer, 2);
-                    z1_multiframe_rx_reset();
-                } else {
-                    // Fallback: try to get from data byte (legacy)
-                    neuron_count = data;
-                }
-                
-                printf("[Node %d] 🧠 Loading %d neurons from PSRAM...\n", Z1_NODE_ID, neuron_count);
-                
-                // Assume table is at standard address
-                uint32_t table_addr = 0x20100000;
-                if (z1_snn_load_table(table_addr, neuron_count)) {
-                    printf("[Node %d] ✅ Loaded %d neurons\n", Z1_NODE_ID, neuron_count);
-                    set_led_pwm(LED_GREEN, 100);  // Green = loaded
-                } else {
-                    printf("[Node %d] ❌ Failed to load neurons\n", Z1_NODE_ID);
-                    set_led_pwm(LED_RED, 100);  // Red = error
-                }
-            }
+            // Neuron count normally comes as a multi-frame payload [neuron_count:2];
+            // a single frame carries it in the data byte (legacy)
+            load_neuron_table(data);
             break;
             
         case Z1_CMD_SNN_START:
             if (snn_initialized && !snn_running) {
                 printf("[Node %d] 🧠 Starting SNN execution\n", Z1_NODE_ID);
-                if (z1_snn_start()) {
+                z1_snn_engine_set_sync((data & Z1_SNN_START_SYNC) != 0);
+                z1_spike_tdma_enable((data & Z1_SNN_START_SYNC) && (data & Z1_SNN_START_TDMA));
+                
+                // Batches are staged where deploys put the table
+                const z1_psram_layout_t* layout = z1_psram_layout_get();
+                bool armed = (data & Z1_SNN_START_BATCH)
+                    ? z1_snn_engine_set_batch(layout->staging_addr, layout->staging_size)
+                    : z1_snn_engine_set_batch(0, 0);
+                if (armed && z1_snn_start()) {
                     snn_running = true;
                     set_led_pwm(LED_BLUE, 100);  // Blue = running
                     printf("[Node %d] ✅ SNN started\n", Z1_NODE_ID);
@@ -247,6 +441,13 @@ void process_bus_command(uint8_t command, uint8_t data) {
                 printf("[Node %d] 🧠 Stopping SNN execution\n", Z1_NODE_ID);
                 z1_snn_stop();
                 snn_running = false;
+                if (z1_spike_tdma_enabled()) {
+                    z1_spike_tdma_stats_t tdma;
+                    z1_spike_tdma_get_stats(&tdma);
+                    printf("[Node %d] TDMA: %lu rounds, %lu marker / %lu window starts, %lu overruns\n",
+                           Z1_NODE_ID, (unsigned long)tdma.rounds, (unsigned long)tdma.marker_starts,
+                           (unsigned long)tdma.window_starts, (unsigned long)tdma.overruns);
+                }
                 set_led_pwm(LED_BLUE, 0);
                 printf("[Node %d] ✅ SNN stopped\n", Z1_NODE_ID);
             }
@@ -256,38 +457,90 @@ void process_bus_command(uint8_t command, uint8_t data) {
             if (snn_running) {
                 // data byte contains local neuron ID (low 8 bits)
                 uint16_t local_neuron_id = data;
-                printf("[Node %d] 🧠 Injecting spike to neuron %d\n", 
-                       Z1_NODE_ID, local_neuron_id);
+                Z1_TRACE(SNN, Z1_TRACE_INFO, Z1_EV_SNN_INJECT, local_neuron_id, 0);
                 z1_snn_inject_input(local_neuron_id, 1.0f);
             }
             break;
             
+        case Z1_CMD_SNN_TICK:
+            // Broadcast by the controller once every node finished the previous step
+            z1_snn_engine_sync_tick(data);
+            z1_spike_tdma_round_start();
+            break;
+            
+        case Z1_CMD_SNN_SLOT_DONE:
+            // Another node closed its TDMA slot
+            z1_spike_tdma_slot_done(data);
+            break;
+            
+        case Z1_CMD_SNN_CREDIT:
+            // A destination took spikes off its queue
+            z1_spike_batch_credit(bus_sender, data);
+            break;
+            
+        case Z1_CMD_MEM_READ_ACK:
+            // The reader made room for more memory read blocks
+            z1_mem_read_ack(bus_sender, data);
+            break;
+            
+        case Z1_CMD_SNN_GET_STATUS:
+            // data bit 0: clear timing counters once they have been read
+            status_response_target = bus_sender;
+            status_response_reset = (data & 0x01) != 0;
+            status_response_pending = true;
+            break;
+            
+        case Z1_CMD_SNN_GET_SPIKES:
+            // Single-byte form: data = Z1_SPIKE_READ_* flags, as many records as fit
+            spikes_request.max_records = Z1_SPIKE_REC_READ_MAX;
+            spikes_request.flags = data;
+            spikes_response_target = bus_sender;
+            spikes_response_pending = true;
+            break;
+            
+        case Z1_CMD_FIRMWARE_STATUS:
+            fw_status_target = bus_sender;
+            fw_status_pending = true;
+            break;
+            
+        case Z1_CMD_BENCH:
+            // Single-byte form: data = Z1_BENCH_* test, default parameters
+            if (!bench_pending) {
+                memset(&bench_request, 0, sizeof(bench_request));
+                bench_request.test = data;
+                bench_target = bus_sender;
+                bench_pending = true;
+            }
+            break;
+            
+        case Z1_CMD_BENCH_SINK:
+            z1_bench_sink(1);
+            break;
+            
+        case Z1_CMD_SNN_CHECKPOINT:
+            // A save is not answered, so the controller can broadcast it
+            if (data == Z1_SNN_CKPT_SAVE) {
+                ckpt_save_pending = true;
+            } else {
+                ckpt_query_target = bus_sender;
+                ckpt_query_pending = true;
+            }
+            break;
+            
+        case Z1_CMD_SNN_RESTORE:
+            ckpt_restore_target = bus_sender;
+            ckpt_restore_pending = true;
+            break;
+            
+        case Z1_CMD_SNN_BATCH:
+            batch_query_target = bus_sender;
+            batch_query_pending = true;
+            break;
+            
         case Z1_CMD_SNN_SPIKE:
+            // Spike data comes via multi-frame: [global_id:4][timestamp:4][flags:1]
             if (snn_running) {
-                // Inter-node spike routing
-                // Spike data comes via multi-frame: [global_id:4][timestamp:4][flags:1]
-                if (z1_multiframe_rx_complete() && z1_multiframe_rx_length() == 9) {
-                    uint32_t global_id;
-                    uint32_t timestamp;
-                    uint8_t flags;
-                    
-                    memcpy(&global_id, multiframe_buffer, 4);
-                    memcpy(&timestamp, multiframe_buffer + 4, 4);
-                    flags = multiframe_buffer[8];
-                    
-                    // Extract local neuron ID from global ID
-                    uint16_t local_id = global_id & 0xFFFF;
-                    
-                    printf("[Node %d] 🧠 Received spike for neuron %d (global 0x%08X)\n", 
-                           Z1_NODE_ID, local_id, (unsigned int)global_id);
-                    
-                    // Inject spike into local neuron
-                    z1_snn_inject_input(local_id, 1.0f);
-                    
-                    z1_multiframe_rx_reset();
-                } else {
-                    printf("[Node %d] ⚠️  Received incomplete spike data\n", Z1_NODE_ID);
-                }
+                printf("[Node %d] ⚠️  Received incomplete spike data\n", Z1_NODE_ID);
             }
             break;
             
@@ -295,13 +548,104 @@ void process_bus_command(uint8_t command, uint8_t data) {
             printf("[Node %d] ❓ UNKNOWN command 0x%02X\n", Z1_NODE_ID, command);
             break;
     }
+}
+
+#ifdef Z1_NODE_DUAL_CORE
+// Core1: owns z1_snn_step(); bus, multiframe and LEDs stay on core0
+static void core1_entry(void) {
+    uint32_t last_step_us = time_us_32();
     
-    printf("[Node %d] *** COMMAND PROCESSING COMPLETE ***\n\n", Z1_NODE_ID);
+    while (true) {
+        if (!z1_snn_engine_is_running()) {
+            tight_loop_contents();
+            continue;
+        }
+        
+        // Barrier mode: step when the controller releases the next step
+        if (z1_snn_engine_sync_enabled()) {
+            z1_snn_engine_sync_step();
+            continue;
+        }
+        
+        // Free-running batch: steps back to back on logical time
+        if (z1_snn_engine_batch_enabled()) {
+            z1_snn_engine_batch_step();
+            continue;
+        }
+        
+        uint32_t now_us = time_us_32();
+        if (now_us - last_step_us >= SNN_CORE1_STEP_US) {
+            z1_snn_step(now_us);
+            last_step_us = now_us;
+        }
+    }
 }
+#endif
 
-// Callback function called by bus interrupt handler when commands are received
+// TDMA barrier mode: send the step's spikes and the SLOT_DONE marker in our slot
+static void service_snn_slot(void) {
+    static bool marker_pending = false;
+    static uint8_t marker_step;
+    
+    if (!z1_spike_tdma_my_turn()) {
+        return;
+    }
+    
+    // The spikes go out before the marker so the slot holds all of our
+    // traffic; a node with nothing to send only broadcasts the marker
+    z1_snn_engine_service_egress();
+    if (!marker_pending) {
+        marker_pending = z1_snn_engine_sync_poll(&marker_step);
+    }
+    
+    // Retried while the slot lasts if the bus was busy
+    if (marker_pending &&
+        z1_bus_broadcast_us(Z1_CMD_SNN_SLOT_DONE, z1_snn_slot_done_data(Z1_NODE_ID, marker_step),
+                            Z1_SNN_SLOT_DONE_HOLD_US)) {
+        marker_pending = false;
+        z1_spike_tdma_finish();
+    }
+}
+
+// Barrier mode: run released steps, report STEP_DONE, then send the step's spikes
+static void service_snn_sync(void) {
+#ifndef Z1_NODE_DUAL_CORE
+    z1_snn_engine_sync_step();
+#endif
+    
+    if (z1_spike_tdma_enabled()) {
+        service_snn_slot();
+        return;
+    }
+    
+    // A lost report is recovered by the controller repeating its tick
+    uint8_t step_lo;
+    if (z1_snn_engine_sync_poll(&step_lo)) {
+        z1_bus_write(Z1_CONTROLLER_ID, Z1_CMD_SNN_STEP_DONE, step_lo);
+    }
+    
+    z1_snn_engine_service_egress();
+}
+
+// Deferred bus message (main loop, z1_bus_rx_dispatch())
+static void handle_bus_message(const z1_bus_rx_msg_t* msg) {
+    bus_sender = msg->sender;
+    if (msg->length > 0) {
+        handle_multiframe_complete(msg->command, msg->payload, msg->length);
+    } else {
+        process_bus_command(msg->command, msg->data);
+    }
+}
+
+// Callback function called by bus interrupt handler when commands are received:
+// capture only, the command runs from the main loop
 void z1_bus_process_command(uint8_t command, uint8_t data) {
-    process_bus_command(command, data);
+    z1_bus_rx_capture(z1_last_sender_id, command, data);
+}
+
+// Called by the bus interrupt handler before it acknowledges a transaction
+bool z1_bus_accept_transaction(void) {
+    return z1_bus_rx_ready();
 }
 
 // Main loop for node operation
@@ -351,12 +695,14 @@ int main() {
         printf("Node %d: ❌ FATAL: Failed to initialize PSRAM\n", Z1_NODE_ID);
         return -1;
     }
-    printf("Node %d: ✅ PSRAM initialized (8MB available)\n", Z1_NODE_ID);
+    printf("Node %d: ✅ PSRAM initialized (%u MB available)\n", Z1_NODE_ID,
+           (unsigned int)(psram_get_size() / (1024 * 1024)));
     
-    // Initialize multi-frame receive buffer
-    z1_multiframe_rx_init(multiframe_buffer, sizeof(multiframe_buffer));
-    printf("Node %d: ✅ Multi-frame RX buffer ready (%d bytes)\n", 
-           Z1_NODE_ID, (int)sizeof(multiframe_buffer));
+    // Initialize the deferred receive path and its multi-frame buffer
+    z1_bus_rx_init(handle_bus_message);
+    z1_multiframe_rx_set_sink(&mem_write_sink);
+    printf("Node %d: ✅ Multi-frame RX buffer ready (%d bytes, MEM_WRITE streamed)\n", 
+           Z1_NODE_ID, Z1_BUS_RX_FRAME_BUFFER);
     
     // Initialize SNN engine
     printf("Node %d: Initializing SNN engine...\n", Z1_NODE_ID);
@@ -368,6 +714,16 @@ int main() {
         snn_initialized = true;
     }
     
+    // Firmware images are staged in the PSRAM region the layout reserves for them
+    z1_firmware_rx_init(z1_psram_layout_get()->firmware_addr, z1_psram_layout_get()->firmware_size);
+    z1_bench_init(Z1_NODE_ID);
+    z1_spike_tdma_init(Z1_NODE_ID);
+    
+#ifdef Z1_NODE_DUAL_CORE
+    multicore_launch_core1(core1_entry);
+    printf("Node %d: ✅ SNN stepping on core1 (%d us timestep)\n", Z1_NODE_ID, SNN_CORE1_STEP_US);
+#endif
+    
     printf("Node %d: 🔄 Entering main loop - listening for bus transactions\n", Z1_NODE_ID);
     
     // Startup LED sequence to show we're alive
@@ -398,12 +754,26 @@ int main() {
         
         // Call bus handler (mostly handled by interrupts now)
         z1_bus_handle_interrupt();
+        z1_bus_rx_dispatch();
+        
+        // Trace records are formatted here, away from the bus and SNN paths
+        z1_trace_drain_stdio(Z1_TRACE_DRAIN_PER_LOOP);
         
         // Process SNN engine if running
-        if (snn_running) {
+#ifdef Z1_NODE_DUAL_CORE
+        // core1 steps; forward its outbound spikes onto the bus (TDMA runs
+        // send only in our slot, from service_snn_sync())
+        if (!z1_spike_tdma_enabled()) {
+            z1_snn_engine_service_egress();
+        }
+#else
+        if (snn_running && z1_snn_engine_batch_enabled()) {
+            z1_snn_engine_batch_step();
+        } else if (snn_running && !z1_snn_engine_sync_enabled()) {
             uint32_t current_time_us = time_us_32();
             z1_snn_step(current_time_us);
         }
+#endif
         
         // Handle deferred ping responses (outside interrupt context)
         if (ping_response_pending) {
@@ -420,8 +790,156 @@ int main() {
             ping_response_pending = false;  // Clear the flag
         }
         
+        // Handle deferred SNN status responses
+        if (status_response_pending) {
+            static z1_snn_status_t status;
+            status_response_pending = false;
+            
+            z1_snn_engine_get_status(&status);
+            if (status_response_reset) {
+                z1_snn_profile_request_reset();
+            }
+            if (!z1_send_multiframe(status_response_target, Z1_CMD_SNN_GET_STATUS,
+                                    (const uint8_t*)&status, sizeof(status))) {
+                printf("[Node %d] ❌ SNN status response to node %d failed\n",
+                       Z1_NODE_ID, status_response_target);
+            }
+        }
+        
+        // Handle deferred spike raster reads (burst multi-frame, up to 4 KB)
+        if (spikes_response_pending) {
+            spikes_response_pending = false;
+            
+            uint16_t length = z1_snn_engine_get_spikes(&spikes_request, spikes_response_buffer,
+                                                       sizeof(spikes_response_buffer));
+            if (!z1_send_multiframe(spikes_response_target, Z1_CMD_SNN_GET_SPIKES,
+                                    spikes_response_buffer, length)) {
+                // Keep the records for the next request
+                z1_spike_raster_header_t header;
+                memcpy(&header, spikes_response_buffer, sizeof(header));
+                z1_spike_recorder_seek(header.first_seq);
+                printf("[Node %d] ❌ Spike raster response to node %d failed\n",
+                       Z1_NODE_ID, spikes_response_target);
+            }
+        }
+        
+        // Stream memory read-back blocks within the reader's window
+        z1_mem_read_service();
+        
+        // Handle deferred chunk hash requests (deploys skip chunks that match)
+        if (hash_response_pending) {
+            hash_response_pending = false;
+            
+            uint16_t count = compute_mem_hashes(&hash_request, hash_response_buffer);
+            if (count > 0 &&
+                !z1_send_multiframe(hash_response_target, Z1_CMD_MEM_HASH,
+                                    (const uint8_t*)hash_response_buffer, count * sizeof(uint32_t))) {
+                printf("[Node %d] ❌ Hash response to node %d failed\n",
+                       Z1_NODE_ID, hash_response_target);
+            }
+        }
+        
+        // Handle deferred weight patches (the controller waits for the result)
+        if (weights_patch_pending) {
+            z1_weight_patch_result_t result;
+            if (!z1_snn_engine_patch_weights(weights_patch_buffer, weights_patch_length, &result)) {
+                printf("[Node %d] ⚠️  Malformed weight patch (%d bytes)\n",
+                       Z1_NODE_ID, weights_patch_length);
+            }
+            weights_patch_pending = false;
+            
+            printf("[Node %d] 🧠 Weight patch: %u applied, %u rejected\n",
+                   Z1_NODE_ID, result.applied, result.rejected);
+            if (!z1_send_multiframe(weights_patch_target, Z1_CMD_SNN_WEIGHT_UPDATE,
+                                    (const uint8_t*)&result, sizeof(result))) {
+                printf("[Node %d] ❌ Weight patch result to node %d failed\n",
+                       Z1_NODE_ID, weights_patch_target);
+            }
+        }
+        
+        // Whole-image firmware check, then chunk bitmap requests
+        z1_firmware_rx_service();
+        if (fw_status_pending) {
+            z1_fw_status_t status;
+            fw_status_pending = false;
+            
+            z1_firmware_rx_get_status(&status);
+            if (!z1_send_multiframe(fw_status_target, Z1_CMD_FIRMWARE_STATUS,
+                                    (const uint8_t*)&status, sizeof(status))) {
+                printf("[Node %d] ❌ Firmware status response to node %d failed\n",
+                       Z1_NODE_ID, fw_status_target);
+            }
+        }
+        
+        // Benchmarks block the loop until done; the controller waits for the result
+        if (bench_pending) {
+            uint16_t length = z1_bench_run(&bench_request, bench_response_buffer,
+                                           sizeof(bench_response_buffer));
+            bench_pending = false;
+            
+            if (!z1_send_multiframe(bench_target, Z1_CMD_BENCH, bench_response_buffer, length)) {
+                printf("[Node %d] ❌ Benchmark result to node %d failed\n",
+                       Z1_NODE_ID, bench_target);
+            }
+        }
+        
+        // Checkpoints go to and come from the deploy staging area; a query
+        // is answered after a save that arrived before it
+        if (ckpt_save_pending) {
+            const z1_psram_layout_t* layout = z1_psram_layout_get();
+            ckpt_save_pending = false;
+            z1_snn_engine_checkpoint(layout->staging_addr, layout->staging_size, &ckpt_info);
+        }
+        if (ckpt_query_pending) {
+            ckpt_query_pending = false;
+            if (!z1_send_multiframe(ckpt_query_target, Z1_CMD_SNN_CHECKPOINT,
+                                    (const uint8_t*)&ckpt_info, sizeof(ckpt_info))) {
+                printf("[Node %d] ❌ Checkpoint info to node %d failed\n",
+                       Z1_NODE_ID, ckpt_query_target);
+            }
+        }
+        if (ckpt_restore_pending) {
+            const z1_psram_layout_t* layout = z1_psram_layout_get();
+            z1_snn_ckpt_info_t restored;
+            ckpt_restore_pending = false;
+            
+            z1_snn_engine_restore(layout->staging_addr, layout->staging_size, &restored);
+            if (!z1_send_multiframe(ckpt_restore_target, Z1_CMD_SNN_RESTORE,
+                                    (const uint8_t*)&restored, sizeof(restored))) {
+                printf("[Node %d] ❌ Restore result to node %d failed\n",
+                       Z1_NODE_ID, ckpt_restore_target);
+            }
+        }
+        if (batch_query_pending) {
+            z1_snn_batch_info_t info;
+            batch_query_pending = false;
+            
+            z1_snn_engine_batch_get_info(&info);
+            info.capacity = z1_psram_layout_get()->staging_size;
+            if (!z1_send_multiframe(batch_query_target, Z1_CMD_SNN_BATCH,
+                                    (const uint8_t*)&info, sizeof(info))) {
+                printf("[Node %d] ❌ Batch info to node %d failed\n",
+                       Z1_NODE_ID, batch_query_target);
+            }
+        }
+        
         loop_count++;
-        sleep_ms(10);  // Small delay to prevent excessive polling
+        
+        // Run captured bus messages for the rest of the loop period; barrier
+        // mode also serves its ticks here
+        absolute_time_t loop_end = make_timeout_time_ms(10);
+        while (!time_reached(loop_end)) {
+            z1_bus_rx_dispatch();
+            if (snn_running && z1_snn_engine_sync_enabled()) {
+                service_snn_sync();
+#ifndef Z1_NODE_DUAL_CORE
+            } else if (snn_running && z1_snn_engine_batch_step()) {
+                continue;  // Free-running batch: steps fill the loop period
+#endif
+            } else if (!z1_bus_rx_pending()) {
+                sleep_us(BUS_RX_POLL_US);
+            }
+        }
     }
     
     return 0;
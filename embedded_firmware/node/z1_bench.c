@@ -0,0 +1,387 @@
+/**
+ * Z1 Node Benchmarks
+ *
+ * The SNN test drives the engine through its barrier interface, the same
+ * path as a controller-ticked run: one tick, wait for the step to be
+ * reported, next tick. On a dual-core build core1 does the stepping and
+ * this loop only waits, so the numbers are those of the stepping core.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_bench.h"
+#include "z1_snn_engine.h"
+#include "z1_psram_neurons.h"
+#include "z1_psram_layout.h"
+#include "z1_synapse_index.h"
+#include "psram_rp2350.h"
+#include "pico/stdlib.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+static uint8_t g_bench_node_id = 0;
+static uint32_t g_bench_rng = 0;
+
+// Z1_CMD_BENCH_SINK traffic since the last clear (bus receive path)
+static volatile uint32_t g_sink_transfers = 0;
+static volatile uint32_t g_sink_bytes = 0;
+
+// Table writer stage and PSRAM test buffer
+static uint8_t g_bench_block[Z1_BENCH_BLOCK_SIZE] __attribute__((aligned(4)));
+
+static z1_neuron_t g_bench_neuron;
+static uint8_t g_bench_entry[Z1_NEURON_ENTRY_SIZE];
+static z1_input_spike_t g_bench_inputs[Z1_INPUT_BATCH_MAX];
+static z1_snn_status_t g_bench_status;
+
+static uint32_t bench_random(void) {
+    uint32_t x = g_bench_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_bench_rng = x;
+    return x;
+}
+
+/**
+ * Set the node ID used for synthetic source IDs
+ */
+void z1_bench_init(uint8_t node_id) {
+    g_bench_node_id = node_id;
+}
+
+// ============================================================================
+// Synthetic Network
+// ============================================================================
+
+// Sequential PSRAM writes through g_bench_block
+typedef struct {
+    uint32_t addr;
+    uint16_t used;
+    bool failed;
+} bench_writer_t;
+
+static void bench_flush(bench_writer_t* w) {
+    if (w->used > 0 && !psram_write(w->addr, g_bench_block, w->used)) {
+        w->failed = true;
+    }
+    w->addr += w->used;
+    w->used = 0;
+}
+
+static void bench_put(bench_writer_t* w, const void* data, uint16_t length) {
+    const uint8_t* p = data;
+    while (length > 0) {
+        uint16_t n = sizeof(g_bench_block) - w->used;
+        if (n > length) n = length;
+
+        memcpy(g_bench_block + w->used, p, n);
+        w->used += n;
+        p += n;
+        length -= n;
+        if (w->used == sizeof(g_bench_block)) {
+            bench_flush(w);
+        }
+    }
+}
+
+static uint32_t bench_table_size(uint16_t neurons, uint16_t fan_in) {
+    return Z1_NEURON_TABLE_HEADER_SIZE + (uint32_t)neurons * Z1_NEURON_PARAM_SIZE +
+           ((uint32_t)neurons + 1) * 4 + (uint32_t)neurons * fan_in * 4;
+}
+
+// v2 table: fan_in random local sources per neuron, all excitatory and equal
+static bool bench_build_network(uint32_t addr, uint16_t neurons, uint16_t fan_in) {
+    bench_writer_t w = { .addr = addr };
+    g_bench_rng = 0x2545F491u ^ g_bench_node_id;
+
+    z1_neuron_table_header_t header = {
+        .magic = { 'Z', '1', 'N' },
+        .version = Z1_NEURON_TABLE_V2,
+        .neuron_count = neurons,
+        .param_size = Z1_NEURON_PARAM_SIZE,
+        .synapse_count = (uint32_t)neurons * fan_in,
+    };
+    bench_put(&w, &header, sizeof(header));
+
+    // Routed with an empty mask: every spike stays on this node
+    memset(&g_bench_neuron, 0, sizeof(g_bench_neuron));
+    g_bench_neuron.flags = Z1_NEURON_FLAG_ACTIVE | Z1_NEURON_FLAG_ROUTED;
+    g_bench_neuron.threshold = 1.0f;
+    g_bench_neuron.leak_rate = 0.1f;
+    g_bench_neuron.refractory_period_us = 2000;
+    g_bench_neuron.synapse_count = fan_in;
+    for (uint16_t i = 0; i < neurons; i++) {
+        g_bench_neuron.neuron_id = i;
+        g_bench_neuron.global_id = i;
+        z1_psram_serialize_neuron(&g_bench_neuron, g_bench_entry);
+        bench_put(&w, g_bench_entry, Z1_NEURON_PARAM_SIZE);
+    }
+
+    for (uint32_t i = 0; i <= neurons; i++) {
+        uint32_t offset = i * fan_in;
+        bench_put(&w, &offset, sizeof(offset));
+    }
+
+    uint8_t weight = (uint8_t)(Z1_BENCH_WEIGHT * 63.5f);
+    uint32_t node_base = (uint32_t)g_bench_node_id << 16;
+    for (uint16_t i = 0; i < neurons; i++) {
+        for (uint16_t s = 0; s < fan_in; s++) {
+            uint16_t source = bench_random() % neurons;
+            if (source == i) {
+                source = (source + 1) % neurons;
+            }
+            z1_synapse_t synapse = z1_synapse_pack(node_base | source, weight);
+            bench_put(&w, &synapse, sizeof(synapse));
+        }
+    }
+
+    bench_flush(&w);
+    return !w.failed;
+}
+
+// Release one step and wait until the engine reports it done
+static bool bench_step(uint32_t step) {
+    z1_snn_engine_sync_tick((uint8_t)step);
+#ifndef Z1_NODE_DUAL_CORE
+    z1_snn_engine_sync_step();
+#endif
+
+    uint32_t start_us = time_us_32();
+    uint8_t step_lo;
+    while (!z1_snn_engine_sync_poll(&step_lo)) {
+        if (time_us_32() - start_us > Z1_BENCH_STEP_TIMEOUT_US) {
+            return false;
+        }
+        z1_snn_engine_service_egress();
+    }
+    return true;
+}
+
+// Inject Z1_BENCH_DRIVE into drive evenly spaced neurons from a random start
+static void bench_drive(uint16_t neurons, uint16_t drive) {
+    uint16_t start = bench_random() % neurons;
+    uint16_t stride = neurons / drive;
+    for (uint16_t k = 0; k < drive; k++) {
+        g_bench_inputs[k].local_id = (start + (uint32_t)k * stride) % neurons;
+        g_bench_inputs[k].value = (int16_t)(Z1_BENCH_DRIVE * Z1_INPUT_VALUE_ONE);
+    }
+    z1_snn_engine_inject_batch((const uint8_t*)g_bench_inputs, drive * sizeof(z1_input_spike_t));
+}
+
+static void bench_snn(const z1_bench_req_t* req, z1_bench_snn_result_t* r) {
+    const z1_psram_layout_t* layout = z1_psram_layout_get();
+    r->neurons = req->neurons ? req->neurons : Z1_BENCH_DEFAULT_NEURONS;
+    r->fan_in = req->fan_in ? req->fan_in : Z1_BENCH_DEFAULT_FAN_IN;
+    r->rate = req->rate ? req->rate : Z1_BENCH_DEFAULT_RATE;
+    uint32_t steps = req->steps ? req->steps : Z1_BENCH_DEFAULT_STEPS;
+
+    uint32_t index_capacity = layout->index_size / Z1_SYNAPSE_INDEX_ENTRY_SIZE;
+    if (r->neurons < 2 || r->neurons > layout->max_neurons ||
+        r->neurons > Z1_SYNAPSE_INDEX_MAX_SOURCES || r->rate > 1000 ||
+        bench_table_size(r->neurons, r->fan_in) > layout->staging_size ||
+        (uint32_t)r->neurons * r->fan_in > index_capacity) {
+        printf("[Bench] ERROR: %u neurons x %u synapses do not fit (max %u neurons, %u synapses)\n",
+               r->neurons, r->fan_in, layout->max_neurons, (unsigned int)index_capacity);
+        r->status = Z1_BENCH_STATUS_BAD_PARAMS;
+        return;
+    }
+    if (z1_snn_engine_is_running()) {
+        r->status = Z1_BENCH_STATUS_BUSY;
+        return;
+    }
+
+    uint32_t setup_start = time_us_32();
+    if (!bench_build_network(layout->staging_addr, r->neurons, r->fan_in) ||
+        !z1_snn_engine_load_network(layout->staging_addr, r->neurons)) {
+        r->status = Z1_BENCH_STATUS_FAILED;
+        return;
+    }
+
+    bool was_sync = z1_snn_engine_sync_enabled();
+    z1_snn_engine_set_sync(true);
+    if (!z1_snn_engine_start()) {
+        z1_snn_engine_set_sync(was_sync);
+        r->status = Z1_BENCH_STATUS_FAILED;
+        return;
+    }
+    r->setup_us = time_us_32() - setup_start;
+
+    uint16_t drive = (uint32_t)r->neurons * r->rate / 1000;
+    if (drive > Z1_INPUT_BATCH_MAX) {
+        drive = Z1_INPUT_BATCH_MAX;
+    }
+
+    z1_snn_engine_get_status(&g_bench_status);
+    uint32_t steps_before = g_bench_status.steps_completed;
+    uint32_t spikes_before = g_bench_status.spikes_generated;
+    uint32_t events_before = g_bench_status.synapse_events;
+
+    uint32_t run_start = time_us_32();
+    uint32_t step = 1;
+    for (; step <= steps; step++) {
+        if (drive > 0) {
+            bench_drive(r->neurons, drive);
+            r->inputs += drive;
+        }
+        if (!bench_step(step)) {
+            printf("[Bench] ERROR: Step %u timed out\n", (unsigned int)step);
+            r->status = Z1_BENCH_STATUS_FAILED;
+            break;
+        }
+    }
+    r->run_us = time_us_32() - run_start;
+
+    z1_snn_engine_get_status(&g_bench_status);
+    r->steps = g_bench_status.steps_completed - steps_before;
+    r->spikes = g_bench_status.spikes_generated - spikes_before;
+    r->synapse_events = g_bench_status.synapse_events - events_before;
+
+    z1_snn_engine_stop();
+    z1_snn_engine_set_sync(was_sync);
+
+    printf("[Bench] SNN: %u neurons x %u synapses, %u steps in %u us, %u spikes, %u synapse events\n",
+           r->neurons, r->fan_in, (unsigned int)r->steps, (unsigned int)r->run_us,
+           (unsigned int)r->spikes, (unsigned int)r->synapse_events);
+}
+
+// ============================================================================
+// PSRAM Bandwidth
+// ============================================================================
+
+static void bench_fill(void) {
+    uint32_t* words = (uint32_t*)g_bench_block;
+    for (uint32_t i = 0; i < sizeof(g_bench_block) / 4; i++) {
+        words[i] = 0xA5A50000u ^ (i * 2654435761u);
+    }
+}
+
+static bool bench_check(void) {
+    const uint32_t* words = (const uint32_t*)g_bench_block;
+    for (uint32_t i = 0; i < sizeof(g_bench_block) / 4; i++) {
+        if (words[i] != (0xA5A50000u ^ (i * 2654435761u))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One pass over [addr, addr + bytes); returns elapsed µs or 0 on failure
+static uint32_t bench_psram_pass(uint32_t addr, uint32_t bytes, bool write, bool dma) {
+    psram_dma_handle_t handle = {0};
+    uint32_t start = time_us_32();
+
+    for (uint32_t offset = 0; offset < bytes; offset += Z1_BENCH_BLOCK_SIZE) {
+        bool ok;
+        if (dma) {
+            ok = write ? psram_write_async(addr + offset, g_bench_block, Z1_BENCH_BLOCK_SIZE,
+                                           &handle, NULL, NULL)
+                       : psram_read_async(addr + offset, g_bench_block, Z1_BENCH_BLOCK_SIZE,
+                                          &handle, NULL, NULL);
+            psram_dma_wait(&handle);
+        } else {
+            ok = write ? psram_write(addr + offset, g_bench_block, Z1_BENCH_BLOCK_SIZE)
+                       : psram_read(addr + offset, g_bench_block, Z1_BENCH_BLOCK_SIZE);
+        }
+        if (!ok) {
+            return 0;
+        }
+    }
+
+    uint32_t elapsed = time_us_32() - start;
+    return elapsed > 0 ? elapsed : 1;
+}
+
+static void bench_psram(const z1_bench_req_t* req, z1_bench_psram_result_t* r) {
+    const z1_psram_layout_t* layout = z1_psram_layout_get();
+    uint32_t bytes = req->bytes ? req->bytes : Z1_BENCH_DEFAULT_BYTES;
+    bytes -= bytes % Z1_BENCH_BLOCK_SIZE;
+
+    r->block_size = Z1_BENCH_BLOCK_SIZE;
+    r->bytes = bytes;
+    if (bytes == 0 || bytes > layout->staging_size) {
+        r->status = Z1_BENCH_STATUS_BAD_PARAMS;
+        return;
+    }
+    if (z1_snn_engine_is_running()) {
+        r->status = Z1_BENCH_STATUS_BUSY;
+        return;
+    }
+
+    // Every pass moves the same pattern, so the last read can be checked
+    uint32_t addr = layout->staging_addr;
+    bench_fill();
+    r->xip_write_us = bench_psram_pass(addr, bytes, true, false);
+    r->xip_read_us = bench_psram_pass(addr, bytes, false, false);
+    r->dma_write_us = bench_psram_pass(addr, bytes, true, true);
+    r->dma_read_us = bench_psram_pass(addr, bytes, false, true);
+
+    if (!r->xip_write_us || !r->xip_read_us || !r->dma_write_us || !r->dma_read_us ||
+        !bench_check()) {
+        printf("[Bench] ERROR: PSRAM pass failed or read back wrong data\n");
+        r->status = Z1_BENCH_STATUS_FAILED;
+        return;
+    }
+
+    printf("[Bench] PSRAM %u bytes: XIP read %u us, write %u us; DMA read %u us, write %u us\n",
+           (unsigned int)bytes, (unsigned int)r->xip_read_us, (unsigned int)r->xip_write_us,
+           (unsigned int)r->dma_read_us, (unsigned int)r->dma_write_us);
+}
+
+// ============================================================================
+// Bus Sink
+// ============================================================================
+
+/**
+ * Count one Z1_CMD_BENCH_SINK transfer
+ */
+void z1_bench_sink(uint16_t bytes) {
+    g_sink_transfers++;
+    g_sink_bytes += bytes;
+}
+
+static void bench_sink_read(const z1_bench_req_t* req, z1_bench_sink_result_t* r) {
+    r->transfers = g_sink_transfers;
+    r->bytes = g_sink_bytes;
+    if (req->flags & Z1_BENCH_SINK_CLEAR) {
+        g_sink_transfers = 0;
+        g_sink_bytes = 0;
+    }
+}
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+/**
+ * Run a benchmark
+ */
+uint16_t z1_bench_run(const z1_bench_req_t* req, uint8_t* result, uint16_t size) {
+    if (size < Z1_BENCH_RESULT_MAX) {
+        return 0;
+    }
+    memset(result, 0, Z1_BENCH_RESULT_MAX);
+    result[0] = req->test;
+
+    switch (req->test) {
+        case Z1_BENCH_SNN:
+            bench_snn(req, (z1_bench_snn_result_t*)result);
+            return sizeof(z1_bench_snn_result_t);
+
+        case Z1_BENCH_PSRAM:
+            bench_psram(req, (z1_bench_psram_result_t*)result);
+            return sizeof(z1_bench_psram_result_t);
+
+        case Z1_BENCH_SINK:
+            bench_sink_read(req, (z1_bench_sink_result_t*)result);
+            return sizeof(z1_bench_sink_result_t);
+
+        default:
+            result[1] = Z1_BENCH_STATUS_BAD_PARAMS;
+            return sizeof(z1_bench_sink_result_t);
+    }
+}
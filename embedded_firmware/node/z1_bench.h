@@ -0,0 +1,76 @@
+/**
+ * Z1 Node Benchmarks
+ *
+ * Reproducible measurements behind Z1_CMD_BENCH (see z1_protocol.h):
+ *
+ *   Z1_BENCH_SNN    builds a synthetic network of the requested size and
+ *                   fan-in, loads it and times a run of barrier steps in
+ *                   which rate per mille of the neurons get a
+ *                   suprathreshold input each step
+ *   Z1_BENCH_PSRAM  moves the same bytes through psram_read()/psram_write()
+ *                   (XIP memcpy) and through the DMA transfer functions
+ *   Z1_BENCH_SINK   reports the Z1_CMD_BENCH_SINK traffic counted since the
+ *                   last clear, for the controller's bus throughput test
+ *
+ * The SNN and PSRAM tests use the deploy staging area, so a table staged
+ * but not yet loaded is lost, and the SNN test replaces the loaded
+ * network. Both refuse to run while the SNN is running.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_BENCH_H
+#define Z1_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+// Defaults for zero request fields
+#define Z1_BENCH_DEFAULT_NEURONS    1024
+#define Z1_BENCH_DEFAULT_FAN_IN     16
+#define Z1_BENCH_DEFAULT_RATE       50          // Per mille of neurons driven per step
+#define Z1_BENCH_DEFAULT_STEPS      1000
+#define Z1_BENCH_DEFAULT_BYTES      (256 * 1024)  // Beyond the 16 KB XIP cache
+
+#define Z1_BENCH_WEIGHT             0.05f       // Every synthetic synapse
+#define Z1_BENCH_DRIVE              2.0f        // Injected input (threshold is 1.0)
+#define Z1_BENCH_BLOCK_SIZE         4096        // PSRAM test transfer size
+#define Z1_BENCH_STEP_TIMEOUT_US    100000      // Longest wait for one step
+
+// Largest result structure
+#define Z1_BENCH_RESULT_MAX         sizeof(z1_bench_snn_result_t)
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Set the node ID used for synthetic source IDs
+ *
+ * @param node_id This node's bus ID
+ */
+void z1_bench_init(uint8_t node_id);
+
+/**
+ * Run a benchmark (main loop; blocks until done)
+ *
+ * @param req Request (zero fields take the defaults above)
+ * @param result Buffer for the result structure of the test
+ * @param size Buffer capacity (at least Z1_BENCH_RESULT_MAX)
+ * @return Result length, 0 if the buffer is too small
+ */
+uint16_t z1_bench_run(const z1_bench_req_t* req, uint8_t* result, uint16_t size);
+
+/**
+ * Count one Z1_CMD_BENCH_SINK transfer (bus receive path)
+ *
+ * @param bytes Payload bytes (1 for a single frame)
+ */
+void z1_bench_sink(uint16_t bytes);
+
+#endif // Z1_BENCH_H
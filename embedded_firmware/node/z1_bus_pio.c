@@ -0,0 +1,345 @@
+/**
+ * Z1 Matrix Bus PIO Backend
+ *
+ * Frame handshake on PIO0 with DMA on both directions. See z1_bus.pio
+ * for the state machine programs.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_bus_pio.h"
+#include "z1_matrix_bus.h"
+#include "z1_bus.pio.h"
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+volatile uint32_t z1_bus_pio_frame_hz = Z1_BUS_PIO_DEFAULT_FRAME_HZ;
+
+static PIO g_pio = pio0;
+static uint g_tx_sm = 0;
+static uint g_rx_sm = 0;
+static uint g_tx_offset = 0;
+static uint g_rx_offset = 0;
+static int g_tx_dma = -1;
+static int g_rx_dma = -1;
+static bool g_pio_ready = false;
+
+// DMA source for TX: one 32-bit FIFO word per frame
+static uint32_t g_tx_words[Z1_BUS_PIO_MAX_FRAMES];
+static uint16_t g_tx_count = 0;
+static bool g_tx_last = false;
+static uint16_t g_rx_count = 0;
+
+static z1_bus_pio_stats_t g_pio_stats = {0};
+
+// ============================================================================
+// State Machine Helpers
+// ============================================================================
+
+static void set_lane_oe_override(enum gpio_override override) {
+    gpio_set_oeover(BUSCLK_PIN, override);
+    for (int i = 0; i < 16; i++) {
+        gpio_set_oeover(BUS0_PIN + i, override);
+    }
+}
+
+/**
+ * Reset a state machine to the start of its program
+ */
+static void sm_reset(uint sm, uint offset) {
+    pio_sm_set_enabled(g_pio, sm, false);
+    pio_sm_clear_fifos(g_pio, sm);
+    pio_sm_restart(g_pio, sm);
+    pio_sm_exec(g_pio, sm, pio_encode_jmp(offset));
+}
+
+static void tx_sm_init(void) {
+    pio_sm_config c = z1_bus_tx_program_get_default_config(g_tx_offset);
+
+    sm_config_set_out_pins(&c, BUS0_PIN, 16);
+    sm_config_set_sideset_pins(&c, BUSCLK_PIN);
+    sm_config_set_in_pins(&c, BUSACK_PIN);
+    sm_config_set_out_shift(&c, true, false, 32);   // LSB first, explicit pull
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+
+    float div = (float)clock_get_hz(clk_sys) /
+                ((float)z1_bus_pio_frame_hz * Z1_BUS_PIO_TX_CYCLES);
+    sm_config_set_clkdiv(&c, div < 1.0f ? 1.0f : div);
+
+    // BUSCLK idles high; lanes stay PIO outputs and are gated by the OE override
+    pio_sm_set_pins_with_mask(g_pio, g_tx_sm, 1u << BUSCLK_PIN, 1u << BUSCLK_PIN);
+    pio_sm_set_consecutive_pindirs(g_pio, g_tx_sm, BUSCLK_PIN, 1, true);
+    pio_sm_set_consecutive_pindirs(g_pio, g_tx_sm, BUS0_PIN, 16, true);
+
+    pio_sm_init(g_pio, g_tx_sm, g_tx_offset, &c);
+    pio_sm_set_enabled(g_pio, g_tx_sm, true);
+}
+
+static void rx_sm_init(void) {
+    pio_sm_config c = z1_bus_rx_program_get_default_config(g_rx_offset);
+
+    sm_config_set_in_pins(&c, BUS0_PIN);
+    sm_config_set_jmp_pin(&c, BUSCLK_PIN);
+    sm_config_set_in_shift(&c, false, true, 16);    // Frame lands in bits [15:0]
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&c, 1.0f);
+
+    // Armed per transaction by z1_bus_pio_receive_start()
+    pio_sm_init(g_pio, g_rx_sm, g_rx_offset, &c);
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+
+/**
+ * Initialize PIO state machines and DMA channels
+ */
+bool z1_bus_pio_init(void) {
+    if (!pio_can_add_program(g_pio, &z1_bus_tx_program) ||
+        !pio_can_add_program(g_pio, &z1_bus_rx_program)) {
+        printf("[Z1 Bus PIO] ERROR: No PIO0 instruction memory\n");
+        return false;
+    }
+
+    int tx_sm = pio_claim_unused_sm(g_pio, false);
+    int rx_sm = pio_claim_unused_sm(g_pio, false);
+    if (tx_sm < 0 || rx_sm < 0) {
+        printf("[Z1 Bus PIO] ERROR: No free PIO0 state machines\n");
+        return false;
+    }
+    g_tx_sm = (uint)tx_sm;
+    g_rx_sm = (uint)rx_sm;
+
+    g_tx_dma = dma_claim_unused_channel(false);
+    g_rx_dma = dma_claim_unused_channel(false);
+    if (g_tx_dma < 0 || g_rx_dma < 0) {
+        printf("[Z1 Bus PIO] ERROR: No free DMA channels\n");
+        return false;
+    }
+
+    g_tx_offset = pio_add_program(g_pio, &z1_bus_tx_program);
+    g_rx_offset = pio_add_program(g_pio, &z1_bus_rx_program);
+
+    // Hand BUSCLK and data lanes to PIO, released until we own the bus
+    set_lane_oe_override(GPIO_OVERRIDE_LOW);
+    pio_gpio_init(g_pio, BUSCLK_PIN);
+    for (int i = 0; i < 16; i++) {
+        pio_gpio_init(g_pio, BUS0_PIN + i);
+    }
+
+    tx_sm_init();
+    rx_sm_init();
+
+    // TX: frame words -> TX FIFO
+    dma_channel_config tx_cfg = dma_channel_get_default_config(g_tx_dma);
+    channel_config_set_transfer_data_size(&tx_cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&tx_cfg, true);
+    channel_config_set_write_increment(&tx_cfg, false);
+    channel_config_set_dreq(&tx_cfg, pio_get_dreq(g_pio, g_tx_sm, true));
+    dma_channel_configure(g_tx_dma, &tx_cfg, &g_pio->txf[g_tx_sm], g_tx_words, 0, false);
+
+    // RX: RX FIFO -> frame buffer
+    dma_channel_config rx_cfg = dma_channel_get_default_config(g_rx_dma);
+    channel_config_set_transfer_data_size(&rx_cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&rx_cfg, false);
+    channel_config_set_write_increment(&rx_cfg, true);
+    channel_config_set_dreq(&rx_cfg, pio_get_dreq(g_pio, g_rx_sm, false));
+    dma_channel_configure(g_rx_dma, &rx_cfg, NULL, &g_pio->rxf[g_rx_sm], 0, false);
+
+    g_pio_ready = true;
+
+    printf("[Z1 Bus PIO] Initialized: TX sm%d, RX sm%d, DMA %d/%d, %u frames/s\n",
+           g_tx_sm, g_rx_sm, g_tx_dma, g_rx_dma, (unsigned int)z1_bus_pio_frame_hz);
+    return true;
+}
+
+/**
+ * Change frame rate
+ */
+bool z1_bus_pio_set_frame_rate(uint32_t frame_hz) {
+    if (!g_pio_ready || frame_hz == 0) {
+        return false;
+    }
+
+    float div = (float)clock_get_hz(clk_sys) / ((float)frame_hz * Z1_BUS_PIO_TX_CYCLES);
+    if (div < 1.0f) {
+        printf("[Z1 Bus PIO] ERROR: %u frames/s exceeds PIO clock\n", (unsigned int)frame_hz);
+        return false;
+    }
+
+    z1_bus_pio_frame_hz = frame_hz;
+    pio_sm_set_clkdiv(g_pio, g_tx_sm, div);
+    return true;
+}
+
+// ============================================================================
+// Pin Ownership
+// ============================================================================
+
+void z1_bus_pio_attach(void) {
+    set_lane_oe_override(GPIO_OVERRIDE_NORMAL);
+}
+
+void z1_bus_pio_detach(void) {
+    set_lane_oe_override(GPIO_OVERRIDE_LOW);
+}
+
+void z1_bus_pio_pins_to_sio(void) {
+    for (int i = 0; i < 16; i++) {
+        gpio_set_oeover(BUS0_PIN + i, GPIO_OVERRIDE_NORMAL);
+        gpio_set_dir(BUS0_PIN + i, GPIO_IN);
+        gpio_set_function(BUS0_PIN + i, GPIO_FUNC_SIO);
+    }
+}
+
+void z1_bus_pio_pins_to_pio(void) {
+    for (int i = 0; i < 16; i++) {
+        gpio_set_oeover(BUS0_PIN + i, GPIO_OVERRIDE_LOW);
+        pio_gpio_init(g_pio, BUS0_PIN + i);
+    }
+}
+
+// ============================================================================
+// Transmit
+// ============================================================================
+
+/**
+ * Start frame transfer
+ */
+bool z1_bus_pio_send_start(const uint16_t* frames, uint16_t count, bool last) {
+    if (!g_pio_ready || count == 0 || count > Z1_BUS_PIO_MAX_FRAMES) {
+        return false;
+    }
+
+    if (dma_channel_is_busy(g_tx_dma)) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        g_tx_words[i] = frames[i];
+    }
+    if (last) {
+        g_tx_words[count - 1] |= Z1_BUS_PIO_LAST_FRAME;
+    }
+    g_tx_count = count;
+    g_tx_last = last;
+
+    pio_interrupt_clear(g_pio, g_tx_sm);
+    dma_channel_transfer_from_buffer_now(g_tx_dma, g_tx_words, count);
+    return true;
+}
+
+/**
+ * Wait for frame transfer
+ */
+bool z1_bus_pio_send_wait(uint32_t timeout_us) {
+    absolute_time_t deadline = make_timeout_time_us(timeout_us);
+
+    // TX program raises IRQ (0 rel) once BUSACK is released after the last frame
+    while (g_tx_last ? !pio_interrupt_get(g_pio, g_tx_sm) : dma_channel_is_busy(g_tx_dma)) {
+        if (time_reached(deadline)) {
+            dma_channel_abort(g_tx_dma);
+            sm_reset(g_tx_sm, g_tx_offset);
+            pio_sm_set_enabled(g_pio, g_tx_sm, true);
+            g_pio_stats.tx_timeouts++;
+            return false;
+        }
+        tight_loop_contents();
+    }
+
+    pio_interrupt_clear(g_pio, g_tx_sm);
+    g_pio_stats.tx_frames += g_tx_count;
+    return true;
+}
+
+/**
+ * Send frames
+ */
+bool z1_bus_pio_send(const uint16_t* frames, uint16_t count, uint32_t timeout_us) {
+    if (!z1_bus_pio_send_start(frames, count, true)) {
+        return false;
+    }
+    return z1_bus_pio_send_wait(timeout_us);
+}
+
+// ============================================================================
+// Receive
+// ============================================================================
+
+/**
+ * Arm receiver
+ */
+bool z1_bus_pio_receive_start(uint16_t* frames, uint16_t count) {
+    if (!g_pio_ready || count == 0) {
+        return false;
+    }
+
+    sm_reset(g_rx_sm, g_rx_offset);
+    dma_channel_abort(g_rx_dma);
+    dma_channel_set_write_addr(g_rx_dma, frames, false);
+    dma_channel_set_trans_count(g_rx_dma, count, true);
+    g_rx_count = count;
+
+    pio_sm_set_enabled(g_pio, g_rx_sm, true);
+    return true;
+}
+
+/**
+ * Receive further frames of the same transaction
+ */
+bool z1_bus_pio_receive_continue(uint16_t* frames, uint16_t count) {
+    if (!g_pio_ready || count == 0 || dma_channel_is_busy(g_rx_dma)) {
+        return false;
+    }
+
+    // FIFO (8 deep, joined) covers the gap until DMA is re-armed
+    dma_channel_set_write_addr(g_rx_dma, frames, false);
+    dma_channel_set_trans_count(g_rx_dma, count, true);
+    g_rx_count = count;
+    return true;
+}
+
+/**
+ * Wait for receive
+ */
+bool z1_bus_pio_receive_wait(uint32_t timeout_us) {
+    absolute_time_t deadline = make_timeout_time_us(timeout_us);
+
+    while (dma_channel_is_busy(g_rx_dma)) {
+        if (time_reached(deadline)) {
+            dma_channel_abort(g_rx_dma);
+            pio_sm_set_enabled(g_pio, g_rx_sm, false);
+            g_pio_stats.rx_timeouts++;
+            return false;
+        }
+        tight_loop_contents();
+    }
+
+    g_pio_stats.rx_frames += g_rx_count;
+    return true;
+}
+
+/**
+ * Stop receiver
+ */
+void z1_bus_pio_receive_stop(void) {
+    pio_sm_set_enabled(g_pio, g_rx_sm, false);
+}
+
+/**
+ * Get backend statistics
+ */
+void z1_bus_pio_get_stats(z1_bus_pio_stats_t* stats) {
+    if (stats) {
+        *stats = g_pio_stats;
+    }
+}
@@ -0,0 +1,356 @@
+/**
+ * Z1 Deferred Bus Receive
+ *
+ * Every ring has one producer (the bus IRQ) and one consumer (the main
+ * loop on core0). head and arena_head only move in the IRQ, tail and
+ * arena_tail only in z1_bus_rx_dispatch(). The arena positions count bytes
+ * ever allocated; a payload that would straddle the end of the arena starts
+ * over at offset 0 and the skipped bytes are freed with it.
+ *
+ * Only one multi-frame transfer is received at a time (the receive buffer
+ * is shared), so an admitted one holds a single slot of its class; its
+ * arena bytes need no hold, since no other payload is queued before it
+ * completes and dispatch only frees space.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_bus_rx.h"
+#include "z1_multiframe.h"
+#include "z1_trace.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    uint32_t offset;                // Arena position of the payload
+    uint32_t fences;                // Fences captured before this message
+    uint16_t length;
+    uint8_t sender;
+    uint8_t command;
+    uint8_t data;
+} z1_bus_rx_entry_t;
+
+typedef struct {
+    z1_bus_rx_entry_t* entries;
+    uint32_t depth;
+    uint8_t* arena;
+    uint32_t arena_size;
+    uint32_t reserve;               // Slots only broadcasts may take
+    uint32_t held;                  // Slot held for the admitted multi-frame transfer (0 or 1)
+    volatile uint32_t head;         // Messages captured
+    volatile uint32_t tail;         // Messages dispatched
+    uint32_t arena_head;            // Bytes allocated
+    volatile uint32_t arena_tail;   // Bytes freed
+} z1_bus_rx_queue_t;
+
+static z1_bus_rx_entry_t g_spike_entries[Z1_BUS_RX_SPIKE_DEPTH];
+static z1_bus_rx_entry_t g_normal_entries[Z1_BUS_RX_NORMAL_DEPTH];
+static uint8_t g_spike_arena[Z1_BUS_RX_SPIKE_ARENA] __attribute__((aligned(4)));
+static uint8_t g_normal_arena[Z1_BUS_RX_NORMAL_ARENA] __attribute__((aligned(4)));
+static uint8_t g_frame_buffer[Z1_BUS_RX_FRAME_BUFFER] __attribute__((aligned(4)));  // Burst DMA target
+
+static struct {
+    z1_bus_rx_queue_t queues[Z1_BUS_RX_CLASSES];
+    z1_bus_rx_handler_t handler;
+    uint8_t frame_command;          // Command of the chunked transfer in progress
+    volatile uint32_t fences_captured;
+    uint32_t fences_dispatched;
+    bool dispatching;
+    z1_bus_rx_stats_t stats;
+} g_rx = {
+    .queues = {
+        [Z1_BUS_RX_SPIKE] = { g_spike_entries, Z1_BUS_RX_SPIKE_DEPTH,
+                              g_spike_arena, Z1_BUS_RX_SPIKE_ARENA, Z1_BUS_RX_SPIKE_RESERVE },
+        [Z1_BUS_RX_NORMAL] = { g_normal_entries, Z1_BUS_RX_NORMAL_DEPTH,
+                               g_normal_arena, Z1_BUS_RX_NORMAL_ARENA, Z1_BUS_RX_NORMAL_RESERVE },
+    },
+};
+
+// ============================================================================
+// Classes
+// ============================================================================
+
+static z1_bus_rx_class_t command_class(uint8_t command) {
+    switch (command) {
+        case Z1_CMD_SNN_SPIKE:
+        case Z1_CMD_SNN_SPIKE_BATCH:
+        case Z1_CMD_SNN_INPUT_SPIKE:
+        case Z1_CMD_SNN_TICK:
+        case Z1_CMD_SNN_SLOT_DONE:
+        case Z1_CMD_SNN_CREDIT:
+            return Z1_BUS_RX_SPIKE;
+        default:
+            return Z1_BUS_RX_NORMAL;
+    }
+}
+
+// Commands that change what spike traffic means; it must not overtake them
+static bool command_is_fence(uint8_t command) {
+    return command == Z1_CMD_SNN_START || command == Z1_CMD_SNN_STOP ||
+           command == Z1_CMD_SNN_RESET || command == Z1_CMD_SNN_LOAD_TABLE;
+}
+
+// ============================================================================
+// Capture (bus IRQ)
+// ============================================================================
+
+// Find room for a message with length payload bytes, leaving kept slots
+// free; false if none
+static bool queue_reserve(const z1_bus_rx_queue_t* q, uint16_t length, uint32_t kept, uint32_t* offset) {
+    if (q->head - q->tail + kept >= q->depth) {
+        return false;
+    }
+
+    uint32_t size = ((uint32_t)length + 3) & ~3u;
+    uint32_t start = q->arena_head;
+    uint32_t pos = start & (q->arena_size - 1);
+    if (pos + size > q->arena_size) {
+        start += q->arena_size - pos;
+    }
+    if (start + size - q->arena_tail > q->arena_size) {
+        return false;
+    }
+    *offset = start;
+    return true;
+}
+
+static bool queue_push(z1_bus_rx_class_t cls, uint8_t sender, uint8_t command, uint8_t data,
+                       const uint8_t* payload, uint16_t length, uint32_t kept) {
+    z1_bus_rx_queue_t* q = &g_rx.queues[cls];
+    uint32_t offset;
+
+    if (!queue_reserve(q, length, kept, &offset)) {
+        return false;
+    }
+
+    z1_bus_rx_entry_t* e = &q->entries[q->head & (q->depth - 1)];
+    e->offset = offset;
+    e->fences = g_rx.fences_captured;
+    e->length = length;
+    e->sender = sender;
+    e->command = command;
+    e->data = data;
+    if (length > 0) {
+        memcpy(q->arena + (offset & (q->arena_size - 1)), payload, length);
+        q->arena_head = offset + ((length + 3) & ~3u);
+    }
+
+    // Publish the entry only once it is complete
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    q->head++;
+
+    if (command_is_fence(command)) {
+        g_rx.fences_captured++;
+    }
+    g_rx.stats.captured[cls]++;
+    uint32_t queued = q->head - q->tail;
+    if (queued > g_rx.stats.high_water[cls]) {
+        g_rx.stats.high_water[cls] = (uint16_t)queued;
+    }
+    return true;
+}
+
+// Release the slot of an admitted transfer that completed or was replaced
+static void release_held(void) {
+    for (int c = 0; c < Z1_BUS_RX_CLASSES; c++) {
+        g_rx.queues[c].held = 0;
+    }
+}
+
+// Multi-frame admission: the payload must fit its class, past the
+// reserve, and keeps its slot until it completes
+static bool admit_transfer(uint8_t command, uint16_t length) {
+    z1_bus_rx_class_t cls = command_class(command);
+    z1_bus_rx_queue_t* q = &g_rx.queues[cls];
+    uint32_t offset;
+
+    release_held();
+    if (!queue_reserve(q, length, q->reserve, &offset)) {
+        g_rx.stats.refused[cls]++;
+        return false;
+    }
+    q->held = 1;
+    return true;
+}
+
+// Queue a completed multi-frame payload and free the receive buffer
+static void push_payload(uint8_t sender, uint8_t command) {
+    uint16_t length = z1_multiframe_rx_length();
+    z1_bus_rx_class_t cls = command_class(command);
+
+    // Goes into the slot held since admission
+    release_held();
+    if (!queue_push(cls, sender, command, 0, g_frame_buffer, length, 0)) {
+        g_rx.stats.dropped[cls]++;
+    }
+    z1_multiframe_rx_reset();
+}
+
+/**
+ * Check whether an addressed transaction can be queued (bus IRQ)
+ */
+bool z1_bus_rx_ready(void) {
+    for (int c = 0; c < Z1_BUS_RX_CLASSES; c++) {
+        const z1_bus_rx_queue_t* q = &g_rx.queues[c];
+        if (q->head - q->tail + q->reserve + q->held >= q->depth) {
+            g_rx.stats.unacked++;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Capture a received transaction (bus IRQ)
+ */
+void z1_bus_rx_capture(uint8_t sender, uint8_t command, uint8_t data) {
+    // Length and data-byte transactions of an active multi-frame transfer
+    // carry raw payload, not commands
+    if (z1_multiframe_rx_feed(command, data)) {
+        return;
+    }
+
+    switch (command) {
+        case Z1_CMD_FRAME_START:
+            g_rx.frame_command = data;  // Command is passed as data byte
+            release_held();             // Replaces any transfer in progress
+            z1_multiframe_handle_start(sender, data);
+            return;
+
+        case Z1_CMD_FRAME_DATA:
+            // data contains sequence number, next frame has actual data
+            Z1_TRACE(APP, Z1_TRACE_DEBUG, Z1_EV_APP_FRAME, data, command);
+            return;
+
+        case Z1_CMD_FRAME_END:
+            z1_multiframe_handle_end(data);  // data is checksum
+            if (z1_multiframe_rx_complete()) {
+                push_payload(sender, g_rx.frame_command);
+            } else {
+                release_held();
+            }
+            return;
+
+        case Z1_CMD_FRAME_BURST:
+            // Payload already received and CRC-checked by the bus receive path
+            if (z1_multiframe_rx_complete()) {
+                push_payload(sender, data);
+            } else {
+                release_held();
+            }
+            return;
+
+        default: {
+            // Addressed frames were admitted before their ACK; only a
+            // broadcast can find the ring full, after it used the reserve
+            z1_bus_rx_class_t cls = command_class(command);
+            if (!queue_push(cls, sender, command, data, NULL, 0, g_rx.queues[cls].held)) {
+                g_rx.stats.dropped[cls]++;
+            }
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// Dispatch (main loop)
+// ============================================================================
+
+/**
+ * Take over the multi-frame receive buffer and set the message handler
+ */
+bool z1_bus_rx_init(z1_bus_rx_handler_t handler) {
+    g_rx.handler = handler;
+    if (!z1_multiframe_rx_init(g_frame_buffer, sizeof(g_frame_buffer))) {
+        return false;
+    }
+    z1_multiframe_rx_set_admit(admit_transfer);
+    return true;
+}
+
+// Run and free the oldest message of a class
+static void dispatch_one(z1_bus_rx_class_t cls) {
+    z1_bus_rx_queue_t* q = &g_rx.queues[cls];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    const z1_bus_rx_entry_t* e = &q->entries[q->tail & (q->depth - 1)];
+
+    z1_bus_rx_msg_t msg = {
+        .sender = e->sender,
+        .command = e->command,
+        .data = e->data,
+        .length = e->length,
+        .payload = e->length ? q->arena + (e->offset & (q->arena_size - 1)) : NULL,
+    };
+    g_rx.handler(&msg);
+
+    if (command_is_fence(e->command)) {
+        g_rx.fences_dispatched++;
+    }
+    if (e->length > 0) {
+        q->arena_tail = e->offset + ((e->length + 3) & ~3u);
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    q->tail++;
+    g_rx.stats.dispatched[cls]++;
+}
+
+/**
+ * Run queued messages
+ */
+uint32_t z1_bus_rx_dispatch(void) {
+    if (!g_rx.handler || g_rx.dispatching) {
+        return 0;
+    }
+    g_rx.dispatching = true;
+
+    z1_bus_rx_queue_t* spikes = &g_rx.queues[Z1_BUS_RX_SPIKE];
+    z1_bus_rx_queue_t* normal = &g_rx.queues[Z1_BUS_RX_NORMAL];
+    uint32_t count = 0;
+    uint32_t normal_count = 0;
+
+    while (true) {
+        bool spike_waiting = spikes->tail != spikes->head;
+        bool normal_waiting = normal->tail != normal->head;
+
+        // Wrapping compare: a spike is held while a fence before it is queued
+        bool spike_ready = spike_waiting &&
+            (int32_t)(spikes->entries[spikes->tail & (spikes->depth - 1)].fences -
+                      g_rx.fences_dispatched) <= 0;
+
+        if (spike_ready) {
+            dispatch_one(Z1_BUS_RX_SPIKE);
+        } else if (normal_waiting && (spike_waiting || normal_count < Z1_BUS_RX_NORMAL_PER_PASS)) {
+            dispatch_one(Z1_BUS_RX_NORMAL);
+            normal_count++;
+        } else {
+            break;
+        }
+        count++;
+    }
+
+    g_rx.dispatching = false;
+    return count;
+}
+
+/**
+ * Check whether messages are waiting
+ */
+bool z1_bus_rx_pending(void) {
+    for (int c = 0; c < Z1_BUS_RX_CLASSES; c++) {
+        if (g_rx.queues[c].tail != g_rx.queues[c].head) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Read the receive statistics
+ */
+void z1_bus_rx_get_stats(z1_bus_rx_stats_t* stats) {
+    *stats = g_rx.stats;
+}
@@ -0,0 +1,145 @@
+/**
+ * Z1 Deferred Bus Receive
+ *
+ * The bus IRQ only captures: single-frame commands are queued as they are,
+ * multi-frame transfers are reassembled (the multi-frame receive buffer is
+ * owned here) and their payloads copied out, so the buffer is free for the
+ * next transfer at once. z1_bus_rx_dispatch() runs the queued messages from
+ * the main loop, spike traffic first.
+ *
+ * Each priority class has its own message ring and payload arena. Nothing
+ * is dropped after it was acknowledged:
+ *
+ *   - a targeted or multicast transaction is left unacknowledged
+ *     (z1_bus_accept_transaction()) unless every ring has a free slot
+ *     beyond its broadcast reserve, so the sender sees the failure and
+ *     keeps the message
+ *   - a multi-frame transfer is refused before its first data frame when
+ *     its arena is full, and once admitted holds a slot until it completes
+ *   - broadcasts (ticks, TDMA markers, run-state commands) are never
+ *     acknowledged, so they alone may use the reserve
+ *
+ * Run-state commands (start, stop, reset, table load) act as fences: spike
+ * traffic captured after one waits for it.
+ *
+ * Streamed payloads (z1_multiframe_rx_set_sink()) still reach their sink
+ * in the receive path, overlapped with the transfer.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_BUS_RX_H
+#define Z1_BUS_RX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_BUS_RX_FRAME_BUFFER      4096    // Multi-frame receive buffer (largest buffered payload)
+
+// Message slots and payload bytes per class (powers of 2)
+#define Z1_BUS_RX_SPIKE_DEPTH       128
+#define Z1_BUS_RX_SPIKE_ARENA       16384
+#define Z1_BUS_RX_NORMAL_DEPTH      64
+#define Z1_BUS_RX_NORMAL_ARENA      8192
+
+// Slots per class only broadcasts may take. Spike class: the ticks and
+// TDMA markers of two rounds (a round cannot start before this node
+// finished the previous step); normal class: run-state broadcasts
+#define Z1_BUS_RX_SPIKE_RESERVE     (2 * (Z1_MAX_NODES + 1))
+#define Z1_BUS_RX_NORMAL_RESERVE    8
+
+#define Z1_BUS_RX_NORMAL_PER_PASS   1       // Normal messages per z1_bus_rx_dispatch()
+
+/**
+ * Priority classes
+ */
+typedef enum {
+    Z1_BUS_RX_SPIKE = 0,            // Spikes, input spikes, timestep ticks and slot markers
+    Z1_BUS_RX_NORMAL,               // Everything else, in arrival order
+    Z1_BUS_RX_CLASSES
+} z1_bus_rx_class_t;
+
+/**
+ * Received message
+ */
+typedef struct {
+    uint8_t sender;
+    uint8_t command;                // Command, or the command of a multi-frame payload
+    uint8_t data;                   // Data byte of a single frame
+    uint16_t length;                // Payload bytes (0 = single frame)
+    const uint8_t* payload;         // Valid until the handler returns
+} z1_bus_rx_msg_t;
+
+typedef void (*z1_bus_rx_handler_t)(const z1_bus_rx_msg_t* msg);
+
+/**
+ * Receive statistics (per class)
+ */
+typedef struct {
+    uint32_t captured[Z1_BUS_RX_CLASSES];
+    uint32_t dispatched[Z1_BUS_RX_CLASSES];
+    uint32_t refused[Z1_BUS_RX_CLASSES];    // Transfers turned away, arena full
+    uint32_t dropped[Z1_BUS_RX_CLASSES];    // Broadcasts lost, ring full past the reserve
+    uint16_t high_water[Z1_BUS_RX_CLASSES]; // Most messages queued at once
+    uint32_t unacked;                       // Transactions left unacknowledged, a ring full
+} z1_bus_rx_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Take over the multi-frame receive buffer and set the message handler
+ *
+ * @param handler Called by z1_bus_rx_dispatch() for every message
+ * @return true on success
+ */
+bool z1_bus_rx_init(z1_bus_rx_handler_t handler);
+
+/**
+ * Capture a received transaction (bus IRQ, from z1_bus_process_command())
+ *
+ * @param sender Sending node
+ * @param command Command byte
+ * @param data Data byte
+ */
+void z1_bus_rx_capture(uint8_t sender, uint8_t command, uint8_t data);
+
+/**
+ * Check whether an addressed transaction can be queued (bus IRQ, before
+ * its ACK; node.c's z1_bus_accept_transaction())
+ *
+ * @return true if every class has a free slot beyond its reserve and the
+ *         slot held by an admitted multi-frame transfer
+ */
+bool z1_bus_rx_ready(void);
+
+/**
+ * Run queued messages (main loop)
+ *
+ * Runs every dispatchable spike-class message and up to
+ * Z1_BUS_RX_NORMAL_PER_PASS others, so a slow command delays spike
+ * traffic by one handler at most. Calls from inside a handler return 0.
+ *
+ * @return Messages run
+ */
+uint32_t z1_bus_rx_dispatch(void);
+
+/**
+ * Check whether messages are waiting
+ */
+bool z1_bus_rx_pending(void);
+
+/**
+ * Read the receive statistics
+ *
+ * @param stats Output statistics
+ */
+void z1_bus_rx_get_stats(z1_bus_rx_stats_t* stats);
+
+#endif // Z1_BUS_RX_H
@@ -0,0 +1,199 @@
+/**
+ * Z1 Firmware Receiver
+ *
+ * Chunks are checked and written as z1_bus_rx_dispatch() hands them over
+ * in the main loop; the image check reads everything back from PSRAM, so
+ * it runs later from z1_firmware_rx_service() instead of holding up the
+ * rest of the bus messages.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_firmware_rx.h"
+#include "psram_rp2350.h"
+#include "../common/z1_crc32.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    uint32_t base;                  // PSRAM address of the image
+    uint32_t capacity;
+
+    uint32_t session;
+    uint32_t image_size;
+    uint16_t chunk_count;
+    uint16_t received;
+    uint32_t crc_errors;
+    uint8_t bitmap[Z1_FW_BITMAP_BYTES];
+
+    volatile bool verify_pending;
+    uint32_t verify_crc32;
+    uint8_t verify_flags;           // Z1_FW_STATUS_VERIFIED or _BAD_IMAGE once checked
+} z1_firmware_rx_t;
+
+static z1_firmware_rx_t g_fw;
+
+// ============================================================================
+// Receive
+// ============================================================================
+
+/**
+ * Set up the receiver over a PSRAM region
+ */
+void z1_firmware_rx_init(uint32_t psram_addr, uint32_t size_bytes) {
+    memset(&g_fw, 0, sizeof(g_fw));
+    g_fw.base = psram_addr;
+    g_fw.capacity = size_bytes;
+}
+
+/**
+ * Start a transfer
+ */
+bool z1_firmware_rx_begin(const uint8_t* payload, uint16_t length) {
+    z1_fw_begin_t begin;
+    if (length < sizeof(begin)) {
+        return false;
+    }
+    memcpy(&begin, payload, sizeof(begin));
+
+    if (begin.session == g_fw.session && begin.image_size == g_fw.image_size) {
+        return true;
+    }
+
+    if (begin.chunk_size != Z1_FW_CHUNK_SIZE || begin.chunk_count > Z1_FW_MAX_CHUNKS ||
+        begin.image_size > g_fw.capacity ||
+        begin.chunk_count != (begin.image_size + Z1_FW_CHUNK_SIZE - 1) / Z1_FW_CHUNK_SIZE) {
+        printf("[Firmware] ⚠️  Image of %u bytes in %u chunks refused\n",
+               (unsigned int)begin.image_size, begin.chunk_count);
+        return false;
+    }
+
+    g_fw.session = begin.session;
+    g_fw.image_size = begin.image_size;
+    g_fw.chunk_count = begin.chunk_count;
+    g_fw.received = 0;
+    g_fw.crc_errors = 0;
+    g_fw.verify_pending = false;
+    g_fw.verify_flags = 0;
+    memset(g_fw.bitmap, 0, sizeof(g_fw.bitmap));
+
+    printf("[Firmware] Receiving %u bytes (%u chunks, session %08X)\n",
+           (unsigned int)begin.image_size, begin.chunk_count, (unsigned int)begin.session);
+    return true;
+}
+
+/**
+ * Store one chunk
+ */
+bool z1_firmware_rx_chunk(const uint8_t* payload, uint16_t length) {
+    z1_fw_chunk_t chunk;
+    if (length < sizeof(chunk)) {
+        return false;
+    }
+    memcpy(&chunk, payload, sizeof(chunk));
+    const uint8_t* data = payload + sizeof(chunk);
+
+    if (g_fw.session == 0 || chunk.session != g_fw.session || chunk.index >= g_fw.chunk_count) {
+        return false;
+    }
+
+    // Every chunk but the last is full size
+    uint32_t offset = (uint32_t)chunk.index * Z1_FW_CHUNK_SIZE;
+    uint32_t expected = g_fw.image_size - offset;
+    if (expected > Z1_FW_CHUNK_SIZE) expected = Z1_FW_CHUNK_SIZE;
+    if (chunk.length != expected || length - sizeof(chunk) < chunk.length ||
+        z1_crc32(data, chunk.length) != chunk.crc32) {
+        g_fw.crc_errors++;
+        return false;
+    }
+
+    uint8_t bit = 1u << (chunk.index & 7);
+    if (g_fw.bitmap[chunk.index >> 3] & bit) {
+        return true;  // Resent to a multicast group; this node had it already
+    }
+    if (!psram_write(g_fw.base + offset, data, chunk.length)) {
+        return false;
+    }
+    g_fw.bitmap[chunk.index >> 3] |= bit;
+    g_fw.received++;
+    return true;
+}
+
+// ============================================================================
+// Verification
+// ============================================================================
+
+/**
+ * Arm the whole-image check
+ */
+void z1_firmware_rx_request_verify(const uint8_t* payload, uint16_t length) {
+    z1_fw_verify_t verify;
+    if (length < sizeof(verify)) {
+        return;
+    }
+    memcpy(&verify, payload, sizeof(verify));
+    if (verify.session != g_fw.session || g_fw.session == 0) {
+        return;
+    }
+
+    g_fw.verify_crc32 = verify.image_crc32;
+    g_fw.verify_flags = 0;
+    g_fw.verify_pending = true;
+}
+
+/**
+ * Run a pending image check
+ */
+void z1_firmware_rx_service(void) {
+    static uint8_t block[256] __attribute__((aligned(4)));
+
+    if (!g_fw.verify_pending) {
+        return;
+    }
+    g_fw.verify_pending = false;
+
+    if (g_fw.received != g_fw.chunk_count) {
+        g_fw.verify_flags = Z1_FW_STATUS_BAD_IMAGE;
+        return;
+    }
+
+    uint32_t crc = 0;
+    for (uint32_t offset = 0; offset < g_fw.image_size; offset += sizeof(block)) {
+        uint32_t n = g_fw.image_size - offset;
+        if (n > sizeof(block)) n = sizeof(block);
+        if (!psram_read(g_fw.base + offset, block, n)) {
+            g_fw.verify_flags = Z1_FW_STATUS_BAD_IMAGE;
+            return;
+        }
+        crc = z1_crc32_update(crc, block, n);
+    }
+
+    g_fw.verify_flags = (crc == g_fw.verify_crc32) ? Z1_FW_STATUS_VERIFIED : Z1_FW_STATUS_BAD_IMAGE;
+    printf("[Firmware] Image %s (CRC32 %08X)\n",
+           (g_fw.verify_flags & Z1_FW_STATUS_VERIFIED) ? "verified" : "MISMATCH",
+           (unsigned int)crc);
+}
+
+/**
+ * Fill a Z1_CMD_FIRMWARE_STATUS response
+ */
+void z1_firmware_rx_get_status(z1_fw_status_t* status) {
+    memset(status, 0, sizeof(*status));
+    status->session = g_fw.session;
+    status->chunk_count = g_fw.chunk_count;
+    status->received = g_fw.received;
+    status->crc_errors = g_fw.crc_errors;
+    memcpy(status->bitmap, g_fw.bitmap, sizeof(status->bitmap));
+
+    status->flags = g_fw.verify_flags;
+    if (g_fw.session != 0 && g_fw.received == g_fw.chunk_count) {
+        status->flags |= Z1_FW_STATUS_COMPLETE;
+    }
+    if (g_fw.verify_pending) {
+        status->flags |= Z1_FW_STATUS_VERIFYING;
+    }
+}
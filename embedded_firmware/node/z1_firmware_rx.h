@@ -0,0 +1,71 @@
+/**
+ * Z1 Firmware Receiver
+ *
+ * Node side of the chunked firmware distribution (see "Firmware
+ * Distribution" in z1_protocol.h). Chunks land in the firmware region of
+ * the PSRAM layout in any order and any number of times; a bitmap records
+ * which ones arrived with a matching CRC32, so the controller can resend
+ * only the gaps after a multicast pass.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_FIRMWARE_RX_H
+#define Z1_FIRMWARE_RX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Set up the receiver over a PSRAM region
+ *
+ * @param psram_addr Firmware region of the PSRAM layout
+ * @param size_bytes Region size (Z1_PSRAM_FIRMWARE_SIZE)
+ */
+void z1_firmware_rx_init(uint32_t psram_addr, uint32_t size_bytes);
+
+/**
+ * Start a transfer (Z1_CMD_FIRMWARE_BEGIN); a repeated BEGIN of the
+ * current session keeps the chunks already stored
+ *
+ * @param payload Received payload
+ * @param length Payload length
+ * @return false if the image does not fit
+ */
+bool z1_firmware_rx_begin(const uint8_t* payload, uint16_t length);
+
+/**
+ * Store one chunk (Z1_CMD_FIRMWARE_UPLOAD)
+ *
+ * @param payload z1_fw_chunk_t followed by the chunk data
+ * @param length Payload length
+ * @return false if the chunk was dropped (other session, bad range or CRC32)
+ */
+bool z1_firmware_rx_chunk(const uint8_t* payload, uint16_t length);
+
+/**
+ * Arm the whole-image check (Z1_CMD_FIRMWARE_VERIFY, from z1_bus_rx_dispatch())
+ *
+ * @param payload z1_fw_verify_t
+ * @param length Payload length
+ */
+void z1_firmware_rx_request_verify(const uint8_t* payload, uint16_t length);
+
+/**
+ * Run a pending image check (main loop: reads the whole image from PSRAM)
+ */
+void z1_firmware_rx_service(void);
+
+/**
+ * Fill a Z1_CMD_FIRMWARE_STATUS response
+ *
+ * @param status Structure to fill
+ */
+void z1_firmware_rx_get_status(z1_fw_status_t* status);
+
+#endif // Z1_FIRMWARE_RX_H
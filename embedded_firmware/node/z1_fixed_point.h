@@ -0,0 +1,112 @@
+/**
+ * Z1 Fixed-Point Arithmetic
+ *
+ * Q16.16 helpers for the fixed-point SNN engine build (Z1_SNN_FIXED_POINT).
+ * The step path only uses integer add and 32x32->64 multiply (SMULL on the
+ * Cortex-M33, MUL/MULH on Hazard3), so both RP2350 core types produce
+ * bit-identical membrane state. Float conversions are for load, store and
+ * host-facing values only.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_FIXED_POINT_H
+#define Z1_FIXED_POINT_H
+
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#endif
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_Q16_SHIFT    16
+#define Z1_Q16_ONE      (1 << Z1_Q16_SHIFT)   // 1.0
+
+/**
+ * Q16.16 value: 16 integer bits (signed), 16 fraction bits
+ */
+typedef int32_t z1_q16_t;
+
+// ============================================================================
+// Conversion
+// ============================================================================
+
+/**
+ * Convert float to Q16.16 (round to nearest, saturating)
+ *
+ * @param f Value to convert
+ * @return Q16.16 value
+ */
+static inline z1_q16_t z1_q16_from_float(float f) {
+    float scaled = f * (float)Z1_Q16_ONE;
+    if (scaled >= 2147483520.0f) {
+        return INT32_MAX;
+    }
+    if (scaled <= -2147483648.0f) {
+        return INT32_MIN;
+    }
+    return (z1_q16_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+/**
+ * Convert Q16.16 to float
+ *
+ * @param v Q16.16 value
+ * @return Float value
+ */
+static inline float z1_q16_to_float(z1_q16_t v) {
+    return (float)v / (float)Z1_Q16_ONE;
+}
+
+/**
+ * Decode 8-bit synapse weight to Q16.16
+ *
+ * Integer equivalent of z1_synapse_decode_weight(): round(w * 65536 / 63.5).
+ *
+ * @param weight Encoded weight (0-127 positive, 128-255 negative)
+ * @return Decoded weight (-2.0 to 2.0)
+ */
+static inline z1_q16_t z1_q16_decode_weight(uint8_t weight) {
+    z1_q16_t magnitude = (z1_q16_t)(((uint32_t)(weight & 0x7F) * 131072u + 63u) / 127u);
+    return (weight & 0x80) ? -magnitude : magnitude;
+}
+
+// ============================================================================
+// Arithmetic
+// ============================================================================
+
+/**
+ * Saturating add
+ *
+ * @param a First operand
+ * @param b Second operand
+ * @return a + b clamped to the Q16.16 range
+ */
+static inline z1_q16_t z1_q16_add_sat(z1_q16_t a, z1_q16_t b) {
+#if defined(__ARM_FEATURE_DSP)
+    return __qadd(a, b);
+#else
+    int32_t r;
+    if (__builtin_add_overflow(a, b, &r)) {
+        r = (b > 0) ? INT32_MAX : INT32_MIN;
+    }
+    return r;
+#endif
+}
+
+/**
+ * Multiply (truncates toward negative infinity)
+ *
+ * @param a First operand
+ * @param b Second operand
+ * @return a * b in Q16.16
+ */
+static inline z1_q16_t z1_q16_mul(z1_q16_t a, z1_q16_t b) {
+    return (z1_q16_t)(((int64_t)a * b) >> Z1_Q16_SHIFT);
+}
+
+#endif // Z1_FIXED_POINT_H
@@ -0,0 +1,134 @@
+/**
+ * Z1 Memory Read-Back
+ *
+ * One read at a time. A block is read from PSRAM into a single send buffer
+ * and sent as one burst; a failed burst is retried on the next pass until
+ * the read times out.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_mem_read.h"
+#include "z1_multiframe.h"
+#include "z1_psram_layout.h"
+#include "psram_rp2350.h"
+#include "pico/time.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    bool active;
+    uint8_t requester;
+    uint32_t device_addr;           // PSRAM address of the range
+    uint32_t length;
+    uint32_t blocks;                // Blocks in the range
+    uint32_t sent;                  // Blocks sent
+    uint32_t acked;                 // Blocks the reader has taken
+    uint32_t progress_ms;           // Last block sent or acknowledged
+} z1_mem_read_t;
+
+static z1_mem_read_t g_read;
+
+// [offset:4][data], 4-byte aligned for the burst DMA
+static uint8_t g_block[4 + Z1_MEM_READ_BLOCK] __attribute__((aligned(4)));
+
+static uint32_t now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// ============================================================================
+// Read-Back
+// ============================================================================
+
+/**
+ * Start a read
+ */
+void z1_mem_read_request(uint8_t requester, const uint8_t* payload, uint16_t length) {
+    z1_mem_read_req_t req;
+    
+    g_read.active = false;
+    if (length < sizeof(req)) {
+        return;
+    }
+    memcpy(&req, payload, sizeof(req));
+    if (req.length == 0) {
+        return;
+    }
+    
+    uint32_t device_addr = z1_psram_layout_host_to_device(req.addr);
+    if (device_addr == 0 || z1_psram_layout_host_to_device(req.addr + req.length - 1) == 0) {
+        printf("[MemRead] ⚠️  Range 0x%08X+%u is outside PSRAM\n",
+               (unsigned int)req.addr, (unsigned int)req.length);
+        uint32_t invalid = Z1_MEM_READ_INVALID;
+        memcpy(g_block, &invalid, 4);
+        z1_send_multiframe_burst(requester, Z1_CMD_MEM_READ_DATA, g_block, 4);
+        return;
+    }
+    
+    g_read.requester = requester;
+    g_read.device_addr = device_addr;
+    g_read.length = req.length;
+    g_read.blocks = (req.length + Z1_MEM_READ_BLOCK - 1) / Z1_MEM_READ_BLOCK;
+    g_read.sent = 0;
+    g_read.acked = 0;
+    g_read.progress_ms = now_ms();
+    g_read.active = true;
+}
+
+/**
+ * Take a window acknowledgement
+ */
+void z1_mem_read_ack(uint8_t requester, uint8_t blocks) {
+    if (!g_read.active || requester != g_read.requester) {
+        return;
+    }
+    
+    // The count wraps at 256; it can only move up to what was sent
+    uint8_t advance = (uint8_t)(blocks - (uint8_t)g_read.acked);
+    if (advance == 0 || advance > g_read.sent - g_read.acked) {
+        return;
+    }
+    g_read.acked += advance;
+    g_read.progress_ms = now_ms();
+    
+    if (g_read.acked == g_read.blocks) {
+        g_read.active = false;
+    }
+}
+
+/**
+ * Send the blocks the window allows
+ */
+void z1_mem_read_service(void) {
+    if (!g_read.active) {
+        return;
+    }
+    
+    while (g_read.sent < g_read.blocks && g_read.sent - g_read.acked < Z1_MEM_READ_WINDOW) {
+        uint32_t offset = g_read.sent * Z1_MEM_READ_BLOCK;
+        uint32_t n = g_read.length - offset;
+        if (n > Z1_MEM_READ_BLOCK) {
+            n = Z1_MEM_READ_BLOCK;
+        }
+        
+        memcpy(g_block, &offset, 4);
+        if (!psram_read(g_read.device_addr + offset, g_block + 4, n) ||
+            !z1_send_multiframe_burst(g_read.requester, Z1_CMD_MEM_READ_DATA,
+                                      g_block, (uint16_t)(4 + n))) {
+            break;  // Retried on the next pass
+        }
+        g_read.sent++;
+        g_read.progress_ms = now_ms();
+    }
+    
+    // A reader that went away leaves the window full
+    if (now_ms() - g_read.progress_ms > Z1_MEM_READ_TIMEOUT_MS) {
+        printf("[MemRead] ⚠️  Read abandoned after %u of %u blocks\n",
+               (unsigned int)g_read.acked, (unsigned int)g_read.blocks);
+        g_read.active = false;
+    }
+}
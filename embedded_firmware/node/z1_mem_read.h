@@ -0,0 +1,47 @@
+/**
+ * Z1 Memory Read-Back
+ *
+ * Node side of Z1_CMD_MEM_READ_REQ (see "Memory Read-Back" in
+ * z1_protocol.h). The requested PSRAM range goes back to the requester as
+ * a run of burst transfers, at most Z1_MEM_READ_WINDOW blocks ahead of the
+ * reader's acknowledgements, so a read runs at bus rate without the reader
+ * having to hold the whole range.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_MEM_READ_H
+#define Z1_MEM_READ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Start a read (Z1_CMD_MEM_READ_REQ); replaces one in progress
+ *
+ * @param requester Node the blocks go to
+ * @param payload z1_mem_read_req_t
+ * @param length Payload length
+ */
+void z1_mem_read_request(uint8_t requester, const uint8_t* payload, uint16_t length);
+
+/**
+ * Take a window acknowledgement (Z1_CMD_MEM_READ_ACK)
+ *
+ * @param requester Sender of the acknowledgement
+ * @param blocks Blocks the reader has taken, mod 256
+ */
+void z1_mem_read_ack(uint8_t requester, uint8_t blocks);
+
+/**
+ * Send the blocks the window allows (main loop: reads PSRAM and blocks
+ * for each burst)
+ */
+void z1_mem_read_service(void);
+
+#endif // Z1_MEM_READ_H
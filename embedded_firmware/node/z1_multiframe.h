@@ -15,15 +15,66 @@
 bool z1_send_multiframe(uint8_t target_node, uint8_t command, 
                         const uint8_t* data, uint16_t length);
 
-// Initialize receive buffer
+// Send payload as chunked single-frame writes (no burst attempt; ~4 ms per 2 bytes)
+bool z1_send_multiframe_chunked(uint8_t target_node, uint8_t command,
+                                const uint8_t* data, uint16_t length);
+
+// Send payload as one burst transaction (no chunked fallback)
+bool z1_send_multiframe_burst(uint8_t target_node, uint8_t command,
+                              const uint8_t* data, uint16_t length);
+
+// Send payload to every node in dest_mask as one multicast burst (no fallback)
+bool z1_send_multicast(uint16_t dest_mask, uint8_t command,
+                       const uint8_t* data, uint16_t length);
+
+/**
+ * Streaming receive sink
+ * 
+ * Payloads of `command` are handed on in chunks as they arrive instead of
+ * being collected in the receive buffer, so they are limited only by the
+ * 16-bit transfer length. The first header_size bytes (e.g. a destination
+ * address) go to begin(); write() gets the rest in order and may keep
+ * reading its data until the next write() or end() call returns. end()
+ * reports the checksum result, which is only known after the last chunk.
+ * Callbacks run from the bus receive path.
+ */
+typedef struct {
+    uint8_t command;                // Command whose payloads are streamed
+    uint16_t header_size;           // Leading bytes for begin() (1-16)
+    bool (*begin)(const uint8_t* header, uint16_t payload_length);
+    bool (*write)(const uint8_t* data, uint16_t length);
+    void (*end)(bool ok);
+} z1_multiframe_sink_t;
+
+// Initialize receive buffer (2-byte aligned: bursts may be written by DMA)
 bool z1_multiframe_rx_init(uint8_t* buffer, uint16_t buffer_size);
 
+// Stream one command's payloads to a sink (buffer halves used as chunks; NULL disables)
+bool z1_multiframe_rx_set_sink(const z1_multiframe_sink_t* sink);
+
+// Check buffered transfers before they start: admit() returning false refuses
+// the transfer (a burst is NACKed); called from the bus receive path. NULL admits all
+void z1_multiframe_rx_set_admit(bool (*admit)(uint8_t command, uint16_t length));
+
 // Handle received frames
 bool z1_multiframe_handle_start(uint8_t source_node, uint8_t command);
 bool z1_multiframe_handle_length(uint8_t length_high, uint8_t length_low);
 bool z1_multiframe_handle_data(uint8_t sequence, uint8_t byte1, uint8_t byte2);
 bool z1_multiframe_handle_end(uint8_t checksum);
 
+// Handle burst transfer (called from the bus receive path): receive
+// *frames into each returned buffer, then ask for the next one
+uint8_t* z1_multiframe_handle_burst(uint8_t source_node, uint8_t command, uint16_t length,
+                                    uint16_t* frames);
+uint8_t* z1_multiframe_handle_burst_chunk(uint16_t* frames);
+bool z1_multiframe_handle_burst_end(uint16_t crc);
+
+// Pass landed streamed data to the sink (at most max_bytes per call)
+void z1_multiframe_rx_drain(uint16_t max_bytes);
+
+// Route length/data transactions of an active transfer (true if consumed)
+bool z1_multiframe_rx_feed(uint8_t command, uint8_t data);
+
 // Check receive status
 bool z1_multiframe_rx_complete(void);
 uint16_t z1_multiframe_rx_length(void);
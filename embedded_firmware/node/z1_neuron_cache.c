@@ -1,7 +1,7 @@
 /**
  * Z1 Neuron Cache
  * 
- * LRU cache for streaming neurons from PSRAM to RAM.
+ * Set-associative write-back cache for streaming neurons from PSRAM to RAM.
  * Keeps only active neurons in RAM to reduce memory footprint.
  * 
  * Copyright NeuroFab Corp. All rights reserved.
@@ -18,6 +18,20 @@
 
 static z1_neuron_cache_t g_cache = {0};
 
+// Serialized entries for coalesced writebacks (double-buffered)
+static uint8_t g_flush_buffer[2][Z1_NEURON_CACHE_FLUSH_BURST * 256] __attribute__((aligned(4)));
+static psram_dma_handle_t g_flush_dma[2];
+
+// Raw entries being fetched ahead of use
+typedef struct {
+    uint16_t neuron_id;          // 0xFFFF when free
+    psram_dma_handle_t dma;
+    uint8_t data[256] __attribute__((aligned(4)));
+} z1_prefetch_slot_t;
+
+static z1_prefetch_slot_t g_prefetch[Z1_NEURON_CACHE_PREFETCH];
+static uint8_t g_prefetch_next = 0;
+
 // ============================================================================
 // Cache Management
 // ============================================================================
@@ -28,20 +42,27 @@ static z1_neuron_cache_t g_cache = {0};
 void z1_neuron_cache_init(void) {
     memset(&g_cache, 0, sizeof(g_cache));
     
-    // Mark all entries as invalid
+    // Mark all entries as invalid; ages within each set start distinct
     for (int i = 0; i < Z1_NEURON_CACHE_SIZE; i++) {
         g_cache.valid[i] = false;
-        g_cache.dirty[i] = false;
+        g_cache.dirty[i] = 0;
         g_cache.neuron_ids[i] = 0xFFFF;  // Invalid ID
-        g_cache.lru_counter[i] = 0;
+        g_cache.lru_age[i] = (uint8_t)(i % Z1_NEURON_CACHE_WAYS);
     }
     
-    g_cache.hits = 0;
-    g_cache.misses = 0;
-    g_cache.evictions = 0;
+    for (int i = 0; i < Z1_NEURON_CACHE_PREFETCH; i++) {
+        g_prefetch[i].neuron_id = 0xFFFF;
+    }
     
-    printf("[Neuron Cache] Initialized: %d entries, %zu bytes\n",
-           Z1_NEURON_CACHE_SIZE, sizeof(g_cache));
+    printf("[Neuron Cache] Initialized: %d sets x %d ways, %zu bytes\n",
+           Z1_NEURON_CACHE_SETS, Z1_NEURON_CACHE_WAYS, sizeof(g_cache));
+}
+
+/**
+ * First cache index of the set a neuron maps to
+ */
+static inline int set_base(uint16_t neuron_id) {
+    return (neuron_id & (Z1_NEURON_CACHE_SETS - 1)) * Z1_NEURON_CACHE_WAYS;
 }
 
 /**
@@ -49,7 +70,8 @@ void z1_neuron_cache_init(void) {
  * Returns cache index if found, -1 if not found
  */
 static int find_in_cache(uint16_t neuron_id) {
-    for (int i = 0; i < Z1_NEURON_CACHE_SIZE; i++) {
+    int base = set_base(neuron_id);
+    for (int i = base; i < base + Z1_NEURON_CACHE_WAYS; i++) {
         if (g_cache.valid[i] && g_cache.neuron_ids[i] == neuron_id) {
             return i;
         }
@@ -58,48 +80,40 @@ static int find_in_cache(uint16_t neuron_id) {
 }
 
 /**
- * Find free cache entry
- * Returns cache index if found, -1 if cache is full
+ * Find replacement way in a neuron's set
+ * Returns a free way if there is one, otherwise the least recently used
  */
-static int find_free_entry(void) {
-    for (int i = 0; i < Z1_NEURON_CACHE_SIZE; i++) {
+static int find_victim(uint16_t neuron_id) {
+    int base = set_base(neuron_id);
+    int victim = base;
+    
+    for (int i = base; i < base + Z1_NEURON_CACHE_WAYS; i++) {
         if (!g_cache.valid[i]) {
             return i;
         }
-    }
-    return -1;
-}
-
-/**
- * Find LRU (Least Recently Used) entry for eviction
- */
-static int find_lru_entry(void) {
-    int lru_index = 0;
-    uint8_t min_counter = g_cache.lru_counter[0];
-    
-    for (int i = 1; i < Z1_NEURON_CACHE_SIZE; i++) {
-        if (g_cache.lru_counter[i] < min_counter) {
-            min_counter = g_cache.lru_counter[i];
-            lru_index = i;
+        if (g_cache.lru_age[i] > g_cache.lru_age[victim]) {
+            victim = i;
         }
     }
     
-    return lru_index;
+    return victim;
 }
 
 /**
- * Update LRU counters (increment all, reset accessed entry)
+ * Update LRU ages within the accessed entry's set
  */
 static void update_lru(int accessed_index) {
-    // Increment all counters
-    for (int i = 0; i < Z1_NEURON_CACHE_SIZE; i++) {
-        if (g_cache.lru_counter[i] < 255) {
-            g_cache.lru_counter[i]++;
+    int base = accessed_index - (accessed_index % Z1_NEURON_CACHE_WAYS);
+    uint8_t age = g_cache.lru_age[accessed_index];
+    
+    // Entries more recent than the accessed one move back by one
+    for (int i = base; i < base + Z1_NEURON_CACHE_WAYS; i++) {
+        if (g_cache.lru_age[i] < age) {
+            g_cache.lru_age[i]++;
         }
     }
     
-    // Reset accessed entry to 0 (most recently used)
-    g_cache.lru_counter[accessed_index] = 0;
+    g_cache.lru_age[accessed_index] = 0;
 }
 
 /**
@@ -111,32 +125,72 @@ static bool flush_entry(int cache_index) {
     }
     
     uint16_t neuron_id = g_cache.neuron_ids[cache_index];
+    const z1_neuron_t* neuron = &g_cache.neurons[cache_index];
+    bool ok;
     
-    if (!z1_psram_write_neuron(neuron_id, &g_cache.neurons[cache_index])) {
+    if (g_cache.dirty[cache_index] & Z1_NEURON_DIRTY_SYNAPSES) {
+        ok = z1_psram_write_neuron(neuron_id, neuron);
+    } else {
+        ok = z1_psram_write_neuron_header(neuron_id, neuron);
+    }
+    
+    if (!ok) {
         printf("[Neuron Cache] ERROR: Failed to flush neuron %d\n", neuron_id);
         return false;
     }
     
-    g_cache.dirty[cache_index] = false;
+    g_cache.dirty[cache_index] = 0;
+    g_cache.writebacks++;
+    g_cache.bursts++;
     return true;
 }
 
 /**
- * Evict LRU entry from cache
+ * Find prefetch slot holding a neuron
+ * Returns slot index, or -1 if not being prefetched
+ */
+static int find_prefetch(uint16_t neuron_id) {
+    for (int i = 0; i < Z1_NEURON_CACHE_PREFETCH; i++) {
+        if (g_prefetch[i].neuron_id == neuron_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Drop a prefetched entry (waits for its DMA to finish)
  */
-static bool evict_lru(void) {
-    int lru_index = find_lru_entry();
+static void drop_prefetch(int slot) {
+    psram_dma_wait(&g_prefetch[slot].dma);
+    g_prefetch[slot].neuron_id = 0xFFFF;
+}
+
+/**
+ * Start DMA writeback of a run of adjacent whole-entry dirty neurons
+ */
+static bool flush_run(const int* indices, int count, int buffer) {
+    uint16_t first_id = g_cache.neuron_ids[indices[0]];
     
-    // Flush if dirty
-    if (!flush_entry(lru_index)) {
-        return false;
+    // Previous burst from this buffer must be out before it is reused
+    psram_dma_wait(&g_flush_dma[buffer]);
+    
+    for (int i = 0; i < count; i++) {
+        z1_psram_serialize_neuron(&g_cache.neurons[indices[i]], g_flush_buffer[buffer] + i * 256);
     }
     
-    // Mark as invalid
-    g_cache.valid[lru_index] = false;
-    g_cache.neuron_ids[lru_index] = 0xFFFF;
-    g_cache.evictions++;
+    if (!z1_psram_write_neuron_range_async(first_id, g_flush_buffer[buffer], (uint16_t)count,
+                                           &g_flush_dma[buffer])) {
+        printf("[Neuron Cache] ERROR: Failed to flush neurons %d-%d\n",
+               first_id, first_id + count - 1);
+        return false;
+    }
     
+    for (int i = 0; i < count; i++) {
+        g_cache.dirty[indices[i]] = 0;
+    }
+    g_cache.writebacks += count;
+    g_cache.bursts++;
     return true;
 }
 
@@ -161,43 +215,77 @@ z1_neuron_t* z1_neuron_cache_get(uint16_t neuron_id) {
     // Cache miss - need to load from PSRAM
     g_cache.misses++;
     
-    // Find free entry or evict LRU
-    cache_index = find_free_entry();
-    if (cache_index < 0) {
-        // Cache full, evict LRU
-        if (!evict_lru()) {
+    // Free way in the set, or evict its LRU entry
+    cache_index = find_victim(neuron_id);
+    if (g_cache.valid[cache_index]) {
+        if (!flush_entry(cache_index)) {
             printf("[Neuron Cache] ERROR: Failed to evict LRU entry\n");
             return NULL;
         }
-        cache_index = find_free_entry();
-        if (cache_index < 0) {
-            printf("[Neuron Cache] ERROR: No free entry after eviction\n");
-            return NULL;
-        }
+        g_cache.valid[cache_index] = false;
+        g_cache.neuron_ids[cache_index] = 0xFFFF;
+        g_cache.evictions++;
     }
     
-    // Load neuron from PSRAM
-    if (!z1_psram_read_neuron(neuron_id, &g_cache.neurons[cache_index])) {
+    // Load neuron: from a finished (or nearly finished) prefetch, else from PSRAM
+    int slot = find_prefetch(neuron_id);
+    if (slot >= 0) {
+        psram_dma_wait(&g_prefetch[slot].dma);
+        bool ok = z1_psram_parse_neuron(g_prefetch[slot].data, &g_cache.neurons[cache_index]);
+        g_prefetch[slot].neuron_id = 0xFFFF;
+        if (!ok) {
+            printf("[Neuron Cache] ERROR: Failed to parse prefetched neuron %d\n", neuron_id);
+            return NULL;
+        }
+        g_cache.prefetch_hits++;
+    } else if (!z1_psram_read_neuron(neuron_id, &g_cache.neurons[cache_index])) {
         printf("[Neuron Cache] ERROR: Failed to load neuron %d from PSRAM\n", neuron_id);
         return NULL;
     }
     
     // Mark entry as valid
     g_cache.valid[cache_index] = true;
-    g_cache.dirty[cache_index] = false;
+    g_cache.dirty[cache_index] = 0;
     g_cache.neuron_ids[cache_index] = neuron_id;
     update_lru(cache_index);
     
     return &g_cache.neurons[cache_index];
 }
 
+/**
+ * Start loading a neuron in the background
+ */
+void z1_neuron_cache_prefetch(uint16_t neuron_id) {
+    if (find_in_cache(neuron_id) >= 0 || find_prefetch(neuron_id) >= 0) {
+        return;
+    }
+    
+    // Prefer an idle free slot, otherwise recycle round-robin
+    int slot = -1;
+    for (int i = 0; i < Z1_NEURON_CACHE_PREFETCH; i++) {
+        if (g_prefetch[i].neuron_id == 0xFFFF && !psram_dma_busy(&g_prefetch[i].dma)) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        slot = g_prefetch_next;
+        g_prefetch_next = (g_prefetch_next + 1) % Z1_NEURON_CACHE_PREFETCH;
+        drop_prefetch(slot);
+    }
+    
+    if (z1_psram_read_neuron_async(neuron_id, g_prefetch[slot].data, &g_prefetch[slot].dma)) {
+        g_prefetch[slot].neuron_id = neuron_id;
+    }
+}
+
 /**
  * Mark cached neuron as dirty (needs flush to PSRAM)
  */
-void z1_neuron_cache_mark_dirty(uint16_t neuron_id) {
+void z1_neuron_cache_mark_dirty(uint16_t neuron_id, uint8_t fields) {
     int cache_index = find_in_cache(neuron_id);
     if (cache_index >= 0) {
-        g_cache.dirty[cache_index] = true;
+        g_cache.dirty[cache_index] |= fields & Z1_NEURON_DIRTY_ALL;
     }
 }
 
@@ -219,14 +307,56 @@ bool z1_neuron_cache_flush(uint16_t neuron_id) {
 bool z1_neuron_cache_flush_all(void) {
     bool success = true;
     
+    // Collect dirty entries in neuron ID order (insertion sort, few entries)
+    int order[Z1_NEURON_CACHE_SIZE];
+    int count = 0;
     for (int i = 0; i < Z1_NEURON_CACHE_SIZE; i++) {
-        if (g_cache.valid[i] && g_cache.dirty[i]) {
-            if (!flush_entry(i)) {
+        if (!g_cache.valid[i] || !g_cache.dirty[i]) {
+            continue;
+        }
+        int j = count++;
+        while (j > 0 && g_cache.neuron_ids[order[j - 1]] > g_cache.neuron_ids[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+    
+    // v2 (CSR) tables keep synapses apart from the parameters; no bursts
+    z1_psram_neuron_table_t table;
+    z1_psram_get_table_info(&table);
+    bool bursts = (table.version == Z1_NEURON_TABLE_V1);
+    
+    int i = 0;
+    int buffer = 0;
+    while (i < count) {
+        // Header-only writebacks cannot be merged (entries are 256 bytes apart)
+        if (!bursts || !(g_cache.dirty[order[i]] & Z1_NEURON_DIRTY_SYNAPSES)) {
+            if (!flush_entry(order[i])) {
                 success = false;
             }
+            i++;
+            continue;
         }
+    
+        // Extend run over adjacent IDs that also need a whole-entry write
+        int run = 1;
+        while (i + run < count && run < Z1_NEURON_CACHE_FLUSH_BURST &&
+               (g_cache.dirty[order[i + run]] & Z1_NEURON_DIRTY_SYNAPSES) &&
+               g_cache.neuron_ids[order[i + run]] == g_cache.neuron_ids[order[i]] + run) {
+            run++;
+        }
+    
+        if (!flush_run(&order[i], run, buffer)) {
+            success = false;
+        }
+        buffer ^= 1;
+        i += run;
     }
     
+    psram_dma_wait(&g_flush_dma[0]);
+    psram_dma_wait(&g_flush_dma[1]);
+    
     return success;
 }
 
@@ -234,6 +364,11 @@ bool z1_neuron_cache_flush_all(void) {
  * Invalidate cache entry
  */
 void z1_neuron_cache_invalidate(uint16_t neuron_id) {
+    int slot = find_prefetch(neuron_id);
+    if (slot >= 0) {
+        drop_prefetch(slot);
+    }
+    
     int cache_index = find_in_cache(neuron_id);
     if (cache_index >= 0) {
         // Flush if dirty before invalidating
@@ -255,6 +390,10 @@ void z1_neuron_cache_clear(void) {
         g_cache.valid[i] = false;
         g_cache.neuron_ids[i] = 0xFFFF;
     }
+    
+    for (int i = 0; i < Z1_NEURON_CACHE_PREFETCH; i++) {
+        drop_prefetch(i);
+    }
 }
 
 /**
@@ -266,12 +405,17 @@ void z1_neuron_cache_get_stats(z1_neuron_cache_stats_t* stats) {
     stats->hits = g_cache.hits;
     stats->misses = g_cache.misses;
     stats->evictions = g_cache.evictions;
+    stats->writebacks = g_cache.writebacks;
+    stats->bursts = g_cache.bursts;
+    stats->prefetch_hits = g_cache.prefetch_hits;
     
     uint32_t total_accesses = g_cache.hits + g_cache.misses;
     if (total_accesses > 0) {
         stats->hit_rate = (float)g_cache.hits / total_accesses;
+        stats->eviction_rate = (float)g_cache.evictions / total_accesses;
     } else {
         stats->hit_rate = 0.0f;
+        stats->eviction_rate = 0.0f;
     }
     
     // Count valid entries
@@ -293,7 +437,11 @@ void z1_neuron_cache_print_stats(void) {
     printf("[Neuron Cache] Stats:\n");
     printf("  Hits:       %u\n", (unsigned int)stats.hits);
     printf("  Misses:     %u\n", (unsigned int)stats.misses);
-    printf("  Evictions:  %u\n", (unsigned int)stats.evictions);
+    printf("  Evictions:  %u (%.1f%% of accesses)\n",
+           (unsigned int)stats.evictions, stats.eviction_rate * 100.0f);
+    printf("  Writebacks: %u entries in %u bursts\n",
+           (unsigned int)stats.writebacks, (unsigned int)stats.bursts);
+    printf("  Prefetched: %u misses\n", (unsigned int)stats.prefetch_hits);
     printf("  Hit Rate:   %.1f%%\n", stats.hit_rate * 100.0f);
     printf("  Entries:    %d / %d\n", stats.entries_used, Z1_NEURON_CACHE_SIZE);
 }
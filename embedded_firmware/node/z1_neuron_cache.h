@@ -1,7 +1,12 @@
 /**
  * Z1 Neuron Cache
  * 
- * LRU cache for streaming neurons from PSRAM to RAM.
+ * Set-associative write-back cache for streaming neurons from PSRAM to RAM.
+ * 
+ * A neuron maps to set (neuron_id % Z1_NEURON_CACHE_SETS) and may occupy
+ * any of that set's ways; replacement is LRU within the set. Dirtiness is
+ * tracked per field group so state-only updates write back just the
+ * 16-byte entry header.
  */
 
 #ifndef Z1_NEURON_CACHE_H
@@ -15,7 +20,17 @@
 // Configuration
 // ============================================================================
 
-#define Z1_NEURON_CACHE_SIZE 16  // Number of neurons to cache in RAM
+#define Z1_NEURON_CACHE_SETS   8   // Sets (power of two)
+#define Z1_NEURON_CACHE_WAYS   4   // Entries per set
+#define Z1_NEURON_CACHE_SIZE   (Z1_NEURON_CACHE_SETS * Z1_NEURON_CACHE_WAYS)
+
+#define Z1_NEURON_CACHE_FLUSH_BURST  4  // Max adjacent entries per PSRAM burst
+#define Z1_NEURON_CACHE_PREFETCH     4  // Outstanding DMA prefetches
+
+// Dirty field groups (z1_neuron_cache_mark_dirty)
+#define Z1_NEURON_DIRTY_STATE     0x01  // Header: flags, potential, threshold, last spike
+#define Z1_NEURON_DIRTY_SYNAPSES  0x02  // Parameters, routing and synapses (whole entry)
+#define Z1_NEURON_DIRTY_ALL       (Z1_NEURON_DIRTY_STATE | Z1_NEURON_DIRTY_SYNAPSES)
 
 // ============================================================================
 // Cache Structure
@@ -25,20 +40,27 @@ typedef struct {
     z1_neuron_t neurons[Z1_NEURON_CACHE_SIZE];  // Cached neurons
     uint16_t neuron_ids[Z1_NEURON_CACHE_SIZE];  // Which neurons are cached
     bool valid[Z1_NEURON_CACHE_SIZE];           // Cache entry valid flags
-    bool dirty[Z1_NEURON_CACHE_SIZE];           // Cache entry dirty flags
-    uint8_t lru_counter[Z1_NEURON_CACHE_SIZE];  // LRU eviction tracking
+    uint8_t dirty[Z1_NEURON_CACHE_SIZE];        // Dirty field groups (Z1_NEURON_DIRTY_*)
+    uint8_t lru_age[Z1_NEURON_CACHE_SIZE];      // Age within set (0 = most recent)
     
     // Statistics
     uint32_t hits;        // Cache hits
     uint32_t misses;      // Cache misses
     uint32_t evictions;   // Cache evictions
+    uint32_t writebacks;  // Entries written back to PSRAM
+    uint32_t bursts;      // PSRAM write operations used for writebacks
+    uint32_t prefetch_hits;  // Misses served from a DMA prefetch
 } z1_neuron_cache_t;
 
 typedef struct {
     uint32_t hits;
     uint32_t misses;
     uint32_t evictions;
+    uint32_t writebacks;
+    uint32_t bursts;
+    uint32_t prefetch_hits;
     float hit_rate;
+    float eviction_rate;  // Evictions per access
     uint16_t entries_used;
 } z1_neuron_cache_stats_t;
 
@@ -59,12 +81,25 @@ void z1_neuron_cache_init(void);
  */
 z1_neuron_t* z1_neuron_cache_get(uint16_t neuron_id);
 
+/**
+ * Start loading a neuron in the background
+ * 
+ * Issues a DMA read of the entry so a later z1_neuron_cache_get() for the
+ * same neuron does not stall on PSRAM. Does nothing if the neuron is
+ * already cached or being prefetched. Code that writes neuron entries to
+ * PSRAM directly must call z1_neuron_cache_invalidate() afterwards.
+ * 
+ * @param neuron_id Local neuron ID
+ */
+void z1_neuron_cache_prefetch(uint16_t neuron_id);
+
 /**
  * Mark cached neuron as dirty (needs flush to PSRAM)
  * 
  * @param neuron_id Local neuron ID
+ * @param fields Modified field groups (Z1_NEURON_DIRTY_*)
  */
-void z1_neuron_cache_mark_dirty(uint16_t neuron_id);
+void z1_neuron_cache_mark_dirty(uint16_t neuron_id, uint8_t fields);
 
 /**
  * Flush specific neuron to PSRAM
@@ -77,6 +112,11 @@ bool z1_neuron_cache_flush(uint16_t neuron_id);
 /**
  * Flush all dirty entries to PSRAM
  * 
+ * Entries are written in neuron ID order; runs of adjacent whole-entry
+ * writebacks are coalesced into single DMA bursts, serializing the next
+ * run while the previous one is in flight. Returns once all writes have
+ * completed.
+ * 
  * @return true if all flushes successful
  */
 bool z1_neuron_cache_flush_all(void);
@@ -0,0 +1,120 @@
+/**
+ * Z1 PSRAM Layout
+ *
+ * Derives the SNN region layout from the detected PSRAM size.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_psram_layout.h"
+#include "psram_rp2350.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+static z1_psram_layout_t g_layout = {0};
+
+// ============================================================================
+// Layout Functions
+// ============================================================================
+
+/**
+ * Derive the layout from the detected PSRAM size
+ */
+bool z1_psram_layout_init(size_t psram_size, uint16_t sram_max_neurons) {
+    memset(&g_layout, 0, sizeof(g_layout));
+
+    if (psram_size <= Z1_PSRAM_STAGING_OFFSET + Z1_PSRAM_FIXED_SIZE) {
+        printf("[PSRAM Layout] ERROR: %u bytes of PSRAM leave no room for neurons\n",
+               (unsigned int)psram_size);
+        return false;
+    }
+
+    // Split the space in per-neuron proportions, 4 KB aligned, so v2 tables
+    // and large fan-in can use what the neuron limit leaves spare
+    uint32_t per_neuron = Z1_PSRAM_STAGING_PER_NEURON + Z1_PSRAM_TABLE_PER_NEURON +
+                          Z1_PSRAM_INDEX_PER_NEURON;
+    uint32_t usable = (uint32_t)(psram_size - Z1_PSRAM_STAGING_OFFSET - Z1_PSRAM_FIXED_SIZE);
+    uint32_t staging_size = (uint32_t)(((uint64_t)usable * Z1_PSRAM_STAGING_PER_NEURON / per_neuron) & ~0xFFFu);
+    uint32_t table_size = (uint32_t)(((uint64_t)usable * Z1_PSRAM_TABLE_PER_NEURON / per_neuron) & ~0xFFFu);
+    uint32_t index_size = usable - staging_size - table_size;
+
+    // Neurons every rounded region has a full share for
+    uint32_t neurons = sram_max_neurons;
+    if (staging_size / Z1_PSRAM_STAGING_PER_NEURON < neurons) {
+        neurons = staging_size / Z1_PSRAM_STAGING_PER_NEURON;
+    }
+    if (table_size / Z1_PSRAM_TABLE_PER_NEURON < neurons) {
+        neurons = table_size / Z1_PSRAM_TABLE_PER_NEURON;
+    }
+    if (index_size / Z1_PSRAM_INDEX_PER_NEURON < neurons) {
+        neurons = index_size / Z1_PSRAM_INDEX_PER_NEURON;
+    }
+    if (neurons == 0) {
+        return false;
+    }
+
+    g_layout.psram_size = (uint32_t)psram_size;
+    g_layout.max_neurons = (uint16_t)neurons;
+    g_layout.staging_addr = PSRAM_BASE_ADDRESS + Z1_PSRAM_STAGING_OFFSET;
+    g_layout.staging_size = staging_size;
+    g_layout.table_addr = g_layout.staging_addr + staging_size;
+    g_layout.table_size = table_size;
+    g_layout.index_addr = g_layout.table_addr + table_size;
+    g_layout.index_size = index_size;
+    g_layout.firmware_addr = g_layout.index_addr + g_layout.index_size;
+    g_layout.firmware_size = Z1_PSRAM_FIRMWARE_SIZE;
+    g_layout.spill_addr = g_layout.firmware_addr + g_layout.firmware_size;
+    g_layout.spill_size = Z1_PSRAM_SPILL_SIZE;
+    g_layout.raster_addr = g_layout.spill_addr + g_layout.spill_size;
+    g_layout.raster_size = Z1_PSRAM_RASTER_SIZE;
+
+    return true;
+}
+
+/**
+ * Get the current layout
+ */
+const z1_psram_layout_t* z1_psram_layout_get(void) {
+    return &g_layout;
+}
+
+/**
+ * Translate a host-side PSRAM address to a device address
+ */
+uint32_t z1_psram_layout_host_to_device(uint32_t host_addr) {
+    if (host_addr >= Z1_PSRAM_HOST_BASE && host_addr - Z1_PSRAM_HOST_BASE < g_layout.psram_size) {
+        return PSRAM_BASE_ADDRESS + (host_addr - Z1_PSRAM_HOST_BASE);
+    }
+
+    if (host_addr >= PSRAM_BASE_ADDRESS && host_addr - PSRAM_BASE_ADDRESS < g_layout.psram_size) {
+        return host_addr;
+    }
+
+    return 0;
+}
+
+/**
+ * Print the layout
+ */
+void z1_psram_layout_print(void) {
+    printf("[PSRAM Layout] %u MB part, %u neurons max\n",
+           (unsigned int)(g_layout.psram_size / (1024 * 1024)), g_layout.max_neurons);
+    printf("  Staging: 0x%08X  %7u bytes\n",
+           (unsigned int)g_layout.staging_addr, (unsigned int)g_layout.staging_size);
+    printf("  Table:   0x%08X  %7u bytes\n",
+           (unsigned int)g_layout.table_addr, (unsigned int)g_layout.table_size);
+    printf("  Index:   0x%08X  %7u bytes (%u targets)\n",
+           (unsigned int)g_layout.index_addr, (unsigned int)g_layout.index_size,
+           (unsigned int)(g_layout.index_size / 4));
+    printf("  Fw:      0x%08X  %7u bytes\n",
+           (unsigned int)g_layout.firmware_addr, (unsigned int)g_layout.firmware_size);
+    printf("  Spill:   0x%08X  %7u bytes\n",
+           (unsigned int)g_layout.spill_addr, (unsigned int)g_layout.spill_size);
+    printf("  Raster:  0x%08X  %7u bytes (%u records)\n",
+           (unsigned int)g_layout.raster_addr, (unsigned int)g_layout.raster_size,
+           (unsigned int)(g_layout.raster_size / 4));
+}
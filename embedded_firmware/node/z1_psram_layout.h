@@ -0,0 +1,105 @@
+/**
+ * Z1 PSRAM Layout
+ *
+ * Splits the detected PSRAM part (2, 4 or 8 MB) into the regions used by
+ * the SNN engine. The first 1 MB is left to host tools ("weights" in
+ * ncp/ncat); the rest is divided in proportion to what one neuron needs
+ * in each region:
+ *
+ *   staging   - deployed tables land here (host address 0x20100000)
+ *   table     - managed neuron table (v1 entries, or v2 params + synapse pool)
+ *   index     - synapse index target entries
+ *   firmware  - received firmware image (fixed size)
+ *   spill     - spike queue overflow ring (fixed size)
+ *   raster    - spike recorder ring (fixed size, at the top of the part)
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_PSRAM_LAYOUT_H
+#define Z1_PSRAM_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_PSRAM_HOST_BASE        0x20000000  // PSRAM as addressed by host tools
+#define Z1_PSRAM_STAGING_OFFSET   0x100000    // Host region below staging (1 MB)
+
+// Per-neuron budget: staging and table entries plus 54 index entries
+#define Z1_PSRAM_STAGING_PER_NEURON  256
+#define Z1_PSRAM_TABLE_PER_NEURON    256
+#define Z1_PSRAM_INDEX_PER_NEURON    (54 * 4)
+
+#define Z1_PSRAM_RASTER_SIZE      0x10000     // Spike recorder ring (16384 records)
+#define Z1_PSRAM_FIRMWARE_SIZE    (Z1_FW_MAX_CHUNKS * Z1_FW_CHUNK_SIZE)  // Firmware distribution image
+#define Z1_PSRAM_SPILL_SIZE       0x10000     // Spike queue overflow (~5400 queued spikes)
+
+// Regions of fixed size at the top of the part
+#define Z1_PSRAM_FIXED_SIZE       (Z1_PSRAM_FIRMWARE_SIZE + Z1_PSRAM_SPILL_SIZE + Z1_PSRAM_RASTER_SIZE)
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Region layout (absolute PSRAM addresses)
+ */
+typedef struct {
+    uint32_t psram_size;      // Detected part size in bytes
+    uint32_t staging_addr;    // Deploy staging area
+    uint32_t staging_size;
+    uint32_t table_addr;      // Managed neuron table / synapse pool
+    uint32_t table_size;
+    uint32_t index_addr;      // Synapse index entries
+    uint32_t index_size;
+    uint32_t firmware_addr;   // Firmware image being received
+    uint32_t firmware_size;
+    uint32_t spill_addr;      // Spike queue overflow ring
+    uint32_t spill_size;
+    uint32_t raster_addr;     // Spike recorder ring
+    uint32_t raster_size;
+    uint16_t max_neurons;     // Neurons per node for this part
+} z1_psram_layout_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Derive the layout from the detected PSRAM size
+ *
+ * @param psram_size Part size from psram_get_size()
+ * @param sram_max_neurons Neurons the SRAM state arrays can hold
+ * @return false if the part is too small for any neurons
+ */
+bool z1_psram_layout_init(size_t psram_size, uint16_t sram_max_neurons);
+
+/**
+ * Get the current layout
+ *
+ * @return Layout (all zero before z1_psram_layout_init())
+ */
+const z1_psram_layout_t* z1_psram_layout_get(void);
+
+/**
+ * Translate a host-side PSRAM address (0x20000000 window) to a device address
+ *
+ * Addresses already in the device window are returned unchanged.
+ *
+ * @param host_addr Address from a MEM_WRITE or similar command
+ * @return Device address, or 0 if outside PSRAM
+ */
+uint32_t z1_psram_layout_host_to_device(uint32_t host_addr);
+
+/**
+ * Print the layout
+ */
+void z1_psram_layout_print(void);
+
+#endif // Z1_PSRAM_LAYOUT_H
@@ -16,7 +16,7 @@
 // Constants
 // ============================================================================
 
-#define Z1_NEURON_ENTRY_SIZE 256  // Each neuron occupies 256 bytes in PSRAM
+#define Z1_NEURON_ENTRY_SIZE 256  // Each neuron occupies 256 bytes in PSRAM (v1)
 
 // ============================================================================
 // PSRAM Neuron Table
@@ -24,19 +24,35 @@
 
 static z1_psram_neuron_table_t g_neuron_table = {0};
 
+/**
+ * Describe a v1 table (fixed 256-byte entries) at the base address
+ */
+static void set_v1_layout(void) {
+    g_neuron_table.version = Z1_NEURON_TABLE_V1;
+    g_neuron_table.entry_size = Z1_NEURON_ENTRY_SIZE;
+    g_neuron_table.entry_addr = g_neuron_table.base_addr;
+    g_neuron_table.row_addr = 0;
+    g_neuron_table.synapse_addr = 0;
+    g_neuron_table.synapse_count = (uint32_t)g_neuron_table.max_neurons * Z1_NEURON_SYNAPSE_CAPACITY;
+    g_neuron_table.end_addr = g_neuron_table.base_addr +
+                              (uint32_t)g_neuron_table.max_neurons * Z1_NEURON_ENTRY_SIZE;
+}
+
 /**
  * Initialize PSRAM neuron table
  */
-bool z1_psram_neuron_table_init(uint32_t base_addr, uint16_t max_neurons) {
-    if (base_addr + (max_neurons * Z1_NEURON_ENTRY_SIZE) > (8 * 1024 * 1024)) {  // 8MB PSRAM
-        printf("[PSRAM Neurons] ERROR: Table exceeds PSRAM size\n");
+bool z1_psram_neuron_table_init(uint32_t base_addr, uint32_t region_size, uint16_t max_neurons) {
+    if ((uint32_t)max_neurons * Z1_NEURON_ENTRY_SIZE > region_size) {
+        printf("[PSRAM Neurons] ERROR: %d neurons exceed table region (%u bytes)\n",
+               max_neurons, (unsigned int)region_size);
         return false;
     }
     
     g_neuron_table.base_addr = base_addr;
+    g_neuron_table.region_size = region_size;
     g_neuron_table.neuron_count = 0;
     g_neuron_table.max_neurons = max_neurons;
-    g_neuron_table.entry_size = Z1_NEURON_ENTRY_SIZE;
+    set_v1_layout();
     
     printf("[PSRAM Neurons] Initialized: base=0x%08X, max=%d neurons\n",
            (unsigned int)base_addr, max_neurons);
@@ -48,7 +64,37 @@ bool z1_psram_neuron_table_init(uint32_t base_addr, uint16_t max_neurons) {
  * Get PSRAM address for a neuron
  */
 static inline uint32_t get_neuron_addr(uint16_t neuron_id) {
-    return g_neuron_table.base_addr + (neuron_id * Z1_NEURON_ENTRY_SIZE);
+    return g_neuron_table.entry_addr + ((uint32_t)neuron_id * g_neuron_table.entry_size);
+}
+
+/**
+ * Locate a neuron's synapses
+ * 
+ * @return false if the row cannot be read
+ */
+static bool get_synapse_row(uint16_t neuron_id, uint32_t* addr, uint16_t* count) {
+    if (g_neuron_table.version == Z1_NEURON_TABLE_V1) {
+        *addr = get_neuron_addr(neuron_id) + Z1_NEURON_SYNAPSE_OFFSET;
+        if (!psram_read(get_neuron_addr(neuron_id) + 16, count, 2)) {
+            return false;
+        }
+        return *count <= Z1_NEURON_SYNAPSE_CAPACITY;
+    }
+    
+    // v2: row bounds from the offset array
+    uint32_t bounds[2];
+    if (neuron_id >= g_neuron_table.neuron_count ||
+        !psram_read(g_neuron_table.row_addr + (uint32_t)neuron_id * 4, bounds, sizeof(bounds))) {
+        return false;
+    }
+    if (bounds[1] < bounds[0] || bounds[1] > g_neuron_table.synapse_count ||
+        bounds[1] - bounds[0] > 0xFFFF) {
+        return false;
+    }
+    
+    *addr = g_neuron_table.synapse_addr + bounds[0] * 4;
+    *count = (uint16_t)(bounds[1] - bounds[0]);
+    return true;
 }
 
 // ============================================================================
@@ -56,9 +102,46 @@ static inline uint32_t get_neuron_addr(uint16_t neuron_id) {
 // ============================================================================
 
 /**
- * Parse neuron from PSRAM binary format to runtime structure
+ * Decode a packed synapse into its runtime form
  */
-bool z1_psram_parse_neuron(const uint8_t* data, z1_neuron_t* neuron) {
+static void decode_synapse(uint32_t synapse_packed, z1_synapse_runtime_t* synapse) {
+    // Extract source neuron ID (bits 27:8)
+    synapse->source_neuron_id = z1_synapse_get_id(synapse_packed);
+    
+    // Extract and decode weight (bits 7:0)
+    synapse->weight = z1_synapse_decode_weight(z1_synapse_get_weight(synapse_packed));
+    
+    // Extract delay (bits 31:28)
+    synapse->delay_us = z1_synapse_get_delay(synapse_packed) * Z1_SNN_TIMESTEP_US;
+}
+
+/**
+ * Pack a runtime synapse: [delay:4][source_id:20][weight:8]
+ */
+static uint32_t encode_synapse(const z1_synapse_runtime_t* synapse) {
+    // Encode weight to 8-bit
+    uint8_t weight_encoded;
+    float weight = synapse->weight;
+    if (weight < 0) {
+        // Negative weight: -2.0 to -0.01 → 128-255
+        weight_encoded = 128 + (uint8_t)(-weight * 63.5f);
+    } else {
+        // Positive weight: 0.0 to 2.0 → 0-127
+        weight_encoded = (uint8_t)(weight * 63.5f);
+    }
+    
+    uint32_t delay_steps = synapse->delay_us / Z1_SNN_TIMESTEP_US;
+    if (delay_steps > Z1_SYNAPSE_MAX_DELAY) {
+        delay_steps = Z1_SYNAPSE_MAX_DELAY;
+    }
+    
+    return (delay_steps << 28) | z1_synapse_pack(synapse->source_neuron_id, weight_encoded);
+}
+
+/**
+ * Parse neuron parameters (entry bytes 0-39) without synapses
+ */
+bool z1_psram_parse_neuron_params(const uint8_t* data, z1_neuron_t* neuron) {
     if (!data || !neuron) return false;
     
     // Parse neuron state (offset 0-15)
@@ -70,13 +153,35 @@ bool z1_psram_parse_neuron(const uint8_t* data, z1_neuron_t* neuron) {
     
     // Parse synapse metadata (offset 16-23)
     memcpy(&neuron->synapse_count, data + 16, 2);
+    memcpy(&neuron->global_id, data + Z1_NEURON_GLOBAL_ID_OFFSET, 4);
     
     // Parse neuron parameters (offset 24-31)
     memcpy(&neuron->leak_rate, data + 24, 4);
     memcpy(&neuron->refractory_period_us, data + 28, 4);
     
+    // Parse routing info (offset 32-33)
+    memcpy(&neuron->fanout_mask, data + Z1_NEURON_FANOUT_OFFSET, 2);
+    
+    // Parse inhibition group (offset 34-39, zero in older tables)
+    neuron->inhibit_group = data[Z1_NEURON_GROUP_OFFSET];
+    neuron->inhibit_k = data[Z1_NEURON_GROUP_OFFSET + 1];
+    memcpy(&neuron->inhibit_strength, data + Z1_NEURON_GROUP_OFFSET + 2, 4);
+    
+    // Initialize runtime state
+    neuron->refractory_until_us = 0;
+    neuron->spike_count = 0;
+    
+    return true;
+}
+
+/**
+ * Parse neuron from PSRAM binary format to runtime structure
+ */
+bool z1_psram_parse_neuron(const uint8_t* data, z1_neuron_t* neuron) {
+    if (!z1_psram_parse_neuron_params(data, neuron)) return false;
+    
     // Validate synapse count
-    if (neuron->synapse_count > Z1_MAX_SYNAPSES_PER_NEURON) {
+    if (neuron->synapse_count > Z1_NEURON_SYNAPSE_CAPACITY) {
         printf("[PSRAM Neurons] ERROR: Neuron %d has invalid synapse count %d\n",
                neuron->neuron_id, neuron->synapse_count);
         return false;
@@ -85,28 +190,10 @@ bool z1_psram_parse_neuron(const uint8_t* data, z1_neuron_t* neuron) {
     // Parse synapses (offset 40-279)
     for (uint16_t i = 0; i < neuron->synapse_count; i++) {
         uint32_t synapse_packed;
-        memcpy(&synapse_packed, data + 40 + (i * 4), 4);
-        
-        // Extract source neuron ID (bits 31:8)
-        neuron->synapses[i].source_neuron_id = synapse_packed >> 8;
-        
-        // Extract and decode weight (bits 7:0)
-        uint8_t weight_encoded = synapse_packed & 0xFF;
-        if (weight_encoded >= 128) {
-            // Negative weight: 128-255 → -0.01 to -2.0
-            neuron->synapses[i].weight = -(weight_encoded - 128) / 63.5f;
-        } else {
-            // Positive weight: 0-127 → 0.0 to 2.0
-            neuron->synapses[i].weight = weight_encoded / 63.5f;
-        }
-        
-        neuron->synapses[i].delay_us = 0;  // No delay in current version
+        memcpy(&synapse_packed, data + Z1_NEURON_SYNAPSE_OFFSET + (i * 4), 4);
+        decode_synapse(synapse_packed, &neuron->synapses[i]);
     }
     
-    // Initialize runtime state
-    neuron->refractory_until_us = 0;
-    neuron->spike_count = 0;
-    
     return true;
 }
 
@@ -130,27 +217,28 @@ bool z1_psram_serialize_neuron(const z1_neuron_t* neuron, uint8_t* data) {
     memcpy(data + 16, &neuron->synapse_count, 2);
     uint16_t synapse_capacity = Z1_MAX_SYNAPSES_PER_NEURON;
     memcpy(data + 18, &synapse_capacity, 2);
+    memcpy(data + Z1_NEURON_GLOBAL_ID_OFFSET, &neuron->global_id, 4);
     
     // Serialize neuron parameters (offset 24-31)
     memcpy(data + 24, &neuron->leak_rate, 4);
     memcpy(data + 28, &neuron->refractory_period_us, 4);
     
-    // Serialize synapses (offset 40-279)
-    for (uint16_t i = 0; i < neuron->synapse_count; i++) {
-        // Encode weight to 8-bit
-        uint8_t weight_encoded;
-        float weight = neuron->synapses[i].weight;
-        if (weight < 0) {
-            // Negative weight: -2.0 to -0.01 → 128-255
-            weight_encoded = 128 + (uint8_t)(-weight * 63.5f);
-        } else {
-            // Positive weight: 0.0 to 2.0 → 0-127
-            weight_encoded = (uint8_t)(weight * 63.5f);
-        }
-        
-        // Pack synapse: [source_id:24][weight:8]
-        uint32_t synapse_packed = (neuron->synapses[i].source_neuron_id << 8) | weight_encoded;
-        memcpy(data + 40 + (i * 4), &synapse_packed, 4);
+    // Serialize routing info (offset 32-33)
+    memcpy(data + Z1_NEURON_FANOUT_OFFSET, &neuron->fanout_mask, 2);
+    
+    // Serialize inhibition group (offset 34-39)
+    data[Z1_NEURON_GROUP_OFFSET] = neuron->inhibit_group;
+    data[Z1_NEURON_GROUP_OFFSET + 1] = neuron->inhibit_k;
+    memcpy(data + Z1_NEURON_GROUP_OFFSET + 2, &neuron->inhibit_strength, 4);
+    
+    // Serialize synapses (offset 40-255)
+    uint16_t synapse_count = neuron->synapse_count;
+    if (synapse_count > Z1_NEURON_SYNAPSE_CAPACITY) {
+        synapse_count = Z1_NEURON_SYNAPSE_CAPACITY;
+    }
+    for (uint16_t i = 0; i < synapse_count; i++) {
+        uint32_t synapse_packed = encode_synapse(&neuron->synapses[i]);
+        memcpy(data + Z1_NEURON_SYNAPSE_OFFSET + (i * 4), &synapse_packed, 4);
     }
     
     return true;
@@ -171,6 +259,28 @@ bool z1_psram_read_neuron(uint16_t neuron_id, z1_neuron_t* neuron) {
     
     if (!neuron) return false;
     
+    if (g_neuron_table.version == Z1_NEURON_TABLE_V2) {
+        if (!z1_psram_read_neuron_params(neuron_id, neuron)) {
+            return false;
+        }
+        if (neuron->synapse_count > Z1_MAX_SYNAPSES_PER_NEURON) {
+            printf("[PSRAM Neurons] ERROR: Neuron %d fan-in %d exceeds runtime entry\n",
+                   neuron_id, neuron->synapse_count);
+            return false;
+        }
+        
+        uint32_t packed[Z1_MAX_SYNAPSES_PER_NEURON];
+        int count = z1_psram_read_neuron_synapses(neuron_id, 0, packed, Z1_MAX_SYNAPSES_PER_NEURON);
+        if (count != neuron->synapse_count) {
+            printf("[PSRAM Neurons] ERROR: Failed to read synapses of neuron %d\n", neuron_id);
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            decode_synapse(packed[i], &neuron->synapses[i]);
+        }
+        return true;
+    }
+    
     // Read neuron data from PSRAM
     uint32_t addr = get_neuron_addr(neuron_id);
     uint8_t buffer[Z1_NEURON_ENTRY_SIZE];
@@ -189,6 +299,26 @@ bool z1_psram_read_neuron(uint16_t neuron_id, z1_neuron_t* neuron) {
     return true;
 }
 
+/**
+ * Read neuron parameters from PSRAM (synapses not loaded)
+ */
+bool z1_psram_read_neuron_params(uint16_t neuron_id, z1_neuron_t* neuron) {
+    if (neuron_id >= g_neuron_table.max_neurons) {
+        printf("[PSRAM Neurons] ERROR: Neuron ID %d out of range\n", neuron_id);
+        return false;
+    }
+    
+    if (!neuron) return false;
+    
+    uint8_t buffer[Z1_NEURON_PARAM_SIZE];
+    if (!psram_read(get_neuron_addr(neuron_id), buffer, sizeof(buffer))) {
+        printf("[PSRAM Neurons] ERROR: Failed to read neuron %d from PSRAM\n", neuron_id);
+        return false;
+    }
+    
+    return z1_psram_parse_neuron_params(buffer, neuron);
+}
+
 /**
  * Write neuron to PSRAM
  */
@@ -207,8 +337,34 @@ bool z1_psram_write_neuron(uint16_t neuron_id, const z1_neuron_t* neuron) {
         return false;
     }
     
-    // Write to PSRAM
     uint32_t addr = get_neuron_addr(neuron_id);
+    
+    if (g_neuron_table.version == Z1_NEURON_TABLE_V2) {
+        // Rows are packed back to back, so they can only be rewritten in place
+        uint32_t row_addr;
+        uint16_t row_count;
+        if (!get_synapse_row(neuron_id, &row_addr, &row_count) ||
+            row_count != neuron->synapse_count) {
+            printf("[PSRAM Neurons] ERROR: Neuron %d synapse count does not match its row\n",
+                   neuron_id);
+            return false;
+        }
+        
+        uint16_t row_length = row_count;
+        memcpy(buffer + 16, &row_length, 2);
+        memcpy(buffer + 18, &row_length, 2);
+        
+        for (uint16_t i = 0; i < row_count; i++) {
+            uint32_t synapse_packed = encode_synapse(&neuron->synapses[i]);
+            if (!psram_write(row_addr + i * 4, &synapse_packed, 4)) {
+                return false;
+            }
+        }
+        
+        return psram_write(addr, buffer, Z1_NEURON_PARAM_SIZE);
+    }
+    
+    // Write to PSRAM
     if (!psram_write(addr, buffer, Z1_NEURON_ENTRY_SIZE)) {
         printf("[PSRAM Neurons] ERROR: Failed to write neuron %d to PSRAM\n", neuron_id);
         return false;
@@ -217,10 +373,202 @@ bool z1_psram_write_neuron(uint16_t neuron_id, const z1_neuron_t* neuron) {
     return true;
 }
 
+/**
+ * Write mutable neuron state to PSRAM
+ */
+bool z1_psram_write_neuron_state(uint16_t neuron_id, float membrane_potential, uint32_t last_spike_time_us) {
+    if (neuron_id >= g_neuron_table.max_neurons) {
+        return false;
+    }
+    
+    // Offsets 4-7 (membrane potential) and 12-15 (last spike time)
+    uint32_t addr = get_neuron_addr(neuron_id);
+    return psram_write(addr + 4, &membrane_potential, 4) &&
+           psram_write(addr + 12, &last_spike_time_us, 4);
+}
+
+/**
+ * Write neuron state header to PSRAM
+ */
+bool z1_psram_write_neuron_header(uint16_t neuron_id, const z1_neuron_t* neuron) {
+    if (neuron_id >= g_neuron_table.max_neurons || !neuron) {
+        return false;
+    }
+    
+    // Same layout as offsets 0-15 of z1_psram_serialize_neuron()
+    uint8_t header[16];
+    memcpy(header + 0, &neuron->neuron_id, 2);
+    memcpy(header + 2, &neuron->flags, 2);
+    memcpy(header + 4, &neuron->membrane_potential, 4);
+    memcpy(header + 8, &neuron->threshold, 4);
+    memcpy(header + 12, &neuron->last_spike_time_us, 4);
+    
+    return psram_write(get_neuron_addr(neuron_id), header, sizeof(header));
+}
+
+/**
+ * Start DMA read of a raw neuron entry
+ */
+bool z1_psram_read_neuron_async(uint16_t neuron_id, uint8_t* data, psram_dma_handle_t* handle) {
+    if (g_neuron_table.version != Z1_NEURON_TABLE_V1 ||
+        neuron_id >= g_neuron_table.max_neurons || !data) {
+        return false;
+    }
+    
+    return psram_read_async(get_neuron_addr(neuron_id), data, Z1_NEURON_ENTRY_SIZE,
+                            handle, NULL, NULL);
+}
+
+/**
+ * Start DMA write of consecutive serialized neuron entries
+ */
+bool z1_psram_write_neuron_range_async(uint16_t first_id, const uint8_t* data, uint16_t count,
+                                       psram_dma_handle_t* handle) {
+    if (g_neuron_table.version != Z1_NEURON_TABLE_V1 ||
+        !data || count == 0 || (uint32_t)first_id + count > g_neuron_table.max_neurons) {
+        return false;
+    }
+    
+    if (!psram_write_async(get_neuron_addr(first_id), data, (size_t)count * Z1_NEURON_ENTRY_SIZE,
+                           handle, NULL, NULL)) {
+        printf("[PSRAM Neurons] ERROR: Failed to write neurons %d-%d to PSRAM\n",
+               first_id, first_id + count - 1);
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * Read packed synapses of a neuron from PSRAM
+ */
+int z1_psram_read_neuron_synapses(uint16_t neuron_id, uint16_t start,
+                                  uint32_t* synapses, uint16_t max_synapses) {
+    if (neuron_id >= g_neuron_table.max_neurons || !synapses) {
+        return -1;
+    }
+    
+    uint32_t addr;
+    uint16_t synapse_count;
+    
+    if (!get_synapse_row(neuron_id, &addr, &synapse_count)) {
+        printf("[PSRAM Neurons] ERROR: Neuron %d has an invalid synapse row\n", neuron_id);
+        return -1;
+    }
+    
+    if (start >= synapse_count) {
+        return 0;
+    }
+    
+    uint16_t n = synapse_count - start;
+    if (n > max_synapses) {
+        n = max_synapses;
+    }
+    
+    if (!psram_read(addr + (uint32_t)start * 4, synapses, (size_t)n * 4)) {
+        return -1;
+    }
+    
+    return n;
+}
+
+/**
+ * Rewrite synapse weights of a neuron in place
+ */
+int z1_psram_write_synapse_weights(uint16_t neuron_id, uint16_t start, const uint8_t* weights,
+                                   uint16_t count, uint32_t* synapses) {
+    if (neuron_id >= g_neuron_table.neuron_count || !weights || !synapses) {
+        return -1;
+    }
+    
+    uint32_t addr;
+    uint16_t synapse_count;
+    
+    if (!get_synapse_row(neuron_id, &addr, &synapse_count)) {
+        printf("[PSRAM Neurons] ERROR: Neuron %d has an invalid synapse row\n", neuron_id);
+        return -1;
+    }
+    
+    if (start >= synapse_count) {
+        return 0;
+    }
+    
+    uint16_t n = synapse_count - start;
+    if (n > count) {
+        n = count;
+    }
+    
+    // Source IDs and delays stay; only the weight byte of each word changes
+    addr += (uint32_t)start * 4;
+    if (!psram_read(addr, synapses, (size_t)n * 4)) {
+        return -1;
+    }
+    
+    uint32_t patched[Z1_NEURON_SYNAPSE_CAPACITY];
+    for (uint16_t done = 0; done < n; ) {
+        uint16_t run = n - done;
+        if (run > Z1_NEURON_SYNAPSE_CAPACITY) {
+            run = Z1_NEURON_SYNAPSE_CAPACITY;
+        }
+        for (uint16_t i = 0; i < run; i++) {
+            patched[i] = (synapses[done + i] & 0xFFFFFF00) | weights[done + i];
+        }
+        if (!psram_write(addr + (uint32_t)done * 4, patched, (size_t)run * 4)) {
+            return -1;
+        }
+        done += run;
+    }
+    
+    return n;
+}
+
+/**
+ * Check for a v2 header and compute the table size
+ * 
+ * @return Table size in bytes, 0 if the source is not a valid v2 table
+ */
+static uint32_t read_v2_header(uint32_t source_addr, z1_neuron_table_header_t* header) {
+    if (!psram_read(source_addr, header, sizeof(*header)) ||
+        memcmp(header->magic, Z1_NEURON_TABLE_MAGIC, 3) != 0) {
+        return 0;
+    }
+    
+    if (header->version != Z1_NEURON_TABLE_V2 || header->param_size != Z1_NEURON_PARAM_SIZE) {
+        printf("[PSRAM Neurons] ERROR: Unsupported table version %d (param size %d)\n",
+               header->version, header->param_size);
+        return 0;
+    }
+    
+    return Z1_NEURON_TABLE_HEADER_SIZE +
+           (uint32_t)header->neuron_count * Z1_NEURON_PARAM_SIZE +
+           ((uint32_t)header->neuron_count + 1) * 4 +
+           header->synapse_count * 4;
+}
+
 /**
  * Bulk load neuron table from PSRAM
  */
 bool z1_psram_load_neuron_table(uint32_t source_addr, uint16_t neuron_count) {
+    z1_neuron_table_header_t header;
+    uint32_t table_size = read_v2_header(source_addr, &header);
+    uint8_t version = (table_size > 0) ? Z1_NEURON_TABLE_V2 : Z1_NEURON_TABLE_V1;
+    
+    if (version == Z1_NEURON_TABLE_V2) {
+        if (neuron_count != header.neuron_count) {
+            printf("[PSRAM Neurons] WARNING: Table header has %d neurons (expected %d)\n",
+                   header.neuron_count, neuron_count);
+        }
+        neuron_count = header.neuron_count;
+        
+        if (table_size > g_neuron_table.region_size) {
+            printf("[PSRAM Neurons] ERROR: Table (%u bytes) exceeds table region (%u bytes)\n",
+                   (unsigned int)table_size, (unsigned int)g_neuron_table.region_size);
+            return false;
+        }
+    } else {
+        table_size = (uint32_t)neuron_count * Z1_NEURON_ENTRY_SIZE;
+    }
+    
     if (neuron_count > g_neuron_table.max_neurons) {
         printf("[PSRAM Neurons] ERROR: Neuron count %d exceeds max %d\n",
                neuron_count, g_neuron_table.max_neurons);
@@ -228,37 +576,32 @@ bool z1_psram_load_neuron_table(uint32_t source_addr, uint16_t neuron_count) {
     }
     
     // Copy neuron table data to our managed area
-    uint32_t table_size = neuron_count * Z1_NEURON_ENTRY_SIZE;
     
-    printf("[PSRAM Neurons] Loading %d neurons from 0x%08X to 0x%08X (%u bytes)\n",
-           neuron_count, (unsigned int)source_addr, 
+    printf("[PSRAM Neurons] Loading %d neurons (v%d) from 0x%08X to 0x%08X (%u bytes)\n",
+           neuron_count, version, (unsigned int)source_addr, 
            (unsigned int)g_neuron_table.base_addr, (unsigned int)table_size);
     
-    // Read in chunks to avoid large stack allocation
-    #define CHUNK_SIZE 1024
-    uint8_t chunk_buffer[CHUNK_SIZE];
-    uint32_t bytes_remaining = table_size;
-    uint32_t src_offset = 0;
-    uint32_t dst_offset = 0;
-    
-    while (bytes_remaining > 0) {
-        uint32_t chunk_len = (bytes_remaining < CHUNK_SIZE) ? bytes_remaining : CHUNK_SIZE;
-        
-        if (!psram_read(source_addr + src_offset, chunk_buffer, chunk_len)) {
-            printf("[PSRAM Neurons] ERROR: Failed to read chunk at offset %u\n", 
-                   (unsigned int)src_offset);
+    // PSRAM-to-PSRAM DMA copy, no bounce buffer
+    if (table_size > 0) {
+        psram_dma_handle_t dma = {0};
+        if (!psram_copy_async(g_neuron_table.base_addr, source_addr, table_size, &dma, NULL, NULL)) {
+            printf("[PSRAM Neurons] ERROR: Failed to start table copy\n");
             return false;
         }
-        
-        if (!psram_write(g_neuron_table.base_addr + dst_offset, chunk_buffer, chunk_len)) {
-            printf("[PSRAM Neurons] ERROR: Failed to write chunk at offset %u\n",
-                   (unsigned int)dst_offset);
-            return false;
-        }
-        
-        src_offset += chunk_len;
-        dst_offset += chunk_len;
-        bytes_remaining -= chunk_len;
+        psram_dma_wait(&dma);
+    }
+    
+    if (version == Z1_NEURON_TABLE_V2) {
+        uint32_t base = g_neuron_table.base_addr;
+        g_neuron_table.version = Z1_NEURON_TABLE_V2;
+        g_neuron_table.entry_size = Z1_NEURON_PARAM_SIZE;
+        g_neuron_table.entry_addr = base + Z1_NEURON_TABLE_HEADER_SIZE;
+        g_neuron_table.row_addr = g_neuron_table.entry_addr + (uint32_t)neuron_count * Z1_NEURON_PARAM_SIZE;
+        g_neuron_table.synapse_addr = g_neuron_table.row_addr + ((uint32_t)neuron_count + 1) * 4;
+        g_neuron_table.synapse_count = header.synapse_count;
+        g_neuron_table.end_addr = base + table_size;
+    } else {
+        set_v1_layout();
     }
     
     g_neuron_table.neuron_count = neuron_count;
@@ -10,11 +10,45 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "z1_snn_engine.h"
+#include "psram_rp2350.h"
 
 // ============================================================================
 // PSRAM Neuron Table
 // ============================================================================
 
+// Entry layout (see docs/ARCHITECTURE.md)
+#define Z1_NEURON_GLOBAL_ID_OFFSET  20  // uint32 compiler-assigned global ID
+#define Z1_NEURON_FANOUT_OFFSET     32  // uint16 destination node mask
+#define Z1_NEURON_GROUP_OFFSET      34  // uint8 group, uint8 k, float strength
+#define Z1_NEURON_SYNAPSE_OFFSET    40  // First packed synapse
+#define Z1_NEURON_SYNAPSE_CAPACITY  ((256 - Z1_NEURON_SYNAPSE_OFFSET) / 4)  // 54
+
+// Table formats. v1 is an array of fixed 256-byte entries. v2 starts with a
+// header, followed by 40-byte parameter records (entry bytes 0-39), row
+// offsets and a compressed-sparse-row synapse array, so fan-in is only
+// limited by the 16-bit synapse count.
+#define Z1_NEURON_TABLE_V1           1
+#define Z1_NEURON_TABLE_V2           2
+#define Z1_NEURON_TABLE_MAGIC        "Z1N"  // v2 header bytes 0-2, version at byte 3
+#define Z1_NEURON_TABLE_HEADER_SIZE  16
+#define Z1_NEURON_PARAM_SIZE         Z1_NEURON_SYNAPSE_OFFSET
+
+/**
+ * v2 table header (16 bytes)
+ * 
+ * Followed by params[neuron_count], uint32 row_offsets[neuron_count + 1]
+ * (in synapses) and uint32 synapses[synapse_count]. A v1 table can never
+ * start with the magic because its first entry is neuron 0.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  magic[3];       // 'Z', '1', 'N'
+    uint8_t  version;        // Z1_NEURON_TABLE_V2
+    uint16_t neuron_count;
+    uint16_t param_size;     // Bytes per parameter record (40)
+    uint32_t synapse_count;  // Total synapses in the CSR array
+    uint32_t reserved;
+} z1_neuron_table_header_t;
+
 /**
  * PSRAM neuron table descriptor
  */
@@ -22,7 +56,14 @@ typedef struct {
     uint32_t base_addr;      // PSRAM base address of neuron table
     uint16_t neuron_count;   // Number of neurons currently loaded
     uint16_t max_neurons;    // Maximum neurons this table can hold
-    uint16_t entry_size;     // Size of each neuron entry (256 bytes)
+    uint16_t entry_size;     // Stride of neuron entries (256 for v1, 40 for v2)
+    uint8_t  version;        // Z1_NEURON_TABLE_V1 or Z1_NEURON_TABLE_V2
+    uint32_t entry_addr;     // First neuron entry / parameter record
+    uint32_t row_addr;       // v2: row offset array
+    uint32_t synapse_addr;   // v2: CSR synapse array
+    uint32_t synapse_count;  // Synapses the table can hold (v1) or holds (v2)
+    uint32_t end_addr;       // First address after the loaded table
+    uint32_t region_size;    // Bytes reserved for the table (see z1_psram_layout.h)
 } z1_psram_neuron_table_t;
 
 // ============================================================================
@@ -32,11 +73,12 @@ typedef struct {
 /**
  * Initialize PSRAM neuron table
  * 
- * @param base_addr PSRAM base address for neuron storage
+ * @param base_addr PSRAM address of the table region
+ * @param region_size Size of the table region in bytes
  * @param max_neurons Maximum number of neurons to support
  * @return true if successful
  */
-bool z1_psram_neuron_table_init(uint32_t base_addr, uint16_t max_neurons);
+bool z1_psram_neuron_table_init(uint32_t base_addr, uint32_t region_size, uint16_t max_neurons);
 
 // ============================================================================
 // Serialization
@@ -51,6 +93,17 @@ bool z1_psram_neuron_table_init(uint32_t base_addr, uint16_t max_neurons);
  */
 bool z1_psram_parse_neuron(const uint8_t* data, z1_neuron_t* neuron);
 
+/**
+ * Parse neuron parameters (entry bytes 0-39) without synapses
+ * 
+ * Sets synapse_count but leaves the synapse array untouched.
+ * 
+ * @param data Pointer to v1 entry or v2 parameter record
+ * @param neuron Pointer to runtime neuron structure to fill
+ * @return true if successful
+ */
+bool z1_psram_parse_neuron_params(const uint8_t* data, z1_neuron_t* neuron);
+
 /**
  * Serialize neuron from runtime structure to PSRAM binary format
  * 
@@ -67,29 +120,131 @@ bool z1_psram_serialize_neuron(const z1_neuron_t* neuron, uint8_t* data);
 /**
  * Read neuron from PSRAM
  * 
+ * Fails for v2 neurons whose fan-in exceeds the runtime structure
+ * (Z1_MAX_SYNAPSES_PER_NEURON); use z1_psram_read_neuron_params() and
+ * z1_psram_read_neuron_synapses() for those.
+ * 
  * @param neuron_id Local neuron ID (0-1023)
  * @param neuron Pointer to neuron structure to fill
  * @return true if successful
  */
 bool z1_psram_read_neuron(uint16_t neuron_id, z1_neuron_t* neuron);
 
+/**
+ * Read neuron parameters from PSRAM (synapses not loaded)
+ * 
+ * @param neuron_id Local neuron ID
+ * @param neuron Pointer to neuron structure to fill
+ * @return true if successful
+ */
+bool z1_psram_read_neuron_params(uint16_t neuron_id, z1_neuron_t* neuron);
+
 /**
  * Write neuron to PSRAM
  * 
+ * For v2 tables the synapses are rewritten in place, so the synapse count
+ * must match the neuron's row length.
+ * 
  * @param neuron_id Local neuron ID (0-1023)
  * @param neuron Pointer to neuron structure to write
  * @return true if successful
  */
 bool z1_psram_write_neuron(uint16_t neuron_id, const z1_neuron_t* neuron);
 
+/**
+ * Write mutable neuron state to PSRAM
+ * 
+ * Updates only the state words of the entry (membrane potential and last
+ * spike time); parameters and synapses are left untouched.
+ * 
+ * @param neuron_id Local neuron ID
+ * @param membrane_potential Current membrane potential
+ * @param last_spike_time_us Last spike timestamp
+ * @return true if successful
+ */
+bool z1_psram_write_neuron_state(uint16_t neuron_id, float membrane_potential, uint32_t last_spike_time_us);
+
+/**
+ * Write neuron state header to PSRAM
+ * 
+ * Writes only the 16-byte header (ID, flags, membrane potential, threshold,
+ * last spike time) from the runtime structure.
+ * 
+ * @param neuron_id Local neuron ID
+ * @param neuron Pointer to neuron structure
+ * @return true if successful
+ */
+bool z1_psram_write_neuron_header(uint16_t neuron_id, const z1_neuron_t* neuron);
+
+/**
+ * Start DMA read of a raw neuron entry (v1 tables only)
+ * 
+ * Parse the 256 bytes with z1_psram_parse_neuron() once the transfer
+ * completes.
+ * 
+ * @param neuron_id Local neuron ID
+ * @param data Buffer for the raw entry (256 bytes, 4-byte aligned)
+ * @param handle Transfer handle
+ * @return true if the transfer was started
+ */
+bool z1_psram_read_neuron_async(uint16_t neuron_id, uint8_t* data, psram_dma_handle_t* handle);
+
+/**
+ * Start DMA write of consecutive serialized neuron entries (one burst)
+ * 
+ * v1 tables only; v2 neurons are written with z1_psram_write_neuron().
+ * 
+ * @param first_id Local ID of the first entry
+ * @param data Serialized entries (count x 256 bytes, valid until complete)
+ * @param count Number of entries
+ * @param handle Transfer handle
+ * @return true if the transfer was started
+ */
+bool z1_psram_write_neuron_range_async(uint16_t first_id, const uint8_t* data, uint16_t count,
+                                       psram_dma_handle_t* handle);
+
+/**
+ * Read packed synapses of a neuron from PSRAM
+ * 
+ * Returns the raw [delay:4][source_id:20][weight:8] words without decoding the rest
+ * of the entry. Used to build the synapse index. Long v2 rows are read in
+ * pieces by advancing start until fewer than max_synapses are returned.
+ * 
+ * @param neuron_id Local neuron ID
+ * @param start Index of the first synapse to read
+ * @param synapses Buffer to receive packed synapses
+ * @param max_synapses Capacity of synapses buffer
+ * @return Number of synapses read, or -1 on error
+ */
+int z1_psram_read_neuron_synapses(uint16_t neuron_id, uint16_t start,
+                                  uint32_t* synapses, uint16_t max_synapses);
+
+/**
+ * Rewrite synapse weights of a neuron in place
+ * 
+ * Read-modify-write of the packed synapse words: source IDs and delays are
+ * kept. The neuron cache and synapse index are not touched; see
+ * z1_snn_engine_patch_weights() for a coherent update.
+ * 
+ * @param neuron_id Local neuron ID
+ * @param start Index of the first synapse to rewrite
+ * @param weights New weights (count bytes)
+ * @param count Number of weights
+ * @param synapses Receives the packed synapses as they were before (count words)
+ * @return Number of synapses rewritten (fewer if the row ends first), or -1 on error
+ */
+int z1_psram_write_synapse_weights(uint16_t neuron_id, uint16_t start, const uint8_t* weights,
+                                   uint16_t count, uint32_t* synapses);
+
 /**
  * Bulk load neuron table from PSRAM
  * 
  * Copies neuron table data from source address to managed neuron table area.
- * Used when controller sends neuron table via memory write commands.
+ * Used when controller sends neuron table via memory write commands. The
+ * format is detected from the v2 header; tables without one are v1.
  * 
  * @param source_addr PSRAM address where neuron table was written
- * @param neuron_count Number of neurons in table
+ * @param neuron_count Number of neurons in table (checked against a v2 header)
  * @return true if successful
  */
 bool z1_psram_load_neuron_table(uint32_t source_addr, uint16_t neuron_count);
@@ -22,6 +22,9 @@ static z1_snn_engine_t g_snn_engine;
 static bool g_engine_initialized = false;
 static bool g_engine_running = false;
 
+// Spikes per inhibition group in the current timestep (k-WTA)
+static uint16_t g_group_fired[256];
+
 // ============================================================================
 // Weight Conversion
 // ============================================================================
@@ -67,7 +70,11 @@ static inline float decode_weight(uint8_t weight_int) {
  *     [24-27] float leak_rate
  *     [28-31] uint32_t refractory_period_us
  * 
- *   Offset 32-39:  Reserved (8 bytes)
+ *   Offset 32-39:  Routing and inhibition group (8 bytes)
+ *     [32-33] uint16_t fanout_mask (not used by this engine)
+ *     [34]    uint8_t inhibit_group (0 = none)
+ *     [35]    uint8_t inhibit_k (0 = no limit)
+ *     [36-39] float inhibit_strength
  * 
  *   Offset 40-279: Synapses (60 × 4 bytes = 240 bytes)
  *     Each synapse: uint32_t packed as:
@@ -92,6 +99,11 @@ static bool parse_neuron_entry(const uint8_t* data, z1_neuron_t* neuron) {
     memcpy(&neuron->leak_rate, data + 24, 4);
     memcpy(&neuron->refractory_period_us, data + 28, 4);
     
+    // Parse inhibition group (offset 34-39)
+    neuron->inhibit_group = data[34];
+    neuron->inhibit_k = data[35];
+    memcpy(&neuron->inhibit_strength, data + 36, 4);
+    
     // Validate
     if (neuron->synapse_count > Z1_MAX_SYNAPSES_PER_NEURON) {
         return false;
@@ -208,6 +220,20 @@ static void apply_leak(z1_neuron_t* neuron, uint32_t delta_t_us) {
     }
 }
 
+/**
+ * Subtract a member's spike from the rest of its inhibition group
+ */
+static void inhibit_group(const z1_neuron_t* source) {
+    float inhibition = fabsf(source->inhibit_strength);
+    
+    for (uint16_t n = 0; n < g_snn_engine.neuron_count; n++) {
+        z1_neuron_t* neuron = &g_snn_engine.neurons[n];
+        if (neuron != source && neuron->inhibit_group == source->inhibit_group) {
+            neuron->membrane_potential -= inhibition;
+        }
+    }
+}
+
 /**
  * Process incoming spike to a neuron
  */
@@ -242,6 +268,13 @@ static void process_spike_to_neuron(z1_neuron_t* neuron, uint32_t source_id,
     
     // Check for spike
     if (neuron->membrane_potential >= neuron->threshold) {
+        // k-WTA: the first k members over threshold in a timestep win
+        if (neuron->inhibit_group != 0 && neuron->inhibit_k != 0 &&
+            g_group_fired[neuron->inhibit_group] >= neuron->inhibit_k) {
+            neuron->membrane_potential = 0.0f;
+            return;
+        }
+        
         // Generate spike
         z1_spike_t outgoing_spike = {
             .neuron_id = neuron->neuron_id,
@@ -259,6 +292,11 @@ static void process_spike_to_neuron(z1_neuron_t* neuron, uint32_t source_id,
         neuron->spike_count++;
         
         g_snn_engine.stats.spikes_generated++;
+        
+        if (neuron->inhibit_group != 0) {
+            g_group_fired[neuron->inhibit_group]++;
+            inhibit_group(neuron);
+        }
     }
 }
 
@@ -378,6 +416,7 @@ void z1_snn_engine_step(void) {
     }
     
     uint32_t current_time = g_snn_engine.current_time_us;
+    memset(g_group_fired, 0, sizeof(g_group_fired));
     
     // Check for incoming spikes from bus
     check_bus_for_spikes(current_time);
@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "../common/z1_protocol.h"
 
 // ============================================================================
 // Configuration
@@ -21,6 +22,8 @@
 #define Z1_SNN_MAX_SYNAPSES     60    // Maximum synapses per neuron
 #define Z1_SNN_PSRAM_BASE       0x20000000  // PSRAM base address
 #define Z1_SNN_NEURON_TABLE_OFFSET 0x100000 // 1MB offset for neuron table
+#define Z1_SNN_TIMESTEP_US      1000  // 1ms timestep
+#define Z1_SYNAPSE_MAX_DELAY    15    // Maximum synaptic delay (timesteps)
 
 // ============================================================================
 // Neuron Data Structures
@@ -41,7 +44,8 @@ typedef struct __attribute__((packed)) {
  * Synapse entry (4 bytes)
  * 
  * Packed format:
- *   Bits [31:8]  - Source neuron global ID (24 bits)
+ *   Bits [31:28] - Extra delivery delay in timesteps (0 = none)
+ *   Bits [27:8]  - Source neuron global ID (20 bits: node [27:24], local [23:8])
  *   Bits [7:0]   - Weight (8-bit fixed point, 0-255)
  */
 typedef uint32_t z1_synapse_t;
@@ -56,14 +60,17 @@ typedef struct __attribute__((packed)) {
     // Synapse table metadata (8 bytes)
     uint16_t synapse_count;       // Number of incoming synapses
     uint16_t synapse_capacity;    // Max synapses allocated
-    uint32_t reserved1;
+    uint32_t global_id;           // Compiler-assigned global ID
     
     // Neuron parameters (8 bytes)
     float    leak_rate;           // Membrane leak rate (0.0-1.0)
     uint32_t refractory_period_us; // Refractory period
     
-    // Reserved for future use (8 bytes)
-    uint32_t reserved2[2];
+    // Routing (2 bytes) + inhibition group (6 bytes)
+    uint16_t fanout_mask;         // Destination nodes of this neuron's spikes
+    uint8_t  inhibit_group;       // Inhibition group ID (0 = none)
+    uint8_t  inhibit_k;           // Group k-WTA winners per timestep (0 = no limit)
+    float    inhibit_strength;    // Subtracted from the other members per member spike
     
     // Synapse entries (60 × 4 bytes = 240 bytes)
     z1_synapse_t synapses[Z1_SNN_MAX_SYNAPSES];
@@ -75,6 +82,9 @@ typedef struct __attribute__((packed)) {
 #define Z1_NEURON_FLAG_INPUT        0x0004  // Input neuron (no processing)
 #define Z1_NEURON_FLAG_OUTPUT       0x0008  // Output neuron
 #define Z1_NEURON_FLAG_REFRACTORY   0x0010  // In refractory period
+#define Z1_NEURON_FLAG_ROUTED       0x0020  // fanout_mask is valid (set by compiler)
+#define Z1_NEURON_FLAG_PLASTIC      0x0040  // Input weights learn by STDP (v2 engine)
+#define Z1_NEURON_FLAG_GATEWAY      0x0080  // Targets on other backplanes: spikes also go to the controller
 
 // ============================================================================
 // Runtime Structures (in RAM)
@@ -108,6 +118,11 @@ typedef struct {
     uint32_t refractory_period_us;                         // Refractory period
     uint32_t refractory_until_us;                          // Refractory end time
     uint16_t synapse_count;                                // Number of synapses
+    uint16_t fanout_mask;                                  // Destination node mask
+    uint8_t inhibit_group;                                 // Inhibition group (0 = none)
+    uint8_t inhibit_k;                                     // k-WTA winners (0 = no limit)
+    float inhibit_strength;                                // Group inhibition per spike
+    uint32_t global_id;                                    // Compiler-assigned global ID
     uint32_t spike_count;                                  // Total spikes generated
     z1_synapse_runtime_t synapses[Z1_MAX_SYNAPSES_PER_NEURON];  // Synapse array
 } z1_neuron_t;
@@ -238,6 +253,17 @@ void z1_snn_process_spike(uint32_t global_neuron_id, uint32_t timestamp_us, uint
  */
 void z1_snn_inject_input(uint16_t local_neuron_id, float value);
 
+/**
+ * Inject a batch of input spikes (Z1_CMD_SNN_INPUT_SPIKE payload)
+ * 
+ * Dual-core builds hand the whole batch to the stepping core in one
+ * ingress record while an input slot is free.
+ * 
+ * @param data Packed z1_input_spike_t entries
+ * @param length Payload length in bytes (at most Z1_INPUT_BATCH_MAX entries)
+ */
+void z1_snn_inject_batch(const uint8_t* data, uint16_t length);
+
 /**
  * Update synapse weight
  * 
@@ -321,7 +347,7 @@ void z1_neuron_generate_spike(const z1_neuron_entry_t* neuron);
  * @return Packed synapse value
  */
 static inline z1_synapse_t z1_synapse_pack(uint32_t global_neuron_id, uint8_t weight) {
-    return ((global_neuron_id & 0xFFFFFF) << 8) | weight;
+    return ((global_neuron_id & 0xFFFFF) << 8) | weight;
 }
 
 /**
@@ -331,7 +357,17 @@ static inline z1_synapse_t z1_synapse_pack(uint32_t global_neuron_id, uint8_t we
  * @return Global neuron ID
  */
 static inline uint32_t z1_synapse_get_id(z1_synapse_t synapse) {
-    return (synapse >> 8) & 0xFFFFFF;
+    return (synapse >> 8) & 0xFFFFF;
+}
+
+/**
+ * Unpack synapse delay
+ * 
+ * @param synapse Packed synapse value
+ * @return Delay in timesteps (0 to Z1_SYNAPSE_MAX_DELAY)
+ */
+static inline uint8_t z1_synapse_get_delay(z1_synapse_t synapse) {
+    return synapse >> 28;
 }
 
 /**
@@ -344,6 +380,19 @@ static inline uint8_t z1_synapse_get_weight(z1_synapse_t synapse) {
     return synapse & 0xFF;
 }
 
+/**
+ * Decode 8-bit synapse weight
+ * 
+ * @param weight Encoded weight (0-127 positive, 128-255 negative)
+ * @return Decoded weight (-2.0 to 2.0)
+ */
+static inline float z1_synapse_decode_weight(uint8_t weight) {
+    if (weight >= 128) {
+        return -(weight - 128) / 63.5f;
+    }
+    return weight / 63.5f;
+}
+
 /**
  * Set synapse weight
  * 
@@ -411,6 +460,175 @@ static inline bool z1_spike_queue_full(const z1_spike_queue_t* queue) {
 // extern z1_snn_engine_state_t g_snn_state;
 // extern z1_spike_queue_t g_spike_queue;
 
+// ============================================================================
+// Engine V2 API (z1_snn_engine_v2.c)
+// ============================================================================
+
+bool z1_snn_engine_init(uint8_t node_id);
+bool z1_snn_engine_load_network(uint32_t table_addr, uint16_t neuron_count);
+bool z1_snn_engine_start(void);
+void z1_snn_engine_stop(void);
+bool z1_snn_engine_is_running(void);
+void z1_snn_engine_step(uint32_t current_time_us);
+void z1_snn_engine_service_egress(void);
+void z1_snn_engine_process_spike(uint32_t global_neuron_id, uint32_t timestamp_us, uint8_t flags);
+void z1_snn_engine_process_spike_batch(const uint8_t* data, uint16_t length);
+void z1_snn_engine_inject_spike(uint16_t local_neuron_id, float value);
+void z1_snn_engine_inject_batch(const uint8_t* data, uint16_t length);
+void z1_snn_engine_get_stats(uint16_t* active_neurons, uint32_t* total_spikes, uint32_t* spike_rate_hz);
+void z1_snn_engine_get_status(z1_snn_status_t* status);
+uint16_t z1_snn_engine_get_spikes(const z1_spike_read_req_t* req, uint8_t* buffer, uint16_t size);
+void z1_snn_engine_print_status(void);
+
+/**
+ * Apply a weight patch (Z1_CMD_SNN_WEIGHT_UPDATE payload)
+ *
+ * Rewrites the weights in the loaded PSRAM table and in the synapse index
+ * that delivery reads, and drops cached copies of the patched neurons.
+ * Refused while running. Reloading the table (a deploy) restores the
+ * deployed weights.
+ *
+ * @param data Records (z1_weight_patch_header_t, ...)
+ * @param length Payload length
+ * @param result Synapses applied and rejected
+ * @return false if the payload ends inside a record or has an unknown format
+ */
+bool z1_snn_engine_patch_weights(const uint8_t* data, uint16_t length, z1_weight_patch_result_t* result);
+bool z1_snn_engine_update_weight(uint16_t local_neuron_id, uint16_t synapse_idx, uint8_t weight);
+
+// Delivery backends, picked by z1_snn_engine_load_network()
+#define Z1_SNN_BACKEND_STREAMING    0   // Synapse index rows fetched from PSRAM by DMA
+#define Z1_SNN_BACKEND_RESIDENT     1   // Synapse index copied to SRAM, rows walked in place
+
+/**
+ * Get the delivery backend of the loaded network
+ *
+ * A network runs resident when its synapse index fits the SRAM copy
+ * (Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES targets) and streams otherwise.
+ * Both use the same neuron state and produce the same spikes.
+ *
+ * @return Z1_SNN_BACKEND_*
+ */
+uint8_t z1_snn_engine_get_backend(void);
+
+// ============================================================================
+// Checkpoints (z1_snn_engine_v2.c)
+// ============================================================================
+
+/**
+ * Serialize the run state of the stopped engine (see "SNN Checkpoints" in z1_protocol.h)
+ *
+ * @param addr PSRAM device address for the image
+ * @param capacity Bytes available at addr
+ * @param info Receives the image description and its Z1_SNN_CKPT_STATUS_*
+ * @return true if the image was written
+ */
+bool z1_snn_engine_checkpoint(uint32_t addr, uint32_t capacity, z1_snn_ckpt_info_t* info);
+
+/**
+ * Check a checkpoint image and apply it to the loaded network
+ *
+ * The image must come from the same network (neuron count and topology
+ * hash). Learned weights go into the synapse index and the neuron table
+ * at once; potentials, refractory times and traces are picked up by the
+ * next z1_snn_engine_start(). Refused while running.
+ *
+ * @param addr PSRAM device address of the image
+ * @param capacity Bytes readable at addr
+ * @param info Receives the image description and its Z1_SNN_CKPT_STATUS_*
+ * @return true if the state was restored
+ */
+bool z1_snn_engine_restore(uint32_t addr, uint32_t capacity, z1_snn_ckpt_info_t* info);
+
+// ============================================================================
+// Batch Inference (z1_snn_engine_v2.c)
+// ============================================================================
+
+/**
+ * Arm or disarm the staged batch for the next start (see "Batch Inference" in z1_protocol.h)
+ *
+ * Checks the image and writes the results header behind it. Ignored while
+ * running.
+ *
+ * @param addr PSRAM device address of the image (0 = no batch)
+ * @param capacity Bytes available at addr for the image and its results
+ * @return true if the batch was armed (or disarmed)
+ */
+bool z1_snn_engine_set_batch(uint32_t addr, uint32_t capacity);
+
+/**
+ * Check whether the engine runs a batch
+ *
+ * @return true if the next or current run is a batch run
+ */
+bool z1_snn_engine_batch_enabled(void);
+
+/**
+ * Run the next step of a free-running batch
+ *
+ * @return false once the batch is done (or without one)
+ */
+bool z1_snn_engine_batch_step(void);
+
+/**
+ * Fill the Z1_CMD_SNN_BATCH answer
+ *
+ * @param info Receives the staged batch and its progress (capacity is left to the caller)
+ */
+void z1_snn_engine_batch_get_info(z1_snn_batch_info_t* info);
+
+// ============================================================================
+// Timestep Barrier (z1_snn_engine_v2.c)
+// ============================================================================
+
+/**
+ * Choose free-running or barrier stepping for the next start
+ *
+ * In barrier mode (Z1_SNN_START_SYNC) a step runs only once the controller
+ * releases it with Z1_CMD_SNN_TICK, on logical time (step * timestep), and
+ * remote spikes arrive with a fixed Z1_SNN_SYNC_LATENCY_STEPS latency. Runs
+ * are then repeatable across nodes and bus timing; bit-exact results also
+ * need Z1_SNN_FIXED_POINT, as float sums depend on arrival order.
+ *
+ * @param enabled Step on controller ticks (ignored while running)
+ */
+void z1_snn_engine_set_sync(bool enabled);
+
+/**
+ * Check whether the engine steps on controller ticks
+ *
+ * @return true in barrier mode
+ */
+bool z1_snn_engine_sync_enabled(void);
+
+/**
+ * Release a timestep (Z1_CMD_SNN_TICK, bus IRQ)
+ *
+ * A tick for a step already released asks for its STEP_DONE again.
+ *
+ * @param step_lo Low byte of the released step
+ */
+void z1_snn_engine_sync_tick(uint8_t step_lo);
+
+/**
+ * Run the next timestep if it has been released (stepping core)
+ *
+ * @return true if a step ran
+ */
+bool z1_snn_engine_sync_step(void);
+
+/**
+ * Check whether a STEP_DONE report is due (bus-owning core)
+ *
+ * Step k is reported once it is computed and the remote spikes of step
+ * k - 1 are on the bus; call before z1_snn_engine_service_egress() so the
+ * spikes of k are sent while the other nodes compute k + 1.
+ *
+ * @param step_lo Receives the low byte of the finished step
+ * @return true if Z1_CMD_SNN_STEP_DONE should be sent to the controller now
+ */
+bool z1_snn_engine_sync_poll(uint8_t* step_lo);
+
 // ============================================================================
 // Compatibility Macros (header declares z1_snn_*, implementation has z1_snn_engine_*)
 // ============================================================================
@@ -420,6 +638,10 @@ static inline bool z1_spike_queue_full(const z1_spike_queue_t* queue) {
 #define z1_snn_start()                      z1_snn_engine_start()
 #define z1_snn_stop()                       z1_snn_engine_stop()
 #define z1_snn_step(timestep)               z1_snn_engine_step(timestep)
+#define z1_snn_process_spike(id, ts, flags) z1_snn_engine_process_spike(id, ts, flags)
+#define z1_snn_process_spike_batch(d, len)  z1_snn_engine_process_spike_batch(d, len)
 #define z1_snn_inject_input(id, value)      z1_snn_engine_inject_spike(id, value)
+#define z1_snn_inject_batch(d, len)         z1_snn_engine_inject_batch(d, len)
+#define z1_snn_update_weight(id, idx, w)    z1_snn_engine_update_weight(id, idx, w)
 
 #endif // Z1_SNN_ENGINE_H
@@ -1,54 +1,403 @@
 /**
  * Z1 Neuromorphic Compute Node - SNN Execution Engine V2
  * 
- * PSRAM-based streaming architecture with neuron caching.
- * Reduces RAM usage from 655KB to ~15KB.
+ * PSRAM-based streaming architecture. Per-timestep neuron state lives in
+ * SRAM structure-of-arrays; synapses stay in PSRAM and are only read
+ * (through the synapse index) when a spike needs them.
+ * 
+ * Delivery has two backends behind the same API, picked when a network
+ * is loaded: resident, for networks whose synapse index fits an SRAM copy,
+ * and streaming, which fetches index rows from PSRAM with DMA. Both apply
+ * targets through one inlined loop, so neither carries the other's checks.
  * 
  * Copyright NeuroFab Corp. All rights reserved.
  */
 
 #include "z1_snn_engine.h"
 #include "z1_psram_neurons.h"
+#include "z1_psram_layout.h"
 #include "z1_neuron_cache.h"
+#include "z1_synapse_index.h"
+#include "z1_spike_ring.h"
+#include "z1_spike_batch.h"
+#include "z1_spike_wheel.h"
+#include "z1_snn_profile.h"
+#include "z1_spike_recorder.h"
 #include "z1_matrix_bus.h"
 #include "z1_multiframe.h"
+#include "z1_trace.h"
+#include "../common/z1_crc32.h"
+#include "pico/time.h"
+#ifdef Z1_SNN_FIXED_POINT
+#include "z1_fixed_point.h"
+#endif
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
 // ============================================================================
 // Configuration
 // ============================================================================
 
-#define Z1_SNN_TIMESTEP_US 1000  // 1ms timestep
-
-// Reduce spike queue size to save RAM
+// SRAM part of the spike queue; spikes beyond it spill to the PSRAM spill
+// region (z1_psram_layout.h) instead of being dropped
 #undef Z1_MAX_SPIKE_QUEUE_SIZE
 #define Z1_MAX_SPIKE_QUEUE_SIZE 128
 
+// Spilled spikes collected in SRAM per PSRAM write
+#define Z1_SNN_SPILL_STAGE 16
+
+// Target entries read from the synapse index per PSRAM burst
+#define Z1_SNN_FANOUT_CHUNK 32
+
+// Fan-out blocks in the delivery pipeline: while one block is applied, the
+// rest are being fetched by DMA (1 = no overlap, 2 = double-buffered)
+#ifndef Z1_SNN_PREFETCH_DEPTH
+#define Z1_SNN_PREFETCH_DEPTH 2
+#endif
+
+// Neurons the SRAM state arrays can hold (~40 bytes each). The real limit
+// is Z1_SNN_STATE_SRAM_BUDGET below, shared with the resident synapse
+// index: at the default 256 KB about 5800 neurons fit with 8192 resident
+// index targets, about 6600 with none. Above that the budget has to grow,
+// up to the 8192 a global neuron ID's local field can address. The
+// per-node limit is the smaller of this and what the PSRAM part can store.
+#ifndef Z1_SNN_V2_MAX_NEURONS
+#define Z1_SNN_V2_MAX_NEURONS 4096
+#endif
+
+#if Z1_SNN_V2_MAX_NEURONS > Z1_GLOBAL_LOCAL_LIMIT
+#error "Z1_SNN_V2_MAX_NEURONS exceeds the local ID range of a global neuron ID (Z1_GLOBAL_LOCAL_LIMIT)"
+#endif
+
+// SRAM the neuron state arrays, active-set bitmaps and resident synapse
+// index may take together (of 520 KB; the rest holds the bus arenas,
+// stacks and the other engine buffers). Checked at compile time below.
+#ifndef Z1_SNN_STATE_SRAM_BUDGET
+#define Z1_SNN_STATE_SRAM_BUDGET (256 * 1024)
+#endif
+
+// STDP of neurons flagged Z1_NEURON_FLAG_PLASTIC; defaults follow the
+// emulator's STDPConfig. Amplitudes are in weight units (w_max = 1.0 is
+// weight code 63), traces in Q12 (one spike adds Z1_STDP_TRACE_ONE).
+#ifndef Z1_STDP_A_PLUS
+#define Z1_STDP_A_PLUS          0.01f
+#endif
+#ifndef Z1_STDP_A_MINUS
+#define Z1_STDP_A_MINUS         0.01f
+#endif
+#ifndef Z1_STDP_TAU_PLUS_US
+#define Z1_STDP_TAU_PLUS_US     20000
+#endif
+#ifndef Z1_STDP_TAU_MINUS_US
+#define Z1_STDP_TAU_MINUS_US    20000
+#endif
+#define Z1_STDP_WEIGHT_MAX      63
+#define Z1_STDP_TRACE_ONE       4096
+#define Z1_STDP_DECAY_POWERS    16      // Traces older than 2^16 steps read as 0
+
+// Learned index blocks held for the batched write-back at the end of a step
+#ifndef Z1_STDP_WRITEBACK_BLOCKS
+#define Z1_STDP_WRITEBACK_BLOCKS 8
+#endif
+
+// Inhibition groups (entry bytes 34-39) and their member slots on this node
+#ifndef Z1_SNN_MAX_GROUPS
+#define Z1_SNN_MAX_GROUPS 16
+#endif
+#ifndef Z1_SNN_GROUP_MEMBERS
+#define Z1_SNN_GROUP_MEMBERS 1024
+#endif
+
+// k-WTA members over threshold in one step; more are clamped without firing
+#define Z1_SNN_WTA_CANDIDATES 256
+
+// Batch inference: staged inputs read per PSRAM burst, and HOLD inputs
+// repeated for the rest of their sample
+#define Z1_SNN_BATCH_INPUT_CHUNK 32
+#ifndef Z1_SNN_BATCH_HELD_MAX
+#define Z1_SNN_BATCH_HELD_MAX 1024
+#endif
+
+// ============================================================================
+// Membrane Arithmetic
+// ============================================================================
+
+#ifdef Z1_SNN_FIXED_POINT
+// Q16.16 potentials, integer weight accumulation, leak as a precomputed
+// (1 - leak_rate) multiplier
+typedef z1_q16_t z1_potential_t;
+#define Z1_POTENTIAL_ZERO     0
+#define Z1_POTENTIAL_ONE      Z1_Q16_ONE
+#define Z1_POTENTIAL_EPSILON  66     // 0.001 in Q16.16
+
+// Decoded synapse weights, indexed by 8-bit encoding
+static z1_q16_t g_weight_lut[256];
+
+static inline z1_potential_t potential_from_float(float f) {
+    return z1_q16_from_float(f);
+}
+
+static inline float potential_to_float(z1_potential_t v) {
+    return z1_q16_to_float(v);
+}
+
+static inline z1_potential_t potential_add(z1_potential_t v, z1_potential_t dv) {
+    return z1_q16_add_sat(v, dv);
+}
+
+static inline z1_potential_t potential_add_weight(z1_potential_t v, uint8_t weight) {
+    return z1_q16_add_sat(v, g_weight_lut[weight]);
+}
+
+static inline z1_potential_t potential_decay(z1_potential_t v, z1_potential_t factor) {
+    return z1_q16_mul(v, factor);
+}
+#else
+typedef float z1_potential_t;
+#define Z1_POTENTIAL_ZERO     0.0f
+#define Z1_POTENTIAL_ONE      1.0f
+#define Z1_POTENTIAL_EPSILON  0.001f
+
+static inline z1_potential_t potential_from_float(float f) {
+    return f;
+}
+
+static inline float potential_to_float(z1_potential_t v) {
+    return v;
+}
+
+static inline z1_potential_t potential_add(z1_potential_t v, z1_potential_t dv) {
+    return v + dv;
+}
+
+static inline z1_potential_t potential_add_weight(z1_potential_t v, uint8_t weight) {
+    return v + z1_synapse_decode_weight(weight);
+}
+
+static inline z1_potential_t potential_decay(z1_potential_t v, z1_potential_t factor) {
+    return v * factor;
+}
+#endif
+
 // ============================================================================
 // Global State
 // ============================================================================
 
 typedef struct {
     bool initialized;
-    bool running;
+    volatile bool running;
+    volatile bool stepping;      // Step in progress (set by the stepping core)
     uint8_t node_id;
     uint16_t neuron_count;
     uint32_t current_time_us;
     uint32_t timestep_us;
+    uint32_t steps_completed;    // Timesteps finished since start
+    bool resume;                 // Restored checkpoint, not yet picked up by a step
+    uint8_t backend;             // Z1_SNN_BACKEND_* of the loaded network
     
     // Statistics
     uint32_t total_spikes;
     uint32_t spikes_generated;
     uint32_t spikes_received;
     uint32_t spikes_processed;
+    uint32_t spikes_dropped;     // Received spikes refused by a full ingress ring
+    uint32_t synapse_events;     // Target updates from the synapse index
+    uint32_t fanout_blocks;      // Index blocks fetched for delivery
+    uint32_t fanout_stalls;      // Blocks still in flight when needed
+    uint16_t active_neurons;     // Neurons visited by the last step
 } z1_snn_state_t;
 
 static z1_snn_state_t g_snn_state = {0};
 
+// Neuron state, structure-of-arrays (~40 bytes/neuron with the active set).
+// Hot: read/written by every visit. Warm: touched on activation or when a neuron fires.
+typedef struct {
+    // Hot
+    z1_potential_t membrane_potential[Z1_SNN_V2_MAX_NEURONS];
+    z1_potential_t threshold[Z1_SNN_V2_MAX_NEURONS];
+    z1_potential_t leak_factor[Z1_SNN_V2_MAX_NEURONS];   // 1 - leak_rate
+    uint32_t refractory_until_us[Z1_SNN_V2_MAX_NEURONS];
+    uint16_t flags[Z1_SNN_V2_MAX_NEURONS];
+    
+    // Warm
+    uint32_t refractory_period_us[Z1_SNN_V2_MAX_NEURONS];
+    uint32_t last_spike_time_us[Z1_SNN_V2_MAX_NEURONS];
+    uint16_t fanout_mask[Z1_SNN_V2_MAX_NEURONS];
+    uint32_t last_update_step[Z1_SNN_V2_MAX_NEURONS];   // Leak applied through this step
+    uint8_t group[Z1_SNN_V2_MAX_NEURONS];               // Slot in g_groups + 1 (0 = none)
+    
+    // Plasticity (Z1_NEURON_FLAG_PLASTIC neurons): post trace as of post_step
+    uint16_t post_trace[Z1_SNN_V2_MAX_NEURONS];
+    uint32_t post_step[Z1_SNN_V2_MAX_NEURONS];          // Step of the last spike
+} z1_neuron_state_arrays_t;
+
+static z1_neuron_state_arrays_t g_neurons;
+
+// Active set: neurons the next step must visit. A neuron joins when input
+// arrives and leaves after a visit unless it is still refractory with
+// charge pending. Resting or sub-threshold neurons left out of the sweep
+// only decay, so their skipped leak is applied in closed form when they
+// are next activated.
+#define Z1_SNN_ACTIVE_WORDS ((Z1_SNN_V2_MAX_NEURONS + 31) / 32)
+static uint32_t g_active_bits[Z1_SNN_ACTIVE_WORDS];
+
+// Neurons that can change without input (threshold <= 0 or leak factor > 1)
+static uint32_t g_always_active_bits[Z1_SNN_ACTIVE_WORDS];
+
+_Static_assert(sizeof(z1_neuron_state_arrays_t) + 2 * sizeof(g_active_bits) +
+               Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES * sizeof(z1_synapse_target_t) <= Z1_SNN_STATE_SRAM_BUDGET,
+               "Z1_SNN_V2_MAX_NEURONS and Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES exceed Z1_SNN_STATE_SRAM_BUDGET");
+
+// Inhibition groups: a member's spike is applied to the rest of its group
+// in one pass over the member list after the sweep, instead of through
+// explicit inhibitory synapses (N^2 storage and deliveries)
+typedef struct {
+    uint8_t id;                  // Group ID from the table
+    uint8_t k;                   // Winners per step (0 = no limit)
+    z1_potential_t inhibition;   // Added to the other members per member spike (<= 0)
+    uint16_t first;              // Members in g_group_members
+    uint16_t count;
+    uint16_t fired;              // Members that fired this step
+} z1_inhibit_group_t;
+
+static z1_inhibit_group_t g_groups[Z1_SNN_MAX_GROUPS];
+static uint8_t g_group_count;
+static uint16_t g_group_members[Z1_SNN_GROUP_MEMBERS];
+static uint32_t g_group_clamped;     // k-WTA losers reset without firing
+
+// k-WTA members that crossed threshold this step, ascending ID
+static uint16_t g_wta_candidates[Z1_SNN_WTA_CANDIDATES];
+static uint16_t g_wta_candidate_count;
+
+// Scratch for parsing table entries at load time
+static z1_neuron_t g_load_scratch;
+
+// Delivery pipeline: ring of fan-out blocks fetched ahead of use
+typedef struct {
+    z1_synapse_target_t targets[Z1_SNN_FANOUT_CHUNK];
+    psram_dma_handle_t dma;
+    uint16_t count;
+    uint32_t source_id;          // For error reports
+    uint32_t first;              // Index entry of targets[0]
+    uint16_t row;                // Directory row of the source
+    bool row_end;                // Last block of the row
+} z1_fanout_block_t;
+
+typedef struct {
+    z1_fanout_block_t blocks[Z1_SNN_PREFETCH_DEPTH];
+    uint8_t head;                // Next block to apply
+    uint8_t in_flight;           // Blocks issued but not yet applied
+    uint16_t spikes_left;        // Queued spikes not yet looked up
+    uint32_t source_id;          // Row being issued
+    uint16_t row;
+    uint32_t row_first;          // Remaining part of that row
+    uint16_t row_count;
+} z1_fanout_pipeline_t;
+
+static z1_fanout_pipeline_t g_fanout;
+
+// STDP. Pre traces belong to synapse index rows, so synapses from remote
+// sources learn like local ones. Traces are decayed lazily, from the step
+// they last changed, with precomputed Q16 multipliers for 2^j steps.
+typedef struct {
+    z1_synapse_target_t targets[Z1_SNN_FANOUT_CHUNK];
+    uint32_t first;
+    uint16_t count;
+} z1_stdp_writeback_t;
+
+typedef struct {
+    bool enabled;                // Loaded network has plastic neurons
+    uint32_t rng;                // Stochastic rounding of weight steps
+    int32_t a_plus;              // Weight-code step per unit trace, Q8
+    int32_t a_minus;
+    uint32_t pre_decay[Z1_STDP_DECAY_POWERS];
+    uint32_t post_decay[Z1_STDP_DECAY_POWERS];
+    
+    uint16_t pre_trace[Z1_SYNAPSE_INDEX_MAX_SOURCES];   // As of pre_step
+    uint32_t pre_step[Z1_SYNAPSE_INDEX_MAX_SOURCES];    // Step of the last delivery
+    uint32_t dirty_rows[Z1_SYNAPSE_INDEX_MAX_SOURCES / 32];  // Learned, table not yet synced
+    uint32_t learned_rows[Z1_SYNAPSE_INDEX_MAX_SOURCES / 32];  // Learned since the table was loaded
+    
+    uint8_t writeback_count;
+    z1_stdp_writeback_t writeback[Z1_STDP_WRITEBACK_BLOCKS];
+    
+    // Statistics
+    uint32_t potentiations;
+    uint32_t depressions;
+    uint32_t blocks_written;
+    uint32_t writeback_batches;
+} z1_stdp_state_t;
+
+static z1_stdp_state_t g_stdp;
+
+// Ticks the current step has spent waiting on fan-out DMA
+static uint32_t g_step_stall_ticks;
+
+// Timestep barrier (Z1_SNN_START_SYNC): steps run on controller ticks
+typedef struct {
+    bool enabled;
+    volatile uint32_t released;  // Highest step the controller has ticked
+    volatile uint32_t flushed;   // Remote spikes of steps up to here are on the bus
+    uint32_t reported;           // Last step reported with STEP_DONE
+    volatile bool repeat;        // Tick repeated by the controller: report again
+    uint32_t deferred;           // Remote spikes held back to the fixed latency
+} z1_snn_sync_t;
+
+static z1_snn_sync_t g_sync;
+
+// Batch run (Z1_SNN_START_BATCH): samples of the staged image one after
+// another, spikes of the output neurons counted per sample
+typedef struct {
+    bool enabled;                // Next or current run is a batch run
+    uint8_t status;              // Z1_SNN_BATCH_STATUS_* of the last set_batch
+    uint32_t addr;               // PSRAM device address of the image
+    uint32_t results_addr;       // PSRAM device address of the results
+    z1_snn_batch_header_t header;
+    
+    uint16_t sample;             // Sample being run
+    volatile uint16_t samples_done;
+    uint32_t sample_start_us;    // Logical time of its first step
+    
+    // Staged inputs not yet applied
+    uint32_t next_input;
+    uint16_t buf_pos;
+    uint16_t buf_fill;
+    z1_snn_batch_input_t buffer[Z1_SNN_BATCH_INPUT_CHUNK];
+    
+    // HOLD inputs of the current sample
+    z1_input_spike_t held[Z1_SNN_BATCH_HELD_MAX];
+    uint16_t held_count;
+    uint16_t held_dropped;
+    
+    // Output neurons (ascending local ID) and their spikes this sample
+    uint16_t outputs[Z1_SNN_BATCH_MAX_OUTPUTS];
+    uint16_t counts[Z1_SNN_BATCH_MAX_OUTPUTS];
+    uint16_t output_count;
+} z1_snn_batch_t;
+
+static z1_snn_batch_t g_batch = { .status = Z1_SNN_BATCH_STATUS_NONE };
+
+#ifdef Z1_NODE_DUAL_CORE
+// Cross-core spike rings: core0 pushes ingress / pops egress, core1 the reverse
+static z1_spike_ring_t g_ingress_ring;
+static z1_spike_ring_t g_egress_ring;
+
+// Input batches handed to core1 whole: one ring record per batch
+#define Z1_SNN_INPUT_SLOTS 2
+
+typedef struct {
+    volatile bool busy;          // Set by core0, cleared by core1 once applied
+    uint16_t count;
+    z1_input_spike_t entries[Z1_INPUT_BATCH_MAX];
+} z1_input_slot_t;
+
+static z1_input_slot_t g_input_slots[Z1_SNN_INPUT_SLOTS];
+#endif
+
 // Reduced spike queue (internal types)
 typedef struct {
-    uint32_t global_neuron_id;
+    uint32_t global_neuron_id;   // Source neuron (see Global Neuron Addressing)
     uint32_t timestamp_us;
     uint8_t flags;
 } z1_spike_event_internal_t;
@@ -62,20 +411,130 @@ typedef struct {
 
 static z1_spike_queue_internal_t g_spike_queue = {0};
 
+// Overflow of the spike queue: a PSRAM ring behind the SRAM one. While it
+// holds spikes, new ones queue behind them, so delivery order is unchanged.
+typedef struct {
+    uint32_t base;               // PSRAM ring (0 = no spill region)
+    uint32_t capacity;           // Events the ring holds
+    uint32_t head;               // Oldest event in PSRAM
+    uint32_t count;              // Events in PSRAM
+    z1_spike_event_internal_t stage[Z1_SNN_SPILL_STAGE];  // Newest, not yet written
+    uint16_t staged;
+    uint32_t spilled;            // Events that went past the SRAM ring
+    uint32_t dropped;            // Events lost with both rings full
+    uint32_t peak;               // Most events spilled at once
+} z1_spike_spill_t;
+
+static z1_spike_spill_t g_spill = {0};
+
 // ============================================================================
 // Spike Queue Management
 // ============================================================================
 
+static uint32_t spike_queue_count(void) {
+    return g_spike_queue.count + g_spill.count + g_spill.staged;
+}
+
+static void spike_queue_reset(void) {
+    g_spike_queue.head = 0;
+    g_spike_queue.tail = 0;
+    g_spike_queue.count = 0;
+    g_spill.head = 0;
+    g_spill.count = 0;
+    g_spill.staged = 0;
+}
+
+// Write the staged events behind the ones already in PSRAM
+static void spill_write_stage(void) {
+    uint32_t tail = (g_spill.head + g_spill.count) % g_spill.capacity;
+    uint32_t first = g_spill.capacity - tail;
+    if (first > g_spill.staged) {
+        first = g_spill.staged;
+    }
+    
+    psram_write(g_spill.base + tail * sizeof(z1_spike_event_internal_t), g_spill.stage,
+                first * sizeof(z1_spike_event_internal_t));
+    if (first < g_spill.staged) {
+        psram_write(g_spill.base, &g_spill.stage[first],
+                    (g_spill.staged - first) * sizeof(z1_spike_event_internal_t));
+    }
+    g_spill.count += g_spill.staged;
+    g_spill.staged = 0;
+}
+
+static bool spill_push(const z1_spike_event_internal_t* event) {
+    if (g_spill.count + g_spill.staged >= g_spill.capacity) {
+        g_spill.dropped++;
+        return false;
+    }
+    
+    g_spill.stage[g_spill.staged++] = *event;
+    if (g_spill.staged == Z1_SNN_SPILL_STAGE) {
+        spill_write_stage();
+    }
+    
+    g_spill.spilled++;
+    if (g_spill.count + g_spill.staged > g_spill.peak) {
+        g_spill.peak = g_spill.count + g_spill.staged;
+    }
+    return true;
+}
+
+// Refill the empty SRAM ring with the oldest spilled events
+static void spill_refill(void) {
+    g_spike_queue.head = 0;
+    
+    if (g_spill.count > 0) {
+        uint32_t n = (g_spill.count < Z1_MAX_SPIKE_QUEUE_SIZE) ? g_spill.count : Z1_MAX_SPIKE_QUEUE_SIZE;
+        uint32_t first = g_spill.capacity - g_spill.head;
+        if (first > n) {
+            first = n;
+        }
+        
+        psram_read(g_spill.base + g_spill.head * sizeof(z1_spike_event_internal_t),
+                   g_spike_queue.events, first * sizeof(z1_spike_event_internal_t));
+        if (first < n) {
+            psram_read(g_spill.base, &g_spike_queue.events[first],
+                       (n - first) * sizeof(z1_spike_event_internal_t));
+        }
+        g_spill.head = (g_spill.head + n) % g_spill.capacity;
+        g_spill.count -= n;
+        g_spike_queue.count = (uint16_t)n;
+    } else {
+        // Nothing in PSRAM: the stage holds the oldest spilled events
+        memcpy(g_spike_queue.events, g_spill.stage, g_spill.staged * sizeof(z1_spike_event_internal_t));
+        g_spike_queue.count = g_spill.staged;
+        g_spill.staged = 0;
+    }
+    
+    g_spike_queue.tail = g_spike_queue.count % Z1_MAX_SPIKE_QUEUE_SIZE;
+}
+
 static bool spike_queue_push(uint32_t global_neuron_id, uint32_t timestamp_us, uint8_t flags) {
-    if (g_spike_queue.count >= Z1_MAX_SPIKE_QUEUE_SIZE) {
-        printf("[SNN] WARNING: Spike queue full, dropping spike\n");
+    z1_spike_event_internal_t event = {
+        .global_neuron_id = global_neuron_id,
+        .timestamp_us = timestamp_us,
+        .flags = flags,
+    };
+    
+    // Spikes of an earlier batch sample must not reach the current one
+    if (g_batch.enabled && timestamp_us < g_batch.sample_start_us &&
+        z1_global_backplane_field(global_neuron_id) == 0) {
+        z1_spike_batch_consumed(global_neuron_id);
         return false;
     }
     
-    g_spike_queue.events[g_spike_queue.tail].global_neuron_id = global_neuron_id;
-    g_spike_queue.events[g_spike_queue.tail].timestamp_us = timestamp_us;
-    g_spike_queue.events[g_spike_queue.tail].flags = flags;
+    // SRAM only while nothing older waits in the spill ring
+    if (g_spill.count + g_spill.staged > 0 || g_spike_queue.count >= Z1_MAX_SPIKE_QUEUE_SIZE) {
+        if (!spill_push(&event)) {
+            Z1_TRACE(SNN, Z1_TRACE_ERROR, Z1_EV_SNN_QUEUE_FULL, 0, global_neuron_id);
+            z1_spike_batch_consumed(global_neuron_id);
+            return false;
+        }
+        return true;
+    }
     
+    g_spike_queue.events[g_spike_queue.tail] = event;
     g_spike_queue.tail = (g_spike_queue.tail + 1) % Z1_MAX_SPIKE_QUEUE_SIZE;
     g_spike_queue.count++;
     
@@ -84,7 +543,10 @@ static bool spike_queue_push(uint32_t global_neuron_id, uint32_t timestamp_us, u
 
 static bool spike_queue_pop(z1_spike_event_internal_t* event) {
     if (g_spike_queue.count == 0) {
-        return false;
+        if (g_spill.count + g_spill.staged == 0) {
+            return false;
+        }
+        spill_refill();
     }
     
     if (event) {
@@ -97,245 +559,2361 @@ static bool spike_queue_pop(z1_spike_event_internal_t* event) {
     return true;
 }
 
-// ============================================================================
-// SNN Engine Functions
-// ============================================================================
-
 /**
- * Initialize SNN engine
+ * Check whether a queued spike must wait for a later step (barrier mode)
+ *
+ * Remote spikes of step k are applied in step k + Z1_SNN_SYNC_LATENCY_STEPS
+ * however early they arrive, so results do not depend on bus timing.
+ * Spikes relayed from other backplanes are applied as they come: their
+ * steps are counted by another barrier.
  */
-bool z1_snn_engine_init(uint8_t node_id) {
-    if (g_snn_state.initialized) {
-        printf("[SNN] Already initialized\n");
-        return true;
-    }
-    
-    printf("[SNN] Initializing engine for node %d\n", node_id);
-    
-    // Initialize state
-    memset(&g_snn_state, 0, sizeof(g_snn_state));
-    g_snn_state.node_id = node_id;
-    g_snn_state.timestep_us = Z1_SNN_TIMESTEP_US;
-    
-    // Initialize PSRAM neuron table (base address 0x100000, max 1024 neurons)
-    if (!z1_psram_neuron_table_init(0x100000, 1024)) {
-        printf("[SNN] ERROR: Failed to initialize PSRAM neuron table\n");
+static inline bool spike_too_early(const z1_spike_event_internal_t* spike) {
+    if ((spike->global_neuron_id >> 16) == g_snn_state.node_id ||
+        z1_global_backplane_field(spike->global_neuron_id) != 0) {
         return false;
     }
-    
-    // Initialize neuron cache
-    z1_neuron_cache_init();
-    
-    // Initialize spike queue
-    memset(&g_spike_queue, 0, sizeof(g_spike_queue));
-    
-    g_snn_state.initialized = true;
-    
-    printf("[SNN] Engine initialized successfully\n");
-    printf("[SNN] RAM usage: ~15 KB (cache + queue + state)\n");
-    printf("[SNN] PSRAM capacity: 1024 neurons (256 KB)\n");
-    
-    return true;
+    uint32_t source_step = spike->timestamp_us / g_snn_state.timestep_us;
+    return source_step + Z1_SNN_SYNC_LATENCY_STEPS > g_snn_state.steps_completed + 1;
 }
 
+// ============================================================================
+// Active Set
+// ============================================================================
+
 /**
- * Load neuron network from PSRAM
+ * Decay a positive potential by factor^steps (square-and-multiply)
  */
-bool z1_snn_engine_load_network(uint32_t table_addr, uint16_t neuron_count) {
-    if (!g_snn_state.initialized) {
-        printf("[SNN] ERROR: Engine not initialized\n");
-        return false;
-    }
-    
-    if (neuron_count > 1024) {
-        printf("[SNN] ERROR: Neuron count %d exceeds max 1024\n", neuron_count);
-        return false;
+static z1_potential_t potential_decay_steps(z1_potential_t v, z1_potential_t factor, uint32_t steps) {
+    if (factor <= Z1_POTENTIAL_ZERO) {
+        return Z1_POTENTIAL_ZERO;  // First step already clamps to rest
     }
     
-    printf("[SNN] Loading network: %d neurons from PSRAM 0x%08X\n",
-           neuron_count, (unsigned int)table_addr);
-    
-    // Load neuron table from PSRAM
-    if (!z1_psram_load_neuron_table(table_addr, neuron_count)) {
-        printf("[SNN] ERROR: Failed to load neuron table\n");
-        return false;
+    while (steps > 0 && v >= Z1_POTENTIAL_EPSILON) {
+        if (steps & 1) {
+            v = potential_decay(v, factor);
+        }
+        factor = potential_decay(factor, factor);
+        steps >>= 1;
     }
     
-    g_snn_state.neuron_count = neuron_count;
-    
-    // Clear cache (will be populated on-demand)
-    z1_neuron_cache_clear();
-    
-    printf("[SNN] Network loaded: %d neurons\n", neuron_count);
-    
-    return true;
+    return (v < Z1_POTENTIAL_EPSILON) ? Z1_POTENTIAL_ZERO : v;
 }
 
 /**
- * Start SNN execution
+ * Apply leak for steps the neuron was skipped, up to and including a step
  */
-bool z1_snn_engine_start(void) {
-    if (!g_snn_state.initialized) {
-        printf("[SNN] ERROR: Engine not initialized\n");
-        return false;
-    }
+static void catch_up_leak(uint16_t i, uint32_t through_step) {
+    uint32_t skipped = through_step - g_neurons.last_update_step[i];
+    g_neurons.last_update_step[i] = through_step;
     
-    if (g_snn_state.neuron_count == 0) {
-        printf("[SNN] ERROR: No network loaded\n");
-        return false;
+    if (skipped > 0 && g_neurons.membrane_potential[i] > Z1_POTENTIAL_ZERO) {
+        g_neurons.membrane_potential[i] =
+            potential_decay_steps(g_neurons.membrane_potential[i], g_neurons.leak_factor[i], skipped);
     }
-    
-    g_snn_state.running = true;
-    g_snn_state.current_time_us = 0;
-    
-    printf("[SNN] Started: %d neurons, timestep=%u us\n",
-           g_snn_state.neuron_count, (unsigned int)g_snn_state.timestep_us);
-    
-    return true;
 }
 
 /**
- * Stop SNN execution
+ * Add neuron to the active set (bring its leak up to date first)
  */
-void z1_snn_engine_stop(void) {
-    g_snn_state.running = false;
-    
-    // Flush all dirty cache entries to PSRAM
-    z1_neuron_cache_flush_all();
-    
-    printf("[SNN] Stopped\n");
-    z1_neuron_cache_print_stats();
+static inline void activate_neuron(uint16_t i) {
+    uint32_t bit = 1u << (i & 31);
+    if (!(g_active_bits[i >> 5] & bit)) {
+        catch_up_leak(i, g_snn_state.steps_completed);
+        g_active_bits[i >> 5] |= bit;
+    }
 }
 
 /**
- * Check if engine is running
+ * Bring every inactive neuron's leak up to date (before state is read out)
  */
-bool z1_snn_engine_is_running(void) {
-    return g_snn_state.running;
+static void settle_inactive_neurons(void) {
+    for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
+        if (!(g_active_bits[i >> 5] & (1u << (i & 31)))) {
+            catch_up_leak(i, g_snn_state.steps_completed);
+        }
+    }
 }
 
 /**
- * Process single neuron (apply leak, check threshold)
+ * Reset active set so the first step visits every neuron
  */
-static void process_neuron(z1_neuron_t* neuron, uint32_t current_time_us) {
-    // Check refractory period
-    if (current_time_us < neuron->refractory_until_us) {
-        return;  // Still in refractory period
-    }
+static void reset_active_set(void) {
+    memset(g_active_bits, 0, sizeof(g_active_bits));
+    memset(g_always_active_bits, 0, sizeof(g_always_active_bits));
     
-    // Apply membrane leak
-    if (neuron->membrane_potential > 0.0f) {
-        neuron->membrane_potential *= (1.0f - neuron->leak_rate);
+    for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
+        g_active_bits[i >> 5] |= 1u << (i & 31);
+        g_neurons.last_update_step[i] = 0;
         
-        // Clamp to zero if very small
-        if (neuron->membrane_potential < 0.001f) {
-            neuron->membrane_potential = 0.0f;
+        if (g_neurons.threshold[i] <= Z1_POTENTIAL_ZERO ||
+            g_neurons.leak_factor[i] > Z1_POTENTIAL_ONE) {
+            g_always_active_bits[i >> 5] |= 1u << (i & 31);
         }
     }
     
-    // Check for spike
-    if (neuron->membrane_potential >= neuron->threshold) {
-        // Generate spike
-        neuron->last_spike_time_us = current_time_us;
-        neuron->spike_count++;
-        neuron->membrane_potential = 0.0f;  // Reset
-        neuron->refractory_until_us = current_time_us + neuron->refractory_period_us;
-        
-        g_snn_state.spikes_generated++;
-        
-        // Send spike to connected neurons (via synapses)
-        for (uint16_t i = 0; i < neuron->synapse_count; i++) {
-            uint32_t target_global_id = neuron->synapses[i].source_neuron_id;
-            
-            // Add to spike queue for routing
-            spike_queue_push(target_global_id, current_time_us, 0);
-        }
-    }
+    g_snn_state.steps_completed = 0;
 }
 
+// ============================================================================
+// Inhibition Groups
+// ============================================================================
+
 /**
- * Process single timestep
+ * Find or add the slot of a neuron's inhibition group (load time)
+ *
+ * @return Slot + 1, or 0 if the neuron has no group or it cannot be tracked
  */
-void z1_snn_engine_step(uint32_t current_time_us) {
-    if (!g_snn_state.running) {
-        return;
+static uint8_t group_slot_for(const z1_neuron_t* neuron, uint16_t* members, uint16_t* dropped) {
+    if (neuron->inhibit_group == 0) {
+        return 0;
+    }
+    if (*members >= Z1_SNN_GROUP_MEMBERS) {
+        (*dropped)++;
+        return 0;
     }
     
-    g_snn_state.current_time_us = current_time_us;
-    
-    // Process pending spikes from queue
-    z1_spike_event_internal_t spike;
-    while (spike_queue_pop(&spike)) {
-        g_snn_state.spikes_processed++;
-        
-        // Extract target node and local neuron ID
-        uint8_t target_node = (spike.global_neuron_id >> 16) & 0xFF;
-        uint16_t local_neuron_id = spike.global_neuron_id & 0xFFFF;
-        
-        if (target_node == g_snn_state.node_id) {
-            // Local neuron - apply spike
-            z1_neuron_t* neuron = z1_neuron_cache_get(local_neuron_id);
-            if (neuron) {
-                // Find synapse weight (simplified - use first synapse weight)
-                float weight = (neuron->synapse_count > 0) ? neuron->synapses[0].weight : 1.0f;
-                
-                neuron->membrane_potential += weight;
-                z1_neuron_cache_mark_dirty(local_neuron_id);
-            }
-        } else {
-            // Remote neuron - route via matrix bus
-            // Pack spike data: [global_id:4][timestamp:4][flags:1]
-            uint8_t spike_data[9];
-            memcpy(&spike_data[0], &spike.global_neuron_id, 4);
-            memcpy(&spike_data[4], &spike.timestamp_us, 4);
-            spike_data[8] = spike.flags;
-            
-            // Send spike to target node via multi-frame protocol
-            if (z1_send_multiframe(target_node, Z1_CMD_SNN_SPIKE, spike_data, sizeof(spike_data))) {
-                printf("[SNN] Routed spike (neuron %u) to node %d\n", 
-                       (unsigned int)spike.global_neuron_id, target_node);
-            } else {
-                printf("[SNN] ERROR: Failed to route spike to node %d\n", target_node);
-            }
+    uint8_t slot = 0;
+    while (slot < g_group_count && g_groups[slot].id != neuron->inhibit_group) {
+        slot++;
+    }
+    if (slot == g_group_count) {
+        if (g_group_count >= Z1_SNN_MAX_GROUPS) {
+            (*dropped)++;
+            return 0;
         }
+        z1_inhibit_group_t* group = &g_groups[g_group_count++];
+        memset(group, 0, sizeof(*group));
+        group->id = neuron->inhibit_group;
+        group->k = neuron->inhibit_k;
+        group->inhibition = potential_from_float(-fabsf(neuron->inhibit_strength));
     }
     
-    // Update all neurons (stream from PSRAM via cache)
-    for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
-        z1_neuron_t* neuron = z1_neuron_cache_get(i);
-        if (neuron) {
-            process_neuron(neuron, current_time_us);
-            z1_neuron_cache_mark_dirty(i);
-        }
+    g_groups[slot].count++;
+    (*members)++;
+    return slot + 1;
+}
+
+/**
+ * Fill member lists once every neuron has its slot (load time)
+ */
+static void group_build_members(void) {
+    uint16_t offset = 0;
+    for (uint8_t g = 0; g < g_group_count; g++) {
+        g_groups[g].first = offset;
+        offset += g_groups[g].count;
+        g_groups[g].count = 0;
     }
     
-    // Periodically flush dirty entries (every 100 timesteps)
-    static uint32_t flush_counter = 0;
-    if (++flush_counter >= 100) {
-        z1_neuron_cache_flush_all();
-        flush_counter = 0;
+    for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
+        if (g_neurons.group[i] != 0) {
+            z1_inhibit_group_t* group = &g_groups[g_neurons.group[i] - 1];
+            g_group_members[group->first + group->count++] = i;
+        }
     }
 }
 
+// ============================================================================
+// Plasticity (STDP)
+// ============================================================================
+
 /**
- * Inject external spike into neuron
+ * Decay a Q12 trace over a number of steps
  */
-void z1_snn_engine_inject_spike(uint16_t local_neuron_id, float value) {
-    if (!g_snn_state.running) {
-        return;
+static uint16_t stdp_trace_at(uint16_t trace, uint32_t steps, const uint32_t* decay) {
+    if (steps >> Z1_STDP_DECAY_POWERS) {
+        return 0;
     }
     
-    if (local_neuron_id >= g_snn_state.neuron_count) {
-        printf("[SNN] ERROR: Invalid neuron ID %d\n", local_neuron_id);
-        return;
+    for (uint8_t j = 0; steps != 0 && trace != 0; j++, steps >>= 1) {
+        if (steps & 1) {
+            trace = (uint16_t)(((uint32_t)trace * decay[j]) >> 16);
+        }
     }
     
-    z1_neuron_t* neuron = z1_neuron_cache_get(local_neuron_id);
-    if (neuron) {
-        neuron->membrane_potential += value;
-        z1_neuron_cache_mark_dirty(local_neuron_id);
-        g_snn_state.spikes_received++;
-    }
+    return trace;
+}
+
+/**
+ * Add one spike to a trace (saturating)
+ */
+static inline uint16_t stdp_trace_bump(uint16_t trace) {
+    return (trace > 0xFFFF - Z1_STDP_TRACE_ONE) ? 0xFFFF : trace + Z1_STDP_TRACE_ONE;
+}
+
+/**
+ * Fill decay multipliers for 1, 2, 4, ... steps of a time constant
+ */
+static void stdp_fill_decay(uint32_t* decay, uint32_t tau_us) {
+    float d = expf(-(float)g_snn_state.timestep_us / (float)tau_us);
+    
+    for (uint8_t j = 0; j < Z1_STDP_DECAY_POWERS; j++) {
+        uint32_t q = (uint32_t)(d * 65536.0f + 0.5f);
+        decay[j] = (q > 0xFFFF) ? 0xFFFF : q;
+        d *= d;
+    }
+}
+
+static inline uint32_t stdp_random(void) {
+    uint32_t x = g_stdp.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_stdp.rng = x;
+    return x;
+}
+
+/**
+ * Clear traces (start of a run) and set up the network's parameters
+ */
+static void stdp_reset(void) {
+    g_stdp.enabled = false;
+    for (uint16_t i = 0; i < g_snn_state.neuron_count && !g_stdp.enabled; i++) {
+        g_stdp.enabled = (g_neurons.flags[i] & Z1_NEURON_FLAG_PLASTIC) != 0;
+    }
+    
+    // A restored checkpoint brings its own traces and rounding state
+    if (!g_snn_state.resume) {
+        memset(g_neurons.post_trace, 0, sizeof(g_neurons.post_trace));
+        memset(g_neurons.post_step, 0, sizeof(g_neurons.post_step));
+        memset(g_stdp.pre_trace, 0, sizeof(g_stdp.pre_trace));
+        memset(g_stdp.pre_step, 0, sizeof(g_stdp.pre_step));
+        g_stdp.rng = 0x9E3779B9u ^ g_snn_state.node_id;
+    }
+    g_stdp.writeback_count = 0;
+    
+    // Positive weight codes are weight * 63.5
+    g_stdp.a_plus = (int32_t)(Z1_STDP_A_PLUS * 63.5f * 256.0f + 0.5f);
+    g_stdp.a_minus = (int32_t)(Z1_STDP_A_MINUS * 63.5f * 256.0f + 0.5f);
+    stdp_fill_decay(g_stdp.pre_decay, Z1_STDP_TAU_PLUS_US);
+    stdp_fill_decay(g_stdp.post_decay, Z1_STDP_TAU_MINUS_US);
+}
+
+/**
+ * Record a spike of a plastic neuron in its post trace
+ */
+static inline void stdp_post_spike(uint16_t i, uint32_t step) {
+    g_neurons.post_trace[i] = stdp_trace_bump(
+        stdp_trace_at(g_neurons.post_trace[i], step - g_neurons.post_step[i], g_stdp.post_decay));
+    g_neurons.post_step[i] = step;
+}
+
+/**
+ * Change the weight of a target entry by dw (Q8 weight codes, rounded stochastically)
+ */
+static z1_synapse_target_t stdp_adjust(z1_synapse_target_t entry, int32_t dw) {
+    int32_t w = z1_synapse_target_get_weight(entry);
+    int32_t step = dw >> 8;
+    if ((int32_t)(stdp_random() & 0xFF) < (dw & 0xFF)) {
+        step++;
+    }
+    
+    int32_t updated = w + step;
+    if (updated < 0) {
+        updated = 0;
+    }
+    if (step > 0 && updated > Z1_STDP_WEIGHT_MAX) {
+        updated = (w > Z1_STDP_WEIGHT_MAX) ? w : Z1_STDP_WEIGHT_MAX;
+    }
+    
+    return (entry & 0xFFFFFF00) | (uint32_t)updated;
+}
+
+/**
+ * Apply the updates a synapse owes, now that its index block is touched
+ *
+ * Potentiation for the target's last spike since the row's previous
+ * delivery (pre trace as it was at that spike) and, for a delivery,
+ * depression by the target's post trace now. Only excitatory synapses
+ * onto plastic neurons learn.
+ *
+ * @param pre true for a spike delivery, false when only settling
+ */
+static z1_synapse_target_t stdp_learn(z1_synapse_target_t entry, uint16_t row, uint32_t step, bool pre) {
+    uint16_t target = z1_synapse_target_get_id(entry);
+    if (target >= g_snn_state.neuron_count || !(g_neurons.flags[target] & Z1_NEURON_FLAG_PLASTIC) ||
+        (z1_synapse_target_get_weight(entry) & 0x80)) {
+        return entry;
+    }
+    
+    int32_t dw = 0;
+    uint32_t post_step = g_neurons.post_step[target];
+    
+    if (g_stdp.pre_trace[row] != 0 && post_step >= g_stdp.pre_step[row]) {
+        uint16_t trace = stdp_trace_at(g_stdp.pre_trace[row], post_step - g_stdp.pre_step[row],
+                                       g_stdp.pre_decay);
+        if (trace != 0) {
+            dw += (g_stdp.a_plus * trace) >> 12;
+            g_stdp.potentiations++;
+        }
+    }
+    
+    if (pre && g_neurons.post_trace[target] != 0) {
+        uint16_t trace = stdp_trace_at(g_neurons.post_trace[target], step - post_step, g_stdp.post_decay);
+        if (trace != 0) {
+            dw -= (g_stdp.a_minus * trace) >> 12;
+            g_stdp.depressions++;
+        }
+    }
+    
+    return (dw != 0) ? stdp_adjust(entry, dw) : entry;
+}
+
+/**
+ * Move a row's pre trace to a step, adding a spike if it was delivered
+ */
+static void stdp_row_advance(uint16_t row, uint32_t step, bool delivered) {
+    uint16_t trace = stdp_trace_at(g_stdp.pre_trace[row], step - g_stdp.pre_step[row], g_stdp.pre_decay);
+    g_stdp.pre_trace[row] = delivered ? stdp_trace_bump(trace) : trace;
+    g_stdp.pre_step[row] = step;
+}
+
+/**
+ * Write the held learned blocks back to the synapse index
+ */
+static void stdp_flush_writeback(void) {
+    if (g_stdp.writeback_count == 0) {
+        return;
+    }
+    
+    for (uint8_t k = 0; k < g_stdp.writeback_count; k++) {
+        const z1_stdp_writeback_t* wb = &g_stdp.writeback[k];
+        if (!z1_synapse_index_write(wb->first, wb->targets, wb->count)) {
+            printf("[SNN] ERROR: Synapse index write-back failed at entry %u\n", (unsigned int)wb->first);
+        }
+    }
+    
+    g_stdp.blocks_written += g_stdp.writeback_count;
+    g_stdp.writeback_batches++;
+    g_stdp.writeback_count = 0;
+}
+
+/**
+ * Hold a learned index block for the batched write-back
+ */
+static void stdp_queue_writeback(uint16_t row, uint32_t first, const z1_synapse_target_t* targets,
+                                 uint16_t count) {
+    if (g_stdp.writeback_count == Z1_STDP_WRITEBACK_BLOCKS) {
+        // Write the batch early; blocks still being fetched land first
+        for (uint8_t k = 0; k < g_fanout.in_flight; k++) {
+            psram_dma_wait(&g_fanout.blocks[(g_fanout.head + k) % Z1_SNN_PREFETCH_DEPTH].dma);
+        }
+        stdp_flush_writeback();
+    }
+    
+    z1_stdp_writeback_t* wb = &g_stdp.writeback[g_stdp.writeback_count++];
+    memcpy(wb->targets, targets, count * sizeof(z1_synapse_target_t));
+    wb->first = first;
+    wb->count = count;
+    g_stdp.dirty_rows[row >> 5] |= 1u << (row & 31);
+    g_stdp.learned_rows[row >> 5] |= 1u << (row & 31);
+}
+
+/**
+ * Apply potentiation still owed by rows not delivered since their targets fired
+ */
+static void stdp_settle(void) {
+    uint32_t step = g_snn_state.steps_completed + 1;
+    z1_synapse_target_t entries[Z1_SNN_FANOUT_CHUNK];
+    uint32_t source_id, first;
+    uint16_t count;
+    
+    for (uint16_t row = 0; z1_synapse_index_get_row(row, &source_id, &first, &count); row++) {
+        if (g_stdp.pre_trace[row] == 0) {
+            continue;
+        }
+        
+        while (count > 0) {
+            uint16_t n = (count < Z1_SNN_FANOUT_CHUNK) ? count : Z1_SNN_FANOUT_CHUNK;
+            if (!z1_synapse_index_read(first, entries, n)) {
+                break;
+            }
+            
+            bool learned = false;
+            for (uint16_t i = 0; i < n; i++) {
+                z1_synapse_target_t entry = stdp_learn(entries[i], row, step, false);
+                learned |= (entry != entries[i]);
+                entries[i] = entry;
+            }
+            if (learned) {
+                stdp_queue_writeback(row, first, entries, n);
+            }
+            
+            first += n;
+            count -= n;
+        }
+        
+        // Spikes up to here are paid for
+        stdp_row_advance(row, step, false);
+    }
+    
+    stdp_flush_writeback();
+}
+
+/**
+ * Copy one learned weight into the synapse it came from in the target's row
+ */
+static bool stdp_sync_synapse(uint16_t target, uint32_t source_id, z1_synapse_target_t entry) {
+    uint8_t weight = z1_synapse_target_get_weight(entry);
+    uint8_t slot = z1_synapse_target_get_slot(entry);
+    uint32_t old;
+    
+    if (slot != Z1_SYNAPSE_TARGET_SLOT_NONE) {
+        return z1_psram_write_synapse_weights(target, slot, &weight, 1, &old) == 1;
+    }
+    
+    // No slot past 62: the first synapse with this source and delay
+    uint32_t synapses[Z1_NEURON_SYNAPSE_CAPACITY];
+    int count;
+    for (uint16_t start = Z1_SYNAPSE_TARGET_SLOT_NONE; ; start += count) {
+        count = z1_psram_read_neuron_synapses(target, start, synapses, Z1_NEURON_SYNAPSE_CAPACITY);
+        if (count <= 0) {
+            return false;
+        }
+        
+        for (int s = 0; s < count; s++) {
+            if (z1_synapse_get_id(synapses[s]) == source_id &&
+                z1_synapse_get_delay(synapses[s]) == z1_synapse_target_get_delay(entry)) {
+                return z1_psram_write_synapse_weights(target, start + s, &weight, 1, &old) == 1;
+            }
+        }
+        
+        if (count < Z1_NEURON_SYNAPSE_CAPACITY) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Bring the neuron table up to date with the weights learned in the index
+ */
+static void stdp_sync_table(void) {
+    z1_synapse_target_t entries[Z1_SNN_FANOUT_CHUNK];
+    uint32_t source_id, first;
+    uint16_t count;
+    uint16_t rows = 0;
+    uint32_t failed = 0;
+    
+    for (uint16_t row = 0; z1_synapse_index_get_row(row, &source_id, &first, &count); row++) {
+        if (!(g_stdp.dirty_rows[row >> 5] & (1u << (row & 31)))) {
+            continue;
+        }
+        
+        while (count > 0) {
+            uint16_t n = (count < Z1_SNN_FANOUT_CHUNK) ? count : Z1_SNN_FANOUT_CHUNK;
+            if (!z1_synapse_index_read(first, entries, n)) {
+                failed += count;
+                break;
+            }
+            
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t target = z1_synapse_target_get_id(entries[i]);
+                if (target >= g_snn_state.neuron_count ||
+                    !(g_neurons.flags[target] & Z1_NEURON_FLAG_PLASTIC)) {
+                    continue;
+                }
+                
+                // A cached copy would otherwise bring the old weight back
+                z1_neuron_cache_invalidate(target);
+                if (!stdp_sync_synapse(target, source_id, entries[i])) {
+                    failed++;
+                }
+            }
+            
+            first += n;
+            count -= n;
+        }
+        rows++;
+    }
+    
+    memset(g_stdp.dirty_rows, 0, sizeof(g_stdp.dirty_rows));
+    
+    if (rows > 0) {
+        printf("[SNN] STDP: %d learned rows written to the neuron table", rows);
+        if (failed > 0) {
+            printf(" (%u synapses not found)", (unsigned int)failed);
+        }
+        printf("\n");
+    }
+}
+
+// ============================================================================
+// Batch Runs
+// ============================================================================
+
+/**
+ * Put the network back at rest for the next batch sample
+ *
+ * Only SRAM state is cleared: the table, the synapse index and learned
+ * weights stay. Spikes still queued belong to the finished sample.
+ */
+static void batch_reset_state(void) {
+    uint16_t n = g_snn_state.neuron_count;
+    memset(g_neurons.membrane_potential, 0, n * sizeof(g_neurons.membrane_potential[0]));
+    memset(g_neurons.refractory_until_us, 0, n * sizeof(g_neurons.refractory_until_us[0]));
+    memset(g_active_bits, 0, sizeof(g_active_bits));
+    if (g_stdp.enabled) {
+        memset(g_neurons.post_trace, 0, n * sizeof(g_neurons.post_trace[0]));
+        memset(g_neurons.post_step, 0, n * sizeof(g_neurons.post_step[0]));
+        memset(g_stdp.pre_trace, 0, sizeof(g_stdp.pre_trace));
+        memset(g_stdp.pre_step, 0, sizeof(g_stdp.pre_step));
+    }
+    g_wta_candidate_count = 0;
+    
+    // Hand back the credit of dropped remote spikes
+    z1_spike_event_internal_t spike;
+    while (spike_queue_pop(&spike)) {
+        z1_spike_batch_consumed(spike.global_neuron_id);
+    }
+    z1_spike_wheel_init();
+    
+    g_batch.held_count = 0;
+    memset(g_batch.counts, 0, sizeof(g_batch.counts));
+}
+
+/**
+ * Count a spike of an output neuron for the current batch sample
+ */
+static void batch_count_spike(uint16_t i) {
+    uint16_t lo = 0;
+    uint16_t hi = g_batch.output_count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (g_batch.outputs[mid] < i) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < g_batch.output_count && g_batch.outputs[lo] == i && g_batch.counts[lo] < 0xFFFF) {
+        g_batch.counts[lo]++;
+    }
+}
+
+/**
+ * Write the counts of the finished sample and move on to the next one
+ */
+static void batch_finish_sample(uint32_t current_time_us) {
+    uint16_t outputs = g_batch.output_count;
+    uint32_t counts_addr = g_batch.results_addr + sizeof(z1_snn_batch_results_t) +
+                           outputs * sizeof(z1_snn_batch_output_t) +
+                           (uint32_t)g_batch.sample * outputs * sizeof(uint16_t);
+    z1_snn_batch_results_t results;
+    bool ok = psram_write(counts_addr, g_batch.counts, outputs * sizeof(uint16_t)) &&
+              psram_read(g_batch.results_addr, &results, sizeof(results));
+    if (ok) {
+        results.sample_count = g_batch.sample + 1;
+        ok = psram_write(g_batch.results_addr, &results, sizeof(results));
+    }
+    if (!ok) {
+        g_batch.status = Z1_SNN_BATCH_STATUS_FAILED;
+    }
+    g_batch.samples_done = g_batch.sample + 1;
+    
+    if (g_batch.samples_done < g_batch.header.sample_count) {
+        g_batch.sample++;
+        g_batch.sample_start_us = current_time_us + g_snn_state.timestep_us;
+        batch_reset_state();
+    }
+}
+
+// ============================================================================
+// Spike Delivery
+// ============================================================================
+
+/**
+ * Take a popped spike for delivery in this step
+ *
+ * @return false if the spike was requeued for a later step
+ */
+static bool take_spike(const z1_spike_event_internal_t* spike) {
+    // Requeued behind this step's window, seen again next step
+    if (g_sync.enabled && spike_too_early(spike)) {
+        spike_queue_push(spike->global_neuron_id, spike->timestamp_us, spike->flags);
+        g_sync.deferred++;
+        return false;
+    }
+    g_snn_state.spikes_processed++;
+    z1_spike_batch_consumed(spike->global_neuron_id);
+    return true;
+}
+
+/**
+ * Apply index target entries to their local targets
+ *
+ * Shared by both delivery backends and inlined into each, so the loop is
+ * compiled once for SRAM rows and once for fetched blocks.
+ *
+ * @param targets Entries; learned weights are written into them
+ * @param count Number of entries
+ * @param row Directory row of the source
+ * @param first Index entry of targets[0]
+ * @param row_end Last entries of the row
+ */
+static inline __attribute__((always_inline)) void apply_targets(z1_synapse_target_t* targets,
+                                                                uint16_t count, uint16_t row,
+                                                                uint32_t first, bool row_end) {
+    uint32_t step = g_snn_state.steps_completed + 1;
+    bool learned = false;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        // Plastic synapses catch up on their updates before they deliver
+        if (g_stdp.enabled) {
+            z1_synapse_target_t entry = stdp_learn(targets[i], row, step, true);
+            learned |= (entry != targets[i]);
+            targets[i] = entry;
+        }
+        
+        uint16_t target = z1_synapse_target_get_id(targets[i]);
+        uint8_t weight = z1_synapse_target_get_weight(targets[i]);
+        uint8_t delay = z1_synapse_target_get_delay(targets[i]);
+        
+        // Delayed synapses go on the wheel; if it is full, deliver now
+        // rather than lose the input
+        if (delay > 0 && z1_spike_wheel_schedule(delay, target, weight)) {
+            continue;
+        }
+        
+        if (target < g_snn_state.neuron_count) {
+            activate_neuron(target);
+            g_neurons.membrane_potential[target] =
+                potential_add_weight(g_neurons.membrane_potential[target], weight);
+        }
+    }
+    
+    g_snn_state.synapse_events += count;
+    
+    if (learned) {
+        stdp_queue_writeback(row, first, targets, count);
+    }
+    if (g_stdp.enabled && row_end) {
+        stdp_row_advance(row, step, true);
+    }
+}
+
+// ============================================================================
+// Streaming Backend
+// ============================================================================
+
+/**
+ * Start fetching the next fan-out block of the queued spikes
+ *
+ * Walks the spike queue and each source's index row in order, one chunk
+ * per call. Returns false when there is nothing left to fetch.
+ */
+static bool fanout_issue_next(void) {
+    // Move to the next queued spike that has local targets
+    while (g_fanout.row_count == 0) {
+        z1_spike_event_internal_t spike;
+        if (g_fanout.spikes_left == 0 || !spike_queue_pop(&spike)) {
+            return false;
+        }
+        g_fanout.spikes_left--;
+        if (!take_spike(&spike)) {
+            continue;
+        }
+        
+        g_fanout.source_id = spike.global_neuron_id;
+        if (!z1_synapse_index_find(spike.global_neuron_id, &g_fanout.row, &g_fanout.row_first,
+                                   &g_fanout.row_count)) {
+            g_fanout.row_count = 0;  // No local targets
+        }
+    }
+    
+    uint8_t slot = (g_fanout.head + g_fanout.in_flight) % Z1_SNN_PREFETCH_DEPTH;
+    z1_fanout_block_t* block = &g_fanout.blocks[slot];
+    uint16_t n = (g_fanout.row_count < Z1_SNN_FANOUT_CHUNK) ? g_fanout.row_count : Z1_SNN_FANOUT_CHUNK;
+    
+    block->source_id = g_fanout.source_id;
+    block->count = n;
+    block->first = g_fanout.row_first;
+    block->row = g_fanout.row;
+    if (!z1_synapse_index_read_async(g_fanout.row_first, block->targets, n, &block->dma)) {
+        printf("[SNN] ERROR: Synapse index read failed (source 0x%06X)\n",
+               (unsigned int)g_fanout.source_id);
+        block->count = 0;
+        g_fanout.row_count = 0;  // Skip the rest of this row
+    } else {
+        g_fanout.row_first += n;
+        g_fanout.row_count -= n;
+    }
+    block->row_end = (g_fanout.row_count == 0);
+    
+    g_fanout.in_flight++;
+    g_snn_state.fanout_blocks++;
+    return true;
+}
+
+/**
+ * Deliver queued source spikes to their local targets via the synapse index
+ *
+ * Index rows are fetched block by block with DMA, keeping up to
+ * Z1_SNN_PREFETCH_DEPTH - 1 blocks in flight while one is applied.
+ *
+ * @param count Number of queued spikes to deliver
+ */
+static void deliver_spikes_streaming(uint16_t count) {
+    g_fanout.head = 0;
+    g_fanout.in_flight = 0;
+    g_fanout.spikes_left = count;
+    g_fanout.row_count = 0;
+    
+    // Fill the pipeline
+    while (g_fanout.in_flight < Z1_SNN_PREFETCH_DEPTH && fanout_issue_next()) {
+    }
+    
+    while (g_fanout.in_flight > 0) {
+        z1_fanout_block_t* block = &g_fanout.blocks[g_fanout.head];
+        if (psram_dma_busy(&block->dma)) {
+            uint32_t stall_start = z1_snn_profile_now();
+            g_snn_state.fanout_stalls++;
+            psram_dma_wait(&block->dma);
+            g_step_stall_ticks += z1_snn_profile_now() - stall_start;
+        }
+        
+        apply_targets(block->targets, block->count, block->row, block->first, block->row_end);
+        
+        g_fanout.head = (g_fanout.head + 1) % Z1_SNN_PREFETCH_DEPTH;
+        g_fanout.in_flight--;
+        fanout_issue_next();
+    }
+}
+
+// ============================================================================
+// Resident Backend
+// ============================================================================
+
+/**
+ * Deliver queued source spikes from the SRAM copy of the synapse index
+ *
+ * Rows are applied where they lie, in the block size of the streaming
+ * backend so learned blocks are written back the same way.
+ *
+ * @param count Number of queued spikes to deliver
+ */
+static void deliver_spikes_resident(uint16_t count) {
+    z1_synapse_target_t* entries = z1_synapse_index_resident();
+    
+    for (uint16_t k = 0; k < count; k++) {
+        z1_spike_event_internal_t spike;
+        if (!spike_queue_pop(&spike)) {
+            break;
+        }
+        if (!take_spike(&spike)) {
+            continue;
+        }
+        
+        uint16_t row;
+        uint32_t first;
+        uint16_t left;
+        if (!z1_synapse_index_find(spike.global_neuron_id, &row, &first, &left)) {
+            continue;  // No local targets
+        }
+        
+        while (left > 0) {
+            uint16_t n = (left < Z1_SNN_FANOUT_CHUNK) ? left : Z1_SNN_FANOUT_CHUNK;
+            left -= n;
+            apply_targets(&entries[first], n, row, first, left == 0);
+            first += n;
+        }
+    }
+}
+
+/**
+ * Name of a delivery backend for logs
+ */
+static const char* backend_name(uint8_t backend) {
+    return (backend == Z1_SNN_BACKEND_RESIDENT) ? "resident" : "streaming";
+}
+
+// ============================================================================
+// SNN Engine Functions
+// ============================================================================
+
+/**
+ * Initialize SNN engine
+ */
+bool z1_snn_engine_init(uint8_t node_id) {
+    if (g_snn_state.initialized) {
+        printf("[SNN] Already initialized\n");
+        return true;
+    }
+    
+    printf("[SNN] Initializing engine for node %d\n", node_id);
+    
+    // Initialize state
+    memset(&g_snn_state, 0, sizeof(g_snn_state));
+    g_snn_state.node_id = node_id;
+    g_snn_state.timestep_us = Z1_SNN_TIMESTEP_US;
+    
+    // Size the PSRAM regions for the detected part
+    if (!z1_psram_layout_init(psram_get_size(), Z1_SNN_V2_MAX_NEURONS)) {
+        printf("[SNN] ERROR: No PSRAM layout for this part\n");
+        return false;
+    }
+    const z1_psram_layout_t* layout = z1_psram_layout_get();
+    
+    // Initialize PSRAM neuron table
+    if (!z1_psram_neuron_table_init(layout->table_addr, layout->table_size, layout->max_neurons)) {
+        printf("[SNN] ERROR: Failed to initialize PSRAM neuron table\n");
+        return false;
+    }
+    
+    // Initialize neuron cache
+    z1_neuron_cache_init();
+    
+    // Initialize spike queue, overflowing into the PSRAM spill region
+    memset(&g_spike_queue, 0, sizeof(g_spike_queue));
+    memset(&g_spill, 0, sizeof(g_spill));
+    g_spill.base = layout->spill_addr;
+    g_spill.capacity = layout->spill_size / sizeof(z1_spike_event_internal_t);
+    
+#ifdef Z1_SNN_FIXED_POINT
+    for (uint16_t w = 0; w < 256; w++) {
+        g_weight_lut[w] = z1_q16_decode_weight((uint8_t)w);
+    }
+#endif
+    
+    // Initialize outbound spike batching
+    z1_spike_batch_init(node_id, g_snn_state.timestep_us);
+    
+    // Initialize delay wheel
+    z1_spike_wheel_init();
+    
+    // Output spike raster in the PSRAM raster region
+    z1_spike_recorder_init(layout->raster_addr, layout->raster_size);
+    
+#ifdef Z1_NODE_DUAL_CORE
+    z1_spike_ring_init(&g_ingress_ring);
+    z1_spike_ring_init(&g_egress_ring);
+#endif
+    
+    g_snn_state.initialized = true;
+    
+    printf("[SNN] Engine initialized successfully\n");
+    printf("[SNN] RAM usage: ~%u KB state arrays + %u KB queue (%u more spikes in PSRAM)\n",
+           (unsigned int)(sizeof(g_neurons) / 1024), (unsigned int)(sizeof(g_spike_queue) / 1024),
+           (unsigned int)g_spill.capacity);
+    printf("[SNN] PSRAM capacity: %d neurons (%u KB table)\n",
+           layout->max_neurons, (unsigned int)(layout->table_size / 1024));
+    z1_psram_layout_print();
+#ifdef Z1_SNN_FIXED_POINT
+    printf("[SNN] Arithmetic: Q16.16 fixed point\n");
+#endif
+    
+    return true;
+}
+
+/**
+ * Load neuron network from PSRAM
+ */
+bool z1_snn_engine_load_network(uint32_t table_addr, uint16_t neuron_count) {
+    if (!g_snn_state.initialized) {
+        printf("[SNN] ERROR: Engine not initialized\n");
+        return false;
+    }
+    
+    if (g_snn_state.running) {
+        printf("[SNN] ERROR: Cannot load network while running\n");
+        return false;
+    }
+    
+    if (neuron_count > z1_psram_layout_get()->max_neurons) {
+        printf("[SNN] ERROR: Neuron count %d exceeds max %d\n",
+               neuron_count, z1_psram_layout_get()->max_neurons);
+        return false;
+    }
+    
+    printf("[SNN] Loading network: %d neurons from PSRAM 0x%08X\n",
+           neuron_count, (unsigned int)table_addr);
+    
+    // Load neuron table from PSRAM
+    if (!z1_psram_load_neuron_table(table_addr, neuron_count)) {
+        printf("[SNN] ERROR: Failed to load neuron table\n");
+        return false;
+    }
+    
+    // Build inverted index in its own region
+    z1_psram_neuron_table_t table;
+    z1_psram_get_table_info(&table);
+    neuron_count = table.neuron_count;  // A v2 header is authoritative
+    const z1_psram_layout_t* layout = z1_psram_layout_get();
+    uint32_t index_addr = layout->index_addr;
+    uint32_t index_capacity = layout->index_size / Z1_SYNAPSE_INDEX_ENTRY_SIZE;
+    
+    if (!z1_synapse_index_build(index_addr, index_capacity, neuron_count)) {
+        printf("[SNN] ERROR: Failed to build synapse index\n");
+        return false;
+    }
+    
+    // Indexes that fit the SRAM copy are delivered in place; larger ones stream
+    g_snn_state.backend = z1_synapse_index_make_resident() ? Z1_SNN_BACKEND_RESIDENT
+                                                           : Z1_SNN_BACKEND_STREAMING;
+    
+    // Pull per-neuron state into the SRAM arrays (synapses stay in PSRAM)
+    uint16_t group_members = 0;
+    uint16_t group_dropped = 0;
+    g_group_count = 0;
+    for (uint16_t i = 0; i < neuron_count; i++) {
+        if (!z1_psram_read_neuron_params(i, &g_load_scratch)) {
+            printf("[SNN] ERROR: Failed to read neuron %d\n", i);
+            return false;
+        }
+        
+        g_neurons.membrane_potential[i] = potential_from_float(g_load_scratch.membrane_potential);
+        g_neurons.threshold[i] = potential_from_float(g_load_scratch.threshold);
+        g_neurons.leak_factor[i] = potential_from_float(1.0f - g_load_scratch.leak_rate);
+        g_neurons.refractory_until_us[i] = 0;
+        g_neurons.flags[i] = g_load_scratch.flags;
+        g_neurons.refractory_period_us[i] = g_load_scratch.refractory_period_us;
+        g_neurons.last_spike_time_us[i] = g_load_scratch.last_spike_time_us;
+        g_neurons.fanout_mask[i] = g_load_scratch.fanout_mask;
+        g_neurons.group[i] = group_slot_for(&g_load_scratch, &group_members, &group_dropped);
+    }
+    
+    g_snn_state.neuron_count = neuron_count;
+    group_build_members();
+    if (g_group_count > 0) {
+        printf("[SNN] Inhibition groups: %d (%d members)\n", g_group_count, group_members);
+    }
+    if (group_dropped > 0) {
+        printf("[SNN] WARNING: %d neurons left out of inhibition groups (max %d groups, %d members)\n",
+               group_dropped, Z1_SNN_MAX_GROUPS, Z1_SNN_GROUP_MEMBERS);
+    }
+    
+    // Cache only serves cold-path accesses now; drop any stale entries
+    z1_neuron_cache_clear();
+    
+    // Index was just built from the table, so nothing is left to sync
+    memset(g_stdp.dirty_rows, 0, sizeof(g_stdp.dirty_rows));
+    memset(g_stdp.learned_rows, 0, sizeof(g_stdp.learned_rows));
+    g_snn_state.resume = false;
+    stdp_reset();
+    
+    // A staged batch was checked against the previous table
+    g_batch.enabled = false;
+    g_batch.status = Z1_SNN_BATCH_STATUS_NONE;
+    g_batch.results_addr = 0;
+    
+    printf("[SNN] Network loaded: %d neurons, %s delivery%s\n", neuron_count,
+           backend_name(g_snn_state.backend), g_stdp.enabled ? " (STDP enabled)" : "");
+    
+    return true;
+}
+
+/**
+ * Start SNN execution
+ */
+bool z1_snn_engine_start(void) {
+    if (!g_snn_state.initialized) {
+        printf("[SNN] ERROR: Engine not initialized\n");
+        return false;
+    }
+    
+    if (g_snn_state.neuron_count == 0) {
+        printf("[SNN] ERROR: No network loaded\n");
+        return false;
+    }
+    
+    // Drop deliveries left over from a previous run
+    spike_queue_reset();
+    z1_spike_wheel_init();
+    reset_active_set();
+    stdp_reset();
+    z1_snn_profile_init();
+    
+    // Record output neurons only when the table marks any
+    bool output_only = false;
+#ifndef Z1_SPIKE_REC_ALL
+    for (uint16_t i = 0; i < g_snn_state.neuron_count && !output_only; i++) {
+        output_only = (g_neurons.flags[i] & Z1_NEURON_FLAG_OUTPUT) != 0;
+    }
+#endif
+    z1_spike_recorder_reset(output_only);
+    
+    // Barrier runs use logical time from zero
+    g_sync.released = 0;
+    g_sync.flushed = 0;
+    g_sync.reported = 0;
+    g_sync.repeat = false;
+    g_sync.deferred = 0;
+    if (g_batch.enabled) {
+        g_snn_state.resume = false;
+    }
+    if ((g_sync.enabled || g_batch.enabled) && !g_snn_state.resume) {
+        memset(g_neurons.refractory_until_us, 0, sizeof(g_neurons.refractory_until_us));
+    }
+    
+    // Batch runs start every sample from rest, the first one included
+    if (g_batch.enabled) {
+        g_batch.sample = 0;
+        g_batch.samples_done = 0;
+        g_batch.held_dropped = 0;
+        g_batch.next_input = 0;
+        g_batch.buf_pos = 0;
+        g_batch.buf_fill = 0;
+        g_batch.sample_start_us = g_snn_state.timestep_us;
+        batch_reset_state();
+    }
+    
+    // Free-running nodes pace each other with spike credit; the barrier
+    // already bounds what is in flight
+    z1_spike_batch_start(!g_sync.enabled);
+    
+    g_snn_state.running = true;
+    g_snn_state.current_time_us = 0;
+    
+    printf("[SNN] Started: %d neurons, timestep=%u us%s\n",
+           g_snn_state.neuron_count, (unsigned int)g_snn_state.timestep_us,
+           g_sync.enabled ? ", stepping on controller ticks" : "");
+    if (g_batch.enabled) {
+        printf("[SNN] Batch: %d samples x %d steps\n",
+               g_batch.header.sample_count, g_batch.header.steps_per_sample);
+    }
+    
+    return true;
+}
+
+/**
+ * Stop SNN execution
+ */
+void z1_snn_engine_stop(void) {
+    g_snn_state.running = false;
+    
+#ifdef Z1_NODE_DUAL_CORE
+    // Let a step in progress on core1 finish before touching state
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (g_snn_state.stepping) {
+    }
+#endif
+    
+    // Flush all dirty cache entries to PSRAM
+    uint32_t flush_start = z1_snn_profile_now();
+    z1_neuron_cache_flush_all();
+    
+    // Write mutable neuron state back into the PSRAM table
+    settle_inactive_neurons();
+    for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
+        z1_psram_write_neuron_state(i, potential_to_float(g_neurons.membrane_potential[i]),
+                                    g_neurons.last_spike_time_us[i]);
+    }
+    
+    // Owed potentiation, then learned weights into the neuron table
+    if (g_stdp.enabled) {
+        stdp_settle();
+        stdp_sync_table();
+    }
+    z1_snn_profile_record(Z1_SNN_PHASE_FLUSH, z1_snn_profile_now() - flush_start);
+    
+    printf("[SNN] Stopped\n");
+    z1_neuron_cache_print_stats();
+}
+
+/**
+ * Check if engine is running
+ */
+bool z1_snn_engine_is_running(void) {
+    return g_snn_state.running;
+}
+
+/**
+ * Send spike of a local neuron to the nodes that host its targets
+ */
+static void route_spike_remote(uint16_t local_id, uint32_t timestamp_us) {
+    // Tables from older compilers carry no destination mask
+    if (!(g_neurons.flags[local_id] & Z1_NEURON_FLAG_ROUTED)) {
+        static bool warned = false;
+        if (!warned) {
+            printf("[SNN] WARNING: Neuron table has no routing info, inter-node spikes disabled\n");
+            warned = true;
+        }
+        return;
+    }
+    
+    uint16_t mask = g_neurons.fanout_mask[local_id] & ~(1u << g_snn_state.node_id);
+    bool gateway = (g_neurons.flags[local_id] & Z1_NEURON_FLAG_GATEWAY) != 0;
+    if (mask == 0 && !gateway) {
+        return;
+    }
+    
+#ifdef Z1_NODE_DUAL_CORE
+    // Bus belongs to core0; hand the spike over
+    z1_ring_spike_t rec = {
+        .neuron_id = local_id,
+        .timestamp_us = timestamp_us,
+        .dest_mask = mask,
+        .type = Z1_RING_ROUTE,
+    };
+    if (mask != 0) {
+        z1_spike_ring_push(&g_egress_ring, &rec);
+    }
+    if (gateway) {
+        rec.type = Z1_RING_GATEWAY;
+        z1_spike_ring_push(&g_egress_ring, &rec);
+    }
+#else
+    // Coalesced per destination, sent at the end of the step
+    z1_spike_batch_add(mask, local_id, timestamp_us);
+    if (gateway) {
+        z1_spike_batch_add_gateway(local_id, timestamp_us);
+    }
+#endif
+}
+
+/**
+ * Emit a neuron's spike (reset is left to the caller)
+ */
+static void fire_neuron(uint16_t i, uint32_t current_time_us) {
+    g_neurons.last_spike_time_us[i] = current_time_us;
+    g_neurons.refractory_until_us[i] = current_time_us + g_neurons.refractory_period_us[i];
+    
+    g_snn_state.spikes_generated++;
+    z1_spike_recorder_add(i, g_neurons.flags[i], g_snn_state.steps_completed + 1);
+    if (g_neurons.flags[i] & Z1_NEURON_FLAG_PLASTIC) {
+        stdp_post_spike(i, g_snn_state.steps_completed + 1);
+    }
+    if (g_neurons.group[i] != 0) {
+        g_groups[g_neurons.group[i] - 1].fired++;
+    }
+    if (g_batch.enabled && (g_neurons.flags[i] & Z1_NEURON_FLAG_OUTPUT)) {
+        batch_count_spike(i);
+    }
+    
+    // Local targets see the spike on the next timestep via the queue
+    uint32_t global_id = ((uint32_t)g_snn_state.node_id << 16) | i;
+    spike_queue_push(global_id, current_time_us, 0);
+    
+    // Remote targets
+    route_spike_remote(i, current_time_us);
+}
+
+/**
+ * Process single neuron (apply leak, check threshold)
+ */
+static void process_neuron(uint16_t i, uint32_t current_time_us) {
+    // Check refractory period
+    if (current_time_us < g_neurons.refractory_until_us[i]) {
+        return;  // Still in refractory period
+    }
+    
+    z1_potential_t v = g_neurons.membrane_potential[i];
+    
+    // Apply membrane leak
+    if (v > Z1_POTENTIAL_ZERO) {
+        v = potential_decay(v, g_neurons.leak_factor[i]);
+        
+        // Clamp to zero if very small
+        if (v < Z1_POTENTIAL_EPSILON) {
+            v = Z1_POTENTIAL_ZERO;
+        }
+    }
+    
+    // Check for spike
+    if (v >= g_neurons.threshold[i]) {
+        uint8_t group = g_neurons.group[i];
+        if (group != 0 && g_groups[group - 1].k != 0) {
+            // k-WTA: the group picks its winners once the sweep is done
+            if (g_wta_candidate_count < Z1_SNN_WTA_CANDIDATES) {
+                g_wta_candidates[g_wta_candidate_count++] = i;
+                g_neurons.membrane_potential[i] = v;
+                return;
+            }
+            g_group_clamped++;
+        } else {
+            fire_neuron(i, current_time_us);
+        }
+        v = Z1_POTENTIAL_ZERO;  // Reset
+    }
+    
+    g_neurons.membrane_potential[i] = v;
+}
+
+/**
+ * Pick k-WTA winners and inhibit the other members of groups that fired
+ *
+ * Runs after the sweep of a step, so inhibited members are brought up to
+ * date through that step before they join the next step's active set.
+ */
+static void resolve_groups(uint32_t current_time_us, uint32_t step) {
+    // Highest potential first; insertion sort keeps ties in ID order
+    for (uint16_t c = 1; c < g_wta_candidate_count; c++) {
+        uint16_t id = g_wta_candidates[c];
+        z1_potential_t v = g_neurons.membrane_potential[id];
+        uint16_t j = c;
+        while (j > 0 && g_neurons.membrane_potential[g_wta_candidates[j - 1]] < v) {
+            g_wta_candidates[j] = g_wta_candidates[j - 1];
+            j--;
+        }
+        g_wta_candidates[j] = id;
+    }
+    
+    // Up to k winners per group fire; the losers are clamped to rest
+    for (uint16_t c = 0; c < g_wta_candidate_count; c++) {
+        uint16_t id = g_wta_candidates[c];
+        z1_inhibit_group_t* group = &g_groups[g_neurons.group[id] - 1];
+        if (group->fired < group->k) {
+            fire_neuron(id, current_time_us);
+        } else {
+            g_group_clamped++;
+        }
+        g_neurons.membrane_potential[id] = Z1_POTENTIAL_ZERO;
+    }
+    g_wta_candidate_count = 0;
+    
+    // One pass over the members of each group with spikes this step
+    for (uint8_t g = 0; g < g_group_count; g++) {
+        z1_inhibit_group_t* group = &g_groups[g];
+        if (group->fired == 0) {
+            continue;
+        }
+        
+        for (uint16_t m = 0; m < group->count; m++) {
+            uint16_t id = g_group_members[group->first + m];
+            uint16_t others = group->fired;
+            if (g_neurons.last_spike_time_us[id] == current_time_us) {
+                others--;  // Fired itself this step
+            }
+            if (others > 0 && group->inhibition != Z1_POTENTIAL_ZERO) {
+                if (!(g_active_bits[id >> 5] & (1u << (id & 31)))) {
+                    catch_up_leak(id, step);
+                    g_active_bits[id >> 5] |= 1u << (id & 31);
+                }
+                g_neurons.membrane_potential[id] =
+                    potential_add(g_neurons.membrane_potential[id], group->inhibition * others);
+            }
+        }
+        group->fired = 0;
+    }
+}
+
+/**
+ * Add input batch values to their neurons (stepping core)
+ */
+static void apply_inputs(const z1_input_spike_t* entries, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        z1_input_spike_t in = entries[i];
+        if (in.local_id >= g_snn_state.neuron_count) {
+            continue;
+        }
+        activate_neuron(in.local_id);
+        g_neurons.membrane_potential[in.local_id] =
+            potential_add(g_neurons.membrane_potential[in.local_id],
+                          potential_from_float((float)in.value / Z1_INPUT_VALUE_ONE));
+        g_snn_state.spikes_received++;
+    }
+}
+
+/**
+ * Get the next staged batch input without taking it
+ */
+static bool batch_peek_input(z1_snn_batch_input_t* in) {
+    if (g_batch.buf_pos == g_batch.buf_fill) {
+        uint32_t left = g_batch.header.input_count - g_batch.next_input;
+        if (left == 0) {
+            return false;
+        }
+        uint16_t n = (left < Z1_SNN_BATCH_INPUT_CHUNK) ? (uint16_t)left : Z1_SNN_BATCH_INPUT_CHUNK;
+        uint32_t addr = g_batch.addr + sizeof(z1_snn_batch_header_t) +
+                        g_batch.next_input * sizeof(z1_snn_batch_input_t);
+        if (!psram_read(addr, g_batch.buffer, n * sizeof(z1_snn_batch_input_t))) {
+            g_batch.status = Z1_SNN_BATCH_STATUS_FAILED;
+            g_batch.next_input = g_batch.header.input_count;
+            return false;
+        }
+        g_batch.buf_pos = 0;
+        g_batch.buf_fill = n;
+    }
+    *in = g_batch.buffer[g_batch.buf_pos];
+    return true;
+}
+
+/**
+ * Add the staged inputs of the current sample that fall due this step
+ */
+static void batch_apply_inputs(void) {
+    uint32_t step = g_snn_state.steps_completed - (uint32_t)g_batch.sample * g_batch.header.steps_per_sample;
+    z1_input_spike_t due[Z1_SNN_BATCH_INPUT_CHUNK];
+    uint16_t count = 0;
+    
+    // Inputs held from earlier steps first; new ones join the list below
+    apply_inputs(g_batch.held, g_batch.held_count);
+    
+    z1_snn_batch_input_t in;
+    while (batch_peek_input(&in)) {
+        if (in.sample > g_batch.sample ||
+            (in.sample == g_batch.sample && (in.step & ~Z1_SNN_BATCH_HOLD) > step)) {
+            break;
+        }
+        g_batch.buf_pos++;
+        g_batch.next_input++;
+        
+        z1_input_spike_t entry = { .local_id = in.local_id, .value = in.value };
+        if (in.sample < g_batch.sample) {
+            continue;  // Sample ended before its step came
+        }
+        if (in.step & Z1_SNN_BATCH_HOLD) {
+            if (g_batch.held_count < Z1_SNN_BATCH_HELD_MAX) {
+                g_batch.held[g_batch.held_count++] = entry;
+            } else if (g_batch.held_dropped < 0xFFFF) {
+                g_batch.held_dropped++;
+            }
+        }
+        due[count++] = entry;
+        if (count == Z1_SNN_BATCH_INPUT_CHUNK) {
+            apply_inputs(due, count);
+            count = 0;
+        }
+    }
+    apply_inputs(due, count);
+}
+
+/**
+ * Process single timestep
+ */
+void z1_snn_engine_step(uint32_t current_time_us) {
+    g_snn_state.stepping = true;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    
+    if (!g_snn_state.running) {
+        g_snn_state.stepping = false;
+        return;
+    }
+    
+    g_snn_state.current_time_us = current_time_us;
+    bool batching = g_batch.enabled && g_batch.samples_done < g_batch.header.sample_count;
+    
+    // Restored refractory times are left over from the checkpoint; they
+    // count from the step before this one
+    if (g_snn_state.resume) {
+        uint32_t base_us = current_time_us - g_snn_state.timestep_us;
+        for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
+            if (g_neurons.refractory_until_us[i] != 0) {
+                g_neurons.refractory_until_us[i] += base_us;
+            }
+        }
+        g_snn_state.resume = false;
+    }
+    
+    uint32_t step_start = z1_snn_profile_begin_step();
+    uint32_t t = step_start;
+    uint32_t phase_end;
+    
+#ifdef Z1_NODE_DUAL_CORE
+    // Pull spikes and inputs handed over by core0
+    z1_ring_spike_t rec;
+    while (z1_spike_ring_pop(&g_ingress_ring, &rec)) {
+        if (rec.type == Z1_RING_SPIKE) {
+            if (spike_queue_push(rec.neuron_id, rec.timestamp_us, rec.flags)) {
+                g_snn_state.spikes_received++;
+            }
+        } else if (rec.type == Z1_RING_INJECT && rec.neuron_id < g_snn_state.neuron_count) {
+            activate_neuron((uint16_t)rec.neuron_id);
+            g_neurons.membrane_potential[rec.neuron_id] =
+                potential_add(g_neurons.membrane_potential[rec.neuron_id],
+                              potential_from_float(rec.value));
+            g_snn_state.spikes_received++;
+        } else if (rec.type == Z1_RING_INPUT && rec.neuron_id < Z1_SNN_INPUT_SLOTS) {
+            z1_input_slot_t* slot = &g_input_slots[rec.neuron_id];
+            apply_inputs(slot->entries, slot->count);
+            __atomic_store_n(&slot->busy, false, __ATOMIC_RELEASE);
+        }
+    }
+    phase_end = z1_snn_profile_now();
+    z1_snn_profile_record(Z1_SNN_PHASE_INGRESS, phase_end - t);
+    t = phase_end;
+#endif
+    
+    // Deliver pending source spikes (local and remote) to their local targets.
+    // Only spikes queued before this step are drained; spikes generated below
+    // are delivered on the next timestep.
+    g_step_stall_ticks = 0;
+    if (g_snn_state.backend == Z1_SNN_BACKEND_RESIDENT) {
+        deliver_spikes_resident((uint16_t)spike_queue_count());
+    } else {
+        deliver_spikes_streaming((uint16_t)spike_queue_count());
+    }
+    if (batching) {
+        batch_apply_inputs();
+    }
+    
+    // Apply delayed synaptic inputs that fall due this timestep
+    uint16_t target;
+    uint8_t weight;
+    while (z1_spike_wheel_pop(&target, &weight)) {
+        if (target < g_snn_state.neuron_count) {
+            activate_neuron(target);
+            g_neurons.membrane_potential[target] =
+                potential_add_weight(g_neurons.membrane_potential[target], weight);
+        }
+    }
+    
+    // Blocks learned by this step's deliveries go back in one batch
+    stdp_flush_writeback();
+    phase_end = z1_snn_profile_now();
+    z1_snn_profile_record(Z1_SNN_PHASE_DELIVERY, phase_end - t);
+    z1_snn_profile_record(Z1_SNN_PHASE_STALL, g_step_stall_ticks);
+    t = phase_end;
+    
+    // Update active neurons only (ascending ID order, no PSRAM traffic)
+    uint32_t step = g_snn_state.steps_completed + 1;
+    uint16_t visited = 0;
+    for (uint16_t w = 0; w < (g_snn_state.neuron_count + 31) / 32; w++) {
+        uint32_t bits = g_active_bits[w] | g_always_active_bits[w];
+        uint32_t keep = g_always_active_bits[w];
+        
+        while (bits) {
+            uint16_t i = (uint16_t)(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            
+            process_neuron(i, current_time_us);
+            g_neurons.last_update_step[i] = step;
+            visited++;
+            
+            // Refractory neurons skip leak, so they cannot be caught up lazily
+            if (g_neurons.membrane_potential[i] > Z1_POTENTIAL_ZERO &&
+                current_time_us < g_neurons.refractory_until_us[i]) {
+                keep |= 1u << (i & 31);
+            }
+        }
+        
+        g_active_bits[w] = keep;
+    }
+    if (g_group_count > 0) {
+        resolve_groups(current_time_us, step);
+    }
+    g_snn_state.active_neurons = visited;
+    g_snn_state.steps_completed = step;
+    if (batching && step % g_batch.header.steps_per_sample == 0) {
+        batch_finish_sample(current_time_us);
+    }
+    phase_end = z1_snn_profile_now();
+    z1_snn_profile_record(Z1_SNN_PHASE_SWEEP, phase_end - t);
+    t = phase_end;
+    
+#ifndef Z1_NODE_DUAL_CORE
+    // One batch transfer per destination node for this timestep; barrier
+    // mode flushes from z1_snn_engine_service_egress() after STEP_DONE
+    if (!g_sync.enabled) {
+        z1_spike_batch_flush();
+        z1_spike_batch_return_credits();
+        z1_snn_profile_record(Z1_SNN_PHASE_ROUTING, z1_snn_profile_now() - t);
+    }
+#endif
+    
+    z1_spike_recorder_flush();
+    z1_spike_wheel_advance();
+    z1_snn_profile_record(Z1_SNN_PHASE_STEP, z1_snn_profile_now() - step_start);
+    
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    g_snn_state.stepping = false;
+}
+
+/**
+ * Send queued remote spikes (bus-owning core)
+ */
+void z1_snn_engine_service_egress(void) {
+    // Steps finished before the drain have all their spikes queued
+    uint32_t completed = g_snn_state.steps_completed;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    
+#ifdef Z1_NODE_DUAL_CORE
+    uint32_t start = z1_snn_profile_now();
+    bool routed = false;
+    z1_ring_spike_t rec;
+    while (z1_spike_ring_pop(&g_egress_ring, &rec)) {
+        if (rec.type == Z1_RING_ROUTE) {
+            z1_spike_batch_add(rec.dest_mask, (uint16_t)rec.neuron_id, rec.timestamp_us);
+            routed = true;
+        } else if (rec.type == Z1_RING_GATEWAY) {
+            z1_spike_batch_add_gateway((uint16_t)rec.neuron_id, rec.timestamp_us);
+            routed = true;
+        }
+    }
+    z1_spike_batch_flush();
+    z1_spike_batch_return_credits();
+    
+    // Counted on core0; idle passes would swamp the distribution
+    if (routed) {
+        z1_snn_profile_record(Z1_SNN_PHASE_ROUTING, z1_snn_profile_now() - start);
+    }
+#else
+    // Single core: only barrier mode leaves batches for this call
+    if (!g_sync.enabled || g_sync.flushed == completed) {
+        return;
+    }
+    uint32_t start = z1_snn_profile_now();
+    z1_spike_batch_flush();
+    z1_snn_profile_record(Z1_SNN_PHASE_ROUTING, z1_snn_profile_now() - start);
+#endif
+    
+    g_sync.flushed = completed;
+}
+
+// ============================================================================
+// Timestep Barrier
+// ============================================================================
+
+/**
+ * Choose free-running or barrier stepping for the next start
+ */
+void z1_snn_engine_set_sync(bool enabled) {
+    if (!g_snn_state.running) {
+        g_sync.enabled = enabled;
+    }
+}
+
+/**
+ * Check whether the engine steps on controller ticks
+ */
+bool z1_snn_engine_sync_enabled(void) {
+    return g_sync.enabled;
+}
+
+/**
+ * Release a timestep (Z1_CMD_SNN_TICK)
+ */
+void z1_snn_engine_sync_tick(uint8_t step_lo) {
+    if (!g_sync.enabled || !g_snn_state.running) {
+        return;
+    }
+    
+    // The controller ticks step k + 1 only after every node reported k, so
+    // the low byte tells the next step from a repeat
+    uint32_t next = g_sync.released + 1;
+    int8_t ahead = (int8_t)(step_lo - (uint8_t)next);
+    if (ahead == 0) {
+        g_sync.released = next;
+    } else if (ahead < 0) {
+        g_sync.repeat = true;  // Our STEP_DONE did not arrive
+    } else {
+        Z1_TRACE(SNN, Z1_TRACE_ERROR, Z1_EV_SNN_TICK_SKIP, step_lo, next);
+    }
+}
+
+/**
+ * Run the next timestep if it has been released
+ */
+bool z1_snn_engine_sync_step(void) {
+    if (!g_sync.enabled || g_snn_state.steps_completed >= g_sync.released) {
+        return false;
+    }
+    z1_snn_engine_step((g_snn_state.steps_completed + 1) * g_snn_state.timestep_us);
+    return true;
+}
+
+/**
+ * Check whether a STEP_DONE report is due
+ */
+bool z1_snn_engine_sync_poll(uint8_t* step_lo) {
+    if (!g_sync.enabled || !g_snn_state.running) {
+        return false;
+    }
+    
+    // Step k is done once computed and the spikes of k - 1 are sent; the
+    // spikes of k go out while the other nodes compute k + 1
+    uint32_t completed = g_snn_state.steps_completed;
+    if (completed > g_sync.reported && g_sync.flushed + 1 >= completed) {
+        g_sync.reported = completed;
+    } else if (!g_sync.repeat || g_sync.reported == 0) {
+        return false;
+    }
+    
+    g_sync.repeat = false;
+    *step_lo = (uint8_t)g_sync.reported;
+    return true;
+}
+
+/**
+ * Process incoming spike from another node
+ */
+void z1_snn_engine_process_spike(uint32_t global_neuron_id, uint32_t timestamp_us, uint8_t flags) {
+    if (!g_snn_state.running) {
+        return;
+    }
+    
+#ifdef Z1_NODE_DUAL_CORE
+    z1_ring_spike_t rec = {
+        .neuron_id = global_neuron_id & 0xFFFFFF,
+        .timestamp_us = timestamp_us,
+        .type = Z1_RING_SPIKE,
+        .flags = flags,
+    };
+    if (!z1_spike_ring_push(&g_ingress_ring, &rec)) {
+        g_snn_state.spikes_dropped++;
+        z1_spike_batch_consumed(global_neuron_id);
+    }
+#else
+    if (spike_queue_push(global_neuron_id & 0xFFFFFF, timestamp_us, flags)) {
+        g_snn_state.spikes_received++;
+    }
+#endif
+}
+
+/**
+ * Process incoming spike batch (Z1_CMD_SNN_SPIKE_BATCH payload)
+ */
+void z1_snn_engine_process_spike_batch(const uint8_t* data, uint16_t length) {
+    z1_spike_batch_header_t header;
+    
+    if (length < sizeof(header)) {
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+    
+    if (length < sizeof(header) + header.count * sizeof(z1_spike_batch_entry_t)) {
+        printf("[SNN] ERROR: Truncated spike batch (%d entries, %d bytes)\n", header.count, length);
+        return;
+    }
+    
+    const uint8_t* p = data + sizeof(header);
+    uint32_t source_base = (uint32_t)header.source_node << 16;
+    
+    for (uint16_t i = 0; i < header.count; i++, p += sizeof(z1_spike_batch_entry_t)) {
+        z1_spike_batch_entry_t entry;
+        memcpy(&entry, p, sizeof(entry));
+        z1_snn_engine_process_spike(source_base | entry.local_id,
+                                    header.base_timestamp_us + entry.dt_steps * g_snn_state.timestep_us,
+                                    header.flags);
+    }
+}
+
+/**
+ * Inject external spike into neuron
+ */
+void z1_snn_engine_inject_spike(uint16_t local_neuron_id, float value) {
+    if (!g_snn_state.running) {
+        return;
+    }
+    
+    if (local_neuron_id >= g_snn_state.neuron_count) {
+        printf("[SNN] ERROR: Invalid neuron ID %d\n", local_neuron_id);
+        return;
+    }
+    
+#ifdef Z1_NODE_DUAL_CORE
+    z1_ring_spike_t rec = {
+        .neuron_id = local_neuron_id,
+        .value = value,
+        .type = Z1_RING_INJECT,
+    };
+    z1_spike_ring_push(&g_ingress_ring, &rec);
+#else
+    activate_neuron(local_neuron_id);
+    g_neurons.membrane_potential[local_neuron_id] =
+        potential_add(g_neurons.membrane_potential[local_neuron_id], potential_from_float(value));
+    g_snn_state.spikes_received++;
+#endif
+}
+
+/**
+ * Inject a batch of inputs (Z1_CMD_SNN_INPUT_SPIKE payload)
+ */
+void z1_snn_engine_inject_batch(const uint8_t* data, uint16_t length) {
+    if (!g_snn_state.running) {
+        return;
+    }
+    
+    uint16_t count = length / sizeof(z1_input_spike_t);
+    if (count > Z1_INPUT_BATCH_MAX) {
+        count = Z1_INPUT_BATCH_MAX;
+    }
+    
+#ifdef Z1_NODE_DUAL_CORE
+    // Whole batch in a free slot; otherwise entry by entry through the ring
+    for (uint8_t i = 0; i < Z1_SNN_INPUT_SLOTS; i++) {
+        z1_input_slot_t* slot = &g_input_slots[i];
+        if (__atomic_load_n(&slot->busy, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        
+        memcpy(slot->entries, data, count * sizeof(z1_input_spike_t));
+        slot->count = count;
+        slot->busy = true;
+        
+        z1_ring_spike_t rec = { .neuron_id = i, .type = Z1_RING_INPUT };
+        if (!z1_spike_ring_push(&g_ingress_ring, &rec)) {
+            slot->busy = false;
+            break;
+        }
+        return;
+    }
+    
+    for (uint16_t i = 0; i < count; i++) {
+        z1_input_spike_t in;
+        memcpy(&in, data + i * sizeof(in), sizeof(in));
+        z1_snn_engine_inject_spike(in.local_id, (float)in.value / Z1_INPUT_VALUE_ONE);
+    }
+#else
+    apply_inputs((const z1_input_spike_t*)data, count);
+#endif
+}
+
+// ============================================================================
+// Weight Patches
+// ============================================================================
+
+/**
+ * Overwrite a run of one neuron's synapse weights in PSRAM and the index
+ * 
+ * @return Synapses updated
+ */
+static uint16_t patch_row(uint16_t local_id, uint16_t start, const uint8_t* weights, uint16_t count) {
+    if (local_id >= g_snn_state.neuron_count) {
+        return 0;
+    }
+    
+    // A dirty cached copy written back later would undo the patch
+    z1_neuron_cache_invalidate(local_id);
+    
+    uint32_t old[Z1_NEURON_SYNAPSE_CAPACITY];
+    uint16_t applied = 0;
+    while (applied < count) {
+        uint16_t n = count - applied;
+        if (n > Z1_NEURON_SYNAPSE_CAPACITY) {
+            n = Z1_NEURON_SYNAPSE_CAPACITY;
+        }
+        
+        int written = z1_psram_write_synapse_weights(local_id, start + applied, weights + applied, n, old);
+        if (written <= 0) {
+            break;  // Past the end of the row, or PSRAM error
+        }
+        
+        // Delivery reads weights from the index, not the table
+        for (int i = 0; i < written; i++) {
+            if (!z1_synapse_index_set_weight(local_id, start + applied + i, old[i], weights[applied + i])) {
+                printf("[SNN] ERROR: No index entry for neuron %d synapse %d\n",
+                       local_id, start + applied + i);
+            }
+        }
+        
+        applied += written;
+        if (written < n) {
+            break;
+        }
+    }
+    
+    return applied;
+}
+
+/**
+ * Apply a weight patch (Z1_CMD_SNN_WEIGHT_UPDATE payload)
+ */
+bool z1_snn_engine_patch_weights(const uint8_t* data, uint16_t length, z1_weight_patch_result_t* result) {
+    result->applied = 0;
+    result->rejected = 0;
+    bool refuse = g_snn_state.running || g_snn_state.neuron_count == 0;
+    
+    uint16_t offset = 0;
+    while (offset + sizeof(z1_weight_patch_header_t) <= length) {
+        z1_weight_patch_header_t header;
+        memcpy(&header, data + offset, sizeof(header));
+        offset += sizeof(header);
+        
+        if (header.format == Z1_WEIGHT_PATCH_LIST) {
+            if (offset + (uint32_t)header.count * sizeof(z1_weight_update_t) > length) {
+                break;
+            }
+            for (uint16_t i = 0; i < header.count; i++) {
+                z1_weight_update_t entry;
+                memcpy(&entry, data + offset, sizeof(entry));
+                offset += sizeof(entry);
+                
+                if (!refuse && patch_row(entry.local_neuron_id, entry.synapse_idx, &entry.new_weight, 1)) {
+                    result->applied++;
+                } else {
+                    result->rejected++;
+                }
+            }
+        } else if (header.format == Z1_WEIGHT_PATCH_VECTOR) {
+            z1_weight_vector_t vector;
+            if (offset + sizeof(vector) + header.count > length) {
+                break;
+            }
+            memcpy(&vector, data + offset, sizeof(vector));
+            offset += sizeof(vector);
+            
+            uint16_t applied = refuse ? 0 :
+                patch_row(vector.local_id, vector.first_synapse, data + offset, header.count);
+            result->applied += applied;
+            result->rejected += header.count - applied;
+            offset += header.count;
+        } else {
+            break;
+        }
+    }
+    
+    if (refuse && result->rejected > 0) {
+        printf("[SNN] ERROR: Weight patch refused (%s)\n",
+               g_snn_state.running ? "running" : "no network loaded");
+    }
+    
+    return offset == length;
+}
+
+/**
+ * Update a single synapse weight
+ */
+bool z1_snn_engine_update_weight(uint16_t local_neuron_id, uint16_t synapse_idx, uint8_t weight) {
+    if (g_snn_state.running) {
+        return false;
+    }
+    return patch_row(local_neuron_id, synapse_idx, &weight, 1) == 1;
+}
+
+// ============================================================================
+// Checkpoints
+// ============================================================================
+
+#define Z1_SNN_CKPT_BUFFER 256
+
+// Sequential access to an image in PSRAM through one SRAM buffer; writes
+// keep the CRC32 of the bytes written
+typedef struct {
+    uint32_t addr;               // PSRAM address of buffer[0]
+    uint32_t end;                // End of the image
+    uint16_t pos;                // Next byte in buffer
+    uint16_t fill;               // Bytes read into buffer
+    uint32_t crc;
+    bool failed;
+    uint8_t buffer[Z1_SNN_CKPT_BUFFER];
+} z1_ckpt_stream_t;
+
+static z1_ckpt_stream_t g_ckpt;
+
+static void ckpt_open(uint32_t addr, uint32_t end) {
+    g_ckpt.addr = addr;
+    g_ckpt.end = end;
+    g_ckpt.pos = 0;
+    g_ckpt.fill = 0;
+    g_ckpt.crc = 0;
+    g_ckpt.failed = false;
+}
+
+static void ckpt_flush(void) {
+    if (g_ckpt.pos == 0 || g_ckpt.failed) {
+        return;
+    }
+    
+    if (g_ckpt.addr + g_ckpt.pos > g_ckpt.end || !psram_write(g_ckpt.addr, g_ckpt.buffer, g_ckpt.pos)) {
+        g_ckpt.failed = true;
+        return;
+    }
+    g_ckpt.crc = z1_crc32_update(g_ckpt.crc, g_ckpt.buffer, g_ckpt.pos);
+    g_ckpt.addr += g_ckpt.pos;
+    g_ckpt.pos = 0;
+}
+
+static void ckpt_put(const void* data, uint16_t length) {
+    const uint8_t* p = (const uint8_t*)data;
+    
+    while (length > 0 && !g_ckpt.failed) {
+        uint16_t n = Z1_SNN_CKPT_BUFFER - g_ckpt.pos;
+        if (n > length) n = length;
+        memcpy(g_ckpt.buffer + g_ckpt.pos, p, n);
+        g_ckpt.pos += n;
+        p += n;
+        length -= n;
+        
+        if (g_ckpt.pos == Z1_SNN_CKPT_BUFFER) {
+            ckpt_flush();
+        }
+    }
+}
+
+static void ckpt_get(void* data, uint16_t length) {
+    uint8_t* p = (uint8_t*)data;
+    
+    while (length > 0 && !g_ckpt.failed) {
+        if (g_ckpt.pos == g_ckpt.fill) {
+            g_ckpt.addr += g_ckpt.fill;
+            uint32_t left = g_ckpt.end - g_ckpt.addr;
+            g_ckpt.fill = (left < Z1_SNN_CKPT_BUFFER) ? (uint16_t)left : Z1_SNN_CKPT_BUFFER;
+            g_ckpt.pos = 0;
+            if (g_ckpt.fill == 0 || !psram_read(g_ckpt.addr, g_ckpt.buffer, g_ckpt.fill)) {
+                g_ckpt.failed = true;
+                break;
+            }
+        }
+        
+        uint16_t n = g_ckpt.fill - g_ckpt.pos;
+        if (n > length) n = length;
+        memcpy(p, g_ckpt.buffer + g_ckpt.pos, n);
+        g_ckpt.pos += n;
+        p += n;
+        length -= n;
+    }
+}
+
+/**
+ * CRC32 of an image body in PSRAM
+ */
+static bool checkpoint_body_crc(uint32_t addr, uint32_t length, uint32_t* crc) {
+    *crc = 0;
+    for (uint32_t offset = 0; offset < length; ) {
+        uint32_t n = length - offset;
+        if (n > Z1_SNN_CKPT_BUFFER) n = Z1_SNN_CKPT_BUFFER;
+        if (!psram_read(addr + offset, g_ckpt.buffer, n)) {
+            return false;
+        }
+        *crc = z1_crc32_update(*crc, g_ckpt.buffer, n);
+        offset += n;
+    }
+    return true;
+}
+
+/**
+ * Hash what an image relies on without carrying it, and size its row sections
+ *
+ * @param rows Receives the synapse index row count
+ * @param learned_rows Receives the rows learned since the table was loaded
+ * @param learned_bytes Receives the size of their records
+ * @return Topology hash (z1_snn_ckpt_header_t)
+ */
+static uint32_t checkpoint_scan(uint16_t* rows, uint16_t* learned_rows, uint32_t* learned_bytes) {
+    uint16_t n = g_snn_state.neuron_count;
+    uint32_t hash = z1_hash32_update(Z1_HASH32_INIT, (const uint8_t*)&n, sizeof(n));
+    hash = z1_hash32_update(hash, (const uint8_t*)g_neurons.flags, n * sizeof(g_neurons.flags[0]));
+    hash = z1_hash32_update(hash, (const uint8_t*)g_neurons.refractory_period_us,
+                            n * sizeof(g_neurons.refractory_period_us[0]));
+    
+    uint32_t source_id, first;
+    uint16_t count;
+    uint16_t row = 0;
+    *learned_rows = 0;
+    *learned_bytes = 0;
+    for (; z1_synapse_index_get_row(row, &source_id, &first, &count); row++) {
+        hash = z1_hash32_update(hash, (const uint8_t*)&source_id, sizeof(source_id));
+        hash = z1_hash32_update(hash, (const uint8_t*)&count, sizeof(count));
+        
+        if (g_stdp.learned_rows[row >> 5] & (1u << (row & 31))) {
+            (*learned_rows)++;
+            *learned_bytes += 4 + count;
+        }
+    }
+    *rows = row;
+    
+    return hash;
+}
+
+static void checkpoint_describe(const z1_snn_ckpt_header_t* header, z1_snn_ckpt_info_t* info) {
+    info->version = header->version;
+    info->neuron_count = header->neuron_count;
+    info->length = header->length;
+    info->crc32 = header->crc32;
+    info->topology = header->topology;
+    info->steps = header->steps;
+    info->learned_rows = header->learned_rows;
+}
+
+/**
+ * Serialize the run state of the stopped engine
+ */
+bool z1_snn_engine_checkpoint(uint32_t addr, uint32_t capacity, z1_snn_ckpt_info_t* info) {
+    memset(info, 0, sizeof(*info));
+    info->version = Z1_SNN_CKPT_VERSION;
+    
+    if (g_snn_state.running || g_snn_state.neuron_count == 0) {
+        info->status = g_snn_state.running ? Z1_SNN_CKPT_STATUS_BUSY : Z1_SNN_CKPT_STATUS_NO_NETWORK;
+        printf("[SNN] ERROR: Checkpoint refused (%s)\n",
+               g_snn_state.running ? "running" : "no network loaded");
+        return false;
+    }
+    
+    uint16_t neuron_count = g_snn_state.neuron_count;
+    uint16_t rows, learned_rows;
+    uint32_t learned_bytes;
+    z1_snn_ckpt_header_t header = {
+        .magic = Z1_SNN_CKPT_MAGIC,
+        .version = Z1_SNN_CKPT_VERSION,
+        .neuron_count = neuron_count,
+        .topology = checkpoint_scan(&rows, &learned_rows, &learned_bytes),
+        .steps = g_snn_state.steps_completed,
+        .rng = g_stdp.rng,
+    };
+    
+    // Traces are all zero without plastic neurons
+    header.rows = g_stdp.enabled ? rows : 0;
+    header.learned_rows = learned_rows;
+    header.length = sizeof(header) + neuron_count * sizeof(z1_snn_ckpt_neuron_t) +
+                    header.rows * sizeof(uint16_t) + learned_bytes;
+    checkpoint_describe(&header, info);
+    
+    if (header.length > capacity) {
+        info->status = Z1_SNN_CKPT_STATUS_TOO_LARGE;
+        printf("[SNN] ERROR: Checkpoint of %u bytes does not fit %u\n",
+               (unsigned int)header.length, (unsigned int)capacity);
+        return false;
+    }
+    
+    // Times and traces as of the end of the last step (stop settled the
+    // leak and the owed potentiation up to there)
+    uint32_t now_us = g_snn_state.current_time_us;
+    uint32_t step = g_snn_state.steps_completed;
+    ckpt_open(addr + sizeof(header), addr + header.length);
+    
+    for (uint16_t i = 0; i < neuron_count; i++) {
+        int32_t left = (int32_t)(g_neurons.refractory_until_us[i] - now_us);
+        uint32_t age = (step > g_neurons.post_step[i]) ? step - g_neurons.post_step[i] : 0;
+        z1_snn_ckpt_neuron_t record = {
+            .potential = potential_to_float(g_neurons.membrane_potential[i]),
+            .refractory_us = (left > 0) ? (uint32_t)left : 0,
+            .post_trace = stdp_trace_at(g_neurons.post_trace[i], age, g_stdp.post_decay),
+        };
+        ckpt_put(&record, sizeof(record));
+    }
+    
+    // Pre traces were settled to the step after the last
+    for (uint16_t row = 0; row < header.rows; row++) {
+        uint32_t age = (step + 1 > g_stdp.pre_step[row]) ? step + 1 - g_stdp.pre_step[row] : 0;
+        uint16_t trace = stdp_trace_at(g_stdp.pre_trace[row], age, g_stdp.pre_decay);
+        ckpt_put(&trace, sizeof(trace));
+    }
+    
+    // Weights of the learned rows; targets, delays and slots come from the table
+    z1_synapse_target_t entries[Z1_SNN_FANOUT_CHUNK];
+    uint8_t weights[Z1_SNN_FANOUT_CHUNK];
+    uint32_t source_id, first;
+    uint16_t count;
+    for (uint16_t row = 0; z1_synapse_index_get_row(row, &source_id, &first, &count); row++) {
+        if (!(g_stdp.learned_rows[row >> 5] & (1u << (row & 31)))) {
+            continue;
+        }
+        
+        uint16_t record[2] = { row, count };
+        ckpt_put(record, sizeof(record));
+        
+        while (count > 0 && !g_ckpt.failed) {
+            uint16_t n = (count < Z1_SNN_FANOUT_CHUNK) ? count : Z1_SNN_FANOUT_CHUNK;
+            if (!z1_synapse_index_read(first, entries, n)) {
+                g_ckpt.failed = true;
+                break;
+            }
+            for (uint16_t k = 0; k < n; k++) {
+                weights[k] = z1_synapse_target_get_weight(entries[k]);
+            }
+            ckpt_put(weights, n);
+            
+            first += n;
+            count -= n;
+        }
+    }
+    
+    ckpt_flush();
+    header.crc32 = g_ckpt.crc;
+    if (g_ckpt.failed || !psram_write(addr, &header, sizeof(header))) {
+        info->status = Z1_SNN_CKPT_STATUS_FAILED;
+        printf("[SNN] ERROR: Checkpoint write failed\n");
+        return false;
+    }
+    
+    info->crc32 = header.crc32;
+    info->status = Z1_SNN_CKPT_STATUS_OK;
+    printf("[SNN] Checkpoint: %u bytes at step %u (%d neurons, %d trace rows, %d learned rows)\n",
+           (unsigned int)header.length, (unsigned int)header.steps, neuron_count,
+           header.rows, learned_rows);
+    return true;
+}
+
+/**
+ * Check a checkpoint image and apply it to the loaded network
+ */
+bool z1_snn_engine_restore(uint32_t addr, uint32_t capacity, z1_snn_ckpt_info_t* info) {
+    memset(info, 0, sizeof(*info));
+    info->version = Z1_SNN_CKPT_VERSION;
+    
+    if (g_snn_state.running || g_snn_state.neuron_count == 0) {
+        info->status = g_snn_state.running ? Z1_SNN_CKPT_STATUS_BUSY : Z1_SNN_CKPT_STATUS_NO_NETWORK;
+        printf("[SNN] ERROR: Restore refused (%s)\n",
+               g_snn_state.running ? "running" : "no network loaded");
+        return false;
+    }
+    
+    z1_snn_ckpt_header_t header;
+    if (capacity < sizeof(header) || !psram_read(addr, &header, sizeof(header))) {
+        info->status = Z1_SNN_CKPT_STATUS_FAILED;
+        return false;
+    }
+    checkpoint_describe(&header, info);
+    
+    uint16_t neuron_count = g_snn_state.neuron_count;
+    uint32_t crc;
+    if (header.magic != Z1_SNN_CKPT_MAGIC || header.version != Z1_SNN_CKPT_VERSION ||
+        header.length > capacity ||
+        header.length < sizeof(header) + (uint32_t)header.neuron_count * sizeof(z1_snn_ckpt_neuron_t) +
+                        header.rows * sizeof(uint16_t)) {
+        info->status = Z1_SNN_CKPT_STATUS_BAD_IMAGE;
+        printf("[SNN] ERROR: No valid checkpoint image at 0x%08X\n", (unsigned int)addr);
+        return false;
+    }
+    if (!checkpoint_body_crc(addr + sizeof(header), header.length - sizeof(header), &crc)) {
+        info->status = Z1_SNN_CKPT_STATUS_FAILED;
+        return false;
+    }
+    if (crc != header.crc32) {
+        info->status = Z1_SNN_CKPT_STATUS_BAD_IMAGE;
+        printf("[SNN] ERROR: Checkpoint CRC32 mismatch (0x%08X, expected 0x%08X)\n",
+               (unsigned int)crc, (unsigned int)header.crc32);
+        return false;
+    }
+    
+    uint16_t rows, learned_rows;
+    uint32_t learned_bytes;
+    if (header.neuron_count != neuron_count ||
+        header.topology != checkpoint_scan(&rows, &learned_rows, &learned_bytes) ||
+        header.rows > rows) {
+        info->status = Z1_SNN_CKPT_STATUS_MISMATCH;
+        printf("[SNN] ERROR: Checkpoint was saved from a different network\n");
+        return false;
+    }
+    
+    // Rebased so the restored state is as of step 0: the next start counts
+    // from there, and the first step adds its time to the refractory times
+    ckpt_open(addr + sizeof(header), addr + header.length);
+    for (uint16_t i = 0; i < neuron_count; i++) {
+        z1_snn_ckpt_neuron_t record;
+        ckpt_get(&record, sizeof(record));
+        
+        g_neurons.membrane_potential[i] = potential_from_float(record.potential);
+        g_neurons.refractory_until_us[i] = record.refractory_us;
+        g_neurons.last_spike_time_us[i] = 0;
+        g_neurons.last_update_step[i] = 0;
+        g_neurons.post_trace[i] = record.post_trace;
+        g_neurons.post_step[i] = 0;
+    }
+    
+    // Pre traces as of step 1, like stop leaves them one step ahead
+    memset(g_stdp.pre_trace, 0, sizeof(g_stdp.pre_trace));
+    for (uint16_t row = 0; row < Z1_SYNAPSE_INDEX_MAX_SOURCES; row++) {
+        g_stdp.pre_step[row] = 1;
+    }
+    for (uint16_t row = 0; row < header.rows; row++) {
+        ckpt_get(&g_stdp.pre_trace[row], sizeof(uint16_t));
+    }
+    
+    // Learned weights into the index, then through it into the neuron table
+    z1_synapse_target_t entries[Z1_SNN_FANOUT_CHUNK];
+    uint8_t weights[Z1_SNN_FANOUT_CHUNK];
+    uint32_t source_id, first;
+    uint16_t count;
+    bool mismatch = false;
+    for (uint16_t k = 0; k < header.learned_rows && !g_ckpt.failed && !mismatch; k++) {
+        uint16_t record[2];
+        ckpt_get(record, sizeof(record));
+        if (g_ckpt.failed || !z1_synapse_index_get_row(record[0], &source_id, &first, &count) ||
+            count != record[1]) {
+            mismatch = true;
+            break;
+        }
+        
+        while (count > 0 && !g_ckpt.failed) {
+            uint16_t n = (count < Z1_SNN_FANOUT_CHUNK) ? count : Z1_SNN_FANOUT_CHUNK;
+            ckpt_get(weights, n);
+            if (g_ckpt.failed || !z1_synapse_index_read(first, entries, n)) {
+                g_ckpt.failed = true;
+                break;
+            }
+            for (uint16_t j = 0; j < n; j++) {
+                entries[j] = (entries[j] & 0xFFFFFF00) | weights[j];
+            }
+            if (!z1_synapse_index_write(first, entries, n)) {
+                g_ckpt.failed = true;
+                break;
+            }
+            
+            first += n;
+            count -= n;
+        }
+        
+        g_stdp.dirty_rows[record[0] >> 5] |= 1u << (record[0] & 31);
+        g_stdp.learned_rows[record[0] >> 5] |= 1u << (record[0] & 31);
+    }
+    stdp_sync_table();
+    
+    g_stdp.rng = header.rng;
+    g_snn_state.steps_completed = 0;
+    g_snn_state.current_time_us = 0;
+    g_snn_state.resume = true;
+    
+    if (mismatch || g_ckpt.failed || g_ckpt.addr + g_ckpt.pos != addr + header.length) {
+        info->status = mismatch ? Z1_SNN_CKPT_STATUS_MISMATCH : Z1_SNN_CKPT_STATUS_BAD_IMAGE;
+        printf("[SNN] ERROR: Checkpoint %s; state only partly restored\n",
+               mismatch ? "rows do not match the synapse index" : "image ends early");
+        return false;
+    }
+    
+    info->status = Z1_SNN_CKPT_STATUS_OK;
+    printf("[SNN] Restored checkpoint of step %u (%d neurons, %d learned rows)\n",
+           (unsigned int)header.steps, neuron_count, header.learned_rows);
+    return true;
+}
+
+// ============================================================================
+// Batch Inference
+// ============================================================================
+
+/**
+ * Check a staged batch image against the loaded network
+ *
+ * @return Z1_SNN_BATCH_STATUS_*
+ */
+static uint8_t batch_check(uint32_t addr, uint32_t capacity, z1_snn_batch_header_t* header) {
+    if (g_snn_state.neuron_count == 0) {
+        return Z1_SNN_BATCH_STATUS_NO_NETWORK;
+    }
+    if (capacity < sizeof(*header)) {
+        return Z1_SNN_BATCH_STATUS_BAD_IMAGE;
+    }
+    if (!psram_read(addr, header, sizeof(*header))) {
+        return Z1_SNN_BATCH_STATUS_FAILED;
+    }
+    
+    uint32_t max_inputs = (capacity - sizeof(*header)) / sizeof(z1_snn_batch_input_t);
+    if (header->magic != Z1_SNN_BATCH_MAGIC || header->version != Z1_SNN_BATCH_VERSION ||
+        header->steps_per_sample == 0 || header->sample_count == 0 || header->input_count > max_inputs ||
+        header->length != sizeof(*header) + header->input_count * sizeof(z1_snn_batch_input_t)) {
+        return Z1_SNN_BATCH_STATUS_BAD_IMAGE;
+    }
+    
+    uint32_t crc;
+    if (!checkpoint_body_crc(addr + sizeof(*header), header->length - sizeof(*header), &crc)) {
+        return Z1_SNN_BATCH_STATUS_FAILED;
+    }
+    if (crc != header->crc32) {
+        return Z1_SNN_BATCH_STATUS_BAD_IMAGE;
+    }
+    
+    // Inputs are taken in order as the run reaches them
+    uint32_t last = 0;
+    ckpt_open(addr + sizeof(*header), addr + header->length);
+    for (uint32_t k = 0; k < header->input_count; k++) {
+        z1_snn_batch_input_t in;
+        ckpt_get(&in, sizeof(in));
+        uint16_t step = in.step & ~Z1_SNN_BATCH_HOLD;
+        uint32_t key = ((uint32_t)in.sample << 16) | step;
+        if (g_ckpt.failed) {
+            return Z1_SNN_BATCH_STATUS_FAILED;
+        }
+        if (key < last || in.sample >= header->sample_count || step >= header->steps_per_sample ||
+            in.local_id >= g_snn_state.neuron_count) {
+            return Z1_SNN_BATCH_STATUS_BAD_IMAGE;
+        }
+        last = key;
+    }
+    
+    // Counted neurons, and room for a record per sample behind the image
+    g_batch.output_count = 0;
+    for (uint16_t i = 0; i < g_snn_state.neuron_count; i++) {
+        if (g_neurons.flags[i] & Z1_NEURON_FLAG_OUTPUT) {
+            if (g_batch.output_count == Z1_SNN_BATCH_MAX_OUTPUTS) {
+                return Z1_SNN_BATCH_STATUS_NO_OUTPUTS;
+            }
+            g_batch.outputs[g_batch.output_count++] = i;
+        }
+    }
+    if (g_batch.output_count == 0) {
+        return Z1_SNN_BATCH_STATUS_NO_OUTPUTS;
+    }
+    
+    uint32_t offset = (header->length + 3) & ~3u;
+    uint32_t size = sizeof(z1_snn_batch_results_t) + g_batch.output_count * sizeof(z1_snn_batch_output_t) +
+                    (uint32_t)header->sample_count * g_batch.output_count * sizeof(uint16_t);
+    if (offset + size > capacity) {
+        return Z1_SNN_BATCH_STATUS_TOO_LARGE;
+    }
+    g_batch.results_addr = addr + offset;
+    
+    // Results header and outputs; counts are added as samples finish
+    z1_snn_batch_results_t results = {
+        .magic = Z1_SNN_BATCH_RESULTS_MAGIC,
+        .node_id = g_snn_state.node_id,
+        .output_count = g_batch.output_count,
+        .sample_count = 0,
+        .steps_per_sample = header->steps_per_sample,
+    };
+    ckpt_open(g_batch.results_addr, addr + capacity);
+    ckpt_put(&results, sizeof(results));
+    for (uint16_t k = 0; k < g_batch.output_count; k++) {
+        z1_snn_batch_output_t output = { .local_id = g_batch.outputs[k] };
+        if (!z1_psram_read_neuron_params(output.local_id, &g_load_scratch)) {
+            return Z1_SNN_BATCH_STATUS_FAILED;
+        }
+        output.global_id = g_load_scratch.global_id;
+        ckpt_put(&output, sizeof(output));
+    }
+    ckpt_flush();
+    
+    return g_ckpt.failed ? Z1_SNN_BATCH_STATUS_FAILED : Z1_SNN_BATCH_STATUS_OK;
+}
+
+/**
+ * Arm or disarm the staged batch for the next start
+ */
+bool z1_snn_engine_set_batch(uint32_t addr, uint32_t capacity) {
+    if (g_snn_state.running) {
+        printf("[SNN] ERROR: Cannot change the batch while running\n");
+        return false;
+    }
+    
+    g_batch.enabled = false;
+    if (addr == 0) {
+        return true;
+    }
+    
+    g_batch.addr = addr;
+    g_batch.results_addr = 0;
+    g_batch.samples_done = 0;
+    g_batch.status = batch_check(addr, capacity, &g_batch.header);
+    if (g_batch.status != Z1_SNN_BATCH_STATUS_OK) {
+        printf("[SNN] ERROR: Batch refused (status %d)\n", g_batch.status);
+        return false;
+    }
+    
+    g_batch.enabled = true;
+    printf("[SNN] Batch staged: %d samples, %u inputs, %d output neurons\n",
+           g_batch.header.sample_count, (unsigned int)g_batch.header.input_count, g_batch.output_count);
+    return true;
+}
+
+/**
+ * Check whether the engine runs a batch
+ */
+bool z1_snn_engine_batch_enabled(void) {
+    return g_batch.enabled;
+}
+
+/**
+ * Run the next step of a free-running batch
+ */
+bool z1_snn_engine_batch_step(void) {
+    if (!g_batch.enabled || g_sync.enabled || !g_snn_state.running ||
+        g_batch.samples_done >= g_batch.header.sample_count) {
+        return false;
+    }
+    z1_snn_engine_step((g_snn_state.steps_completed + 1) * g_snn_state.timestep_us);
+    return true;
+}
+
+/**
+ * Fill the Z1_CMD_SNN_BATCH answer
+ */
+void z1_snn_engine_batch_get_info(z1_snn_batch_info_t* info) {
+    memset(info, 0, sizeof(*info));
+    info->status = g_batch.status;
+    info->version = Z1_SNN_BATCH_VERSION;
+    info->steps = g_snn_state.steps_completed;
+    if (g_batch.results_addr == 0) {
+        return;
+    }
+    
+    uint16_t done = g_batch.samples_done;
+    info->output_count = g_batch.output_count;
+    info->sample_count = g_batch.header.sample_count;
+    info->samples_done = done;
+    info->steps_per_sample = g_batch.header.steps_per_sample;
+    info->held_dropped = g_batch.held_dropped;
+    info->results_addr = Z1_PSRAM_HOST_BASE + (g_batch.results_addr - PSRAM_BASE_ADDRESS);
+    info->results_length = sizeof(z1_snn_batch_results_t) +
+                           g_batch.output_count * sizeof(z1_snn_batch_output_t) +
+                           (uint32_t)done * g_batch.output_count * sizeof(uint16_t);
 }
 
 /**
@@ -353,18 +2931,139 @@ void z1_snn_engine_get_stats(uint16_t* active_neurons, uint32_t* total_spikes, u
     }
 }
 
+/**
+ * Get the delivery backend of the loaded network
+ */
+uint8_t z1_snn_engine_get_backend(void) {
+    return g_snn_state.backend;
+}
+
+/**
+ * Fill the Z1_CMD_SNN_GET_STATUS response payload
+ */
+void z1_snn_engine_get_status(z1_snn_status_t* status) {
+    memset(status, 0, sizeof(*status));
+    status->version = Z1_SNN_STATUS_VERSION;
+    status->running = g_snn_state.running;
+    status->neuron_count = g_snn_state.neuron_count;
+    status->active_neurons = g_snn_state.active_neurons;
+    status->current_time_us = g_snn_state.current_time_us;
+    status->steps_completed = g_snn_state.steps_completed;
+    status->spikes_generated = g_snn_state.spikes_generated;
+    status->spikes_received = g_snn_state.spikes_received;
+    status->spikes_processed = g_snn_state.spikes_processed;
+    status->synapse_events = g_snn_state.synapse_events;
+    status->fanout_stalls = g_snn_state.fanout_stalls;
+    status->spikes_spilled = g_spill.spilled;
+    status->spikes_dropped = g_spill.dropped + g_snn_state.spikes_dropped;
+    status->uptime_ms = to_ms_since_boot(get_absolute_time());
+    
+    uint32_t credit_stalls;
+    z1_spike_batch_get_credit_stats(&credit_stalls, NULL);
+    status->credit_stalls = credit_stalls;
+    
+    z1_neuron_cache_stats_t cache;
+    z1_neuron_cache_get_stats(&cache);
+    status->cache_hits = cache.hits;
+    status->cache_misses = cache.misses;
+    status->cache_evictions = cache.evictions;
+    z1_snn_profile_get(status);
+}
+
+/**
+ * Fill a Z1_CMD_SNN_GET_SPIKES response (header + raster records)
+ */
+uint16_t z1_snn_engine_get_spikes(const z1_spike_read_req_t* req, uint8_t* buffer, uint16_t size) {
+    z1_spike_raster_header_t header;
+    
+    if (size < sizeof(header)) {
+        return 0;
+    }
+    uint16_t max_records = (size - sizeof(header)) / sizeof(z1_spike_raster_t);
+    if (req->max_records < max_records) {
+        max_records = req->max_records;
+    }
+    
+    // buffer is word-aligned, so records can be copied straight after the header
+    uint16_t n = z1_spike_recorder_read((req->flags & Z1_SPIKE_READ_REWIND) != 0, &header,
+                                        (z1_spike_raster_t*)(buffer + sizeof(header)), max_records);
+    header.current_step = g_snn_state.steps_completed;
+    memcpy(buffer, &header, sizeof(header));
+    
+    return sizeof(header) + n * sizeof(z1_spike_raster_t);
+}
+
 /**
  * Print engine status
  */
 void z1_snn_engine_print_status(void) {
     printf("[SNN] Status:\n");
     printf("  Running:     %s\n", g_snn_state.running ? "YES" : "NO");
-    printf("  Neurons:     %d\n", g_snn_state.neuron_count);
+    printf("  Neurons:     %d (%d active last step)\n",
+           g_snn_state.neuron_count, g_snn_state.active_neurons);
     printf("  Time:        %u us\n", (unsigned int)g_snn_state.current_time_us);
     printf("  Generated:   %u spikes\n", (unsigned int)g_snn_state.spikes_generated);
     printf("  Received:    %u spikes\n", (unsigned int)g_snn_state.spikes_received);
     printf("  Processed:   %u spikes\n", (unsigned int)g_snn_state.spikes_processed);
-    printf("  Queue:       %d / %d\n", g_spike_queue.count, Z1_MAX_SPIKE_QUEUE_SIZE);
+    printf("  Synapses:    %u events\n", (unsigned int)g_snn_state.synapse_events);
+    if (g_snn_state.backend == Z1_SNN_BACKEND_RESIDENT) {
+        printf("  Fan-out:     resident synapse index (SRAM)\n");
+    } else {
+        printf("  Fan-out:     %u blocks, %u stalls (prefetch depth %d)\n",
+               (unsigned int)g_snn_state.fanout_blocks, (unsigned int)g_snn_state.fanout_stalls,
+               Z1_SNN_PREFETCH_DEPTH);
+    }
+    
+    uint32_t batches, batch_spikes, batch_errors, multicasts;
+    z1_spike_batch_get_stats(&batches, &batch_spikes, &batch_errors, &multicasts);
+    printf("  Batches:     %u sent, %u multicast (%u spikes, %u errors)\n",
+           (unsigned int)batches, (unsigned int)multicasts, (unsigned int)batch_spikes,
+           (unsigned int)batch_errors);
+    printf("  Queue:       %d / %d, %u / %u spilled (peak %u, %u total), %u dropped\n",
+           g_spike_queue.count, Z1_MAX_SPIKE_QUEUE_SIZE,
+           (unsigned int)(g_spill.count + g_spill.staged), (unsigned int)g_spill.capacity,
+           (unsigned int)g_spill.peak, (unsigned int)g_spill.spilled, (unsigned int)g_spill.dropped);
+    
+    uint32_t credit_stalls, overdrafts;
+    z1_spike_batch_get_credit_stats(&credit_stalls, &overdrafts);
+    printf("  Credit:      %u stalls, %u overdrafts\n",
+           (unsigned int)credit_stalls, (unsigned int)overdrafts);
+    if (g_sync.enabled) {
+        printf("  Barrier:     step %u released, %u reported, %u spikes deferred\n",
+               (unsigned int)g_sync.released, (unsigned int)g_sync.reported,
+               (unsigned int)g_sync.deferred);
+    }
+    
+    if (g_group_count > 0) {
+        printf("  Groups:      %d inhibition groups, %u k-WTA losers clamped\n",
+               g_group_count, (unsigned int)g_group_clamped);
+    }
+    if (g_stdp.enabled) {
+        printf("  STDP:        %u LTP, %u LTD, %u blocks written back in %u batches\n",
+               (unsigned int)g_stdp.potentiations, (unsigned int)g_stdp.depressions,
+               (unsigned int)g_stdp.blocks_written, (unsigned int)g_stdp.writeback_batches);
+    }
+    
+    z1_spike_wheel_stats_t wheel;
+    z1_spike_wheel_get_stats(&wheel);
+    printf("  Delays:      %u pending (peak %u), %u scheduled, %u overflows\n",
+           (unsigned int)wheel.pending, (unsigned int)wheel.peak,
+           (unsigned int)wheel.scheduled, (unsigned int)wheel.overflows);
+#ifdef Z1_NODE_DUAL_CORE
+    printf("  Ingress:     %u queued, %u dropped (%u spikes)\n",
+           (unsigned int)z1_spike_ring_count(&g_ingress_ring), (unsigned int)g_ingress_ring.dropped,
+           (unsigned int)g_snn_state.spikes_dropped);
+    printf("  Egress:      %u queued, %u dropped\n",
+           (unsigned int)z1_spike_ring_count(&g_egress_ring), (unsigned int)g_egress_ring.dropped);
+#endif
+    
+    
+    z1_spike_recorder_stats_t rec;
+    z1_spike_recorder_get_stats(&rec);
+    printf("  Raster:      %u recorded, %u unread / %u, %u overruns (%s)\n",
+           (unsigned int)rec.recorded, (unsigned int)rec.unread, (unsigned int)rec.capacity,
+           (unsigned int)rec.overruns, rec.output_only ? "output neurons" : "all neurons");
     
+    z1_snn_profile_print();
     z1_neuron_cache_print_stats();
 }
@@ -0,0 +1,151 @@
+/**
+ * Z1 SNN Timestep Profiler
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_snn_profile.h"
+#include "hardware/clocks.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    uint32_t samples;
+    uint32_t min_ticks;
+    uint32_t max_ticks;
+    uint64_t total_ticks;
+    uint32_t buckets[Z1_SNN_STATUS_BUCKETS];
+} z1_snn_phase_stats_t;
+
+static z1_snn_phase_stats_t g_phases[Z1_SNN_PHASE_COUNT];
+static volatile bool g_reset_pending = false;
+
+static const char* const g_phase_names[Z1_SNN_PHASE_COUNT] = {
+    "ingress", "delivery", "sweep", "routing", "flush", "stall", "step",
+};
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+static void enable_counter(void) {
+#if Z1_SNN_PROFILE_CYCLES
+    if (!(Z1_DWT_CTRL & Z1_DWT_CTRL_CYCCNTENA)) {
+        Z1_DEMCR |= Z1_DEMCR_TRCENA;
+        Z1_DWT_CYCCNT = 0;
+        Z1_DWT_CTRL |= Z1_DWT_CTRL_CYCCNTENA;
+    }
+#endif
+}
+
+static void clear_phases(void) {
+    memset(g_phases, 0, sizeof(g_phases));
+    for (uint8_t p = 0; p < Z1_SNN_PHASE_COUNT; p++) {
+        g_phases[p].min_ticks = UINT32_MAX;
+    }
+}
+
+/**
+ * Enable the timing counter on the calling core and clear all phases
+ */
+void z1_snn_profile_init(void) {
+    enable_counter();
+    clear_phases();
+    g_reset_pending = false;
+}
+
+/**
+ * Start a timestep on the stepping core
+ */
+uint32_t z1_snn_profile_begin_step(void) {
+    enable_counter();
+    if (g_reset_pending) {
+        clear_phases();
+        g_reset_pending = false;
+    }
+    return z1_snn_profile_now();
+}
+
+/**
+ * Add one sample to a phase
+ */
+void z1_snn_profile_record(uint8_t phase, uint32_t ticks) {
+    if (phase >= Z1_SNN_PHASE_COUNT) {
+        return;
+    }
+    z1_snn_phase_stats_t* s = &g_phases[phase];
+
+    s->samples++;
+    s->total_ticks += ticks;
+    if (ticks < s->min_ticks) s->min_ticks = ticks;
+    if (ticks > s->max_ticks) s->max_ticks = ticks;
+
+    uint32_t scaled = ticks >> Z1_SNN_PROFILE_BUCKET_SHIFT;
+    uint32_t bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+    if (bucket >= Z1_SNN_STATUS_BUCKETS) {
+        bucket = Z1_SNN_STATUS_BUCKETS - 1;
+    }
+    s->buckets[bucket]++;
+}
+
+/**
+ * Clear all phases at the start of the next step
+ */
+void z1_snn_profile_request_reset(void) {
+    g_reset_pending = true;
+}
+
+// ============================================================================
+// Readout
+// ============================================================================
+
+static uint16_t ticks_per_us(void) {
+#if Z1_SNN_PROFILE_CYCLES
+    return (uint16_t)(clock_get_hz(clk_sys) / 1000000);
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Copy the phase statistics into a status payload
+ */
+void z1_snn_profile_get(z1_snn_status_t* status) {
+    status->phase_count = Z1_SNN_PHASE_COUNT;
+    status->bucket_shift = Z1_SNN_PROFILE_BUCKET_SHIFT;
+    status->ticks_per_us = ticks_per_us();
+
+    for (uint8_t p = 0; p < Z1_SNN_PHASE_COUNT; p++) {
+        const z1_snn_phase_stats_t* s = &g_phases[p];
+        z1_snn_phase_status_t* out = &status->phases[p];
+
+        out->samples = s->samples;
+        out->min_ticks = s->samples ? s->min_ticks : 0;
+        out->avg_ticks = s->samples ? (uint32_t)(s->total_ticks / s->samples) : 0;
+        out->max_ticks = s->max_ticks;
+        memcpy(out->buckets, s->buckets, sizeof(out->buckets));
+    }
+}
+
+/**
+ * Print per-phase timing in microseconds
+ */
+void z1_snn_profile_print(void) {
+    uint32_t tpu = ticks_per_us();
+
+    printf("  Timing (us):  %8s %8s %8s %8s\n", "samples", "min", "avg", "max");
+    for (uint8_t p = 0; p < Z1_SNN_PHASE_COUNT; p++) {
+        const z1_snn_phase_stats_t* s = &g_phases[p];
+        if (s->samples == 0) {
+            continue;
+        }
+        printf("    %-9s %8u %8u %8u %8u\n", g_phase_names[p], (unsigned int)s->samples,
+               (unsigned int)(s->min_ticks / tpu),
+               (unsigned int)(s->total_ticks / s->samples / tpu),
+               (unsigned int)(s->max_ticks / tpu));
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * Z1 SNN Timestep Profiler
+ *
+ * Per-phase timing of z1_snn_engine_step(): sample count, min/avg/max and
+ * a log2 histogram for each Z1_SNN_PHASE_*. Times are taken from the
+ * Cortex-M33 DWT cycle counter of the core doing the work (1 tick = 1 CPU
+ * cycle); RISC-V builds fall back to the 1 MHz system timer.
+ *
+ * Recording is a handful of stores and is done only by the stepping core;
+ * readers on the other core may see a sample half-applied.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SNN_PROFILE_H
+#define Z1_SNN_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#if defined(__ARM_ARCH_8M_MAIN__)
+#define Z1_SNN_PROFILE_CYCLES   1
+#define Z1_DWT_CTRL             (*(volatile uint32_t*)0xE0001000)
+#define Z1_DWT_CYCCNT           (*(volatile uint32_t*)0xE0001004)
+#define Z1_DEMCR                (*(volatile uint32_t*)0xE000EDFC)
+#define Z1_DEMCR_TRCENA         (1u << 24)
+#define Z1_DWT_CTRL_CYCCNTENA   (1u << 0)
+#else
+#include "pico/time.h"
+#define Z1_SNN_PROFILE_CYCLES   0
+#endif
+
+// Bucket 0 upper bound: 256 cycles (~1.7 µs at 150 MHz), or 1 µs on the timer
+#if Z1_SNN_PROFILE_CYCLES
+#define Z1_SNN_PROFILE_BUCKET_SHIFT 8
+#else
+#define Z1_SNN_PROFILE_BUCKET_SHIFT 0
+#endif
+
+// ============================================================================
+// Functions
+// ============================================================================
+
+/**
+ * Read the timing counter of the calling core
+ */
+static inline uint32_t z1_snn_profile_now(void) {
+#if Z1_SNN_PROFILE_CYCLES
+    return Z1_DWT_CYCCNT;
+#else
+    return time_us_32();
+#endif
+}
+
+/**
+ * Enable the timing counter on the calling core and clear all phases
+ */
+void z1_snn_profile_init(void);
+
+/**
+ * Start a timestep on the stepping core
+ *
+ * Enables this core's counter on first use and applies a pending reset.
+ *
+ * @return Counter value at the start of the step
+ */
+uint32_t z1_snn_profile_begin_step(void);
+
+/**
+ * Add one sample to a phase
+ *
+ * @param phase Z1_SNN_PHASE_*
+ * @param ticks Duration in counter ticks
+ */
+void z1_snn_profile_record(uint8_t phase, uint32_t ticks);
+
+/**
+ * Clear all phases at the start of the next step (safe from either core)
+ */
+void z1_snn_profile_request_reset(void);
+
+/**
+ * Copy the phase statistics into a status payload
+ *
+ * Fills phase_count, bucket_shift, ticks_per_us and phases[].
+ *
+ * @param status Status payload to fill
+ */
+void z1_snn_profile_get(z1_snn_status_t* status);
+
+/**
+ * Print per-phase timing in microseconds
+ */
+void z1_snn_profile_print(void);
+
+#endif // Z1_SNN_PROFILE_H
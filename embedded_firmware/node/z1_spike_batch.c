@@ -0,0 +1,347 @@
+/**
+ * Z1 Spike Batch
+ *
+ * Per-destination-mask outbound spike batching for the matrix bus, with
+ * credit-based pacing of free-running runs.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_spike_batch.h"
+#include "z1_multiframe.h"
+#include "z1_matrix_bus.h"
+#include "z1_trace.h"
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    z1_spike_batch_header_t header;
+    z1_spike_batch_entry_t entries[Z1_SPIKE_BATCH_MAX_ENTRIES];
+} __attribute__((packed)) z1_spike_batch_t;
+
+static z1_spike_batch_t g_batches[Z1_SPIKE_BATCH_MAX_GROUPS];
+static uint16_t g_masks[Z1_SPIKE_BATCH_MAX_GROUPS];     // 0 = group free
+static uint16_t g_stalled[Z1_SPIKE_BATCH_MAX_GROUPS];   // Destinations held for credit
+static z1_spike_batch_t g_gateway;                      // Spikes for other backplanes, to the controller
+static uint8_t g_node_id = 0;
+static uint32_t g_timestep_us = 1000;
+
+static uint32_t g_batches_sent = 0;
+static uint32_t g_spikes_sent = 0;
+static uint32_t g_send_errors = 0;
+static uint32_t g_multicasts = 0;
+
+// Credit: spikes each destination can still take (sender side), and spikes
+// consumed for / credited back to each source (receiver side)
+static bool g_credits_enabled = false;
+static int32_t g_credits[Z1_SPIKE_BATCH_MAX_NODES];
+static uint32_t g_consumed[Z1_SPIKE_BATCH_MAX_NODES];   // Both cores add
+static uint32_t g_returned[Z1_SPIKE_BATCH_MAX_NODES];
+static uint32_t g_credit_stalls = 0;
+static uint32_t g_overdrafts = 0;
+
+// ============================================================================
+// Batch Functions
+// ============================================================================
+
+/**
+ * Send one group's batch
+ *
+ * Without force, destinations short of credit or with a failed transfer
+ * stay in the group for the next flush. Returns true once every
+ * destination has the batch and the group is free.
+ */
+static bool flush_group(uint8_t group, bool force) {
+    z1_spike_batch_t* batch = &g_batches[group];
+    uint16_t count = batch->header.count;
+    uint16_t length = Z1_SPIKE_BATCH_HEADER_SIZE + count * Z1_SPIKE_BATCH_ENTRY_SIZE;
+    uint16_t mask = g_masks[group];
+    uint16_t held = 0;
+
+    if (g_credits_enabled) {
+        uint16_t short_of = 0;
+        for (uint8_t node = 0; node < Z1_SPIKE_BATCH_MAX_NODES; node++) {
+            if ((mask & (1u << node)) && g_credits[node] < count) {
+                short_of |= (uint16_t)(1u << node);
+            }
+        }
+        if (force) {
+            g_overdrafts += __builtin_popcount(short_of);
+        } else {
+            g_credit_stalls += __builtin_popcount(short_of & ~g_stalled[group]);
+            g_stalled[group] = short_of;
+            held = short_of;
+            mask &= ~short_of;
+        }
+    }
+    uint16_t sent = 0;
+
+    // Several destinations: one bus claim for all of them
+    if ((mask & (mask - 1)) != 0 &&
+        z1_send_multicast(mask, Z1_CMD_SNN_SPIKE_BATCH, (const uint8_t*)batch, length)) {
+        g_batches_sent++;
+        g_multicasts++;
+        g_spikes_sent += count;
+        sent = mask;
+        mask = 0;
+    }
+
+    for (uint8_t node = 0; mask; node++, mask >>= 1) {
+        if (!(mask & 1)) {
+            continue;
+        }
+        if (z1_send_multiframe(node, Z1_CMD_SNN_SPIKE_BATCH, (const uint8_t*)batch, length)) {
+            g_batches_sent++;
+            g_spikes_sent += count;
+            sent |= (uint16_t)(1u << node);
+        } else {
+            g_send_errors++;
+            Z1_TRACE(SNN, Z1_TRACE_ERROR, Z1_EV_SNN_BATCH_FAIL, node, count);
+            if (!force) {
+                held |= (uint16_t)(1u << node);
+            }
+        }
+    }
+
+    if (g_credits_enabled) {
+        for (uint8_t node = 0; sent; node++, sent >>= 1) {
+            if (sent & 1) {
+                g_credits[node] -= count;
+            }
+        }
+    }
+
+    if (held != 0) {
+        g_masks[group] = held;
+        return false;
+    }
+
+    batch->header.count = 0;
+    g_masks[group] = 0;
+    g_stalled[group] = 0;
+    return true;
+}
+
+/**
+ * Send the gateway batch to the controller
+ *
+ * The controller takes no credit. A failed transfer keeps the batch for
+ * the next flush unless forced (the batch is full and its spikes are lost).
+ */
+static bool flush_gateway(bool force) {
+    uint16_t count = g_gateway.header.count;
+    uint16_t length = Z1_SPIKE_BATCH_HEADER_SIZE + count * Z1_SPIKE_BATCH_ENTRY_SIZE;
+
+    if (z1_send_multiframe(Z1_CONTROLLER_ID, Z1_CMD_SNN_SPIKE_BATCH, (const uint8_t*)&g_gateway, length)) {
+        g_batches_sent++;
+        g_spikes_sent += count;
+    } else {
+        g_send_errors++;
+        Z1_TRACE(SNN, Z1_TRACE_ERROR, Z1_EV_SNN_BATCH_FAIL, Z1_CONTROLLER_ID, count);
+        if (!force) {
+            return false;
+        }
+    }
+
+    g_gateway.header.count = 0;
+    return true;
+}
+
+/**
+ * Find the group collecting dest_mask, or claim one
+ */
+static uint8_t find_group(uint16_t dest_mask) {
+    uint8_t free_group = Z1_SPIKE_BATCH_MAX_GROUPS;
+    uint8_t fullest = 0;
+
+    for (uint8_t g = 0; g < Z1_SPIKE_BATCH_MAX_GROUPS; g++) {
+        if (g_masks[g] == dest_mask) {
+            return g;
+        }
+        if (g_masks[g] == 0) {
+            if (free_group == Z1_SPIKE_BATCH_MAX_GROUPS) {
+                free_group = g;
+            }
+        } else if (g_batches[g].header.count > g_batches[fullest].header.count) {
+            fullest = g;
+        }
+    }
+
+    // All groups in use: the fullest batch is worth a transaction already
+    if (free_group == Z1_SPIKE_BATCH_MAX_GROUPS) {
+        flush_group(fullest, true);
+        free_group = fullest;
+    }
+
+    g_masks[free_group] = dest_mask;
+    return free_group;
+}
+
+/**
+ * Initialize batch builder
+ */
+void z1_spike_batch_init(uint8_t node_id, uint32_t timestep_us) {
+    memset(g_batches, 0, sizeof(g_batches));
+    memset(g_masks, 0, sizeof(g_masks));
+    memset(g_stalled, 0, sizeof(g_stalled));
+    memset(&g_gateway, 0, sizeof(g_gateway));
+    g_node_id = node_id;
+    g_timestep_us = timestep_us ? timestep_us : 1;
+}
+
+/**
+ * Drop pending batches and reset credit for a new run
+ */
+void z1_spike_batch_start(bool credits) {
+    for (uint8_t g = 0; g < Z1_SPIKE_BATCH_MAX_GROUPS; g++) {
+        g_batches[g].header.count = 0;
+        g_masks[g] = 0;
+        g_stalled[g] = 0;
+    }
+    g_gateway.header.count = 0;
+
+    for (uint8_t node = 0; node < Z1_SPIKE_BATCH_MAX_NODES; node++) {
+        g_credits[node] = Z1_SNN_CREDIT_WINDOW;
+        __atomic_store_n(&g_consumed[node], 0, __ATOMIC_RELAXED);
+        g_returned[node] = 0;
+    }
+    g_credits_enabled = credits;
+}
+
+/**
+ * Add a local spike for the nodes in dest_mask
+ */
+void z1_spike_batch_add(uint16_t dest_mask, uint16_t local_id, uint32_t timestamp_us) {
+    if (dest_mask == 0) {
+        return;
+    }
+
+    uint8_t group = find_group(dest_mask);
+    z1_spike_batch_t* batch = &g_batches[group];
+    if (batch->header.count == 0) {
+        batch->header.source_node = g_node_id;
+        batch->header.flags = 0;
+        batch->header.base_timestamp_us = timestamp_us;
+    }
+
+    uint32_t dt = (timestamp_us - batch->header.base_timestamp_us) / g_timestep_us;
+    z1_spike_batch_entry_t* entry = &batch->entries[batch->header.count++];
+    entry->local_id = local_id;
+    entry->dt_steps = (dt > 255) ? 255 : (uint8_t)dt;
+
+    // A full batch goes out even without credit
+    if (batch->header.count >= Z1_SPIKE_BATCH_MAX_ENTRIES) {
+        flush_group(group, true);
+    }
+}
+
+/**
+ * Add a local spike for the controller gateway
+ */
+void z1_spike_batch_add_gateway(uint16_t local_id, uint32_t timestamp_us) {
+    if (g_gateway.header.count == 0) {
+        g_gateway.header.source_node = g_node_id;
+        g_gateway.header.flags = 0;
+        g_gateway.header.base_timestamp_us = timestamp_us;
+    }
+
+    uint32_t dt = (timestamp_us - g_gateway.header.base_timestamp_us) / g_timestep_us;
+    z1_spike_batch_entry_t* entry = &g_gateway.entries[g_gateway.header.count++];
+    entry->local_id = local_id;
+    entry->dt_steps = (dt > 255) ? 255 : (uint8_t)dt;
+
+    if (g_gateway.header.count >= Z1_SPIKE_BATCH_MAX_ENTRIES) {
+        flush_gateway(true);
+    }
+}
+
+/**
+ * Send all pending batches
+ */
+uint8_t z1_spike_batch_flush(void) {
+    uint8_t sent = 0;
+
+    for (uint8_t g = 0; g < Z1_SPIKE_BATCH_MAX_GROUPS; g++) {
+        if (g_masks[g] != 0 && flush_group(g, false)) {
+            sent++;
+        }
+    }
+
+    if (g_gateway.header.count != 0 && flush_gateway(false)) {
+        sent++;
+    }
+
+    return sent;
+}
+
+/**
+ * Take credit returned by a destination
+ */
+void z1_spike_batch_credit(uint8_t node, uint8_t units) {
+    if (node < Z1_SPIKE_BATCH_MAX_NODES) {
+        g_credits[node] += (int32_t)units * Z1_SNN_CREDIT_UNIT;
+    }
+}
+
+/**
+ * Count a received spike off the spike queue
+ */
+void z1_spike_batch_consumed(uint32_t source_id) {
+    // Spikes relayed from other backplanes came from the controller, without credit
+    uint8_t source_node = z1_global_node(source_id);
+    if (z1_global_backplane_field(source_id) == 0 && source_node != g_node_id) {
+        __atomic_fetch_add(&g_consumed[source_node], 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Return credit for consumed spikes to their senders
+ */
+uint8_t z1_spike_batch_return_credits(void) {
+    uint8_t frames = 0;
+
+    if (!g_credits_enabled) {
+        return 0;
+    }
+
+    for (uint8_t node = 0; node < Z1_SPIKE_BATCH_MAX_NODES; node++) {
+        uint32_t owed = __atomic_load_n(&g_consumed[node], __ATOMIC_RELAXED) - g_returned[node];
+        if (owed < Z1_SNN_CREDIT_UNIT) {
+            continue;
+        }
+
+        uint32_t units = owed / Z1_SNN_CREDIT_UNIT;
+        if (units > 255) {
+            units = 255;
+        }
+        // Not sent: still owed, tried again on the next call
+        if (z1_bus_write(node, Z1_CMD_SNN_CREDIT, (uint8_t)units)) {
+            g_returned[node] += units * Z1_SNN_CREDIT_UNIT;
+            frames++;
+        }
+    }
+
+    return frames;
+}
+
+/**
+ * Get batch statistics
+ */
+void z1_spike_batch_get_stats(uint32_t* batches_sent, uint32_t* spikes_sent, uint32_t* send_errors,
+                              uint32_t* multicasts) {
+    if (batches_sent) *batches_sent = g_batches_sent;
+    if (spikes_sent) *spikes_sent = g_spikes_sent;
+    if (send_errors) *send_errors = g_send_errors;
+    if (multicasts) *multicasts = g_multicasts;
+}
+
+/**
+ * Get credit statistics
+ */
+void z1_spike_batch_get_credit_stats(uint32_t* stalls, uint32_t* overdrafts) {
+    if (stalls) *stalls = g_credit_stalls;
+    if (overdrafts) *overdrafts = g_overdrafts;
+}
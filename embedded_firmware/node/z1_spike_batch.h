@@ -0,0 +1,140 @@
+/**
+ * Z1 Spike Batch
+ *
+ * Coalesces outbound spikes per destination mask into a single
+ * Z1_CMD_SNN_SPIKE_BATCH transfer per timestep. A batch for several nodes
+ * goes out as one multicast burst; a single destination, or a multicast
+ * nobody took, is sent point-to-point with z1_send_multiframe().
+ *
+ * In a free-running run, sends are paced by credit: each destination starts
+ * with Z1_SNN_CREDIT_WINDOW spikes and returns Z1_CMD_SNN_CREDIT as its
+ * engine consumes them. A batch for a destination short of credit, or one
+ * whose transfer failed, is held and retried on the next flush. A held
+ * batch is only sent regardless (an overdraft) once it is full or its group
+ * is needed, so bursts cost latency and the receiver's spill queue absorbs
+ * what is left.
+ *
+ * Spikes of neurons with targets on other backplanes also go into one
+ * batch for the controller, which relays them (see Global Neuron
+ * Addressing in z1_protocol.h); that batch is flushed with the others but
+ * takes no credit.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SPIKE_BATCH_H
+#define Z1_SPIKE_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_SPIKE_BATCH_MAX_ENTRIES  128  // Entries per batch before early flush
+#define Z1_SPIKE_BATCH_MAX_GROUPS   16   // Distinct destination masks batched at once
+#define Z1_SPIKE_BATCH_MAX_NODES    16   // Credit accounts (node IDs 0-15)
+
+#define Z1_SPIKE_BATCH_HEADER_SIZE  sizeof(z1_spike_batch_header_t)
+#define Z1_SPIKE_BATCH_ENTRY_SIZE   sizeof(z1_spike_batch_entry_t)
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Initialize batch builder
+ *
+ * @param node_id This node's ID (source node of all batches)
+ * @param timestep_us Timestep used to encode dt_steps
+ */
+void z1_spike_batch_init(uint8_t node_id, uint32_t timestep_us);
+
+/**
+ * Drop pending batches and reset credit for a new run
+ *
+ * @param credits true to pace sends by credit (free-running runs)
+ */
+void z1_spike_batch_start(bool credits);
+
+/**
+ * Add a local spike for the nodes in dest_mask
+ *
+ * Spikes with the same mask share a batch. A batch is flushed early when
+ * it is full, and the fullest one when every group is in use; both are
+ * sent even without credit.
+ *
+ * @param dest_mask Destination node mask
+ * @param local_id Local ID of the firing neuron
+ * @param timestamp_us Spike timestamp
+ */
+void z1_spike_batch_add(uint16_t dest_mask, uint16_t local_id, uint32_t timestamp_us);
+
+/**
+ * Add a local spike for the controller, to be relayed to other backplanes
+ *
+ * A full gateway batch is sent at once.
+ *
+ * @param local_id Local ID of the firing neuron
+ * @param timestamp_us Spike timestamp
+ */
+void z1_spike_batch_add_gateway(uint16_t local_id, uint32_t timestamp_us);
+
+/**
+ * Send all pending batches (one transaction per destination mask)
+ *
+ * Destinations short of credit keep their batch for the next flush.
+ *
+ * @return Number of batches sent to all their destinations
+ */
+uint8_t z1_spike_batch_flush(void);
+
+/**
+ * Take credit returned by a destination (Z1_CMD_SNN_CREDIT)
+ *
+ * @param node Destination that sent the credit
+ * @param units Credit in Z1_SNN_CREDIT_UNIT spikes
+ */
+void z1_spike_batch_credit(uint8_t node, uint8_t units);
+
+/**
+ * Count a received spike off the spike queue (consumed or dropped)
+ *
+ * Callable from either core. Spikes of this node and spikes relayed from
+ * other backplanes are ignored.
+ *
+ * @param source_id Global ID of the spike's source
+ */
+void z1_spike_batch_consumed(uint32_t source_id);
+
+/**
+ * Return credit for consumed spikes to their senders (bus-owning core)
+ *
+ * One Z1_CMD_SNN_CREDIT per sender owed at least Z1_SNN_CREDIT_UNIT.
+ *
+ * @return Number of credit frames sent
+ */
+uint8_t z1_spike_batch_return_credits(void);
+
+/**
+ * Get batch statistics
+ *
+ * @param batches_sent Pointer to receive number of bus transactions sent
+ * @param spikes_sent Pointer to receive number of spike entries sent
+ * @param send_errors Pointer to receive number of failed transfers
+ * @param multicasts Pointer to receive number of transactions sent as multicast
+ */
+void z1_spike_batch_get_stats(uint32_t* batches_sent, uint32_t* spikes_sent, uint32_t* send_errors,
+                              uint32_t* multicasts);
+
+/**
+ * Get credit statistics
+ *
+ * @param stalls Pointer to receive number of times a destination's batch was held for credit
+ * @param overdrafts Pointer to receive number of sends made without enough credit
+ */
+void z1_spike_batch_get_credit_stats(uint32_t* stalls, uint32_t* overdrafts);
+
+#endif // Z1_SPIKE_BATCH_H
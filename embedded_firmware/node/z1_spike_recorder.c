@@ -0,0 +1,194 @@
+/**
+ * Z1 Spike Recorder
+ *
+ * The writer (stepping core) publishes records by advancing g_rec.head
+ * after their PSRAM write; the reader (bus core) only trusts records the
+ * writer cannot have started to overwrite.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_spike_recorder.h"
+#include "z1_snn_engine.h"
+#include "psram_rp2350.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    uint32_t base;                  // PSRAM address of the ring
+    uint32_t capacity;              // Records (power of 2)
+    volatile uint32_t head;         // Records ever published
+    uint32_t read_seq;              // Next record for GET_SPIKES
+    uint32_t overruns;
+    bool output_only;
+
+    z1_spike_raster_t stage[Z1_SPIKE_REC_STAGE];
+    uint16_t staged;
+} z1_spike_recorder_t;
+
+static z1_spike_recorder_t g_rec;
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+/**
+ * Set up the ring in PSRAM
+ */
+bool z1_spike_recorder_init(uint32_t psram_addr, uint32_t size_bytes) {
+    memset(&g_rec, 0, sizeof(g_rec));
+
+    uint32_t records = size_bytes / sizeof(z1_spike_raster_t);
+    if (records == 0) {
+        printf("[Recorder] ERROR: No PSRAM for the spike raster\n");
+        return false;
+    }
+    g_rec.capacity = 1u << (31 - __builtin_clz(records));
+    g_rec.base = psram_addr;
+    return true;
+}
+
+/**
+ * Empty the ring and choose what is recorded
+ */
+void z1_spike_recorder_reset(bool output_only) {
+    g_rec.head = 0;
+    g_rec.read_seq = 0;
+    g_rec.overruns = 0;
+    g_rec.staged = 0;
+    g_rec.output_only = output_only;
+}
+
+/**
+ * Record a spike
+ */
+void z1_spike_recorder_add(uint16_t local_id, uint16_t flags, uint32_t step) {
+    if (g_rec.capacity == 0 || (g_rec.output_only && !(flags & Z1_NEURON_FLAG_OUTPUT))) {
+        return;
+    }
+
+    g_rec.stage[g_rec.staged++] = z1_spike_raster_pack(local_id, step);
+    if (g_rec.staged == Z1_SPIKE_REC_STAGE) {
+        z1_spike_recorder_flush();
+    }
+}
+
+/**
+ * Write staged records to PSRAM
+ */
+void z1_spike_recorder_flush(void) {
+    uint16_t n = g_rec.staged;
+    if (n == 0) {
+        return;
+    }
+
+    uint32_t index = g_rec.head & (g_rec.capacity - 1);
+    uint32_t first = g_rec.capacity - index;
+    if (first > n) {
+        first = n;
+    }
+
+    psram_write(g_rec.base + index * sizeof(z1_spike_raster_t), g_rec.stage,
+                first * sizeof(z1_spike_raster_t));
+    if (n > first) {
+        psram_write(g_rec.base, &g_rec.stage[first], (n - first) * sizeof(z1_spike_raster_t));
+    }
+
+    // Publish only after the records are in PSRAM
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    g_rec.head += n;
+    g_rec.staged = 0;
+}
+
+// ============================================================================
+// Readback
+// ============================================================================
+
+/**
+ * Copy unread records out of the ring and advance the read cursor
+ */
+uint16_t z1_spike_recorder_read(bool rewind, z1_spike_raster_header_t* header,
+                                z1_spike_raster_t* records, uint16_t max_records) {
+    uint32_t cap = g_rec.capacity;
+    uint32_t head = g_rec.head;
+    uint32_t oldest = (head > cap) ? head - cap : 0;
+    uint8_t flags = g_rec.output_only ? Z1_SPIKE_RASTER_OUTPUT_ONLY : 0;
+
+    if (rewind) {
+        g_rec.read_seq = oldest;
+    } else if (g_rec.read_seq < oldest) {
+        g_rec.overruns += oldest - g_rec.read_seq;
+        g_rec.read_seq = oldest;
+        flags |= Z1_SPIKE_RASTER_OVERRUN;
+    }
+
+    uint32_t n = head - g_rec.read_seq;
+    if (n > max_records) {
+        n = max_records;
+    }
+
+    if (n > 0) {
+        uint32_t index = g_rec.read_seq & (cap - 1);
+        uint32_t first = (cap - index < n) ? cap - index : n;
+        psram_read(g_rec.base + index * sizeof(z1_spike_raster_t), records,
+                   first * sizeof(z1_spike_raster_t));
+        if (n > first) {
+            psram_read(g_rec.base, &records[first], (n - first) * sizeof(z1_spike_raster_t));
+        }
+    }
+
+    // Drop records the writer may have overwritten during the copy,
+    // including a flush that is in progress but not yet published
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint32_t head_after = g_rec.head;
+    uint32_t reach = head_after + Z1_SPIKE_REC_STAGE;
+    uint32_t safe_from = (reach > cap) ? reach - cap : 0;
+    if (safe_from > g_rec.read_seq) {
+        uint32_t skip = safe_from - g_rec.read_seq;
+        if (skip > n) {
+            skip = n;
+        }
+        memmove(records, &records[skip], (n - skip) * sizeof(z1_spike_raster_t));
+        n -= skip;
+        g_rec.read_seq += skip;
+        g_rec.overruns += skip;
+        flags |= Z1_SPIKE_RASTER_OVERRUN;
+    }
+
+    header->first_seq = g_rec.read_seq;
+    header->count = (uint16_t)n;
+    header->flags = flags;
+    header->reserved = 0;
+    g_rec.read_seq += n;
+
+    uint32_t pending = head_after - g_rec.read_seq;
+    header->pending = (pending > cap) ? cap : pending;
+    return (uint16_t)n;
+}
+
+/**
+ * Move the read cursor back
+ */
+void z1_spike_recorder_seek(uint32_t seq) {
+    if (seq <= g_rec.head) {
+        g_rec.read_seq = seq;
+    }
+}
+
+/**
+ * Get recorder statistics
+ */
+void z1_spike_recorder_get_stats(z1_spike_recorder_stats_t* stats) {
+    uint32_t head = g_rec.head;
+    uint32_t unread = head - g_rec.read_seq;
+
+    stats->capacity = g_rec.capacity;
+    stats->recorded = head;
+    stats->unread = (unread > g_rec.capacity) ? g_rec.capacity : unread;
+    stats->overruns = g_rec.overruns;
+    stats->output_only = g_rec.output_only;
+}
@@ -0,0 +1,109 @@
+/**
+ * Z1 Spike Recorder
+ *
+ * Spike raster of this node in the PSRAM raster region: a ring of 4-byte
+ * (timestep, local ID) records (z1_spike_raster_t). Spikes gather in a
+ * small SRAM stage during the neuron sweep and go to PSRAM in one write
+ * per timestep. Z1_CMD_SNN_GET_SPIKES reads the ring back in bulk with a
+ * consuming cursor; once the ring wraps the oldest records are lost and
+ * the next read reports an overrun.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SPIKE_RECORDER_H
+#define Z1_SPIKE_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_SPIKE_REC_STAGE      64      // SRAM records per PSRAM write
+
+#ifndef Z1_SPIKE_REC_READ_MAX
+#define Z1_SPIKE_REC_READ_MAX   1000    // Records per GET_SPIKES response (4 KB)
+#endif
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Recorder statistics
+ */
+typedef struct {
+    uint32_t capacity;       // Records the ring holds
+    uint32_t recorded;       // Records written since start
+    uint32_t unread;         // Records written but not yet read (capped at capacity)
+    uint32_t overruns;       // Records overwritten before they were read
+    bool output_only;        // Recording only output neurons
+} z1_spike_recorder_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Set up the ring in PSRAM
+ *
+ * @param psram_addr Ring base (raster region of the PSRAM layout)
+ * @param size_bytes Region size; the ring uses the largest power-of-two record count that fits
+ * @return false if the region holds no records
+ */
+bool z1_spike_recorder_init(uint32_t psram_addr, uint32_t size_bytes);
+
+/**
+ * Empty the ring and choose what is recorded (call before a run)
+ *
+ * @param output_only Record only neurons with Z1_NEURON_FLAG_OUTPUT
+ */
+void z1_spike_recorder_reset(bool output_only);
+
+/**
+ * Record a spike (stepping core, during the sweep)
+ *
+ * @param local_id Local neuron ID
+ * @param flags Neuron flags (checked against the output-only filter)
+ * @param step Timestep the neuron fired in
+ */
+void z1_spike_recorder_add(uint16_t local_id, uint16_t flags, uint32_t step);
+
+/**
+ * Write staged records to PSRAM (stepping core, end of each step)
+ */
+void z1_spike_recorder_flush(void);
+
+/**
+ * Copy unread records out of the ring and advance the read cursor
+ *
+ * Safe against a concurrent writer on the other core: records overwritten
+ * while they were copied are dropped and reported as an overrun.
+ *
+ * @param rewind Restart from the oldest record still in the ring
+ * @param header Response header to fill (current_step is left to the caller)
+ * @param records Output array
+ * @param max_records Array capacity
+ * @return Records copied
+ */
+uint16_t z1_spike_recorder_read(bool rewind, z1_spike_raster_header_t* header,
+                                z1_spike_raster_t* records, uint16_t max_records);
+
+/**
+ * Move the read cursor back, e.g. to resend a response that did not arrive
+ *
+ * @param seq Sequence number to read from next (first_seq of that response)
+ */
+void z1_spike_recorder_seek(uint32_t seq);
+
+/**
+ * Get recorder statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_spike_recorder_get_stats(z1_spike_recorder_stats_t* stats);
+
+#endif // Z1_SPIKE_RECORDER_H
@@ -0,0 +1,109 @@
+/**
+ * Z1 Spike Ring
+ *
+ * Lock-free single-producer/single-consumer ring used to pass spike
+ * events between core0 (bus, multiframe) and core1 (SNN integration).
+ * One core may only push and the other may only pop.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SPIKE_RING_H
+#define Z1_SPIKE_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_SPIKE_RING_SIZE  256  // Entries per ring (power of two)
+
+// Record types
+#define Z1_RING_SPIKE       0x01  // Ingress: source spike to deliver (neuron_id = global source)
+#define Z1_RING_INJECT      0x02  // Ingress: add value to local neuron (neuron_id = local)
+#define Z1_RING_ROUTE       0x03  // Egress: send spike to nodes in dest_mask
+#define Z1_RING_INPUT       0x04  // Ingress: input batch in slot neuron_id (engine-owned buffers)
+#define Z1_RING_GATEWAY     0x05  // Egress: send spike to the controller (other backplanes)
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Ring record (16 bytes)
+ */
+typedef struct {
+    uint32_t neuron_id;      // Global or local neuron ID (see record type)
+    uint32_t timestamp_us;   // Spike timestamp
+    float    value;          // Injected value (Z1_RING_INJECT)
+    uint16_t dest_mask;      // Destination nodes (Z1_RING_ROUTE)
+    uint8_t  type;           // Record type
+    uint8_t  flags;          // Spike flags
+} z1_ring_spike_t;
+
+/**
+ * SPSC ring
+ *
+ * head is written only by the consumer, tail only by the producer.
+ */
+typedef struct {
+    z1_ring_spike_t entries[Z1_SPIKE_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;   // Pushes rejected because the ring was full
+} z1_spike_ring_t;
+
+// ============================================================================
+// Ring Operations
+// ============================================================================
+
+static inline void z1_spike_ring_init(z1_spike_ring_t* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+}
+
+/**
+ * Push record (producer side)
+ *
+ * @return false if the ring is full
+ */
+static inline bool z1_spike_ring_push(z1_spike_ring_t* ring, const z1_ring_spike_t* rec) {
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= Z1_SPIKE_RING_SIZE) {
+        ring->dropped++;
+        return false;
+    }
+
+    ring->entries[tail & (Z1_SPIKE_RING_SIZE - 1)] = *rec;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Pop record (consumer side)
+ *
+ * @return false if the ring is empty
+ */
+static inline bool z1_spike_ring_pop(z1_spike_ring_t* ring, z1_ring_spike_t* rec) {
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *rec = ring->entries[head & (Z1_SPIKE_RING_SIZE - 1)];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline uint32_t z1_spike_ring_count(const z1_spike_ring_t* ring) {
+    return ring->tail - ring->head;
+}
+
+#endif // Z1_SPIKE_RING_H
@@ -0,0 +1,168 @@
+/**
+ * Z1 TDMA Spike Exchange
+ *
+ * A node's rank is the number of scheduled nodes with a lower ID; its slot
+ * window opens guard_us + rank * slot_us after the tick. Every tick resets
+ * the round, so a repeated tick reopens the slots and a node whose marker
+ * was lost sends it again in turn.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_spike_tdma.h"
+#include "z1_trace.h"
+#include "pico/stdlib.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+typedef struct {
+    uint8_t node_id;
+    bool configured;
+    bool enabled;
+    z1_snn_tdma_config_t config;
+    uint16_t earlier_mask;          // Nodes whose slots come before ours
+    uint32_t window_us;             // Tick to the start of our window
+    uint32_t round_us;              // Time of the last tick
+    uint16_t done_mask;             // Markers seen this round
+    bool round_open;                // Tick seen, our slot not yet closed
+    bool started;                   // Our slot started this round
+    z1_spike_tdma_stats_t stats;
+} z1_spike_tdma_t;
+
+static z1_spike_tdma_t g_tdma;
+
+// ============================================================================
+// Schedule
+// ============================================================================
+
+/**
+ * Set this node's ID and clear the schedule
+ */
+void z1_spike_tdma_init(uint8_t node_id) {
+    memset(&g_tdma, 0, sizeof(g_tdma));
+    g_tdma.node_id = node_id;
+}
+
+/**
+ * Take the schedule sent with Z1_CMD_SNN_TDMA
+ */
+bool z1_spike_tdma_configure(const z1_snn_tdma_config_t* config) {
+    uint16_t self = 1u << g_tdma.node_id;
+
+    if (!(config->node_mask & self) || config->slot_us == 0) {
+        printf("[TDMA] ERROR: No slot for node %d in mask 0x%04X (slot %u us)\n",
+               g_tdma.node_id, config->node_mask, config->slot_us);
+        g_tdma.configured = false;
+        return false;
+    }
+
+    g_tdma.config = *config;
+    g_tdma.earlier_mask = config->node_mask & (self - 1);
+    uint32_t rank = __builtin_popcount(g_tdma.earlier_mask);
+    g_tdma.window_us = config->guard_us + rank * config->slot_us;
+    g_tdma.configured = true;
+
+    printf("[TDMA] Slot %u of %d, window at +%u us, %u us per slot\n",
+           (unsigned int)rank, __builtin_popcount(config->node_mask),
+           (unsigned int)g_tdma.window_us, config->slot_us);
+    return true;
+}
+
+/**
+ * Switch slotted sending on or off for the next run
+ */
+bool z1_spike_tdma_enable(bool enabled) {
+    if (enabled && !g_tdma.configured) {
+        printf("[TDMA] WARNING: No schedule received, sending on contention\n");
+        enabled = false;
+    }
+    g_tdma.enabled = enabled;
+    g_tdma.round_open = false;
+    memset(&g_tdma.stats, 0, sizeof(g_tdma.stats));
+    return enabled;
+}
+
+/**
+ * Check whether slotted sending is on
+ */
+bool z1_spike_tdma_enabled(void) {
+    return g_tdma.enabled;
+}
+
+// ============================================================================
+// Rounds
+// ============================================================================
+
+/**
+ * Open a round
+ */
+void z1_spike_tdma_round_start(void) {
+    if (!g_tdma.enabled) {
+        return;
+    }
+    g_tdma.round_us = time_us_32();
+    g_tdma.done_mask = 0;
+    g_tdma.started = false;
+    g_tdma.round_open = true;
+    g_tdma.stats.rounds++;
+}
+
+/**
+ * Record another node's marker
+ */
+void z1_spike_tdma_slot_done(uint8_t data) {
+    uint8_t node = data >> 4;
+    if (g_tdma.enabled && node < Z1_MAX_NODES) {
+        g_tdma.done_mask |= 1u << node;
+    }
+}
+
+/**
+ * Check whether this node may send now
+ */
+bool z1_spike_tdma_my_turn(void) {
+    if (!g_tdma.enabled || !g_tdma.round_open) {
+        return false;
+    }
+    if (g_tdma.started) {
+        return true;
+    }
+
+    // The marker of the node before us usually opens our slot long before
+    // the window; the window covers a node that missed the tick or stalled
+    if ((g_tdma.done_mask & g_tdma.earlier_mask) == g_tdma.earlier_mask) {
+        g_tdma.stats.marker_starts++;
+    } else if (time_us_32() - g_tdma.round_us >= g_tdma.window_us) {
+        g_tdma.stats.window_starts++;
+    } else {
+        return false;
+    }
+    g_tdma.started = true;
+    return true;
+}
+
+/**
+ * Close this node's slot
+ */
+void z1_spike_tdma_finish(void) {
+    uint32_t elapsed = time_us_32() - g_tdma.round_us;
+
+    // Past the window the next node may already be sending; the bus claim
+    // still keeps the transfers apart, only the bound on latency is lost
+    if (elapsed > g_tdma.window_us + g_tdma.config.slot_us) {
+        g_tdma.stats.overruns++;
+        Z1_TRACE(SNN, Z1_TRACE_INFO, Z1_EV_SNN_SLOT_OVERRUN, g_tdma.node_id, elapsed);
+    }
+    g_tdma.round_open = false;
+}
+
+/**
+ * Read the schedule statistics
+ */
+void z1_spike_tdma_get_stats(z1_spike_tdma_stats_t* stats) {
+    *stats = g_tdma.stats;
+}
@@ -0,0 +1,104 @@
+/**
+ * Z1 TDMA Spike Exchange
+ *
+ * Slot schedule for the spike exchange of a barrier run started with
+ * Z1_SNN_START_TDMA (see z1_protocol.h). Each Z1_CMD_SNN_TICK opens a round;
+ * the node may send its spike batches and its Z1_CMD_SNN_SLOT_DONE marker
+ * only while z1_spike_tdma_my_turn() holds, which is once every node ranked
+ * before it has sent its marker, or once its slot window has opened without
+ * them.
+ *
+ * All calls run in the main loop (ticks and markers from z1_bus_rx_dispatch()).
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SPIKE_TDMA_H
+#define Z1_SPIKE_TDMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/z1_protocol.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#ifndef Z1_SNN_SLOT_DONE_HOLD_US
+#define Z1_SNN_SLOT_DONE_HOLD_US    100     // BUSATTN hold of a Z1_CMD_SNN_SLOT_DONE broadcast
+#endif
+
+/**
+ * Schedule statistics (since z1_spike_tdma_enable())
+ */
+typedef struct {
+    uint32_t rounds;                // Ticks seen, repeats included
+    uint32_t marker_starts;         // Slots started on the previous node's marker
+    uint32_t window_starts;         // Slots started when the window opened
+    uint32_t overruns;              // Slots closed after their window
+} z1_spike_tdma_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Set this node's ID and clear the schedule
+ *
+ * @param node_id This node's bus ID
+ */
+void z1_spike_tdma_init(uint8_t node_id);
+
+/**
+ * Take the schedule sent with Z1_CMD_SNN_TDMA
+ *
+ * @param config Schedule (node_mask must include this node)
+ * @return true if the schedule was accepted
+ */
+bool z1_spike_tdma_configure(const z1_snn_tdma_config_t* config);
+
+/**
+ * Switch slotted sending on or off for the next run
+ *
+ * @param enabled true to send only in this node's slot
+ * @return true if slotted sending is on (a schedule has been configured)
+ */
+bool z1_spike_tdma_enable(bool enabled);
+
+/**
+ * Check whether slotted sending is on
+ */
+bool z1_spike_tdma_enabled(void);
+
+/**
+ * Open a round (Z1_CMD_SNN_TICK)
+ */
+void z1_spike_tdma_round_start(void);
+
+/**
+ * Record another node's marker (Z1_CMD_SNN_SLOT_DONE)
+ *
+ * @param data Marker data byte (z1_snn_slot_done_data())
+ */
+void z1_spike_tdma_slot_done(uint8_t data);
+
+/**
+ * Check whether this node may send now
+ *
+ * @return true from the start of this node's slot until z1_spike_tdma_finish()
+ */
+bool z1_spike_tdma_my_turn(void);
+
+/**
+ * Close this node's slot after its marker went out
+ */
+void z1_spike_tdma_finish(void);
+
+/**
+ * Read the schedule statistics
+ *
+ * @param stats Output statistics
+ */
+void z1_spike_tdma_get_stats(z1_spike_tdma_stats_t* stats);
+
+#endif // Z1_SPIKE_TDMA_H
@@ -0,0 +1,129 @@
+/**
+ * Z1 Spike Wheel
+ *
+ * Bucketed timing wheel for synaptic delays.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_spike_wheel.h"
+#include <string.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+#define WHEEL_NIL  0xFFFF
+
+typedef struct {
+    uint16_t target;     // Local target neuron
+    uint16_t next;       // Next event in slot or free list
+    uint8_t  weight;     // Encoded weight
+} z1_wheel_event_t;
+
+static z1_wheel_event_t g_events[Z1_SPIKE_WHEEL_EVENTS];
+static uint16_t g_slot_head[Z1_SPIKE_WHEEL_SLOTS];
+static uint16_t g_free_head = WHEEL_NIL;
+static uint8_t g_current = 0;
+static z1_spike_wheel_stats_t g_wheel_stats = {0};
+
+// ============================================================================
+// Wheel Functions
+// ============================================================================
+
+/**
+ * Initialize wheel
+ */
+void z1_spike_wheel_init(void) {
+    for (uint16_t i = 0; i < Z1_SPIKE_WHEEL_EVENTS; i++) {
+        g_events[i].next = (i + 1 < Z1_SPIKE_WHEEL_EVENTS) ? i + 1 : WHEEL_NIL;
+    }
+    g_free_head = 0;
+
+    for (uint8_t s = 0; s < Z1_SPIKE_WHEEL_SLOTS; s++) {
+        g_slot_head[s] = WHEEL_NIL;
+    }
+    g_current = 0;
+
+    memset(&g_wheel_stats, 0, sizeof(g_wheel_stats));
+}
+
+/**
+ * Schedule a target update
+ */
+bool z1_spike_wheel_schedule(uint8_t delay_steps, uint16_t target, uint8_t weight) {
+    if (delay_steps == 0 || delay_steps >= Z1_SPIKE_WHEEL_SLOTS) {
+        return false;
+    }
+
+    uint16_t e = g_free_head;
+    if (e == WHEEL_NIL) {
+        g_wheel_stats.overflows++;
+        return false;
+    }
+    g_free_head = g_events[e].next;
+
+    // Order within a slot does not matter (updates are additive), so push at head
+    uint8_t slot = (g_current + delay_steps) & (Z1_SPIKE_WHEEL_SLOTS - 1);
+    g_events[e].target = target;
+    g_events[e].weight = weight;
+    g_events[e].next = g_slot_head[slot];
+    g_slot_head[slot] = e;
+
+    g_wheel_stats.scheduled++;
+    g_wheel_stats.pending++;
+    if (g_wheel_stats.pending > g_wheel_stats.peak) {
+        g_wheel_stats.peak = g_wheel_stats.pending;
+    }
+
+    return true;
+}
+
+/**
+ * Pop next update due now
+ */
+bool z1_spike_wheel_pop(uint16_t* target, uint8_t* weight) {
+    uint16_t e = g_slot_head[g_current];
+    if (e == WHEEL_NIL) {
+        return false;
+    }
+
+    *target = g_events[e].target;
+    *weight = g_events[e].weight;
+
+    g_slot_head[g_current] = g_events[e].next;
+    g_events[e].next = g_free_head;
+    g_free_head = e;
+    g_wheel_stats.pending--;
+
+    return true;
+}
+
+/**
+ * Advance to the next timestep
+ */
+void z1_spike_wheel_advance(void) {
+    uint8_t next = (g_current + 1) & (Z1_SPIKE_WHEEL_SLOTS - 1);
+
+    // Carry over anything not drained (splice onto the next slot)
+    uint16_t e = g_slot_head[g_current];
+    if (e != WHEEL_NIL) {
+        while (g_events[e].next != WHEEL_NIL) {
+            e = g_events[e].next;
+        }
+        g_events[e].next = g_slot_head[next];
+        g_slot_head[next] = g_slot_head[g_current];
+        g_slot_head[g_current] = WHEEL_NIL;
+    }
+
+    g_current = next;
+}
+
+/**
+ * Get wheel statistics
+ */
+void z1_spike_wheel_get_stats(z1_spike_wheel_stats_t* stats) {
+    if (stats) {
+        *stats = g_wheel_stats;
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * Z1 Spike Wheel
+ *
+ * Timing wheel for delayed synaptic delivery. Slot k holds the target
+ * updates due k timesteps after the current one; each slot is a linked
+ * list over a shared event pool, so schedule and pop are O(1).
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SPIKE_WHEEL_H
+#define Z1_SPIKE_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_SPIKE_WHEEL_SLOTS    16     // Timesteps on the wheel (power of two, > max delay)
+#define Z1_SPIKE_WHEEL_EVENTS   2048   // Pending target updates across all slots
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Wheel statistics
+ */
+typedef struct {
+    uint16_t pending;        // Events currently on the wheel
+    uint16_t peak;           // Highest pending count seen
+    uint32_t scheduled;      // Events scheduled
+    uint32_t overflows;      // Events rejected because the pool was full
+} z1_spike_wheel_stats_t;
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Initialize wheel (drops all pending events)
+ */
+void z1_spike_wheel_init(void);
+
+/**
+ * Schedule a target update
+ *
+ * @param delay_steps Timesteps from now (1 to Z1_SPIKE_WHEEL_SLOTS - 1)
+ * @param target Local target neuron ID
+ * @param weight Encoded synapse weight
+ * @return false if the delay is out of range or the pool is full
+ */
+bool z1_spike_wheel_schedule(uint8_t delay_steps, uint16_t target, uint8_t weight);
+
+/**
+ * Pop next update due in the current timestep
+ *
+ * @param target Pointer to receive local target neuron ID
+ * @param weight Pointer to receive encoded synapse weight
+ * @return false when the current slot is empty
+ */
+bool z1_spike_wheel_pop(uint16_t* target, uint8_t* weight);
+
+/**
+ * Advance to the next timestep
+ *
+ * The current slot should be drained first; anything left is carried
+ * over into the next slot.
+ */
+void z1_spike_wheel_advance(void);
+
+/**
+ * Get wheel statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_spike_wheel_get_stats(z1_spike_wheel_stats_t* stats);
+
+#endif // Z1_SPIKE_WHEEL_H
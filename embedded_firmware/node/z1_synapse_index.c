@@ -0,0 +1,369 @@
+/**
+ * Z1 Synapse Index
+ *
+ * Builds and queries the inverted connectivity index used for
+ * event-driven spike delivery.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_synapse_index.h"
+#include "z1_psram_neurons.h"
+#include "psram_rp2350.h"
+#include <string.h>
+#include <stdio.h>
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+// Directory has one extra sentinel row so row i ends at dir[i + 1].first
+static z1_synapse_index_dir_t g_index_dir[Z1_SYNAPSE_INDEX_MAX_SOURCES + 1];
+static z1_synapse_index_stats_t g_index_stats = {0};
+
+#if Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES > 0
+// SRAM copy of the target entries while g_index_stats.resident is set
+static z1_synapse_target_t g_index_resident[Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES];
+#endif
+
+// ============================================================================
+// Directory Helpers
+// ============================================================================
+
+/**
+ * Binary search for source ID
+ *
+ * @return Row index if found, otherwise -(insert position) - 1
+ */
+static int32_t dir_search(uint32_t source_id) {
+    int32_t lo = 0;
+    int32_t hi = (int32_t)g_index_stats.source_count - 1;
+
+    while (lo <= hi) {
+        int32_t mid = (lo + hi) >> 1;
+        uint32_t mid_id = g_index_dir[mid].source_id;
+
+        if (mid_id == source_id) {
+            return mid;
+        } else if (mid_id < source_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return -lo - 1;
+}
+
+/**
+ * Find or insert source row (build time only)
+ *
+ * @return Row index, or -1 if the directory is full
+ */
+static int32_t dir_get_or_insert(uint32_t source_id) {
+    int32_t pos = dir_search(source_id);
+    if (pos >= 0) {
+        return pos;
+    }
+
+    if (g_index_stats.source_count >= Z1_SYNAPSE_INDEX_MAX_SOURCES) {
+        return -1;
+    }
+
+    pos = -pos - 1;
+    memmove(&g_index_dir[pos + 1], &g_index_dir[pos],
+            (g_index_stats.source_count - pos) * sizeof(z1_synapse_index_dir_t));
+    g_index_dir[pos].source_id = source_id;
+    g_index_dir[pos].first = 0;  // Used as a counter during pass 1
+    g_index_stats.source_count++;
+
+    return pos;
+}
+
+// ============================================================================
+// Index Build
+// ============================================================================
+
+/**
+ * Clear index
+ */
+void z1_synapse_index_clear(void) {
+    memset(&g_index_stats, 0, sizeof(g_index_stats));
+    g_index_dir[0].first = 0;
+}
+
+/**
+ * Build index from the loaded neuron table
+ */
+bool z1_synapse_index_build(uint32_t base_addr, uint32_t max_entries, uint16_t neuron_count) {
+    uint32_t synapses[Z1_NEURON_SYNAPSE_CAPACITY];
+
+    z1_synapse_index_clear();
+    g_index_stats.base_addr = base_addr;
+
+    // Pass 1: collect distinct sources and count targets per source
+    uint32_t total = 0;
+    for (uint16_t n = 0; n < neuron_count; n++) {
+        // Rows longer than the buffer (v2 tables) are read in pieces
+        int count;
+        for (uint16_t start = 0; ; start += count) {
+            count = z1_psram_read_neuron_synapses(n, start, synapses, Z1_NEURON_SYNAPSE_CAPACITY);
+            if (count < 0) {
+                printf("[Synapse Index] ERROR: Failed to read synapses of neuron %d\n", n);
+                return false;
+            }
+
+            for (int s = 0; s < count; s++) {
+                int32_t row = dir_get_or_insert(z1_synapse_get_id(synapses[s]));
+                if (row < 0) {
+                    printf("[Synapse Index] ERROR: More than %d distinct sources\n",
+                           Z1_SYNAPSE_INDEX_MAX_SOURCES);
+                    z1_synapse_index_clear();
+                    return false;
+                }
+                g_index_dir[row].first++;
+                total++;
+            }
+
+            if (count < Z1_NEURON_SYNAPSE_CAPACITY) {
+                break;
+            }
+        }
+    }
+
+    if (total > max_entries) {
+        printf("[Synapse Index] ERROR: %u entries exceed capacity %u\n",
+               (unsigned int)total, (unsigned int)max_entries);
+        z1_synapse_index_clear();
+        return false;
+    }
+
+    // Turn counts into row end offsets; pass 2 decrements them to row starts
+    uint32_t offset = 0;
+    for (uint16_t i = 0; i < g_index_stats.source_count; i++) {
+        offset += g_index_dir[i].first;
+        g_index_dir[i].first = offset;
+    }
+    g_index_dir[g_index_stats.source_count].source_id = 0xFFFFFFFF;
+    g_index_dir[g_index_stats.source_count].first = total;
+
+    // Pass 2: scatter target entries into their rows
+    for (uint16_t n = 0; n < neuron_count; n++) {
+        int count;
+        for (uint16_t start = 0; ; start += count) {
+            count = z1_psram_read_neuron_synapses(n, start, synapses, Z1_NEURON_SYNAPSE_CAPACITY);
+            if (count < 0) {
+                z1_synapse_index_clear();
+                return false;
+            }
+
+            for (int s = 0; s < count; s++) {
+                int32_t row = dir_search(z1_synapse_get_id(synapses[s]));
+                uint32_t pos = --g_index_dir[row].first;
+                uint8_t slot = (start + s < Z1_SYNAPSE_TARGET_SLOT_NONE) ?
+                               (uint8_t)(start + s) : Z1_SYNAPSE_TARGET_SLOT_NONE;
+                z1_synapse_target_t entry = z1_synapse_target_pack(n, slot,
+                                                                   z1_synapse_get_delay(synapses[s]),
+                                                                   z1_synapse_get_weight(synapses[s]));
+
+                if (!psram_write(base_addr + pos * Z1_SYNAPSE_INDEX_ENTRY_SIZE, &entry, sizeof(entry))) {
+                    printf("[Synapse Index] ERROR: PSRAM write failed at entry %u\n", (unsigned int)pos);
+                    z1_synapse_index_clear();
+                    return false;
+                }
+            }
+
+            if (count < Z1_NEURON_SYNAPSE_CAPACITY) {
+                break;
+            }
+        }
+    }
+
+    g_index_stats.entry_count = total;
+
+    printf("[Synapse Index] Built: %d sources, %u targets at 0x%08X (%u bytes PSRAM)\n",
+           g_index_stats.source_count, (unsigned int)total, (unsigned int)base_addr,
+           (unsigned int)(total * Z1_SYNAPSE_INDEX_ENTRY_SIZE));
+
+    return true;
+}
+
+/**
+ * Keep the built index resident in SRAM
+ */
+bool z1_synapse_index_make_resident(void) {
+#if Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES > 0
+    uint32_t total = g_index_stats.entry_count;
+    if (g_index_stats.resident || total > Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES) {
+        return g_index_stats.resident;
+    }
+
+    if (total > 0 && !psram_read(g_index_stats.base_addr, g_index_resident,
+                                 total * Z1_SYNAPSE_INDEX_ENTRY_SIZE)) {
+        printf("[Synapse Index] ERROR: PSRAM read for the resident copy failed\n");
+        return false;
+    }
+
+    g_index_stats.resident = true;
+    printf("[Synapse Index] Resident: %u targets (%u bytes SRAM)\n",
+           (unsigned int)total, (unsigned int)(total * Z1_SYNAPSE_INDEX_ENTRY_SIZE));
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Get the resident target entries
+ */
+z1_synapse_target_t* z1_synapse_index_resident(void) {
+#if Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES > 0
+    return g_index_stats.resident ? g_index_resident : NULL;
+#else
+    return NULL;
+#endif
+}
+
+// ============================================================================
+// Index Lookup
+// ============================================================================
+
+/**
+ * Look up targets of a source neuron
+ */
+bool z1_synapse_index_find(uint32_t source_id, uint16_t* row_out, uint32_t* first, uint16_t* count) {
+    g_index_stats.lookups++;
+
+    int32_t row = dir_search(source_id & 0xFFFFFF);
+    if (row < 0) {
+        g_index_stats.misses++;
+        return false;
+    }
+
+    if (row_out) {
+        *row_out = (uint16_t)row;
+    }
+    *first = g_index_dir[row].first;
+    *count = (uint16_t)(g_index_dir[row + 1].first - g_index_dir[row].first);
+    return true;
+}
+
+/**
+ * Get a directory row by position
+ */
+bool z1_synapse_index_get_row(uint16_t row, uint32_t* source_id, uint32_t* first, uint16_t* count) {
+    if (row >= g_index_stats.source_count) {
+        return false;
+    }
+
+    *source_id = g_index_dir[row].source_id;
+    *first = g_index_dir[row].first;
+    *count = (uint16_t)(g_index_dir[row + 1].first - g_index_dir[row].first);
+    return true;
+}
+
+/**
+ * Read target entries (from SRAM when resident)
+ */
+bool z1_synapse_index_read(uint32_t first, z1_synapse_target_t* entries, uint16_t count) {
+    if (first + count > g_index_stats.entry_count) {
+        return false;
+    }
+
+#if Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES > 0
+    if (g_index_stats.resident) {
+        memcpy(entries, &g_index_resident[first], count * Z1_SYNAPSE_INDEX_ENTRY_SIZE);
+        return true;
+    }
+#endif
+    return psram_read(g_index_stats.base_addr + first * Z1_SYNAPSE_INDEX_ENTRY_SIZE,
+                      entries, count * Z1_SYNAPSE_INDEX_ENTRY_SIZE);
+}
+
+/**
+ * Write target entries back to PSRAM, and to SRAM when resident
+ */
+bool z1_synapse_index_write(uint32_t first, const z1_synapse_target_t* entries, uint16_t count) {
+    if (first + count > g_index_stats.entry_count) {
+        return false;
+    }
+
+#if Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES > 0
+    // Entries changed in place through z1_synapse_index_resident() are already there
+    if (g_index_stats.resident && entries != &g_index_resident[first]) {
+        memcpy(&g_index_resident[first], entries, count * Z1_SYNAPSE_INDEX_ENTRY_SIZE);
+    }
+#endif
+    return psram_write(g_index_stats.base_addr + first * Z1_SYNAPSE_INDEX_ENTRY_SIZE,
+                       entries, count * Z1_SYNAPSE_INDEX_ENTRY_SIZE);
+}
+
+/**
+ * Start a DMA read of target entries from PSRAM
+ */
+bool z1_synapse_index_read_async(uint32_t first, z1_synapse_target_t* entries, uint16_t count,
+                                 psram_dma_handle_t* handle) {
+    if (first + count > g_index_stats.entry_count) {
+        return false;
+    }
+
+    return psram_read_async(g_index_stats.base_addr + first * Z1_SYNAPSE_INDEX_ENTRY_SIZE,
+                            entries, count * Z1_SYNAPSE_INDEX_ENTRY_SIZE, handle, NULL, NULL);
+}
+
+/**
+ * Change the weight of one target entry
+ */
+bool z1_synapse_index_set_weight(uint16_t target, uint16_t synapse_idx, uint32_t synapse,
+                                 uint8_t weight) {
+    int32_t row = dir_search(z1_synapse_get_id(synapse));
+    if (row < 0) {
+        return false;
+    }
+
+    // Rows are in descending (target, slot) order, the order pass 2 fills them
+    uint8_t slot = (synapse_idx < Z1_SYNAPSE_TARGET_SLOT_NONE) ?
+                   (uint8_t)synapse_idx : Z1_SYNAPSE_TARGET_SLOT_NONE;
+    uint32_t key = ((uint32_t)target << 6) | slot;
+    uint32_t lo = g_index_dir[row].first;
+    uint32_t hi = g_index_dir[row + 1].first;
+    uint32_t end = hi;
+    z1_synapse_target_t entry;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) >> 1;
+        if (!z1_synapse_index_read(mid, &entry, 1)) {
+            return false;
+        }
+        if ((entry >> 12) > key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Slot-less entries of one target only differ in delay and weight;
+    // any entry that matches both delivers the same input
+    for (uint32_t pos = lo; pos < end; pos++) {
+        if (!z1_synapse_index_read(pos, &entry, 1) || (entry >> 12) != key) {
+            return false;
+        }
+        if (slot != Z1_SYNAPSE_TARGET_SLOT_NONE ||
+            (z1_synapse_target_get_delay(entry) == z1_synapse_get_delay(synapse) &&
+             z1_synapse_target_get_weight(entry) == z1_synapse_get_weight(synapse))) {
+            entry = (entry & 0xFFFFFF00) | weight;
+            return z1_synapse_index_write(pos, &entry, 1);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Get index statistics
+ */
+void z1_synapse_index_get_stats(z1_synapse_index_stats_t* stats) {
+    if (stats) {
+        *stats = g_index_stats;
+    }
+}
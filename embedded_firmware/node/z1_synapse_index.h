@@ -0,0 +1,223 @@
+/**
+ * Z1 Synapse Index
+ *
+ * Inverted connectivity index for event-driven spike delivery.
+ * Maps a source neuron global ID to the list of local target neurons
+ * (and their synapse weights) so an incoming spike only touches the
+ * neurons it actually connects to.
+ *
+ * Layout:
+ *   SRAM  - sorted directory of source IDs with CSR-style row offsets
+ *   PSRAM - packed target entries, placed directly after the neuron table
+ *
+ * An index small enough is also kept resident: an SRAM copy of the target
+ * entries that reads are served from and writes go through to, so
+ * delivery can walk rows in place instead of fetching them.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#ifndef Z1_SYNAPSE_INDEX_H
+#define Z1_SYNAPSE_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "psram_rp2350.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#define Z1_SYNAPSE_INDEX_MAX_SOURCES  2048  // Distinct source neurons per node
+#define Z1_SYNAPSE_INDEX_ENTRY_SIZE   4     // Bytes per target entry in PSRAM
+#define Z1_SYNAPSE_TARGET_SLOT_NONE   0x3F  // Slot field for synapses past slot 62 (v2 rows)
+
+// Target entries the SRAM copy holds (4 bytes each, 0 = never resident).
+// Counted against the engine's Z1_SNN_STATE_SRAM_BUDGET with the neuron state.
+#ifndef Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES
+#define Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES 8192
+#endif
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * Target entry (4 bytes in PSRAM)
+ *
+ * Packed format:
+ *   Bits [31:18] - Target local neuron ID
+ *   Bits [17:12] - Synapse slot in the target's neuron entry (0x3F if >= 63)
+ *   Bits [11:8]  - Delay in timesteps (copied from the synapse)
+ *   Bits [7:0]   - Weight (same 8-bit encoding as the neuron table)
+ */
+typedef uint32_t z1_synapse_target_t;
+
+/**
+ * Directory entry (8 bytes in SRAM)
+ *
+ * Row for source i spans [first, next.first) in the PSRAM entry array.
+ */
+typedef struct {
+    uint32_t source_id;   // Source global ID: (node_id << 16) | local_id
+    uint32_t first;       // Index of first target entry
+} z1_synapse_index_dir_t;
+
+/**
+ * Index statistics
+ */
+typedef struct {
+    uint32_t base_addr;      // PSRAM address of target entries
+    uint16_t source_count;   // Distinct source neurons
+    uint32_t entry_count;    // Total target entries
+    uint32_t lookups;        // Spikes looked up
+    uint32_t misses;         // Spikes with no local targets
+    bool resident;           // Entries also held in SRAM
+} z1_synapse_index_stats_t;
+
+// ============================================================================
+// Entry Helpers
+// ============================================================================
+
+static inline z1_synapse_target_t z1_synapse_target_pack(uint16_t target, uint8_t slot,
+                                                         uint8_t delay, uint8_t weight) {
+    return ((uint32_t)target << 18) | ((uint32_t)(slot & 0x3F) << 12) |
+           ((uint32_t)(delay & 0x0F) << 8) | weight;
+}
+
+static inline uint16_t z1_synapse_target_get_id(z1_synapse_target_t entry) {
+    return entry >> 18;
+}
+
+static inline uint8_t z1_synapse_target_get_slot(z1_synapse_target_t entry) {
+    return (entry >> 12) & 0x3F;
+}
+
+static inline uint8_t z1_synapse_target_get_delay(z1_synapse_target_t entry) {
+    return (entry >> 8) & 0x0F;
+}
+
+static inline uint8_t z1_synapse_target_get_weight(z1_synapse_target_t entry) {
+    return entry & 0xFF;
+}
+
+// ============================================================================
+// Function Prototypes
+// ============================================================================
+
+/**
+ * Build index from the loaded neuron table
+ *
+ * Two passes over the table: the first counts targets per source, the
+ * second writes the packed entries to PSRAM.
+ *
+ * @param base_addr PSRAM address for target entries
+ * @param max_entries Capacity of the PSRAM entry region
+ * @param neuron_count Number of neurons in the loaded table
+ * @return true if successful
+ */
+bool z1_synapse_index_build(uint32_t base_addr, uint32_t max_entries, uint16_t neuron_count);
+
+/**
+ * Keep the built index resident in SRAM
+ *
+ * Copies the target entries into SRAM if they fit in
+ * Z1_SYNAPSE_INDEX_RESIDENT_ENTRIES. The PSRAM entries stay authoritative;
+ * the copy lasts until the next build or clear.
+ *
+ * @return true if the index is resident
+ */
+bool z1_synapse_index_make_resident(void);
+
+/**
+ * Get the resident target entries
+ *
+ * Entry i of the index is element i. Changes made through the pointer
+ * must be written back with z1_synapse_index_write() to reach PSRAM.
+ *
+ * @return SRAM entries, or NULL if the index is not resident
+ */
+z1_synapse_target_t* z1_synapse_index_resident(void);
+
+/**
+ * Clear index (no sources)
+ */
+void z1_synapse_index_clear(void);
+
+/**
+ * Look up targets of a source neuron
+ *
+ * @param source_id Source global ID
+ * @param row Pointer to receive the directory row (may be NULL)
+ * @param first Pointer to receive index of first target entry
+ * @param count Pointer to receive number of target entries
+ * @return true if the source has local targets
+ */
+bool z1_synapse_index_find(uint32_t source_id, uint16_t* row, uint32_t* first, uint16_t* count);
+
+/**
+ * Get a directory row by position
+ *
+ * @param row Directory row (0 to source_count - 1)
+ * @param source_id Pointer to receive the source global ID
+ * @param first Pointer to receive index of first target entry
+ * @param count Pointer to receive number of target entries
+ * @return true if the row exists
+ */
+bool z1_synapse_index_get_row(uint16_t row, uint32_t* source_id, uint32_t* first, uint16_t* count);
+
+/**
+ * Read target entries (from SRAM when resident)
+ *
+ * @param first Index of first entry
+ * @param entries Buffer to receive entries
+ * @param count Number of entries to read
+ * @return true if successful
+ */
+bool z1_synapse_index_read(uint32_t first, z1_synapse_target_t* entries, uint16_t count);
+
+/**
+ * Write target entries back to PSRAM (learned weights), and to SRAM when resident
+ *
+ * @param first Index of first entry
+ * @param entries Entries to write
+ * @param count Number of entries to write
+ * @return true if successful
+ */
+bool z1_synapse_index_write(uint32_t first, const z1_synapse_target_t* entries, uint16_t count);
+
+/**
+ * Start a DMA read of target entries from PSRAM
+ *
+ * @param first Index of first entry
+ * @param entries Buffer to receive entries (must stay valid until complete)
+ * @param count Number of entries to read
+ * @param handle Transfer handle (poll with psram_dma_busy/psram_dma_wait)
+ * @return true if the read was started
+ */
+bool z1_synapse_index_read_async(uint32_t first, z1_synapse_target_t* entries, uint16_t count,
+                                 psram_dma_handle_t* handle);
+
+/**
+ * Change the weight of one target entry (after a weight patch)
+ *
+ * Finds the entry of a target synapse by binary search over its source
+ * row, which is ordered by descending (target, slot).
+ *
+ * @param target Local ID of the neuron holding the synapse
+ * @param synapse_idx Index of the synapse in its row
+ * @param synapse Packed synapse before the patch (source, delay, old weight)
+ * @param weight New weight
+ * @return true if the entry was found and rewritten
+ */
+bool z1_synapse_index_set_weight(uint16_t target, uint16_t synapse_idx, uint32_t synapse,
+                                 uint8_t weight);
+
+/**
+ * Get index statistics
+ *
+ * @param stats Pointer to structure to fill
+ */
+void z1_synapse_index_get_stats(z1_synapse_index_stats_t* stats);
+
+#endif // Z1_SYNAPSE_INDEX_H
@@ -0,0 +1,181 @@
+/**
+ * Z1 Binary Event Trace
+ *
+ * Writers reserve a slot with one atomic increment, so records from the bus
+ * IRQ, the main loop and core1 interleave without locks. A reader can see
+ * a record that is still being filled; that is accepted for diagnostics.
+ *
+ * Copyright NeuroFab Corp. All rights reserved.
+ */
+
+#include "z1_trace.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+#if (Z1_TRACE_RING_SIZE & (Z1_TRACE_RING_SIZE - 1)) != 0
+#error "Z1_TRACE_RING_SIZE must be a power of 2"
+#endif
+
+#define Z1_TRACE_MASK (Z1_TRACE_RING_SIZE - 1)
+
+// ============================================================================
+// Global State
+// ============================================================================
+
+static z1_trace_record_t g_trace_ring[Z1_TRACE_RING_SIZE];
+static volatile uint32_t g_trace_head = 0;      // Records ever written
+static uint32_t g_trace_drain = 0;              // Next record for the stdio drain
+static uint32_t g_trace_dropped = 0;
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+/**
+ * Append a record
+ */
+void z1_trace_record(uint8_t subsystem, uint8_t event, uint16_t arg0, uint32_t arg1) {
+    uint32_t index = __atomic_fetch_add(&g_trace_head, 1, __ATOMIC_RELAXED);
+    z1_trace_record_t* rec = &g_trace_ring[index & Z1_TRACE_MASK];
+
+    rec->timestamp_us = time_us_32();
+    rec->subsystem = subsystem;
+    rec->event = event;
+    rec->arg0 = arg0;
+    rec->arg1 = arg1;
+}
+
+// ============================================================================
+// Readout
+// ============================================================================
+
+static const char* const g_bus_events[] = {
+    [Z1_EV_BUS_CLAIM] = "claim",
+    [Z1_EV_BUS_CLAIM_FAIL] = "claim_fail",
+    [Z1_EV_BUS_BACKOFF] = "backoff",
+    [Z1_EV_BUS_RELEASE] = "release",
+    [Z1_EV_BUS_ACK] = "ack",
+    [Z1_EV_BUS_ACK_TIMEOUT] = "ack_timeout",
+    [Z1_EV_BUS_FRAME] = "frame",
+    [Z1_EV_BUS_WRITE] = "write",
+    [Z1_EV_BUS_WRITE_DONE] = "write_done",
+    [Z1_EV_BUS_BROADCAST] = "broadcast",
+    [Z1_EV_BUS_RX] = "rx",
+    [Z1_EV_BUS_BURST_TX] = "burst_tx",
+    [Z1_EV_BUS_BURST_FAIL] = "burst_fail",
+    [Z1_EV_BUS_MCAST_TX] = "mcast_tx",
+    [Z1_EV_BUS_MCAST_FAIL] = "mcast_fail",
+};
+
+static const char* const g_frame_events[] = {
+    [Z1_EV_FRAME_TX] = "tx",
+    [Z1_EV_FRAME_TX_DONE] = "tx_done",
+    [Z1_EV_FRAME_TX_BURST] = "tx_burst",
+    [Z1_EV_FRAME_TX_FALLBACK] = "tx_fallback",
+    [Z1_EV_FRAME_RX_START] = "rx_start",
+    [Z1_EV_FRAME_RX_LENGTH] = "rx_length",
+    [Z1_EV_FRAME_RX_DONE] = "rx_done",
+    [Z1_EV_FRAME_RX_ERROR] = "rx_error",
+};
+
+static const char* const g_snn_events[] = {
+    [Z1_EV_SNN_QUEUE_FULL] = "queue_full",
+    [Z1_EV_SNN_BATCH_FAIL] = "batch_fail",
+    [Z1_EV_SNN_INJECT] = "inject",
+    [Z1_EV_SNN_TICK_SKIP] = "tick_skip",
+};
+
+static const char* const g_app_events[] = {
+    [Z1_EV_APP_COMMAND] = "command",
+    [Z1_EV_APP_FRAME] = "frame",
+    [Z1_EV_APP_HTTP] = "http",
+    [Z1_EV_APP_MULTIFRAME] = "multiframe",
+};
+
+static const char* const g_subsystem_names[] = {"bus", "frame", "snn", "app"};
+
+/**
+ * Get a short name for an event
+ */
+const char* z1_trace_event_name(uint8_t subsystem, uint8_t event) {
+    const char* const* names = NULL;
+    uint8_t count = 0;
+
+    switch (subsystem) {
+        case Z1_TRACE_SUB_BUS:
+            names = g_bus_events;
+            count = sizeof(g_bus_events) / sizeof(g_bus_events[0]);
+            break;
+        case Z1_TRACE_SUB_FRAME:
+            names = g_frame_events;
+            count = sizeof(g_frame_events) / sizeof(g_frame_events[0]);
+            break;
+        case Z1_TRACE_SUB_SNN:
+            names = g_snn_events;
+            count = sizeof(g_snn_events) / sizeof(g_snn_events[0]);
+            break;
+        case Z1_TRACE_SUB_APP:
+            names = g_app_events;
+            count = sizeof(g_app_events) / sizeof(g_app_events[0]);
+            break;
+    }
+
+    if (!names || event >= count || !names[event]) {
+        return "?";
+    }
+    return names[event];
+}
+
+/**
+ * Print pending records as text
+ */
+uint16_t z1_trace_drain_stdio(uint16_t max_records) {
+    uint32_t head = g_trace_head;
+    uint16_t printed = 0;
+
+    // Skip what the writers have already lapped
+    if (head - g_trace_drain > Z1_TRACE_RING_SIZE) {
+        g_trace_dropped += head - g_trace_drain - Z1_TRACE_RING_SIZE;
+        g_trace_drain = head - Z1_TRACE_RING_SIZE;
+    }
+
+    while (g_trace_drain != head && printed < max_records) {
+        const z1_trace_record_t* rec = &g_trace_ring[g_trace_drain & Z1_TRACE_MASK];
+        const char* sub = (rec->subsystem < 4) ? g_subsystem_names[rec->subsystem] : "?";
+        printf("[Trace %10u] %s.%s 0x%04X 0x%08X\n", (unsigned int)rec->timestamp_us, sub,
+               z1_trace_event_name(rec->subsystem, rec->event),
+               rec->arg0, (unsigned int)rec->arg1);
+        g_trace_drain++;
+        printed++;
+    }
+
+    return printed;
+}
+
+/**
+ * Copy the most recent records, oldest first
+ */
+uint16_t z1_trace_snapshot(z1_trace_record_t* records, uint16_t max_records) {
+    uint32_t head = g_trace_head;
+    uint32_t available = (head < Z1_TRACE_RING_SIZE) ? head : Z1_TRACE_RING_SIZE;
+    uint16_t count = (available < max_records) ? (uint16_t)available : max_records;
+
+    for (uint16_t i = 0; i < count; i++) {
+        records[i] = g_trace_ring[(head - count + i) & Z1_TRACE_MASK];
+    }
+    return count;
+}
+
+/**
+ * Get the total number of records written
+ */
+uint32_t z1_trace_count(void) {
+    return g_trace_head;
+}
+
+/**
+ * Get the number of records lost to the stdio drain
+ */
+uint32_t z1_trace_dropped(void) {
+    return g_trace_dropped;
+}
@@ -273,6 +273,12 @@ class ComputeNode:
             if all(b == 0 for b in first_entry):
                 return neurons
             
+            # v2 (CSR) tables start with a header instead of neuron 0
+            if first_entry[:3] == b'Z1N':
+                neurons = self._parse_csr_table(addr)
+                self.neuron_table = neurons
+                return neurons
+            
             # Parse entries until we hit empty data
             offset = 0
             while offset < 1024 * 1024:  # Max 1MB of neuron tables
@@ -313,9 +319,31 @@ class ComputeNode:
         self.neuron_table = neurons
         return neurons
     
-    def _parse_neuron_entry(self, entry_data: bytes) -> Optional[ParsedNeuron]:
-        """Parse single neuron entry (256 bytes)."""
-        if len(entry_data) < 256:
+    def _parse_csr_table(self, addr: int) -> List[ParsedNeuron]:
+        """Parse v2 neuron table: header, parameter records, CSR synapse rows."""
+        _, version, count, param_size, synapse_total, _ = \
+            struct.unpack('<3sBHHII', self.memory.read(addr, 16))
+        if version != 2 or param_size != 40:
+            print(f"Unsupported neuron table version {version}")
+            return []
+        
+        params = self.memory.read(addr + 16, count * param_size)
+        rows_addr = addr + 16 + count * param_size
+        offsets = struct.unpack(f'<{count + 1}I', self.memory.read(rows_addr, 4 * (count + 1)))
+        synapse_data = self.memory.read(rows_addr + 4 * (count + 1), 4 * synapse_total)
+        
+        neurons = []
+        for i in range(count):
+            record = params[i * param_size:(i + 1) * param_size]
+            row = synapse_data[offsets[i] * 4:offsets[i + 1] * 4]
+            neuron = self._parse_neuron_entry(bytes(record) + bytes(row), max_synapses=len(row) // 4)
+            if neuron:
+                neurons.append(neuron)
+        return neurons
+    
+    def _parse_neuron_entry(self, entry_data: bytes, max_synapses: int = 54) -> Optional[ParsedNeuron]:
+        """Parse single neuron entry (256 bytes, or a v2 record followed by its row)."""
+        if len(entry_data) < 40 + 4 * min(max_synapses, 54):
             return None
         
         try:
@@ -335,9 +363,9 @@ class ComputeNode:
             synapses = []
             if self.node_id in [14, 15] and synapse_count > 54:
                 print(f"[Node {self.node_id}] WARNING: synapse_count={synapse_count} exceeds limit of 54!")
-            for i in range(min(synapse_count, 54)):
+            for i in range(min(synapse_count, max_synapses)):
                 synapse_value = struct.unpack_from('<I', entry_data, 40 + i * 4)[0]
-                source_id = (synapse_value >> 8) & 0xFFFFFF
+                source_id = (synapse_value >> 8) & 0xFFFFF
                 weight = synapse_value & 0xFF
                 synapses.append((source_id, weight))
             
@@ -243,7 +243,7 @@ class SNNEngineSTDP:
             synapses = []
             for j in range(min(synapse_count, 60)):
                 synapse_value = struct.unpack_from('<I', entry_data, 40 + j * 4)[0]
-                source_id = (synapse_value >> 8) & 0xFFFFFF
+                source_id = (synapse_value >> 8) & 0xFFFFF
                 weight_int = synapse_value & 0xFF
                 weight_float = weight_int / 255.0
                 
@@ -205,8 +205,16 @@ class Z1APIServer:
         @self.app.route('/api/snn/input', methods=['POST'])
         def inject_spikes():
             """Inject input spikes."""
-            data = request.json
-            spikes_data = data.get('spikes', [])
+            if request.mimetype == 'application/octet-stream':
+                # Firmware format: [count:2] then [neuron_id:2][value:f32]
+                body = request.get_data()
+                count = struct.unpack_from('<H', body, 0)[0] if len(body) >= 2 else 0
+                count = min(count, max(len(body) - 2, 0) // 6)
+                spikes_data = [{'neuron_id': n, 'value': v}
+                               for n, v in struct.iter_unpack('<Hf', body[2:2 + 6 * count])]
+            else:
+                data = request.json
+                spikes_data = data.get('spikes', [])
             
             injected = 0
             for spike_data in spikes_data:
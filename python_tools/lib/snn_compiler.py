@@ -7,7 +7,9 @@ for deployment on Z1 cluster. Supports multi-backplane configurations with
 hundreds of nodes.
 """
 
+import heapq
 import json
+import math
 import struct
 import random
 import numpy as np
@@ -15,6 +17,82 @@ from typing import Dict, List, Tuple, Any, Optional
 from dataclasses import dataclass
 
 
+# Neuron table formats (see docs/ARCHITECTURE.md)
+TABLE_V1 = 1                # Fixed 256-byte entries
+TABLE_V2 = 2                # Header + parameter records + CSR synapse rows
+TABLE_MAGIC = b'Z1N'        # v2 header bytes 0-2; version is byte 3
+NEURON_ENTRY_SIZE = 256     # v1 entry
+NEURON_PARAM_SIZE = 40      # v1 entry bytes 0-39 / v2 parameter record
+V1_MAX_SYNAPSES = 54        # (256 - 40) / 4
+V2_MAX_SYNAPSES = 0xFFFF    # 16-bit synapse count
+
+# Node capacity, as z1_psram_layout_init() derives it on the node
+PSRAM_SIZE = 8 * 1024 * 1024        # APS6404L
+PSRAM_STAGING_OFFSET = 0x100000     # Host region below staging
+PSRAM_FIRMWARE_SIZE = 128 * 1024    # Firmware distribution image
+PSRAM_SPILL_SIZE = 0x10000          # Spike queue overflow
+PSRAM_RASTER_SIZE = 0x10000         # Spike recorder ring
+PSRAM_STAGING_PER_NEURON = 256
+PSRAM_TABLE_PER_NEURON = 256
+PSRAM_INDEX_PER_NEURON = 54 * 4
+SRAM_MAX_NEURONS = 4096             # Z1_SNN_V2_MAX_NEURONS
+INDEX_MAX_SOURCES = 2048            # Distinct source neurons per node
+INDEX_ENTRY_SIZE = 4                # Synapse index bytes per synapse
+
+SPIKE_ENTRY_SIZE = 3                # z1_spike_batch_entry_t
+
+# Global neuron addressing (see Global Neuron Addressing in z1_protocol.h)
+MAX_BACKPLANES = 8                  # Z1_MAX_BACKPLANES
+GLOBAL_LOCAL_BITS = 13              # [19:16] node, [15:13] backplane field, [12:0] local
+FLAG_ROUTED = 0x0020                # Z1_NEURON_FLAG_ROUTED
+FLAG_GATEWAY = 0x0080               # Z1_NEURON_FLAG_GATEWAY
+GATEWAY_ROUTE_FORMAT = '<BBHHH'     # z1_gateway_route_t
+DEFAULT_RATE_HZ = 10.0              # Expected firing rate of layers that give none
+
+
+def table_neuron_count(table_data: bytes) -> int:
+    """Number of neurons in a compiled v1 or v2 neuron table."""
+    if table_data[:3] == TABLE_MAGIC:
+        return struct.unpack_from('<H', table_data, 4)[0]
+    return len(table_data) // NEURON_ENTRY_SIZE
+
+
+def table_size(table_version: int, neurons: int, synapses: int) -> int:
+    """Bytes of a compiled table with this many neurons and synapses."""
+    if table_version == TABLE_V2:
+        return 16 + NEURON_PARAM_SIZE * neurons + 4 * (neurons + 1) + 4 * synapses
+    return NEURON_ENTRY_SIZE * neurons
+
+
+@dataclass
+class NodeCapacity:
+    """What one node can hold (see embedded_firmware/node/z1_psram_layout.c)."""
+    neurons: int        # SRAM state arrays / PSRAM layout
+    table_bytes: int    # Neuron table region (the staging region is as large)
+    synapses: int       # Synapse index entries
+    sources: int        # Distinct source neurons in the synapse index
+
+
+def node_capacity(psram_size: int = PSRAM_SIZE,
+                  sram_max_neurons: int = SRAM_MAX_NEURONS) -> NodeCapacity:
+    """Per-node capacity for a PSRAM part size."""
+    per_neuron = PSRAM_STAGING_PER_NEURON + PSRAM_TABLE_PER_NEURON + PSRAM_INDEX_PER_NEURON
+    usable = (psram_size - PSRAM_STAGING_OFFSET - PSRAM_FIRMWARE_SIZE - PSRAM_SPILL_SIZE -
+              PSRAM_RASTER_SIZE)
+    staging_size = (usable * PSRAM_STAGING_PER_NEURON // per_neuron) & ~0xFFF
+    table_bytes = (usable * PSRAM_TABLE_PER_NEURON // per_neuron) & ~0xFFF
+    index_size = usable - staging_size - table_bytes
+    # Neurons every rounded region has a full share for
+    neurons = min(staging_size // PSRAM_STAGING_PER_NEURON,
+                  table_bytes // PSRAM_TABLE_PER_NEURON,
+                  index_size // PSRAM_INDEX_PER_NEURON,
+                  sram_max_neurons)
+    return NodeCapacity(neurons=neurons,
+                        table_bytes=table_bytes,
+                        synapses=index_size // INDEX_ENTRY_SIZE,
+                        sources=INDEX_MAX_SOURCES)
+
+
 @dataclass
 class NeuronConfig:
     """Configuration for a single neuron."""
@@ -26,7 +104,10 @@ class NeuronConfig:
     threshold: float
     leak_rate: float
     refractory_period_us: int
-    synapses: List[Tuple[int, int]]  # List of (source_global_id, weight)
+    synapses: List[Tuple[int, int, int]]  # List of (source_global_id, weight, delay_steps)
+    inhibit_group: int = 0        # Inhibition group ID (0 = none), node-local
+    inhibit_k: int = 0            # k-WTA winners per timestep (0 = no limit)
+    inhibit_strength: float = 0.0  # Subtracted from the other members per member spike
 
 
 @dataclass
@@ -37,6 +118,177 @@ class DeploymentPlan:
     backplane_nodes: Dict[str, List[int]]        # backplane_id -> list of node_ids
     total_neurons: int
     total_synapses: int
+    traffic: Optional[Dict[str, Any]] = None     # Predicted inter-node spike traffic
+    backplane_index: Optional[Dict[str, int]] = None   # backplane_id -> gateway backplane number
+    gateway_routes: Optional[Dict[str, bytes]] = None  # backplane_id -> POST /api/gateway/routes body
+
+
+class NodePartitioner:
+    """
+    Greedy placement of units (neurons or groups) onto nodes.
+    
+    Edges carry the expected spike rate of the synapses between two units,
+    so the cut is the rate of synaptic events that cross the bus. Every
+    placement keeps each node within the neuron, table, synapse and
+    distinct-source limits of a NodeCapacity.
+    """
+    
+    def __init__(self, node_count: int, limit: NodeCapacity, table_version: int):
+        self.node_count = node_count
+        self.limit = limit
+        self.table_version = table_version
+        self.sizes = []      # Neurons per unit
+        self.synapses = []   # Incoming synapses per unit
+        self.sources = []    # Per unit: source global ID -> synapses from it
+        self.edges = []      # Per unit: neighbour unit -> rate
+    
+    def add_unit(self, size: int):
+        """Add a unit of size neurons."""
+        self.sizes.append(size)
+        self.synapses.append(0)
+        self.sources.append({})
+        self.edges.append({})
+    
+    def add_synapse(self, target: int, source_id: int, source: Optional[int], rate: float):
+        """Add a synapse into unit target from source_id (in unit source, or None if external)."""
+        self.synapses[target] += 1
+        self.sources[target][source_id] = self.sources[target].get(source_id, 0) + 1
+        if source is not None and source != target:
+            self.edges[target][source] = self.edges[target].get(source, 0.0) + rate
+            self.edges[source][target] = self.edges[source].get(target, 0.0) + rate
+    
+    def cut(self, part: List[int]) -> float:
+        """Rate of synaptic events between units on different nodes."""
+        total = 0.0
+        for u, neighbours in enumerate(self.edges):
+            for v, w in neighbours.items():
+                if part[u] != part[v]:
+                    total += w
+        return total / 2
+    
+    def _empty_loads(self):
+        return ([0] * self.node_count, [0] * self.node_count,
+                [dict() for _ in range(self.node_count)])
+    
+    def _place(self, loads, u: int, p: int, sign: int):
+        neurons, synapses, sources = loads
+        neurons[p] += sign * self.sizes[u]
+        synapses[p] += sign * self.synapses[u]
+        refs = sources[p]
+        for source_id, count in self.sources[u].items():
+            refs[source_id] = refs.get(source_id, 0) + sign * count
+            if refs[source_id] == 0:
+                del refs[source_id]
+    
+    def _fits(self, loads, u: int, q: int, max_neurons: int) -> bool:
+        neurons, synapses, sources = loads
+        n = neurons[q] + self.sizes[u]
+        syn = synapses[q] + self.synapses[u]
+        if (n > max_neurons or syn > self.limit.synapses or
+                table_size(self.table_version, n, syn) > self.limit.table_bytes):
+            return False
+        new_sources = sum(1 for source_id in self.sources[u] if source_id not in sources[q])
+        return len(sources[q]) + new_sources <= self.limit.sources
+    
+    def grow(self) -> Optional[List[int]]:
+        """
+        Fill the nodes one at a time along the synapse graph.
+        
+        Each node takes an even share of the remaining neurons, always adding
+        the unplaced unit with the most rate to the units it already holds
+        (the lowest unplaced unit when nothing is connected).
+        
+        Returns:
+            Node index per unit, or None if some unit fits no node
+        """
+        part = [-1] * len(self.sizes)
+        loads = self._empty_loads()
+        remaining = sum(self.sizes)
+        unplaced = 0
+        
+        for p in range(self.node_count):
+            share = math.ceil(remaining / (self.node_count - p))
+            target = min(self.limit.neurons, share)
+            affinity = {}
+            heap = []
+            skipped = set()
+            while loads[0][p] < target:
+                u = None
+                while heap:
+                    neg, candidate = heapq.heappop(heap)
+                    if part[candidate] < 0 and candidate not in skipped and -neg == affinity[candidate]:
+                        u = candidate
+                        break
+                if u is None:
+                    while unplaced < len(part) and part[unplaced] >= 0:
+                        unplaced += 1
+                    u = next((c for c in range(unplaced, len(part))
+                              if part[c] < 0 and c not in skipped), None)
+                    if u is None:
+                        break
+                if not self._fits(loads, u, p, target):
+                    skipped.add(u)
+                    continue
+                part[u] = p
+                self._place(loads, u, p, 1)
+                remaining -= self.sizes[u]
+                for v, w in self.edges[u].items():
+                    if part[v] < 0:
+                        affinity[v] = affinity.get(v, 0.0) + w
+                        heapq.heappush(heap, (-affinity[v], v))
+        
+        # Leftovers (units that overshot a share) go wherever they fit
+        for u in range(len(part)):
+            if part[u] < 0:
+                fits = [q for q in range(self.node_count)
+                        if self._fits(loads, u, q, self.limit.neurons)]
+                if not fits:
+                    return None
+                q = min(fits, key=lambda q: loads[0][q])
+                part[u] = q
+                self._place(loads, u, q, 1)
+        return part
+    
+    def refine(self, start: List[int], passes: int) -> Tuple[List[int], int]:
+        """
+        Move units to the node they exchange the most rate with.
+        
+        A pass visits every unit and applies the best positive-gain move that
+        keeps the destination within its limits. Stops after a pass with no
+        moves or after passes passes.
+        
+        Returns:
+            (node index per unit, moves made)
+        """
+        part = list(start)
+        loads = self._empty_loads()
+        for u, p in enumerate(part):
+            self._place(loads, u, p, 1)
+        
+        moves = 0
+        for _ in range(passes):
+            moved = 0
+            for u in range(len(part)):
+                p = part[u]
+                weight_to = {}
+                for v, w in self.edges[u].items():
+                    weight_to[part[v]] = weight_to.get(part[v], 0.0) + w
+                here = weight_to.get(p, 0.0)
+                
+                # Best feasible node by gain, ties to the lower node index
+                for q, w in sorted(weight_to.items(), key=lambda item: (-item[1], item[0])):
+                    if w - here <= 1e-9:
+                        break
+                    if self._fits(loads, u, q, self.limit.neurons):
+                        self._place(loads, u, p, -1)
+                        self._place(loads, u, q, 1)
+                        part[u] = q
+                        moved += 1
+                        break
+            moves += moved
+            if moved == 0:
+                break
+        return part, moves
 
 
 class SNNCompiler:
@@ -56,6 +308,19 @@ class SNNCompiler:
         self.node_assignments = {}  # (backplane_id, node_id) -> [global_neuron_ids]
         self.layer_map = {}
         self.neuron_map = {}  # global_id -> (backplane, node, local_id)
+        self.fanout_masks = {}  # global_id -> destination node mask
+        self.backplane_index = {}  # backplane_id -> backplane number (0-7)
+        self.gateway_sources = set()  # global_ids with targets on other backplanes
+        self.gateway_routes = {}  # backplane_id -> packed z1_gateway_route_t entries
+        self.inhibit_groups = 0  # Inhibition group IDs handed out (1-255)
+        self.strategy = topology.get('node_assignment', {}).get('strategy', 'balanced')
+        self.available_nodes = []  # (backplane_id, node_id) the strategy may use
+        
+        # Table format: v1 for older firmware, v2 (CSR) lifts the fan-in cap
+        self.table_version = int(topology.get('table_version', TABLE_V1))
+        if self.table_version not in (TABLE_V1, TABLE_V2):
+            raise ValueError(f"Unsupported table_version {self.table_version}")
+        self.max_synapses = V1_MAX_SYNAPSES if self.table_version == TABLE_V1 else V2_MAX_SYNAPSES
         
     def compile(self) -> DeploymentPlan:
         """
@@ -73,18 +338,25 @@ class SNNCompiler:
         # Step 3: Generate connections
         self._generate_connections()
         
+        # Step 3b: Move neurons to cut remote synapses ('partitioned' strategy)
+        if self.strategy == 'partitioned':
+            self._partition_neurons()
+        self._check_inhibition_groups()
+        self._check_node_capacity()
+        
         # Step 4: Compile neuron tables
         neuron_tables = self._compile_neuron_tables()
         
         # Step 5: Build deployment plan
         deployment_plan = self._build_deployment_plan(neuron_tables)
+        deployment_plan.traffic = self.predict_traffic()
         
         return deployment_plan
     
     def _assign_neurons_to_nodes(self):
         """Assign neurons to compute nodes across backplanes."""
         assignment = self.topology.get('node_assignment', {})
-        strategy = assignment.get('strategy', 'balanced')
+        strategy = self.strategy
         
         # Get available backplanes and nodes
         if self.backplane_config:
@@ -103,9 +375,15 @@ class SNNCompiler:
             available_nodes = [(backplane_name, node_id) for node_id in nodes]
         
         total_neurons = self.topology['neuron_count']
+        self.available_nodes = available_nodes
+        for bp_name, _ in available_nodes:
+            self.backplane_index.setdefault(bp_name, len(self.backplane_index))
+        if len(self.backplane_index) > MAX_BACKPLANES:
+            raise ValueError(f"{len(self.backplane_index)} backplanes (max {MAX_BACKPLANES})")
         
-        if strategy == 'balanced':
+        if strategy in ('balanced', 'partitioned'):
             # Evenly distribute neurons across all available nodes
+            # ('partitioned' refines this once the synapses are known)
             neurons_per_node = total_neurons // len(available_nodes)
             
             neuron_id = 0
@@ -147,6 +425,7 @@ class SNNCompiler:
     def _build_neuron_configs(self):
         """Build neuron configurations from layers."""
         layers = self.topology['layers']
+        stdp_enabled = self.topology.get('stdp_config', {}).get('enabled', False)
         
         for layer in layers:
             layer_id = layer['layer_id']
@@ -161,6 +440,10 @@ class SNNCompiler:
             elif layer_type == 'output':
                 flags |= 0x0008  # OUTPUT
             
+            # On-node STDP learns the input weights of flagged neurons
+            if stdp_enabled and layer_type != 'input' and layer.get('plastic', True):
+                flags |= 0x0040  # PLASTIC
+            
             # Get layer parameters
             threshold = layer.get('threshold', 1.0)
             leak_rate = layer.get('leak_rate', 0.95)
@@ -186,6 +469,44 @@ class SNNCompiler:
                 self.neurons.append(neuron)
                 self.layer_map[global_id] = layer_id
                 self.neuron_map[global_id] = (bp_name, node_id, local_id)
+            
+            # Layer-wide lateral inhibition: {"strength": s, "k": winners}
+            inhibition = layer.get('inhibition')
+            if inhibition:
+                self._set_inhibition_group(start_id, end_id, inhibition.get('strength', 1.0),
+                                           inhibition.get('k', 0))
+    
+    def _set_inhibition_group(self, start_id: int, end_id: int, strength: float, k: int):
+        """
+        Make a neuron range one inhibition group.
+        
+        The node engine subtracts `strength` from the other members when one
+        fires and lets at most k members fire per timestep (k = 0: no limit),
+        so no inhibitory synapses are stored. Groups act within a node only.
+        """
+        if self.inhibit_groups >= 255:
+            raise ValueError("More than 255 inhibition groups")
+        self.inhibit_groups += 1
+        
+        for neuron in self.neurons:
+            if start_id <= neuron.global_id <= end_id:
+                neuron.inhibit_group = self.inhibit_groups
+                neuron.inhibit_k = max(0, min(255, int(k)))
+                neuron.inhibit_strength = abs(float(strength))
+    
+    def _check_inhibition_groups(self):
+        """Warn about inhibition groups the final placement splits across nodes."""
+        groups = {}
+        for neuron in self.neurons:
+            if neuron.inhibit_group:
+                groups.setdefault(neuron.inhibit_group, []).append(neuron)
+        
+        for group_id, members in sorted(groups.items()):
+            nodes = set((n.backplane_id, n.node_id) for n in members)
+            if len(nodes) > 1:
+                ids = [n.global_id for n in members]
+                print(f"Warning: Inhibition group {group_id} (neurons {min(ids)}-{max(ids)}) "
+                      f"spans {len(nodes)} nodes; members only inhibit others on the same node")
     
     def _find_node_for_neuron(self, global_id: int) -> Tuple[str, int, int]:
         """
@@ -230,6 +551,11 @@ class SNNCompiler:
                     target_start, target_end,
                     conn
                 )
+            elif conn_type == 'all_to_all_inhibitory' and source_layer_id == target_layer_id:
+                # Lateral inhibition without N^2 synapses: mean weight magnitude
+                weight_range = conn.get('weight_range', [-1.0, -1.0])
+                strength = sum(abs(w) for w in weight_range) / len(weight_range)
+                self._set_inhibition_group(target_start, target_end, strength, conn.get('k', 0))
             elif conn_type in ['sparse_random', 'random']:
                 # Map 'probability' to 'connection_probability' if needed
                 if 'probability' in conn and 'connection_probability' not in conn:
@@ -240,6 +566,11 @@ class SNNCompiler:
                     conn
                 )
     
+    @staticmethod
+    def _get_delay_steps(conn_config: Dict[str, Any]) -> int:
+        """Synaptic delay in timesteps (0-15, stored in synapse bits 31:28)."""
+        return max(0, min(15, int(conn_config.get('delay_steps', 0))))
+    
     def _add_explicit_connection(self, conn_config: Dict[str, Any]):
         """Add an explicit neuron-to-neuron connection."""
         source_id = conn_config['source_neuron']
@@ -265,8 +596,8 @@ class SNNCompiler:
             weight = min(127, int(weight_float * 63.5))
         
         # Add synapse (limit to max synapses)
-        if len(target_neuron.synapses) < 54:
-            target_neuron.synapses.append((source_id, weight))
+        if len(target_neuron.synapses) < self.max_synapses:
+            target_neuron.synapses.append((source_id, weight, self._get_delay_steps(conn_config)))
     
     def _generate_fully_connected(self, source_start: int, source_end: int,
                                   target_start: int, target_end: int,
@@ -275,6 +606,7 @@ class SNNCompiler:
         weight_init = conn_config.get('weight_init', 'random_normal')
         weight_mean = conn_config.get('weight_mean', 0.5)
         weight_stddev = conn_config.get('weight_stddev', 0.1)
+        delay_steps = self._get_delay_steps(conn_config)
         
         for target_id in range(target_start, target_end + 1):
             target_neuron = next(n for n in self.neurons if n.global_id == target_id)
@@ -297,8 +629,8 @@ class SNNCompiler:
                 weight = int(weight_float * 255)
                 
                 # Add synapse (limit to max synapses)
-                if len(target_neuron.synapses) < 54:
-                    target_neuron.synapses.append((source_id, weight))
+                if len(target_neuron.synapses) < self.max_synapses:
+                    target_neuron.synapses.append((source_id, weight, delay_steps))
     
     def _generate_sparse_random(self, source_start: int, source_end: int,
                                 target_start: int, target_end: int,
@@ -314,6 +646,7 @@ class SNNCompiler:
             weight_mean = conn_config.get('weight_mean', 0.5)
             weight_stddev = conn_config.get('weight_stddev', 0.1)
             use_range = False
+        delay_steps = self._get_delay_steps(conn_config)
         
         for target_id in range(target_start, target_end + 1):
             target_neuron = next(n for n in self.neurons if n.global_id == target_id)
@@ -331,12 +664,229 @@ class SNNCompiler:
                     weight = min(127, int(weight_float * 63.5))
                     
                     # Add synapse (limit to max synapses)
-                    if len(target_neuron.synapses) < 54:
-                        target_neuron.synapses.append((source_id, weight))
+                    if len(target_neuron.synapses) < self.max_synapses:
+                        target_neuron.synapses.append((source_id, weight, delay_steps))
+    
+    def _neuron_rates(self) -> Dict[int, float]:
+        """Expected firing rate (Hz) per global ID, from each layer's expected_rate_hz."""
+        rates = {}
+        for layer in self.topology['layers']:
+            rate = float(layer.get('expected_rate_hz', DEFAULT_RATE_HZ))
+            for global_id in range(layer['neuron_ids'][0], layer['neuron_ids'][1] + 1):
+                rates[global_id] = rate
+        return rates
+    
+    def _node_limit(self) -> NodeCapacity:
+        """
+        Capacity each node may use.
+        
+        node_assignment may override the part ("psram_mb") or cap the neurons
+        per node ("max_neurons_per_node"). The partitioned strategy also keeps
+        every node within "imbalance" (default 0.05) of an even share, so the
+        nodes still step in parallel.
+        """
+        assignment = self.topology.get('node_assignment', {})
+        capacity = node_capacity(int(assignment.get('psram_mb', PSRAM_SIZE >> 20)) << 20)
+        if 'max_neurons_per_node' in assignment:
+            capacity.neurons = min(capacity.neurons, int(assignment['max_neurons_per_node']))
+        if self.strategy == 'partitioned' and self.available_nodes:
+            share = len(self.neurons) / len(self.available_nodes)
+            imbalance = float(assignment.get('imbalance', 0.05))
+            capacity.neurons = min(capacity.neurons, max(1, math.ceil(share * (1.0 + imbalance))))
+        return capacity
+    
+    def _partition_neurons(self):
+        """
+        Re-place neurons to cut rate-weighted remote synapses.
+        
+        A unit is one neuron, or a whole inhibition group when it fits on a
+        node (groups only act within a node). Two starting placements, the
+        balanced slices and one grown over the synapse graph, are refined by
+        NodePartitioner and the one with less remote traffic is kept.
+        """
+        limit = self._node_limit()
+        rates = self._neuron_rates()
+        nodes = list(self.available_nodes)
+        node_index = {key: p for p, key in enumerate(nodes)}
+        by_id = {n.global_id: n for n in self.neurons}
+        
+        # Units: inhibition groups that fit one node, other neurons singly
+        groups = {}
+        for neuron in self.neurons:
+            if neuron.inhibit_group:
+                groups.setdefault(neuron.inhibit_group, []).append(neuron.global_id)
+        unit_of = {}
+        units = []
+        for members in groups.values():
+            if len(members) <= limit.neurons:
+                for global_id in members:
+                    unit_of[global_id] = len(units)
+                units.append(members)
+        for neuron in self.neurons:
+            if neuron.global_id not in unit_of:
+                unit_of[neuron.global_id] = len(units)
+                units.append([neuron.global_id])
+        
+        # Per unit: synapse count, source multiplicities, rate-weighted edges
+        partitioner = NodePartitioner(len(nodes), limit, self.table_version)
+        for members in units:
+            partitioner.add_unit(len(members))
+        for neuron in self.neurons:
+            u = unit_of[neuron.global_id]
+            for source_id, _, _ in neuron.synapses:
+                v = unit_of.get(source_id)
+                partitioner.add_synapse(u, source_id, v, rates.get(source_id, DEFAULT_RATE_HZ))
+        
+        passes = int(self.topology.get('node_assignment', {}).get('passes', 10))
+        sliced = [node_index[self.neuron_map[members[0]][:2]] for members in units]
+        before = partitioner.cut(sliced)
+        best = None
+        for start in (sliced, partitioner.grow()):
+            if start is None:
+                continue
+            part, moves = partitioner.refine(start, passes)
+            cut = partitioner.cut(part)
+            if best is None or cut < best[1]:
+                best = (part, cut, moves)
+        part, after, moves = best
+        
+        # Local IDs follow global ID order on each node
+        assignments = {}
+        for u, members in enumerate(units):
+            assignments.setdefault(part[u], []).extend(members)
+        self.node_assignments = {}
+        for p, key in enumerate(nodes):
+            if p not in assignments:
+                continue
+            neuron_list = sorted(assignments[p])
+            self.node_assignments[key] = neuron_list
+            for local_id, global_id in enumerate(neuron_list):
+                neuron = by_id[global_id]
+                neuron.backplane_id, neuron.node_id = key
+                neuron.neuron_id = local_id
+                self.neuron_map[global_id] = (key[0], key[1], local_id)
+        
+        print(f"Partitioner: {moves} moves, remote synapse traffic "
+              f"{before:.0f} -> {after:.0f} spikes/s")
+    
+    def _check_node_capacity(self):
+        """Warn about nodes whose table would not fit the node."""
+        limit = node_capacity(int(self.topology.get('node_assignment', {})
+                                  .get('psram_mb', PSRAM_SIZE >> 20)) << 20)
+        for (bp_name, node_id), neuron_ids in self.node_assignments.items():
+            members = [n for n in self.neurons if n.backplane_id == bp_name and n.node_id == node_id]
+            synapses = sum(len(n.synapses) for n in members)
+            sources = set(s for n in members for s, _, _ in n.synapses)
+            problems = []
+            if len(members) > limit.neurons:
+                problems.append(f"{len(members)} neurons (max {limit.neurons})")
+            if synapses > limit.synapses:
+                problems.append(f"{synapses} synapses (max {limit.synapses})")
+            if table_size(self.table_version, len(members), synapses) > limit.table_bytes:
+                problems.append(f"table over {limit.table_bytes} bytes")
+            if len(sources) > limit.sources:
+                problems.append(f"{len(sources)} distinct sources (max {limit.sources})")
+            if problems:
+                print(f"Warning: {bp_name}:{node_id} exceeds node capacity: {', '.join(problems)}")
+    
+    def predict_traffic(self) -> Dict[str, Any]:
+        """
+        Expected inter-node spike traffic of the current placement.
+        
+        A spike of a neuron with targets on other nodes is one bus entry
+        (batches are multicast to the fan-out mask) and one remote delivery
+        per destination node. Rates come from each layer's expected_rate_hz.
+        
+        Returns:
+            Dictionary with cut synapse counts, remote spike and delivery
+            rates, bus bytes/s and remote spikes/s sent per node
+        """
+        rates = self._neuron_rates()
+        remote_nodes = {}  # source global ID -> nodes of its remote targets
+        cut_synapses = 0
+        cut_rate = 0.0
+        for target in self.neurons:
+            for source_id, _, _ in target.synapses:
+                if source_id not in self.neuron_map:
+                    continue
+                source_bp, source_node, _ = self.neuron_map[source_id]
+                if (source_bp, source_node) != (target.backplane_id, target.node_id):
+                    cut_synapses += 1
+                    cut_rate += rates.get(source_id, DEFAULT_RATE_HZ)
+                    remote_nodes.setdefault(source_id, set()).add((target.backplane_id, target.node_id))
+        
+        per_node = {}
+        remote_spikes = 0.0
+        remote_deliveries = 0.0
+        for source_id, destinations in remote_nodes.items():
+            rate = rates.get(source_id, DEFAULT_RATE_HZ)
+            source_bp, source_node, _ = self.neuron_map[source_id]
+            key = f"{source_bp}:{source_node}"
+            per_node[key] = per_node.get(key, 0.0) + rate
+            remote_spikes += rate
+            remote_deliveries += rate * len(destinations)
+        
+        return {
+            'total_synapses': sum(len(n.synapses) for n in self.neurons),
+            'cut_synapses': cut_synapses,
+            'cut_synapse_rate': cut_rate,
+            'remote_spikes_per_s': remote_spikes,
+            'remote_deliveries_per_s': remote_deliveries,
+            'bus_bytes_per_s': remote_spikes * SPIKE_ENTRY_SIZE,
+            'per_node_spikes_per_s': per_node
+        }
+    
+    def _compute_fanout_masks(self) -> Dict[int, int]:
+        """Compute destination node mask per source neuron (same backplane only)."""
+        fanout = {}
+        for target in self.neurons:
+            for source_global_id, _, _ in target.synapses:
+                if source_global_id not in self.neuron_map:
+                    continue
+                source_bp, _, _ = self.neuron_map[source_global_id]
+                if source_bp == target.backplane_id:
+                    fanout[source_global_id] = fanout.get(source_global_id, 0) | (1 << target.node_id)
+        return fanout
+    
+    def _compute_gateway_routes(self) -> Dict[str, bytes]:
+        """
+        Gateway route table of each backplane (z1_gateway_route_t entries).
+        
+        Exports name the peer backplanes a local source has targets on,
+        imports the local nodes a source on another backplane has targets on.
+        Also collects the sources that need Z1_NEURON_FLAG_GATEWAY.
+        """
+        exports = {}  # source global ID -> peer backplane mask
+        imports = {}  # (target backplane, source global ID) -> local node mask
+        for target in self.neurons:
+            for source_global_id, _, _ in target.synapses:
+                if source_global_id not in self.neuron_map:
+                    continue
+                source_bp, _, _ = self.neuron_map[source_global_id]
+                if source_bp == target.backplane_id:
+                    continue
+                peer = self.backplane_index[target.backplane_id]
+                exports[source_global_id] = exports.get(source_global_id, 0) | (1 << peer)
+                key = (target.backplane_id, source_global_id)
+                imports[key] = imports.get(key, 0) | (1 << target.node_id)
+        
+        self.gateway_sources = set(exports)
+        routes = {bp_name: [] for bp_name in self.backplane_index}
+        for source_global_id, peers in exports.items():
+            bp_name, node_id, local_id = self.neuron_map[source_global_id]
+            routes[bp_name].append((self.backplane_index[bp_name], node_id, local_id, peers))
+        for (bp_name, source_global_id), nodes in imports.items():
+            source_bp, node_id, local_id = self.neuron_map[source_global_id]
+            routes[bp_name].append((self.backplane_index[source_bp], node_id, local_id, nodes))
+        
+        return {bp_name: b''.join(struct.pack(GATEWAY_ROUTE_FORMAT, *r, 0) for r in sorted(entries))
+                for bp_name, entries in routes.items() if entries}
     
     def _compile_neuron_tables(self) -> Dict[Tuple[str, int], bytes]:
         """Compile neuron tables for each node."""
         neuron_tables = {}
+        self.fanout_masks = self._compute_fanout_masks()
+        self.gateway_routes = self._compute_gateway_routes()
         
         for (bp_name, node_id), neuron_ids in self.node_assignments.items():
             table_data = bytearray()
@@ -346,31 +896,66 @@ class SNNCompiler:
                           if n.backplane_id == bp_name and n.node_id == node_id]
             node_neurons.sort(key=lambda n: n.neuron_id)
             
-            for neuron in node_neurons:
-                # Pack neuron entry (256 bytes)
-                entry = self._pack_neuron_entry(neuron)
-                table_data.extend(entry)
+            if self.table_version == TABLE_V2:
+                table_data = self._pack_csr_table(node_neurons)
+            else:
+                for neuron in node_neurons:
+                    # Pack neuron entry (256 bytes)
+                    entry = self._pack_neuron_entry(neuron)
+                    table_data.extend(entry)
             
             neuron_tables[(bp_name, node_id)] = bytes(table_data)
         
         return neuron_tables
     
-    def _pack_neuron_entry(self, neuron: NeuronConfig) -> bytes:
-        """Pack neuron entry into 256-byte binary format."""
-        entry = bytearray(256)
+    def _pack_csr_table(self, node_neurons: List[NeuronConfig]) -> bytes:
+        """
+        Pack a v2 table: header, parameter records, row offsets, synapses.
+        
+        Row offsets count synapses; row i spans [offsets[i], offsets[i + 1]).
+        """
+        params = bytearray()
+        rows = bytearray()
+        offsets = [0]
+        
+        for neuron in node_neurons:
+            entry = self._pack_neuron_entry(neuron, TABLE_V2)
+            params.extend(entry[:NEURON_PARAM_SIZE])
+            rows.extend(entry[NEURON_PARAM_SIZE:])
+            offsets.append(len(rows) // 4)
+        
+        header = TABLE_MAGIC + struct.pack('<BHHII', TABLE_V2, len(node_neurons),
+                                           NEURON_PARAM_SIZE, offsets[-1], 0)
+        return header + bytes(params) + struct.pack(f'<{len(offsets)}I', *offsets) + bytes(rows)
+    
+    def _pack_neuron_entry(self, neuron: NeuronConfig, table_version: int = TABLE_V1) -> bytes:
+        """
+        Pack neuron entry.
+        
+        v1: 256-byte entry with up to 54 inline synapses.
+        v2: 40-byte parameter record followed by the neuron's packed synapse row.
+        """
+        max_synapses = V1_MAX_SYNAPSES if table_version == TABLE_V1 else V2_MAX_SYNAPSES
+        synapses = neuron.synapses[:max_synapses]
+        entry = bytearray(NEURON_ENTRY_SIZE if table_version == TABLE_V1
+                          else NEURON_PARAM_SIZE + 4 * len(synapses))
         
         # Neuron state (16 bytes)
+        # ROUTED: fanout mask below is valid; GATEWAY: targets on other backplanes
+        flags = neuron.flags | FLAG_ROUTED
+        if neuron.global_id in self.gateway_sources:
+            flags |= FLAG_GATEWAY
         struct.pack_into('<HHffI', entry, 0,
                         neuron.neuron_id,  # Use local neuron ID (0-based on this node)
-                        neuron.flags,
+                        flags,
                         0.0,  # Initial membrane potential
                         neuron.threshold,
                         0)    # Last spike time
         
         # Synapse metadata (8 bytes)
         struct.pack_into('<HHI', entry, 16,
-                        len(neuron.synapses),  # synapse_count
-                        54,                    # synapse_capacity (256-40)/4 = 54 max
+                        len(synapses),         # synapse_count
+                        V1_MAX_SYNAPSES if table_version == TABLE_V1 else len(synapses),
                         neuron.global_id)      # global_id
         
         # Neuron parameters (8 bytes)
@@ -378,21 +963,34 @@ class SNNCompiler:
                         neuron.leak_rate,
                         neuron.refractory_period_us)
         
-        # Reserved (8 bytes) - already zero
+        # Routing (2 bytes): nodes hosting this neuron's targets
+        struct.pack_into('<H', entry, 32,
+                        self.fanout_masks.get(neuron.global_id, 0) & 0xFFFF)
+        
+        # Inhibition group (6 bytes): group ID, k, strength
+        struct.pack_into('<BBf', entry, 34,
+                        neuron.inhibit_group,
+                        neuron.inhibit_k,
+                        neuron.inhibit_strength)
         
-        # Synapses (216 bytes, 54 × 4 bytes)
-        for i, (source_global_id, weight) in enumerate(neuron.synapses[:54]):
-            # Convert global ID to encoded format: (node_id << 16) | local_neuron_id
+        # Synapses (v1: 216 bytes, 54 × 4 bytes; v2: row after the record)
+        for i, (source_global_id, weight, delay_steps) in enumerate(synapses):
+            # Convert global ID to encoded format: node, backplane field, local ID
+            # (the field is 0 for sources on this backplane)
             if source_global_id in self.neuron_map:
                 source_bp, source_node, source_local = self.neuron_map[source_global_id]
-                source_encoded = (source_node << 16) | source_local
+                source_field = (self.backplane_index[source_bp] ^
+                                self.backplane_index[neuron.backplane_id])
+                source_encoded = ((source_node << 16) | (source_field << GLOBAL_LOCAL_BITS) |
+                                  source_local)
             else:
                 # Fallback: use global ID as-is
                 source_encoded = source_global_id
             
-            # Pack synapse: [source_id:24][weight:8]
-            synapse_value = ((source_encoded & 0xFFFFFF) << 8) | (weight & 0xFF)
-            struct.pack_into('<I', entry, 40 + i * 4, synapse_value)
+            # Pack synapse: [delay:4][source_id:20][weight:8]
+            synapse_value = ((delay_steps & 0xF) << 28) | \
+                            ((source_encoded & 0xFFFFF) << 8) | (weight & 0xFF)
+            struct.pack_into('<I', entry, NEURON_PARAM_SIZE + i * 4, synapse_value)
         
         return bytes(entry)
     
@@ -417,7 +1015,9 @@ class SNNCompiler:
             neuron_map=self.neuron_map,
             backplane_nodes=backplane_nodes,
             total_neurons=len(self.neurons),
-            total_synapses=total_synapses
+            total_synapses=total_synapses,
+            backplane_index=dict(self.backplane_index),
+            gateway_routes=self.gateway_routes
         )
     
     def get_deployment_info(self) -> Dict[str, Any]:
@@ -440,19 +1040,23 @@ class SNNCompiler:
 
 
 def compile_snn_topology(topology_file: str, 
-                        backplane_config: Optional[Dict[str, Any]] = None) -> DeploymentPlan:
+                        backplane_config: Optional[Dict[str, Any]] = None,
+                        table_version: Optional[int] = None) -> DeploymentPlan:
     """
     Compile SNN topology file to deployment plan.
     
     Args:
         topology_file: Path to topology JSON file
         backplane_config: Optional backplane configuration for multi-backplane deployment
+        table_version: Optional table format, overriding the topology's table_version
         
     Returns:
         DeploymentPlan with neuron tables and mapping
     """
     with open(topology_file, 'r') as f:
         topology = json.load(f)
+    if table_version is not None:
+        topology['table_version'] = table_version
     
     compiler = SNNCompiler(topology, backplane_config)
     deployment_plan = compiler.compile()
@@ -461,20 +1065,25 @@ def compile_snn_topology(topology_file: str,
 
 
 if __name__ == '__main__':
-    import sys
+    import argparse
+    import os
     
-    if len(sys.argv) < 2:
-        print("Usage: snn_compiler.py <topology.json> [backplane_config.json]")
-        sys.exit(1)
+    parser = argparse.ArgumentParser(description='Compile an SNN topology to per-node neuron tables')
+    parser.add_argument('topology', help='Topology JSON file')
+    parser.add_argument('backplane_config', nargs='?', help='Backplane configuration JSON file')
+    parser.add_argument('--tables', metavar='DIR',
+                        help='Write each table to DIR/<backplane>_node<id>.bin '
+                             '(input for embedded_firmware/host z1_snn_replay)')
+    parser.add_argument('--table-version', type=int, choices=(TABLE_V1, TABLE_V2),
+                        help='Table format (default: the topology\'s table_version, else 1)')
+    args = parser.parse_args()
     
-    topology_file = sys.argv[1]
     backplane_config = None
-    
-    if len(sys.argv) > 2:
-        with open(sys.argv[2], 'r') as f:
+    if args.backplane_config:
+        with open(args.backplane_config, 'r') as f:
             backplane_config = json.load(f)
     
-    deployment_plan = compile_snn_topology(topology_file, backplane_config)
+    deployment_plan = compile_snn_topology(args.topology, backplane_config, args.table_version)
     
     print(f"Compiled SNN Deployment Plan")
     print(f"  Total Neurons: {deployment_plan.total_neurons}")
@@ -483,5 +1092,20 @@ if __name__ == '__main__':
     print(f"  Nodes: {len(deployment_plan.neuron_tables)}")
     print(f"\nNeurons per node:")
     for (bp_name, node_id), table_data in deployment_plan.neuron_tables.items():
-        neuron_count = len(table_data) // 256
+        neuron_count = table_neuron_count(table_data)
         print(f"  {bp_name}:{node_id:2d} - {neuron_count:4d} neurons ({len(table_data):6d} bytes)")
+    
+    traffic = deployment_plan.traffic
+    print(f"\nPredicted inter-node traffic:")
+    print(f"  Cut synapses:  {traffic['cut_synapses']} of {traffic['total_synapses']}")
+    print(f"  Remote spikes: {traffic['remote_spikes_per_s']:.0f}/s "
+          f"({traffic['remote_deliveries_per_s']:.0f} deliveries/s, "
+          f"{traffic['bus_bytes_per_s'] / 1024:.1f} KB/s of batch entries)")
+    
+    if args.tables:
+        os.makedirs(args.tables, exist_ok=True)
+        for (bp_name, node_id), table_data in deployment_plan.neuron_tables.items():
+            path = os.path.join(args.tables, f"{bp_name}_node{node_id}.bin")
+            with open(path, 'wb') as f:
+                f.write(table_data)
+        print(f"\nWrote {len(deployment_plan.neuron_tables)} tables to {args.tables}")
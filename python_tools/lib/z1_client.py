@@ -7,6 +7,8 @@ Provides Python interface to NeuroFab Z1 neuromorphic cluster via HTTP REST API.
 
 import requests
 import json
+import socket
+import struct
 import base64
 import time
 from typing import List, Dict, Optional, Any, Tuple
@@ -292,18 +294,46 @@ class Z1Client:
     
     def update_weights(self, updates: List[Dict[str, Any]]) -> int:
         """
-        Update synaptic weights.
+        Patch synaptic weights of the deployed network (SNN stopped).
         
         Args:
-            updates: List of weight updates, each with:
-                     {neuron_id, synapse_idx, weight}
+            updates: List of weight updates, each either
+                     {node_id, neuron_id, synapse_idx, weight} for one synapse
+                     (synapse_idx 0-255), or {node_id, neuron_id,
+                     first_synapse, weights} for a run of weights
             
         Returns:
             Number of weights updated
         """
-        response = self._request('POST', '/snn/weights', 
-                                json={'updates': updates})
-        return response.get('weights_updated', 0)
+        body = bytearray()
+        entries = bytearray()
+        entries_node = None
+        
+        def flush_entries():
+            if entries:
+                body.extend(struct.pack('<BBH', 1, entries_node, len(entries) // 4))
+                body.extend(entries)
+                entries.clear()
+        
+        for update in updates:
+            node_id = update['node_id']
+            if 'weights' in update:
+                weights = bytes(update['weights'])
+                flush_entries()
+                body.extend(struct.pack('<BBHHH', 2, node_id, len(weights),
+                                        update['neuron_id'], update.get('first_synapse', 0)))
+                body.extend(weights)
+                continue
+            if node_id != entries_node or len(entries) // 4 == 0xFFFF:
+                flush_entries()
+                entries_node = node_id
+            entries.extend(struct.pack('<HBB', update['neuron_id'], update['synapse_idx'],
+                                       update['weight']))
+        flush_entries()
+        
+        response = self._request('POST', '/snn/weights', data=bytes(body),
+                                headers={'Content-Type': 'application/octet-stream'})
+        return response.get('applied', 0)
     
     def get_spike_activity(self, duration_ms: int = 1000) -> List[SpikeEvent]:
         """
@@ -332,13 +362,17 @@ class Z1Client:
         
         Args:
             spikes: List of spike events, each with:
-                    {neuron_id, value}
+                    {neuron_id, value} (global neuron ID, value default 1.0)
             
         Returns:
             Number of spikes injected
         """
-        response = self._request('POST', '/snn/input',
-                                json={'spikes': spikes})
+        body = bytearray(struct.pack('<H', len(spikes)))
+        for spike in spikes:
+            body.extend(struct.pack('<Hf', spike['neuron_id'], spike.get('value', 1.0)))
+        
+        response = self._request('POST', '/snn/input', data=bytes(body),
+                                headers={'Content-Type': 'application/octet-stream'})
         return response.get('spikes_injected', 0)
     
     def start_snn(self) -> bool:
@@ -369,6 +403,293 @@ class Z1Client:
             Status dictionary with execution state and statistics
         """
         return self._request('GET', '/snn/status')
+    
+    # ========================================================================
+    # Input Encoders
+    # ========================================================================
+    
+    ENCODE_MODES = {'poisson': 0, 'rate': 1, 'latency': 2}
+    ENCODE_FLAG_LOOP = 0x01
+    
+    def encode_input(self, values: List[int], first_neuron: int = 0, mode: str = 'poisson',
+                     window_steps: int = 100, max_rate: float = 1.0, value: float = 1.0,
+                     seed: int = 0, loop: bool = False) -> Dict[str, Any]:
+        """
+        Present a raw tensor through the controller's spike encoder.
+        
+        The controller generates the input spikes of every step of the
+        window itself, so the tensor is sent once. A new tensor replaces
+        the one being presented.
+        
+        Args:
+            values: Tensor values 0-255; value i drives global neuron first_neuron + i
+            first_neuron: Global ID of the neuron driven by values[0]
+            mode: 'poisson', 'rate' (evenly spaced) or 'latency' (time-to-first-spike)
+            window_steps: Steps each presentation lasts
+            max_rate: Spike chance per step at value 255 (poisson and rate)
+            value: Input per spike
+            seed: Poisson PRNG seed (0 = from the controller timer)
+            loop: Present again after each window until replaced or stopped
+            
+        Returns:
+            Summary (values, inputs, window_steps)
+        """
+        if mode not in self.ENCODE_MODES:
+            raise ValueError(f"Unknown encoder mode: {mode}")
+        rate = max(0, min(0xFFFF, int(round(max_rate * 65536)))) if max_rate < 1.0 else 0
+        q = max(-32768, min(32767, int(round(value * 256))))
+        body = struct.pack('<BBHHHHhI', self.ENCODE_MODES[mode], self.ENCODE_FLAG_LOOP if loop else 0,
+                           len(values), first_neuron, window_steps, rate, q, seed)
+        body += bytes(max(0, min(255, int(v))) for v in values)
+        
+        return self._request('POST', '/snn/encode', data=body,
+                             headers={'Content-Type': 'application/octet-stream'})
+    
+    def get_encoder_status(self) -> Dict[str, Any]:
+        """
+        Get the tensor being presented and the spikes generated so far.
+        
+        Returns:
+            Status dictionary ('active', 'step', 'presentations', 'spikes')
+        """
+        return self._request('GET', '/snn/encode')
+    
+    def stop_encoder(self) -> bool:
+        """
+        End the current presentation.
+        
+        Returns:
+            True if successful
+        """
+        response = self._request('POST', '/snn/encode/stop')
+        return response.get('status') == 'ok'
+    
+    # ========================================================================
+    # Batch Inference
+    # ========================================================================
+    
+    BATCH_HOLD = 0x8000
+    BATCH_RESULTS_MAGIC = 0x5242315A
+    
+    def upload_batch(self, samples: List[List[Tuple[int, int, float]]], steps_per_sample: int,
+                     hold: bool = False) -> Dict[str, Any]:
+        """
+        Stage a batch of samples on the nodes (SNN deployed and stopped).
+        
+        The staging area of the nodes is reused, so the next deploy sends
+        the whole network again.
+        
+        Args:
+            samples: Per sample, (step, global neuron ID, value) inputs
+            steps_per_sample: Steps each sample runs
+            hold: Repeat every input from its step to the end of its sample
+            
+        Returns:
+            Staging summary (inputs, unmapped, bytes)
+        """
+        flag = self.BATCH_HOLD if hold else 0
+        body = bytearray()
+        for index, inputs in enumerate(samples):
+            for step, neuron_id, value in sorted(inputs, key=lambda entry: entry[0]):
+                q = max(-32768, min(32767, int(round(value * 256))))
+                body += struct.pack('<HHHh', index, step | flag, neuron_id, q)
+        
+        return self._request('POST', f'/snn/batch?steps={steps_per_sample}&samples={len(samples)}',
+                             data=bytes(body), headers={'Content-Type': 'application/octet-stream'})
+    
+    def start_batch(self) -> bool:
+        """
+        Run the staged batch.
+        
+        Returns:
+            True if successful
+        """
+        response = self._request('POST', '/snn/batch/start')
+        return response.get('status') == 'ok'
+    
+    def get_batch_status(self) -> Dict[str, Any]:
+        """
+        Get the staged batch and the progress of each node.
+        
+        Returns:
+            Status dictionary ('done' once every node finished)
+        """
+        return self._request('GET', '/snn/batch')
+    
+    def get_batch_results(self) -> Dict[int, List[int]]:
+        """
+        Read the output spike counts of the finished samples.
+        
+        Returns:
+            Global output neuron ID -> spike count per sample
+        """
+        try:
+            response = requests.get(f"{self.base_url}/snn/batch/results", timeout=self.timeout)
+            response.raise_for_status()
+        except requests.exceptions.RequestException as e:
+            raise Z1CommunicationError(f"Failed to communicate with cluster: {e}")
+        
+        data = response.content
+        results: Dict[int, List[int]] = {}
+        pos = 0
+        while pos + 16 <= len(data):
+            magic, _node, _, outputs, sample_count, _steps, _ = struct.unpack_from('<IBBHHHI', data, pos)
+            if magic != self.BATCH_RESULTS_MAGIC:
+                raise Z1CommunicationError("Malformed batch results")
+            pos += 16
+            
+            ids = []
+            for _ in range(outputs):
+                _local_id, _, global_id = struct.unpack_from('<HHI', data, pos)
+                ids.append(global_id)
+                pos += 8
+            
+            counts = struct.unpack_from(f'<{sample_count * outputs}H', data, pos)
+            pos += 2 * sample_count * outputs
+            for k, global_id in enumerate(ids):
+                results[global_id] = list(counts[k::outputs])
+        
+        return results
+    
+    # ========================================================================
+    # Backplane Gateway
+    # ========================================================================
+    
+    def set_gateway_backplane(self, backplane: int) -> Dict[str, Any]:
+        """
+        Set the controller's backplane number (drops its gateway routes).
+        
+        Args:
+            backplane: Backplane number (0-7)
+            
+        Returns:
+            Gateway status
+        """
+        return self._request('POST', f'/gateway?backplane={backplane}')
+    
+    def set_gateway_peer(self, backplane: int, ip: Optional[str], port: int = 5005) -> Dict[str, Any]:
+        """
+        Set or remove the controller of a peer backplane.
+        
+        Args:
+            backplane: Peer backplane number
+            ip: Peer controller address (None removes the peer)
+            port: Peer UDP spike port
+            
+        Returns:
+            Gateway status
+        """
+        query = f'backplane={backplane}'
+        if ip is not None:
+            query += f'&ip={ip}&port={port}'
+        return self._request('POST', f'/gateway/peer?{query}')
+    
+    def upload_gateway_routes(self, routes: bytes) -> int:
+        """
+        Replace the gateway route table (SNN stopped).
+        
+        Args:
+            routes: Packed z1_gateway_route_t entries (DeploymentPlan.gateway_routes)
+            
+        Returns:
+            Number of routes held by the controller
+        """
+        response = self._request('POST', '/gateway/routes', data=routes,
+                                headers={'Content-Type': 'application/octet-stream'})
+        return response.get('routes', 0)
+    
+    def get_gateway_status(self) -> Dict[str, Any]:
+        """
+        Get backplane number, peers and relay counters of the gateway.
+        
+        Returns:
+            Gateway status
+        """
+        return self._request('GET', '/gateway')
+
+
+class Z1SpikeChannel:
+    """
+    UDP spike channel of the controller (port 5005): input datagrams in,
+    recorded spikes pushed out every N timesteps to the subscribed host.
+    """
+    
+    MAGIC = 0x315A
+    INPUT, SUBSCRIBE, UNSUBSCRIBE, SPIKES, ACK = 1, 2, 3, 4, 5
+    FLAG_ACK, FLAG_OVERRUN, FLAG_LOCAL_IDS = 0x01, 0x02, 0x04
+    HEADER = struct.Struct('<HBBHHI')
+    MAX_INPUTS = (1472 - 12) // 4
+    
+    def __init__(self, controller_ip: str = "192.168.1.222", port: int = 5005,
+                 timeout: float = 1.0):
+        self.address = (controller_ip, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.settimeout(timeout)
+        self.seq = 0
+    
+    def _send(self, kind: int, flags: int = 0, count: int = 0, payload: bytes = b'') -> int:
+        self.seq = (self.seq + 1) & 0xFFFF
+        self.sock.sendto(self.HEADER.pack(self.MAGIC, kind, flags, self.seq, count, 0) + payload,
+                         self.address)
+        return self.seq
+    
+    def _wait_ack(self, seq: int) -> int:
+        while True:
+            data, _ = self.sock.recvfrom(2048)
+            if len(data) >= self.HEADER.size:
+                magic, kind, _, ack_seq, count, _ = self.HEADER.unpack_from(data)
+                if magic == self.MAGIC and kind == self.ACK and ack_seq == seq:
+                    return count
+    
+    def subscribe(self, every_steps: int = 1) -> None:
+        """Receive recorded spikes every every_steps timesteps."""
+        self._wait_ack(self._send(self.SUBSCRIBE, payload=struct.pack('<HH', every_steps, 0)))
+    
+    def unsubscribe(self) -> None:
+        self._wait_ack(self._send(self.UNSUBSCRIBE))
+    
+    def inject(self, spikes: List[Tuple[int, float]], ack: bool = False) -> Optional[int]:
+        """
+        Inject (global neuron ID, value) pairs; values are sent in Q8.8.
+        
+        Returns:
+            Spikes injected if ack is set (waits for the controller), else None
+        """
+        injected = 0
+        for start in range(0, len(spikes), self.MAX_INPUTS):
+            part = spikes[start:start + self.MAX_INPUTS]
+            payload = b''.join(struct.pack('<Hh', n, max(-32768, min(32767, round(v * 256))))
+                               for n, v in part)
+            seq = self._send(self.INPUT, self.FLAG_ACK if ack else 0, len(part), payload)
+            if ack:
+                injected += self._wait_ack(seq)
+        return injected if ack else None
+    
+    def receive(self) -> Optional[Dict[str, Any]]:
+        """
+        Wait for the next spike push.
+        
+        Returns:
+            {step, seq, overrun, spikes: [(node, neuron_id, step)]}, or None on timeout
+        """
+        try:
+            while True:
+                data, _ = self.sock.recvfrom(2048)
+                if len(data) < self.HEADER.size:
+                    continue
+                magic, kind, flags, seq, count, step = self.HEADER.unpack_from(data)
+                if magic != self.MAGIC or kind != self.SPIKES:
+                    continue
+                spikes = [(node, neuron, spike_step) for node, _, neuron, spike_step
+                          in struct.iter_unpack('<BBHI', data[self.HEADER.size:
+                                                              self.HEADER.size + 8 * count])]
+                return {'step': step, 'seq': seq, 'overrun': bool(flags & self.FLAG_OVERRUN),
+                        'local_ids': bool(flags & self.FLAG_LOCAL_IDS), 'spikes': spikes}
+        except socket.timeout:
+            return None
+    
+    def close(self) -> None:
+        self.sock.close()
 
 
 # Utility functions for common operations